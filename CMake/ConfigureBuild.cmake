@@ -73,6 +73,7 @@ set(OGRE_SET_MEMTRACK_DEBUG 0)
 set(OGRE_SET_MEMTRACK_RELEASE 0)
 set(OGRE_SET_THREADS ${OGRE_CONFIG_THREADS})
 set(OGRE_SET_THREAD_PROVIDER ${OGRE_THREAD_PROVIDER})
+set(OGRE_SET_WORK_STEALING_QUEUE 0)
 set(OGRE_SET_DISABLE_FREEIMAGE 0)
 set(OGRE_SET_DISABLE_DDS 0)
 set(OGRE_SET_DISABLE_PVRTC 0)
@@ -85,6 +86,9 @@ set(OGRE_SET_PROFILING 0)
 if (OGRE_CONFIG_DOUBLE)
   set(OGRE_SET_DOUBLE 1)
 endif()
+if (OGRE_CONFIG_WORK_STEALING_QUEUE AND (OGRE_THREAD_PROVIDER EQUAL 1 OR OGRE_THREAD_PROVIDER EQUAL 2))
+  set(OGRE_SET_WORK_STEALING_QUEUE 1)
+endif()
 if (OGRE_CONFIG_CONTAINERS_USE_CUSTOM_ALLOCATOR)
   set(OGRE_SET_CONTAINERS_USE_ALLOCATOR 1)
 endif ()
@@ -47,6 +47,7 @@ if (OGRE_THREAD_SUPPORT_AVAILABLE)
 		poco  - Poco thread library.
 		tbb   - ThreadingBuildingBlocks library."
 	)
+	option(OGRE_CONFIG_WORK_STEALING_QUEUE "Use the work-stealing WorkQueue as the default queue created by Root (boost and poco only)." FALSE)
 else ()
 	set(OGRE_CONFIG_THREADS 0)
 	set(OGRE_CONFIG_THREAD_PROVIDER "none")
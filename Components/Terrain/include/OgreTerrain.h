@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreTerrainMaterialGenerator.h"
 #include "OgreTerrainLayerBlendMap.h"
+#include "OgreTerrainHeightPyramid.h"
 #include "OgreWorkQueue.h"
 
 namespace Ogre
@@ -53,7 +54,7 @@ namespace Ogre
 		Terrain can be edited and stored.
 	The data format for this in a file is:<br/>
 	<b>TerrainData (Identifier 'TERR')</b>\n
-	[Version 1]
+	[Version 1, or 2 if saved compressed (see TerrainGlobalOptions::setSaveCompressed)]
 	<table>
 	<tr>
 		<td><b>Name</b></td>
@@ -93,7 +94,8 @@ namespace Ogre
 	<tr>
 		<td>Height data</td>
 		<td>float[size*size]</td>
-		<td>List of floating point heights</td>
+		<td>List of floating point heights. Version 1 only, version 2 stores
+			the heights in the height level chunks at the end</td>
 	</tr>
 	<tr>
 		<td>LayerDeclaration</td>
@@ -119,7 +121,8 @@ namespace Ogre
 		<td>Packed blend texture data</td>
 		<td>uint8*</td>
 		<td>layerCount-1 sets of blend texture data interleaved as either RGB or RGBA 
-			depending on layer count</td>
+			depending on layer count. Written by TerrainCompression::writeImage 
+			in version 2</td>
 	</tr>
 	<tr>
 		<td>Optional derived map data</td>
@@ -129,13 +132,19 @@ namespace Ogre
 	<tr>
 		<td>Delta data</td>
 		<td>float[size*size]</td>
-		<td>At each vertex, delta information for the LOD at which this vertex disappears</td>
+		<td>At each vertex, delta information for the LOD at which this vertex disappears.
+			Written by TerrainCompression::writeQuantised in version 2</td>
 	</tr>
 	<tr>
 		<td>Quadtree delta data</td>
 		<td>float[quadtrees*lods]</td>
 		<td>At each quadtree node, for each lod a record of the max delta value in the region</td>
 	</tr>
+	<tr>
+		<td>Height levels</td>
+		<td>TerrainHeightLevel list</td>
+		<td>Version 2 only, one chunk per LOD level, coarsest first (see below)</td>
+	</tr>
 	</table>
 	<b>TerrainLayerDeclaration (Identifier 'TDCL')</b>\n
 	[Version 1]
@@ -254,7 +263,44 @@ namespace Ogre
 	<tr>
 		<td>Data</td>
 		<td>varies based on type</td>
-		<td>The data</td>
+		<td>The data. Written by TerrainCompression::writeImage if the 
+			terrain is version 2</td>
+	</tr>
+	</table>
+	<b>TerrainHeightLevel (Identifier 'THLV')</b>\n
+	[Version 1]
+	<table>
+	<tr>
+		<td><b>Name</b></td>
+		<td><b>Type</b></td>
+		<td><b>Description</b></td>
+	</tr>
+	<tr>
+		<td>Level</td>
+		<td>uint16</td>
+		<td>The LOD level, 0 being the full resolution</td>
+	</tr>
+	<tr>
+		<td>Level count</td>
+		<td>uint16</td>
+		<td>The number of levels the heights are split into</td>
+	</tr>
+	<tr>
+		<td>Precision</td>
+		<td>Real</td>
+		<td>The size of one step of the quantised heights</td>
+	</tr>
+	<tr>
+		<td>Residual size</td>
+		<td>uint32</td>
+		<td>The size of the residuals before compression</td>
+	</tr>
+	<tr>
+		<td>Residuals</td>
+		<td>compressed bytes</td>
+		<td>For each vertex in the level, the difference between its quantised 
+			height and that predicted from the coarser levels, as variable length
+			integers</td>
 	</tr>
 	</table>
 	*/
@@ -581,12 +627,28 @@ namespace Ogre
 			void warmStart(size_t numInstances, uint16 terrainSize, uint16 maxBatchSize, 
 				uint16 minBatchSize);
 
+			/** Sets the memory which freed vertex buffers kept for reuse may
+				occupy, in bytes (default 0, meaning no limit).
+			@remarks
+				When the limit is exceeded the buffers which were freed first
+				are released.
+			*/
+			void setMaxFreeBufferMemory(size_t bytes);
+			/// Gets the memory which freed vertex buffers kept for reuse may occupy, in bytes
+			size_t getMaxFreeBufferMemory() const { return mMaxFreeBufferMemory; }
+			/// Gets the memory occupied by freed vertex buffers kept for reuse, in bytes
+			size_t getFreeBufferMemory() const { return mFreeBufferMemory; }
+			/// Release freed vertex buffers, oldest first, until at most the given memory is used
+			void trimFreeBuffers(size_t maxBytes);
+
 		protected:
 			typedef list<HardwareVertexBufferSharedPtr>::type VBufList;
 			VBufList mFreePosBufList;
 			VBufList mFreeDeltaBufList;
 			typedef map<uint32, HardwareIndexBufferSharedPtr>::type IBufMap;
 			IBufMap mSharedIBufMap;
+			size_t mFreeBufferMemory;
+			size_t mMaxFreeBufferMemory;
 
 			uint32 hashIndexBuffer(uint16 batchSize, 
 				uint16 vdatasize, size_t vertexIncrement, uint16 xoffset, uint16 yoffset, uint16 numSkirtRowsCols, 
@@ -604,6 +666,99 @@ namespace Ogre
 		/// Get the current buffer allocator
 		GpuBufferAllocator* getGpuBufferAllocator();
 
+		/** Loads and evicts the vertex data of quadtree nodes on demand, when
+			TerrainGlobalOptions::setStreamVertexData is enabled.
+		@remarks
+			Nodes request their vertex data as they come within range of their
+			coarsest LOD; requests are served once per frame, closest to the
+			camera first, and the least recently rendered data is evicted to 
+			stay within the memory budget, or data further away when all of it 
+			was rendered in the last frame. An instance can be shared between several terrains
+			so that they share a budget, which is what TerrainGroup does.
+		*/
+		class _OgreTerrainExport VertexDataStreamer : public TerrainAlloc
+		{
+		public:
+			/// Counters describing the streamed vertex data
+			struct Statistics
+			{
+				/// Number of nodes whose streamed vertex data is loaded
+				size_t residentCount;
+				/// Memory used by the loaded streamed vertex data, in bytes
+				size_t residentBytes;
+				/// Number of times vertex data was loaded
+				size_t loadCount;
+				/// Number of times vertex data was evicted to stay within budget
+				size_t evictionCount;
+				/// Number of requests postponed by the budget or the per-frame limit
+				size_t deferredCount;
+
+				Statistics() : residentCount(0), residentBytes(0), loadCount(0),
+					evictionCount(0), deferredCount(0) {}
+			};
+
+			VertexDataStreamer();
+			virtual ~VertexDataStreamer();
+
+			/** Sets the memory that streamed vertex data may use, in bytes
+				(default 0, meaning no limit).
+			@remarks
+				Data which has been rendered in the current frame is never
+				evicted, and data rendered in the last frame only for closer
+				data; requests are postponed until enough can be evicted.
+			*/
+			void setMemoryBudget(size_t bytes) { mMemoryBudget = bytes; }
+			/// Gets the memory that streamed vertex data may use, in bytes
+			size_t getMemoryBudget() const { return mMemoryBudget; }
+			/** Sets the number of nodes which may load their vertex data in
+				a single frame (default 0, meaning no limit).
+			*/
+			void setMaxLoadsPerFrame(size_t loads) { mMaxLoadsPerFrame = loads; }
+			/// Gets the number of nodes which may load their vertex data in a single frame
+			size_t getMaxLoadsPerFrame() const { return mMaxLoadsPerFrame; }
+
+			/// Get the counters describing the streamed vertex data
+			const Statistics& getStatistics() const { return mStatistics; }
+			/// Reset the load, eviction and deferral counters
+			void resetStatistics();
+
+			/// Evict all the streamed vertex data which has been loaded
+			void evictAll();
+
+			/// Ask for a node's vertex data to be loaded, internal use only
+			void _requestLoad(TerrainQuadTreeNode* node);
+			/// Load the requested vertex data, evicting as needed, internal use only
+			void _processRequests();
+			/// Notify that a node's vertex data has been destroyed, internal use only
+			void _notifyUnloaded(TerrainQuadTreeNode* node);
+
+		protected:
+			typedef vector<TerrainQuadTreeNode*>::type NodeList;
+			NodeList mRequests;
+			NodeList mResident;
+			size_t mMemoryBudget;
+			size_t mMaxLoadsPerFrame;
+			size_t mLoadsThisFrame;
+			unsigned long mCurrentFrame;
+			Statistics mStatistics;
+
+			/// Evict data until the given amount, wanted at the given distance, fits the budget
+			bool makeRoom(size_t bytes, Real distance);
+			void evict(TerrainQuadTreeNode* node);
+		};
+
+		/** Tell this instance to use the given VertexDataStreamer.
+		@remarks
+			May only be called when the terrain is not loaded.
+		*/
+		void setVertexDataStreamer(VertexDataStreamer* streamer);
+
+		/// Get the current vertex data streamer
+		VertexDataStreamer* getVertexDataStreamer();
+
+		/// Get whether vertex data below the root of the quadtree is loaded on demand
+		bool _getStreamVertexData() const { return mStreamVertexData; }
+
 		/// Utility method to get the number of indexes required to render a given batch
 		static size_t _getNumIndexesForBatchSize(uint16 batchSize);
 		/** Utility method to populate a (locked) index buffer.
@@ -747,6 +902,24 @@ namespace Ogre
 		*/
 		bool isHeightDataModified() const { return mHeightDataModified; }
 
+		/// Get the last frame in which any part of this terrain was queued for rendering
+		unsigned long getLastVisibleFrame() const { return mLastVisibleFrame; }
+		/// Notify that part of this terrain is being rendered, internal use only
+		void _notifyVisible();
+
+		/** Get the main memory held by this terrain, in bytes.
+		@remarks
+			This counts the height and delta data, vertex data which is not on
+			the GPU and CPU copies of the blend and derived maps.
+		*/
+		size_t getCpuMemoryUsage() const;
+		/** Get the video memory held by this terrain, in bytes.
+		@remarks
+			This counts the vertex buffers of the quadtree and the blend and 
+			derived map textures, but not index buffers, which are shared.
+		*/
+		size_t getGpuMemoryUsage() const;
+
 
 		/** Unload the terrain and free GPU resources. 
 		@remarks
@@ -1239,6 +1412,18 @@ namespace Ogre
 		*/
 		PixelBox* calculateNormals(const Rect& rect, Rect& outFinalRect);
 
+		/** Calculate the normals for part of the terrain into an existing PixelBox.
+		@remarks
+			Unlike the version above, the rectangle is not widened; this is
+			for filling in one tile of a larger area.
+		@param rect Rectangle describing the vertices to calculate, which must
+			be within boxRect
+		@param boxRect Rectangle describing the vertices the whole of box covers
+		@param box PixelBox of PF_BYTE_RGB to receive the normals, laid out
+			as calculateNormals returns them
+		*/
+		void calculateNormals(const Rect& rect, const Rect& boxRect, PixelBox* box);
+
 		/** Finalise the normals. 
 		Calculated normals are kept in a separate calculation area to make
 		them safe to perform in a background thread. This call promotes those
@@ -1257,6 +1442,18 @@ namespace Ogre
 		*/
 		PixelBox* calculateLightmap(const Rect& rect, const Rect& extraTargetRect, Rect& outFinalRect);
 
+		/** Calculate the lightmap for part of the terrain into an existing PixelBox.
+		@remarks
+			Unlike the version above, the rectangle is in lightmap space already
+			and is not widened; this is for filling in one tile of a larger area.
+		@param rect Rectangle describing the lightmap texels to calculate, which
+			must be within boxRect
+		@param boxRect Rectangle describing the lightmap texels the whole of box covers
+		@param box PixelBox of PF_L8 to receive the lighting, laid out
+			as calculateLightmap returns it
+		*/
+		void calculateLightmap(const Rect& rect, const Rect& boxRect, PixelBox* box);
+
 		/** Finalise the lightmap. 
 		Calculating lightmaps is kept in a separate calculation area to make
 		it safe to perform in a background thread. This call promotes those
@@ -1281,6 +1478,11 @@ namespace Ogre
 		 @return A pair which contains whether the ray hit the terrain and, if so, where.
 		 @remarks This can be called from any thread as long as no parallel write to
 		 the heightmap data occurs.
+		 @par
+		 The ray descends a pyramid of minimum and maximum heights, which is kept
+		 up to date by setHeightAtPoint, dirty and dirtyRect, so only the quads
+		 the ray could actually hit are tested. If you change the data returned 
+		 by getHeightData, call dirtyRect before testing rays against it.
 		 */
 		std::pair<bool, Vector3> rayIntersects(const Ray& ray, 
 			bool cascadeToNeighbours = false, Real distanceLimit = 0); //const;
@@ -1638,6 +1840,13 @@ namespace Ogre
 		void calculateCurrentLod(Viewport* vp);
 		/// Test a single quad of the terrain for ray intersection.
 		std::pair<bool, Vector3> checkQuadIntersection(int x, int y, const Ray& ray); //const;
+		/** Test the terrain for ray intersection by walking along the ray through
+			the height pyramid, skipping whole cells which the ray passes over.
+		@param ray The ray in vertex space
+		@param start, end The part of the ray to test
+		*/
+		std::pair<bool, Vector3> checkPyramidIntersection(const Ray& ray, 
+			const TerrainHeightPyramid::CellRay& cellRay, Real start, Real end);
 
         /// Delete blend maps for all layers >= lowIndex
         void deleteBlendMaps(uint8 lowIndex);
@@ -1654,7 +1863,7 @@ namespace Ogre
 		void checkLayers(bool includeGPUResources);
 		void checkDeclaration();
 		void deriveUVMultipliers();
-		PixelFormat getBlendTextureFormat(uint8 textureIndex, uint8 numLayers);
+		PixelFormat getBlendTextureFormat(uint8 textureIndex, uint8 numLayers) const;
 
 		void updateDerivedDataImpl(const Rect& rect, const Rect& lightmapExtraRect, bool synchronous, uint8 typeMask);
 
@@ -1675,11 +1884,14 @@ namespace Ogre
 		bool mIsLoaded;
 		bool mModified;
 		bool mHeightDataModified;
+		unsigned long mLastVisibleFrame;
 		
 		/// The height data (world coords relative to mPos)
 		float* mHeightData;
 		/// The delta information defining how a vertex moves before it is removed at a lower LOD
 		float* mDeltaData;
+		/// Min / max heights of the height data, for ray queries
+		TerrainHeightPyramid mHeightPyramid;
 		Alignment mAlign;
 		Real mWorldSize;
 		uint16 mSize;
@@ -1718,6 +1930,11 @@ namespace Ogre
 			uint8 typeMask;
 			Rect dirtyRect;
 			Rect lightmapExtraDirtyRect;
+			// if not null, this is one tile of a larger update, which is
+			// calculated straight into the shared box that covers targetRect
+			PixelBox* targetBox;
+			Rect targetRect;
+			Rect tileRect;
 			_OgreTerrainExport friend std::ostream& operator<<(std::ostream& o, const DerivedDataRequest& r)
 			{ return o; }		
 		};
@@ -1741,6 +1958,26 @@ namespace Ogre
 			{ return o; }		
 		};
 
+		/// Tiles of the update in progress that haven't responded yet
+		size_t mDerivedDataTilesPending;
+		/// The update that was split into tiles, and its response once they're all done
+		DerivedDataRequest mTiledDerivedDataRequest;
+		DerivedDataResponse mTiledDerivedDataResponse;
+
+		/// Get the area of normals to recalculate when the heights in rect change
+		Rect getNormalUpdateRect(const Rect& rect);
+		/// Get the area of lightmap (in lightmap space) to recalculate when the heights in rect change
+		Rect getLightmapUpdateRect(const Rect& rect, const Rect& extraTargetRect);
+		/** Split the next step of a derived data update into tiles which are
+			dispatched as separate requests, so they can be calculated in parallel.
+		@remarks
+			Only normals and lightmaps are split up, and only if the area is larger
+			than TerrainGlobalOptions::getDerivedDataTileSize. handleResponse joins
+			the tiles and finalises them together.
+		@returns Whether the request was dispatched as tiles
+		*/
+		bool dispatchDerivedDataTiles(const DerivedDataRequest& req, bool synchronous);
+
 		String mMaterialName;
 		mutable MaterialPtr mMaterial;
 		mutable TerrainMaterialGeneratorPtr mMaterialGenerator;
@@ -1804,6 +2041,10 @@ namespace Ogre
 		GpuBufferAllocator* mCustomGpuBufferAllocator;
 		DefaultGpuBufferAllocator mDefaultGpuBufferAllocator;
 
+		bool mStreamVertexData;
+		VertexDataStreamer* mCustomVertexDataStreamer;
+		VertexDataStreamer mDefaultVertexDataStreamer;
+
 		size_t getPositionBufVertexSize() const;
 		size_t getDeltaBufVertexSize() const;
 
@@ -1841,6 +2082,10 @@ namespace Ogre
 		ColourValue mCompositeMapDiffuse;
 		Real mCompositeMapDistance;
 		String mResourceGroup;
+		uint16 mDerivedDataTileSize;
+		bool mSaveCompressed;
+		Real mCompressedHeightPrecision;
+		bool mStreamVertexData;
 
 	public:
 		TerrainGlobalOptions();
@@ -2007,6 +2252,66 @@ namespace Ogre
 		*/
 		const String& getDefaultResourceGroup() { return mResourceGroup; }
 
+		/** Get the size of the tiles that updates of normals and lightmaps
+			are split into.
+		*/
+		uint16 getDerivedDataTileSize() { return mDerivedDataTileSize; }
+
+		/** Sets the size of the tiles, in texels along each side, that updates
+			of normals and lightmaps are split into (default 256).
+		@remarks
+			Each tile is a separate WorkQueue request, so a large update such as
+			that of a newly loaded terrain is spread over the worker threads.
+			0 calculates each update in a single request.
+		*/
+		void setDerivedDataTileSize(uint16 sz) { mDerivedDataTileSize = sz; }
+
+		/** Get whether terrains are saved in the compressed format.
+		*/
+		bool getSaveCompressed() { return mSaveCompressed; }
+
+		/** Sets whether terrains are saved in the compressed format (default false).
+		@remarks
+			Compressed terrains store heights quantised to the precision given
+			by setCompressedHeightPrecision, split by LOD level so the coarse
+			levels can be read without the fine ones, and store blend maps and
+			derived data losslessly through StreamSerialiser::writeCompressedData.
+			Terrains are always saved uncompressed if 
+			StreamSerialiser::isCompressionSupported is false; either form can 
+			be loaded.
+		*/
+		void setSaveCompressed(bool compressed) { mSaveCompressed = compressed; }
+
+		/** Get the precision that heights are kept to when saving compressed terrains.
+		*/
+		Real getCompressedHeightPrecision() { return mCompressedHeightPrecision; }
+
+		/** Sets the precision, in world units, that heights are kept to when
+			saving compressed terrains (default 0.01). 
+		@remarks
+			No saved height will differ from the original by more than half of
+			this. Larger values compress better.
+		*/
+		void setCompressedHeightPrecision(Real precision) { mCompressedHeightPrecision = precision; }
+
+		/** Get whether the vertex data of quadtree nodes is loaded on demand.
+		*/
+		bool getStreamVertexData() { return mStreamVertexData; }
+
+		/** Sets whether the vertex data of quadtree nodes is loaded on demand
+			(default false).
+		@remarks
+			When enabled, only the coarsest vertex data, held by the root of 
+			each quadtree, is created when a terrain is prepared, so a terrain
+			can be rendered as soon as it is loaded. Finer data is created as
+			the LOD calculation comes to need it and evicted again when it is no
+			longer rendered, under the control of Terrain::VertexDataStreamer.
+			Height data is always held in full.
+		@par
+			Changing this value only applies to Terrain instances loaded / reloaded afterwards.
+		*/
+		void setStreamVertexData(bool stream) { mStreamVertexData = stream; }
+
 		/** Override standard Singleton retrieval.
 		@remarks
 		Why do we do this? Well, it's because the Singleton
@@ -0,0 +1,144 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __Ogre_TerrainCompression_H__
+#define __Ogre_TerrainCompression_H__
+
+#include "OgreTerrainPrerequisites.h"
+#include "OgreStreamSerialiser.h"
+
+namespace Ogre
+{
+	/** \addtogroup Optional Components
+	*  @{
+	*/
+	/** \addtogroup Terrain
+	*  Some details on the terrain component
+	*  @{
+	*/
+
+
+	/** Utility class for the compressed form of terrain data.
+	@remarks
+		Every method writes or reads its data through 
+		StreamSerialiser::writeCompressedData, after first transforming it into
+		something that compresses well: the differences between neighbouring 
+		bytes of images, and small integers for heights.
+	@par
+		Heights are quantised to a given precision and split by LOD level, so 
+		that the coarse levels come first and the finer ones can be read later,
+		or not at all. Level n holds the vertices on the grid of spacing 2^n
+		which are not on the grid of level n+1, the coarsest level holding all
+		of the vertices on its grid. Each height is stored as the difference
+		from the height predicted by the coarser level, which for smooth 
+		terrain is close to zero.
+	@par
+		You shouldn't need to use this class directly, it is used by Terrain 
+		when TerrainGlobalOptions::setSaveCompressed is enabled.
+	*/
+	class _OgreTerrainExport TerrainCompression
+	{
+	public:
+		static const uint32 HEIGHTLEVEL_CHUNK_ID;
+		static const uint16 HEIGHTLEVEL_CHUNK_VERSION;
+
+		/** Write a square grid of heights as one chunk per LOD level, 
+			coarsest first.
+		@param stream The stream to write to
+		@param heights The heights, size * size of them
+		@param size The number of vertices along one side, which must be
+			a multiple of 2^(numLevels-1) plus 1
+		@param numLevels The number of LOD levels to split the heights into
+		@param precision The largest difference allowed between a height and
+			the height that is stored
+		*/
+		static void writeHeights(StreamSerialiser& stream, const float* heights, 
+			uint16 size, uint16 numLevels, Real precision);
+
+		/** Read the next chunk written by writeHeights.
+		@remarks
+			Chunks must be read coarsest first, since each level is predicted
+			from the heights already read.
+		@param stream The stream to read from
+		@param heights The heights to update, size * size of them
+		@param size The number of vertices along one side
+		@param outLevel If not null, receives the level that was read
+		@returns Whether a height level chunk was read
+		*/
+		static bool readHeightLevel(StreamSerialiser& stream, float* heights, 
+			uint16 size, uint16* outLevel = 0);
+
+		/** Fill in the heights of all the levels finer than the given one
+			as the coarser levels predict them, for when they haven't been read.
+		@param heights The heights to update, size * size of them
+		@param size The number of vertices along one side
+		@param level The finest level that holds real heights
+		*/
+		static void interpolateHeights(float* heights, uint16 size, uint16 level);
+
+		/** Write an image, such as a blend map.
+		@param stream The stream to write to
+		@param data The pixels, rows packed together
+		@param width, height The dimensions of the image
+		@param bytesPerPixel The size of each pixel
+		*/
+		static void writeImage(StreamSerialiser& stream, const uint8* data, 
+			size_t width, size_t height, size_t bytesPerPixel);
+
+		/** Read an image written by writeImage.
+		@param stream The stream to read from
+		@param data Pointer to receive the pixels
+		@param width, height The dimensions of the image
+		@param bytesPerPixel The size of each pixel
+		*/
+		static void readImage(StreamSerialiser& stream, uint8* data, 
+			size_t width, size_t height, size_t bytesPerPixel);
+
+		/** Write a set of values quantised to a given precision.
+		@param stream The stream to write to
+		@param values The values to write
+		@param count The number of values
+		@param precision The largest difference allowed between a value and
+			the value that is stored
+		*/
+		static void writeQuantised(StreamSerialiser& stream, const float* values, 
+			size_t count, Real precision);
+
+		/** Read a set of values written by writeQuantised.
+		@param stream The stream to read from
+		@param values Pointer to receive the values
+		@param count The number of values expected
+		*/
+		static void readQuantised(StreamSerialiser& stream, float* values, size_t count);
+	};
+
+	/** @} */
+	/** @} */
+}
+
+#endif
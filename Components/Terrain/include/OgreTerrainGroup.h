@@ -161,6 +161,59 @@ namespace Ogre
 		void setResourceGroup(const String& grp) { mResourceGroup = grp; }
 		/** Get the resource group in which files will be located. */
 		const String& getResourceGroup() const { return mResourceGroup; }
+
+		/** Get the vertex data streamer shared by all the terrains in this group.
+		@remarks
+			Use this to set the memory budget that streamed vertex data may use
+			across the whole group, and to read its statistics. It's only used
+			when TerrainGlobalOptions::setStreamVertexData is enabled.
+		*/
+		Terrain::VertexDataStreamer* getVertexDataStreamer() { return &mVertexDataStreamer; }
+
+		/// Counters describing the terrain instances which are loaded, and the memory they use
+		struct ResidencyStatistics
+		{
+			/// Number of loaded terrain instances
+			size_t loadedCount;
+			/// Main memory held by the loaded instances, in bytes
+			size_t cpuMemory;
+			/// Video memory held by the loaded instances, in bytes
+			size_t gpuMemory;
+			/// Video memory held by freed vertex buffers the group keeps for reuse, in bytes
+			size_t freeBufferMemory;
+			/// Number of instances unloaded to stay within the memory budget
+			size_t evictionCount;
+
+			ResidencyStatistics() : loadedCount(0), cpuMemory(0), gpuMemory(0),
+				freeBufferMemory(0), evictionCount(0) {}
+		};
+
+		/** Sets the memory the terrains of this group may use, in bytes 
+			(default 0, meaning no limit).
+		@remarks
+			The budget covers the main and video memory of the loaded instances
+			and the vertex buffers kept for reuse. When it's exceeded, the spare
+			buffers are released first, then the instances which were visible
+			least recently are unloaded, which frees both their GPU and CPU 
+			resources. Their slot definitions are kept so they can be loaded 
+			again with loadTerrain.
+		@par
+			Only instances which can be reloaded without losing anything are 
+			unloaded, ie those defined from a file and not modified since. 
+			Instances visible in the current or the last frame are never 
+			unloaded, so the budget can be exceeded while they're in view.
+		*/
+		void setMemoryBudget(size_t bytes);
+		/// Gets the memory the terrains of this group may use, in bytes
+		size_t getMemoryBudget() const { return mMemoryBudget; }
+		/** Unload terrain instances until the group fits its memory budget.
+		@remarks
+			This happens whenever an instance is loaded; call it once per frame
+			as well to release instances once they're out of view.
+		*/
+		void applyMemoryBudget();
+		/// Get the counters describing the loaded terrain instances
+		ResidencyStatistics getResidencyStatistics() const;
 		/** Define a 'slot' in the terrain grid - in this case to be loaded from 
 			a generated file name.
 		@remarks
@@ -513,6 +566,9 @@ namespace Ogre
 		String mFilenameExtension;
 		String mResourceGroup;
 		Terrain::DefaultGpuBufferAllocator mBufferAllocator;
+		Terrain::VertexDataStreamer mVertexDataStreamer;
+		size_t mMemoryBudget;
+		size_t mEvictionCount;
 		
 		/// Get the position of a terrain instance
 		Vector3 getTerrainSlotPosition(long x, long y);
@@ -522,6 +578,8 @@ namespace Ogre
 		void connectNeighbour(TerrainSlot* slot, long offsetx, long offsety);
 
 		void loadTerrainImpl(TerrainSlot* slot, bool synchronous);
+		/// Whether an instance can be unloaded and loaded again without losing anything
+		bool isEvictable(const TerrainSlot* slot) const;
 
 		/// Structure for holding the load request
 		struct LoadRequest
@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __Ogre_TerrainHeightPyramid_H__
+#define __Ogre_TerrainHeightPyramid_H__
+
+#include "OgreTerrainPrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreRay.h"
+
+namespace Ogre
+{
+	/** \addtogroup Optional Components
+	*  @{
+	*/
+	/** \addtogroup Terrain
+	*  Some details on the terrain component
+	*  @{
+	*/
+
+
+	/** Minimum and maximum heights of a terrain's height data, at a series of
+		resolutions, used to find the quads a ray might hit without visiting
+		every quad along its path.
+	@remarks
+		Level 0 holds the bounds of each block of 2x2 quads, and each level 
+		above merges 2x2 cells of the one below, up to a single cell covering
+		the whole terrain. The bounds of individual quads are read straight from
+		the height data, which keeps the pyramid to about two thirds of the size
+		of the height data itself.
+	@par
+		Cells are addressed in the terrain's vertex space, the same space as
+		Terrain::getHeightData, in which quads are 1 unit across. 
+	@par
+		You shouldn't construct this class directly, it is maintained by Terrain.
+	*/
+	class _OgreTerrainExport TerrainHeightPyramid : public TerrainAlloc
+	{
+	public:
+		TerrainHeightPyramid();
+		~TerrainHeightPyramid();
+
+		/** Build the pyramid from the given height data.
+		@param heights The height data, which must remain valid while the
+			pyramid is in use
+		@param size The number of vertices along one side of the terrain
+		*/
+		void build(const float* heights, uint16 size);
+		/** Update the bounds of the cells touched by a change in the heights.
+		@param rect Rectangle of vertices which changed, with the right and 
+			bottom edges exclusive as for Terrain::dirtyRect
+		*/
+		void update(const Rect& rect);
+		/// Release the pyramid
+		void clear();
+		/// Returns whether there are no heights to describe
+		bool isEmpty() const { return mHeights == 0; }
+
+		/// Get the number of levels, not counting individual quads
+		uint16 getNumLevels() const { return static_cast<uint16>(mLevels.size()); }
+		/// Get the number of cells along one side at a level, with -1 for quads
+		long getLevelWidth(int level) const;
+		/** Get the height bounds of a cell
+		@param level The level, with -1 for individual quads
+		@param x, z The cell within the level
+		*/
+		void getCellBounds(int level, long x, long z, float* minHeight, float* maxHeight) const;
+
+		/// A ray in vertex space, prepared for testing against many cells
+		struct _OgreTerrainExport CellRay
+		{
+			CellRay(const Ray& ray);
+
+			Vector3 origin;
+			Vector3 dir;
+			/// Reciprocal of the direction, 0 on axes the ray is parallel to
+			Vector3 invDir;
+			bool parallel[3];
+		};
+
+		/** Test a ray against the box bounding a cell.
+		@param level The level, with -1 for individual quads
+		@param x, z The cell within the level
+		@param entry Set to the distance along the ray at which it enters the box
+		@param exit If not null, set to the distance at which it leaves the box
+		@returns Whether the ray passes through the box in front of its origin
+		*/
+		bool intersectsCell(const CellRay& ray, int level, long x, long z, 
+			Real* entry, Real* exit = 0) const;
+		/** Find the cell containing a point on a ray, and whether the ray
+			comes within the cell's heights before it leaves the cell.
+		@param level The level, with -1 for individual quads
+		@param t The distance of the point along the ray
+		@param x, z Set to the cell
+		@param exit Set to the distance at which the ray leaves the cell's column
+		@returns Whether the ray is within the cell's height bounds anywhere 
+			between t and exit
+		*/
+		bool stepCell(const CellRay& ray, int level, Real t, long* x, long* z, Real* exit) const;
+
+	protected:
+		struct Level
+		{
+			/// Number of cells along one side
+			long width;
+			/// Interleaved min / max height of each cell
+			vector<float>::type bounds;
+		};
+		typedef vector<Level>::type LevelList;
+
+		const float* mHeights;
+		uint16 mSize;
+		LevelList mLevels;
+
+		void updateLevel(int level, long left, long top, long right, long bottom);
+	};
+
+	/** @} */
+	/** @} */
+}
+
+#endif
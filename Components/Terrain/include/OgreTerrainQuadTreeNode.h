@@ -114,6 +114,8 @@ namespace Ogre
 		TerrainQuadTreeNode* getParent() const;
 		/// Get ultimate parent terrain
 		Terrain* getTerrain() const;
+		/// Get the depth of this node in the tree (0 is the root)
+		uint16 getDepth() const { return mDepth; }
 
 		/// Prepare node and children (perform CPU tasks, may be background thread)
 		void prepare();
@@ -191,6 +193,37 @@ namespace Ogre
 		*/
 		void updateVertexData(bool positions, bool deltas, const Rect& rect, bool cpuData);
 
+		/** Returns whether the vertex data this node renders with is loaded.
+		@remarks
+			This is only ever false when TerrainGlobalOptions::getStreamVertexData
+			is enabled, for nodes below the root of the tree.
+		*/
+		bool isVertexDataAvailable() const;
+		/// Returns whether this node owns vertex data which is loaded on demand
+		bool isVertexDataStreamed() const;
+		/** Create the vertex data this node owns, if it's loaded on demand. 
+		@remarks
+			The GPU copy is created too if the terrain is loaded. Usually this is
+			called by the Terrain::VertexDataStreamer.
+		*/
+		void loadVertexData();
+		/** Destroy the vertex data this node owns, if it's loaded on demand. 
+		@remarks
+			Usually this is called by the Terrain::VertexDataStreamer, which 
+			unloads any finer data first.
+		*/
+		void unloadVertexData();
+		/// Get the memory the vertex data this node owns uses when loaded, in bytes
+		size_t getVertexDataMemorySize() const;
+		/// Get the frame in which the vertex data this node owns was last rendered
+		unsigned long getVertexDataLastUsedFrame() const;
+		/// Get the distance from the camera at which the vertex data this node owns was last rendered or requested
+		Real getVertexDataDistance() const;
+		/** Get the memory used by the vertex data owned by this node and all
+			the nodes below it, in bytes.
+		@param gpu Whether to count the hardware buffers rather than the CPU copies
+		*/
+		size_t getVertexDataMemoryUsage(bool gpu) const;
 
 
 		/** Merge a point (relative to terrain node) into the local bounds, 
@@ -297,10 +330,20 @@ namespace Ogre
 			uint16 skirtRowColSkip;
 			/// Is the GPU vertex data out of date?
 			bool gpuVertexDataDirty;
-
+			/// Is the data only created on demand?
+			bool streamed;
+			/// The frame number in which the data was last rendered
+			unsigned long lastUsedFrame;
+			/// The closest distance from the camera it was rendered at in that frame, or requested at
+			Real distance;
+
+			// You need 2^levels + 1 rows of full resolution (max 129) vertex copies, plus
+			// the same number of columns. There are common vertices at intersections
 			VertexDataRecord(uint16 res, uint16 sz, uint16 lvls) 
 				: cpuVertexData(0), gpuVertexData(0), resolution(res), size(sz),
-				treeLevels(lvls), gpuVertexDataDirty(false) {}
+				treeLevels(lvls), numSkirtRowsCols((uint16)((1 << lvls) + 1)),
+				skirtRowColSkip((sz - 1) / (numSkirtRowsCols - 1)),
+				gpuVertexDataDirty(false), streamed(false), lastUsedFrame(0), distance(0) {}
 		};
 		
 		TerrainQuadTreeNode* mNodeWithVertexData;
@@ -385,6 +428,8 @@ namespace Ogre
 
 		const VertexDataRecord* getVertexDataRecord() const;
 		void createCpuVertexData();
+		/// Merge the positions in a region into the bounds, without any vertex data
+		void updateBounds(const Rect& rect);
 		/* Update the vertex buffers - the rect in question is relative to the whole terrain, 
 			not the local vertex data (which may use a subset)
 		*/
@@ -401,6 +446,15 @@ namespace Ogre
 		
 		uint16 calcSkirtVertexIndex(uint16 mainIndex, bool isCol);
 
+		/// Distance from the camera used to pick the LOD
+		Real calculateDistance(const Camera* cam) const;
+		/// Deselect this node and its children for rendering
+		void resetCurrentLod();
+		/// Ask for the vertex data this node owns to be loaded, if it's missing
+		void requestVertexData(Real distance);
+		/// Record that the vertex data is being rendered in this frame
+		void markVertexDataUsed(Real distance);
+
 	};
 
 	/** @} */
@@ -27,6 +27,7 @@ THE SOFTWARE.
 */
 #include "OgreTerrain.h"
 #include "OgreTerrainQuadTreeNode.h"
+#include "OgreTerrainCompression.h"
 #include "OgreStreamSerialiser.h"
 #include "OgreMath.h"
 #include "OgreImage.h"
@@ -47,6 +48,7 @@ THE SOFTWARE.
 #include "OgreTerrainMaterialGeneratorA.h"
 #include "OgreMaterialManager.h"
 #include "OgreHardwareBufferManager.h"
+#include "OgreOptimisedUtil.h"
 
 
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
@@ -57,7 +59,7 @@ namespace Ogre
 {
 	//---------------------------------------------------------------------
 	const uint32 Terrain::TERRAIN_CHUNK_ID = StreamSerialiser::makeIdentifier("TERR");
-	const uint16 Terrain::TERRAIN_CHUNK_VERSION = 1;
+	const uint16 Terrain::TERRAIN_CHUNK_VERSION = 2;
 	const uint32 Terrain::TERRAINLAYERDECLARATION_CHUNK_ID = StreamSerialiser::makeIdentifier("TDCL");
 	const uint16 Terrain::TERRAINLAYERDECLARATION_CHUNK_VERSION = 1;
 	const uint32 Terrain::TERRAINLAYERSAMPLER_CHUNK_ID = StreamSerialiser::makeIdentifier("TSAM");;
@@ -106,6 +108,10 @@ namespace Ogre
 		, mCompositeMapDiffuse(ColourValue::White)
 		, mCompositeMapDistance(4000)
 		, mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
+		, mDerivedDataTileSize(256)
+		, mSaveCompressed(false)
+		, mCompressedHeightPrecision(0.01)
+		, mStreamVertexData(false)
 	{
 	}
 	//---------------------------------------------------------------------
@@ -134,6 +140,7 @@ namespace Ogre
 		, mIsLoaded(false)
 		, mModified(false)
 		, mHeightDataModified(false)
+		, mLastVisibleFrame(0)
 		, mHeightData(0)
 		, mDeltaData(0)
 		, mPos(Vector3::ZERO)
@@ -147,6 +154,7 @@ namespace Ogre
 		, mDirtyLightmapFromNeighboursRect(0, 0, 0, 0)
 		, mDerivedDataUpdateInProgress(false)
 		, mDerivedUpdatePendingMask(0)
+		, mDerivedDataTilesPending(0)
 		, mMaterialGenerationCount(0)
 		, mMaterialDirty(false)
 		, mMaterialParamsDirty(false)
@@ -169,6 +177,8 @@ namespace Ogre
 		, mLastLODFrame(0)
 		, mLastViewportHeight(0)
 		, mCustomGpuBufferAllocator(0)
+		, mStreamVertexData(false)
+		, mCustomVertexDataStreamer(0)
 
 	{
 		mRootNode = sm->getRootSceneNode()->createChildSceneNode();
@@ -256,6 +266,25 @@ namespace Ogre
 		save(ser);
 	}
 	//---------------------------------------------------------------------
+	/// Write a square map of bytes, compressed if the terrain is
+	static void writeMapData(StreamSerialiser& stream, const uint8* data, size_t size, 
+		size_t bytesPerPixel, bool compressed)
+	{
+		if (compressed)
+			TerrainCompression::writeImage(stream, data, size, size, bytesPerPixel);
+		else
+			stream.write(data, size * size * bytesPerPixel);
+	}
+	//---------------------------------------------------------------------
+	static void readMapData(StreamSerialiser& stream, uint8* data, size_t size, 
+		size_t bytesPerPixel, bool compressed)
+	{
+		if (compressed)
+			TerrainCompression::readImage(stream, data, size, size, bytesPerPixel);
+		else
+			stream.read(data, size * size * bytesPerPixel);
+	}
+	//---------------------------------------------------------------------
 	void Terrain::save(StreamSerialiser& stream)
 	{
 		// wait for any queued processes to finish
@@ -274,7 +303,17 @@ namespace Ogre
 			finaliseHeightDeltas(rect, false);
 		}
 
-		stream.writeChunkBegin(TERRAIN_CHUNK_ID, TERRAIN_CHUNK_VERSION);
+		// Version 2 is only used for the compressed form, so uncompressed
+		// terrains can still be read by older versions
+		bool compressed = TerrainGlobalOptions::getSingleton().getSaveCompressed();
+		if (compressed && !StreamSerialiser::isCompressionSupported())
+		{
+			LogManager::getSingleton().stream() << 
+				"WARNING: compressed terrain was requested but compression is not "
+				"available in this build, saving uncompressed";
+			compressed = false;
+		}
+		stream.writeChunkBegin(TERRAIN_CHUNK_ID, compressed ? TERRAIN_CHUNK_VERSION : 1);
 
 		uint8 align = (uint8)mAlign;
 		stream.write(&align);
@@ -284,7 +323,8 @@ namespace Ogre
 		stream.write(&mMaxBatchSize);
 		stream.write(&mMinBatchSize);
 		stream.write(&mPos);
-		stream.write(mHeightData, mSize * mSize);
+		if (!compressed)
+			stream.write(mHeightData, mSize * mSize);
 
 		writeLayerDeclaration(mLayerDecl, stream);
 
@@ -305,9 +345,8 @@ namespace Ogre
 			{
 				PixelFormat fmt = getBlendTextureFormat(i, numLayers);
 				size_t channels = PixelUtil::getNumElemBytes(fmt);
-				size_t dataSz = channels * mLayerBlendMapSize * mLayerBlendMapSize;
 				uint8* pData = mCpuBlendMapStorage[i];
-				stream.write(pData, dataSz);
+				writeMapData(stream, pData, mLayerBlendMapSize, channels, compressed);
 			}
 		}
 		else
@@ -327,33 +366,44 @@ namespace Ogre
 				PixelFormat cpuFormat = getBlendTextureFormat(texIndex, getLayerCount());
 				PixelBox dst(mLayerBlendMapSizeActual, mLayerBlendMapSizeActual, 1, cpuFormat, tmpData);
 				(*i)->getBuffer()->blitToMemory(dst);
-				size_t dataSz = PixelUtil::getNumElemBytes((*i)->getFormat()) * 
-					mLayerBlendMapSizeActual * mLayerBlendMapSizeActual;
-				stream.write(tmpData, dataSz);
+				writeMapData(stream, tmpData, mLayerBlendMapSizeActual,
+					PixelUtil::getNumElemBytes((*i)->getFormat()), compressed);
+			}
+			// Textures may never have been created (no texture manager), but
+			// the loader always expects a full set, so write empty blend data
+			memset(tmpData, 0, mLayerBlendMapSizeActual * mLayerBlendMapSizeActual * 4);
+			for (; texIndex < getBlendTextureCount(numLayers); ++texIndex)
+			{
+				PixelFormat cpuFormat = getBlendTextureFormat(texIndex, numLayers);
+				writeMapData(stream, tmpData, mLayerBlendMapSizeActual,
+					PixelUtil::getNumElemBytes(cpuFormat), compressed);
 			}
 			OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
 		}
 
 		// other data
-		// normals
-		stream.writeChunkBegin(TERRAINDERIVEDDATA_CHUNK_ID, TERRAINDERIVEDDATA_CHUNK_VERSION);
-		String normalDataType("normalmap");
-		stream.write(&normalDataType);
-		stream.write(&mSize);
-		if (mCpuTerrainNormalMap)
+		// normals, if they've been calculated
+		if (mCpuTerrainNormalMap || !mTerrainNormalMap.isNull())
 		{
-			// save from CPU data if it's there, it means GPU data was never created
-			stream.write((uint8*)mCpuTerrainNormalMap->data, mSize * mSize * 3);
-		}
-		else
-		{
-			uint8* tmpData = (uint8*)OGRE_MALLOC(mSize * mSize * 3, MEMCATEGORY_GENERAL);
-			PixelBox dst(mSize, mSize, 1, PF_BYTE_RGB, tmpData);
-			mTerrainNormalMap->getBuffer()->blitToMemory(dst);
-			stream.write(tmpData, mSize * mSize * 3);
-			OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
+			stream.writeChunkBegin(TERRAINDERIVEDDATA_CHUNK_ID, TERRAINDERIVEDDATA_CHUNK_VERSION);
+			String normalDataType("normalmap");
+			stream.write(&normalDataType);
+			stream.write(&mSize);
+			if (mCpuTerrainNormalMap)
+			{
+				// save from CPU data if it's there, it means GPU data was never created
+				writeMapData(stream, (uint8*)mCpuTerrainNormalMap->data, mSize, 3, compressed);
+			}
+			else
+			{
+				uint8* tmpData = (uint8*)OGRE_MALLOC(mSize * mSize * 3, MEMCATEGORY_GENERAL);
+				PixelBox dst(mSize, mSize, 1, PF_BYTE_RGB, tmpData);
+				mTerrainNormalMap->getBuffer()->blitToMemory(dst);
+				writeMapData(stream, tmpData, mSize, 3, compressed);
+				OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
+			}
+			stream.writeChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
 		}
-		stream.writeChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
 
 
 		// colourmap
@@ -366,14 +416,14 @@ namespace Ogre
 			if (mCpuColourMapStorage)
 			{
 				// save from CPU data if it's there, it means GPU data was never created
-				stream.write(mCpuColourMapStorage, mGlobalColourMapSize * mGlobalColourMapSize * 3);
+				writeMapData(stream, mCpuColourMapStorage, mGlobalColourMapSize, 3, compressed);
 			}
 			else
 			{
 				uint8* tmpData = (uint8*)OGRE_MALLOC(mGlobalColourMapSize * mGlobalColourMapSize * 3, MEMCATEGORY_GENERAL);
 				PixelBox dst(mGlobalColourMapSize, mGlobalColourMapSize, 1, PF_BYTE_RGB, tmpData);
 				mColourMap->getBuffer()->blitToMemory(dst);
-				stream.write(tmpData, mGlobalColourMapSize * mGlobalColourMapSize * 3);
+				writeMapData(stream, tmpData, mGlobalColourMapSize, 3, compressed);
 				OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
 			}
 			stream.writeChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
@@ -390,14 +440,14 @@ namespace Ogre
 			if (mCpuLightmapStorage)
 			{
 				// save from CPU data if it's there, it means GPU data was never created
-				stream.write(mCpuLightmapStorage, mLightmapSize * mLightmapSize);
+				writeMapData(stream, mCpuLightmapStorage, mLightmapSize, 1, compressed);
 			}
 			else
 			{
 				uint8* tmpData = (uint8*)OGRE_MALLOC(mLightmapSize * mLightmapSize, MEMCATEGORY_GENERAL);
 				PixelBox dst(mLightmapSize, mLightmapSize, 1, PF_L8, tmpData);
 				mLightmap->getBuffer()->blitToMemory(dst);
-				stream.write(tmpData, mLightmapSize * mLightmapSize);
+				writeMapData(stream, tmpData, mLightmapSize, 1, compressed);
 				OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
 			}
 			stream.writeChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
@@ -413,7 +463,7 @@ namespace Ogre
 			if (mCpuCompositeMapStorage)
 			{
 				// save from CPU data if it's there, it means GPU data was never created
-				stream.write(mCpuCompositeMapStorage, mCompositeMapSize * mCompositeMapSize * 4);
+				writeMapData(stream, mCpuCompositeMapStorage, mCompositeMapSize, 4, compressed);
 			}
 			else
 			{
@@ -421,17 +471,26 @@ namespace Ogre
 				uint8* tmpData = (uint8*)OGRE_MALLOC(mCompositeMapSize * mCompositeMapSize * 4, MEMCATEGORY_GENERAL);
 				PixelBox dst(mCompositeMapSize, mCompositeMapSize, 1, PF_BYTE_RGBA, tmpData);
 				mCompositeMap->getBuffer()->blitToMemory(dst);
-				stream.write(tmpData, mCompositeMapSize * mCompositeMapSize * 4);
+				writeMapData(stream, tmpData, mCompositeMapSize, 4, compressed);
 				OGRE_FREE(tmpData, MEMCATEGORY_GENERAL);
 			}
 			stream.writeChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
 		}
 
 		// write deltas
-		stream.write(mDeltaData, mSize * mSize);
+		Real precision = TerrainGlobalOptions::getSingleton().getCompressedHeightPrecision();
+		if (compressed)
+			TerrainCompression::writeQuantised(stream, mDeltaData, mSize * mSize, precision);
+		else
+			stream.write(mDeltaData, mSize * mSize);
 		// write the quadtree
 		mQuadTree->save(stream);
 
+		// heights go last, coarsest level first, so that the finer levels
+		// can be left until they're needed
+		if (compressed)
+			TerrainCompression::writeHeights(stream, mHeightData, mSize, mNumLodLevels, precision);
+
 		stream.writeChunkEnd(TERRAIN_CHUNK_ID);
 
 		mModified = false;
@@ -578,8 +637,11 @@ namespace Ogre
 
 		copyGlobalOptions();
 
-		if (!stream.readChunkBegin(TERRAIN_CHUNK_ID, TERRAIN_CHUNK_VERSION))
+		const StreamSerialiser::Chunk* chunk = 
+			stream.readChunkBegin(TERRAIN_CHUNK_ID, TERRAIN_CHUNK_VERSION);
+		if (!chunk)
 			return false;
+		bool compressed = chunk->version >= 2;
 
 		uint8 align;
 		stream.read(&align);
@@ -596,8 +658,8 @@ namespace Ogre
 
 		size_t numVertices = mSize * mSize;
 		mHeightData = OGRE_ALLOC_T(float, numVertices, MEMCATEGORY_GEOMETRY);
-		stream.read(mHeightData, numVertices);
-
+		if (!compressed)
+			stream.read(mHeightData, numVertices);
 
 		// Layer declaration
 		if (!readLayerDeclaration(stream, mLayerDecl))
@@ -622,8 +684,8 @@ namespace Ogre
 			size_t channels = PixelUtil::getNumElemBytes(fmt);
 			size_t dataSz = channels * mLayerBlendMapSize * mLayerBlendMapSize;
 			uint8* pData = (uint8*)OGRE_MALLOC(dataSz, MEMCATEGORY_RESOURCE);
-			stream.read(pData, dataSz);
 			mCpuBlendMapStorage.push_back(pData);
+			readMapData(stream, pData, mLayerBlendMapSize, channels, compressed);
 		}
 
 		// derived data
@@ -642,7 +704,7 @@ namespace Ogre
 				uint8* pData = static_cast<uint8*>(OGRE_MALLOC(sz * sz * 3, MEMCATEGORY_GENERAL));
 				mCpuTerrainNormalMap = OGRE_NEW PixelBox(sz, sz, 1, PF_BYTE_RGB, pData);
 
-				stream.read(pData, sz * sz * 3);
+				readMapData(stream, pData, sz, 3, compressed);
 				
 			}
 			else if (name == "colourmap")
@@ -650,21 +712,21 @@ namespace Ogre
 				mGlobalColourMapEnabled = true;
 				mGlobalColourMapSize = sz;
 				mCpuColourMapStorage = static_cast<uint8*>(OGRE_MALLOC(sz * sz * 3, MEMCATEGORY_GENERAL));
-				stream.read(mCpuColourMapStorage, sz * sz * 3);
+				readMapData(stream, mCpuColourMapStorage, sz, 3, compressed);
 			}
 			else if (name == "lightmap")
 			{
 				mLightMapRequired = true;
 				mLightmapSize = sz;
 				mCpuLightmapStorage = static_cast<uint8*>(OGRE_MALLOC(sz * sz, MEMCATEGORY_GENERAL));
-				stream.read(mCpuLightmapStorage, sz * sz);
+				readMapData(stream, mCpuLightmapStorage, sz, 1, compressed);
 			}
 			else if (name == "compositemap")
 			{
 				mCompositeMapRequired = true;
 				mCompositeMapSize = sz;
 				mCpuCompositeMapStorage = static_cast<uint8*>(OGRE_MALLOC(sz * sz * 4, MEMCATEGORY_GENERAL));
-				stream.read(mCpuCompositeMapStorage, sz * sz * 4);
+				readMapData(stream, mCpuCompositeMapStorage, sz, 4, compressed);
 			}
 
 			stream.readChunkEnd(TERRAINDERIVEDDATA_CHUNK_ID);
@@ -674,12 +736,29 @@ namespace Ogre
 
 		// Load delta data
 		mDeltaData = OGRE_ALLOC_T(float, numVertices, MEMCATEGORY_GEOMETRY);
-		stream.read(mDeltaData, numVertices);
+		if (compressed)
+			TerrainCompression::readQuantised(stream, mDeltaData, numVertices);
+		else
+			stream.read(mDeltaData, numVertices);
 
 		// Create & load quadtree
 		mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0, 0);
 		mQuadTree->prepare(stream);
 
+		if (compressed)
+		{
+			uint16 levelsRead = 0;
+			while (!stream.isEndOfChunk(TERRAIN_CHUNK_ID) && 
+				TerrainCompression::readHeightLevel(stream, mHeightData, mSize))
+				++levelsRead;
+			if (levelsRead != mNumLodLevels)
+			{
+				OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+					"Terrain height data is incomplete", "Terrain::prepare");
+			}
+		}
+		mHeightPyramid.build(mHeightData, mSize);
+
 		stream.readChunkEnd(TERRAIN_CHUNK_ID);
 
 		distributeVertexData();
@@ -805,6 +884,7 @@ namespace Ogre
 
 		mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0, 0);
 		mQuadTree->prepare();
+		mHeightPyramid.build(mHeightData, mSize);
 
 		// calculate entire terrain
 		Rect rect;
@@ -837,6 +917,7 @@ namespace Ogre
 		mLightmapSizeActual = mLightmapSize; // for now, until we check
 		mCompositeMapSize = opts.getCompositeMapSize();
 		mCompositeMapSizeActual = mCompositeMapSize; // for now, until we check
+		mStreamVertexData = opts.getStreamVertexData();
 
 	}
 	//---------------------------------------------------------------------
@@ -1038,6 +1119,7 @@ namespace Ogre
 		mMaterialGenerator->requestOptions(this);
 
 		mIsLoaded = true;
+		mLastVisibleFrame = Root::getSingleton().getNextFrameNumber();
 
 	}
 	//---------------------------------------------------------------------
@@ -1058,6 +1140,58 @@ namespace Ogre
 
 	}
 	//---------------------------------------------------------------------
+	void Terrain::_notifyVisible()
+	{
+		mLastVisibleFrame = Root::getSingleton().getNextFrameNumber();
+	}
+	//---------------------------------------------------------------------
+	size_t Terrain::getCpuMemoryUsage() const
+	{
+		size_t total = 0;
+		size_t numVertices = (size_t)mSize * mSize;
+		if (mHeightData)
+			total += numVertices * sizeof(float);
+		if (mDeltaData)
+			total += numVertices * sizeof(float);
+		if (mQuadTree)
+			total += mQuadTree->getVertexDataMemoryUsage(false);
+
+		if (mCpuTerrainNormalMap)
+			total += numVertices * 3;
+		if (mCpuColourMapStorage)
+			total += (size_t)mGlobalColourMapSize * mGlobalColourMapSize * 3;
+		if (mCpuLightmapStorage)
+			total += (size_t)mLightmapSize * mLightmapSize;
+		if (mCpuCompositeMapStorage)
+			total += (size_t)mCompositeMapSize * mCompositeMapSize * 4;
+		uint8 numLayers = getLayerCount();
+		for (size_t i = 0; i < mCpuBlendMapStorage.size(); ++i)
+		{
+			total += PixelUtil::getMemorySize(mLayerBlendMapSize, mLayerBlendMapSize, 1, 
+				getBlendTextureFormat((uint8)i, numLayers));
+		}
+		return total;
+	}
+	//---------------------------------------------------------------------
+	size_t Terrain::getGpuMemoryUsage() const
+	{
+		size_t total = 0;
+		if (mQuadTree)
+			total += mQuadTree->getVertexDataMemoryUsage(true);
+
+		for (TexturePtrList::const_iterator i = mBlendTextureList.begin(); i != mBlendTextureList.end(); ++i)
+			total += (*i)->getSize();
+		if (!mTerrainNormalMap.isNull())
+			total += mTerrainNormalMap->getSize();
+		if (!mColourMap.isNull())
+			total += mColourMap->getSize();
+		if (!mLightmap.isNull())
+			total += mLightmap->getSize();
+		if (!mCompositeMap.isNull())
+			total += mCompositeMap->getSize();
+		return total;
+	}
+	//---------------------------------------------------------------------
 	void Terrain::unprepare()
 	{
 		if (mQuadTree)
@@ -1698,6 +1832,7 @@ namespace Ogre
 		mDirtyGeometryRectForNeighbours.merge(rect);
 		mDirtyDerivedDataRect.merge(rect);
 		mCompositeMapDirtyRect.merge(rect);
+		mHeightPyramid.update(rect);
 
 		mModified = true;
 		mHeightDataModified = true;
@@ -1789,6 +1924,10 @@ namespace Ogre
 			req.typeMask = req.typeMask & ~DERIVED_DATA_NORMALS;
 		if (!mLightMapRequired)
 			req.typeMask = req.typeMask & ~DERIVED_DATA_LIGHTMAP;
+		req.targetBox = 0;
+
+		if (dispatchDerivedDataTiles(req, synchronous))
+			return;
 
 		Root::getSingleton().getWorkQueue()->addRequest(
 			mWorkQueueChannel, WORKQUEUE_DERIVED_DATA_REQUEST, 
@@ -1796,6 +1935,80 @@ namespace Ogre
 
 	}
 	//---------------------------------------------------------------------
+	bool Terrain::dispatchDerivedDataTiles(const DerivedDataRequest& req, bool synchronous)
+	{
+		long tileSize = TerrainGlobalOptions::getSingleton().getDerivedDataTileSize();
+		if (!tileSize)
+			return false;
+
+		// Same order of priority as handleRequest; deltas are never split
+		// since they all feed into the same quadtree nodes
+		DerivedDataResponse res;
+		res.terrain = this;
+		res.remainingTypeMask = req.typeMask & DERIVED_DATA_ALL;
+		res.normalMapBox = 0;
+		res.lightMapBox = 0;
+		uint8 type;
+		Rect area;
+		PixelBox* box;
+		if (req.typeMask & DERIVED_DATA_DELTAS)
+			return false;
+		else if (req.typeMask & DERIVED_DATA_NORMALS)
+		{
+			type = DERIVED_DATA_NORMALS;
+			area = getNormalUpdateRect(req.dirtyRect);
+			if (area.width() <= tileSize && area.height() <= tileSize)
+				return false;
+			uint8* pData = static_cast<uint8*>(
+				OGRE_MALLOC(area.width() * area.height() * 3, MEMCATEGORY_GENERAL));
+			box = OGRE_NEW PixelBox(area.width(), area.height(), 1, PF_BYTE_RGB, pData);
+			res.normalUpdateRect = area;
+			res.normalMapBox = box;
+		}
+		else if (req.typeMask & DERIVED_DATA_LIGHTMAP)
+		{
+			type = DERIVED_DATA_LIGHTMAP;
+			area = getLightmapUpdateRect(req.dirtyRect, req.lightmapExtraDirtyRect);
+			if (area.width() <= tileSize && area.height() <= tileSize)
+				return false;
+			uint8* pData = static_cast<uint8*>(
+				OGRE_MALLOC(area.width() * area.height(), MEMCATEGORY_GENERAL));
+			box = OGRE_NEW PixelBox(area.width(), area.height(), 1, PF_L8, pData);
+			res.lightmapUpdateRect = area;
+			res.lightMapBox = box;
+		}
+		else
+			return false;
+
+		res.remainingTypeMask &= ~type;
+		mTiledDerivedDataRequest = req;
+		mTiledDerivedDataResponse = res;
+
+		// All the tiles must be counted before any of them can respond, since
+		// synchronous requests respond straight away
+		long tilesX = (area.width() + tileSize - 1) / tileSize;
+		long tilesY = (area.height() + tileSize - 1) / tileSize;
+		mDerivedDataTilesPending = static_cast<size_t>(tilesX * tilesY);
+
+		DerivedDataRequest tileReq = req;
+		tileReq.typeMask = type;
+		tileReq.targetBox = box;
+		tileReq.targetRect = area;
+		WorkQueue* wq = Root::getSingleton().getWorkQueue();
+		for (long top = area.top; top < area.bottom; top += tileSize)
+		{
+			for (long left = area.left; left < area.right; left += tileSize)
+			{
+				tileReq.tileRect = Rect(left, top,
+					std::min(left + tileSize, area.right), std::min(top + tileSize, area.bottom));
+				wq->addRequest(mWorkQueueChannel, WORKQUEUE_DERIVED_DATA_REQUEST, 
+					Any(tileReq), 0, synchronous);
+			}
+		}
+
+		return true;
+	}
+	//---------------------------------------------------------------------
 	void Terrain::waitForDerivedProcesses()
 	{
 		while (mDerivedDataUpdateInProgress)
@@ -1811,6 +2024,7 @@ namespace Ogre
 	{
 		OGRE_FREE(mHeightData, MEMCATEGORY_GEOMETRY);
 		mHeightData = 0;
+		mHeightPyramid.clear();
 
 		OGRE_FREE(mDeltaData, MEMCATEGORY_GEOMETRY);
 		mDeltaData = 0;
@@ -2127,6 +2341,11 @@ namespace Ogre
 			// CFactor = A / T
 			Real cFactor = A / T;
 
+			// Serve the requests made last time before the LOD is calculated
+			// again, so nothing which gets evicted is left selected
+			if (mStreamVertexData)
+				getVertexDataStreamer()->_processRequests();
+
 			mQuadTree->calculateCurrentLod(cam, cFactor);
 		}
 	}
@@ -2178,61 +2397,14 @@ namespace Ogre
 		Ray localRay (rayOrigin, rayDirection);
 
 		// test if the ray actually hits the terrain's bounds
-		Real maxHeight = getMaxHeight();
-		Real minHeight = getMinHeight();
-
-		AxisAlignedBox aabb (Vector3(0, minHeight, 0), Vector3(mSize, maxHeight, mSize));
-		std::pair<bool, Real> aabbTest = localRay.intersects(aabb);
-		if (!aabbTest.first)
+		Result result(false, Vector3::ZERO);
+		TerrainHeightPyramid::CellRay cellRay(localRay);
+		int topLevel = mHeightPyramid.getNumLevels() - 1;
+		Real entry, exit;
+		if (!mHeightPyramid.isEmpty() && 
+			mHeightPyramid.intersectsCell(cellRay, topLevel, 0, 0, &entry, &exit))
 		{
-			if (cascadeToNeighbours)
-			{
-				Terrain* neighbour = raySelectNeighbour(ray, distanceLimit);
-				if (neighbour)
-					return neighbour->rayIntersects(ray, cascadeToNeighbours, distanceLimit);
-			}
-			return Result(false, Vector3());
-		}
-		// get intersection point and move inside
-		Vector3 cur = localRay.getPoint(aabbTest.second);
-
-		// now check every quad the ray touches
-		int quadX = std::min(std::max(static_cast<int>(cur.x), 0), (int)mSize-2);
-		int quadZ = std::min(std::max(static_cast<int>(cur.z), 0), (int)mSize-2);
-		int flipX = (rayDirection.x < 0 ? 0 : 1);
-		int flipZ = (rayDirection.z < 0 ? 0 : 1);
-		int xDir = (rayDirection.x < 0 ? -1 : 1);
-		int zDir = (rayDirection.z < 0 ? -1 : 1);
-
-		Result result(true, Vector3::ZERO);
-		Real dummyHighValue = (Real)mSize * 10000.0f;
-
-
-		while (cur.y >= (minHeight - 1e-3) && cur.y <= (maxHeight + 1e-3))
-		{
-			if (quadX < 0 || quadX >= (int)mSize-1 || quadZ < 0 || quadZ >= (int)mSize-1)
-				break;
-
-			result = checkQuadIntersection(quadX, quadZ, localRay);
-			if (result.first)
-				break;
-
-			// determine next quad to test
-			Real xDist = Math::RealEqual(rayDirection.x, 0.0) ? dummyHighValue : 
-				(quadX - cur.x + flipX) / rayDirection.x;
-			Real zDist = Math::RealEqual(rayDirection.z, 0.0) ? dummyHighValue : 
-				(quadZ - cur.z + flipZ) / rayDirection.z;
-			if (xDist < zDist)
-			{
-				quadX += xDir;
-				cur += rayDirection * xDist;
-			}
-			else
-			{
-				quadZ += zDir;
-				cur += rayDirection * zDist;
-			}
-
+			result = checkPyramidIntersection(localRay, cellRay, entry, exit);
 		}
 
 		if (result.first)
@@ -2269,6 +2441,49 @@ namespace Ogre
 		return result;
 	}
 	//---------------------------------------------------------------------
+	std::pair<bool, Vector3> Terrain::checkPyramidIntersection(const Ray& ray, 
+		const TerrainHeightPyramid::CellRay& cellRay, Real start, Real end)
+	{
+		typedef std::pair<bool, Vector3> Result;
+		// Always move on a little, in case rounding puts a point on the edge
+		// it's leaving. A cell which ends behind the point has been clamped to
+		// the edge of the terrain, which means the ray has left it.
+		const Real minStep = 1e-4f;
+		const Real leftTolerance = 1e-3f;
+
+		int topLevel = mHeightPyramid.getNumLevels() - 1;
+		int level = 0;
+		Real t = start;
+		while (t <= end)
+		{
+			long x, z;
+			Real exit;
+			bool inCell = mHeightPyramid.stepCell(cellRay, level, t, &x, &z, &exit);
+			if (exit < t - leftTolerance)
+				break;
+
+			if (!inCell)
+			{
+				// the ray passes over this cell, so try to skip a bigger one next
+				t = std::max(exit, t + minStep);
+				level = std::min(level + 1, topLevel);
+			}
+			else if (level >= 0)
+			{
+				// look closer at the same point
+				--level;
+			}
+			else
+			{
+				Result result = checkQuadIntersection((int)x, (int)z, ray);
+				if (result.first)
+					return result;
+				t = std::max(exit, t + minStep);
+			}
+		}
+		return Result(false, Vector3::ZERO);
+	}
+	//---------------------------------------------------------------------
 	std::pair<bool, Vector3> Terrain::checkQuadIntersection(int x, int z, const Ray& ray)
 	{
 		// build the two planes belonging to the quad's triangles
@@ -2569,7 +2784,7 @@ namespace Ogre
 		return (uint8)mBlendTextureList.size();
 	}
 	//---------------------------------------------------------------------
-	PixelFormat Terrain::getBlendTextureFormat(uint8 textureIndex, uint8 numLayers)
+	PixelFormat Terrain::getBlendTextureFormat(uint8 textureIndex, uint8 numLayers) const
 	{
 		/*
 		if (numLayers - 1 - (textureIndex * 4) > 3)
@@ -2770,7 +2985,8 @@ namespace Ogre
 	//---------------------------------------------------------------------
 	void Terrain::createOrDestroyGPUNormalMap()
 	{
-		if (mNormalMapRequired && mTerrainNormalMap.isNull())
+		// without a texture manager (no render system) there's nothing to create
+		if (mNormalMapRequired && mTerrainNormalMap.isNull() && TextureManager::getSingletonPtr())
 		{
 			// create
 			mTerrainNormalMap = TextureManager::getSingleton().createManual(
@@ -2946,8 +3162,17 @@ namespace Ogre
 		// Do only ONE type of task per background iteration, in order of priority
 		// this means we return faster, can abort faster and we repeat less redundant calcs
 		// we don't do this as separate requests, because we only want one background
-		// task per Terrain instance in flight at once
-		if (ddr.typeMask & DERIVED_DATA_DELTAS)
+		// update per Terrain instance in flight at once; the only exception is
+		// when one type has been split into tiles, which handleResponse joins
+		if (ddr.targetBox)
+		{
+			if (ddr.typeMask & DERIVED_DATA_NORMALS)
+				calculateNormals(ddr.tileRect, ddr.targetRect, ddr.targetBox);
+			else
+				calculateLightmap(ddr.tileRect, ddr.targetRect, ddr.targetBox);
+			ddres.remainingTypeMask &= ~ddr.typeMask;
+		}
+		else if (ddr.typeMask & DERIVED_DATA_DELTAS)
 		{
 			ddres.deltaUpdateRect = calculateHeightDeltas(ddr.dirtyRect);
 			ddres.remainingTypeMask &= ~ DERIVED_DATA_DELTAS;
@@ -2979,6 +3204,15 @@ namespace Ogre
 		if (ddreq.terrain != this)
 			return;
 
+		if (ddreq.targetBox)
+		{
+			// Join the tiles; the last one finalises the whole update
+			if (--mDerivedDataTilesPending)
+				return;
+			ddreq = mTiledDerivedDataRequest;
+			ddres = mTiledDerivedDataResponse;
+		}
+
 		if ((ddreq.typeMask & DERIVED_DATA_DELTAS) && 
 			!(ddres.remainingTypeMask & DERIVED_DATA_DELTAS))
 			finaliseHeightDeltas(ddres.deltaUpdateRect, false);
@@ -3060,21 +3294,43 @@ namespace Ogre
 	}
 	//---------------------------------------------------------------------
 	PixelBox* Terrain::calculateNormals(const Rect &rect, Rect& finalRect)
+	{
+		Rect widenedRect = getNormalUpdateRect(rect);
+		// allocate memory for RGB
+		uint8* pData = static_cast<uint8*>(
+			OGRE_MALLOC(widenedRect.width() * widenedRect.height() * 3, MEMCATEGORY_GENERAL));
+
+		PixelBox* pixbox = OGRE_NEW PixelBox(widenedRect.width(), widenedRect.height(), 1, PF_BYTE_RGB, pData);
+
+		calculateNormals(widenedRect, widenedRect, pixbox);
+
+		finalRect = widenedRect;
+
+		return pixbox;
+	}
+	//---------------------------------------------------------------------
+	Rect Terrain::getNormalUpdateRect(const Rect& rect)
 	{
 		// Widen the rectangle by 1 element in all directions since height
 		// changes affect neighbours normals
-		Rect widenedRect(
+		return Rect(
 			std::max(0L, rect.left - 1L), 
 			std::max(0L, rect.top - 1L), 
 			std::min((long)mSize, rect.right + 1L), 
 			std::min((long)mSize, rect.bottom + 1L)
 			);
-		// allocate memory for RGB
-		uint8* pData = static_cast<uint8*>(
-			OGRE_MALLOC(widenedRect.width() * widenedRect.height() * 3, MEMCATEGORY_GENERAL));
-
-		PixelBox* pixbox = OGRE_NEW PixelBox(widenedRect.width(), widenedRect.height(), 1, PF_BYTE_RGB, pData);
-
+	}
+	//---------------------------------------------------------------------
+	static uint8* encodeNormal(const Vector3& normal, uint8* pStore)
+	{
+		*pStore++ = static_cast<uint8>((normal.x + 1.0f) * 0.5f * 255.0f);
+		*pStore++ = static_cast<uint8>((normal.y + 1.0f) * 0.5f * 255.0f);
+		*pStore++ = static_cast<uint8>((normal.z + 1.0f) * 0.5f * 255.0f);
+		return pStore;
+	}
+	//---------------------------------------------------------------------
+	void Terrain::calculateNormals(const Rect& rect, const Rect& boxRect, PixelBox* box)
+	{
 		// Evaluate normal like this
 		//  3---2---1
 		//  | \ | / |
@@ -3082,12 +3338,41 @@ namespace Ogre
 		//  | / | \ |
 		//	5---6---7
 
+		// Away from the edges all of those points are in our own height data,
+		// so those runs of each row can be done by the optimised version
+		long innerLeft = std::max(1L, rect.left);
+		long innerRight = std::min((long)mSize - 1, rect.right);
+		vector<float>::type innerNormals(std::max(0L, innerRight - innerLeft) * 3);
+		OptimisedUtil* util = OptimisedUtil::getImplementation();
+
+		uint8* pData = static_cast<uint8*>(box->data);
 		Plane plane;
-		for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+		for (long y = rect.top; y < rect.bottom; ++y)
 		{
-			for (long x = widenedRect.left; x < widenedRect.right; ++x)
+			// encode as RGB, object space
+			// invert the Y to deal with image space
+			uint8* pStore = pData + 
+				(((boxRect.bottom - y - 1) * boxRect.width()) + rect.left - boxRect.left) * 3;
+			bool innerRow = y > 0 && y < (long)mSize - 1 && innerLeft < innerRight;
+
+			for (long x = rect.left; x < rect.right; )
 			{
-				Vector3 cumulativeNormal = Vector3::ZERO;
+				Vector3 cumulativeNormal;
+				if (innerRow && x == innerLeft)
+				{
+					// the optimised version works in terrain space
+					util->calculateHeightfieldNormals(getHeightData(x, y), mSize, mScale,
+						&innerNormals[0], innerRight - innerLeft);
+					for (const float* pNormal = &innerNormals[0]; x < innerRight; ++x, pNormal += 3)
+					{
+						convertTerrainToWorldAxes(mAlign, 
+							Vector3(pNormal[0], pNormal[1], pNormal[2]), &cumulativeNormal);
+						pStore = encodeNormal(cumulativeNormal, pStore);
+					}
+					continue;
+				}
+
+				cumulativeNormal = Vector3::ZERO;
 
 				// Build points to sample
 				Vector3 centrePoint;
@@ -3110,24 +3395,10 @@ namespace Ogre
 
 				// normalise & store normal
 				cumulativeNormal.normalise();
-
-				// encode as RGB, object space
-				// invert the Y to deal with image space
-				long storeX = x - widenedRect.left;
-				long storeY = widenedRect.bottom - y - 1;
-
-				uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
-				*pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
-				*pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
-				*pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
-
-
+				pStore = encodeNormal(cumulativeNormal, pStore);
+				++x;
 			}
 		}
-
-		finalRect = widenedRect;
-
-		return pixbox;
 	}
 	//---------------------------------------------------------------------
 	void Terrain::finaliseNormals(const Ogre::Rect &rect, Ogre::PixelBox *normalsBox)
@@ -3222,6 +3493,22 @@ namespace Ogre
 	}
 	//---------------------------------------------------------------------
 	PixelBox* Terrain::calculateLightmap(const Rect& rect, const Rect& extraTargetRect, Rect& outFinalRect)
+	{
+		Rect widenedRect = getLightmapUpdateRect(rect, extraTargetRect);
+		outFinalRect = widenedRect;
+
+		// allocate memory (L8)
+		uint8* pData = static_cast<uint8*>(
+			OGRE_MALLOC(widenedRect.width() * widenedRect.height(), MEMCATEGORY_GENERAL));
+
+		PixelBox* pixbox = OGRE_NEW PixelBox(widenedRect.width(), widenedRect.height(), 1, PF_L8, pData);
+
+		calculateLightmap(widenedRect, widenedRect, pixbox);
+
+		return pixbox;
+	}
+	//---------------------------------------------------------------------
+	Rect Terrain::getLightmapUpdateRect(const Rect& rect, const Rect& extraTargetRect)
 	{
 		// as well as calculating the lighting changes for the area that is
 		// dirty, we also need to calculate the effect on casting shadow on
@@ -3250,19 +3537,19 @@ namespace Ogre
 		widenedRect.right = std::min((long)mLightmapSizeActual, widenedRect.right);
 		widenedRect.bottom = std::min((long)mLightmapSizeActual, widenedRect.bottom);
 
-		outFinalRect = widenedRect;
-
-		// allocate memory (L8)
-		uint8* pData = static_cast<uint8*>(
-			OGRE_MALLOC(widenedRect.width() * widenedRect.height(), MEMCATEGORY_GENERAL));
-
-		PixelBox* pixbox = OGRE_NEW PixelBox(widenedRect.width(), widenedRect.height(), 1, PF_L8, pData);
+		return widenedRect;
+	}
+	//---------------------------------------------------------------------
+	void Terrain::calculateLightmap(const Rect& rect, const Rect& boxRect, PixelBox* box)
+	{
+		const Vector3& lightVec = TerrainGlobalOptions::getSingleton().getLightMapDirection();
+		uint8* pData = static_cast<uint8*>(box->data);
 
 		Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
 
-		for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+		for (long y = rect.top; y < rect.bottom; ++y)
 		{
-			for (long x = widenedRect.left; x < widenedRect.right; ++x)
+			for (long x = rect.left; x < rect.right; ++x)
 			{
 				float litVal = 1.0f;
 
@@ -3287,18 +3574,15 @@ namespace Ogre
 
 				// encode as L8
 				// invert the Y to deal with image space
-				long storeX = x - widenedRect.left;
-				long storeY = widenedRect.bottom - y - 1;
+				long storeX = x - boxRect.left;
+				long storeY = boxRect.bottom - y - 1;
 
-				uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX);
+				uint8* pStore = pData + ((storeY * boxRect.width()) + storeX);
 				*pStore = (unsigned char)(litVal * 255.0);
 
 			}
 		}
 
-		return pixbox;
-
-
 	}
 	//---------------------------------------------------------------------
 	void Terrain::finaliseLightmap(const Rect& rect, PixelBox* lightmapBox)
@@ -4065,6 +4349,26 @@ namespace Ogre
 			return &mDefaultGpuBufferAllocator;
 	}
 	//---------------------------------------------------------------------
+	void Terrain::setVertexDataStreamer(VertexDataStreamer* streamer)
+	{
+		if (streamer != getVertexDataStreamer())
+		{
+			if (isLoaded())
+				OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+				"Cannot alter the vertex data streamer when loaded!", __FUNCTION__);
+
+			mCustomVertexDataStreamer = streamer;
+		}
+	}
+	//---------------------------------------------------------------------
+	Terrain::VertexDataStreamer* Terrain::getVertexDataStreamer()
+	{
+		if (mCustomVertexDataStreamer)
+			return mCustomVertexDataStreamer;
+		else
+			return &mDefaultVertexDataStreamer;
+	}
+	//---------------------------------------------------------------------
 	size_t Terrain::getPositionBufVertexSize() const
 	{
 		size_t sz = 0;
@@ -4300,6 +4604,7 @@ namespace Ogre
 
 			mQuadTree = OGRE_NEW TerrainQuadTreeNode(this, 0, 0, 0, mSize, mNumLodLevels - 1, 0, 0);
 			mQuadTree->prepare();
+			mHeightPyramid.build(mHeightData, mSize);
 
 			// calculate entire terrain
 			Rect rect;
@@ -4322,6 +4627,8 @@ namespace Ogre
 	//---------------------------------------------------------------------
 	//---------------------------------------------------------------------
 	Terrain::DefaultGpuBufferAllocator::DefaultGpuBufferAllocator()
+		: mFreeBufferMemory(0)
+		, mMaxFreeBufferMemory(0)
 	{
 
 	}
@@ -4349,6 +4656,7 @@ namespace Ogre
 			{
 				HardwareVertexBufferSharedPtr ret = *i;
 				list.erase(i);
+				mFreeBufferMemory -= sz;
 				return ret;
 			}
 		}
@@ -4364,6 +4672,10 @@ namespace Ogre
 	{
 		mFreePosBufList.push_back(posbuf);
 		mFreeDeltaBufList.push_back(deltabuf);
+		mFreeBufferMemory += posbuf->getSizeInBytes() + deltabuf->getSizeInBytes();
+
+		if (mMaxFreeBufferMemory)
+			trimFreeBuffers(mMaxFreeBufferMemory);
 	}
 	//---------------------------------------------------------------------
 	HardwareIndexBufferSharedPtr Terrain::DefaultGpuBufferAllocator::getSharedIndexBuffer(uint16 batchSize, 
@@ -4397,9 +4709,36 @@ namespace Ogre
 	{
 		mFreePosBufList.clear();
 		mFreeDeltaBufList.clear();
+		mFreeBufferMemory = 0;
 		mSharedIBufMap.clear();
 	}
 	//---------------------------------------------------------------------
+	void Terrain::DefaultGpuBufferAllocator::setMaxFreeBufferMemory(size_t bytes)
+	{
+		mMaxFreeBufferMemory = bytes;
+		if (mMaxFreeBufferMemory)
+			trimFreeBuffers(mMaxFreeBufferMemory);
+	}
+	//---------------------------------------------------------------------
+	void Terrain::DefaultGpuBufferAllocator::trimFreeBuffers(size_t maxBytes)
+	{
+		// buffers are freed in pairs, so release from the front of both lists
+		while (mFreeBufferMemory > maxBytes && 
+			(!mFreePosBufList.empty() || !mFreeDeltaBufList.empty()))
+		{
+			if (!mFreePosBufList.empty())
+			{
+				mFreeBufferMemory -= mFreePosBufList.front()->getSizeInBytes();
+				mFreePosBufList.pop_front();
+			}
+			if (!mFreeDeltaBufList.empty())
+			{
+				mFreeBufferMemory -= mFreeDeltaBufList.front()->getSizeInBytes();
+				mFreeDeltaBufList.pop_front();
+			}
+		}
+	}
+	//---------------------------------------------------------------------
 	void Terrain::DefaultGpuBufferAllocator::warmStart(size_t numInstances, uint16 terrainSize, uint16 maxBatchSize, 
 		uint16 mMinBatchSize)
 	{
@@ -4422,6 +4761,180 @@ namespace Ogre
 		return ret;
 
 	}
+	//---------------------------------------------------------------------
+	//---------------------------------------------------------------------
+	namespace
+	{
+		struct ShallowerNode
+		{
+			bool operator()(const TerrainQuadTreeNode* a, const TerrainQuadTreeNode* b) const
+			{
+				return a->getDepth() < b->getDepth();
+			}
+		};
+
+		struct CloserNode
+		{
+			bool operator()(const TerrainQuadTreeNode* a, const TerrainQuadTreeNode* b) const
+			{
+				return a->getVertexDataDistance() < b->getVertexDataDistance();
+			}
+		};
+
+		bool isAncestor(const TerrainQuadTreeNode* ancestor, const TerrainQuadTreeNode* node)
+		{
+			for (node = node->getParent(); node; node = node->getParent())
+			{
+				if (node == ancestor)
+					return true;
+			}
+			return false;
+		}
+	}
+	//---------------------------------------------------------------------
+	Terrain::VertexDataStreamer::VertexDataStreamer()
+		: mMemoryBudget(0)
+		, mMaxLoadsPerFrame(0)
+		, mLoadsThisFrame(0)
+		, mCurrentFrame(0)
+	{
+	}
+	//---------------------------------------------------------------------
+	Terrain::VertexDataStreamer::~VertexDataStreamer()
+	{
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::resetStatistics()
+	{
+		mStatistics.loadCount = 0;
+		mStatistics.evictionCount = 0;
+		mStatistics.deferredCount = 0;
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::evictAll()
+	{
+		// finest first, so that no data outlives the data it refines
+		while (!mResident.empty())
+		{
+			NodeList::iterator deepest = std::max_element(
+				mResident.begin(), mResident.end(), ShallowerNode());
+			evict(*deepest);
+		}
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::_requestLoad(TerrainQuadTreeNode* node)
+	{
+		if (std::find(mRequests.begin(), mRequests.end(), node) == mRequests.end())
+			mRequests.push_back(node);
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::_processRequests()
+	{
+		if (mRequests.empty())
+			return;
+
+		unsigned long frame = Root::getSingleton().getNextFrameNumber();
+		if (frame != mCurrentFrame)
+		{
+			mCurrentFrame = frame;
+			mLoadsThisFrame = 0;
+		}
+
+		std::stable_sort(mRequests.begin(), mRequests.end(), CloserNode());
+		for (NodeList::iterator i = mRequests.begin(); i != mRequests.end(); ++i)
+		{
+			TerrainQuadTreeNode* node = *i;
+			if (node->isVertexDataAvailable())
+				continue;
+
+			size_t bytes = node->getVertexDataMemorySize();
+			if ((mMaxLoadsPerFrame && mLoadsThisFrame >= mMaxLoadsPerFrame) ||
+				!makeRoom(bytes, node->getVertexDataDistance()))
+			{
+				// try again when it's requested next
+				++mStatistics.deferredCount;
+				continue;
+			}
+
+			node->loadVertexData();
+			mResident.push_back(node);
+			++mStatistics.residentCount;
+			mStatistics.residentBytes += bytes;
+			++mStatistics.loadCount;
+			++mLoadsThisFrame;
+		}
+		mRequests.clear();
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::_notifyUnloaded(TerrainQuadTreeNode* node)
+	{
+		NodeList::iterator i = std::find(mResident.begin(), mResident.end(), node);
+		if (i != mResident.end())
+		{
+			mResident.erase(i);
+			--mStatistics.residentCount;
+			mStatistics.residentBytes -= node->getVertexDataMemorySize();
+		}
+		i = std::find(mRequests.begin(), mRequests.end(), node);
+		if (i != mRequests.end())
+			mRequests.erase(i);
+	}
+	//---------------------------------------------------------------------
+	bool Terrain::VertexDataStreamer::makeRoom(size_t bytes, Real distance)
+	{
+		if (!mMemoryBudget)
+			return true;
+
+		while (mStatistics.residentBytes + bytes > mMemoryBudget)
+		{
+			// least recently used, then furthest away, then finest
+			// data rendered in this frame by a terrain sharing this is never chosen
+			TerrainQuadTreeNode* lru = 0;
+			for (NodeList::iterator i = mResident.begin(); i != mResident.end(); ++i)
+			{
+				TerrainQuadTreeNode* node = *i;
+				unsigned long lastUsed = node->getVertexDataLastUsedFrame();
+				if (lastUsed >= mCurrentFrame)
+					continue;
+				if (!lru)
+				{
+					lru = node;
+					continue;
+				}
+				unsigned long lruLastUsed = lru->getVertexDataLastUsedFrame();
+				Real lruDistance = lru->getVertexDataDistance();
+				if (lastUsed < lruLastUsed ||
+					(lastUsed == lruLastUsed && node->getVertexDataDistance() > lruDistance) ||
+					(lastUsed == lruLastUsed && node->getVertexDataDistance() == lruDistance && 
+						node->getDepth() > lru->getDepth()))
+					lru = node;
+			}
+
+			// data rendered in the last frame only makes way for closer data
+			if (!lru || (lru->getVertexDataLastUsedFrame() + 1 >= mCurrentFrame && 
+				lru->getVertexDataDistance() <= distance))
+				return false;
+
+			evict(lru);
+		}
+		return true;
+	}
+	//---------------------------------------------------------------------
+	void Terrain::VertexDataStreamer::evict(TerrainQuadTreeNode* node)
+	{
+		// finer data can't be rendered without this, so it goes too
+		for (size_t i = 0; i < mResident.size(); )
+		{
+			if (isAncestor(node, mResident[i]))
+				evict(mResident[i]);
+			else
+				++i;
+		}
+
+		++mStatistics.evictionCount;
+		// notifies us, which updates the residency
+		node->unloadVertexData();
+	}
 
 
 
@@ -0,0 +1,343 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreTerrainCompression.h"
+#include "OgreException.h"
+#include "OgreMath.h"
+
+namespace Ogre
+{
+	const uint32 TerrainCompression::HEIGHTLEVEL_CHUNK_ID = StreamSerialiser::makeIdentifier("THLV");
+	const uint16 TerrainCompression::HEIGHTLEVEL_CHUNK_VERSION = 1;
+
+	namespace
+	{
+		typedef vector<uint8>::type ByteList;
+
+		inline int32 quantise(float value, float invPrecision)
+		{
+			return static_cast<int32>(Math::Floor(value * invPrecision + 0.5f));
+		}
+
+		/// Zig-zag encode so small negative numbers are small too, then 7 bits per byte
+		void writeVarInt(int32 value, ByteList& bytes)
+		{
+			uint32 bits = static_cast<uint32>(value) << 1;
+			if (value < 0)
+				bits = ~bits;
+			while (bits >= 0x80)
+			{
+				bytes.push_back(static_cast<uint8>(bits | 0x80));
+				bits >>= 7;
+			}
+			bytes.push_back(static_cast<uint8>(bits));
+		}
+
+		int32 readVarInt(const uint8*& pos, const uint8* end)
+		{
+			uint32 bits = 0;
+			for (int shift = 0; ; shift += 7)
+			{
+				if (pos == end || shift > 28)
+				{
+					OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+						"Compressed terrain data is corrupt", "TerrainCompression::readVarInt");
+				}
+				uint8 b = *pos++;
+				bits |= static_cast<uint32>(b & 0x7F) << shift;
+				if (!(b & 0x80))
+					break;
+			}
+			return static_cast<int32>((bits & 1) ? ~(bits >> 1) : (bits >> 1));
+		}
+
+		void writeVarInts(StreamSerialiser& stream, const ByteList& bytes)
+		{
+			uint32 numBytes = static_cast<uint32>(bytes.size());
+			stream.write(&numBytes);
+			if (numBytes)
+				stream.writeCompressedData(&bytes[0], numBytes);
+		}
+
+		void readVarInts(StreamSerialiser& stream, ByteList& bytes, size_t maxBytes)
+		{
+			uint32 numBytes;
+			stream.read(&numBytes);
+			if (numBytes > maxBytes)
+			{
+				OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+					"Compressed terrain data is corrupt", "TerrainCompression::readVarInts");
+			}
+			bytes.resize(numBytes);
+			if (numBytes)
+				stream.readCompressedData(&bytes[0], numBytes);
+		}
+
+		/// Height of a vertex as a multiple of the precision
+		inline int64 quantisedHeight(const float* heights, uint16 size, long x, long y, 
+			float invPrecision)
+		{
+			return quantise(heights[y * size + x], invPrecision);
+		}
+
+		/** The prediction of a height in the given level from the coarser ones,
+			as a multiple of the precision.
+		@remarks
+			Only ever uses heights that have been read already, so reading can
+			make exactly the same prediction as writing.
+		*/
+		int32 predictHeight(const float* heights, uint16 size, long x, long y, 
+			long step, bool coarsest, float invPrecision)
+		{
+			if (coarsest)
+			{
+				// the previous vertex along the row, or up the first column
+				if (x)
+					return quantise(heights[y * size + x - step], invPrecision);
+				else if (y)
+					return quantise(heights[(y - step) * size], invPrecision);
+				else
+					return 0;
+			}
+
+			// Between the vertices of the next level up, either along a row,
+			// down a column or in the middle of 4
+			bool midX = (x / step) & 1;
+			bool midY = (y / step) & 1;
+			int64 sum;
+			if (midX && midY)
+			{
+				sum = quantisedHeight(heights, size, x - step, y - step, invPrecision) +
+					quantisedHeight(heights, size, x + step, y - step, invPrecision) +
+					quantisedHeight(heights, size, x - step, y + step, invPrecision) +
+					quantisedHeight(heights, size, x + step, y + step, invPrecision);
+				return static_cast<int32>(sum / 4);
+			}
+			else if (midX)
+			{
+				sum = quantisedHeight(heights, size, x - step, y, invPrecision) +
+					quantisedHeight(heights, size, x + step, y, invPrecision);
+			}
+			else
+			{
+				sum = quantisedHeight(heights, size, x, y - step, invPrecision) +
+					quantisedHeight(heights, size, x, y + step, invPrecision);
+			}
+			return static_cast<int32>(sum / 2);
+		}
+
+		/// Whether a vertex on the grid of a level belongs to it rather than a coarser level
+		inline bool isInLevel(long x, long y, long step, bool coarsest)
+		{
+			return coarsest || ((x / step) & 1) || ((y / step) & 1);
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::writeHeights(StreamSerialiser& stream, const float* heights, 
+		uint16 size, uint16 numLevels, Real precision)
+	{
+		// Predictions must come from the heights as they'll be read back,
+		// not the originals
+		float fPrecision = static_cast<float>(precision);
+		float invPrecision = 1.0f / fPrecision;
+		size_t numVertices = (size_t)size * size;
+		vector<int32>::type quantised(numVertices);
+		vector<float>::type stored(numVertices);
+		for (size_t i = 0; i < numVertices; ++i)
+		{
+			quantised[i] = quantise(heights[i], invPrecision);
+			stored[i] = quantised[i] * fPrecision;
+		}
+
+		ByteList bytes;
+		for (long level = numLevels - 1; level >= 0; --level)
+		{
+			long step = 1L << level;
+			bool coarsest = level == numLevels - 1;
+			bytes.clear();
+			for (long y = 0; y < size; y += step)
+			{
+				for (long x = 0; x < size; x += step)
+				{
+					if (isInLevel(x, y, step, coarsest))
+					{
+						int32 prediction = predictHeight(&stored[0], size, x, y, step, coarsest, invPrecision);
+						writeVarInt(quantised[y * size + x] - prediction, bytes);
+					}
+				}
+			}
+
+			uint16 level16 = static_cast<uint16>(level);
+			stream.writeChunkBegin(HEIGHTLEVEL_CHUNK_ID, HEIGHTLEVEL_CHUNK_VERSION);
+			stream.write(&level16);
+			stream.write(&numLevels);
+			stream.write(&precision);
+			writeVarInts(stream, bytes);
+			stream.writeChunkEnd(HEIGHTLEVEL_CHUNK_ID);
+		}
+	}
+	//---------------------------------------------------------------------
+	bool TerrainCompression::readHeightLevel(StreamSerialiser& stream, float* heights, 
+		uint16 size, uint16* outLevel)
+	{
+		if (!stream.readChunkBegin(HEIGHTLEVEL_CHUNK_ID, HEIGHTLEVEL_CHUNK_VERSION))
+			return false;
+
+		uint16 level, numLevels;
+		Real precision;
+		stream.read(&level);
+		stream.read(&numLevels);
+		stream.read(&precision);
+		if (level >= numLevels || numLevels > 16 || (size - 1) % (1 << (numLevels - 1)) ||
+			!(precision > 0))
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Compressed terrain heights don't match the terrain", 
+				"TerrainCompression::readHeightLevel");
+		}
+
+		// No height takes more than 5 bytes
+		ByteList bytes;
+		readVarInts(stream, bytes, (size_t)size * size * 5);
+		const uint8* pos = bytes.empty() ? 0 : &bytes[0];
+		const uint8* end = pos + bytes.size();
+
+		float fPrecision = static_cast<float>(precision);
+		float invPrecision = 1.0f / fPrecision;
+		long step = 1L << level;
+		bool coarsest = level == numLevels - 1;
+		for (long y = 0; y < size; y += step)
+		{
+			for (long x = 0; x < size; x += step)
+			{
+				if (isInLevel(x, y, step, coarsest))
+				{
+					int32 prediction = predictHeight(heights, size, x, y, step, coarsest, invPrecision);
+					heights[y * size + x] = (prediction + readVarInt(pos, end)) * fPrecision;
+				}
+			}
+		}
+
+		stream.readChunkEnd(HEIGHTLEVEL_CHUNK_ID);
+
+		if (outLevel)
+			*outLevel = level;
+		return true;
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::interpolateHeights(float* heights, uint16 size, uint16 level)
+	{
+		for (long finer = (long)level - 1; finer >= 0; --finer)
+		{
+			long step = 1L << finer;
+			for (long y = 0; y < size; y += step)
+			{
+				for (long x = 0; x < size; x += step)
+				{
+					bool midX = (x / step) & 1;
+					bool midY = (y / step) & 1;
+					float* pHeight = heights + y * size + x;
+					if (midX && midY)
+					{
+						*pHeight = (pHeight[-step * size - step] + pHeight[-step * size + step] +
+							pHeight[step * size - step] + pHeight[step * size + step]) * 0.25f;
+					}
+					else if (midX)
+						*pHeight = (pHeight[-step] + pHeight[step]) * 0.5f;
+					else if (midY)
+						*pHeight = (pHeight[-step * size] + pHeight[step * size]) * 0.5f;
+				}
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::writeImage(StreamSerialiser& stream, const uint8* data, 
+		size_t width, size_t height, size_t bytesPerPixel)
+	{
+		// Each byte becomes the difference from the same channel of the pixel 
+		// to its left, or above it at the start of a row
+		size_t rowSize = width * bytesPerPixel;
+		size_t dataSize = rowSize * height;
+		if (!dataSize)
+			return;
+		ByteList differences(dataSize);
+		for (size_t i = 0; i < dataSize; ++i)
+		{
+			uint8 prediction = 0;
+			if (i % rowSize >= bytesPerPixel)
+				prediction = data[i - bytesPerPixel];
+			else if (i >= rowSize)
+				prediction = data[i - rowSize];
+			differences[i] = static_cast<uint8>(data[i] - prediction);
+		}
+		stream.writeCompressedData(&differences[0], dataSize);
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::readImage(StreamSerialiser& stream, uint8* data, 
+		size_t width, size_t height, size_t bytesPerPixel)
+	{
+		size_t rowSize = width * bytesPerPixel;
+		size_t dataSize = rowSize * height;
+		if (!dataSize)
+			return;
+		stream.readCompressedData(data, dataSize);
+		for (size_t i = 0; i < dataSize; ++i)
+		{
+			if (i % rowSize >= bytesPerPixel)
+				data[i] = static_cast<uint8>(data[i] + data[i - bytesPerPixel]);
+			else if (i >= rowSize)
+				data[i] = static_cast<uint8>(data[i] + data[i - rowSize]);
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::writeQuantised(StreamSerialiser& stream, const float* values, 
+		size_t count, Real precision)
+	{
+		float invPrecision = 1.0f / static_cast<float>(precision);
+		ByteList bytes;
+		bytes.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			writeVarInt(quantise(values[i], invPrecision), bytes);
+
+		stream.write(&precision);
+		writeVarInts(stream, bytes);
+	}
+	//---------------------------------------------------------------------
+	void TerrainCompression::readQuantised(StreamSerialiser& stream, float* values, size_t count)
+	{
+		Real precision;
+		stream.read(&precision);
+		ByteList bytes;
+		readVarInts(stream, bytes, count * 5);
+		const uint8* pos = bytes.empty() ? 0 : &bytes[0];
+		const uint8* end = pos + bytes.size();
+		float fPrecision = static_cast<float>(precision);
+		for (size_t i = 0; i < count; ++i)
+			values[i] = readVarInt(pos, end) * fPrecision;
+	}
+
+}
@@ -46,6 +46,8 @@ namespace Ogre
 		, mFilenamePrefix("terrain")
 		, mFilenameExtension("dat")
 		, mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
+		, mMemoryBudget(0)
+		, mEvictionCount(0)
 	{
 		mDefaultImportData.terrainAlign = align;
 		mDefaultImportData.terrainSize = terrainSize;
@@ -70,6 +72,8 @@ namespace Ogre
 		, mFilenamePrefix("terrain")
 		, mFilenameExtension("dat")
 		, mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
+		, mMemoryBudget(0)
+		, mEvictionCount(0)
 	{
 		mDefaultImportData.terrainAlign = mAlignment;
 		mDefaultImportData.terrainSize = 0;
@@ -285,6 +289,8 @@ namespace Ogre
 			slot->instance->setResourceGroup(mResourceGroup);
 			// Use shared pool of buffers
 			slot->instance->setGpuBufferAllocator(&mBufferAllocator);
+			// Share a budget for streamed vertex data
+			slot->instance->setVertexDataStreamer(&mVertexDataStreamer);
 
 			LoadRequest req;
 			req.slot = slot;
@@ -305,6 +311,80 @@ namespace Ogre
 		}
 
 
+	}
+	//---------------------------------------------------------------------
+	void TerrainGroup::setMemoryBudget(size_t bytes)
+	{
+		mMemoryBudget = bytes;
+		applyMemoryBudget();
+	}
+	//---------------------------------------------------------------------
+	bool TerrainGroup::isEvictable(const TerrainSlot* slot) const
+	{
+		Terrain* t = slot->instance;
+		if (!t || !t->isLoaded() || t->isModified() || slot->def.filename.empty())
+			return false;
+
+		// keep anything which was in view in this frame or the last
+		return t->getLastVisibleFrame() + 1 < Root::getSingleton().getNextFrameNumber();
+	}
+	//---------------------------------------------------------------------
+	void TerrainGroup::applyMemoryBudget()
+	{
+		if (!mMemoryBudget)
+			return;
+
+		typedef std::pair<unsigned long, TerrainSlot*> Candidate;
+		vector<Candidate>::type candidates;
+		size_t used = 0;
+		for (TerrainSlotMap::iterator i = mTerrainSlots.begin(); i != mTerrainSlots.end(); ++i)
+		{
+			TerrainSlot* slot = i->second;
+			if (slot->instance && slot->instance->isLoaded())
+			{
+				used += slot->instance->getCpuMemoryUsage() + slot->instance->getGpuMemoryUsage();
+				if (isEvictable(slot))
+					candidates.push_back(Candidate(slot->instance->getLastVisibleFrame(), slot));
+			}
+		}
+
+		// least recently visible first
+		std::stable_sort(candidates.begin(), candidates.end());
+		for (vector<Candidate>::type::iterator i = candidates.begin(); 
+			i != candidates.end() && used > mMemoryBudget; ++i)
+		{
+			Terrain* t = i->second->instance;
+			used -= t->getCpuMemoryUsage() + t->getGpuMemoryUsage();
+
+			// neighbours must not keep pointing at it
+			for (int n = 0; n < Terrain::NEIGHBOUR_COUNT; ++n)
+				t->setNeighbour((Terrain::NeighbourIndex)n, 0);
+
+			// destroying the instance frees both GPU & CPU resources
+			i->second->freeInstance();
+			++mEvictionCount;
+		}
+
+		// the evicted vertex buffers went to the pool, only keep what fits
+		mBufferAllocator.trimFreeBuffers(mMemoryBudget > used ? mMemoryBudget - used : 0);
+	}
+	//---------------------------------------------------------------------
+	TerrainGroup::ResidencyStatistics TerrainGroup::getResidencyStatistics() const
+	{
+		ResidencyStatistics stats;
+		for (TerrainSlotMap::const_iterator i = mTerrainSlots.begin(); i != mTerrainSlots.end(); ++i)
+		{
+			const Terrain* t = i->second->instance;
+			if (t && t->isLoaded())
+			{
+				++stats.loadedCount;
+				stats.cpuMemory += t->getCpuMemoryUsage();
+				stats.gpuMemory += t->getGpuMemoryUsage();
+			}
+		}
+		stats.freeBufferMemory = mBufferAllocator.getFreeBufferMemory();
+		stats.evictionCount = mEvictionCount;
+		return stats;
 	}
 	//---------------------------------------------------------------------
 	void TerrainGroup::removeTerrain(long x, long y)
@@ -655,6 +735,8 @@ namespace Ogre
 					}
 
 				}
+
+				applyMemoryBudget();
 			}
 		}
 		else
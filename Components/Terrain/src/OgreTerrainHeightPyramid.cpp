@@ -0,0 +1,250 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreTerrainHeightPyramid.h"
+
+namespace Ogre
+{
+	namespace
+	{
+		/// Margin around cells, matching the tolerance of the quad intersection test
+		const Real CELL_MARGIN = 0.01f;
+		const Real HEIGHT_MARGIN = 1e-3f;
+
+		/// Narrow [tNear, tFar] to where the ray is within [lo, hi] on one axis
+		inline bool clipAxis(Real origin, Real invDir, bool parallel, Real lo, Real hi, 
+			Real& tNear, Real& tFar)
+		{
+			if (parallel)
+				return origin >= lo && origin <= hi;
+
+			Real t1 = (lo - origin) * invDir;
+			Real t2 = (hi - origin) * invDir;
+			if (t1 > t2)
+				std::swap(t1, t2);
+			if (t1 > tNear)
+				tNear = t1;
+			if (t2 < tFar)
+				tFar = t2;
+			return tNear <= tFar;
+		}
+	}
+	//---------------------------------------------------------------------
+	TerrainHeightPyramid::TerrainHeightPyramid()
+		: mHeights(0)
+		, mSize(0)
+	{
+	}
+	//---------------------------------------------------------------------
+	TerrainHeightPyramid::~TerrainHeightPyramid()
+	{
+	}
+	//---------------------------------------------------------------------
+	void TerrainHeightPyramid::build(const float* heights, uint16 size)
+	{
+		clear();
+		if (!heights || size < 2)
+			return;
+
+		mHeights = heights;
+		mSize = size;
+
+		// add levels until one cell covers everything
+		for (int level = 0; ; ++level)
+		{
+			Level l;
+			l.width = getLevelWidth(level);
+			l.bounds.resize(l.width * l.width * 2);
+			mLevels.push_back(l);
+			if (l.width == 1)
+				break;
+		}
+
+		update(Rect(0, 0, size, size));
+	}
+	//---------------------------------------------------------------------
+	void TerrainHeightPyramid::update(const Rect& rect)
+	{
+		if (isEmpty() || rect.isNull())
+			return;
+
+		// a vertex belongs to the quads either side of it
+		long lastQuad = (long)mSize - 2;
+		long left = std::max(rect.left - 1, 0L);
+		long top = std::max(rect.top - 1, 0L);
+		long right = std::min(rect.right - 1, lastQuad);
+		long bottom = std::min(rect.bottom - 1, lastQuad);
+		if (left > right || top > bottom)
+			return;
+
+		for (int level = 0; level < (int)mLevels.size(); ++level)
+		{
+			left >>= 1; top >>= 1; right >>= 1; bottom >>= 1;
+			updateLevel(level, left, top, right, bottom);
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainHeightPyramid::updateLevel(int level, long left, long top, long right, long bottom)
+	{
+		Level& l = mLevels[level];
+		long childWidth = getLevelWidth(level - 1);
+		for (long z = top; z <= bottom; ++z)
+		{
+			float* pBounds = &l.bounds[(z * l.width + left) * 2];
+			for (long x = left; x <= right; ++x)
+			{
+				float minHeight = std::numeric_limits<float>::max();
+				float maxHeight = -std::numeric_limits<float>::max();
+				long childRight = std::min(x * 2 + 2, childWidth);
+				long childBottom = std::min(z * 2 + 2, childWidth);
+				for (long cz = z * 2; cz < childBottom; ++cz)
+				{
+					for (long cx = x * 2; cx < childRight; ++cx)
+					{
+						float cmin, cmax;
+						getCellBounds(level - 1, cx, cz, &cmin, &cmax);
+						minHeight = std::min(minHeight, cmin);
+						maxHeight = std::max(maxHeight, cmax);
+					}
+				}
+				*pBounds++ = minHeight;
+				*pBounds++ = maxHeight;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainHeightPyramid::clear()
+	{
+		mLevels.clear();
+		mHeights = 0;
+		mSize = 0;
+	}
+	//---------------------------------------------------------------------
+	long TerrainHeightPyramid::getLevelWidth(int level) const
+	{
+		long numQuads = (long)mSize - 1;
+		long span = 1L << (level + 1);
+		return (numQuads + span - 1) / span;
+	}
+	//---------------------------------------------------------------------
+	void TerrainHeightPyramid::getCellBounds(int level, long x, long z, 
+		float* minHeight, float* maxHeight) const
+	{
+		if (level < 0)
+		{
+			const float* pRow = mHeights + z * mSize + x;
+			*minHeight = std::min(std::min(pRow[0], pRow[1]), std::min(pRow[mSize], pRow[mSize + 1]));
+			*maxHeight = std::max(std::max(pRow[0], pRow[1]), std::max(pRow[mSize], pRow[mSize + 1]));
+		}
+		else
+		{
+			const Level& l = mLevels[level];
+			const float* pBounds = &l.bounds[(z * l.width + x) * 2];
+			*minHeight = pBounds[0];
+			*maxHeight = pBounds[1];
+		}
+	}
+	//---------------------------------------------------------------------
+	TerrainHeightPyramid::CellRay::CellRay(const Ray& ray)
+		: origin(ray.getOrigin())
+		, dir(ray.getDirection())
+		, invDir(Vector3::ZERO)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			parallel[i] = Math::Abs(dir[i]) < 1e-10f;
+			if (!parallel[i])
+				invDir[i] = 1.0f / dir[i];
+		}
+	}
+	//---------------------------------------------------------------------
+	bool TerrainHeightPyramid::intersectsCell(const CellRay& ray, 
+		int level, long x, long z, Real* entry, Real* exit) const
+	{
+		long numQuads = (long)mSize - 1;
+		long span = 1L << (level + 1);
+		float minHeight, maxHeight;
+		getCellBounds(level, x, z, &minHeight, &maxHeight);
+
+		Real tNear = 0;
+		Real tFar = std::numeric_limits<Real>::max();
+		if (clipAxis(ray.origin.y, ray.invDir.y, ray.parallel[1], 
+				minHeight - HEIGHT_MARGIN, maxHeight + HEIGHT_MARGIN, tNear, tFar) &&
+			clipAxis(ray.origin.x, ray.invDir.x, ray.parallel[0], (Real)(x * span) - CELL_MARGIN, 
+				(Real)std::min((x + 1) * span, numQuads) + CELL_MARGIN, tNear, tFar) &&
+			clipAxis(ray.origin.z, ray.invDir.z, ray.parallel[2], (Real)(z * span) - CELL_MARGIN, 
+				(Real)std::min((z + 1) * span, numQuads) + CELL_MARGIN, tNear, tFar))
+		{
+			*entry = tNear;
+			if (exit)
+				*exit = tFar;
+			return true;
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
+	bool TerrainHeightPyramid::stepCell(const CellRay& ray, int level, Real t, 
+		long* x, long* z, Real* exit) const
+	{
+		long numQuads = (long)mSize - 1;
+		long span = 1L << (level + 1);
+		long width = getLevelWidth(level);
+		Real invSpan = 1.0f / (Real)span;
+
+		// a point on a boundary belongs to the cell the ray is heading into
+		Vector3 pos = ray.origin + ray.dir * t;
+		long cx = ray.dir.x < 0 ? 
+			(long)Math::Ceil(pos.x * invSpan) - 1 : (long)Math::Floor(pos.x * invSpan);
+		long cz = ray.dir.z < 0 ? 
+			(long)Math::Ceil(pos.z * invSpan) - 1 : (long)Math::Floor(pos.z * invSpan);
+		cx = std::min(std::max(cx, 0L), width - 1);
+		cz = std::min(std::max(cz, 0L), width - 1);
+		*x = cx;
+		*z = cz;
+
+		Real tExit = std::numeric_limits<Real>::max();
+		if (!ray.parallel[0])
+		{
+			long edge = ray.dir.x < 0 ? cx * span : std::min((cx + 1) * span, numQuads);
+			tExit = std::min(tExit, ((Real)edge - ray.origin.x) * ray.invDir.x);
+		}
+		if (!ray.parallel[2])
+		{
+			long edge = ray.dir.z < 0 ? cz * span : std::min((cz + 1) * span, numQuads);
+			tExit = std::min(tExit, ((Real)edge - ray.origin.z) * ray.invDir.z);
+		}
+		*exit = tExit;
+
+		float minHeight, maxHeight;
+		getCellBounds(level, cx, cz, &minHeight, &maxHeight);
+		Real y1 = pos.y;
+		Real y2 = ray.parallel[1] ? y1 : ray.origin.y + ray.dir.y * tExit;
+		return std::max(y1, y2) >= minHeight - HEIGHT_MARGIN && 
+			std::min(y1, y2) <= maxHeight + HEIGHT_MARGIN;
+	}
+
+}
@@ -152,6 +152,8 @@ namespace Ogre
 		for (int i = 0; i < 4; ++i)
 			OGRE_DELETE mChildren[i];
 
+		if (isVertexDataStreamed())
+			mTerrain->getVertexDataStreamer()->_notifyUnloaded(this);
 		destroyCpuVertexData();
 		destroyGpuVertexData();
 		destroyGpuIndexData();
@@ -263,6 +265,8 @@ namespace Ogre
 				mChildren[i]->unload();
 
 		destroyGpuVertexData();
+		// streamed data is loaded again when it's needed
+		unloadVertexData();
 
 		if (mMovable->isAttached())
 			mLocalNode->detachObject(mMovable);
@@ -276,6 +280,7 @@ namespace Ogre
 				mChildren[i]->unprepare();
 
 		destroyCpuVertexData();
+		unloadVertexData();
 	}
 	//---------------------------------------------------------------------
 	uint16 TerrainQuadTreeNode::getLodCount() const
@@ -444,7 +449,14 @@ namespace Ogre
 			mNodeWithVertexData = this;
 			mVertexDataRecord = OGRE_NEW VertexDataRecord(resolution, sz, treeDepthEnd - treeDepthStart);
 
-			createCpuVertexData();
+			if (mParent && mTerrain->_getStreamVertexData())
+			{
+				// created on demand, but the LOD calculation needs the bounds before then
+				mVertexDataRecord->streamed = true;
+				updateBounds(Rect(mOffsetX, mOffsetY, mBoundaryX, mBoundaryY));
+			}
+			else
+				createCpuVertexData();
 
 			// pass on to children
 			if (!isLeaf() && treeDepthEnd > (mDepth + 1)) // treeDepthEnd is exclusive, and this is children
@@ -501,11 +513,19 @@ namespace Ogre
 				HardwareVertexBufferSharedPtr posbuf, deltabuf;
 				VertexData* targetVertexData = cpuData ?
 					mVertexDataRecord->cpuVertexData : mVertexDataRecord->gpuVertexData;
-				if (positions) 
-					posbuf = targetVertexData->vertexBufferBinding->getBuffer(POSITION_BUFFER);
-				if (deltas)
-					deltabuf = targetVertexData->vertexBufferBinding->getBuffer(DELTA_BUFFER);
-				updateVertexBuffer(posbuf, deltabuf, updateRect);
+				if (targetVertexData)
+				{
+					if (positions) 
+						posbuf = targetVertexData->vertexBufferBinding->getBuffer(POSITION_BUFFER);
+					if (deltas)
+						deltabuf = targetVertexData->vertexBufferBinding->getBuffer(DELTA_BUFFER);
+					updateVertexBuffer(posbuf, deltabuf, updateRect);
+				}
+				else if (positions)
+				{
+					// streamed data which isn't loaded, keep the bounds up to date
+					updateBounds(updateRect);
+				}
 			}
 
 			// pass on to children
@@ -576,11 +596,7 @@ namespace Ogre
 			// Some people use one big fan with only 3 vertices at the bottom, 
 			// but this requires creating them much bigger that necessary, meaning
 			// more unnecessary overdraw, so we'll use more vertices 
-			// You need 2^levels + 1 rows of full resolution (max 129) vertex copies, plus
-			// the same number of columns. There are common vertices at intersections
-			uint16 levels = mVertexDataRecord->treeLevels;
-			mVertexDataRecord->numSkirtRowsCols = (uint16)(Math::Pow(2, levels) + 1);
-			mVertexDataRecord->skirtRowColSkip = (mVertexDataRecord->size - 1) / (mVertexDataRecord->numSkirtRowsCols - 1);
+			// The number of rows and columns is set up by the VertexDataRecord
 			numVerts += mVertexDataRecord->size * mVertexDataRecord->numSkirtRowsCols;
 			numVerts += mVertexDataRecord->size * mVertexDataRecord->numSkirtRowsCols;
 			// manually create CPU-side buffer
@@ -599,6 +615,127 @@ namespace Ogre
 			bufbind->setBinding(DELTA_BUFFER, deltabuf);
 		}
 	}
+	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::updateBounds(const Rect& rect)
+	{
+		// same sampling as updateVertexBuffer
+		resetBounds(rect);
+
+		uint16 inc = (mTerrain->getSize()-1) / (mVertexDataRecord->resolution-1);
+		Vector3 pos;
+		for (uint16 y = rect.top; y < rect.bottom; y += inc)
+		{
+			const float* pHeight = mTerrain->getHeightData(rect.left, y);
+			for (uint16 x = rect.left; x < rect.right; x += inc)
+			{
+				mTerrain->getPoint(x, y, *pHeight, &pos);
+				mergeIntoBounds(x, y, pos);
+				pHeight += inc;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	bool TerrainQuadTreeNode::isVertexDataAvailable() const
+	{
+		const VertexDataRecord* vdr = getVertexDataRecord();
+		return vdr && (vdr->cpuVertexData || vdr->gpuVertexData);
+	}
+	//---------------------------------------------------------------------
+	bool TerrainQuadTreeNode::isVertexDataStreamed() const
+	{
+		return mVertexDataRecord && mVertexDataRecord->streamed;
+	}
+	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::loadVertexData()
+	{
+		if (isVertexDataStreamed() && !isVertexDataAvailable())
+		{
+			createCpuVertexData();
+			if (mTerrain->isLoaded())
+				createGpuVertexData();
+			// so that it isn't evicted before it's first rendered
+			markVertexDataUsed(mVertexDataRecord->distance);
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::unloadVertexData()
+	{
+		if (isVertexDataStreamed())
+		{
+			destroyGpuVertexData();
+			destroyCpuVertexData();
+			resetCurrentLod();
+			mTerrain->getVertexDataStreamer()->_notifyUnloaded(this);
+		}
+	}
+	//---------------------------------------------------------------------
+	size_t TerrainQuadTreeNode::getVertexDataMemorySize() const
+	{
+		if (!mVertexDataRecord)
+			return 0;
+
+		// main grid plus skirts, as laid out by createCpuVertexData
+		size_t sz = mVertexDataRecord->size;
+		size_t numVerts = sz * sz + sz * mVertexDataRecord->numSkirtRowsCols * 2;
+		// float3 position, float2 uv, float2 delta
+		size_t vertexSize = VertexElement::getTypeSize(VET_FLOAT3) + 
+			VertexElement::getTypeSize(VET_FLOAT2) * 2;
+		return numVerts * vertexSize;
+	}
+	//---------------------------------------------------------------------
+	size_t TerrainQuadTreeNode::getVertexDataMemoryUsage(bool gpu) const
+	{
+		size_t total = 0;
+		if (mVertexDataRecord && 
+			(gpu ? mVertexDataRecord->gpuVertexData : mVertexDataRecord->cpuVertexData))
+			total += getVertexDataMemorySize();
+
+		if (!isLeaf())
+		{
+			for (int i = 0; i < 4; ++i)
+				total += mChildren[i]->getVertexDataMemoryUsage(gpu);
+		}
+		return total;
+	}
+	//---------------------------------------------------------------------
+	unsigned long TerrainQuadTreeNode::getVertexDataLastUsedFrame() const
+	{
+		return mVertexDataRecord ? mVertexDataRecord->lastUsedFrame : 0;
+	}
+	//---------------------------------------------------------------------
+	Real TerrainQuadTreeNode::getVertexDataDistance() const
+	{
+		return mVertexDataRecord ? mVertexDataRecord->distance : 0;
+	}
+	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::requestVertexData(Real distance)
+	{
+		if (isVertexDataStreamed() && !isVertexDataAvailable())
+		{
+			mVertexDataRecord->distance = distance;
+			mTerrain->getVertexDataStreamer()->_requestLoad(this);
+		}
+	}
+	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::markVertexDataUsed(Real distance)
+	{
+		if (!mTerrain->_getStreamVertexData())
+			return;
+
+		// the coarser data of the ancestors is in use too, since it's what 
+		// would be rendered if this data were evicted
+		unsigned long frame = Root::getSingleton().getNextFrameNumber();
+		TerrainQuadTreeNode* owner = mNodeWithVertexData;
+		while (owner)
+		{
+			VertexDataRecord* vdr = owner->mVertexDataRecord;
+			if (vdr->lastUsedFrame == frame && vdr->distance <= distance)
+				break;
+			vdr->lastUsedFrame = frame;
+			vdr->distance = distance;
+			owner = owner->mParent ? owner->mParent->mNodeWithVertexData : 0;
+		}
+	}
 	//----------------------------------------------------------------------
 	void TerrainQuadTreeNode::updateVertexBuffer(HardwareVertexBufferSharedPtr& posbuf, 
 		HardwareVertexBufferSharedPtr& deltabuf, const Rect& rect)
@@ -1131,6 +1268,20 @@ namespace Ogre
 	{
 		mSelfOrChildRendered = false;
 
+		// Streamed vertex data is wanted once we're within range of its 
+		// coarsest LOD; until it's loaded an ancestor renders instead
+		if (!isVertexDataAvailable())
+		{
+			if (mNodeWithVertexData == this)
+			{
+				Real dist = calculateDistance(cam);
+				if (dist < mLodLevels.back()->maxHeightDelta * cFactor)
+					requestVertexData(dist);
+			}
+			resetCurrentLod();
+			return false;
+		}
+
 		// early-out
 		/* disable this, could cause 'jumps' in LOD as children go out of frustum
 		if (!cam->isVisible(mMovable->getWorldBoundingBox(true)))
@@ -1156,28 +1307,7 @@ namespace Ogre
 		{
 
 			// no children were within their LOD ranges, so we should consider our own
-			Vector3 localPos = cam->getDerivedPosition() - mLocalCentre - mTerrain->getPosition();
-			Real dist;
-			if (TerrainGlobalOptions::getSingleton().getUseRayBoxDistanceCalculation())
-			{
-				// Get distance to this terrain node (to closest point of the box)
-				// head towards centre of the box (note, box may not cover mLocalCentre because of height)
-				Vector3 dir(mAABB.getCenter() - localPos);
-				dir.normalise();
-				Ray ray(localPos, dir);
-				std::pair<bool, Real> intersectRes = Math::intersects(ray, mAABB);
-
-				// ray will always intersect, we just want the distance
-				dist = intersectRes.second;
-			}
-			else
-			{
-				// distance to tile centre
-				dist = localPos.length();
-				// deduct half the radius of the box, assume that on average the 
-				// worst case is best approximated by this
-				dist -= (mBoundingRadius * 0.5f);
-			}
+			Real dist = calculateDistance(cam);
 
 			// Do material LOD
 			MaterialPtr material = getMaterial();
@@ -1276,6 +1406,9 @@ namespace Ogre
 				}
 			}
 
+			if (mCurrentLod != -1)
+				markVertexDataUsed(dist);
+
 		}
 		else 
 		{
@@ -1286,15 +1419,41 @@ namespace Ogre
 			{
 				// only *some* children decided to render on their own, but either 
 				// none or all need to render, so set the others manually to their lowest
+				// unless one of them has no vertex data loaded yet, in which case
+				// we render ourselves until it has
+				bool childrenAvailable = true;
 				for (int i = 0; i < 4; ++i)
 				{
 					TerrainQuadTreeNode* child = mChildren[i];
-					if (!child->isSelfOrChildRenderedAtCurrentLod())
+					if (!child->isSelfOrChildRenderedAtCurrentLod() && !child->isVertexDataAvailable())
 					{
-						child->setCurrentLod(child->getLodCount()-1);
-						child->setLodTransition(1.0);
+						child->requestVertexData(child->calculateDistance(cam));
+						childrenAvailable = false;
 					}
 				}
+
+				if (childrenAvailable)
+				{
+					for (int i = 0; i < 4; ++i)
+					{
+						TerrainQuadTreeNode* child = mChildren[i];
+						if (!child->isSelfOrChildRenderedAtCurrentLod())
+						{
+							child->setCurrentLod(child->getLodCount()-1);
+							child->setLodTransition(1.0);
+							if (mTerrain->_getStreamVertexData())
+								child->markVertexDataUsed(child->calculateDistance(cam));
+						}
+					}
+				}
+				else
+				{
+					for (int i = 0; i < 4; ++i)
+						mChildren[i]->resetCurrentLod();
+					mLodTransition = 0;
+					setCurrentLod(getLodCount()-1);
+					markVertexDataUsed(calculateDistance(cam));
+				}
 			} // (childRenderedCount < 4)
 
 		} // (childRenderedCount == 0)
@@ -1311,6 +1470,44 @@ namespace Ogre
 			 Vector4(mLodTransition, mCurrentLod + mBaseLod + 1, 0, 0));
 	}
 	//---------------------------------------------------------------------
+	void TerrainQuadTreeNode::resetCurrentLod()
+	{
+		mCurrentLod = -1;
+		mSelfOrChildRendered = false;
+		if (!isLeaf())
+		{
+			for (int i = 0; i < 4; ++i)
+				mChildren[i]->resetCurrentLod();
+		}
+	}
+	//---------------------------------------------------------------------
+	Real TerrainQuadTreeNode::calculateDistance(const Camera* cam) const
+	{
+		Vector3 localPos = cam->getDerivedPosition() - mLocalCentre - mTerrain->getPosition();
+		Real dist;
+		if (TerrainGlobalOptions::getSingleton().getUseRayBoxDistanceCalculation())
+		{
+			// Get distance to this terrain node (to closest point of the box)
+			// head towards centre of the box (note, box may not cover mLocalCentre because of height)
+			Vector3 dir(mAABB.getCenter() - localPos);
+			dir.normalise();
+			Ray ray(localPos, dir);
+			std::pair<bool, Real> intersectRes = Math::intersects(ray, mAABB);
+
+			// ray will always intersect, we just want the distance
+			dist = intersectRes.second;
+		}
+		else
+		{
+			// distance to tile centre
+			dist = localPos.length();
+			// deduct half the radius of the box, assume that on average the 
+			// worst case is best approximated by this
+			dist -= (mBoundingRadius * 0.5f);
+		}
+		return dist;
+	}
+	//---------------------------------------------------------------------
 	void TerrainQuadTreeNode::setLodTransition(float t)
 	{
 		mLodTransition = t; 						
@@ -1333,6 +1530,7 @@ namespace Ogre
 		if (isRenderedAtCurrentLod())
 		{
 			queue->addRenderable(mRend, mTerrain->getRenderQueueGroup());			
+			mTerrain->_notifyVisible();
 		}
 	}
 	//---------------------------------------------------------------------
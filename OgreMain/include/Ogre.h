@@ -57,6 +57,7 @@ THE SOFTWARE.
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreHighLevelGpuProgram.h"
 #include "OgreHighLevelGpuProgramManager.h"
+#include "OgreInstanceManager.h"
 #include "OgreKeyFrame.h"
 #include "OgreLight.h"
 #include "OgreLogManager.h"
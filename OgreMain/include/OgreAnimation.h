@@ -130,6 +130,15 @@ namespace Ogre {
         */
         NodeAnimationTrack* createNodeTrack(unsigned short handle, Node* node);
 
+		/** Creates a CompressedNodeAnimationTrack associated with a Node.
+		@remarks
+			The track is empty; fill it in with CompressedNodeAnimationTrack::compress.
+		@param handle Numeric handle to give the track, used for accessing the track later. 
+			Must be unique within this Animation.
+		@param node A pointer to the Node object which will be affected by this track
+		*/
+		CompressedNodeAnimationTrack* createCompressedNodeTrack(unsigned short handle, Node* node);
+
 		/** Creates a NumericAnimationTrack and associates it with an animable. 
 		@param handle Handle to give the track, used for accessing the track later. 
 		@param anim Animable object link
@@ -387,6 +396,15 @@ namespace Ogre {
 		*/
 		void optimise(bool discardIdentityNodeTracks = true);
 
+		/** Replace every node track with a CompressedNodeAnimationTrack.
+		@remarks
+			Tracks which are already compressed are compressed again, which
+			is only useful with larger tolerances.
+		@see CompressedNodeAnimationTrack::compress
+		*/
+		void compressNodeTracks(Real translationTolerance, const Radian& rotationTolerance,
+			Real scaleTolerance);
+
         /// A list of track handles
         typedef set<ushort>::type TrackHandleList;
 
@@ -427,6 +445,15 @@ namespace Ogre {
         */
         TimeIndex _getTimeIndex(Real timePos) const;
 
+        /** Internal method to build the data which is otherwise built on demand
+            the first time the animation is applied after it has been changed.
+        @remarks
+            Applying an animation only reads it once this has been done, so
+            the same animation can then be applied to different skeletons on
+            several threads at once, as long as track listeners allow it.
+        */
+        void _prepareForApply(void) const;
+
     protected:
         /// Node tracks, indexed by handle
         NodeTrackList mNodeTrackList;
@@ -455,6 +482,12 @@ namespace Ogre {
 
         /// Internal method to build global keyframe time list
         void buildKeyFrameTimeList(void) const;
+
+        /** Applies the node tracks to a skeleton, interpolating the rotations
+            of batches of tracks at once with OptimisedUtil::nlerpQuaternions.
+            Only used for linear interpolation; blendMask may be null. */
+        void applyToSkeletonBatched(Skeleton* skeleton, const TimeIndex& timeIndex,
+            Real weight, const AnimationState::BoneBlendMask* blendMask, Real scale);
     };
 
 	/** @} */
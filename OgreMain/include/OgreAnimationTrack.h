@@ -233,6 +233,9 @@ namespace Ogre
 		/** Set a listener for this track. */
 		virtual void setListener(Listener* l) { mListener = l; }
 
+		/** Get the listener for this track, if any. */
+		Listener* getListener(void) const { return mListener; }
+
 		/** Returns the parent Animation object for this track. */
 		Animation *getParent() const { return mParent; }
     protected:
@@ -375,14 +378,30 @@ namespace Ogre
 		/** Optimise the current track by removing any duplicate keyframes. */
 		virtual void optimise(void);
 
+		/** Returns whether the key frames of this track are stored compressed.
+		@see CompressedNodeAnimationTrack
+		*/
+		virtual bool isCompressed(void) const { return false; }
+
 		/** Clone this track (internal use only) */
-		NodeAnimationTrack* _clone(Animation* newParent) const;
+		virtual NodeAnimationTrack* _clone(Animation* newParent) const;
+
+		/** Internal method to build the interpolation splines now, if they
+			need building, rather than the next time the track is applied. */
+		void _buildInterpolationSplines(void) const
+		{
+			if (mSplineBuildNeeded)
+				buildInterpolationSplines();
+		}
 		
 	protected:
 		/// Specialised keyframe creation
 		KeyFrame* createKeyFrameImpl(Real time);
 		// Flag indicating we need to rebuild the splines next time
 		virtual void buildInterpolationSplines(void) const;
+		/// Interpolate between 2 key frames using the parent's interpolation modes
+		void interpolateKeyFrames(const TransformKeyFrame* k1, const TransformKeyFrame* k2,
+			Real t, unsigned short firstKeyIndex, TransformKeyFrame* result) const;
 
         // Struct for store splines, allocate on demand for better memory footprint
         struct Splines
@@ -400,6 +419,173 @@ namespace Ogre
 		mutable bool mUseShortestRotationPath ;
 	};
 
+	/** NodeAnimationTrack which stores its key frames in a compact, quantised form.
+	@remarks
+		Regular node tracks store a TransformKeyFrame object for every key,
+		which is a lot of memory for large animation libraries. This track
+		instead stores:
+		<ul>
+		<li>Only the keys needed to reproduce the source track within a
+			given error, since keys which linear interpolation of their
+			neighbours reproduces well enough are removed (see compress).</li>
+		<li>Rotations as 3 16-bit values per key, using the 'smallest three'
+			encoding in which the largest component of the quaternion is
+			dropped and recalculated from the others.</li>
+		<li>Translations and scales as 3 16-bit values per key, scaled to the
+			range of values in the track.</li>
+		</ul>
+		A channel which doesn't change over the track stores no per-key data
+		at all. Keys are decoded on demand when the track is interpolated.
+	@par
+		The track can't be edited; create a regular NodeAnimationTrack,
+		fill it in and compress it, or use Animation::compressNodeTracks or
+		Skeleton::compressAllAnimations. Key frames returned by getKeyFrame
+		and getKeyFramesAtTime are decoded into objects owned by the track,
+		which are only valid until the next call to either and must not be
+		modified, so those methods should not be used from several threads at
+		once. getInterpolatedKeyFrame and applyToNode don't have this
+		restriction.
+	*/
+	class _OgreExport CompressedNodeAnimationTrack : public NodeAnimationTrack
+	{
+	public:
+		/// Flags for the channels which have a value per key
+		enum Channel
+		{
+			CH_ROTATION = 0x1,
+			CH_TRANSLATION = 0x2,
+			CH_SCALE = 0x4
+		};
+
+		/// Constructor
+		CompressedNodeAnimationTrack(Animation* parent, unsigned short handle);
+		/// Constructor, associates with a Node
+		CompressedNodeAnimationTrack(Animation* parent, unsigned short handle, 
+			Node* targetNode);
+
+		/** Replace the contents of this track with a compressed copy of another.
+		@remarks
+			Keys are removed where interpolating linearly between the keys
+			either side of them is within the given tolerances of the source;
+			the first and last keys are always kept. Quantisation adds a
+			further error, which is a fraction of a thousandth of a degree for
+			rotations and 1/65535 of the range of values in the track for
+			translations and scales.
+		@param source The track to compress, which may itself be compressed
+		@param translationTolerance The largest distance a translation may move by
+		@param rotationTolerance The largest angle a rotation may change by
+		@param scaleTolerance The largest amount any component of a scale may change by
+		*/
+		void compress(const NodeAnimationTrack* source, Real translationTolerance,
+			const Radian& rotationTolerance, Real scaleTolerance);
+
+		/** Get the channels which have a value per key (see Channel). */
+		unsigned short getChannels(void) const { return mChannels; }
+
+		/** Get the number of bytes used by the compressed key frames. */
+		size_t getCompressedSize(void) const;
+
+		/// @copydoc AnimationTrack::getNumKeyFrames
+		unsigned short getNumKeyFrames(void) const;
+
+		/** Returns the key frame at the specified index, decoded.
+		@note The key frame is only valid until the next call, and must not be modified.
+		*/
+		KeyFrame* getKeyFrame(unsigned short index) const;
+
+		/** Gets the 2 key frames which are active at the time given, decoded.
+		@note The key frames are only valid until the next call, and must not be modified.
+		@see AnimationTrack::getKeyFramesAtTime
+		*/
+		Real getKeyFramesAtTime(const TimeIndex& timeIndex, KeyFrame** keyFrame1, KeyFrame** keyFrame2,
+			unsigned short* firstKeyIndex = 0) const;
+
+		/** Decode the 2 key frames which are active at the time given into the
+			key frames supplied, which unlike getKeyFramesAtTime is safe to call
+			from several threads at once.
+		@see AnimationTrack::getKeyFramesAtTime
+		*/
+		Real _decodeKeyFramesAtTime(const TimeIndex& timeIndex, TransformKeyFrame* keyFrame1,
+			TransformKeyFrame* keyFrame2, unsigned short* firstKeyIndex = 0) const;
+
+		/** Not supported, since compressed tracks can't be edited. */
+		KeyFrame* createKeyFrame(Real timePos);
+
+		/** Not supported, since compressed tracks can't be edited. */
+		void removeKeyFrame(unsigned short index);
+
+		/// @copydoc AnimationTrack::removeAllKeyFrames
+		void removeAllKeyFrames(void);
+
+		/// @copydoc AnimationTrack::getInterpolatedKeyFrame
+		void getInterpolatedKeyFrame(const TimeIndex& timeIndex, KeyFrame* kf) const;
+
+		/// @copydoc NodeAnimationTrack::hasNonZeroKeyFrames
+		bool hasNonZeroKeyFrames(void) const;
+
+		/** Does nothing, since key removal is done by compress. */
+		void optimise(void) {}
+
+		/// @copydoc AnimationTrack::_collectKeyFrameTimes
+		void _collectKeyFrameTimes(vector<Real>::type& keyFrameTimes);
+
+		/// @copydoc AnimationTrack::_buildKeyFrameIndexMap
+		void _buildKeyFrameIndexMap(const vector<Real>::type& keyFrameTimes);
+
+		/// @copydoc NodeAnimationTrack::isCompressed
+		bool isCompressed(void) const { return true; }
+
+		/** Clone this track (internal use only) */
+		NodeAnimationTrack* _clone(Animation* newParent) const;
+
+	protected:
+		friend class SkeletonSerializer;
+		typedef vector<Real>::type TimeList;
+		typedef vector<uint16>::type QuantisedList;
+
+		/// Channels with per key values
+		unsigned short mChannels;
+		/// Time of each key
+		TimeList mKeyTimes;
+		/// 3 values per key if CH_ROTATION is set
+		QuantisedList mRotations;
+		/// The rotation of every key if CH_ROTATION is not set
+		Quaternion mConstantRotation;
+		/// 3 values per key if CH_TRANSLATION is set
+		QuantisedList mTranslations;
+		/// Smallest translation, which is the translation of every key if CH_TRANSLATION is not set
+		Vector3 mTranslateBase;
+		/// Range of the translations
+		Vector3 mTranslateExtent;
+		/// 3 values per key if CH_SCALE is set
+		QuantisedList mScales;
+		/// Smallest scale, which is the scale of every key if CH_SCALE is not set
+		Vector3 mScaleBase;
+		/// Range of the scales
+		Vector3 mScaleExtent;
+
+		/// Key frames returned by getKeyFrame and getKeyFramesAtTime
+		mutable TransformKeyFrame mDecodedKeyFrame1;
+		mutable TransformKeyFrame mDecodedKeyFrame2;
+
+		/// @copydoc NodeAnimationTrack::buildInterpolationSplines
+		void buildInterpolationSplines(void) const;
+
+		/// Find the keys either side of a time, returning the parametric position between them
+		Real findKeyFrames(const TimeIndex& timeIndex, unsigned short& key1, unsigned short& key2) const;
+		/// Decode a key into a key frame
+		void decodeKeyFrame(unsigned short index, TransformKeyFrame* kf) const;
+
+		/// Quantise a quaternion using the smallest three encoding
+		static void packRotation(const Quaternion& q, uint16* packed);
+		/// Recover a quaternion quantised by packRotation
+		static Quaternion unpackRotation(const uint16* packed);
+		/// Quantise a value in the range [base, base + extent]
+		static void packVector(const Vector3& v, const Vector3& base, const Vector3& extent, uint16* packed);
+		/// Recover a value quantised by packVector
+		static Vector3 unpackVector(const uint16* packed, const Vector3& base, const Vector3& extent);
+	};
+
 	/** Type of vertex animation.
 		Vertex animation comes in 2 types, morph and pose. The reason
 		for the 2 types is that we have 2 different potential goals - to encapsulate
@@ -250,6 +250,25 @@ namespace Ogre {
         */
         void genVertices(const Vector3* const offsets, const Billboard& pBillboard);
 
+        /** Internal method for queueing a billboard's vertices to be generated
+            in a batch with others.
+        @remarks
+            Billboards with no rotation are staged and their vertices written
+            by OptimisedUtil::generateQuadVertices when the batch is flushed;
+            others flush the batch and are generated straight away, so the
+            order of the billboards in the buffer is kept.
+        @param offsets Array of 4 Vector3 offsets
+        @param sharedOffsets Whether the offsets are mVOffset, which is the
+            same for every billboard until endBillboards
+        @param bb Reference to billboard
+        */
+        void queueVertices(const Vector3* const offsets, bool sharedOffsets, const Billboard& bb);
+
+        /** Internal method which generates the vertices of the staged billboards
+            at the lock pointer, and moves it past them.
+        */
+        void flushQueuedVertices(void);
+
         /** Internal method generates vertex offsets.
         @remarks
             Takes in parametric offsets as generated from getParametericOffsets, width and height values
@@ -300,6 +319,24 @@ namespace Ogre {
 		bool mAutoUpdate;
 		/// True if the billboard data changed. Will cause vertex buffer update.
 		bool mBillboardDataChanged;
+		/// Whether vertex generation is split between threads
+		bool mParallelVertexGeneration;
+		/// SIMD aligned storage for the staged billboards, one allocation
+		float* mStagingData;
+		/// Centres of the staged billboards, 4 floats each
+		float* mStagedCentres;
+		/// Corner offsets of the staged billboards, 16 floats each
+		float* mStagedOffsets;
+		/// Texture rectangles of the staged billboards, 4 floats each
+		float* mStagedTexCoords;
+		/// Colours of the staged billboards
+		RGBA* mStagedColours;
+		/// Number of billboards waiting for their vertices to be generated
+		size_t mNumStagedBillboards;
+		/// True if the staged billboards all use mVOffset, held once
+		bool mStagedSharedOffsets;
+		/// Packed colour format of the vertices, looked up in beginBillboards
+		VertexElementType mColourType;
 
         /** Internal method creates vertex and index buffers.
         */
@@ -846,6 +883,20 @@ namespace Ogre {
 		*/			
 		void notifyBillboardDataChanged(void) { mBillboardDataChanged = true; }
 
+		/** Sets whether vertices are generated by several threads at once.
+		@remarks
+			Billboards without rotation have their vertices generated in
+			batches with SIMD; when this is enabled, large batches are also
+			split into chunks of the locked buffer which are filled in
+			parallel by the ParallelTaskDispatcher of the SceneManager which
+			created the set, or the one its node belongs to. The default is
+			false.
+		*/
+		void setParallelVertexGeneration(bool enabled) { mParallelVertexGeneration = enabled; }
+
+		/** Gets whether vertices are generated by several threads at once. */
+		bool getParallelVertexGeneration(void) const { return mParallelVertexGeneration; }
+
     };
 
 	/** Factory object for creating BillboardSet instances */
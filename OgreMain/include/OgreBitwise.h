@@ -53,6 +53,15 @@ namespace Ogre {
             }
             return result-1;
         }
+        /** Returns the number of bits set in a value.
+        */
+        static FORCEINLINE unsigned int countBitsSet(uint32 value)
+        {
+            value = value - ((value >> 1) & 0x55555555);
+            value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+            value = (value + (value >> 4)) & 0x0F0F0F0F;
+            return (value * 0x01010101) >> 24;
+        }
         /** Returns the closest power-of-two number greater or equal to value.
             @note 0 and 1 are powers of two, so 
                 firstPO2From(0)==0 and firstPO2From(1)==1.
@@ -159,6 +159,13 @@ OGRE_THREAD_PROVIDER = 3
 #define OGRE_THREAD_PROVIDER 0
 #endif
 
+/** If set to 1, Root creates a DefaultWorkQueueStealing instead of a 
+	DefaultWorkQueue. Only has an effect with the boost and poco thread providers.
+*/
+#ifndef OGRE_WORK_STEALING_QUEUE
+#define OGRE_WORK_STEALING_QUEUE 0
+#endif
+
 /** Disables use of the FreeImage image library for loading images.
 WARNING: Use only when you want to provide your own image loading code via codecs.
 */
@@ -185,6 +185,15 @@ namespace Ogre {
 
         /** Close the stream; this makes further operations invalid. */
         virtual void close(void) = 0;
+
+		/** Returns a pointer to the data at the current position, if the stream
+			holds all its data in memory which stays valid while it is open,
+			or null otherwise.
+		@remarks
+			This lets callers use the data in place rather than copying it out
+			with read.
+		*/
+		virtual uchar* getCurrentPtr(void) { return 0; }
 		
 
 	};
@@ -370,6 +379,29 @@ namespace Ogre {
     */
     typedef SharedPtr<MemoryDataStream> MemoryDataStreamPtr;
 
+	/** Subclass of MemoryDataStream which maps a file into memory.
+	@remarks
+		The pages of the file are only read when they are first accessed, and
+		are shared with the operating system's file cache, so opening a large
+		file is cheap and data used in place (see DataStream::getCurrentPtr)
+		is never copied. The mapping is private: the memory may be written,
+		but changes are not written back to the file.
+	*/
+	class _OgreExport MappedFileDataStream : public MemoryDataStream
+	{
+	public:
+		/** Map a file into memory.
+		@param name The name to give the stream
+		@param path The path of the file to map
+		*/
+		MappedFileDataStream(const String& name, const String& path);
+		~MappedFileDataStream();
+
+		/** @copydoc DataStream::close
+		*/
+		void close(void);
+	};
+
     /** Common subclass of DataStream for handling data from 
 		std::basic_istream.
 	*/
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreHardwareBufferManager.h"
 #include "OgreHardwareVertexBuffer.h"
 #include "OgreHardwareIndexBuffer.h"
+#include "OgreDataStream.h"
 
 namespace Ogre {
 	/** \addtogroup Core
@@ -47,6 +48,8 @@ namespace Ogre {
     {
 	protected:
 		unsigned char* mpData;
+		/// Holds the data if it isn't owned by the buffer
+		DataStreamPtr mDataOwner;
         /** See HardwareBuffer. */
         void* lockImpl(size_t offset, size_t length, LockOptions options);
         /** See HardwareBuffer. */
@@ -54,6 +57,14 @@ namespace Ogre {
     public:
 		DefaultHardwareVertexBuffer(size_t vertexSize, size_t numVertices, 
             HardwareBuffer::Usage usage);
+		/** Create a buffer which uses existing memory in place.
+		@param data The vertex data, which must stay valid and writeable for
+			as long as dataOwner does
+		@param dataOwner The stream holding the data, which the buffer keeps
+			a reference to
+		*/
+		DefaultHardwareVertexBuffer(size_t vertexSize, size_t numVertices, 
+            HardwareBuffer::Usage usage, void* data, const DataStreamPtr& dataOwner);
         ~DefaultHardwareVertexBuffer();
         /** See HardwareBuffer. */
         void readData(size_t offset, size_t length, void* pDest);
@@ -73,12 +84,22 @@ namespace Ogre {
     {
 	protected:
 		unsigned char* mpData;
+		/// Holds the data if it isn't owned by the buffer
+		DataStreamPtr mDataOwner;
         /** See HardwareBuffer. */
         void* lockImpl(size_t offset, size_t length, LockOptions options);
         /** See HardwareBuffer. */
 		void unlockImpl(void);
     public:
 		DefaultHardwareIndexBuffer(IndexType idxType, size_t numIndexes, HardwareBuffer::Usage usage);
+		/** Create a buffer which uses existing memory in place.
+		@param data The indexes, which must stay valid and writeable for as
+			long as dataOwner does
+		@param dataOwner The stream holding the data, which the buffer keeps
+			a reference to
+		*/
+		DefaultHardwareIndexBuffer(IndexType idxType, size_t numIndexes, HardwareBuffer::Usage usage,
+			void* data, const DataStreamPtr& dataOwner);
         ~DefaultHardwareIndexBuffer();
         /** See HardwareBuffer. */
         void readData(size_t offset, size_t length, void* pDest);
@@ -112,6 +133,18 @@ namespace Ogre {
 		HardwareIndexBufferSharedPtr 
             createIndexBuffer(HardwareIndexBuffer::IndexType itype, size_t numIndexes, 
 				HardwareBuffer::Usage usage, bool useShadowBuffer = false);
+		/** Creates a vertex buffer which uses the data in place if it is
+			aligned for SIMD and has an owner, otherwise copies it. */
+		HardwareVertexBufferSharedPtr 
+            createVertexBufferFromData(size_t vertexSize, size_t numVerts, 
+				HardwareBuffer::Usage usage, bool useShadowBuffer, void* data,
+				const DataStreamPtr& dataOwner);
+		/** Creates an index buffer which uses the data in place if it is
+			aligned for SIMD and has an owner, otherwise copies it. */
+		HardwareIndexBufferSharedPtr 
+            createIndexBufferFromData(HardwareIndexBuffer::IndexType itype, size_t numIndexes, 
+				HardwareBuffer::Usage usage, bool useShadowBuffer, void* data,
+				const DataStreamPtr& dataOwner);
 		/// Create a hardware vertex buffer
 		RenderToVertexBufferSharedPtr createRenderToVertexBuffer();
     };
@@ -89,6 +89,16 @@ namespace Ogre {
         // similar bit-fields causing loss performance.
         typedef vector<char>::type TriangleLightFacingList;
 
+        // Working vector used when calculating the silhouette, one bit per
+        // triangle packed into 32-bit masks, so it can be tested a word at
+        // a time.
+        typedef vector<uint32>::type TriangleLightFacingMask;
+
+        // Working vector of the silhouette edges of each edge group, as
+        // pairs of vertex indexes.
+        typedef vector<uint32>::type SilhouetteEdgeList;
+        typedef vector<size_t>::type SilhouetteEdgeStartList;
+
         typedef vector<Triangle>::type TriangleList;
         typedef vector<Edge>::type EdgeList;
 
@@ -119,24 +129,58 @@ namespace Ogre {
         TriangleList triangles;
         /** All triangle face normals. It should be 1:1 with triangles. */
         TriangleFaceNormalList triangleFaceNormals;
-        /** Triangle light facing states. It should be 1:1 with triangles. */
+        /** Triangle light facing states. It should be 1:1 with triangles. 
+        @remarks
+            This holds the same states as triangleLightFacingMask, one per
+            byte, for code which reads them directly.
+        */
         TriangleLightFacingList triangleLightFacings;
+        /** Triangle light facing states, bit (i % 32) of mask i / 32 is set
+            if triangle i is facing the light. */
+        TriangleLightFacingMask triangleLightFacingMask;
+        /** Silhouette edges found by updateSilhouetteEdges, as pairs of
+            vertex indexes running anticlockwise around the light facing
+            triangle; those of each edge group follow the previous group's. */
+        SilhouetteEdgeList silhouetteEdges;
+        /** Index of the first vertex index in silhouetteEdges for each edge
+            group, plus one past the end of the last group. */
+        SilhouetteEdgeStartList silhouetteEdgeStarts;
         /** All edge groups of this edge list. */
         EdgeGroupList edgeGroups;
         /** Flag indicate the mesh is manifold. */
         bool isClosed;
+        /** Number identifying this edge list, which unlike its address is not
+            reused when the edge list is rebuilt, so it can key data derived
+            from it. */
+        uint32 generation;
+
+        EdgeData();
 
 
         /** Calculate the light facing state of the triangles in this edge list
         @remarks
             This is normally the first stage of calculating a silhouette, i.e.
             establishing which tris are facing the light and which are facing
-            away. This state is stored in the 'triangleLightFacings'.
+            away. This state is stored in the 'triangleLightFacingMask'.
         @param lightPos 4D position of the light in object space, note that 
             for directional lights (which have no position), the w component
             is 0 and the x/y/z position are the direction.
         */
         void updateTriangleLightFacing(const Vector4& lightPos);
+        /** Finds the silhouette edges of every edge group.
+        @remarks
+            This is the second stage of calculating a silhouette, which uses
+            the light facing states from updateTriangleLightFacing. The edges
+            are stored in 'silhouetteEdges'.
+        */
+        void updateSilhouetteEdges(void);
+        /** Returns whether a triangle was facing the light in the last call
+            to updateTriangleLightFacing.
+        */
+        bool isTriangleLightFacing(size_t triIndex) const
+        {
+            return (triangleLightFacingMask[triIndex >> 5] & (1u << (triIndex & 31))) != 0;
+        }
         /** Updates the face normals for this edge list based on (changed)
             position information, useful for animated objects. 
         @param vertexSet The vertex set we are updating
@@ -159,6 +203,10 @@ namespace Ogre {
         separate index and (optionally) vertex data and still get the same connectivity 
         information. It's important to note that the indexes for the edge will be constrained
         to a single vertex buffer though (this is required in order to render the edge).
+    @par
+        Vertices are identified by exact position with a hash table, and edges
+        are matched by looking up open edges from the vertex at their far end,
+        so building is roughly linear in the number of triangles.
     */
     class _OgreExport EdgeListBuilder 
     {
@@ -191,6 +239,18 @@ namespace Ogre {
         */
         EdgeData* build(void);
 
+        /** Sets a dispatcher used to process the vertex sets in parallel (default none).
+        @remarks
+            Reading the triangles of each vertex set, identifying the vertices
+            at the same position and calculating face normals is done
+            independently for each set; only joining the sets and connecting
+            edges is serial, so the result is the same either way. Buffers
+            are only locked by the thread calling build.
+        */
+        void setParallelDispatcher(ParallelTaskDispatcher* dispatcher) { mDispatcher = dispatcher; }
+        /** Gets the dispatcher used to process the vertex sets in parallel, if any. */
+        ParallelTaskDispatcher* getParallelDispatcher(void) const { return mDispatcher; }
+
         /// Debugging method
         void log(Log* l);
     protected:
@@ -207,12 +267,14 @@ namespace Ogre {
             size_t indexSet;    // The index set this was referenced (first) from
             size_t originalIndex; // place of vertex in original vertex set
         };
+
         /** A set of indexed geometry data */
         struct Geometry {
             size_t vertexSet;           // The vertex data set this geometry data refers to
             size_t indexSet;            // The index data set this geometry data refers to
             const IndexData* indexData; // The index information which describes the triangles.
             RenderOperation::OperationType opType;  // The operation type used to render this geometry
+            const void* lockedIndexes;  // The locked index buffer, during build
         };
         /** Comparator for sorting geometries by vertex set */
         struct geometryLess {
@@ -223,43 +285,39 @@ namespace Ogre {
                 return a.indexSet < b.indexSet;
             }
         };
-        /** Comparator for unique vertex list */
-        struct vectorLess {
-            bool operator()(const Vector3& a, const Vector3& b) const
-            {
-                if (a.x < b.x) return true;
-                if (a.x > b.x) return false;
-                if (a.y < b.y) return true;
-                if (a.y > b.y) return false;
-                return a.z < b.z;
-            }
-        };
 
         typedef vector<const VertexData*>::type VertexDataList;
         typedef vector<Geometry>::type GeometryList;
         typedef vector<CommonVertex>::type CommonVertexList;
 
+        /** The triangles of one vertex set, gathered independently of the others. */
+        struct VertexSet {
+            /// First and last + 1 geometries using this set, once sorted
+            size_t geometryStart, geometryEnd;
+            /// Position element of the locked buffer, with the size and number of vertices
+            const unsigned char* positions;
+            size_t vertexSize;
+            size_t vertexCount;
+            /// Vertices at distinct positions, in order of first use; 'index' is
+            /// only relative to this set until the sets are joined
+            CommonVertexList vertices;
+            /// Triangles which aren't degenerate, with shared indexes into 'vertices'
+            EdgeData::TriangleList triangles;
+            EdgeData::TriangleFaceNormalList triangleFaceNormals;
+        };
+        typedef vector<VertexSet>::type VertexSetList;
+        class VertexSetTasks;
+
         GeometryList mGeometryList;
         VertexDataList mVertexDataList;
         CommonVertexList mVertices;
         EdgeData* mEdgeData;
-		/// Map for identifying common vertices
-		typedef map<Vector3, size_t, vectorLess>::type CommonVertexMap;
-		CommonVertexMap mCommonVertexMap;
-        /** Edge map, used to connect edges. Note we allow many triangles on an edge,
-        after connected an existing edge, we will remove it and never used again.
-        */
-        typedef multimap< std::pair<size_t, size_t>, std::pair<size_t, size_t> >::type EdgeMap;
-        EdgeMap mEdgeMap;
-
-        void buildTrianglesEdges(const Geometry &geometry);
+        ParallelTaskDispatcher* mDispatcher;
 
-        /// Finds an existing common vertex, or inserts a new one
-        size_t findOrCreateCommonVertex(const Vector3& vec, size_t vertexSet, 
-            size_t indexSet, size_t originalIndex);
-        /// Connect existing edge or create a new edge - utility method during building
-        void connectOrCreateEdge(size_t vertexSet, size_t triangleIndex, size_t vertIndex0, size_t vertIndex1, 
-            size_t sharedVertIndex0, size_t sharedVertIndex1);
+        /// Read the triangles of a vertex set and find its distinct vertices
+        void buildVertexSet(size_t vertexSetIndex, VertexSet& vertexSet) const;
+        /// Connect the edges of each triangle to earlier triangles, or create them
+        void connectEdges(void);
     };
 	/** @} */
 	/** @} */
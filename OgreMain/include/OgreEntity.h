@@ -675,6 +675,28 @@ namespace Ogre {
         */
         bool _isSkeletonAnimated(void) const;
 
+		/** Returns whether _updateSkeleton may be called for this entity
+			ahead of it being rendered this frame.
+		@remarks
+			This is true for entities in the scene whose animation state has
+			changed and whose skeleton hasn't been evaluated yet this frame.
+			Entities with objects attached to their bones are left to be
+			updated when they are rendered, since updating the attached
+			objects uses the transform of the entity's node.
+		*/
+		bool _isSkeletonUpdatePending(void) const;
+
+		/** Internal method which evaluates the skeleton for the current frame
+			and caches the bone matrices, unless that's been done already.
+		@remarks
+			Skinning is still done when the entity is rendered. This may be
+			called on several threads at once for entities which don't share a
+			skeleton instance, once Skeleton::_prepareAnimationState has been
+			called for each of them.
+		@see SceneManager::setParallelSkeletalAnimation
+		*/
+		void _updateSkeleton(void);
+
 		/** Advanced method to get the temporarily blended skeletal vertex information
 		for entities which are software skinned.
         @remarks
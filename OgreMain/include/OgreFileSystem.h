@@ -116,7 +116,26 @@ namespace Ogre {
 			return ms_IgnoreHidden;
 		}
 
+		/** Set whether files opened read-only are mapped into memory rather
+			than read through a file stream (see MappedFileDataStream).
+		@remarks
+			Mapped files can be used in place by loaders which support it, such
+			as MeshSerializer with meshes written with aligned buffers. The
+			default is false.
+		*/
+		static void setUseMemoryMapping(bool mapFiles)
+		{
+			ms_UseMemoryMapping = mapFiles;
+		}
+
+		/// Get whether files opened read-only are mapped into memory.
+		static bool getUseMemoryMapping()
+		{
+			return ms_UseMemoryMapping;
+		}
+
 		static bool ms_IgnoreHidden;
+		static bool ms_UseMemoryMapping;
     };
 
     /** Specialisation of ArchiveFactory for FileSystem files. */
@@ -401,6 +401,9 @@ namespace Ogre {
 		/// Version number of the definitions in this buffer
 		unsigned long mVersion; 
 
+		/// Number of times the values in this buffer have been modified
+		unsigned long mUpdateCount;
+
 	public:
 		GpuSharedParameters(const String& name);
 		virtual ~GpuSharedParameters();
@@ -430,6 +433,11 @@ namespace Ogre {
 		*/
 		unsigned long getVersion() const { return mVersion; }
 
+		/** Get the number of times the values in this shared parameter set have
+			been modified, can be used to identify when the values need copying again.
+		*/
+		unsigned long getUpdateCount() const { return mUpdateCount; }
+
 		/** Mark the shared set as being dirty (values modified).
 		@remarks
 		You do not need to call this yourself, set is marked as dirty whenever
@@ -520,6 +528,9 @@ namespace Ogre {
 		/// Version of shared params we based the copydata on
 		unsigned long mCopyDataVersion;
 
+		/// Update count of shared params when the values were last copied
+		unsigned long mCopiedUpdateCount;
+
 		void initCopyData();
 
 
@@ -530,6 +541,10 @@ namespace Ogre {
 
 		/** Update the target parameters by copying the data from the shared
 			parameters.
+		@remarks
+			The copy is only performed if the shared values have been modified 
+			since the last copy, in which case the GPV_GLOBAL variability of the 
+			target parameters is marked as dirty.
 		@note This method  may not actually be called if the RenderSystem
 			supports using shared parameters directly in their own shared buffer; in
 			which case the values should not be copied out of the shared area
@@ -1125,6 +1140,10 @@ namespace Ogre {
 		AutoConstantList mAutoConstants;
 		/// The combined variability masks of all parameters
 		uint16 mCombinedVariability;
+		/// The variability masks of parameters whose values changed since the last _markClean
+		uint16 mDirtyVariability;
+		/// The variability that writes to the constant buffers are attributed to
+		uint16 mWriteVariability;
 		/// Do we need to transpose matrices?
 		bool mTransposeMatrices;
 		/// flag to indicate if names not found will be ignored
@@ -1142,6 +1161,10 @@ namespace Ogre {
 		/// Return the variability for an auto constant
 		uint16 deriveVariability(AutoConstantType act);
 
+		/// Count the elements in a logical buffer with a variability matching the mask
+		static size_t calculateLogicalConstantElements(const GpuLogicalIndexUseMap& logicalMap, 
+			uint16 variabilityMask);
+
 		void copySharedParamSetUsage(const GpuSharedParamUsageList& srcList);
 
 		GpuSharedParamUsageList mSharedParamSets;
@@ -1400,13 +1423,19 @@ namespace Ogre {
 		const GpuLogicalBufferStructPtr& getIntLogicalBufferStruct() const { return mIntLogicalToPhysical; }
 		/// Get a reference to the list of float constants
 		const FloatConstantList& getFloatConstantList() const { return mFloatConstants; }
-		/// Get a pointer to the 'nth' item in the float buffer
+		/** Get a pointer to the 'nth' item in the float buffer
+		@note Writes through this pointer are not tracked, call _markDirty after
+			modifying values this way.
+		*/
 		float* getFloatPointer(size_t pos) { return &mFloatConstants[pos]; }
 		/// Get a pointer to the 'nth' item in the float buffer
 		const float* getFloatPointer(size_t pos) const { return &mFloatConstants[pos]; }
 		/// Get a reference to the list of int constants
 		const IntConstantList& getIntConstantList() const { return mIntConstants; }
-		/// Get a pointer to the 'nth' item in the int buffer
+		/** Get a pointer to the 'nth' item in the int buffer
+		@note Writes through this pointer are not tracked, call _markDirty after
+			modifying values this way.
+		*/
 		int* getIntPointer(size_t pos) { return &mIntConstants[pos]; }
 		/// Get a pointer to the 'nth' item in the int buffer
 		const int* getIntPointer(size_t pos) const { return &mIntConstants[pos]; }
@@ -1509,6 +1538,40 @@ namespace Ogre {
 		*/
 		void _updateAutoParams(const AutoParamDataSource* source, uint16 variabilityMask);
 
+		/** Gets the variability classes (see GpuParamVariability) of the parameters 
+			whose values have changed since the last call to _markClean.
+		@remarks
+			Every write to the constant buffers is compared against the current
+			contents, so re-writing the same values (e.g. an auto constant updated
+			for every object but which only depends on the camera) does not make
+			the parameters dirty. Writes made while updating auto constants are
+			attributed to the variability of that auto constant, all other writes 
+			mark every variability class as dirty. This allows the SceneManager
+			to skip uploading blocks of constants the GPU already holds.
+		*/
+		uint16 getDirtyVariability(void) const { return mDirtyVariability; }
+
+		/** Marks parameters of the given variability classes as modified. 
+		@remarks
+			You do not need to call this yourself unless you've modified the 
+			values through the (non const) getFloatPointer or getIntPointer.
+		*/
+		void _markDirty(uint16 variability = (uint16)GPV_ALL) { mDirtyVariability |= variability; }
+
+		/** Marks parameters of the given variability classes as being in sync 
+			with the GPU, called once they have been bound to the render system.
+		*/
+		void _markClean(uint16 variability = (uint16)GPV_ALL) { mDirtyVariability &= ~variability; }
+
+		/** Calculates the size in bytes of all the float and int constants
+			whose variability matches the mask given.
+		@remarks
+			This is the amount of data a render system will upload if this
+			parameter set is bound with this mask; it walks all constant 
+			definitions so should not be called per object unless necessary.
+		*/
+		size_t calculateConstantBytes(uint16 variabilityMask) const;
+
 		/** Tells the program whether to ignore missing parameters or not.
 		*/
 		void setIgnoreMissingParams(bool state) { mIgnoreMissingParams = state; }
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreHardwareVertexBuffer.h"
 #include "OgreHardwareIndexBuffer.h"
 #include "OgreRenderToVertexBuffer.h"
+#include "OgreDataStream.h"
 
 namespace Ogre {
 	/** \addtogroup Core
@@ -260,6 +261,35 @@ namespace Ogre {
             createIndexBuffer(HardwareIndexBuffer::IndexType itype, size_t numIndexes, 
 			HardwareBuffer::Usage usage, bool useShadowBuffer = false) = 0;
 
+		/** Create a hardware vertex buffer holding the given data.
+		@remarks
+			This is equivalent to calling createVertexBuffer and writing the
+			data to the whole buffer, which is what the default implementation
+			does. Buffer managers which keep buffers in system memory may use
+			the data in place instead of copying it, provided it is aligned
+			for SIMD; they then keep a reference to dataOwner for as long as
+			the buffer exists, so data must remain valid and writeable for as
+			long as dataOwner does.
+		@param data Pointer to numVerts * vertexSize bytes of vertex data
+		@param dataOwner The stream holding the data, which may be null if
+			the data must be copied
+		@see createVertexBuffer for the other parameters
+		*/
+		virtual HardwareVertexBufferSharedPtr 
+            createVertexBufferFromData(size_t vertexSize, size_t numVerts, HardwareBuffer::Usage usage, 
+			bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner);
+		/** Create a hardware index buffer holding the given data.
+		@remarks
+			As createVertexBufferFromData, for index buffers.
+		@param data Pointer to the numIndexes indexes
+		@param dataOwner The stream holding the data, which may be null if
+			the data must be copied
+		@see createIndexBuffer for the other parameters
+		*/
+		virtual HardwareIndexBufferSharedPtr 
+            createIndexBufferFromData(HardwareIndexBuffer::IndexType itype, size_t numIndexes, 
+			HardwareBuffer::Usage usage, bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner);
+
 		/** Create a render to vertex buffer.
 		@remarks The parameters (such as vertex size etc) are determined later
 			and are allocated when needed.
@@ -405,6 +435,22 @@ namespace Ogre {
 		{
 			return mImpl->createIndexBuffer(itype, numIndexes, usage, useShadowBuffer);
 		}
+		/** @copydoc HardwareBufferManagerBase::createVertexBufferFromData */
+		HardwareVertexBufferSharedPtr 
+            createVertexBufferFromData(size_t vertexSize, size_t numVerts, HardwareBuffer::Usage usage, 
+			bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner)
+		{
+			return mImpl->createVertexBufferFromData(vertexSize, numVerts, usage, useShadowBuffer,
+				data, dataOwner);
+		}
+		/** @copydoc HardwareBufferManagerBase::createIndexBufferFromData */
+		HardwareIndexBufferSharedPtr 
+            createIndexBufferFromData(HardwareIndexBuffer::IndexType itype, size_t numIndexes, 
+			HardwareBuffer::Usage usage, bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner)
+		{
+			return mImpl->createIndexBufferFromData(itype, numIndexes, usage, useShadowBuffer,
+				data, dataOwner);
+		}
 
 		/** @copydoc HardwareBufferManagerInterface::createRenderToVertexBuffer */
 		RenderToVertexBufferSharedPtr createRenderToVertexBuffer()
@@ -51,6 +51,8 @@ namespace Ogre {
 			HardwareBufferManagerBase* mMgr;
 		    size_t mNumVertices;
             size_t mVertexSize;
+			bool mIsInstanceData;
+			size_t mInstanceDataStepRate;
 
 	    public:
 		    /// Should be called by HardwareBufferManager
@@ -63,6 +65,20 @@ namespace Ogre {
             size_t getVertexSize(void) const { return mVertexSize; }
             /// Get the number of vertices in this buffer
             size_t getNumVertices(void) const { return mNumVertices; }
+			/// Get if this vertex buffer is an "instance data" buffer (per instance)
+			bool getIsInstanceData() const { return mIsInstanceData; }
+			/** Set if this vertex buffer is an "instance data" buffer (per instance).
+			@remarks
+				The elements of an instance data buffer advance once per instance
+				drawn, rather than once per vertex, when a RenderOperation draws 
+				more than one instance. The render system must support
+				RSC_VERTEX_BUFFER_INSTANCE_DATA to make use of this.
+			*/
+			void setIsInstanceData(bool val) { mIsInstanceData = val; }
+			/// Get the number of instances to draw using the same per-instance data before advancing
+			size_t getInstanceDataStepRate() const { return mInstanceDataStepRate; }
+			/// Set the number of instances to draw using the same per-instance data before advancing
+			void setInstanceDataStepRate(size_t val) { mInstanceDataStepRate = val; }
 
 
 
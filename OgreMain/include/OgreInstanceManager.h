@@ -0,0 +1,289 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __InstanceManager_H__
+#define __InstanceManager_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreMesh.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreIteratorWrappers.h"
+
+namespace Ogre {
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Scene
+	*  @{
+	*/
+	/** Draws many copies of a mesh using hardware instancing.
+	@remarks
+		Unlike InstancedGeometry, which replicates the geometry into each
+		batch and indexes world matrices from shader constants, this class
+		keeps a single copy of the mesh data. Each batch adds a per-instance
+		vertex stream holding the world transforms of its instances, and
+		draws all of them with one RenderOperation. Batches are therefore
+		limited only by the size of the instance stream, and instances can be
+		added and removed at any time.
+	@par
+		The instance stream holds the first three rows of each instance's
+		world matrix as 3 VET_FLOAT4 texture coordinates, starting at the
+		index returned by getInstanceTexCoordIndex (the first one the mesh
+		doesn't use). The vertex program used by the material has to
+		transform the vertices by them, for example:
+		@code
+		float3 worldPos = float3(dot(row0, pos), dot(row1, pos), dot(row2, pos));
+		@endcode
+		since the world matrix of the batch itself is always the identity.
+	@par
+		Each time a batch is rendered, its instances are frustum culled as a
+		batch and only the visible ones are packed into the instance stream.
+		None of this depends on the GPU, so it works the same way with the
+		DefaultHardwareBufferManager, without a render system.
+	@par
+		You should not construct instances of this class directly; instead,
+		call SceneManager::createInstanceManager.
+	@note
+		Requires RSC_VERTEX_BUFFER_INSTANCE_DATA, if there is a render system.
+	*/
+	class _OgreExport InstanceManager : public BatchedGeometryAlloc
+	{
+	public:
+		class InstanceBatch;
+
+		/** A single copy of the mesh drawn by an InstanceManager.
+		@remarks
+			This isn't a MovableObject; it holds its own world transform, and
+			is culled and drawn by the batch it belongs to.
+		*/
+		class _OgreExport InstancedEntity : public BatchedGeometryAlloc
+		{
+			friend class InstanceBatch;
+		protected:
+			/// The batch this instance is drawn by
+			InstanceBatch* mBatch;
+			/// Position of this instance in the batch's dense arrays
+			size_t mIndex;
+			Vector3 mPosition;
+			Quaternion mOrientation;
+			Vector3 mScale;
+			bool mVisible;
+		public:
+			InstancedEntity(InstanceBatch* batch);
+			virtual ~InstancedEntity() {}
+
+			/// Get the batch which draws this instance
+			InstanceBatch* getBatch(void) const { return mBatch; }
+			/// Set the position of the instance in world space
+			void setPosition(const Vector3& position);
+			/// Get the position of the instance in world space
+			const Vector3& getPosition(void) const { return mPosition; }
+			/// Set the orientation of the instance in world space
+			void setOrientation(const Quaternion& orientation);
+			/// Get the orientation of the instance in world space
+			const Quaternion& getOrientation(void) const { return mOrientation; }
+			/// Set the scale of the instance
+			void setScale(const Vector3& scale);
+			/// Get the scale of the instance
+			const Vector3& getScale(void) const { return mScale; }
+			/// Set the whole transform at once, which is cheaper than each part
+			void setTransform(const Vector3& position, const Quaternion& orientation,
+				const Vector3& scale = Vector3::UNIT_SCALE);
+			/// Set whether the instance is drawn
+			void setVisible(bool visible) { mVisible = visible; }
+			/// Get whether the instance is drawn
+			bool getVisible(void) const { return mVisible; }
+			/// Get the position of the instance in its batch's arrays
+			size_t _getIndex(void) const { return mIndex; }
+		};
+
+		/** A set of instances which share a material, drawn in one go.
+		@remarks
+			The transforms and bounding spheres of the instances are held in
+			dense arrays; removing an instance moves the last one into its
+			place, so the arrays never have holes to skip.
+		*/
+		class _OgreExport InstanceBatch : public MovableObject, public Renderable
+		{
+		public:
+			typedef vector<InstancedEntity*>::type InstancedEntityList;
+		protected:
+			InstanceManager* mInstanceManager;
+			/// Scene node
+			SceneNode* mNode;
+			MaterialPtr mMaterial;
+			/// The mesh's vertex buffers, plus the instance stream
+			VertexData* mVertexData;
+			/// The mesh's index data, not owned
+			IndexData* mIndexData;
+			HardwareVertexBufferSharedPtr mInstanceBuffer;
+			size_t mMaxInstances;
+			/// Instances in the batch, densely packed
+			InstancedEntityList mInstances;
+			/// SIMD aligned storage for the arrays below
+			float* mInstanceData;
+			/// World bounding spheres of the instances
+			SphereArrays mSpheres;
+			/// Rows of the world transforms of the instances, 12 floats each
+			float* mTransforms;
+			/// Results of the last cull, one bit per instance
+			vector<uint32>::type mVisibility;
+			/// Number of instances packed into the instance stream
+			size_t mNumVisible;
+			mutable AxisAlignedBox mAABB;
+			mutable Real mBoundingRadius;
+			mutable bool mBoundsDirty;
+
+			/// Write the transform and bounds of the instance to its slot
+			void updateInstance(const InstancedEntity* instance);
+			/// Flag the bounds to be updated, and let the node know
+			void markBoundsDirty(void);
+			/// Update the bounds from the instances, if any of them moved
+			void updateBounds(void) const;
+		public:
+			InstanceBatch(InstanceManager* manager, const String& name,
+				const MaterialPtr& material, size_t maxInstances);
+			virtual ~InstanceBatch();
+
+			/// Get the manager which owns this batch
+			InstanceManager* getInstanceManager(void) const { return mInstanceManager; }
+			/// Get the number of instances in this batch
+			size_t getNumInstances(void) const { return mInstances.size(); }
+			/// Get the maximum number of instances this batch can hold
+			size_t getMaxInstances(void) const { return mMaxInstances; }
+			/// Get whether the batch can take another instance
+			bool isFull(void) const { return mInstances.size() >= mMaxInstances; }
+			/// Get the number of instances drawn by the last render operation
+			size_t getNumVisibleInstances(void) const { return mNumVisible; }
+			/// Get the instances in this batch, in the order they are held
+			const InstancedEntityList& getInstances(void) const { return mInstances; }
+
+			/// Creates a new instance in this batch, which mustn't be full
+			InstancedEntity* _createInstance(void);
+			/// Destroys an instance in this batch, moving the last one into its place
+			void _destroyInstance(InstancedEntity* instance);
+			/// Called by instances when their transform changes
+			void _notifyInstanceMoved(const InstancedEntity* instance);
+			/** Culls the instances against a frustum, and packs the transforms
+				of the visible ones into the instance stream.
+			@returns The number of visible instances
+			*/
+			size_t _cullAndPackInstances(const Frustum* frustum);
+
+			// MovableObject overrides
+			const String& getMovableType(void) const;
+			void _notifyCurrentCamera(Camera* cam);
+			const AxisAlignedBox& getBoundingBox(void) const;
+			Real getBoundingRadius(void) const;
+			void _updateRenderQueue(RenderQueue* queue);
+			/// @copydoc MovableObject::visitRenderables
+			void visitRenderables(Renderable::Visitor* visitor,
+				bool debugRenderables = false);
+			uint32 getTypeFlags(void) const;
+
+			// Renderable overrides
+			const MaterialPtr& getMaterial(void) const { return mMaterial; }
+			void getRenderOperation(RenderOperation& op);
+			void getWorldTransforms(Matrix4* xform) const;
+			Real getSquaredViewDepth(const Camera* cam) const;
+			const LightList& getLights(void) const;
+			bool getCastsShadows(void) const { return false; }
+		};
+
+		typedef vector<InstanceBatch*>::type InstanceBatchList;
+		typedef map<String, InstanceBatchList>::type InstanceBatchMap;
+		typedef MapIterator<InstanceBatchMap> InstanceBatchMapIterator;
+
+	protected:
+		String mName;
+		SceneManager* mOwner;
+		MeshPtr mMesh;
+		unsigned short mSubMeshIdx;
+		size_t mInstancesPerBatch;
+		/// Batches by material name
+		InstanceBatchMap mInstanceBatches;
+		size_t mNumInstances;
+		size_t mBatchCount;
+
+	public:
+		/** Constructor - don't call directly, use SceneManager::createInstanceManager.
+		@param name The name of the manager
+		@param owner The SceneManager the instances are drawn by
+		@param meshName The mesh to draw
+		@param groupName The resource group of the mesh
+		@param instancesPerBatch The maximum number of instances in each batch
+		@param subMeshIdx The submesh of the mesh to draw
+		*/
+		InstanceManager(const String& name, SceneManager* owner, const String& meshName,
+			const String& groupName, size_t instancesPerBatch, unsigned short subMeshIdx = 0);
+		virtual ~InstanceManager();
+
+		/// Get the name of this manager
+		const String& getName(void) const { return mName; }
+		/// Get the SceneManager which owns this manager
+		SceneManager* getSceneManager(void) const { return mOwner; }
+		/// Get the mesh drawn by this manager
+		const MeshPtr& getMesh(void) const { return mMesh; }
+		/// Get the submesh drawn by this manager
+		SubMesh* getSubMesh(void) const;
+		/// Get the maximum number of instances in each batch
+		size_t getInstancesPerBatch(void) const { return mInstancesPerBatch; }
+		/** Set the maximum number of instances in each batch.
+		@note Only affects batches created after it's called
+		*/
+		void setInstancesPerBatch(size_t instancesPerBatch);
+		/// Get the texture coordinate set the instance transforms start at
+		unsigned short getInstanceTexCoordIndex(void) const;
+
+		/** Creates an instance of the mesh, using the given material.
+		@remarks
+			The instance goes in the first batch of that material which has
+			room for it, or a new batch if there isn't one.
+		*/
+		virtual InstancedEntity* createInstancedEntity(const String& materialName);
+		/// Destroys an instance created by createInstancedEntity
+		virtual void destroyInstancedEntity(InstancedEntity* instance);
+		/// Destroys all the instances, and the batches
+		virtual void destroyAllInstancedEntities(void);
+		/// Destroys batches which have no instances left in them
+		virtual void cleanupEmptyBatches(void);
+		/// Get the total number of instances
+		size_t getNumInstancedEntities(void) const { return mNumInstances; }
+
+		/// Get an iterator over the batches, keyed by material name
+		InstanceBatchMapIterator getInstanceBatchMapIterator(void)
+		{ return InstanceBatchMapIterator(mInstanceBatches.begin(), mInstanceBatches.end()); }
+	};
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -92,6 +92,7 @@ namespace Ogre {
     {
         friend class SubMesh;
         friend class MeshSerializerImpl;
+        friend class MeshSerializerImpl_Aligned;
         friend class MeshSerializerImpl_v1_4;
         friend class MeshSerializerImpl_v1_2;
         friend class MeshSerializerImpl_v1_1;
@@ -435,6 +436,9 @@ namespace Ogre {
 			to that level of detail. 
 		@par
 			I recommend calling this method before mesh export, not at runtime.
+		@par
+			The levels are generated by QuadricLodGenerator. The submeshes are
+			reduced in parallel using MeshManager's ParallelTaskDispatcher.
 		@param lodValues A list of lod values indicating the values at which new lods should be
 		generated. These are 'user values', before being potentially 
 		transformed by the strategy, so for the distance strategy this is an
@@ -53,6 +53,13 @@ namespace Ogre {
 
     A .mesh file only contains a single mesh, which can itself have multiple submeshes.
 
+    Files with the version [MeshSerializer_v1.41_aligned] have the same layout, except that
+    the faceVertexIndices of M_SUBMESH and the data of M_GEOMETRY_VERTEX_BUFFER_DATA are each
+    preceded by:
+        unsigned short PADDING         : number of padding bytes which follow
+        char*          PADDING_BYTES   : zeros, so that the data starts on a 16 byte boundary
+                                         of the file
+
 */
 
 	enum MeshChunkID {
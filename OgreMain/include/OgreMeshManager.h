@@ -420,6 +420,11 @@ namespace Ogre {
 		*/
 		MeshSerializerListener *getListener();
 
+		/** Gets the object which splits work such as LOD generation between
+			threads, for instance to change its concurrency.
+		*/
+		ParallelTaskDispatcher* getParallelDispatcher(void);
+
         /** @see ManualResourceLoader::loadResource */
         void loadResource(Resource* res);
 
@@ -487,6 +492,9 @@ namespace Ogre {
 
 		// The listener to pass to serializers
 		MeshSerializerListener *mListener;
+
+		/// Created when first needed
+		ParallelTaskDispatcher* mParallelDispatcher;
     };
 
 	/** @} */
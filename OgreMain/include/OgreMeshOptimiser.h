@@ -0,0 +1,196 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __MeshOptimiser_H__
+#define __MeshOptimiser_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreVertexIndexData.h"
+
+namespace Ogre {
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Resources
+	*  @{
+	*/
+	/** Reorders the triangles and vertices of meshes to make better use of
+		the GPU's post-transform vertex cache and to reduce overdraw.
+	@remarks
+		Meshes exported from modelling tools keep whatever triangle order the
+		tool happened to have, so the same vertex is often transformed many
+		times and vertex fetches are scattered. This class applies three
+		passes to each triangle list:
+		<ol>
+		<li>The triangles are reordered to reuse recently transformed
+			vertices, using Tom Forsyth's 'linear speed vertex cache
+			optimisation' scoring.</li>
+		<li>The result is split into clusters, which are sorted so that those
+			facing away from the centre of the mesh are drawn first (as
+			described by Sander, Nehab and Barczak in 'Fast Triangle
+			Reordering for Vertex Locality and Reduced Overdraw'). Clusters
+			are only split where doing so costs less than the overdraw
+			threshold in cache efficiency.</li>
+		<li>The vertices are reordered in the order in which the triangles
+			first use them, and the indexes, bone assignments, poses and morph
+			keyframes which refer to them are remapped.</li>
+		</ol>
+	@par
+		The efficiency of the vertex cache is reported as the ACMR (average
+		cache miss ratio), the number of vertices transformed per triangle
+		when simulating a FIFO cache of the configured size. It can be no
+		lower than 0.5 for a regular grid, and is 3 in the worst case.
+	@par
+		Index and vertex buffers are read back, so must be readable, as with
+		shadow buffers or the DefaultHardwareBufferManager used by tools.
+		Only triangle lists are changed.
+	*/
+	class _OgreExport MeshOptimiser : public ProgMeshAlloc
+	{
+	public:
+		/// Cache statistics of the triangle lists optimised
+		struct Statistics
+		{
+			/// Number of triangles, not counting LOD levels
+			size_t triangleCount;
+			/// Number of vertices transformed by the simulated cache before optimisation
+			size_t cacheMissesBefore;
+			/// Number of vertices transformed by the simulated cache after optimisation
+			size_t cacheMissesAfter;
+
+			Statistics() : triangleCount(0), cacheMissesBefore(0), cacheMissesAfter(0) {}
+			/// Average cache miss ratio before optimisation
+			Real getACMRBefore(void) const
+			{ return triangleCount ? (Real)cacheMissesBefore / triangleCount : 0; }
+			/// Average cache miss ratio after optimisation
+			Real getACMRAfter(void) const
+			{ return triangleCount ? (Real)cacheMissesAfter / triangleCount : 0; }
+		};
+
+		MeshOptimiser();
+		virtual ~MeshOptimiser();
+
+		/** Sets the number of entries of the vertex cache to optimise for
+			(default 16).
+		@remarks
+			Hardware caches range from 12 entries on old GPUs to 32 or more
+			on recent ones; an order made for a small cache also works well
+			on a larger one, but not the other way around.
+		*/
+		void setCacheSize(size_t size) { mCacheSize = std::max(size, (size_t)4); }
+		/** Gets the number of entries of the vertex cache to optimise for. */
+		size_t getCacheSize(void) const { return mCacheSize; }
+
+		/** Sets whether clusters of triangles are sorted to reduce overdraw
+			(default true). */
+		void setOptimiseOverdraw(bool optimise) { mOptimiseOverdraw = optimise; }
+		/** Gets whether clusters of triangles are sorted to reduce overdraw. */
+		bool getOptimiseOverdraw(void) const { return mOptimiseOverdraw; }
+
+		/** Sets how much worse the ACMR of a cluster may become by splitting
+			it to reduce overdraw (default 1.05).
+		@remarks
+			1 only splits where the cache would be flushed anyway; higher
+			values give smaller clusters, which can be sorted better.
+		*/
+		void setOverdrawThreshold(Real threshold) { mOverdrawThreshold = std::max(threshold, (Real)1); }
+		/** Gets how much worse the ACMR of a cluster may become by splitting
+			it to reduce overdraw. */
+		Real getOverdrawThreshold(void) const { return mOverdrawThreshold; }
+
+		/** Sets whether vertices are reordered to match their first use
+			(default true). */
+		void setReorderVertices(bool reorder) { mReorderVertices = reorder; }
+		/** Gets whether vertices are reordered to match their first use. */
+		bool getReorderVertices(void) const { return mReorderVertices; }
+
+		/** Optimises all the submeshes of a mesh, including their LOD levels.
+		@remarks
+			Shared vertex data is reordered once for all the submeshes using
+			it. Edge lists which have been built are rebuilt.
+		*/
+		void optimise(Mesh* mesh);
+
+		/** Optimises a single submesh, including its LOD levels.
+		@remarks
+			If the submesh uses the shared vertex data of its mesh its
+			vertices are not reordered, since other submeshes refer to them;
+			use optimise(Mesh*) in that case. Edge lists are not rebuilt.
+		*/
+		void optimise(SubMesh* subMesh);
+
+		/** Gets the statistics of everything optimised since the last call
+			to resetStatistics. */
+		const Statistics& getStatistics(void) const { return mStatistics; }
+		/** Resets the statistics. */
+		void resetStatistics(void) { mStatistics = Statistics(); }
+
+		/** Counts the vertices which a FIFO cache of the given size would
+			have to transform to draw a triangle list.
+		@remarks
+			Divide by the number of triangles to get the ACMR.
+		*/
+		static size_t countCacheMisses(const IndexData* indexData, size_t cacheSize = 16);
+
+	protected:
+		typedef vector<uint32>::type IndexList;
+		typedef vector<IndexData*>::type IndexDataList;
+
+		size_t mCacheSize;
+		bool mOptimiseOverdraw;
+		Real mOverdrawThreshold;
+		bool mReorderVertices;
+		Statistics mStatistics;
+
+		/// Reorders the triangles of the index data of a submesh and its LOD levels
+		void optimiseTriangles(SubMesh* subMesh, const VertexData* vertexData, bool countStatistics);
+		/// Reorders the triangles of a single list
+		void optimiseTriangles(IndexData* indexData, const VertexData* vertexData, bool countStatistics);
+		/// Reorders the vertices of vertex data to match their first use by the index data
+		void reorderVertices(Mesh* mesh, ushort target, VertexData* vertexData,
+			const IndexDataList& indexDataList);
+
+		/// Forsyth's vertex cache optimisation
+		void optimiseVertexCache(IndexList& indexes, size_t vertexCount) const;
+		/// Sorts clusters of triangles from the outside in
+		void optimiseOverdraw(IndexList& indexes, size_t vertexCount, const VertexData* vertexData) const;
+		/// Simulates a FIFO cache over some triangles, returning the number of misses
+		static size_t simulateCache(const uint32* indexes, size_t indexCount,
+			IndexList& timestamps, uint32& time, size_t cacheSize);
+
+		/// Read the indexes of index data, widening them to 32 bits
+		static void readIndexes(const IndexData* indexData, IndexList& indexes);
+		/// Write back the indexes of index data
+		static void writeIndexes(IndexData* indexData, const IndexList& indexes);
+	};
+	/** @} */
+	/** @} */
+
+}
+
+#endif
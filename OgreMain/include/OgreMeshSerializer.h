@@ -80,9 +80,14 @@ namespace Ogre {
         @param pMesh Pointer to the Mesh to export
         @param filename The destination filename
 		@param endianMode The endian mode of the written file
+		@param alignBuffers If true, the file is written in a variant of the
+			current version with the vertex and index data aligned, so that it
+			can be loaded without copying from a memory mapped file (see
+			FileSystemArchive::setUseMemoryMapping) when it has native
+			endianness. Older versions of OGRE can't read such files.
         */
         void exportMesh(const Mesh* pMesh, const String& filename,
-			Endian endianMode = ENDIAN_NATIVE);
+			Endian endianMode = ENDIAN_NATIVE, bool alignBuffers = false);
 
         /** Imports Mesh and (optionally) Material data from a .mesh file DataStream.
         @remarks
@@ -99,6 +104,8 @@ namespace Ogre {
 		MeshSerializerListener *getListener();
     protected:
         static String msCurrentVersion;
+        /// Version of the current format with aligned buffers
+        static String msAlignedVersion;
 
         typedef map<String, MeshSerializerImpl* >::type MeshSerializerImplMap;
         MeshSerializerImplMap mImplementations;
@@ -128,6 +128,10 @@ namespace Ogre {
 		virtual size_t calcPoseKeyframePoseRefSize(void);
 		virtual size_t calcPoseVertexSize(void);
         virtual size_t calcSubMeshTextureAliasesSize(const SubMesh* pSub);
+        /// Size of the padding written before buffer data which would otherwise start at the given file offset
+        virtual size_t calcBufferDataPaddingSize(size_t offset);
+        /// Write the padding before buffer data starting at the current file position
+        virtual void writeBufferDataPadding(void);
 
 
         virtual void readTextureLayer(DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
@@ -140,6 +144,12 @@ namespace Ogre {
         virtual void readGeometryVertexDeclaration(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexElement(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexBuffer(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
+        /// Create a vertex buffer from the vertex data at the current position of the stream
+        virtual HardwareVertexBufferSharedPtr readVertexBufferData(DataStreamPtr& stream, Mesh* pMesh,
+            size_t vertexSize, size_t vertexCount, const VertexDeclaration::VertexElementList& elems);
+        /// Create an index buffer from the indexes at the current position of the stream
+        virtual HardwareIndexBufferSharedPtr readIndexBufferData(DataStreamPtr& stream, Mesh* pMesh,
+            HardwareIndexBuffer::IndexType itype, size_t indexCount);
 
         virtual void readSkeletonLink(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener);
         virtual void readMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh);
@@ -176,6 +186,36 @@ namespace Ogre {
 
     };
 
+    /** Variant of the current version of the .mesh format whose vertex and
+        index data are aligned in the file, for loading in place.
+    @remarks
+        Each vertex buffer data chunk, and the indexes of each submesh, are
+        preceded by an unsigned short count and that many padding bytes, so
+        that the data starts on a 16 byte boundary of the file. If the file
+        is loaded from a stream held in memory (such as a memory mapped file,
+        see FileSystemArchive::setUseMemoryMapping) and has native endianness,
+        the data is passed to the HardwareBufferManager in place rather than
+        being copied and converted element by element; software buffers use
+        the memory of the stream directly.
+    */
+    class _OgrePrivate MeshSerializerImpl_Aligned : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_Aligned();
+        ~MeshSerializerImpl_Aligned();
+    protected:
+        /// Alignment of buffer data in the file
+        static const size_t BUFFER_ALIGNMENT = 16;
+
+        virtual size_t calcBufferDataPaddingSize(size_t offset);
+        virtual void writeBufferDataPadding(void);
+        virtual void readBufferDataPadding(DataStreamPtr& stream);
+        virtual HardwareVertexBufferSharedPtr readVertexBufferData(DataStreamPtr& stream, Mesh* pMesh,
+            size_t vertexSize, size_t vertexCount, const VertexDeclaration::VertexElementList& elems);
+        virtual HardwareIndexBufferSharedPtr readIndexBufferData(DataStreamPtr& stream, Mesh* pMesh,
+            HardwareIndexBuffer::IndexType itype, size_t indexCount);
+    };
+
     /** Class for providing backwards-compatibility for loading version 1.4 of the .mesh format. */
     class _OgrePrivate MeshSerializerImpl_v1_4 : public MeshSerializerImpl
     {
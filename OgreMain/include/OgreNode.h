@@ -76,6 +76,10 @@ namespace Ogre {
         typedef HashMap<String, Node*> ChildNodeMap;
         typedef MapIterator<ChildNodeMap> ChildNodeIterator;
 		typedef ConstMapIterator<ChildNodeMap> ConstChildNodeIterator;
+		/** A child whose update has been deferred, and the parentHasChanged
+			value to pass to its _update call. */
+		typedef std::pair<Node*, bool> DeferredUpdate;
+		typedef vector<DeferredUpdate>::type DeferredUpdateList;
 
 		/** Listener which gets called back on Node events.
 		*/
@@ -228,12 +232,29 @@ namespace Ogre {
 
 		typedef vector<Node*>::type QueuedUpdates;
 		static QueuedUpdates msQueuedUpdates;
+		/// Guards msQueuedUpdates, which may be added to while the graph is updated in parallel
+		OGRE_STATIC_MUTEX(msQueuedUpdatesMutex)
 
 		DebugRenderable* mDebug;
 
 		/// User objects binding.
 		UserObjectBindings mUserObjectBindings;
 
+		/// The transform pool which holds a copy of this node's transforms, if any
+		TransformPool* mTransformPool;
+		/// Index of this node's slot in mTransformPool
+		size_t mTransformPoolIndex;
+		friend class TransformPool;
+
+		/** Set the derived transforms calculated by a TransformPool.
+		@remarks
+			This takes the place of _updateFromParent for nodes held in a
+			TransformPool, so it clears the update flags and raises the
+			same events.
+		*/
+		virtual void setDerivedTransform(const Vector3& position,
+			const Quaternion& orientation, const Vector3& scale);
+
     public:
         /** Constructor, should only be called by parent, not directly.
         @remarks
@@ -652,6 +673,21 @@ namespace Ogre {
         */
         virtual void _update(bool updateChildren, bool parentHasChanged);
 
+        /** Internal method to update the Node, leaving the update of its children to the caller.
+            @remarks
+                This does what _update(true, parentHasChanged) does for this node, but
+                rather than updating the children which need it, it appends them to a list.
+                Calling _update(true, second) on each of them completes the update, and
+                since their subtrees are independent this can be done in parallel.
+                Node subclasses which need to do more in _update (e.g. SceneNode bounds)
+                must still be given the chance to do it once the children are done.
+            @param
+                parentHasChanged As for _update.
+            @param
+                deferred List to which children still needing an update are appended.
+        */
+        virtual void _updateDeferred(bool parentHasChanged, DeferredUpdateList& deferred);
+
         /** Sets a listener for this Node.
 		@remarks
 			Note for size and performance reasons only one listener per node is
@@ -733,6 +769,8 @@ namespace Ogre {
 			response to a Node::Listener hook, because the graph is already being 
 			updated, and update flag changes cannot be made reliably in that context. 
 			Call this method if you need to queue a needUpdate call in this case.
+			This method is thread safe, so it can also be used from listeners which
+			are called during a parallel scene graph update.
 		*/
 		static void queueNeedUpdate(Node* n);
 		/** Process queued 'needUpdate' calls. */
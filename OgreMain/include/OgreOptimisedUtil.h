@@ -39,6 +39,83 @@ namespace Ogre {
 	/** \addtogroup Math
 	*  @{
 	*/
+	/** Pointers to the components of an array of transforms held in
+		structure-of-arrays form, i.e. one array per component.
+	@note
+		For best performance each array should be aligned to SIMD alignment.
+	*/
+	struct TransformArrays
+	{
+		float* posX;
+		float* posY;
+		float* posZ;
+		float* rotW;
+		float* rotX;
+		float* rotY;
+		float* rotZ;
+		float* scaleX;
+		float* scaleY;
+		float* scaleZ;
+
+		/// Returns the arrays starting from element 'offset'
+		TransformArrays offset(size_t offset) const
+		{
+			TransformArrays ret;
+			ret.posX = posX + offset;
+			ret.posY = posY + offset;
+			ret.posZ = posZ + offset;
+			ret.rotW = rotW + offset;
+			ret.rotX = rotX + offset;
+			ret.rotY = rotY + offset;
+			ret.rotZ = rotZ + offset;
+			ret.scaleX = scaleX + offset;
+			ret.scaleY = scaleY + offset;
+			ret.scaleZ = scaleZ + offset;
+			return ret;
+		}
+	};
+
+	/** Pointers to the components of an array of axis aligned boxes held in
+		structure-of-arrays form, as their centres and half sizes.
+	@note
+		For best performance each array should be aligned to SIMD alignment.
+	*/
+	struct AxisAlignedBoxArrays
+	{
+		float* centreX;
+		float* centreY;
+		float* centreZ;
+		float* halfSizeX;
+		float* halfSizeY;
+		float* halfSizeZ;
+	};
+
+	/** Pointers to the components of an array of spheres held in
+		structure-of-arrays form.
+	@note
+		For best performance each array should be aligned to SIMD alignment.
+	*/
+	struct SphereArrays
+	{
+		float* centreX;
+		float* centreY;
+		float* centreZ;
+		float* radius;
+	};
+
+	/** Pointers to the components of an array of quaternions held in
+		structure-of-arrays form.
+	@note
+		For best performance each array should be aligned to SIMD alignment.
+	*/
+	struct QuaternionArrays
+	{
+		float* w;
+		float* x;
+		float* y;
+		float* z;
+	};
+
 	/** Utility class for provides optimised functions.
     @note
         This class are supposed used by internal engine only.
@@ -179,6 +256,51 @@ namespace Ogre {
             char* lightFacings,
             size_t numFaces) = 0;
 
+        /** Calculate the light facing state of the triangle's face normals,
+            as a bitmask.
+        @remarks
+            This is the same test as calculateLightFacing, but it stores one
+            bit per face, which is what findSilhouetteEdges expects.
+        @param lightPos 4D position of the light in object space, note that
+            for directional lights (which have no position), the w component
+            is 0 and the x/y/z position are the direction.
+        @param faceNormals An array of face normals for the triangles. This
+            array must be aligned to SIMD alignment.
+        @param lightFacingMask Array of (numFaces + 31) / 32 masks to store
+            the results in: bit (i % 32) of lightFacingMask[i / 32] is set if
+            face i is facing the light. Unused bits of the last mask are
+            cleared.
+        @param numFaces Number of face normals to calculate.
+        */
+        virtual void calculateLightFacingMask(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            uint32* lightFacingMask,
+            size_t numFaces) = 0;
+
+        /** Finds the silhouette edges of a batch of edges.
+        @remarks
+            An edge is on the silhouette if one of its triangles is facing the
+            light and the other isn't, or if it is degenerate and its only
+            triangle is facing the light. The vertex indexes of each of these
+            edges are stored in the order they run anticlockwise around the
+            light facing triangle, which is the order the sides of a shadow
+            volume are built in.
+        @param lightFacingMask The light facing state of the triangles the
+            edges refer to, as calculated by calculateLightFacingMask.
+        @param edges The edges to test.
+        @param numEdges Number of edges to test.
+        @param silhouetteEdges Array to store the vertex index pairs of the
+            silhouette edges in, one after another. It must have room for
+            numEdges pairs, although only as many as are returned are used.
+        @returns The number of silhouette edges found.
+        */
+        virtual size_t findSilhouetteEdges(
+            const uint32* lightFacingMask,
+            const EdgeData::Edge* edges,
+            size_t numEdges,
+            uint32* silhouetteEdges) = 0;
+
         /** Extruding vertices by a fixed distance based on light position.
         @param lightPos 4D light position, when w=0.0f this represents a
             directional light, otherwise, w must be equal to 1.0f, which
@@ -199,6 +321,222 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) = 0;
+
+        /** Transforms vertex positions or directions by an affine matrix.
+        @remarks
+            Positions are transformed by the whole matrix. Directions are only
+            transformed by the upper 3x3 part and then normalised, so for
+            normals the inverse transpose of the position transform should
+            be passed.
+        @param matrix The affine matrix to transform by.
+        @param srcPtr Pointer to the first source vector, which is a 3D vector
+            packed in xyz format. No SIMD alignment requirement.
+        @param srcStride Distance in bytes between consecutive source vectors.
+        @param destPtr Pointer to the first destination vector, which is a 3D
+            vector packed in xyz format. No SIMD alignment requirement, and
+            it's allowed to be the same as srcPtr.
+        @param destStride Distance in bytes between consecutive destination vectors.
+        @param numVertices Number of vectors to transform.
+        @param directions Whether the vectors are directions rather than positions.
+        */
+        virtual void transformAffineVertices(
+            const Matrix4& matrix,
+            const float* srcPtr,
+            size_t srcStride,
+            float* destPtr,
+            size_t destStride,
+            size_t numVertices,
+            bool directions) = 0;
+
+        /** Calculates derived transforms for a batch of nodes from the derived
+            transforms of their parents.
+        @remarks
+            For each node this calculates what Node::_updateFromParent does for
+            a node which inherits orientation and scale:
+            derived orientation = parent orientation * orientation,
+            derived scale = parent scale * scale, and
+            derived position = parent orientation * (parent scale * position) + parent position.
+        @param parentTransforms The derived transforms of the parents, gathered
+            so that element i is the parent of node i.
+        @param localTransforms The transforms of the nodes relative to their parents.
+        @param derivedTransforms The arrays to store the derived transforms in,
+            which must not overlap the source arrays.
+        @param numNodes Number of nodes to calculate.
+        @note
+            All arrays must be aligned to SIMD alignment.
+        */
+        virtual void calculateDerivedTransforms(
+            const TransformArrays& parentTransforms,
+            const TransformArrays& localTransforms,
+            const TransformArrays& derivedTransforms,
+            size_t numNodes) = 0;
+
+        /** Tests a batch of axis aligned boxes against a convex volume bounded
+            by planes, such as a frustum.
+        @remarks
+            A box is culled if it lies entirely on the negative side of any of
+            the planes, which is the test Frustum::isVisible does for a single
+            box. Null and infinite boxes can't be represented by a centre and
+            half size, so they must be dealt with by the caller.
+        @param planes The planes bounding the volume, facing into it.
+        @param numPlanes Number of planes.
+        @param boxes The boxes to test.
+        @param visibility Array of (numBoxes + 31) / 32 masks to store the
+            results in, one bit per box: bit (i % 32) of visibility[i / 32]
+            is set if box i is not culled.
+        @param numBoxes Number of boxes to test.
+        @note
+            All box arrays must be aligned to SIMD alignment.
+        */
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const AxisAlignedBoxArrays& boxes,
+            uint32* visibility,
+            size_t numBoxes) = 0;
+
+        /** Tests a batch of spheres against a convex volume bounded by planes,
+            such as a frustum.
+        @remarks
+            A sphere is culled if it lies entirely on the negative side of any
+            of the planes, which is the test Frustum::isVisible does for a
+            single sphere.
+        @param planes The planes bounding the volume, facing into it.
+        @param numPlanes Number of planes.
+        @param spheres The spheres to test.
+        @param visibility Array of (numSpheres + 31) / 32 masks to store the
+            results in, one bit per sphere: bit (i % 32) of visibility[i / 32]
+            is set if sphere i is not culled.
+        @param numSpheres Number of spheres to test.
+        @note
+            All sphere arrays must be aligned to SIMD alignment.
+        */
+        virtual void cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const SphereArrays& spheres,
+            uint32* visibility,
+            size_t numSpheres) = 0;
+
+        /** Interpolates a batch of pairs of quaternions.
+        @remarks
+            This calculates Quaternion::nlerp(t[i], from[i], to[i], shortestPath)
+            for each i, i.e. a linear interpolation followed by normalisation.
+        @param from The quaternions to interpolate from.
+        @param to The quaternions to interpolate to.
+        @param t The interpolation factor for each pair.
+        @param result The arrays to store the results in, which may be the
+            same as from or to.
+        @param count Number of quaternions to interpolate.
+        @param shortestPath Whether to negate 'to' where that is closer to 'from'.
+        @note
+            All arrays must be aligned to SIMD alignment.
+        */
+        virtual void nlerpQuaternions(
+            const QuaternionArrays& from,
+            const QuaternionArrays& to,
+            const float* t,
+            const QuaternionArrays& result,
+            size_t count,
+            bool shortestPath) = 0;
+
+        /** Adds a scaled array of values to another.
+        @remarks
+            This calculates dest[i] += src[i] * scale for each i, e.g. to
+            move a batch of particles along their directions.
+        @param dest The values to add to.
+        @param src The values to scale and add.
+        @param scale The factor to multiply the source values by.
+        @param count Number of values.
+        @note
+            Both arrays must be aligned to SIMD alignment.
+        */
+        virtual void accumulateScaled(
+            float* dest,
+            const float* src,
+            float scale,
+            size_t count) = 0;
+
+        /** Scales, offsets and clamps an array of values in place.
+        @remarks
+            This calculates values[i] = clamp(values[i] * scale + offset,
+            minValue, maxValue) for each i. Pass infinite limits for no
+            clamping.
+        @param values The values to modify.
+        @param count Number of values.
+        @param scale The factor to multiply each value by.
+        @param offset The amount to add after scaling.
+        @param minValue The smallest result allowed.
+        @param maxValue The largest result allowed.
+        @note
+            The array must be aligned to SIMD alignment.
+        */
+        virtual void scaleOffsetClamp(
+            float* values,
+            size_t count,
+            float scale,
+            float offset,
+            float minValue,
+            float maxValue) = 0;
+
+        /** Generates the vertices of a batch of quads, such as billboards,
+            from their centres and corner offsets.
+        @remarks
+            Each quad gets 4 vertices, in the order left-top, right-top,
+            left-bottom, right-bottom. A vertex is 3 floats of position (the
+            centre plus the offset of its corner), the 32 bit colour of the
+            quad and 2 floats of texture coordinates taken from the corners
+            of the quad's texture rectangle; this is the layout BillboardSet
+            uses, 24 bytes per vertex.
+        @param centres The centre of each quad, as 4 floats of which the last
+            is ignored.
+        @param offsets The offsets of the corners of each quad from its
+            centre, in vertex order, as 4 floats each of which the last is
+            ignored.
+        @param offsetStride Number of floats between the offsets of
+            consecutive quads; 0 if all the quads share the same offsets.
+        @param colours The colour of each quad, already in vertex colour format.
+        @param texCoords The texture rectangle of each quad, as 4 floats:
+            left, top, right and bottom.
+        @param dest Pointer to the first vertex to write. No SIMD alignment
+            requirement.
+        @param numQuads Number of quads to generate.
+        @note
+            The source arrays must be aligned to SIMD alignment.
+        */
+        virtual void generateQuadVertices(
+            const float* centres,
+            const float* offsets,
+            size_t offsetStride,
+            const uint32* colours,
+            const float* texCoords,
+            float* dest,
+            size_t numQuads) = 0;
+
+        /** Calculates the normals of a run of vertices along a row of a
+            regular height grid, such as a terrain.
+        @remarks
+            The normal of each vertex is the normalised sum of the unit normals
+            of the 8 triangles that fan from it to its neighbouring vertices,
+            with the vertex positions taken as (column * spacing, row * spacing,
+            height). Successive rows are taken to increase in that second
+            axis, and the normals are in the same space.
+        @param heights Pointer to the height of the first vertex of the run.
+            The heights of the columns either side of the run and of the rows
+            above and below it must be valid too.
+        @param rowStride Number of floats between the heights of vertically
+            adjacent vertices.
+        @param spacing Distance between adjacent vertices in the grid.
+        @param normals Pointer to receive the normals, 3 floats each. No SIMD
+            alignment requirement.
+        @param count Number of vertices in the run.
+        */
+        virtual void calculateHeightfieldNormals(
+            const float* heights,
+            size_t rowStride,
+            float spacing,
+            float* normals,
+            size_t count) = 0;
     };
 
     /** Returns raw offseted of the given pointer.
@@ -0,0 +1,161 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ParallelTaskDispatcher_H__
+#define __ParallelTaskDispatcher_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreWorkQueue.h"
+#include "OgreAtomicWrappers.h"
+#include "OgreSharedPtr.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup General
+	*  @{
+	*/
+
+	/** Splits a number of independent tasks between the calling thread and the
+		workers of Root's WorkQueue, and waits for them all to complete.
+	@remarks
+		This is for work which is needed in the current frame, such as updating
+		the scene graph, where the calling thread can't carry on until the work
+		is done. The calling thread processes tasks itself rather than just
+		waiting, so dispatch() always completes even if every worker is busy
+		with other requests or the queue hasn't been started; it then simply
+		does all the work itself.
+	@par
+		Tasks are claimed in batches of 'grainSize' from a shared counter, so
+		threads which finish early pick up the remaining work. If
+		OGRE_THREAD_SUPPORT is 0 all tasks are processed by the calling thread.
+	*/
+	class _OgreExport ParallelTaskDispatcher : public WorkQueue::RequestHandler, public UtilityAlloc
+	{
+	public:
+		/** Interface for a set of tasks identified by index.
+		*/
+		class _OgreExport TaskSet
+		{
+		public:
+			virtual ~TaskSet() {}
+			/** Process the tasks with indexes from begin up to (but not including) end.
+			@remarks
+				This is called from several threads at once, for ranges which
+				never overlap.
+			*/
+			virtual void processTasks(size_t begin, size_t end) = 0;
+		};
+
+		/** Constructor.
+		@param channelName The name of the WorkQueue channel to post requests to
+		*/
+		ParallelTaskDispatcher(const String& channelName);
+		virtual ~ParallelTaskDispatcher();
+
+		/** Process tasks [0, taskCount) and return once all of them are done.
+		@param tasks The tasks to process
+		@param taskCount The number of tasks
+		@param grainSize The number of tasks which a thread claims at once
+		*/
+		void dispatch(TaskSet* tasks, size_t taskCount, size_t grainSize = 1);
+
+		/** Set the number of threads which dispatch() will try to use, including
+			the calling thread.
+		@param threads The number of threads, or 0 (the default) to match the
+			hardware concurrency
+		*/
+		void setConcurrency(size_t threads) { mConcurrency = threads; }
+		/** Get the number of threads which dispatch() will try to use, including
+			the calling thread.
+		*/
+		size_t getConcurrency() const;
+
+		/** Set the queue whose workers help with dispatch(), instead of Root's.
+		@remarks
+			This lets tools which don't create a Root use several threads. The
+			queue must have been started, and must outlive this object or be
+			replaced first. Pass 0 to go back to using Root's queue.
+		*/
+		void setWorkQueue(WorkQueue* queue);
+
+		/// @copydoc WorkQueue::RequestHandler::handleRequest
+		WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
+
+	protected:
+		/// State shared by the threads working on one dispatch() call
+		struct Job : public UtilityAlloc
+		{
+			TaskSet* tasks;
+			size_t taskCount;
+			size_t grainSize;
+			size_t batchCount;
+			/// Index of the next batch to claim
+			AtomicScalar<size_t> nextBatch;
+			/// Number of batches completed
+			AtomicScalar<size_t> completedBatches;
+			/// Description of the first exception raised by a task
+			String error;
+			OGRE_MUTEX(errorMutex)
+
+			Job() : tasks(0), taskCount(0), grainSize(1), batchCount(0),
+				nextBatch(0), completedBatches(0) {}
+			/// Claim and process batches until there are none left
+			void run();
+		};
+		typedef SharedPtr<Job> JobPtr;
+
+		/// Data carried by the requests posted to the WorkQueue
+		struct JobRequest
+		{
+			JobPtr job;
+			_OgreExport friend std::ostream& operator<<(std::ostream& o, const JobRequest& r)
+			{ (void)r; return o; }
+		};
+
+		String mChannelName;
+		/// The queue our handler is registered with
+		WorkQueue* mWorkQueue;
+		/// The queue set with setWorkQueue, if any
+		WorkQueue* mUserWorkQueue;
+		uint16 mChannel;
+		size_t mConcurrency;
+
+		/// Register with the user's or Root's current WorkQueue if it has changed
+		void registerWithWorkQueue();
+		/// Unregister from the queue we registered with, if it still exists
+		void unregisterFromWorkQueue();
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -109,6 +109,34 @@ namespace Ogre {
         */
         virtual void _affectParticles(ParticleSystem* pSystem, Real timeElapsed) = 0;
 
+        /** Returns whether this affector implements _affectParticleArrays.
+        @remarks
+            Particle systems which hold their particles in arrays (see
+            ParticleSystem::setParticleArraysEnabled) still call
+            _affectParticles on affectors which don't, after copying the
+            arrays back to the particles.
+        */
+        virtual bool supportsParticleArrays(void) const { return false; }
+
+        /** Method called to apply the affector to all active particles of a system
+            at once, when they are held in structure-of-arrays form.
+        @remarks
+            This must have the same effect as _affectParticles, except that
+            the particle system should be notified of rotated or resized
+            particles once rather than for every particle. It is only called
+            if supportsParticleArrays returns true.
+        @param
+            pSystem Pointer to the ParticleSystem being affected.
+        @param
+            particles The state of the active particles of the system.
+        @param
+            timeElapsed The number of seconds which have elapsed since the last call.
+        */
+        virtual void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+                {
+                    (void)pSystem; (void)particles; (void)timeElapsed;
+                }
+
         /** Returns the name of the type of affector. 
         @remarks
             This property is useful for determining the type of affector procedurally so another
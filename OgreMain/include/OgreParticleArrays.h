@@ -0,0 +1,130 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ParticleArrays_H__
+#define __ParticleArrays_H__
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre {
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Effects
+	*  @{
+	*/
+	/** Holds the state of the active particles of a ParticleSystem in
+		structure-of-arrays form, so that they can be updated in batches.
+	@remarks
+		Each component of the particles is held in its own contiguous array,
+		aligned to SIMD alignment, so an affector can update every particle
+		with a few calls to the OptimisedUtil array functions rather than
+		visiting the particles one at a time. Element i of every array
+		belongs to the same particle, getParticle(i).
+	@par
+		Emitters and renderers still work with Particle instances, so the
+		particle system appends new particles to the arrays as they are
+		emitted and copies the arrays back to the particles after each
+		update. See ParticleSystem::setParticleArraysEnabled.
+	*/
+	class _OgreExport ParticleArrays : public FXAlloc
+	{
+	public:
+		typedef list<Particle*>::type ParticleList;
+
+		ParticleArrays();
+		~ParticleArrays();
+
+		/** Append the state of a range of particles to the arrays.
+		@remarks
+			The iterators are kept, so that the particles can be removed
+			from their list without searching it.
+		*/
+		void append(ParticleList::iterator begin, ParticleList::iterator end);
+		/** Copy the state held in the arrays back to the particles. */
+		void scatter(void) const;
+
+		/// Remove all the particles
+		void clear(void) { mCount = 0; }
+		/// Remove the particles from element count onwards
+		void truncate(size_t count) { if (count < mCount) mCount = count; }
+		/// Copy the particle in element src over element dest
+		void copyElement(size_t dest, size_t src);
+
+		/// Get the number of particles held
+		size_t getCount(void) const { return mCount; }
+		/// Get the particle whose state is held in element index of the arrays
+		Particle* getParticle(size_t index) const { return mParticles[index]; }
+		/// Get the position of the particle in element index in the list it was appended from
+		ParticleList::iterator getIterator(size_t index) const { return mIterators[index]; }
+
+		float* positionX;
+		float* positionY;
+		float* positionZ;
+		float* directionX;
+		float* directionY;
+		float* directionZ;
+		float* colourR;
+		float* colourG;
+		float* colourB;
+		float* colourA;
+		/// Rotation in radians
+		float* rotation;
+		/// Rotation speed in radians per second
+		float* rotationSpeed;
+		/// Own width, only meaningful where ownDimensions is set
+		float* width;
+		/// Own height, only meaningful where ownDimensions is set
+		float* height;
+		float* timeToLive;
+		float* totalTimeToLive;
+		/// Whether each particle has its own dimensions (1) or uses the system's defaults (0)
+		uint8* ownDimensions;
+
+	protected:
+		/// Number of float arrays held in the one block
+		static const size_t NUM_FLOAT_ARRAYS = 16;
+
+		vector<Particle*>::type mParticles;
+		vector<ParticleList::iterator>::type mIterators;
+		size_t mCount;
+		/// Number of elements allocated for each array, a multiple of 4
+		size_t mCapacity;
+
+		/// Make room for at least count particles, keeping those held
+		void reserve(size_t count);
+		/// Point the arrays into a block allocated for capacity particles
+		void setArrays(float* block, size_t capacity);
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
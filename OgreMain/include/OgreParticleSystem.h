@@ -144,6 +144,13 @@ namespace Ogre {
 			String doGet(const void* target) const;
 			void doSet(void* target, const String& val);
 		};
+		/** Command object for particle arrays (see ParamCommand).*/
+		class CmdParticleArrays : public ParamCommand
+		{
+		public:
+			String doGet(const void* target) const;
+			void doSet(void* target, const String& val);
+		};
 
         /// Default constructor required for STL creation in manager
         ParticleSystem();
@@ -558,6 +565,27 @@ namespace Ogre {
 		/// Gets whether particles are sorted relative to the camera.
 		bool getSortingEnabled(void) const { return mSorted; }
 
+		/** Set whether affectors and motion are applied to the particles in
+			batches, held in structure-of-arrays form.
+		@remarks
+			When enabled, the state of the active particles is kept in
+			contiguous arrays (see ParticleArrays) between updates, and new
+			particles are added to them as they are emitted. Expiry, motion and
+			affectors which support it (ParticleAffector::supportsParticleArrays)
+			then update every particle at once, using SIMD where it is
+			available, and the results are copied back to the particles once
+			per update for the emitters and the renderer. Affectors which don't
+			support arrays still work, but each one costs an extra copy each way.
+		@par
+			Sorting the particles, or accessing them through getParticle or
+			_getIterator, means the arrays have to be gathered again on the
+			next update. This is worthwhile for systems with many particles
+			whose affectors all support arrays. It is disabled by default.
+		*/
+		void setParticleArraysEnabled(bool enabled);
+		/// Gets whether affectors and motion are applied to the particles in batches.
+		bool getParticleArraysEnabled(void) const { return mParticleArraysEnabled; }
+
         /** Set the (initial) bounds of the particle system manually. 
         @remarks
             If you can, set the bounds of a particle system up-front and 
@@ -652,6 +680,7 @@ namespace Ogre {
 		static CmdLocalSpace msLocalSpaceCmd;
 		static CmdIterationInterval msIterationIntervalCmd;
 		static CmdNonvisibleTimeout msNonvisibleTimeoutCmd;
+		static CmdParticleArrays msParticleArraysCmd;
 
 
         AxisAlignedBox mAABB;
@@ -683,6 +712,12 @@ namespace Ogre {
         bool mIterationIntervalSet;
 		/// Particles sorted according to camera?
 		bool mSorted;
+		/// Affectors and motion applied to particle arrays?
+		bool mParticleArraysEnabled;
+		/// Whether mParticleArrays must be gathered from the particles again
+		bool mParticleArraysDirty;
+		/// State of the active particles, for updating them as arrays
+		ParticleArrays* mParticleArrays;
 		/// Particles in local space?
 		bool mLocalSpace;
 		/// Update timeout when nonvisible (0 for no timeout)
@@ -817,6 +852,9 @@ namespace Ogre {
         /** Internal method used to expire dead particles. */
         void _expire(Real timeElapsed);
 
+        /** Expires a single active particle. */
+        void _expireParticle(ActiveParticleList::iterator i);
+
         /** Spawn new particles based on free quota and emitter requirements. */
         void _triggerEmitters(Real timeElapsed);
 
@@ -830,6 +868,13 @@ namespace Ogre {
         /** Applies the effects of affectors. */
         void _triggerAffectors(Real timeElapsed);
 
+        /** Expires particles and applies the effects of affectors and then the
+            motion of the rest, with the particles held in arrays. */
+        void _updateParticleArrays(Real timeElapsed);
+
+        /** Brings mParticleArrays up to date with the active particles. */
+        void _syncParticleArrays(void);
+
 		/** Sort the particles in the system **/
 		void _sortParticles(Camera* cam);
 
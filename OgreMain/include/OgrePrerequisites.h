@@ -133,6 +133,7 @@ namespace Ogre {
     class Camera;
     class Codec;
     class ColourValue;
+	class CompressedNodeAnimationTrack;
     class ConfigDialog;
     template <typename T> class Controller;
     template <typename T> class ControllerFunction;
@@ -169,6 +170,7 @@ namespace Ogre {
 	class HighLevelGpuProgramManager;
 	class HighLevelGpuProgramFactory;
     class IndexData;
+	class InstanceManager;
     class IntersectionSceneQuery;
     class IntersectionSceneQueryListener;
     class Image;
@@ -202,9 +204,11 @@ namespace Ogre {
     class OverlayElement;
     class OverlayElementFactory;
     class OverlayManager;
+    class ParallelTaskDispatcher;
     class Particle;
     class ParticleAffector;
     class ParticleAffectorFactory;
+    class ParticleArrays;
     class ParticleEmitter;
     class ParticleEmitterFactory;
     class ParticleSystem;
@@ -256,6 +260,7 @@ namespace Ogre {
     class SceneNode;
     class SceneQuery;
     class SceneQueryListener;
+	class ScriptCache;
 	class ScriptCompiler;
 	class ScriptCompilerManager;
 	class ScriptLoader;
@@ -285,7 +290,9 @@ namespace Ogre {
     class Texture;
     class TexturePtr;
     class TextureManager;
+    class TraceProfiler;
     class TransformKeyFrame;
+    class TransformPool;
 	class Timer;
 	class UserObjectBindings;
     class Vector2;
@@ -0,0 +1,217 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __QuadricLodGenerator_H__
+#define __QuadricLodGenerator_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreProgressiveMesh.h"
+#include "OgreVector2.h"
+
+namespace Ogre {
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup LOD
+	*  @{
+	*/
+	/** Generates reduced versions of indexed triangle lists by collapsing
+		edges in the order of least quadric error.
+	@remarks
+		This does the same job as ProgressiveMesh, and is what
+		Mesh::generateLodLevels uses, but scales to much larger meshes. Every
+		vertex keeps a quadric, the sum of the squared distances to the planes
+		of the triangles it has absorbed (after Garland and Heckbert), and the
+		cheapest collapse of each vertex is kept in a priority queue, so
+		each collapse only re-evaluates the vertices around it.
+	@par
+		Since the levels are index buffers over the original vertices, a
+		vertex is always collapsed onto one of its neighbours. Vertices
+		duplicated at the same position to hold different normals or texture
+		coordinates are treated as one; vertices on such seams, and on open
+		borders, may only move along them, and corners where they meet are
+		kept. The difference in normal and texture coordinate between a
+		vertex and its replacement is added to the cost (see
+		setAttributeWeight).
+	@par
+		All the vertex and index data is read when the generator is created,
+		so computeLevels doesn't touch the buffers and can run on any thread;
+		bakeLevels creates the index buffers so should be called from the
+		thread which owns the render system.
+	*/
+	class _OgreExport QuadricLodGenerator : public ProgMeshAlloc
+	{
+	public:
+		/** Constructor, reads the geometry.
+		@remarks
+			As with ProgressiveMesh, don't pass write-only buffers without
+			shadow buffers. Only triangle lists are supported, and positions
+			must be VET_FLOAT3.
+		*/
+		QuadricLodGenerator(const VertexData* vertexData, const IndexData* indexData);
+		virtual ~QuadricLodGenerator();
+
+		/** Sets how much changes in normal and texture coordinate count
+			against a collapse (default 0.01).
+		@remarks
+			A difference of 1 in texture coordinate (or between unit
+			normals) costs the same as moving the surface by the square root
+			of this times the radius of the geometry.
+		*/
+		void setAttributeWeight(Real weight) { mAttributeWeight = weight; }
+		/** Gets how much changes in normal and texture coordinate count
+			against a collapse. */
+		Real getAttributeWeight(void) const { return mAttributeWeight; }
+
+		/** Sets how strongly open borders and seams are kept in place
+			(default 10). */
+		void setBorderWeight(Real weight) { mBorderWeight = weight; }
+		/** Gets how strongly open borders and seams are kept in place. */
+		Real getBorderWeight(void) const { return mBorderWeight; }
+
+		/** Computes the reduced levels, without creating any buffers.
+		@param numLevels The number of levels, excluding the full detail version
+		@param quota The way to derive the number of vertices removed at each level
+		@param reductionValue Either the proportion of vertices to remove at each level,
+			or a fixed number of vertices to remove at each level, depending on quota
+		*/
+		void computeLevels(ushort numLevels,
+			ProgressiveMesh::VertexReductionQuota quota = ProgressiveMesh::VRQ_PROPORTIONAL,
+			Real reductionValue = 0.5f);
+
+		/** Creates index data for each of the levels computed, adding them to
+			the list in decreasing order of detail. */
+		void bakeLevels(ProgressiveMesh::LODFaceList* outList) const;
+
+		/** Computes and bakes the levels, as ProgressiveMesh::build. */
+		void build(ushort numLevels, ProgressiveMesh::LODFaceList* outList,
+			ProgressiveMesh::VertexReductionQuota quota = ProgressiveMesh::VRQ_PROPORTIONAL,
+			Real reductionValue = 0.5f);
+
+		/** Gets the number of levels computed. */
+		size_t getNumLevels(void) const { return mLevels.size(); }
+
+		/** Gets an estimate of the largest distance by which the surface of a
+			level moved, from the root mean square distance of the vertices
+			collapsed to the planes of the triangles they have absorbed. */
+		Real getLevelError(size_t level) const { return mLevelErrors[level]; }
+
+	protected:
+		typedef vector<uint32>::type IndexList;
+
+		/// Sum of squared distances to planes
+		struct Quadric
+		{
+			double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+			/// Total area of the triangles summed
+			double area;
+
+			Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0), area(0) {}
+			void addPlane(const Vector3& n, Real d, double weight);
+			Quadric& operator+=(const Quadric& rhs);
+			double evaluate(const Vector3& p) const;
+		};
+
+		/// The cheapest collapse of a vertex, as held in the queue
+		struct Collapse
+		{
+			double cost;
+			double error;
+			uint32 vertex;
+			uint32 target;
+			uint32 version;
+			/// Reversed, so that the queue gives the cheapest first
+			bool operator<(const Collapse& rhs) const { return cost > rhs.cost; }
+		};
+
+		/// An edge from a vertex, by position
+		struct Edge
+		{
+			uint32 vertex;
+			/// Number of triangles using the edge
+			uint32 triangles;
+			/// Vertices used at each end by the first triangle
+			uint32 wedgeFrom, wedgeTo;
+			/// Whether triangles use different vertices for the edge
+			bool seam;
+			/// Area weighted normal of the triangles
+			Vector3 normal;
+		};
+		typedef vector<Edge>::type EdgeList;
+
+		HardwareIndexBuffer::IndexType mIndexType;
+		Real mAttributeWeight;
+		Real mBorderWeight;
+
+		/// Original triangles, by vertex
+		IndexList mIndexes;
+		/// The position of each vertex, and its attributes
+		IndexList mVertexPosition;
+		vector<Vector3>::type mNormals;
+		vector<Vector2>::type mUVs;
+		/// Distinct positions
+		vector<Vector3>::type mPositions;
+		/// Squared radius of the geometry
+		double mAttributeScale;
+
+		/// Current triangles, by vertex, and whether they have gone
+		IndexList mTriangles;
+		vector<uchar>::type mTriangleRemoved;
+		/// Triangles and vertices using each position
+		vector<IndexList>::type mPositionTriangles;
+		vector<IndexList>::type mPositionVertices;
+		vector<Quadric>::type mQuadrics;
+		/// Changed whenever a position's best collapse needs recalculating
+		IndexList mVersions;
+		vector<uchar>::type mPositionRemoved;
+
+		/// Triangles of each level, by vertex
+		vector<IndexList>::type mLevels;
+		vector<Real>::type mLevelErrors;
+
+		/// Set up the working state from the original triangles
+		void initialise(void);
+		/// Gather the edges from a position
+		void gatherEdges(uint32 position, EdgeList& edges) const;
+		/// Find the cheapest valid collapse of a position
+		bool evaluate(uint32 position, Collapse& collapse) const;
+		/// Collapse a position onto another
+		void collapse(uint32 position, uint32 target);
+		/// Find the vertex at the target position to replace a vertex with
+		uint32 findReplacement(uint32 vertex, uint32 position, uint32 target) const;
+		/// Squared difference in the attributes of two vertices
+		double attributeDistance(uint32 a, uint32 b) const;
+		/// Whether a triangle uses a position
+		bool usesPosition(uint32 triangle, uint32 position) const;
+	};
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -76,11 +76,16 @@ namespace Ogre {
 		/// Debug pointer back to renderable which created this
 		const Renderable* srcRenderable;
 
+		/** The number of instances to draw. Buffers marked as instance data
+			advance once per instance, the others are repeated for each one.
+		@see HardwareVertexBuffer::setIsInstanceData
+		*/
+		size_t numberOfInstances;
 
 
         RenderOperation() :
             vertexData(0), operationType(OT_TRIANGLE_LIST), useIndexes(true),
-                indexData(0), srcRenderable(0) {}
+                indexData(0), srcRenderable(0), numberOfInstances(1) {}
 
 
 	};
@@ -130,7 +130,18 @@ namespace Ogre {
 			/** Sort ascending camera distance 
 				Note value overlaps with descending since both use same sort
 			*/
-			OM_SORT_ASCENDING = 6
+			OM_SORT_ASCENDING = 6,
+			/** Group by pass, using a single sort of a flat list rather than a map.
+			@remarks
+				Each item is given a 64-bit key made from the hash of its pass, an
+				identifier for the pass itself and its view depth, and the list
+				is radix sorted on that key. Visitors see the same pass / renderable 
+				calls as OM_PASS_GROUP (and it will be used if OM_PASS_GROUP is 
+				requested but not available), with the renderables in each group 
+				ordered front to back. This avoids a map insertion per item, so
+				is faster for collections of many thousands of renderables. 
+			*/
+			OM_SORT_KEY = 8
 		};
 
 	protected:
@@ -231,6 +242,32 @@ namespace Ogre {
         /// Radix sorter for sort value 2 (distance)
 		static RadixSort<RenderablePassList, RenderablePass, float> msRadixSorter2;
 
+		/** Functor for the sort key used by OM_SORT_KEY.
+		@remarks
+			The collection already belongs to a single queue group and priority, 
+			so the key is made up of (high to low bits): 32 bits of pass hash,
+			16 bits hashed from the pass pointer to keep passes whose hashes
+			collide apart, and the top 16 bits of the squared view depth, which
+			for a positive float sort in the same order as the float itself.
+		*/
+		struct RadixSortFunctorSortKey
+		{
+			const Camera* camera;
+
+			RadixSortFunctorSortKey(const Camera* cam)
+				: camera(cam)
+			{
+			}
+
+			uint64 operator()(const RenderablePass& p) const
+			{
+				return getSortKey(p.pass, p.renderable->getSquaredViewDepth(camera));
+			}
+		};
+
+		/// Radix sorter for the OM_SORT_KEY list
+		static RadixSort<RenderablePassList, RenderablePass, uint64> msRadixSorterKey;
+
 		/// Bitmask of the organisation modes requested
 		uint8 mOrganisationMode;
 
@@ -238,6 +275,8 @@ namespace Ogre {
 		PassGroupRenderableMap mGrouped;
 		/// Sorted descending (can iterate backwards to get ascending)
 		RenderablePassList mSortedDescending;
+		/// Sorted by key, for OM_SORT_KEY
+		RenderablePassList mSortedByKey;
 
 		/// Internal visitor implementation
 		void acceptVisitorGrouped(QueuedRenderableVisitor* visitor) const;
@@ -245,6 +284,8 @@ namespace Ogre {
 		void acceptVisitorDescending(QueuedRenderableVisitor* visitor) const;
 		/// Internal visitor implementation
 		void acceptVisitorAscending(QueuedRenderableVisitor* visitor) const;
+		/// Internal visitor implementation
+		void acceptVisitorSortKey(QueuedRenderableVisitor* visitor) const;
 
 	public:
 		QueuedRenderableCollection();
@@ -299,6 +340,12 @@ namespace Ogre {
 		/** Merge renderable collection. 
 		*/
 		void merge( const QueuedRenderableCollection& rhs );
+
+		/** Calculate the key which OM_SORT_KEY orders items by.
+		@param pass The pass the item is rendered with
+		@param squaredViewDepth The squared view depth of the renderable
+		*/
+		static uint64 getSortKey(const Pass* pass, Real squaredViewDepth);
 	};
 
 	/** Collection of renderables by priority.
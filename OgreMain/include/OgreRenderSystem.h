@@ -1134,6 +1134,44 @@ namespace Ogre
 		/** Only binds Gpu program parameters used for passes that have more than one iteration rendering
 		*/
 		virtual void bindGpuProgramPassIterationParameters(GpuProgramType gptype) = 0;
+
+		/** Statistics about the GPU program parameters passed to the render 
+			system in a frame.
+		*/
+		struct GpuProgramParameterStats
+		{
+			/// Number of parameter sets bound
+			size_t bindCount;
+			/// Number of bytes of constants uploaded
+			size_t bytesUploaded;
+			/// Number of bytes of constants skipped since the GPU already held the same values
+			size_t bytesSkipped;
+
+			GpuProgramParameterStats() : bindCount(0), bytesUploaded(0), bytesSkipped(0) {}
+		};
+
+		/** Sets whether to gather statistics on the GPU program parameters uploaded
+			each frame.
+		@remarks
+			Gathering these statistics requires walking the constant definitions
+			of every parameter set bound, so it is disabled by default.
+		*/
+		void setGpuProgramParameterStatsEnabled(bool enabled) { mGpuProgramParameterStatsEnabled = enabled; }
+		/** Gets whether statistics on the GPU program parameters uploaded are gathered. */
+		bool getGpuProgramParameterStatsEnabled(void) const { return mGpuProgramParameterStatsEnabled; }
+		/** Gets the statistics on the GPU program parameters uploaded in the last
+			complete frame (see setGpuProgramParameterStatsEnabled).
+		*/
+		const GpuProgramParameterStats& getGpuProgramParameterStats(void) const { return mLastGpuProgramParameterStats; }
+		/** Records the upload of GPU program parameters for the statistics.
+		@param params The parameters which were bound
+		@param uploadedMask Mask of GpuParamVariability passed to bindGpuProgramParameters,
+			0 if the parameters weren't bound at all
+		@param skippedMask Mask of GpuParamVariability which could have been bound
+			but were skipped since the values hadn't changed
+		*/
+		void _notifyGpuProgramParametersBound(const GpuProgramParametersSharedPtr& params,
+			uint16 uploadedMask, uint16 skippedMask);
 		/** Unbinds GpuPrograms of a given GpuProgramType.
 		@remarks
 		This returns the pipeline to fixed-function processing for this type.
@@ -1463,6 +1501,12 @@ namespace Ogre
 		bool mTexProjRelative;
 		Vector3 mTexProjRelativeOrigin;
 
+		/// Whether GPU program parameter statistics are being gathered
+		bool mGpuProgramParameterStatsEnabled;
+		/// GPU program parameter statistics for the frame being rendered
+		GpuProgramParameterStats mGpuProgramParameterStats;
+		/// GPU program parameter statistics for the last complete frame
+		GpuProgramParameterStats mLastGpuProgramParameterStats;
 
 
 	};
@@ -151,6 +151,8 @@ namespace Ogre
 		/// Supports attaching a depth buffer to an RTT that has width & height less or equal than RTT's.
 		/// Otherwise must be of _exact_ same resolution. D3D 9&10, OGL 3.0 (not 2.0)
 		RSC_RTT_DEPTHBUFFER_RESOLUTION_LESSEQUAL = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_2, 10),
+		/// Supports vertex buffers with per instance data, drawing many instances at once
+		RSC_VERTEX_BUFFER_INSTANCE_DATA = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_2, 11),
 
 		// ***** DirectX specific caps *****
 		/// Is DirectX feature "per stage constants" supported
@@ -107,6 +107,7 @@ namespace Ogre
         Timer* mTimer;
         RenderWindow* mAutoWindow;
         Profiler* mProfiler;
+        TraceProfiler* mTraceProfiler;
         HighLevelGpuProgramManager* mHighLevelGpuProgramManager;
 		ExternalTextureSourceManager* mExternalTextureSourceManager;
         CompositorManager* mCompositorManager;      
@@ -390,6 +390,8 @@ namespace Ogre {
 		StaticGeometryList mStaticGeometryList;
 		typedef map<String, InstancedGeometry* >::type InstancedGeometryList;
 		InstancedGeometryList mInstancedGeometryList;
+		typedef map<String, InstanceManager* >::type InstanceManagerMap;
+		InstanceManagerMap mInstanceManagers;
 
         typedef map<String, SceneNode*>::type SceneNodeList;
 
@@ -955,12 +957,17 @@ namespace Ogre {
 		uint32 mLastLightHashGpuProgram;
 		/// Gpu params that need rebinding (mask of GpuParamVariability)
 		uint16 mGpuParamsDirty;
+		/// Parameters last bound per GpuProgramType, null if the program has been rebound since
+		const GpuProgramParameters* mLastBoundGpuParams[3];
 
 		virtual void useLights(const LightList& lights, unsigned short limit);
 		virtual void setViewMatrix(const Matrix4& m);
 		virtual void useLightsGpuProgram(const Pass* pass, const LightList* lights);
 		virtual void bindGpuProgram(GpuProgram* prog);
 		virtual void updateGpuProgramParameters(const Pass* p);
+		/** Binds the parameters of one program, skipping the variability classes
+			whose values the GPU already has. */
+		void bindGpuProgramParameters(GpuProgramType gptype, const GpuProgramParametersSharedPtr& params);
 
 
 
@@ -985,6 +992,68 @@ namespace Ogre {
         typedef vector<EntityMaterialLodChangedEvent>::type EntityMaterialLodChangedEventList;
         EntityMaterialLodChangedEventList mEntityMaterialLodChangedEvents;
 
+		/// Whether to update the scene graph on several threads
+		bool mParallelSceneGraphUpdate;
+		/// Minimum number of scene nodes for a parallel scene graph update
+		size_t mParallelSceneGraphUpdateThreshold;
+		/// Splits work between this thread and the WorkQueue workers, created on demand
+		ParallelTaskDispatcher* mParallelDispatcher;
+		/// Subtrees whose update is handed out to threads
+		Node::DeferredUpdateList mDeferredNodeUpdates;
+		/// Nodes updated before their subtrees were split off, in the order updated
+		typedef vector<SceneNode*>::type SplitSceneNodeList;
+		SplitSceneNodeList mSplitSceneNodes;
+		/// Structure-of-arrays copy of the scene graph's transforms, if enabled
+		TransformPool* mTransformPool;
+
+		/** Update the scene graph from the root, splitting it into subtrees
+			which are updated in parallel. */
+		virtual void updateSceneGraphParallel(void);
+
+		/// Whether to find visible objects on several threads
+		bool mParallelCulling;
+		/// Minimum number of scene nodes for parallel culling
+		size_t mParallelCullingThreshold;
+		/// What to add to the render queue for a node found to be visible
+		enum CullingStep
+		{
+			/// The objects attached to the node
+			CS_OBJECTS,
+			/// The debug renderables of the node, once its children are done
+			CS_DEBUG,
+			/// The results of culling the subtree below the node
+			CS_SUBTREE
+		};
+		struct CullingEntry
+		{
+			SceneNode* node;
+			CullingStep step;
+		};
+		typedef vector<CullingEntry>::type CullingEntryList;
+		typedef vector<CullingEntryList>::type CullingEntryListList;
+		/// Entries for the nodes above the split, in the order of a serial traversal
+		CullingEntryList mCullingPlan;
+		/// Roots of the subtrees which are culled by other threads
+		SplitSceneNodeList mCullingSubtrees;
+		/// Entries for the visible nodes of each subtree, filled in by the thread culling it
+		CullingEntryListList mCullingResults;
+		/// Culls a list of subtrees, see findVisibleObjectsParallel
+		class CullingTaskSet;
+
+		/** Find visible objects from the root, culling subtrees of the scene
+			graph in parallel. */
+		virtual void findVisibleObjectsParallel(Camera* cam,
+			VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters);
+		/** Add entries for a node above the split and its visible children
+			to mCullingPlan, or the node to mCullingSubtrees if it is at the split. */
+		void planCulling(SceneNode* node, Camera* cam, size_t depth, size_t splitDepth);
+
+		/// Whether to evaluate the skeletons of animated entities on several threads
+		bool mParallelSkeletalAnimation;
+		typedef vector<Entity*>::type EntityList;
+		/// Entities whose skeletons are evaluated by _updateSkeletalAnimations
+		EntityList mSkeletonUpdates;
+
     public:
         /** Constructor.
         */
@@ -1756,6 +1825,127 @@ namespace Ogre {
         */
         virtual void _updateSceneGraph(Camera* cam);
 
+		/** Sets whether the scene graph is updated on several threads.
+		@remarks
+			If enabled, _updateSceneGraph splits the scene graph into independent
+			subtrees below the root, and updates them using the worker threads of
+			Root's WorkQueue as well as the calling thread. The world bounds of
+			the nodes above the split are merged once the subtrees are done.
+			This only pays off for large scenes, so it's only done when there are
+			at least getParallelSceneGraphUpdateThreshold() scene nodes.
+		@par
+			Node::Listener::nodeUpdated and MovableObject::Listener::objectMoved
+			are then called from several threads at once, so they must not change
+			anything outside the node or object they are called for; use
+			Node::queueNeedUpdate rather than Node::needUpdate from them.
+		@par
+			This is disabled by default, and has no effect if
+			isParallelSceneGraphUpdateSupported returns false or OGRE_THREAD_SUPPORT
+			is 0.
+		*/
+		virtual void setParallelSceneGraphUpdate(bool enabled) { mParallelSceneGraphUpdate = enabled; }
+		/** Gets whether the scene graph is updated on several threads. */
+		virtual bool getParallelSceneGraphUpdate(void) const { return mParallelSceneGraphUpdate; }
+		/** Sets the minimum number of scene nodes for which the scene graph is
+			updated on several threads (default 2000). */
+		virtual void setParallelSceneGraphUpdateThreshold(size_t nodeCount) { mParallelSceneGraphUpdateThreshold = nodeCount; }
+		/** Gets the minimum number of scene nodes for which the scene graph is
+			updated on several threads. */
+		virtual size_t getParallelSceneGraphUpdateThreshold(void) const { return mParallelSceneGraphUpdateThreshold; }
+		/** Returns whether this SceneManager's scene graph can be updated on
+			several threads.
+		@remarks
+			Subclasses whose nodes modify shared structures when they are updated,
+			such as a spatial partitioning tree, must return false.
+		*/
+		virtual bool isParallelSceneGraphUpdateSupported(void) const { return true; }
+		/** Gets the object which splits work such as the scene graph update
+			between threads, for instance to change its concurrency.
+		*/
+		virtual ParallelTaskDispatcher* getParallelDispatcher(void);
+
+		/** Sets whether the scene graph's transforms are held in a TransformPool.
+		@remarks
+			If enabled, _updateSceneGraph calculates derived transforms a level
+			of the scene graph at a time, using SIMD where it is available,
+			rather than by recursing through the nodes. This takes precedence
+			over setParallelSceneGraphUpdate. See TransformPool for the details.
+		@par
+			This is disabled by default, and has no effect if
+			isTransformPoolSupported returns false.
+		*/
+		virtual void setTransformPoolEnabled(bool enabled);
+		/** Gets whether the scene graph's transforms are held in a TransformPool. */
+		virtual bool getTransformPoolEnabled(void) const { return mTransformPool != 0; }
+		/** Returns whether this SceneManager's scene graph can be updated using
+			a TransformPool.
+		@remarks
+			Subclasses whose nodes override Node::_update must return false.
+		*/
+		virtual bool isTransformPoolSupported(void) const { return true; }
+
+		/** Sets whether visible objects are found on several threads.
+		@remarks
+			If enabled, _findVisibleObjects splits the scene graph into subtrees
+			below the root and culls them against the camera on the calling
+			thread and the worker threads of Root's WorkQueue, testing the
+			children of each node in batches with
+			OptimisedUtil::cullAxisAlignedBoxes. The visible nodes of each
+			subtree are staged in a list of their own, and the lists are merged
+			on the calling thread, which adds the visible objects to the render
+			queue in the same order as a serial traversal would. Only culling is
+			done in parallel, since MovableObject::_updateRenderQueue isn't
+			thread safe.
+		@par
+			This only pays off for large scenes, so it's only done when there are
+			at least getParallelCullingThreshold() scene nodes. Below the split
+			nodes are tested against the camera's frustum planes directly, so
+			overrides of Camera::isVisible and SceneNode::_findVisibleObjects are
+			not called for them.
+		@par
+			This is disabled by default. If OGRE_THREAD_SUPPORT is 0 the
+			culling is still done in batches, on the calling thread.
+		*/
+		virtual void setParallelCulling(bool enabled) { mParallelCulling = enabled; }
+		/** Gets whether visible objects are found on several threads. */
+		virtual bool getParallelCulling(void) const { return mParallelCulling; }
+		/** Sets the minimum number of scene nodes for which visible objects are
+			found on several threads (default 2000). */
+		virtual void setParallelCullingThreshold(size_t nodeCount) { mParallelCullingThreshold = nodeCount; }
+		/** Gets the minimum number of scene nodes for which visible objects are
+			found on several threads. */
+		virtual size_t getParallelCullingThreshold(void) const { return mParallelCullingThreshold; }
+
+		/** Sets whether the skeletons of animated entities are evaluated on
+			several threads.
+		@remarks
+			Normally an entity's skeleton is evaluated when the entity is
+			rendered, one entity at a time. If this is enabled, the skeletons
+			of all the visible entities in the scene whose animation state has
+			changed are instead evaluated by _updateSkeletalAnimations once per
+			frame, before the scene graph is updated, using the worker threads
+			of Root's WorkQueue as well as the calling thread. This pays off
+			for scenes with many animated characters. Software skinning is
+			still done when each entity is rendered.
+		@par
+			Entities which aren't visible, such as those outside the camera, are
+			then evaluated too. AnimationTrack::Listener implementations are
+			called from several threads at once, so must be thread safe.
+		@par
+			This is disabled by default. If OGRE_THREAD_SUPPORT is 0 the
+			skeletons are evaluated on the calling thread.
+		*/
+		virtual void setParallelSkeletalAnimation(bool enabled) { mParallelSkeletalAnimation = enabled; }
+		/** Gets whether the skeletons of animated entities are evaluated on
+			several threads. */
+		virtual bool getParallelSkeletalAnimation(void) const { return mParallelSkeletalAnimation; }
+
+		/** Internal method which evaluates the skeletons of the animated
+			entities in the scene on several threads.
+		@see setParallelSkeletalAnimation
+		*/
+		virtual void _updateSkeletalAnimations(void);
+
         /** Internal method which parses the scene to find visible objects to render.
             @remarks
                 If you're implementing a custom scene manager, this is the most important method to
@@ -3080,6 +3270,35 @@ namespace Ogre {
 		/** Remove & destroy all InstancedGeometry instances. */
 		virtual void destroyAllInstancedGeometry(void);
 
+		/** Creates an InstanceManager, which draws many copies of a mesh 
+			using hardware instancing.
+		@remarks
+			Unlike InstancedGeometry, instances share a single copy of the 
+			mesh and can be added and removed at any time. Please read the
+			InstanceManager class documentation for full information.
+		@param customName The name to give the new manager
+		@param meshName The mesh to draw
+		@param groupName The resource group of the mesh
+		@param instancesPerBatch The maximum number of instances drawn at once
+		@param subMeshIdx The submesh of the mesh to draw
+		@returns The new InstanceManager
+		*/
+		virtual InstanceManager* createInstanceManager(const String& customName, 
+			const String& meshName, const String& groupName, 
+			size_t instancesPerBatch, unsigned short subMeshIdx = 0);
+		/** Retrieve a previously created InstanceManager. 
+		@note Throws an exception if the named manager does not exist
+		*/
+		virtual InstanceManager* getInstanceManager(const String& name) const;
+		/** Returns whether an InstanceManager with the given name exists. */
+		virtual bool hasInstanceManager(const String& name) const;
+		/** Remove & destroy an InstanceManager, and all its instances. */
+		virtual void destroyInstanceManager(InstanceManager* instanceManager);
+		/** Remove & destroy an InstanceManager, and all its instances. */
+		virtual void destroyInstanceManager(const String& name);
+		/** Remove & destroy all InstanceManagers. */
+		virtual void destroyAllInstanceManagers(void);
+
 
 		/** Create a movable object of the type specified.
 		@remarks
@@ -79,6 +79,10 @@ namespace Ogre {
         /** @copydoc Node::updateFromParentImpl. */
         void updateFromParentImpl(void) const;
 
+        /** @copydoc Node::setDerivedTransform. */
+        void setDerivedTransform(const Vector3& position,
+            const Quaternion& orientation, const Vector3& scale);
+
         /** See Node. */
         Node* createChildImpl(void);
 
@@ -209,6 +213,29 @@ namespace Ogre {
 			VisibleObjectsBoundsInfo* visibleBounds, 
             bool includeChildren = true, bool displayNodes = false, bool onlyShadowCasters = false);
 
+		/** Internal method which adds the objects attached to this node to the
+			queue, which is what _findVisibleObjects does once it has found this
+			node to be visible.
+		@remarks
+			Along with _addDebugRenderablesToQueue, this lets a SceneManager
+			which finds visible nodes by other means, such as on several threads,
+			add them to the queue in the same way.
+		*/
+		virtual void _addVisibleObjectsToQueue(Camera* cam, RenderQueue* queue,
+			VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters = false);
+
+		/** Internal method which returns whether _addDebugRenderablesToQueue
+			adds anything to the queue.
+		*/
+		virtual bool _hasDebugRenderables(bool displayNodes) const;
+
+		/** Internal method which adds the debug renderables of this node, i.e.
+			its axes if displayNodes is true and its bounding box if it is shown,
+			to the queue. _findVisibleObjects does this after visiting the
+			children of a visible node.
+		*/
+		virtual void _addDebugRenderablesToQueue(RenderQueue* queue, bool displayNodes);
+
         /** Gets the axis-aligned bounding box of this node (and hence all subnodes).
         @remarks
             Recommended only if you are extending a SceneManager, because the bounding box returned
@@ -0,0 +1,117 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ScriptCache_H__
+#define __ScriptCache_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreScriptCompiler.h"
+#include "OgreFileSystem.h"
+
+namespace Ogre {
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup General
+	*  @{
+	*/
+	/** Keeps the parsed form of scripts in a directory, so that scripts which
+		haven't changed don't have to be lexed and parsed again.
+	@remarks
+		Each script is stored as its tree of concrete nodes, the output of
+		ScriptParser, in a file of its own. An entry is used only if the
+		script's name, length and a hash of its contents all match, so
+		editing a script simply causes it to be parsed and stored again.
+	@par
+		Imported scripts go through the cache on their own when the
+		compiler loads them, so each file only depends on its own contents;
+		changing an imported script doesn't invalidate the scripts which
+		import it. The concrete nodes are cached rather than the abstract
+		ones, because ScriptCompilerListener::preConversion is given the
+		concrete nodes, and the abstract nodes hold ids which depend on the
+		compiler's word map.
+	@par
+		Set up through ScriptCompilerManager::setCacheLocation.
+	*/
+	class _OgreExport ScriptCache : public ScriptCompilerAlloc
+	{
+	public:
+		/** Constructor.
+		@param location The directory to keep the cache files in, which must exist
+		*/
+		ScriptCache(const String& location);
+		virtual ~ScriptCache();
+
+		/// Get the directory the cache files are kept in
+		const String& getLocation(void) const { return mLocation; }
+
+		/** Returns the parsed nodes of a script, from the cache if they are
+			there, otherwise by lexing and parsing it and storing the result.
+		@param script The contents of the script
+		@param source The name of the script
+		*/
+		ConcreteNodeListPtr parse(const String& script, const String& source);
+
+		/** Reads the nodes of a script from the cache.
+		@returns The nodes, or a null pointer if there's no valid entry for
+			these contents
+		*/
+		ConcreteNodeListPtr load(const String& script, const String& source);
+		/// Stores the nodes of a script in the cache
+		void save(const ConcreteNodeListPtr& nodes, const String& script, const String& source);
+		/// Removes the entry for a script from the cache, if there is one
+		void remove(const String& source);
+
+		/// Get the number of scripts which were read from the cache
+		size_t getNumHits(void) const { return mNumHits; }
+		/// Get the number of scripts which had to be parsed
+		size_t getNumMisses(void) const { return mNumMisses; }
+		/// Reset the hit and miss counts
+		void resetStatistics(void);
+
+		/// The chunk holding a cached script
+		static const uint32 SCRIPTCACHE_CHUNK_ID;
+		/// The version of the cache format, which also covers the parser's output
+		static const uint16 SCRIPTCACHE_CHUNK_VERSION;
+
+	protected:
+		OGRE_AUTO_MUTEX
+		String mLocation;
+		FileSystemArchive mArchive;
+		size_t mNumHits;
+		size_t mNumMisses;
+
+		/// Get the name of the cache file for a script
+		String getCacheFileName(const String& source) const;
+	};
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -254,6 +254,8 @@ namespace Ogre
 		/// Internal method for firing the handleEvent method
 		bool _fireEvent(ScriptCompilerEvent *evt, void *retval);
 	private: // Tree processing
+		/// Lexes and parses a script, through the ScriptCache if one is set up
+		ConcreteNodeListPtr parse(const String &str, const String &source);
 		AbstractNodeListPtr convertToAST(const ConcreteNodeListPtr &nodes);
 		/// This built-in function processes import nodes
 		void processImports(AbstractNodeListPtr &nodes);
@@ -399,6 +401,9 @@ namespace Ogre
 
 		// A pointer to the specific compiler instance used
 		OGRE_THREAD_POINTER(ScriptCompiler, mScriptCompiler);
+
+		// The cache of parsed scripts, or null if caching is off
+		ScriptCache *mCache;
 	public:
 		ScriptCompilerManager();
 		virtual ~ScriptCompilerManager();
@@ -408,6 +413,20 @@ namespace Ogre
 		/// Returns the currently set listener used for compiler instances
 		ScriptCompilerListener *getListener();
 
+		/** Sets the directory which parsed scripts are cached in.
+		@remarks
+			Scripts which haven't changed since they were cached are read back
+			from here instead of being lexed and parsed again, which shortens
+			startup for applications with many scripts. The directory must
+			exist. An empty location, the default, turns caching off.
+		@see ScriptCache
+		*/
+		void setCacheLocation(const String &location);
+		/// Returns the directory parsed scripts are cached in, or an empty string
+		const String &getCacheLocation() const;
+		/// Returns the script cache, or null if caching is off
+		ScriptCache *getCache() const;
+
 		/// Adds the given translator manager to the list of managers
 		void addTranslatorManager(ScriptTranslatorManager *man);
 		/// Removes the given translator manager from the list of managers
@@ -109,7 +109,8 @@ namespace Ogre {
     class _OgreExport ShadowCaster
     {
     public:
-        virtual ~ShadowCaster() { }
+        ShadowCaster();
+        virtual ~ShadowCaster();
         /** Returns whether or not this object currently casts a shadow. */
         virtual bool getCastShadows(void) const = 0;
 
@@ -171,7 +172,27 @@ namespace Ogre {
             size_t originalVertexCount, const Vector4& lightPos, Real extrudeDist);
         /** Get the distance to extrude for a point/spot light */
         virtual Real getPointExtrusionDistance(const Light* l) const = 0;
+
+        /** Sets the number of lights to keep shadow volumes for.
+        @remarks
+            Casters which aren't animated keep the shadow volume indexes they
+            generate for the last few lights, and use them again as long as
+            neither the light nor the caster has moved, rather than finding
+            the silhouette again. This is most useful with many static lights
+            and casters. The default is 4, 0 disables caching.
+        */
+        void setShadowVolumeCacheSize(size_t numLights);
+        /** Gets the number of lights to keep shadow volumes for. */
+        size_t getShadowVolumeCacheSize(void) const { return mShadowVolumeCacheSize; }
     protected:
+        struct CachedShadowVolume;
+        typedef vector<CachedShadowVolume*>::type CachedShadowVolumeList;
+
+        /// Shadow volumes kept for the lights used most recently, first
+        CachedShadowVolumeList mCachedShadowVolumes;
+        /// The number of lights to keep shadow volumes for
+        size_t mShadowVolumeCacheSize;
+
         /// Helper method for calculating extrusion distance
         Real getExtrusionDistance(const Vector3& objectPos, const Light* light) const;
         /** Tells the caster to perform the tasks necessary to update the 
@@ -200,6 +221,31 @@ namespace Ogre {
         virtual void generateShadowVolume(EdgeData* edgeData, 
             const HardwareIndexBufferSharedPtr& indexBuffer, const Light* light,
             ShadowRenderableList& shadowRenderables, unsigned long flags);
+        /** Updates the light facing state of an edge list and generates the
+            shadow volume indexes, like calling updateEdgeListLightFacing then
+            generateShadowVolume, but uses the indexes kept from an earlier
+            call with the same object space light position if there are any.
+        @param edgeData The edge information to use
+        @param indexBuffer The buffer into which to write data into; current 
+            contents are assumed to be discardable.
+        @param light The light, mainly for type info
+        @param lightPos 4D light position in object space, when w=0.0f this
+            represents a directional light
+        @param shadowRenderables A list of shadow renderables which has 
+            already been constructed but will need populating with details of
+            the index ranges to be used.
+        @param flags Additional controller flags, see ShadowRenderableFlags
+        @param cacheable Whether the indexes can be kept, which requires that
+            the edge list doesn't change, so is false for animated casters
+        */
+        void updateShadowVolume(EdgeData* edgeData, 
+            const HardwareIndexBufferSharedPtr& indexBuffer, const Light* light,
+            const Vector4& lightPos, ShadowRenderableList& shadowRenderables,
+            unsigned long flags, bool cacheable);
+        /** Discards the shadow volumes kept by updateShadowVolume, which must
+            be done when the edge list or shadow renderables are changed.
+        */
+        void clearCachedShadowVolumes(void);
         /** Utility method for extruding a bounding box. 
         @param box Original bounding box, will be updated in-place
         @param lightPos 4D light position in object space, when w=0.0f this
@@ -246,6 +246,16 @@ namespace Ogre {
         */
         virtual void setAnimationState(const AnimationStateSet& animSet);
 
+		/** Prepare the animations enabled in an animation set to be applied.
+		@remarks
+			Only recommended for use inside the engine. This builds the data
+			which the animations otherwise build on demand, so that
+			setAnimationState can then be called for different skeletons which
+			use the same animations on several threads at once.
+		@see Animation::_prepareForApply
+		*/
+		virtual void _prepareAnimationState(const AnimationStateSet& animSet) const;
+
 
         /** Initialise an animation set suitable for use with this skeleton. 
         @remarks
@@ -293,6 +303,20 @@ namespace Ogre {
 		*/
 		virtual void optimiseAllAnimations(bool preservingIdentityNodeTracks = false);
 
+		/** Store the node tracks of all animations in compressed form, to
+			save memory.
+		@remarks
+			Keys which can be reproduced by interpolation within the given
+			tolerances are removed, and the rest are quantised. Use
+			optimiseAllAnimations first to remove identity tracks.
+		@see CompressedNodeAnimationTrack
+		@param translationTolerance The largest distance a translation may move by
+		@param rotationTolerance The largest angle a rotation may change by
+		@param scaleTolerance The largest amount any component of a scale may change by
+		*/
+		virtual void compressAllAnimations(Real translationTolerance = 0.001f,
+			const Radian& rotationTolerance = Radian(Degree(0.1f)), Real scaleTolerance = 0.001f);
+
 		/** Allows you to use the animations from another Skeleton object to animate
 			this skeleton.
 		@remarks
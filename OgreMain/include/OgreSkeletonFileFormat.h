@@ -93,6 +93,25 @@ namespace Ogre {
                     // Quaternion rotate            : Rotation to apply at this keyframe
                     // Vector3 translate            : Translation to apply at this keyframe
                     // Vector3 scale                : Scale to apply at this keyframe
+
+            SKELETON_ANIMATION_TRACK_COMPRESSED = 0x4200,
+            // A single animation track stored as a CompressedNodeAnimationTrack, 
+            // which may take the place of SKELETON_ANIMATION_TRACK from version 1.20
+            // Repeating section (within SKELETON_ANIMATION)
+
+                // unsigned short boneIndex     : Index of bone to apply to
+                // unsigned short numKeyFrames  : Number of keyframes
+                // unsigned short channels      : CompressedNodeAnimationTrack::Channel flags
+                // float times[numKeyFrames]    : The time position of each keyframe (seconds)
+                // unsigned short rotations[numKeyFrames * 3] : Quantised rotations, if CH_ROTATION is set
+                // Quaternion rotate            : Rotation of every keyframe, if CH_ROTATION is not set
+                // Vector3 translateBase        : Smallest translation
+                // Vector3 translateExtent      : Range of the translations
+                // unsigned short translations[numKeyFrames * 3] : Quantised translations, if CH_TRANSLATION is set
+                // Vector3 scaleBase            : Smallest scale
+                // Vector3 scaleExtent          : Range of the scales
+                // unsigned short scales[numKeyFrames * 3] : Quantised scales, if CH_SCALE is set
+
 		SKELETON_ANIMATION_LINK         = 0x5000
 		// Link to another skeleton, to re-use its animations
 
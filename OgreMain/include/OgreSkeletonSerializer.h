@@ -64,6 +64,8 @@ namespace Ogre {
         @remarks
             This method takes an externally created Skeleton object, and exports both it
             and animations it uses to a .skeleton file.
+            If any of the animations have compressed tracks the file is written
+            with a later version, which older versions of OGRE will refuse to load.
         @param pSkeleton Weak reference to the Skeleton to export
         @param filename The destination filename
 		@param endianMode The endian mode to write in
@@ -90,6 +92,8 @@ namespace Ogre {
         void writeAnimation(const Skeleton* pSkel, const Animation* anim);
         void writeAnimationTrack(const Skeleton* pSkel, const NodeAnimationTrack* track);
         void writeKeyFrame(const Skeleton* pSkel, const TransformKeyFrame* key);
+        void writeCompressedAnimationTrack(const Skeleton* pSkel, 
+            const CompressedNodeAnimationTrack* track);
 		void writeSkeletonAnimationLink(const Skeleton* pSkel, 
 			const LinkedSkeletonAnimationSource& link);
 
@@ -99,6 +103,7 @@ namespace Ogre {
         void readAnimation(DataStreamPtr& stream, Skeleton* pSkel);
         void readAnimationTrack(DataStreamPtr& stream, Animation* anim, Skeleton* pSkel);
         void readKeyFrame(DataStreamPtr& stream, NodeAnimationTrack* track, Skeleton* pSkel);
+        void readCompressedAnimationTrack(DataStreamPtr& stream, Animation* anim, Skeleton* pSkel);
 		void readSkeletonAnimationLink(DataStreamPtr& stream, Skeleton* pSkel);
 
         size_t calcBoneSize(const Skeleton* pSkel, const Bone* pBone);
@@ -106,11 +111,16 @@ namespace Ogre {
         size_t calcBoneParentSize(const Skeleton* pSkel);
         size_t calcAnimationSize(const Skeleton* pSkel, const Animation* pAnim);
         size_t calcAnimationTrackSize(const Skeleton* pSkel, const NodeAnimationTrack* pTrack);
+        size_t calcCompressedAnimationTrackSize(const Skeleton* pSkel, 
+            const CompressedNodeAnimationTrack* pTrack);
         size_t calcKeyFrameSize(const Skeleton* pSkel, const TransformKeyFrame* pKey);
         size_t calcKeyFrameSizeWithoutScale(const Skeleton* pSkel, const TransformKeyFrame* pKey);
 		size_t calcSkeletonAnimationLinkSize(const Skeleton* pSkel, 
 			const LinkedSkeletonAnimationSource& link);
 
+        /// Whether any animation of a skeleton has compressed tracks
+        bool hasCompressedTracks(const Skeleton* pSkel) const;
+
 
 
 
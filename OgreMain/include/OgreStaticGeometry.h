@@ -177,6 +177,28 @@ namespace Ogre {
 			Vector3 scale;
 		};
 		typedef vector<QueuedGeometry*>::type QueuedGeometryList;
+		/// Source buffers locked for reading during a build, and their lock pointers
+		typedef map<HardwareBuffer*, void*>::type SourceBufferLockMap;
+
+		/** Listener which is told about the progress of StaticGeometry::build.
+		@remarks
+			All methods are called on the thread which called build.
+		*/
+		class _OgreExport BuildListener
+		{
+		public:
+			virtual ~BuildListener() {}
+			/** Called each time some more regions have been built.
+			@param geom The geometry being built
+			@param regionsBuilt The number of regions built so far
+			@param regionCount The total number of regions to build
+			*/
+			virtual void buildProgress(StaticGeometry* geom, size_t regionsBuilt, 
+				size_t regionCount) 
+			{ (void)geom; (void)regionsBuilt; (void)regionCount; }
+			/** Called when the build has completed. */
+			virtual void buildComplete(StaticGeometry* geom) { (void)geom; }
+		};
 		
 		// forward declarations
 		class LODBucket;
@@ -206,6 +228,12 @@ namespace Ogre {
 			HardwareIndexBuffer::IndexType mIndexType;
 			/// Maximum vertex indexable
 			size_t mMaxVertexIndex;
+			/// Index buffer lock while building
+			void* mIndexLock;
+			/// Vertex buffer locks while building
+			vector<uchar*>::type mVertexLocks;
+			/// Whether the build is for stencil shadows
+			bool mStencilShadows;
 
 			template<typename T>
 			void copyIndexes(const T* src, T* dst, size_t count, size_t indexOffset)
@@ -246,6 +274,21 @@ namespace Ogre {
 			bool assign(QueuedGeometry* qsm);
 			/// Build
 			void build(bool stencilShadows);
+			/** Creates and locks the buffers which _bakeGeometry fills, the first 
+				part of build. */
+			void _beginBuild(bool stencilShadows);
+			/** Locks the source buffers of the queued geometry for reading, 
+				unless they are already in the map. */
+			void _lockSourceBuffers(SourceBufferLockMap& locks);
+			/** Copies the queued geometry into the buffers locked by _beginBuild. 
+			@remarks
+				This doesn't touch any shared state, so several buckets can be 
+				baked by different threads at once.
+			@param locks The source buffers, locked by _lockSourceBuffers
+			*/
+			void _bakeGeometry(const SourceBufferLockMap& locks);
+			/** Unlocks the buffers and finishes the build. */
+			void _endBuild(void);
 			/// Dump contents for diagnostics
 			void dump(std::ofstream& of) const;
 		};
@@ -284,6 +327,10 @@ namespace Ogre {
 			void assign(QueuedGeometry* qsm);
 			/// Build
 			void build(bool stencilShadows);
+			/// Loads the material and begins building the geometry buckets
+			void _beginBuild(bool stencilShadows);
+			/// Finishes building the geometry buckets
+			void _endBuild(void);
 			/// Add children to the render queue
 			void addRenderables(RenderQueue* queue, uint8 group, 
 				Real lodValue);
@@ -359,6 +406,10 @@ namespace Ogre {
 			void assign(QueuedSubMesh* qsm, ushort atLod);
 			/// Build
 			void build(bool stencilShadows);
+			/// Begins building the material buckets
+			void _beginBuild(bool stencilShadows);
+			/// Finishes building the material buckets, then the edge list if required
+			void _endBuild(bool stencilShadows);
 			/// Add children to the render queue
 			void addRenderables(RenderQueue* queue, uint8 group, 
 				Real lodValue);
@@ -439,6 +490,15 @@ namespace Ogre {
 			void assign(QueuedSubMesh* qmesh);
 			/// Build this region
 			void build(bool stencilShadows);
+			/** Creates the node and LOD buckets, and begins building them. 
+			@remarks
+				build is the same as _beginBuild, baking all the geometry 
+				buckets then _endBuild; this lets StaticGeometry::build bake 
+				the buckets of several regions in parallel.
+			*/
+			void _beginBuild(bool stencilShadows);
+			/// Finishes building the LOD buckets
+			void _endBuild(bool stencilShadows);
 			/// Get the region ID of this region
 			uint32 getID(void) const { return mRegionID; }
 			/// Get the centre point of the region
@@ -497,6 +557,10 @@ namespace Ogre {
 		bool mRenderQueueIDSet;
 		/// Stores the visibility flags for the regions
 		uint32 mVisibilityFlags;
+		/// Whether geometry buckets are built in parallel
+		bool mParallelBuild;
+		/// Listener told about the progress of builds
+		BuildListener* mBuildListener;
 
 		QueuedSubMeshList mQueuedSubMeshes;
 
@@ -637,12 +701,33 @@ namespace Ogre {
 			options which have been set, this method constructs	the batched 
 			geometry structures required. The batches are added to the scene 
 			and will be rendered unless you specifically hide them.
+		@par
+			Building happens a few regions at a time, and the listener set
+			with setBuildListener is told about the progress after each batch.
+			Filling the geometry buckets of a batch is done in parallel if
+			setParallelBuild is enabled; creating the hardware buffers and
+			building edge lists is always done on the calling thread.
 		@note
 			Once you have called this method, you can no longer add any more 
 			entities.
 		*/
 		virtual void build(void);
 
+		/** Sets whether build fills the geometry buckets in parallel.
+		@remarks
+			The work is split between the calling thread and the workers of
+			Root's WorkQueue, using the owning SceneManager's 
+			ParallelTaskDispatcher. The default is false.
+		*/
+		virtual void setParallelBuild(bool enabled) { mParallelBuild = enabled; }
+		/** Gets whether build fills the geometry buckets in parallel. */
+		virtual bool getParallelBuild(void) const { return mParallelBuild; }
+
+		/** Sets a listener which is told about the progress of build. */
+		virtual void setBuildListener(BuildListener* listener) { mBuildListener = listener; }
+		/** Gets the listener which is told about the progress of build. */
+		virtual BuildListener* getBuildListener(void) const { return mBuildListener; }
+
 		/** Destroys all the built geometry state (reverse of build). 
 		@remarks
 			You can call build() again after this and it will pick up all the
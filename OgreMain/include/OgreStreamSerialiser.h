@@ -265,6 +265,19 @@ namespace Ogre
 			writeData(pT, sizeof(T), count);
 		}
 
+		/** Write a block of bytes compressed with zlib. 
+		@remarks
+			The size of the compressed data is written first, so that 
+			readCompressedData knows how much to read. This is only available if
+			OGRE was built with zlib; see isCompressionSupported.
+		@param buf Pointer to bytes
+		@param size The number of bytes to write
+		*/
+		virtual void writeCompressedData(const void* buf, size_t size);
+
+		/// Returns whether writeCompressedData and readCompressedData are available
+		static bool isCompressionSupported();
+
 		// Special-case Real since we need to deal with single/double precision
 		virtual void write(const Real* val, size_t count = 1);
 
@@ -292,6 +305,13 @@ namespace Ogre
 		*/
 		virtual void readData(void* buf, size_t size, size_t count);
 
+		/** Read a block of bytes written by writeCompressedData. 
+		@param buf Pointer to receive the uncompressed bytes
+		@param size The number of bytes expected; it is an error for the
+			block to uncompress to any other size
+		*/
+		virtual void readCompressedData(void* buf, size_t size);
+
 		/** Catch-all method to read primitive types. */
 		template <typename T>
 		void read(T* pT, size_t count = 1)
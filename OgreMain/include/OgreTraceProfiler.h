@@ -0,0 +1,265 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TraceProfiler_H__
+#define __TraceProfiler_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreSingleton.h"
+#include "OgreProfiler.h"
+#include "OgreAtomicWrappers.h"
+#include "OgreTimer.h"
+
+#if OGRE_PROFILING == 1
+#	define OgreTraceScope( a ) OgreTraceScopeGroup( a, Ogre::OGREPROF_USER_DEFAULT )
+#	define OgreTraceScopeGroup( a, g ) \
+		static const Ogre::TraceMarker _OgreTraceMarker( (a), (Ogre::uint32)(g) ); \
+		Ogre::TraceScope _OgreTraceScopeInstance( _OgreTraceMarker )
+#	define OgreTraceFrame() \
+		if (Ogre::TraceProfiler::getSingletonPtr()) Ogre::TraceProfiler::getSingleton().markFrame()
+#else
+#	define OgreTraceScope( a )
+#	define OgreTraceScopeGroup( a, g )
+#	define OgreTraceFrame()
+#endif
+
+namespace Ogre {
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup General
+	*  @{
+	*/
+
+	/** A static description of a place in the code which is traced.
+	@remarks
+		Markers are created once, by the OgreTraceScope macros, so recording
+		an event only stores a pointer to the marker rather than looking its
+		name up. The name must be a string which outlives the marker, such
+		as a literal.
+	*/
+	struct _OgreExport TraceMarker
+	{
+		TraceMarker(const char* markerName, uint32 markerGroupID = (uint32)OGREPROF_USER_DEFAULT);
+
+		/// The name of the marker
+		const char* name;
+		/// The profile group identifier (see ProfileGroupMask)
+		uint32 groupID;
+		/// Hash of the name, so that markers with the same name can be combined
+		uint32 hash;
+	};
+
+	/** A timed event recorded by the TraceProfiler. */
+	struct TraceEvent
+	{
+		/// What was timed
+		const TraceMarker* marker;
+		/// Index of the thread which recorded the event (see TraceProfiler::getThreadName)
+		uint32 threadIndex;
+		/// Number of events which enclosed this one on the same thread
+		uint32 depth;
+		/// Start time in microseconds, relative to the creation of the profiler
+		unsigned long start;
+		/// Duration in microseconds
+		unsigned long duration;
+	};
+	typedef vector<TraceEvent>::type TraceEventList;
+
+	/** Records nested timed events from any number of threads, so they can be
+		viewed as timelines.
+	@remarks
+		Unlike Profiler, which gathers per-frame statistics for display on an
+		overlay from a single thread, this records every event along with the
+		thread it occurred on, so that the work done by WorkQueue workers can
+		be seen alongside the main thread and individual slow frames can be
+		examined after the fact. Use exportChromeTrace to write the events in
+		the Trace Event format read by Chrome's about:tracing and similar
+		tools.
+	@par
+		Each thread records into its own fixed size ring buffer, so recording
+		an event never takes a lock, and only the most recent events of each
+		thread are kept. Use the OgreTraceScope macros to trace a scope; like
+		the Profiler macros they compile to nothing unless OGRE_PROFILING is 1.
+		Recording must also be enabled with setEnabled.
+	*/
+	class _OgreExport TraceProfiler : public Singleton<TraceProfiler>, public ProfilerAlloc
+	{
+	public:
+		/** Constructor.
+		@param eventsPerThread The number of events to keep for each thread,
+			which is rounded up to a power of 2
+		*/
+		TraceProfiler(size_t eventsPerThread = 65536);
+		~TraceProfiler();
+
+		/** Gets the number of events kept for each thread. */
+		size_t getEventsPerThread(void) const { return mCapacity; }
+
+		/** Sets whether events are recorded. */
+		void setEnabled(bool enabled) { mEnabled = enabled; }
+		/** Gets whether events are recorded. */
+		bool getEnabled(void) const { return mEnabled; }
+
+		/** Set the mask which the group of a marker must pass for it to be recorded. */
+		void setProfileGroupMask(uint32 mask) { mProfileMask = mask; }
+		/** Get the mask which the group of a marker must pass for it to be recorded. */
+		uint32 getProfileGroupMask(void) const { return mProfileMask; }
+
+		/** Returns whether an event for the given marker would be recorded. */
+		bool isRecording(const TraceMarker& marker) const
+		{ return mEnabled && (marker.groupID & mProfileMask) != 0; }
+
+		/** Begins an event on the calling thread.
+		@remarks
+			Use the OgreTraceScope macros rather than calling this directly.
+		@return Opaque handle to pass to endEvent, on the same thread
+		*/
+		void* beginEvent(const TraceMarker& marker);
+		/** Ends the most recent event begun on the calling thread. */
+		void endEvent(void* thread);
+
+		/** Marks the start of a new frame.
+		@remarks
+			Each frame is recorded as an event on the calling thread which
+			lasts until the next call. Root calls this at the start of every
+			frame through OgreTraceFrame.
+		*/
+		void markFrame(void);
+		/** Gets the number of frames marked. */
+		size_t getFrameCount(void) const { return mFrameCount; }
+
+		/** Sets the name used for the calling thread in exported traces. */
+		void setThreadName(const String& name);
+		/** Gets the name of the thread with the given index. */
+		String getThreadName(uint32 threadIndex) const;
+
+		/** Copy the recorded events of every thread.
+		@remarks
+			This can be called while other threads are recording; events being
+			overwritten at the time are left out.
+		*/
+		void getEvents(TraceEventList& events) const;
+
+		/** Write the recorded events in Chrome's Trace Event (JSON) format. */
+		void exportChromeTrace(std::ostream& stream) const;
+		/** Write the recorded events in Chrome's Trace Event (JSON) format.
+		@return Whether the file could be written
+		*/
+		bool exportChromeTrace(const String& filename) const;
+
+		/** Writes the total, average and maximum time of each marker to the log. */
+		void logSummary(void) const;
+
+		/** Discards all recorded events. */
+		void reset(void);
+
+		/// @copydoc Singleton::getSingleton()
+		static TraceProfiler& getSingleton(void);
+		/// @copydoc Singleton::getSingleton()
+		static TraceProfiler* getSingletonPtr(void);
+
+	protected:
+		/// Deepest nesting of events which is recorded on one thread
+		static const size_t MAX_DEPTH = 64;
+
+		/// Events recorded by one thread
+		struct ThreadBuffer : public ProfilerAlloc
+		{
+			uint32 index;
+			String name;
+			/// Ring of events, allocated when the first one is recorded
+			TraceEvent* events;
+			/// Number of events ever written; only the owning thread changes it
+			AtomicScalar<size_t> written;
+			/// Value of written when reset was last called
+			size_t discarded;
+			/// Start times and markers of the events in progress
+			unsigned long openStart[MAX_DEPTH];
+			const TraceMarker* openMarker[MAX_DEPTH];
+			size_t depth;
+			/// Start of the current frame, if markFrame has been called on this thread
+			unsigned long frameStart;
+			bool frameOpen;
+
+			ThreadBuffer() : index(0), events(0), written(0), discarded(0), depth(0), frameStart(0), frameOpen(false) {}
+		};
+		typedef vector<ThreadBuffer*>::type ThreadBufferList;
+
+		/// Held in thread local storage, which can't own the buffer since it
+		/// is still needed after the thread exits
+		struct ThreadHandle : public ProfilerAlloc
+		{
+			ThreadBuffer* buffer;
+		};
+
+		ThreadBufferList mThreads;
+		OGRE_MUTEX(mThreadsMutex)
+		OGRE_THREAD_POINTER(ThreadHandle, mThreadHandle);
+
+		size_t mCapacity;
+		volatile bool mEnabled;
+		uint32 mProfileMask;
+		size_t mFrameCount;
+		Timer mTimer;
+
+		/// Get the buffer for the calling thread, creating it if need be
+		ThreadBuffer* getThreadBuffer(void);
+		/// Add an event to a thread's ring
+		void record(ThreadBuffer* thread, const TraceMarker* marker, unsigned long start,
+			unsigned long end, size_t depth);
+	};
+
+	/** Records an event for the lifetime of this object.
+	@remarks
+		Use the OgreTraceScope macros rather than creating this directly.
+	*/
+	class TraceScope
+	{
+	public:
+		TraceScope(const TraceMarker& marker)
+			: mThread(0)
+		{
+			TraceProfiler* profiler = TraceProfiler::getSingletonPtr();
+			if (profiler && profiler->isRecording(marker))
+				mThread = profiler->beginEvent(marker);
+		}
+		~TraceScope()
+		{
+			if (mThread)
+				TraceProfiler::getSingleton().endEvent(mThread);
+		}
+	protected:
+		void* mThread;
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TransformPool_H__
+#define __TransformPool_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreOptimisedUtil.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Scene
+	*  @{
+	*/
+
+	/** Holds the transforms of a SceneNode hierarchy in structure-of-arrays
+		form, so that derived transforms can be updated in batches.
+	@remarks
+		The nodes are laid out breadth first, so that each level of the
+		hierarchy is contiguous and follows its parent level. Derived
+		transforms are then calculated a level at a time by
+		OptimisedUtil::calculateDerivedTransforms, which uses SIMD where it
+		is available, rather than by recursing through the nodes.
+	@par
+		Nodes still hold their own copies of their local and derived
+		transforms, so the rest of the engine is unaware of the pool. Nodes
+		tell the pool when they need updating, their local transforms are
+		copied into the pool, and the derived transforms are copied back to
+		the nodes whose transforms have changed once every level has been
+		calculated. Copying back and updating world bounds visit the nodes
+		depth first, like a recursive update, so that a node's children are
+		still cached when its bounds are merged.
+	@par
+		Any change to the structure of the hierarchy causes the layout to be
+		rebuilt on the next update, so this is best suited to hierarchies
+		which are large and whose structure rarely changes.
+	@note
+		Nodes which override Node::_update are not supported, since the pool
+		does not call it. See SceneManager::setTransformPoolEnabled.
+	*/
+	class _OgreExport TransformPool : public NodeAlloc
+	{
+	public:
+		/** Constructor.
+		@param root The root of the hierarchy to hold
+		*/
+		TransformPool(SceneNode* root);
+		~TransformPool();
+
+		/** Update the derived transforms and world bounds of all the nodes
+			in the hierarchy which need it.
+		@remarks
+			This is the equivalent of calling _update(true, false) on the
+			root node.
+		*/
+		void update(void);
+
+		/// Get the root of the hierarchy
+		SceneNode* getRootNode(void) const { return mRoot; }
+		/// Get the number of nodes held, as of the last update
+		size_t getNodeCount(void) const { return mNodeCount; }
+		/// Get the number of levels in the hierarchy, as of the last update
+		size_t getLevelCount(void) const { return mLevels.size(); }
+
+		/// Internal method to notify that the transform of a node needs updating
+		void _notifyNodeDirty(size_t index) { mDirty[index] = 1; }
+		/// Internal method to notify that a node is being destroyed
+		void _notifyNodeDestroyed(size_t index);
+		/// Internal method to notify that a node has been attached or detached
+		void _notifyHierarchyChanged(void) { mHierarchyDirty = true; }
+
+	protected:
+		/// Range of slots which holds one level of the hierarchy
+		struct Level
+		{
+			/// First slot, which is always a multiple of 4 to keep the arrays aligned
+			size_t start;
+			/// Number of slots used by nodes
+			size_t count;
+		};
+		typedef vector<Level>::type LevelList;
+		typedef vector<SceneNode*>::type NodeList;
+		typedef vector<size_t>::type IndexList;
+		typedef vector<uint8>::type FlagList;
+
+		enum InheritFlags
+		{
+			IF_ORIENTATION = 0x1,
+			IF_SCALE = 0x2
+		};
+
+		SceneNode* mRoot;
+		bool mHierarchyDirty;
+		size_t mNodeCount;
+		LevelList mLevels;
+
+		/// Node in each slot, or null for slots used as padding
+		NodeList mNodes;
+		/// Slot of the parent of the node in each slot
+		IndexList mParents;
+		/** Order in which to visit the nodes after calculating their transforms,
+			which is the same depth first order as a recursive update. Each
+			entry is a slot times 2, plus 1 for leaving the slot after its
+			children have been visited. */
+		IndexList mVisits;
+		/// Whether the local transform of each slot has changed
+		FlagList mDirty;
+		/// Whether the derived transform of each slot is being recalculated
+		FlagList mChanged;
+		/// Whether the world bounds of each slot need updating
+		FlagList mBoundsDirty;
+		/// InheritFlags of each slot
+		FlagList mInherit;
+
+		/// Transforms of the nodes relative to their parents
+		TransformArrays mLocal;
+		/// Derived transforms of the nodes
+		TransformArrays mDerived;
+		/// Derived transforms of the parents of the current level
+		TransformArrays mParentDerived;
+		size_t mCapacity;
+		size_t mParentCapacity;
+
+		/// Lay the nodes out again, after the structure of the hierarchy has changed
+		void rebuild(void);
+		/// Copy the local transform of a node into its slot
+		void copyLocalTransform(size_t slot);
+		/// Calculate the derived transforms of one level
+		void updateLevel(const Level& level);
+
+		static void allocateArrays(TransformArrays& arrays, size_t count);
+		static void freeArrays(TransformArrays& arrays);
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -30,8 +30,10 @@ THE SOFTWARE
 	#include "OgreDefaultWorkQueueStandard.h"
 #elif OGRE_THREAD_PROVIDER == 1
 	#include "OgreDefaultWorkQueueStandard.h"
+	#include "OgreDefaultWorkQueueStealing.h"
 #elif OGRE_THREAD_PROVIDER == 2
 	#include "OgreDefaultWorkQueueStandard.h"
+	#include "OgreDefaultWorkQueueStealing.h"
 #elif OGRE_THREAD_PROVIDER == 3
 	#include "OgreDefaultWorkQueueTBB.h"
 #endif
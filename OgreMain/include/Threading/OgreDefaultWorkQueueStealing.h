@@ -0,0 +1,253 @@
+/*-------------------------------------------------------------------------
+This source file is a part of OGRE
+(Object-oriented Graphics Rendering Engine)
+
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE
+-------------------------------------------------------------------------*/
+#ifndef __OgreDefaultWorkQueueStealing_H__
+#define __OgreDefaultWorkQueueStealing_H__
+
+#include "../OgreWorkQueue.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup General
+	*  @{
+	*/
+
+	/** Work-stealing implementation of a general purpose request / response
+		style background work queue.
+	@remarks
+		DefaultWorkQueue passes every request through a single mutex-protected
+		queue, which all worker threads contend on. This implementation gives
+		each worker its own queue instead. New requests are posted without
+		locking into the inbox of a worker chosen by channel, so that requests
+		for the same handler tend to run on the same thread, and workers which
+		run out of requests steal them from the queues of busy workers. Each
+		worker queue is processed in FIFO order.
+	@par
+		Abort, pause and retry behave as they do for DefaultWorkQueue. Aborting
+		a request which is still queued is recorded and applied when a worker
+		takes the request, so that no worker queue ever has to be searched or
+		locked.
+	@par
+		This class is only available with the boost and poco thread providers.
+		Enable OGRE_CONFIG_WORK_STEALING_QUEUE in the build to make it the
+		queue which Root creates by default.
+	*/
+	class _OgreExport DefaultWorkQueueStealing : public DefaultWorkQueueBase
+	{
+	public:
+		DefaultWorkQueueStealing(const String& name = StringUtil::BLANK);
+		virtual ~DefaultWorkQueueStealing();
+
+		/// Main function for each thread spawned.
+		virtual void _threadMain();
+
+		/** Process the next request on the queue.
+		@remarks
+			The calling thread steals the next request from whichever worker
+			has one waiting. See DefaultWorkQueueBase::_processNextRequest.
+		*/
+		virtual void _processNextRequest();
+
+		/// @copydoc WorkQueue::shutdown
+		virtual void shutdown();
+
+		/// @copydoc WorkQueue::startup
+		virtual void startup(bool forceRestart = true);
+
+		/// @copydoc WorkQueue::addRequest
+		virtual RequestID addRequest(uint16 channel, uint16 requestType, const Any& rData, uint8 retryCount = 0,
+			bool forceSynchronous = false);
+		/// @copydoc WorkQueue::abortRequest
+		virtual void abortRequest(RequestID id);
+		/// @copydoc WorkQueue::abortRequestsByChannel
+		virtual void abortRequestsByChannel(uint16 channel);
+		/// @copydoc WorkQueue::abortAllRequests
+		virtual void abortAllRequests();
+		/// @copydoc WorkQueue::setPaused
+		virtual void setPaused(bool pause);
+
+		/** Set whether requests are assigned to workers by channel (default true).
+		@remarks
+			If true, all the requests in a channel are posted to the same worker,
+			and other workers only process them by stealing. If false, requests are
+			posted to each worker in turn.
+		*/
+		virtual void setChannelAffinity(bool enabled) { mChannelAffinity = enabled; }
+		/// Get whether requests are assigned to workers by channel
+		virtual bool getChannelAffinity() const { return mChannelAffinity; }
+
+		/// Get the number of requests processed by a worker other than the one they were posted to
+		size_t getStealCount() const { return mStealCount.get(); }
+		/// Get the number of requests waiting to be processed
+		size_t getQueuedRequestCount() const { return mQueuedCount.get(); }
+
+	protected:
+		/// A request waiting in a worker's inbox or queue
+		struct QueuedRequest
+		{
+			Request* request;
+			/// Value of mAbortGeneration when this was queued
+			uint32 abortGeneration;
+			/// Link for the inbox stack
+			QueuedRequest* next;
+		};
+
+		/** Queue of requests owned by a single worker.
+		@remarks
+			Only the owning thread may push; any thread may take, in FIFO order.
+			Taking is a single compare-and-swap on the front index, so the owner
+			and thieves only collide when they take the same request. The ring
+			grows when full; replaced rings are kept until destruction because a
+			thief may still be reading from one.
+		*/
+		class _OgreExport StealQueue : public UtilityAlloc
+		{
+		public:
+			StealQueue();
+			~StealQueue();
+			/// Add a request to the back of the queue (owner only)
+			void push(QueuedRequest* q);
+			/// Take a request from the front of the queue, or return null if empty
+			QueuedRequest* take();
+			/// Returns whether the queue is empty (may be stale)
+			bool empty() const;
+		protected:
+			struct Ring
+			{
+				size_t mask;
+				QueuedRequest* volatile* slots;
+				Ring* retired;
+			};
+			AtomicScalar<size_t> mFront;
+			AtomicScalar<size_t> mBack;
+			/// Only replaced by the owner, before the mBack increment which needs it
+			Ring* volatile mRing;
+
+			Ring* createRing(size_t capacity, Ring* retired);
+			void grow();
+		};
+
+		/// Per-thread state
+		struct Worker : public UtilityAlloc
+		{
+			StealQueue queue;
+			/** Requests posted by other threads, most recent first (a QueuedRequest*,
+				held as an integer since AtomicScalar only supports integral types) */
+			AtomicScalar<size_t> inbox;
+			/// The request this worker is processing
+			Request* current;
+			OGRE_MUTEX(currentMutex)
+
+			Worker() : inbox(0), current(0) {}
+		};
+		typedef vector<Worker*>::type WorkerList;
+		/** Per-thread state for every worker thread, followed by one for threads
+			calling _processNextRequest themselves.
+		*/
+		WorkerList mWorkerSlots;
+		/// Guards the final entry of mWorkerSlots
+		OGRE_MUTEX(mExternalMutex)
+
+		/// Record of an abort which may apply to queued requests
+		struct AbortRecord
+		{
+			enum Scope { AS_ID, AS_CHANNEL, AS_ALL };
+			Scope scope;
+			RequestID id;
+			uint16 channel;
+			uint32 generation;
+		};
+		typedef vector<AbortRecord>::type AbortRecordList;
+		AbortRecordList mAbortRecords;
+		AtomicScalar<uint32> mAbortGeneration;
+		OGRE_MUTEX(mAbortMutex)
+
+		AtomicScalar<RequestID> mNextRequestID;
+		AtomicScalar<size_t> mQueuedCount;
+		/// Queued requests which have not yet been checked for aborts
+		AtomicScalar<size_t> mUncheckedCount;
+		AtomicScalar<size_t> mStealCount;
+		AtomicScalar<size_t> mNextWorker;
+		AtomicScalar<size_t> mWorkersStarted;
+		AtomicScalar<size_t> mIdleWorkers;
+		bool mChannelAffinity;
+
+		size_t mNumThreadsRegisteredWithRS;
+		/// Init notification mutex (must lock before waiting on initCondition)
+		OGRE_MUTEX(mInitMutex)
+		/// Synchroniser token to wait / notify on thread init
+		OGRE_THREAD_SYNCHRONISER(mInitSync)
+		/// Idle workers wait on this
+		OGRE_MUTEX(mIdleMutex)
+		OGRE_THREAD_SYNCHRONISER(mIdleCondition)
+
+		typedef vector<OGRE_THREAD_TYPE*>::type WorkerThreadList;
+		WorkerThreadList mWorkers;
+
+		virtual void notifyWorkers();
+		/// Notify that a thread has registered itself with the render system
+		virtual void notifyThreadRegistered();
+		/// Suspend the calling worker until there are requests to process
+		virtual void waitForWork();
+
+		/// Post a new request to the inbox of the worker it has affinity with
+		void postRequest(Request* req);
+		/// Take the next request for the given worker slot, stealing if need be
+		QueuedRequest* takeRequest(size_t slot);
+		/// Move everything in a worker's inbox into the queue of worker slot 'dest'
+		bool drainInbox(Worker* src, size_t dest);
+		/// Process a request taken from a queue (which is freed) and queue the response
+		void processQueuedRequest(QueuedRequest* q, Worker* w);
+		/** Process a request and dispatch the response.
+		@param r The request, which is owned by the response afterwards
+		@param abortGeneration Value of mAbortGeneration when the request was queued
+		@param w The worker slot processing the request, or null for other threads
+		@param synchronous Whether to process the response immediately; otherwise the
+			request came off a queue and counts as unchecked until tested for aborts
+		*/
+		void processQueuedRequest(Request* r, uint32 abortGeneration, Worker* w, bool synchronous);
+		/// Call the request handlers for a request
+		Response* dispatchRequest(Request* r);
+		/// Returns whether a recorded abort applies to a queued request
+		bool isAbortPending(const Request* r, uint32 abortGeneration);
+		/// Record an abort, mark requests in progress and responses
+		void recordAbort(const AbortRecord& rec);
+		/// Returns whether an abort record applies to a request
+		static bool abortApplies(const AbortRecord& rec, const Request* r);
+		/// Delete the worker thread slots (and optionally the external one) and any requests queued on them
+		void destroyWorkerSlots(bool includeExternal);
+		/// Returns whether trivial log messages will be written
+		bool isTrivialLogging() const;
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
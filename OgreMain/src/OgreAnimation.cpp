@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
 #include "OgreStringConverter.h"
+#include "OgreOptimisedUtil.h"
+#include "OgrePlatformInformation.h"
 
 namespace Ogre {
 
@@ -91,6 +93,23 @@ namespace Ogre {
 
         return ret;
     }
+	//---------------------------------------------------------------------
+	CompressedNodeAnimationTrack* Animation::createCompressedNodeTrack(unsigned short handle,
+		Node* node)
+	{
+		if (hasNodeTrack(handle))
+		{
+			OGRE_EXCEPT(Exception::ERR_DUPLICATE_ITEM, 
+				"Node track with the specified handle " +
+				StringConverter::toString(handle) + " already exists",
+				"Animation::createCompressedNodeTrack");
+		}
+
+		CompressedNodeAnimationTrack* ret = OGRE_NEW CompressedNodeAnimationTrack(this, handle, node);
+
+		mNodeTrackList[handle] = ret;
+		return ret;
+	}
     //---------------------------------------------------------------------
     unsigned short Animation::getNumNodeTracks(void) const
     {
@@ -346,6 +365,12 @@ namespace Ogre {
         // Calculate time index for fast keyframe search
         TimeIndex timeIndex = _getTimeIndex(timePos);
 
+        if (mInterpolationMode == IM_LINEAR && mRotationInterpolationMode == RIM_LINEAR)
+        {
+            applyToSkeletonBatched(skel, timeIndex, weight, 0, scale);
+            return;
+        }
+
         NodeTrackList::iterator i;
         for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
         {
@@ -363,6 +388,12 @@ namespace Ogre {
       // Calculate time index for fast keyframe search
       TimeIndex timeIndex = _getTimeIndex(timePos);
 
+      if (mInterpolationMode == IM_LINEAR && mRotationInterpolationMode == RIM_LINEAR)
+      {
+        applyToSkeletonBatched(skel, timeIndex, weight, blendMask, scale);
+        return;
+      }
+
       NodeTrackList::iterator i;
       for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
       {
@@ -371,6 +402,142 @@ namespace Ogre {
 		i->second->applyToNode(b, timeIndex, (*blendMask)[b->getHandle()] * weight, scale);
       }
     }
+	//---------------------------------------------------------------------
+	/** Node track results waiting for their rotations to be interpolated,
+		see Animation::applyToSkeletonBatched. */
+	struct NodeTrackBatch
+	{
+		enum { SIZE = 32 };
+
+		// Storage for the quaternion arrays, interpolation factors and weights
+		OGRE_SIMD_ALIGNED_DECL(float, arrays[SIZE * 14]);
+		QuaternionArrays from;
+		QuaternionArrays to;
+		QuaternionArrays identity;
+		float* factors;
+		float* weights;
+		Node* nodes[SIZE];
+		Vector3 translations[SIZE];
+		Vector3 scales[SIZE];
+		size_t count;
+
+		NodeTrackBatch() : count(0)
+		{
+			from.w = arrays;
+			from.x = arrays + SIZE;
+			from.y = arrays + SIZE * 2;
+			from.z = arrays + SIZE * 3;
+			to.w = arrays + SIZE * 4;
+			to.x = arrays + SIZE * 5;
+			to.y = arrays + SIZE * 6;
+			to.z = arrays + SIZE * 7;
+			identity.w = arrays + SIZE * 8;
+			identity.x = arrays + SIZE * 9;
+			identity.y = arrays + SIZE * 10;
+			identity.z = arrays + SIZE * 11;
+			factors = arrays + SIZE * 12;
+			weights = arrays + SIZE * 13;
+			for (size_t i = 0; i < SIZE; ++i)
+			{
+				identity.w[i] = 1;
+				identity.x[i] = identity.y[i] = identity.z[i] = 0;
+			}
+		}
+
+		/// Interpolate the rotations and apply everything to the nodes
+		void flush()
+		{
+			OptimisedUtil* util = OptimisedUtil::getImplementation();
+			// Between the key frames, then from no rotation to the result by
+			// the weight, as NodeAnimationTrack::applyToNode does
+			util->nlerpQuaternions(from, to, factors, to, count, true);
+			util->nlerpQuaternions(identity, to, weights, to, count, true);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				nodes[i]->translate(translations[i]);
+				nodes[i]->rotate(Quaternion(to.w[i], to.x[i], to.y[i], to.z[i]));
+				nodes[i]->scale(scales[i]);
+			}
+			count = 0;
+		}
+	};
+	//---------------------------------------------------------------------
+	void Animation::applyToSkeletonBatched(Skeleton* skel, const TimeIndex& timeIndex, 
+		Real weight, const AnimationState::BoneBlendMask* blendMask, Real scale)
+	{
+		NodeTrackBatch batch;
+		TransformKeyFrame decoded1(0, 0), decoded2(0, 0);
+
+		NodeTrackList::iterator i;
+		for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
+		{
+			NodeAnimationTrack* track = i->second;
+			Bone* b = skel->getBone(i->first);
+			Real trackWeight = blendMask ? (*blendMask)[b->getHandle()] * weight : weight;
+
+			// Tracks which don't interpolate in the usual way apply themselves
+			if (track->getListener() || !track->getUseShortestRotationPath())
+			{
+				track->applyToNode(b, timeIndex, trackWeight, scale);
+				continue;
+			}
+			if (!track->getNumKeyFrames() || !trackWeight)
+				continue;
+
+			Real t;
+			TransformKeyFrame *k1, *k2;
+			if (track->isCompressed())
+			{
+				// Decode into our own key frames, since the track's are shared
+				// by every thread applying the animation
+				k1 = &decoded1;
+				k2 = &decoded2;
+				t = static_cast<CompressedNodeAnimationTrack*>(track)->_decodeKeyFramesAtTime(
+					timeIndex, k1, k2);
+			}
+			else
+			{
+				KeyFrame *kBase1, *kBase2;
+				t = track->getKeyFramesAtTime(timeIndex, &kBase1, &kBase2);
+				k1 = static_cast<TransformKeyFrame*>(kBase1);
+				k2 = static_cast<TransformKeyFrame*>(kBase2);
+			}
+
+			size_t n = batch.count;
+			const Quaternion& q1 = k1->getRotation();
+			const Quaternion& q2 = k2->getRotation();
+			batch.from.w[n] = q1.w;
+			batch.from.x[n] = q1.x;
+			batch.from.y[n] = q1.y;
+			batch.from.z[n] = q1.z;
+			batch.to.w[n] = q2.w;
+			batch.to.x[n] = q2.x;
+			batch.to.y[n] = q2.y;
+			batch.to.z[n] = q2.z;
+			batch.factors[n] = t;
+			batch.weights[n] = trackWeight;
+			batch.nodes[n] = b;
+
+			// Translation and scale are cheap, so are done straight away
+			Vector3 base = k1->getTranslate();
+			batch.translations[n] = (base + ((k2->getTranslate() - base) * t)) * trackWeight * scale;
+
+			base = k1->getScale();
+			Vector3 scl = base + ((k2->getScale() - base) * t);
+			if (scale != 1.0f && scl != Vector3::UNIT_SCALE)
+			{
+				scl = Vector3::UNIT_SCALE + (scl - Vector3::UNIT_SCALE) * scale;
+			}
+			batch.scales[n] = scl;
+
+			if (++batch.count == NodeTrackBatch::SIZE)
+				batch.flush();
+		}
+
+		if (batch.count)
+			batch.flush();
+	}
 	//---------------------------------------------------------------------
 	void Animation::apply(Entity* entity, Real timePos, Real weight, 
 		bool software, bool hardware)
@@ -528,6 +695,24 @@ namespace Ogre {
 		
 	}
 	//-----------------------------------------------------------------------
+	void Animation::compressNodeTracks(Real translationTolerance, const Radian& rotationTolerance,
+		Real scaleTolerance)
+	{
+		NodeTrackList::iterator i;
+		for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
+		{
+			NodeAnimationTrack* track = i->second;
+			CompressedNodeAnimationTrack* compressed = OGRE_NEW CompressedNodeAnimationTrack(
+				this, i->first, track->getAssociatedNode());
+			compressed->compress(track, translationTolerance, rotationTolerance, scaleTolerance);
+			compressed->setListener(track->getListener());
+
+			i->second = compressed;
+			OGRE_DELETE track;
+		}
+		_keyFrameListChanged();
+	}
+	//-----------------------------------------------------------------------
     void Animation::_collectIdentityNodeTracks(TrackHandleList& tracks) const
     {
 		NodeTrackList::const_iterator i, iend;
@@ -663,6 +848,23 @@ namespace Ogre {
         return TimeIndex(timePos, std::distance(mKeyFrameTimes.begin(), it));
     }
     //-----------------------------------------------------------------------
+    void Animation::_prepareForApply(void) const
+    {
+        if (mKeyFrameTimesDirty)
+        {
+            buildKeyFrameTimeList();
+        }
+
+        if (mInterpolationMode == IM_SPLINE)
+        {
+            NodeTrackList::const_iterator i;
+            for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
+            {
+                i->second->_buildInterpolationSplines();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void Animation::buildKeyFrameTimeList(void) const
     {
         NodeTrackList::const_iterator i;
@@ -46,6 +46,23 @@ namespace Ogre {
                 return kf->getTime() < kf2->getTime();
             }
         };
+
+        // Whether a node key frame does anything useful
+        bool isNonZeroKeyFrame(const TransformKeyFrame* kf)
+        {
+			// look for keyframes which have any component which is non-zero
+			// Since exporters can be a little inaccurate sometimes we use a
+			// tolerance value rather than looking for nothing
+			Vector3 trans = kf->getTranslate();
+			Vector3 scale = kf->getScale();
+			Vector3 axis;
+			Radian angle;
+			kf->getRotation().ToAngleAxis(angle, axis);
+			Real tolerance = 1e-3f;
+			return !trans.positionEquals(Vector3::ZERO, tolerance) ||
+				!scale.positionEquals(Vector3::UNIT_SCALE, tolerance) ||
+				!Math::RealEqual(angle.valueRadians(), 0.0f, tolerance);
+        }
     }
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -383,17 +400,20 @@ namespace Ogre {
 				return;
 		}
 
-		TransformKeyFrame* kret = static_cast<TransformKeyFrame*>(kf);
-
         // Keyframe pointers
 		KeyFrame *kBase1, *kBase2;
-        TransformKeyFrame *k1, *k2;
         unsigned short firstKeyIndex;
 
         Real t = this->getKeyFramesAtTime(timeIndex, &kBase1, &kBase2, &firstKeyIndex);
-		k1 = static_cast<TransformKeyFrame*>(kBase1);
-		k2 = static_cast<TransformKeyFrame*>(kBase2);
-
+		interpolateKeyFrames(static_cast<TransformKeyFrame*>(kBase1),
+			static_cast<TransformKeyFrame*>(kBase2), t, firstKeyIndex,
+			static_cast<TransformKeyFrame*>(kf));
+    }
+    //---------------------------------------------------------------------
+    void NodeAnimationTrack::interpolateKeyFrames(const TransformKeyFrame* k1,
+		const TransformKeyFrame* k2, Real t, unsigned short firstKeyIndex,
+		TransformKeyFrame* kret) const
+    {
         if (t == 0.0)
         {
             // Just use k1
@@ -479,7 +499,7 @@ namespace Ogre {
 		Real scl)
     {
 		// Nothing to do if no keyframes or zero weight or no node
-		if (mKeyFrames.empty() || !weight || !node)
+		if (!getNumKeyFrames() || !weight || !node)
 			return;
 
         TransformKeyFrame kf(0, timeIndex.getTimePos());
@@ -574,19 +594,7 @@ namespace Ogre {
         KeyFrameList::const_iterator i = mKeyFrames.begin();
         for (; i != mKeyFrames.end(); ++i)
         {
-			// look for keyframes which have any component which is non-zero
-			// Since exporters can be a little inaccurate sometimes we use a
-			// tolerance value rather than looking for nothing
-			TransformKeyFrame* kf = static_cast<TransformKeyFrame*>(*i);
-			Vector3 trans = kf->getTranslate();
-			Vector3 scale = kf->getScale();
-			Vector3 axis;
-			Radian angle;
-			kf->getRotation().ToAngleAxis(angle, axis);
-			Real tolerance = 1e-3f;
-			if (!trans.positionEquals(Vector3::ZERO, tolerance) ||
-				!scale.positionEquals(Vector3::UNIT_SCALE, tolerance) ||
-				!Math::RealEqual(angle.valueRadians(), 0.0f, tolerance))
+			if (isNonZeroKeyFrame(static_cast<TransformKeyFrame*>(*i)))
 			{
 				return true;
 			}
@@ -677,6 +685,466 @@ namespace Ogre {
 		return newTrack;
 	}	
 	//--------------------------------------------------------------------------
+	// Compressed node specialisations
+	//--------------------------------------------------------------------------
+	namespace {
+		/// Largest magnitude of the components kept by the smallest three encoding
+		const Real ROTATION_RANGE = 0.70710678f;
+		/// Steps used for each quantised rotation component, which has 15 bits
+		const Real ROTATION_STEPS = 32767.0f;
+		/// Steps used for each quantised translation or scale component
+		const Real VECTOR_STEPS = 65535.0f;
+
+		/// Angle of the rotation between 2 orientations
+		Radian rotationDifference(const Quaternion& a, const Quaternion& b)
+		{
+			Real d = std::min(Math::Abs(a.Dot(b)), (Real)1.0f);
+			return Math::ACos(d) * 2;
+		}
+	}
+	//--------------------------------------------------------------------------
+	CompressedNodeAnimationTrack::CompressedNodeAnimationTrack(Animation* parent,
+		unsigned short handle)
+		: NodeAnimationTrack(parent, handle), mChannels(0)
+		, mConstantRotation(Quaternion::IDENTITY)
+		, mTranslateBase(Vector3::ZERO), mTranslateExtent(Vector3::ZERO)
+		, mScaleBase(Vector3::UNIT_SCALE), mScaleExtent(Vector3::ZERO)
+		, mDecodedKeyFrame1(0, 0), mDecodedKeyFrame2(0, 0)
+	{
+	}
+	//--------------------------------------------------------------------------
+	CompressedNodeAnimationTrack::CompressedNodeAnimationTrack(Animation* parent,
+		unsigned short handle, Node* targetNode)
+		: NodeAnimationTrack(parent, handle, targetNode), mChannels(0)
+		, mConstantRotation(Quaternion::IDENTITY)
+		, mTranslateBase(Vector3::ZERO), mTranslateExtent(Vector3::ZERO)
+		, mScaleBase(Vector3::UNIT_SCALE), mScaleExtent(Vector3::ZERO)
+		, mDecodedKeyFrame1(0, 0), mDecodedKeyFrame2(0, 0)
+	{
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::compress(const NodeAnimationTrack* source,
+		Real translationTolerance, const Radian& rotationTolerance, Real scaleTolerance)
+	{
+		// Copy the source first, since it may be this track, and a compressed
+		// source decodes every key into the same object
+		unsigned short numKeys = source->getNumKeyFrames();
+		TimeList times(numKeys);
+		vector<Quaternion>::type rotations(numKeys);
+		vector<Vector3>::type translations(numKeys);
+		vector<Vector3>::type scales(numKeys);
+		for (unsigned short k = 0; k < numKeys; ++k)
+		{
+			const TransformKeyFrame* kf = source->getNodeKeyFrame(k);
+			times[k] = kf->getTime();
+			rotations[k] = kf->getRotation();
+			translations[k] = kf->getTranslate();
+			scales[k] = kf->getScale();
+		}
+		bool shortestPath = source->getUseShortestRotationPath();
+
+		// Extend the span from each kept key for as long as interpolating
+		// across it reproduces every key it skips
+		vector<unsigned short>::type kept;
+		unsigned short anchor = 0;
+		if (numKeys)
+			kept.push_back(0);
+		for (unsigned short end = 2; end < numKeys; ++end)
+		{
+			Real span = times[end] - times[anchor];
+			bool fits = true;
+			for (unsigned short k = anchor + 1; k < end && fits; ++k)
+			{
+				Real t = span > 0 ? (times[k] - times[anchor]) / span : 0;
+				Vector3 translate = translations[anchor] + (translations[end] - translations[anchor]) * t;
+				Vector3 scale = scales[anchor] + (scales[end] - scales[anchor]) * t;
+				Quaternion rotate = Quaternion::nlerp(t, rotations[anchor], rotations[end], shortestPath);
+				fits = translate.distance(translations[k]) <= translationTolerance &&
+					scale.positionEquals(scales[k], scaleTolerance) &&
+					rotationDifference(rotate, rotations[k]) <= rotationTolerance;
+			}
+			if (!fits)
+			{
+				anchor = end - 1;
+				kept.push_back(anchor);
+			}
+		}
+		if (numKeys > 1)
+			kept.push_back(numKeys - 1);
+
+		removeAllKeyFrames();
+		mUseShortestRotationPath = shortestPath;
+		size_t numKept = kept.size();
+		if (!numKept)
+			return;
+
+		// A channel only needs a value per key if some key differs from the
+		// first by more than the tolerance
+		mChannels = 0;
+		Vector3 minTranslate = translations[kept[0]], maxTranslate = minTranslate;
+		Vector3 minScale = scales[kept[0]], maxScale = minScale;
+		for (size_t i = 0; i < numKept; ++i)
+		{
+			unsigned short k = kept[i];
+			if (rotationDifference(rotations[k], rotations[kept[0]]) > rotationTolerance)
+				mChannels |= CH_ROTATION;
+			if (translations[k].distance(translations[kept[0]]) > translationTolerance)
+				mChannels |= CH_TRANSLATION;
+			if (!scales[k].positionEquals(scales[kept[0]], scaleTolerance))
+				mChannels |= CH_SCALE;
+			minTranslate.makeFloor(translations[k]);
+			maxTranslate.makeCeil(translations[k]);
+			minScale.makeFloor(scales[k]);
+			maxScale.makeCeil(scales[k]);
+		}
+
+		mConstantRotation = rotations[kept[0]];
+		mTranslateBase = translations[kept[0]];
+		mTranslateExtent = Vector3::ZERO;
+		mScaleBase = scales[kept[0]];
+		mScaleExtent = Vector3::ZERO;
+		if (mChannels & CH_ROTATION)
+			mRotations.resize(numKept * 3);
+		if (mChannels & CH_TRANSLATION)
+		{
+			mTranslateBase = minTranslate;
+			mTranslateExtent = maxTranslate - minTranslate;
+			mTranslations.resize(numKept * 3);
+		}
+		if (mChannels & CH_SCALE)
+		{
+			mScaleBase = minScale;
+			mScaleExtent = maxScale - minScale;
+			mScales.resize(numKept * 3);
+		}
+
+		mKeyTimes.resize(numKept);
+		for (size_t i = 0; i < numKept; ++i)
+		{
+			unsigned short k = kept[i];
+			mKeyTimes[i] = times[k];
+			if (mChannels & CH_ROTATION)
+				packRotation(rotations[k], &mRotations[i * 3]);
+			if (mChannels & CH_TRANSLATION)
+				packVector(translations[k], mTranslateBase, mTranslateExtent, &mTranslations[i * 3]);
+			if (mChannels & CH_SCALE)
+				packVector(scales[k], mScaleBase, mScaleExtent, &mScales[i * 3]);
+		}
+
+		_keyFrameDataChanged();
+		mParent->_keyFrameListChanged();
+	}
+	//--------------------------------------------------------------------------
+	size_t CompressedNodeAnimationTrack::getCompressedSize(void) const
+	{
+		return mKeyTimes.size() * sizeof(Real) +
+			(mRotations.size() + mTranslations.size() + mScales.size()) * sizeof(uint16) +
+			sizeof(Quaternion) + sizeof(Vector3) * 4;
+	}
+	//--------------------------------------------------------------------------
+	unsigned short CompressedNodeAnimationTrack::getNumKeyFrames(void) const
+	{
+		return (unsigned short)mKeyTimes.size();
+	}
+	//--------------------------------------------------------------------------
+	KeyFrame* CompressedNodeAnimationTrack::getKeyFrame(unsigned short index) const
+	{
+		// If you hit this assert, then the keyframe index is out of bounds
+		assert(index < (ushort)mKeyTimes.size());
+
+		decodeKeyFrame(index, &mDecodedKeyFrame1);
+		return &mDecodedKeyFrame1;
+	}
+	//--------------------------------------------------------------------------
+	Real CompressedNodeAnimationTrack::getKeyFramesAtTime(const TimeIndex& timeIndex,
+		KeyFrame** keyFrame1, KeyFrame** keyFrame2, unsigned short* firstKeyIndex) const
+	{
+		*keyFrame1 = &mDecodedKeyFrame1;
+		*keyFrame2 = &mDecodedKeyFrame2;
+		return _decodeKeyFramesAtTime(timeIndex, &mDecodedKeyFrame1, &mDecodedKeyFrame2, firstKeyIndex);
+	}
+	//--------------------------------------------------------------------------
+	Real CompressedNodeAnimationTrack::_decodeKeyFramesAtTime(const TimeIndex& timeIndex,
+		TransformKeyFrame* keyFrame1, TransformKeyFrame* keyFrame2, unsigned short* firstKeyIndex) const
+	{
+		unsigned short key1, key2;
+		Real t = findKeyFrames(timeIndex, key1, key2);
+		decodeKeyFrame(key1, keyFrame1);
+		decodeKeyFrame(key2, keyFrame2);
+		if (firstKeyIndex)
+			*firstKeyIndex = key1;
+		return t;
+	}
+	//--------------------------------------------------------------------------
+	Real CompressedNodeAnimationTrack::findKeyFrames(const TimeIndex& timeIndex,
+		unsigned short& key1, unsigned short& key2) const
+	{
+		// As AnimationTrack::getKeyFramesAtTime, but using the key times
+		Real t1, t2;
+		Real timePos = timeIndex.getTimePos();
+
+		TimeList::const_iterator i;
+		if (timeIndex.hasKeyIndex())
+		{
+			assert(timeIndex.getKeyIndex() < mKeyFrameIndexMap.size());
+			i = mKeyTimes.begin() + mKeyFrameIndexMap[timeIndex.getKeyIndex()];
+		}
+		else
+		{
+			Real totalAnimationLength = mParent->getLength();
+			assert(totalAnimationLength > 0.0f && "Invalid animation length!");
+
+			while (timePos > totalAnimationLength && totalAnimationLength > 0.0f)
+			{
+				timePos -= totalAnimationLength;
+			}
+
+			i = std::lower_bound(mKeyTimes.begin(), mKeyTimes.end(), timePos);
+		}
+
+		if (i == mKeyTimes.end())
+		{
+			// There is no keyframe after this time, wrap back to first
+			key2 = 0;
+			t2 = mParent->getLength() + mKeyTimes.front();
+			--i;
+		}
+		else
+		{
+			key2 = static_cast<unsigned short>(i - mKeyTimes.begin());
+			t2 = *i;
+			if (i != mKeyTimes.begin() && timePos < *i)
+			{
+				--i;
+			}
+		}
+
+		key1 = static_cast<unsigned short>(i - mKeyTimes.begin());
+		t1 = *i;
+
+		if (t1 == t2)
+		{
+			return 0.0;
+		}
+		else
+		{
+			return (timePos - t1) / (t2 - t1);
+		}
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::decodeKeyFrame(unsigned short index, TransformKeyFrame* kf) const
+	{
+		// Decoded key frames have no parent, so setting them doesn't mark
+		// this track as changed
+		*kf = TransformKeyFrame(0, mKeyTimes[index]);
+		kf->setRotation((mChannels & CH_ROTATION) ?
+			unpackRotation(&mRotations[index * 3]) : mConstantRotation);
+		kf->setTranslate((mChannels & CH_TRANSLATION) ?
+			unpackVector(&mTranslations[index * 3], mTranslateBase, mTranslateExtent) : mTranslateBase);
+		kf->setScale((mChannels & CH_SCALE) ?
+			unpackVector(&mScales[index * 3], mScaleBase, mScaleExtent) : mScaleBase);
+	}
+	//--------------------------------------------------------------------------
+	KeyFrame* CompressedNodeAnimationTrack::createKeyFrame(Real timePos)
+	{
+		(void)timePos;
+		OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+			"Key frames can't be added to a compressed track.",
+			"CompressedNodeAnimationTrack::createKeyFrame");
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::removeKeyFrame(unsigned short index)
+	{
+		(void)index;
+		OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+			"Key frames can't be removed from a compressed track.",
+			"CompressedNodeAnimationTrack::removeKeyFrame");
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::removeAllKeyFrames(void)
+	{
+		mChannels = 0;
+		mKeyTimes.clear();
+		mRotations.clear();
+		mTranslations.clear();
+		mScales.clear();
+
+		_keyFrameDataChanged();
+		mParent->_keyFrameListChanged();
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::getInterpolatedKeyFrame(const TimeIndex& timeIndex,
+		KeyFrame* kf) const
+	{
+		if (mListener)
+		{
+			if (mListener->getInterpolatedKeyFrame(this, timeIndex, kf))
+				return;
+		}
+
+		TransformKeyFrame k1(0, 0), k2(0, 0);
+		unsigned short firstKeyIndex;
+		Real t = _decodeKeyFramesAtTime(timeIndex, &k1, &k2, &firstKeyIndex);
+		interpolateKeyFrames(&k1, &k2, t, firstKeyIndex, static_cast<TransformKeyFrame*>(kf));
+	}
+	//--------------------------------------------------------------------------
+	bool CompressedNodeAnimationTrack::hasNonZeroKeyFrames(void) const
+	{
+		TransformKeyFrame kf(0, 0);
+		for (unsigned short k = 0; k < mKeyTimes.size(); ++k)
+		{
+			decodeKeyFrame(k, &kf);
+			if (isNonZeroKeyFrame(&kf))
+				return true;
+		}
+		return false;
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::_collectKeyFrameTimes(vector<Real>::type& keyFrameTimes)
+	{
+		for (TimeList::const_iterator i = mKeyTimes.begin(); i != mKeyTimes.end(); ++i)
+		{
+			vector<Real>::type::iterator it =
+				std::lower_bound(keyFrameTimes.begin(), keyFrameTimes.end(), *i);
+			if (it == keyFrameTimes.end() || *it != *i)
+			{
+				keyFrameTimes.insert(it, *i);
+			}
+		}
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::_buildKeyFrameIndexMap(const vector<Real>::type& keyFrameTimes)
+	{
+		mKeyFrameIndexMap.resize(keyFrameTimes.size() + 1);
+
+		size_t i = 0;
+		for (size_t j = 0; j <= keyFrameTimes.size(); ++j)
+		{
+			mKeyFrameIndexMap[j] = static_cast<ushort>(i);
+			while (j < keyFrameTimes.size() && i < mKeyTimes.size() && mKeyTimes[i] <= keyFrameTimes[j])
+				++i;
+		}
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::buildInterpolationSplines(void) const
+	{
+		if (!mSplines)
+		{
+			mSplines = OGRE_NEW_T(Splines, MEMCATEGORY_ANIMATION);
+		}
+
+		Splines* splines = mSplines;
+		splines->positionSpline.setAutoCalculate(false);
+		splines->rotationSpline.setAutoCalculate(false);
+		splines->scaleSpline.setAutoCalculate(false);
+
+		splines->positionSpline.clear();
+		splines->rotationSpline.clear();
+		splines->scaleSpline.clear();
+
+		TransformKeyFrame kf(0, 0);
+		for (unsigned short k = 0; k < mKeyTimes.size(); ++k)
+		{
+			decodeKeyFrame(k, &kf);
+			splines->positionSpline.addPoint(kf.getTranslate());
+			splines->rotationSpline.addPoint(kf.getRotation());
+			splines->scaleSpline.addPoint(kf.getScale());
+		}
+
+		splines->positionSpline.recalcTangents();
+		splines->rotationSpline.recalcTangents();
+		splines->scaleSpline.recalcTangents();
+
+		mSplineBuildNeeded = false;
+	}
+	//--------------------------------------------------------------------------
+	NodeAnimationTrack* CompressedNodeAnimationTrack::_clone(Animation* newParent) const
+	{
+		CompressedNodeAnimationTrack* newTrack =
+			newParent->createCompressedNodeTrack(mHandle, mTargetNode);
+		newTrack->mUseShortestRotationPath = mUseShortestRotationPath;
+		newTrack->mChannels = mChannels;
+		newTrack->mKeyTimes = mKeyTimes;
+		newTrack->mRotations = mRotations;
+		newTrack->mConstantRotation = mConstantRotation;
+		newTrack->mTranslations = mTranslations;
+		newTrack->mTranslateBase = mTranslateBase;
+		newTrack->mTranslateExtent = mTranslateExtent;
+		newTrack->mScales = mScales;
+		newTrack->mScaleBase = mScaleBase;
+		newTrack->mScaleExtent = mScaleExtent;
+		newTrack->_keyFrameDataChanged();
+		newParent->_keyFrameListChanged();
+		return newTrack;
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::packRotation(const Quaternion& q, uint16* packed)
+	{
+		Quaternion n = q;
+		n.normalise();
+		Real c[4] = { n.w, n.x, n.y, n.z };
+		int largest = 0;
+		for (int i = 1; i < 4; ++i)
+		{
+			if (Math::Abs(c[i]) > Math::Abs(c[largest]))
+				largest = i;
+		}
+
+		// Quantise the other 3 components to 15 bits each, and use the top
+		// bits for the index and sign of the largest, so that the sign of
+		// the whole quaternion is kept for non-shortest path interpolation
+		int j = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			Real v = (c[i] + ROTATION_RANGE) / (2 * ROTATION_RANGE) * ROTATION_STEPS + 0.5f;
+			packed[j++] = static_cast<uint16>(Math::Clamp(v, (Real)0.0f, ROTATION_STEPS));
+		}
+		packed[0] |= static_cast<uint16>((largest & 1) << 15);
+		packed[1] |= static_cast<uint16>((largest >> 1) << 15);
+		if (c[largest] < 0)
+			packed[2] |= 0x8000;
+	}
+	//--------------------------------------------------------------------------
+	Quaternion CompressedNodeAnimationTrack::unpackRotation(const uint16* packed)
+	{
+		int largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+		Real c[4];
+		Real sum = 0;
+		int j = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			c[i] = (packed[j++] & 0x7FFF) / ROTATION_STEPS * (2 * ROTATION_RANGE) - ROTATION_RANGE;
+			sum += c[i] * c[i];
+		}
+		c[largest] = Math::Sqrt(std::max((Real)1.0f - sum, (Real)0.0f));
+		if (packed[2] & 0x8000)
+			c[largest] = -c[largest];
+		return Quaternion(c[0], c[1], c[2], c[3]);
+	}
+	//--------------------------------------------------------------------------
+	void CompressedNodeAnimationTrack::packVector(const Vector3& v, const Vector3& base,
+		const Vector3& extent, uint16* packed)
+	{
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Real scaled = extent[i] > 0 ? (v[i] - base[i]) / extent[i] * VECTOR_STEPS + 0.5f : 0;
+			packed[i] = static_cast<uint16>(Math::Clamp(scaled, (Real)0.0f, VECTOR_STEPS));
+		}
+	}
+	//--------------------------------------------------------------------------
+	Vector3 CompressedNodeAnimationTrack::unpackVector(const uint16* packed, const Vector3& base,
+		const Vector3& extent)
+	{
+		return Vector3(
+			base.x + packed[0] / VECTOR_STEPS * extent.x,
+			base.y + packed[1] / VECTOR_STEPS * extent.y,
+			base.z + packed[2] / VECTOR_STEPS * extent.z);
+	}
+	//--------------------------------------------------------------------------
 	VertexAnimationTrack::VertexAnimationTrack(Animation* parent,
 		unsigned short handle, VertexAnimationType animType)
 		: AnimationTrack(parent, handle), mAnimationType(animType)
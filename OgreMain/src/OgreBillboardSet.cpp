@@ -41,12 +41,51 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreStringConverter.h"
 #include "OgreLogManager.h"
+#include "OgreSceneManager.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreParallelTaskDispatcher.h"
 #include <algorithm>
 
 namespace Ogre {
     // Init statics
     RadixSort<BillboardSet::ActiveBillboardList, Billboard*, float> BillboardSet::mRadixSorter;
 
+	namespace
+	{
+		/// Number of billboards in each chunk of a parallel vertex generation
+		const size_t BILLBOARD_CHUNK_SIZE = 512;
+		/// Floats in the 4 vertices of a billboard
+		const size_t BILLBOARD_VERTEX_FLOATS = 24;
+
+		/// Generates the vertices of chunks of staged billboards
+		class QuadVertexTaskSet : public ParallelTaskDispatcher::TaskSet
+		{
+		public:
+			QuadVertexTaskSet(const float* centres, const float* offsets, size_t offsetStride,
+				const RGBA* colours, const float* texCoords, float* dest, size_t numQuads)
+				: mCentres(centres), mOffsets(offsets), mOffsetStride(offsetStride),
+				mColours(colours), mTexCoords(texCoords), mDest(dest), mNumQuads(numQuads) {}
+
+			void processTasks(size_t begin, size_t end)
+			{
+				size_t first = begin * BILLBOARD_CHUNK_SIZE;
+				size_t last = std::min(end * BILLBOARD_CHUNK_SIZE, mNumQuads);
+				OptimisedUtil::getImplementation()->generateQuadVertices(
+					mCentres + first * 4, mOffsets + first * mOffsetStride, mOffsetStride,
+					mColours + first, mTexCoords + first * 4,
+					mDest + first * BILLBOARD_VERTEX_FLOATS, last - first);
+			}
+		protected:
+			const float* mCentres;
+			const float* mOffsets;
+			size_t mOffsetStride;
+			const RGBA* mColours;
+			const float* mTexCoords;
+			float* mDest;
+			size_t mNumQuads;
+		};
+	}
+
     //-----------------------------------------------------------------------
     BillboardSet::BillboardSet() :
 		mBoundingRadius(0.0f), 
@@ -69,7 +108,16 @@ namespace Ogre {
         mPoolSize(0),
 		mExternalData(false),
 		mAutoUpdate(true),
-		mBillboardDataChanged(true)
+		mBillboardDataChanged(true),
+		mParallelVertexGeneration(false),
+		mStagingData(0),
+		mStagedCentres(0),
+		mStagedOffsets(0),
+		mStagedTexCoords(0),
+		mStagedColours(0),
+		mNumStagedBillboards(0),
+		mStagedSharedOffsets(false),
+		mColourType(VET_COLOUR_ABGR)
     {
         setDefaultDimensions( 100, 100 );
         setMaterialName( "BaseWhite" );
@@ -103,7 +151,16 @@ namespace Ogre {
         mPoolSize(poolSize),
         mExternalData(externalData),
 		mAutoUpdate(true),
-		mBillboardDataChanged(true)
+		mBillboardDataChanged(true),
+		mParallelVertexGeneration(false),
+		mStagingData(0),
+		mStagedCentres(0),
+		mStagedOffsets(0),
+		mStagedTexCoords(0),
+		mStagedColours(0),
+		mNumStagedBillboards(0),
+		mStagedSharedOffsets(false),
+		mColourType(VET_COLOUR_ABGR)
     {
         setDefaultDimensions( 100, 100 );
         setMaterialName( "BaseWhite" );
@@ -444,6 +501,10 @@ namespace Ogre {
 
         // Init num visible
         mNumVisibleBillboards = 0;
+        mNumStagedBillboards = 0;
+        // the same conversion as the render system's, without a call through
+        // Root per billboard
+        mColourType = VertexElement::getBestColourVertexElementType();
 
         // Lock the buffer
 		if (numBillboards) // optimal lock
@@ -508,8 +569,16 @@ namespace Ogre {
             {
                 genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff,
                     mDefaultWidth, mDefaultHeight, mCamX, mCamY, mVOffset);
+                queueVertices(mVOffset, false, bb);
+            }
+            else if (mPointRendering)
+            {
+                genVertices(mVOffset, bb);
+            }
+            else
+            {
+                queueVertices(mVOffset, true, bb);
             }
-            genVertices(mVOffset, bb);
         }
         else // not all default size and not point rendering
         {
@@ -524,11 +593,11 @@ namespace Ogre {
                 genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff,
                     bb.mWidth, bb.mHeight, mCamX, mCamY, vOwnOffset);
                 // Create vertex data
-                genVertices(vOwnOffset, bb);
+                queueVertices(vOwnOffset, false, bb);
             }
             else // Use default dimension, already computed before the loop, for faster creation
             {
-                genVertices(mVOffset, bb);
+                queueVertices(mVOffset, true, bb);
             }
         }
         // Increment visibles
@@ -537,6 +606,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void BillboardSet::endBillboards(void)
     {
+        flushQueuedVertices();
         mMainBuf->unlock();
     }
 	//-----------------------------------------------------------------------
@@ -836,6 +906,14 @@ namespace Ogre {
 			}
 
 			mIndexData->indexBuffer->unlock();
+
+			// Staging for the billboards whose vertices are generated in batches
+			mStagingData = static_cast<float*>(OGRE_MALLOC_SIMD(
+				sizeof(float) * mPoolSize * 25, MEMCATEGORY_GEOMETRY));
+			mStagedCentres = mStagingData;
+			mStagedOffsets = mStagedCentres + mPoolSize * 4;
+			mStagedTexCoords = mStagedOffsets + mPoolSize * 16;
+			mStagedColours = reinterpret_cast<RGBA*>(mStagedTexCoords + mPoolSize * 4);
 		}
         mBuffersCreated = true;
     }
@@ -855,6 +933,13 @@ namespace Ogre {
 
         mMainBuf.setNull();
 
+		if (mStagingData)
+		{
+			OGRE_FREE_SIMD(mStagingData, MEMCATEGORY_GEOMETRY);
+			mStagingData = 0;
+		}
+		mNumStagedBillboards = 0;
+
 		mBuffersCreated = false;
 
 	}
@@ -1101,11 +1186,88 @@ namespace Ogre {
 		return SceneManager::FX_TYPE_MASK;
 	}
     //-----------------------------------------------------------------------
+    void BillboardSet::queueVertices(
+        const Vector3* const offsets, bool sharedOffsets, const Billboard& bb)
+    {
+        if (!mAllDefaultRotation && bb.mRotation != Radian(0))
+        {
+            // Rotated billboards keep the general path, after those before them
+            flushQueuedVertices();
+            genVertices(offsets, bb);
+            return;
+        }
+
+        // The staged billboards either all share one set of offsets or all
+        // have their own
+        if (mNumStagedBillboards && sharedOffsets != mStagedSharedOffsets)
+            flushQueuedVertices();
+        mStagedSharedOffsets = sharedOffsets;
+
+        size_t index = mNumStagedBillboards++;
+        if (!sharedOffsets || index == 0)
+        {
+            float* pOffset = mStagedOffsets + (sharedOffsets ? 0 : index * 16);
+            for (size_t corner = 0; corner < 4; ++corner)
+            {
+                *pOffset++ = offsets[corner].x;
+                *pOffset++ = offsets[corner].y;
+                *pOffset++ = offsets[corner].z;
+                *pOffset++ = 0;
+            }
+        }
+
+        float* pCentre = mStagedCentres + index * 4;
+        pCentre[0] = bb.mPosition.x;
+        pCentre[1] = bb.mPosition.y;
+        pCentre[2] = bb.mPosition.z;
+        pCentre[3] = 0;
+
+        mStagedColours[index] = VertexElement::convertColourValue(bb.mColour, mColourType);
+
+        assert( bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size() );
+        const Ogre::FloatRect & r =
+            bb.mUseTexcoordRect ? bb.mTexcoordRect : mTextureCoords[bb.mTexcoordIndex];
+        float* pTexCoord = mStagedTexCoords + index * 4;
+        pTexCoord[0] = r.left;
+        pTexCoord[1] = r.top;
+        pTexCoord[2] = r.right;
+        pTexCoord[3] = r.bottom;
+    }
+    //-----------------------------------------------------------------------
+    void BillboardSet::flushQueuedVertices(void)
+    {
+        if (!mNumStagedBillboards)
+            return;
+
+        size_t offsetStride = mStagedSharedOffsets ? 0 : 16;
+
+        ParallelTaskDispatcher* dispatcher = 0;
+        if (mParallelVertexGeneration && mNumStagedBillboards > BILLBOARD_CHUNK_SIZE)
+        {
+            SceneManager* sceneMgr = mManager;
+            if (!sceneMgr && getParentSceneNode())
+                sceneMgr = getParentSceneNode()->getCreator();
+            if (sceneMgr)
+                dispatcher = sceneMgr->getParallelDispatcher();
+        }
+
+        // Each chunk writes its own part of the locked buffer
+        QuadVertexTaskSet tasks(mStagedCentres, mStagedOffsets, offsetStride,
+            mStagedColours, mStagedTexCoords, mLockPtr, mNumStagedBillboards);
+        size_t numChunks = (mNumStagedBillboards + BILLBOARD_CHUNK_SIZE - 1) / BILLBOARD_CHUNK_SIZE;
+        if (dispatcher)
+            dispatcher->dispatch(&tasks, numChunks);
+        else
+            tasks.processTasks(0, numChunks);
+
+        mLockPtr += mNumStagedBillboards * BILLBOARD_VERTEX_FLOATS;
+        mNumStagedBillboards = 0;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::genVertices(
         const Vector3* const offsets, const Billboard& bb)
     {
-        RGBA colour;
-        Root::getSingleton().convertColourValue(bb.mColour, &colour);
+        RGBA colour = VertexElement::convertColourValue(bb.mColour, mColourType);
 		RGBA* pCol;
 
         // Texcoords
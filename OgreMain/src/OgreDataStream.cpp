@@ -30,6 +30,20 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreException.h"
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  if !defined(NOMINMAX) && defined(_MSC_VER)
+#	define NOMINMAX // required to stop windows.h messing up std::min
+#  endif
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 namespace Ogre {
 
     //-----------------------------------------------------------------------
@@ -413,6 +427,83 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
+    MappedFileDataStream::MappedFileDataStream(const String& name, const String& path)
+        : MemoryDataStream(name, (void*)0, 0, false, false)
+    {
+        void* data = 0;
+        size_t size = 0;
+        bool failed = false;
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + path,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+        size = (size_t)GetFileSize(file, 0);
+        if (size)
+        {
+            // The view keeps the file and the mapping open
+            HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+            if (mapping)
+            {
+                data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+            failed = (data == 0);
+        }
+        CloseHandle(file);
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND, "Cannot open file: " + path,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+        struct stat tagStat;
+        if (fstat(file, &tagStat) == 0)
+            size = (size_t)tagStat.st_size;
+        if (size)
+        {
+            // The mapping keeps the file open
+            data = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+            if (data == MAP_FAILED)
+                data = 0;
+            failed = (data == 0);
+        }
+        ::close(file);
+#endif
+        if (failed)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot map file: " + path,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+
+        mData = mPos = static_cast<uchar*>(data);
+        mSize = size;
+        mEnd = mData + mSize;
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        close();
+    }
+    //-----------------------------------------------------------------------
+    void MappedFileDataStream::close(void)
+    {
+        if (mData)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            UnmapViewOfFile(mData);
+#else
+            munmap(mData, mSize);
+#endif
+            mData = mPos = mEnd = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
     FileStreamDataStream::FileStreamDataStream(std::ifstream* s, bool freeOnClose)
         : DataStream(), mpInStream(s), mpFStreamRO(s), mpFStream(0), mFreeOnClose(freeOnClose)
     {
@@ -38,9 +38,18 @@ namespace Ogre {
         mpData = static_cast<unsigned char*>(OGRE_MALLOC_SIMD(mSizeInBytes, MEMCATEGORY_GEOMETRY));
 	}
 	//-----------------------------------------------------------------------
+	DefaultHardwareVertexBuffer::DefaultHardwareVertexBuffer(size_t vertexSize, size_t numVertices, 
+		HardwareBuffer::Usage usage, void* data, const DataStreamPtr& dataOwner)
+        : HardwareVertexBuffer(0, vertexSize, numVertices, usage, true, false) // always software, never shadowed
+		, mpData(static_cast<unsigned char*>(data))
+		, mDataOwner(dataOwner)
+	{
+	}
+	//-----------------------------------------------------------------------
     DefaultHardwareVertexBuffer::~DefaultHardwareVertexBuffer()
 	{
-		OGRE_FREE_SIMD(mpData, MEMCATEGORY_GEOMETRY);
+		if (mDataOwner.isNull())
+			OGRE_FREE_SIMD(mpData, MEMCATEGORY_GEOMETRY);
 	}
 	//-----------------------------------------------------------------------
     void* DefaultHardwareVertexBuffer::lockImpl(size_t offset, size_t length, LockOptions options)
@@ -89,9 +98,18 @@ namespace Ogre {
 		mpData = OGRE_ALLOC_T(unsigned char, mSizeInBytes, MEMCATEGORY_GEOMETRY);
 	}
 	//-----------------------------------------------------------------------
+	DefaultHardwareIndexBuffer::DefaultHardwareIndexBuffer(IndexType idxType, 
+		size_t numIndexes, HardwareBuffer::Usage usage, void* data, const DataStreamPtr& dataOwner) 
+		: HardwareIndexBuffer(0, idxType, numIndexes, usage, true, false) // always software, never shadowed
+		, mpData(static_cast<unsigned char*>(data))
+		, mDataOwner(dataOwner)
+	{
+	}
+	//-----------------------------------------------------------------------
     DefaultHardwareIndexBuffer::~DefaultHardwareIndexBuffer()
 	{
-		OGRE_FREE(mpData, MEMCATEGORY_GEOMETRY);
+		if (mDataOwner.isNull())
+			OGRE_FREE(mpData, MEMCATEGORY_GEOMETRY);
 	}
 	//-----------------------------------------------------------------------
     void* DefaultHardwareIndexBuffer::lockImpl(size_t offset, size_t length, LockOptions options)
@@ -159,6 +177,36 @@ namespace Ogre {
 		return HardwareIndexBufferSharedPtr(ib);
 	}
 	//-----------------------------------------------------------------------
+	HardwareVertexBufferSharedPtr 
+        DefaultHardwareBufferManagerBase::createVertexBufferFromData(size_t vertexSize, 
+		size_t numVerts, HardwareBuffer::Usage usage, bool useShadowBuffer, void* data,
+		const DataStreamPtr& dataOwner)
+	{
+		if (dataOwner.isNull() || (reinterpret_cast<size_t>(data) & 15) != 0)
+		{
+			return HardwareBufferManagerBase::createVertexBufferFromData(
+				vertexSize, numVerts, usage, useShadowBuffer, data, dataOwner);
+		}
+        DefaultHardwareVertexBuffer* vb = OGRE_NEW DefaultHardwareVertexBuffer(
+			vertexSize, numVerts, usage, data, dataOwner);
+        return HardwareVertexBufferSharedPtr(vb);
+	}
+    //-----------------------------------------------------------------------
+	HardwareIndexBufferSharedPtr 
+        DefaultHardwareBufferManagerBase::createIndexBufferFromData(HardwareIndexBuffer::IndexType itype, 
+		size_t numIndexes, HardwareBuffer::Usage usage, bool useShadowBuffer, void* data,
+		const DataStreamPtr& dataOwner)
+	{
+		if (dataOwner.isNull() || (reinterpret_cast<size_t>(data) & 15) != 0)
+		{
+			return HardwareBufferManagerBase::createIndexBufferFromData(
+				itype, numIndexes, usage, useShadowBuffer, data, dataOwner);
+		}
+        DefaultHardwareIndexBuffer* ib = OGRE_NEW DefaultHardwareIndexBuffer(
+			itype, numIndexes, usage, data, dataOwner);
+		return HardwareIndexBufferSharedPtr(ib);
+	}
+	//-----------------------------------------------------------------------
 	RenderToVertexBufferSharedPtr
 		DefaultHardwareBufferManagerBase::createRenderToVertexBuffer()
 	{
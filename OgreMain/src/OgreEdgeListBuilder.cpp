@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "OgreVertexIndexData.h"
 #include "OgreException.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "OgreAtomicWrappers.h"
 
 namespace Ogre {
 
@@ -75,8 +77,149 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    namespace
+    {
+        const size_t NO_INDEX = ~(size_t)0;
+
+        /** Hash table of exact positions, holding the index of the first
+            vertex found at each. */
+        class PositionTable
+        {
+        public:
+            PositionTable(size_t expected)
+                : mCount(0)
+            {
+                size_t capacity = 16;
+                while (capacity < expected * 2)
+                    capacity <<= 1;
+                mSlots.resize(capacity);
+            }
+
+            /** Returns the index stored for the position, storing the given
+                index if there's none yet. */
+            size_t findOrInsert(const Vector3& position, size_t index)
+            {
+                if ((mCount + 1) * 2 > mSlots.size())
+                    grow();
+
+                Slot key;
+                key.bits[0] = positionBits(position.x);
+                key.bits[1] = positionBits(position.y);
+                key.bits[2] = positionBits(position.z);
+                key.index = static_cast<uint32>(index);
+                Slot* slot = find(key);
+                if (slot->index == EMPTY)
+                {
+                    *slot = key;
+                    ++mCount;
+                }
+                return slot->index;
+            }
+
+        protected:
+            static const uint32 EMPTY = 0xFFFFFFFF;
+            struct Slot
+            {
+                uint32 bits[3];
+                uint32 index;
+                Slot() : index(EMPTY) {}
+            };
+            typedef vector<Slot>::type SlotList;
+            SlotList mSlots;
+            size_t mCount;
+
+            static uint32 positionBits(Real value)
+            {
+                // The same test as comparing positions, so 0 and -0 are one
+                union { float f; uint32 u; } bits;
+                bits.f = value == 0 ? 0.0f : static_cast<float>(value);
+                return bits.u;
+            }
+
+            /// Find the slot holding the key's position, or where it should go
+            Slot* find(const Slot& key)
+            {
+                size_t mask = mSlots.size() - 1;
+                uint32 hash = key.bits[0] * 0x8da6b343 ^ key.bits[1] * 0xd8163841 ^ key.bits[2] * 0xcb1ab31f;
+                for (size_t s = (hash ^ (hash >> 15)) & mask; ; s = (s + 1) & mask)
+                {
+                    Slot& slot = mSlots[s];
+                    if (slot.index == EMPTY || (slot.bits[0] == key.bits[0] &&
+                        slot.bits[1] == key.bits[1] && slot.bits[2] == key.bits[2]))
+                    {
+                        return &slot;
+                    }
+                }
+            }
+
+            void grow(void)
+            {
+                SlotList old(mSlots.size() * 2);
+                old.swap(mSlots);
+                for (SlotList::iterator i = old.begin(); i != old.end(); ++i)
+                {
+                    if (i->index != EMPTY)
+                        *find(*i) = *i;
+                }
+            }
+        };
+
+        /// An edge which has only found the triangle on one side so far
+        struct OpenEdge
+        {
+            /// Shared index of the vertex the edge runs to
+            size_t endVertex;
+            /// Where the edge is held
+            size_t vertexSet;
+            size_t edge;
+            /// The next open edge from the same vertex, in order of creation
+            size_t next;
+        };
+        typedef vector<OpenEdge>::type OpenEdgeList;
+
+        typedef map<HardwareBuffer*, void*>::type LockedBufferMap;
+
+        /// Lock a buffer for reading, unless it has been already
+        void* lockOnce(LockedBufferMap& locked, HardwareBuffer* buffer)
+        {
+            LockedBufferMap::iterator i = locked.find(buffer);
+            if (i == locked.end())
+            {
+                i = locked.insert(LockedBufferMap::value_type(
+                    buffer, buffer->lock(HardwareBuffer::HBL_READ_ONLY))).first;
+            }
+            return i->second;
+        }
+
+        void unlockAll(LockedBufferMap& locked)
+        {
+            for (LockedBufferMap::iterator i = locked.begin(); i != locked.end(); ++i)
+                i->first->unlock();
+            locked.clear();
+        }
+    }
+    //---------------------------------------------------------------------
+    /// Builds vertex sets from a ParallelTaskDispatcher
+    class EdgeListBuilder::VertexSetTasks : public ParallelTaskDispatcher::TaskSet
+    {
+    public:
+        VertexSetTasks(const EdgeListBuilder* builder, VertexSetList& vertexSets)
+            : mBuilder(builder), mVertexSets(vertexSets) {}
+
+        void processTasks(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                mBuilder->buildVertexSet(i, mVertexSets[i]);
+        }
+
+    protected:
+        const EdgeListBuilder* mBuilder;
+        VertexSetList& mVertexSets;
+    };
+    //---------------------------------------------------------------------
     EdgeListBuilder::EdgeListBuilder()
         : mEdgeData(0)
+        , mDispatcher(0)
     {
     }
     //---------------------------------------------------------------------
@@ -113,28 +256,37 @@ namespace Ogre {
         geometry.vertexSet = vertexSet;
         geometry.opType = opType;
         geometry.indexSet = mGeometryList.size();
+        geometry.lockedIndexes = 0;
         mGeometryList.push_back(geometry);
     }
     //---------------------------------------------------------------------
     EdgeData* EdgeListBuilder::build(void)
     {
         /* Ok, here's the algorithm:
-        For each set of indices in turn
-          For each set of 3 indexes
-            Create a new Triangle entry in the list
-            For each vertex referenced by the tri indexes
-              Get the position of the vertex as a Vector3 from the correct vertex buffer
-              Attempt to locate this position in the existing common vertex set
-              If not found
-                Create a new common vertex entry in the list
-              End If
-              Populate the original vertex index and common vertex index 
-            Next vertex
-            Connect to existing edge(v1, v0) or create a new edge(v0, v1)
-            Connect to existing edge(v2, v1) or create a new edge(v1, v2)
-            Connect to existing edge(v0, v2) or create a new edge(v2, v0)
-          Next set of 3 indexes
-        Next index set
+        For each vertex set (in parallel if there's a dispatcher)
+          For each set of indices referring to the vertex set in turn
+            For each set of 3 indexes
+              Create a new Triangle entry in the list
+              For each vertex referenced by the tri indexes
+                Get the position of the vertex as a Vector3 from the correct vertex buffer
+                Attempt to locate this position in the vertex set's distinct positions
+                If not found
+                  Create a new common vertex entry in the vertex set's list
+                End If
+                Populate the original vertex index and common vertex index 
+              Next vertex
+            Next set of 3 indexes
+          Next index set
+        Next vertex set
+        For each vertex set in turn
+          Join its common vertices with those of the previous sets, by position
+          Append its triangles
+        Next vertex set
+        For each triangle
+          Connect to existing edge(v1, v0) or create a new edge(v0, v1)
+          Connect to existing edge(v2, v1) or create a new edge(v1, v2)
+          Connect to existing edge(v0, v2) or create a new edge(v2, v0)
+        Next triangle
 
         Note that all edges 'belong' to the index set which originally caused them
         to be created, which also means that the 2 vertices on the edge are both referencing the 
@@ -175,272 +327,418 @@ namespace Ogre {
         std::sort(mGeometryList.begin(), mGeometryList.end(), geometryLess());
         // Initialize edge data
         mEdgeData = OGRE_NEW EdgeData();
+        mVertices.clear();
         // resize the edge group list to equal the number of vertex sets
         mEdgeData->edgeGroups.resize(mVertexDataList.size());
         // Initialise edge group data
+        VertexSetList vertexSets(mVertexDataList.size());
         for (unsigned short vSet = 0; vSet < mVertexDataList.size(); ++vSet)
         {
             mEdgeData->edgeGroups[vSet].vertexSet = vSet;
             mEdgeData->edgeGroups[vSet].vertexData = mVertexDataList[vSet];
             mEdgeData->edgeGroups[vSet].triStart = 0;
             mEdgeData->edgeGroups[vSet].triCount = 0;
+            vertexSets[vSet].geometryStart = vertexSets[vSet].geometryEnd = 0;
+            vertexSets[vSet].positions = 0;
+            vertexSets[vSet].vertexSize = 0;
+            vertexSets[vSet].vertexCount = 0;
+        }
+
+        // Lock the buffers here, since other threads may not be able to;
+        // several geometries could share an index buffer
+        LockedBufferMap lockedBuffers;
+        try
+        {
+            for (size_t g = 0; g < mGeometryList.size(); ++g)
+            {
+                Geometry& geometry = mGeometryList[g];
+                geometry.lockedIndexes = 0;
+                VertexSet& vertexSet = vertexSets[geometry.vertexSet];
+                if (!vertexSet.geometryEnd)
+                {
+                    // locate position element & the buffer to go with it
+                    const VertexData* vertexData = mVertexDataList[geometry.vertexSet];
+                    const VertexElement* posElem =
+                        vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+                    HardwareVertexBufferSharedPtr vbuf =
+                        vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+                    vertexSet.geometryStart = g;
+                    vertexSet.positions = static_cast<const unsigned char*>(
+                        lockOnce(lockedBuffers, vbuf.get())) + posElem->getOffset();
+                    vertexSet.vertexSize = vbuf->getVertexSize();
+                    vertexSet.vertexCount = vbuf->getNumVertices();
+                }
+                vertexSet.geometryEnd = g + 1;
+
+                const IndexData* indexData = geometry.indexData;
+                if (!indexData->indexCount)
+                    continue;
+                geometry.lockedIndexes = static_cast<const char*>(
+                    lockOnce(lockedBuffers, indexData->indexBuffer.get())) +
+                    indexData->indexStart * indexData->indexBuffer->getIndexSize();
+            }
+
+            VertexSetTasks tasks(this, vertexSets);
+            if (mDispatcher && vertexSets.size() > 1)
+                mDispatcher->dispatch(&tasks, vertexSets.size());
+            else
+                tasks.processTasks(0, vertexSets.size());
         }
+        catch (...)
+        {
+            unlockAll(lockedBuffers);
+            OGRE_DELETE mEdgeData;
+            mEdgeData = 0;
+            throw;
+        }
+        unlockAll(lockedBuffers);
 
-        // Build triangles and edge list
-        GeometryList::const_iterator i, iend;
-        iend = mGeometryList.end();
-        for (i = mGeometryList.begin(); i != iend; ++i)
+        // Join the vertex sets in order, so the common vertices and triangles
+        // are numbered as if they had been read one after another
+        size_t vertexCount = 0, triangleCount = 0;
+        for (VertexSetList::const_iterator i = vertexSets.begin(); i != vertexSets.end(); ++i)
         {
-            buildTrianglesEdges(*i);
+            vertexCount += i->vertices.size();
+            triangleCount += i->triangles.size();
         }
+        PositionTable commonVertices(vertexCount);
+        mEdgeData->triangles.reserve(triangleCount);
+        mEdgeData->triangleFaceNormals.reserve(triangleCount);
+        vector<size_t>::type commonIndexes;
+        for (size_t vSet = 0; vSet < vertexSets.size(); ++vSet)
+        {
+            VertexSet& vertexSet = vertexSets[vSet];
+            if (!vertexSet.geometryEnd)
+                continue;
+
+            // Vertices at the position of a vertex of an earlier set are welded to it
+            commonIndexes.resize(vertexSet.vertices.size());
+            for (size_t v = 0; v < vertexSet.vertices.size(); ++v)
+            {
+                commonIndexes[v] = commonVertices.findOrInsert(vertexSet.vertices[v].position, mVertices.size());
+                if (commonIndexes[v] == mVertices.size())
+                {
+                    mVertices.push_back(vertexSet.vertices[v]);
+                    mVertices.back().index = commonIndexes[v];
+                }
+            }
+
+            EdgeData::EdgeGroup& eg = mEdgeData->edgeGroups[vSet];
+            eg.triStart = mEdgeData->triangles.size();
+            eg.triCount = vertexSet.triangles.size();
+            for (EdgeData::TriangleList::iterator t = vertexSet.triangles.begin(); t != vertexSet.triangles.end(); ++t)
+            {
+                t->sharedVertIndex[0] = commonIndexes[t->sharedVertIndex[0]];
+                t->sharedVertIndex[1] = commonIndexes[t->sharedVertIndex[1]];
+                t->sharedVertIndex[2] = commonIndexes[t->sharedVertIndex[2]];
+            }
+            mEdgeData->triangles.insert(mEdgeData->triangles.end(),
+                vertexSet.triangles.begin(), vertexSet.triangles.end());
+            mEdgeData->triangleFaceNormals.insert(mEdgeData->triangleFaceNormals.end(),
+                vertexSet.triangleFaceNormals.begin(), vertexSet.triangleFaceNormals.end());
+
+            // Free as we go
+            EdgeData::TriangleList().swap(vertexSet.triangles);
+            EdgeData::TriangleFaceNormalList().swap(vertexSet.triangleFaceNormals);
+        }
+
+        connectEdges();
 
         // Allocate memory for light facing calculate
         mEdgeData->triangleLightFacings.resize(mEdgeData->triangles.size());
-
-        // Record closed, ie the mesh is manifold
-        mEdgeData->isClosed = mEdgeMap.empty();
+        mEdgeData->triangleLightFacingMask.resize((mEdgeData->triangles.size() + 31) / 32);
 
         return mEdgeData;
     }
     //---------------------------------------------------------------------
-    void EdgeListBuilder::buildTrianglesEdges(const Geometry &geometry)
+    void EdgeListBuilder::buildVertexSet(size_t vertexSetIndex, VertexSet& vertexSet) const
     {
-        size_t indexSet = geometry.indexSet;
-        size_t vertexSet = geometry.vertexSet;
-        const IndexData* indexData = geometry.indexData;
-        RenderOperation::OperationType opType = geometry.opType;
+        if (!vertexSet.geometryEnd)
+            return;
 
-        size_t iterations;
-        
-        switch (opType)
-        {
-        case RenderOperation::OT_TRIANGLE_LIST:
-            iterations = indexData->indexCount / 3;
-            break;
-        case RenderOperation::OT_TRIANGLE_FAN:
-        case RenderOperation::OT_TRIANGLE_STRIP:
-            iterations = indexData->indexCount - 2;
-            break;
-        default:
-            return; // Just in case
-        };
+        // Common vertex of each original vertex, so that each is only looked up once
+        const size_t vertexCount = vertexSet.vertexCount;
+        vector<size_t>::type commonIndexes(vertexCount, NO_INDEX);
+        PositionTable positions(vertexCount);
+        vertexSet.vertices.reserve(vertexCount);
 
-        // The edge group now we are dealing with.
-        EdgeData::EdgeGroup& eg = mEdgeData->edgeGroups[vertexSet];
-
-		// locate position element & the buffer to go with it
-        const VertexData* vertexData = mVertexDataList[vertexSet];
-		const VertexElement* posElem = vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
-		HardwareVertexBufferSharedPtr vbuf = 
-			vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
-		// lock the buffer for reading
-		unsigned char* pBaseVertex = static_cast<unsigned char*>(
-			vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
-
-        // Get the indexes ready for reading
-		bool idx32bit = (indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
-		size_t indexSize = idx32bit ? sizeof(uint32) : sizeof(uint16);
-#if defined(_MSC_VER) && _MSC_VER <= 1300
-        // NB: Can't use un-named union with VS.NET 2002 when /RTC1 compile flag enabled.
-        void* pIndex = indexData->indexBuffer->lock(HardwareBuffer::HBL_READ_ONLY);
-		pIndex = static_cast<void*>(
-			static_cast<char*>(pIndex) + indexData->indexStart * indexSize);
-        unsigned short* p16Idx = static_cast<unsigned short*>(pIndex);
-        unsigned int* p32Idx = static_cast<unsigned int*>(pIndex);
-#else
-        union {
-            void* pIndex;
-            unsigned short* p16Idx;
-            unsigned int* p32Idx;
-        };
-        pIndex = indexData->indexBuffer->lock(HardwareBuffer::HBL_READ_ONLY);
-		pIndex = static_cast<void*>(
-			static_cast<char*>(pIndex) + indexData->indexStart * indexSize);
-#endif
-
-        // Iterate over all the groups of 3 indexes
-        unsigned int index[3];
-        // Get the triangle start, if we have more than one index set then this
-        // will not be zero
-        size_t triangleIndex = mEdgeData->triangles.size();
-        // If it's first time dealing with the edge group, setup triStart for it.
-        // Note that we are assume geometries sorted by vertex set.
-        if (!eg.triCount)
-        {
-            eg.triStart = triangleIndex;
-        }
-        // Pre-reserve memory for less thrashing
-        mEdgeData->triangles.reserve(triangleIndex + iterations);
-        mEdgeData->triangleFaceNormals.reserve(triangleIndex + iterations);
-        for (size_t t = 0; t < iterations; ++t)
+        for (size_t g = vertexSet.geometryStart; g < vertexSet.geometryEnd; ++g)
         {
-            EdgeData::Triangle tri;
-            tri.indexSet = indexSet;
-            tri.vertexSet = vertexSet;
-
-            if (opType == RenderOperation::OT_TRIANGLE_LIST || t == 0)
+            const Geometry& geometry = mGeometryList[g];
+            const IndexData* indexData = geometry.indexData;
+            RenderOperation::OperationType opType = geometry.opType;
+            if (indexData->indexCount < 3)
+                continue;
+
+            size_t iterations;
+            switch (opType)
             {
-                // Standard 3-index read for tri list or first tri in strip / fan
-                if (idx32bit)
+            case RenderOperation::OT_TRIANGLE_LIST:
+                iterations = indexData->indexCount / 3;
+                break;
+            case RenderOperation::OT_TRIANGLE_FAN:
+            case RenderOperation::OT_TRIANGLE_STRIP:
+                iterations = indexData->indexCount - 2;
+                break;
+            default:
+                continue; // Just in case
+            };
+
+            bool idx32bit = (indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT);
+            const uint16* p16Idx = static_cast<const uint16*>(geometry.lockedIndexes);
+            const uint32* p32Idx = static_cast<const uint32*>(geometry.lockedIndexes);
+
+            // Pre-reserve memory for less thrashing
+            vertexSet.triangles.reserve(vertexSet.triangles.size() + iterations);
+            vertexSet.triangleFaceNormals.reserve(vertexSet.triangleFaceNormals.size() + iterations);
+
+            // Iterate over all the groups of 3 indexes
+            unsigned int index[3];
+            for (size_t t = 0; t < iterations; ++t)
+            {
+                EdgeData::Triangle tri;
+                tri.indexSet = geometry.indexSet;
+                tri.vertexSet = vertexSetIndex;
+
+                if (opType == RenderOperation::OT_TRIANGLE_LIST || t == 0)
                 {
-                    index[0] = p32Idx[0];
-                    index[1] = p32Idx[1];
-                    index[2] = p32Idx[2];
-                    p32Idx += 3;
+                    // Standard 3-index read for tri list or first tri in strip / fan
+                    if (idx32bit)
+                    {
+                        index[0] = p32Idx[0];
+                        index[1] = p32Idx[1];
+                        index[2] = p32Idx[2];
+                        p32Idx += 3;
+                    }
+                    else
+                    {
+                        index[0] = p16Idx[0];
+                        index[1] = p16Idx[1];
+                        index[2] = p16Idx[2];
+                        p16Idx += 3;
+                    }
                 }
                 else
                 {
-                    index[0] = p16Idx[0];
-                    index[1] = p16Idx[1];
-                    index[2] = p16Idx[2];
-                    p16Idx += 3;
+                    // Strips are formed from last 2 indexes plus the current one for
+                    // triangles after the first.
+                    // For fans, all the triangles share the first vertex, plus last
+                    // one index and the current one for triangles after the first.
+                    // We also make sure that all the triangles are process in the
+                    // _anti_ clockwise orientation
+                    index[(opType == RenderOperation::OT_TRIANGLE_STRIP) && (t & 1) ? 0 : 1] = index[2];
+                    // Read for the last tri index
+                    if (idx32bit)
+                        index[2] = *p32Idx++;
+                    else
+                        index[2] = *p16Idx++;
                 }
-            }
-            else
-            {
-                // Strips are formed from last 2 indexes plus the current one for
-                // triangles after the first.
-                // For fans, all the triangles share the first vertex, plus last
-                // one index and the current one for triangles after the first.
-                // We also make sure that all the triangles are process in the
-                // _anti_ clockwise orientation
-                index[(opType == RenderOperation::OT_TRIANGLE_STRIP) && (t & 1) ? 0 : 1] = index[2];
-                // Read for the last tri index
-                if (idx32bit)
-                    index[2] = *p32Idx++;
-                else
-                    index[2] = *p16Idx++;
-            }
 
-            Vector3 v[3];
-            for (size_t i = 0; i < 3; ++i)
-            {
-                // Populate tri original vertex index
-                tri.vertIndex[i] = index[i];
-
-                // Retrieve the vertex position
-                unsigned char* pVertex = pBaseVertex + (index[i] * vbuf->getVertexSize());
-                float* pFloat;
-                posElem->baseVertexPointerToElement(pVertex, &pFloat);
-                v[i].x = *pFloat++;
-                v[i].y = *pFloat++;
-                v[i].z = *pFloat++;
-                // find this vertex in the existing vertex map, or create it
-                tri.sharedVertIndex[i] = 
-                    findOrCreateCommonVertex(v[i], vertexSet, indexSet, index[i]);
-            }
+                Vector3 v[3];
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    if (index[i] >= vertexCount)
+                    {
+                        OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                            "Index " + StringConverter::toString(index[i]) +
+                            " is beyond the end of vertex set " + StringConverter::toString(vertexSetIndex),
+                            "EdgeListBuilder::buildVertexSet");
+                    }
 
-            // Ignore degenerate triangle
-            if (tri.sharedVertIndex[0] != tri.sharedVertIndex[1] &&
-                tri.sharedVertIndex[1] != tri.sharedVertIndex[2] &&
-                tri.sharedVertIndex[2] != tri.sharedVertIndex[0])
-            {
-                // Calculate triangle normal (NB will require recalculation for 
-                // skeletally animated meshes)
-                mEdgeData->triangleFaceNormals.push_back(
-                    Math::calculateFaceNormalWithoutNormalize(v[0], v[1], v[2]));
-                // Add triangle to list
-                mEdgeData->triangles.push_back(tri);
-                // Connect or create edges from common list
-                connectOrCreateEdge(vertexSet, triangleIndex, 
-                    tri.vertIndex[0], tri.vertIndex[1], 
-                    tri.sharedVertIndex[0], tri.sharedVertIndex[1]);
-                connectOrCreateEdge(vertexSet, triangleIndex, 
-                    tri.vertIndex[1], tri.vertIndex[2], 
-                    tri.sharedVertIndex[1], tri.sharedVertIndex[2]);
-                connectOrCreateEdge(vertexSet, triangleIndex, 
-                    tri.vertIndex[2], tri.vertIndex[0], 
-                    tri.sharedVertIndex[2], tri.sharedVertIndex[0]);
-                ++triangleIndex;
-            }
-        }
+                    // Populate tri original vertex index
+                    tri.vertIndex[i] = index[i];
 
-        // Update triCount for the edge group. Note that we are assume
-        // geometries sorted by vertex set.
-        eg.triCount = triangleIndex - eg.triStart;
+                    // Retrieve the vertex position
+                    const float* pFloat = reinterpret_cast<const float*>(
+                        vertexSet.positions + index[i] * vertexSet.vertexSize);
+                    v[i].x = pFloat[0];
+                    v[i].y = pFloat[1];
+                    v[i].z = pFloat[2];
+
+                    // find this vertex in the existing vertex map, or create it
+                    size_t& common = commonIndexes[index[i]];
+                    if (common == NO_INDEX)
+                    {
+                        common = positions.findOrInsert(v[i], vertexSet.vertices.size());
+                        if (common == vertexSet.vertices.size())
+                        {
+                            CommonVertex newCommon;
+                            newCommon.index = common;
+                            newCommon.position = v[i];
+                            newCommon.vertexSet = vertexSetIndex;
+                            newCommon.indexSet = geometry.indexSet;
+                            newCommon.originalIndex = index[i];
+                            vertexSet.vertices.push_back(newCommon);
+                        }
+                    }
+                    tri.sharedVertIndex[i] = common;
+                }
 
-        indexData->indexBuffer->unlock();
-        vbuf->unlock();
+                // Ignore degenerate triangle
+                if (tri.sharedVertIndex[0] != tri.sharedVertIndex[1] &&
+                    tri.sharedVertIndex[1] != tri.sharedVertIndex[2] &&
+                    tri.sharedVertIndex[2] != tri.sharedVertIndex[0])
+                {
+                    // Calculate triangle normal (NB will require recalculation for 
+                    // skeletally animated meshes)
+                    vertexSet.triangleFaceNormals.push_back(
+                        Math::calculateFaceNormalWithoutNormalize(v[0], v[1], v[2]));
+                    // Add triangle to list
+                    vertexSet.triangles.push_back(tri);
+                }
+            }
+        }
     }
     //---------------------------------------------------------------------
-    void EdgeListBuilder::connectOrCreateEdge(size_t vertexSet, size_t triangleIndex, 
-        size_t vertIndex0, size_t vertIndex1, size_t sharedVertIndex0, 
-        size_t sharedVertIndex1)
+    void EdgeListBuilder::connectEdges(void)
     {
-        // Find the existing edge (should be reversed order) on shared vertices
-        EdgeMap::iterator emi = mEdgeMap.find(std::pair<size_t, size_t>(sharedVertIndex1, sharedVertIndex0));
-        if (emi != mEdgeMap.end())
+        // Edges with a triangle on one side only, listed by the vertex they
+        // start from. Note we allow many triangles on an edge; edges are
+        // connected in the order they were created, and once connected are
+        // never used again.
+        OpenEdgeList openEdges;
+        openEdges.reserve(mEdgeData->triangles.size() * 3 / 2);
+        vector<size_t>::type firstOpen(mVertices.size(), NO_INDEX), lastOpen(mVertices.size(), NO_INDEX);
+        size_t openCount = 0;
+
+        // Most edges are shared by two triangles of the group, plus some borders
+        for (EdgeData::EdgeGroupList::iterator i = mEdgeData->edgeGroups.begin(); i != mEdgeData->edgeGroups.end(); ++i)
+            i->edges.reserve(i->triCount * 3 / 2 + i->triCount / 8);
+
+        for (size_t t = 0; t < mEdgeData->triangles.size(); ++t)
         {
-            // The edge already exist, connect it
-            EdgeData::Edge& e = mEdgeData->edgeGroups[emi->second.first].edges[emi->second.second];
-            // update with second side
-            e.triIndex[1] = triangleIndex;
-            e.degenerate = false;
-
-            // Remove from the edge map, so we never supplied to connect edge again
-            mEdgeMap.erase(emi);
-        }
-        else
-        {
-            // Not found, create new edge
-            mEdgeMap.insert(EdgeMap::value_type(
-                std::pair<size_t, size_t>(sharedVertIndex0, sharedVertIndex1),
-                std::pair<size_t, size_t>(vertexSet, mEdgeData->edgeGroups[vertexSet].edges.size())));
-            EdgeData::Edge e;
-            e.degenerate = true; // initialise as degenerate
-
-            // Set only first tri, the other will be completed in connect existing edge
-            e.triIndex[0] = triangleIndex;
-            e.triIndex[1] = static_cast<size_t>(~0);
-            e.sharedVertIndex[0] = sharedVertIndex0;
-            e.sharedVertIndex[1] = sharedVertIndex1;
-            e.vertIndex[0] = vertIndex0;
-            e.vertIndex[1] = vertIndex1;
-            mEdgeData->edgeGroups[vertexSet].edges.push_back(e);
+            const EdgeData::Triangle& tri = mEdgeData->triangles[t];
+            for (size_t i = 0; i < 3; ++i)
+            {
+                size_t j = i == 2 ? 0 : i + 1;
+                size_t sharedVertIndex0 = tri.sharedVertIndex[i];
+                size_t sharedVertIndex1 = tri.sharedVertIndex[j];
+
+                // Find the existing edge (should be reversed order) on shared vertices
+                size_t previous = NO_INDEX;
+                size_t open = firstOpen[sharedVertIndex1];
+                while (open != NO_INDEX && openEdges[open].endVertex != sharedVertIndex0)
+                {
+                    previous = open;
+                    open = openEdges[open].next;
+                }
+
+                if (open != NO_INDEX)
+                {
+                    // The edge already exist, connect it
+                    const OpenEdge& oe = openEdges[open];
+                    EdgeData::Edge& e = mEdgeData->edgeGroups[oe.vertexSet].edges[oe.edge];
+                    // update with second side
+                    e.triIndex[1] = t;
+                    e.degenerate = false;
+
+                    // Remove from the open list, so we never supplied to connect edge again
+                    if (previous == NO_INDEX)
+                        firstOpen[sharedVertIndex1] = oe.next;
+                    else
+                        openEdges[previous].next = oe.next;
+                    if (lastOpen[sharedVertIndex1] == open)
+                        lastOpen[sharedVertIndex1] = previous;
+                    --openCount;
+                }
+                else
+                {
+                    // Not found, create new edge
+                    EdgeData::EdgeList& edges = mEdgeData->edgeGroups[tri.vertexSet].edges;
+                    OpenEdge oe;
+                    oe.endVertex = sharedVertIndex1;
+                    oe.vertexSet = tri.vertexSet;
+                    oe.edge = edges.size();
+                    oe.next = NO_INDEX;
+                    if (lastOpen[sharedVertIndex0] == NO_INDEX)
+                        firstOpen[sharedVertIndex0] = openEdges.size();
+                    else
+                        openEdges[lastOpen[sharedVertIndex0]].next = openEdges.size();
+                    lastOpen[sharedVertIndex0] = openEdges.size();
+                    openEdges.push_back(oe);
+                    ++openCount;
+
+                    EdgeData::Edge e;
+                    e.degenerate = true; // initialise as degenerate
+
+                    // Set only first tri, the other will be completed in connect existing edge
+                    e.triIndex[0] = t;
+                    e.triIndex[1] = static_cast<size_t>(~0);
+                    e.sharedVertIndex[0] = sharedVertIndex0;
+                    e.sharedVertIndex[1] = sharedVertIndex1;
+                    e.vertIndex[0] = tri.vertIndex[i];
+                    e.vertIndex[1] = tri.vertIndex[j];
+                    edges.push_back(e);
+                }
+            }
         }
+
+        // Record closed, ie the mesh is manifold
+        mEdgeData->isClosed = openCount == 0;
     }
     //---------------------------------------------------------------------
-    size_t EdgeListBuilder::findOrCreateCommonVertex(const Vector3& vec, 
-        size_t vertexSet, size_t indexSet, size_t originalIndex)
+    //---------------------------------------------------------------------
+    /// Source of EdgeData::generation; edge lists may be built in the background
+    static AtomicScalar<uint32> msNextEdgeDataGeneration(0);
+    //---------------------------------------------------------------------
+    EdgeData::EdgeData()
+        : isClosed(false)
+        , generation(++msNextEdgeDataGeneration)
     {
-        // Because the algorithm doesn't care about manifold or not, we just identifying
-        // the common vertex by EXACT same position.
-        // Hint: We can use quantize method for welding almost same position vertex fastest.
-        std::pair<CommonVertexMap::iterator, bool> inserted =
-            mCommonVertexMap.insert(CommonVertexMap::value_type(vec, mVertices.size()));
-        if (!inserted.second)
-        {
-            // Already existing, return old one
-            return inserted.first->second;
-        }
-        // Not found, insert
-        CommonVertex newCommon;
-        newCommon.index = mVertices.size();
-        newCommon.position = vec;
-        newCommon.vertexSet = vertexSet;
-        newCommon.indexSet = indexSet;
-        newCommon.originalIndex = originalIndex;
-        mVertices.push_back(newCommon);
-        return newCommon.index;
     }
     //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
     void EdgeData::updateTriangleLightFacing(const Vector4& lightPos)
     {
         // Triangle face normals should be 1:1 with light facing flags
         assert(triangleFaceNormals.size() == triangleLightFacings.size());
+        assert((triangleFaceNormals.size() + 31) / 32 == triangleLightFacingMask.size());
 
         // Use optimised util to determine if triangle's face normal are light facing
 		if(!triangleFaceNormals.empty())
 		{
-			OptimisedUtil::getImplementation()->calculateLightFacing(
+			OptimisedUtil::getImplementation()->calculateLightFacingMask(
 				lightPos,
 				&triangleFaceNormals.front(),
-				&triangleLightFacings.front(),
-				triangleLightFacings.size());
+				&triangleLightFacingMask.front(),
+				triangleFaceNormals.size());
+
+			// Keep the per triangle states up to date as well
+			for (size_t i = 0; i < triangleLightFacings.size(); ++i)
+				triangleLightFacings[i] = isTriangleLightFacing(i);
 		}
     }
     //---------------------------------------------------------------------
+    void EdgeData::updateSilhouetteEdges(void)
+    {
+        // Each group's silhouette starts where the previous one ended, and
+        // can have as many edges as the group, so room for every edge is
+        // always enough
+        size_t numEdges = 0;
+        EdgeGroupList::const_iterator egi, egiend = edgeGroups.end();
+        for (egi = edgeGroups.begin(); egi != egiend; ++egi)
+            numEdges += egi->edges.size();
+        if (silhouetteEdges.size() < numEdges * 2)
+            silhouetteEdges.resize(numEdges * 2);
+        silhouetteEdgeStarts.resize(edgeGroups.size() + 1);
+
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        size_t start = 0;
+        size_t group = 0;
+        for (egi = edgeGroups.begin(); egi != egiend; ++egi, ++group)
+        {
+            silhouetteEdgeStarts[group] = start;
+            if (!egi->edges.empty())
+            {
+                start += 2 * util->findSilhouetteEdges(
+                    &triangleLightFacingMask.front(),
+                    &egi->edges.front(),
+                    egi->edges.size(),
+                    &silhouetteEdges[start]);
+            }
+        }
+        silhouetteEdgeStarts[group] = start;
+    }
+    //---------------------------------------------------------------------
     void EdgeData::updateFaceNormals(size_t vertexSet, 
         const HardwareVertexBufferSharedPtr& positionBuffer)
     {
@@ -247,6 +247,7 @@ namespace Ogre {
 			OGRE_DELETE *si;
 		}
         mShadowRenderables.clear();
+        clearCachedShadowVolumes();
         
 		// Detach all child objects, do this manually to avoid needUpdate() call
 		// which can fail because of deleted items
@@ -1122,6 +1123,22 @@ namespace Ogre {
         return getSkeleton() &&
             (mAnimationState->hasEnabledAnimationState() || getSkeleton()->hasManualBones());
     }
+	//-----------------------------------------------------------------------
+	bool Entity::_isSkeletonUpdatePending(void) const
+	{
+		// Entities which are only dirty because bones were moved manually are
+		// left alone, since evaluating the skeleton clears that flag, which
+		// updateAnimation relies on
+		return mInitialised && hasSkeleton() && isInScene() && isVisible() &&
+			mChildObjectList.empty() &&
+			mFrameAnimationLastUpdated != mAnimationState->getDirtyFrameNumber() &&
+			*mFrameBonesLastUpdated != Root::getSingleton().getNextFrameNumber();
+	}
+	//-----------------------------------------------------------------------
+	void Entity::_updateSkeleton(void)
+	{
+		cacheBoneMatrices();
+	}
 	//-----------------------------------------------------------------------
 	VertexData* Entity::_getSkelAnimVertexData(void) const
 	{
@@ -1753,12 +1770,9 @@ namespace Ogre {
             esrPositionBuffer->suppressHardwareUpdate(false);
 
         }
-        // Calc triangle light facing
-        updateEdgeListLightFacing(edgeList, lightPos);
-
-        // Generate indexes and update renderables
-        generateShadowVolume(edgeList, *indexBuffer, light,
-            mShadowRenderables, flags);
+        // Calc triangle light facing, generate indexes and update renderables
+        updateShadowVolume(edgeList, *indexBuffer, light, lightPos,
+            mShadowRenderables, flags, !hasAnimation);
 
 
         return ShadowRenderableListIterator(mShadowRenderables.begin(), mShadowRenderables.end());
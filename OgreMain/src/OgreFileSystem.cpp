@@ -55,6 +55,7 @@ THE SOFTWARE.
 namespace Ogre {
 
 	bool FileSystemArchive::ms_IgnoreHidden = true;
+	bool FileSystemArchive::ms_UseMemoryMapping = false;
 
     //-----------------------------------------------------------------------
     FileSystemArchive::FileSystemArchive(const String& name, const String& archType )
@@ -219,6 +220,11 @@ namespace Ogre {
 		assert(ret == 0 && "Problem getting file size" );
         (void)ret;  // Silence warning
 
+		if (readOnly && ms_UseMemoryMapping)
+		{
+			return DataStreamPtr(OGRE_NEW MappedFileDataStream(filename, full_path));
+		}
+
 		// Always open in binary mode
 		// Also, always include reading
 		std::ios::openmode mode = std::ios::in | std::ios::binary;
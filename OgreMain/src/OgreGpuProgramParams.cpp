@@ -343,6 +343,7 @@ namespace Ogre
 		:mName(name)
 		, mFrameLastUpdated(Root::getSingleton().getNextFrameNumber())
 		, mVersion(0)
+		, mUpdateCount(0)
 	{
 
 	}
@@ -557,6 +558,7 @@ namespace Ogre
 	void GpuSharedParameters::_markDirty()
 	{
 		mFrameLastUpdated = Root::getSingleton().getNextFrameNumber();
+		++mUpdateCount;
 	}
 
 	//-----------------------------------------------------------------------------
@@ -598,6 +600,8 @@ namespace Ogre
 		}
 
 		mCopyDataVersion = mSharedParams->getVersion();
+		// force a copy of the values
+		mCopiedUpdateCount = mSharedParams->getUpdateCount() - 1;
 
 	}
 	//---------------------------------------------------------------------
@@ -607,13 +611,22 @@ namespace Ogre
 		if (mCopyDataVersion != mSharedParams->getVersion())
 			initCopyData();
 
+		// skip the copy if the values haven't changed since last time
+		if (mCopiedUpdateCount == mSharedParams->getUpdateCount())
+			return;
+		mCopiedUpdateCount = mSharedParams->getUpdateCount();
+		mParams->_markDirty(GPV_GLOBAL);
+
+		// read only access, so the shared set isn't marked as updated again
+		const GpuSharedParameters* sharedParams = mSharedParams.get();
+
 		for (CopyDataList::iterator i = mCopyDataList.begin(); i != mCopyDataList.end(); ++i)
 		{
 			CopyDataEntry& e = *i;
 
 			if (e.dstDefinition->isFloat())
 			{	
-				const float* pSrc = mSharedParams->getFloatPointer(e.srcDefinition->physicalIndex);
+				const float* pSrc = sharedParams->getFloatPointer(e.srcDefinition->physicalIndex);
 				float* pDst = mParams->getFloatPointer(e.dstDefinition->physicalIndex);
 
 				// Deal with matrix transposition here!!!
@@ -649,7 +662,7 @@ namespace Ogre
 			}
 			else
 			{
-				const int* pSrc = mSharedParams->getIntPointer(e.srcDefinition->physicalIndex);
+				const int* pSrc = sharedParams->getIntPointer(e.srcDefinition->physicalIndex);
 				int* pDst = mParams->getIntPointer(e.dstDefinition->physicalIndex);
 
 				if (e.dstDefinition->elementSize == e.srcDefinition->elementSize)
@@ -682,6 +695,8 @@ namespace Ogre
 	//-----------------------------------------------------------------------------
 	GpuProgramParameters::GpuProgramParameters() :
 		mCombinedVariability(GPV_GLOBAL)
+		, mDirtyVariability(GPV_ALL)
+		, mWriteVariability(GPV_ALL)
 		, mTransposeMatrices(false)
 		, mIgnoreMissingParams(false)
 		, mActivePassIterationIndex(std::numeric_limits<size_t>::max())	
@@ -708,6 +723,8 @@ namespace Ogre
 		copySharedParamSetUsage(oth.mSharedParamSets);
 
 		mCombinedVariability = oth.mCombinedVariability;
+		mDirtyVariability = GPV_ALL;
+		mWriteVariability = GPV_ALL;
 		mTransposeMatrices = oth.mTransposeMatrices;
 		mIgnoreMissingParams  = oth.mIgnoreMissingParams;
 		mActivePassIterationIndex = oth.mActivePassIterationIndex;
@@ -846,13 +863,7 @@ namespace Ogre
 		assert(!mFloatLogicalToPhysical.isNull() && "GpuProgram hasn't set up the logical -> physical map!");
 
 		size_t physicalIndex = _getFloatConstantPhysicalIndex(index, rawCount, GPV_GLOBAL);
-		assert(physicalIndex + rawCount <= mFloatConstants.size());
-		// Copy manually since cast required
-		for (size_t i = 0; i < rawCount; ++i)
-		{
-			mFloatConstants[physicalIndex + i] = 
-				static_cast<float>(val[i]);
-		}
+		_writeRawConstants(physicalIndex, val, rawCount);
 
 	}
 	//-----------------------------------------------------------------------------
@@ -937,22 +948,37 @@ namespace Ogre
 	void GpuProgramParameters::_writeRawConstants(size_t physicalIndex, const double* val, size_t count)
 	{
 		assert(physicalIndex + count <= mFloatConstants.size());
+		float* pDest = &mFloatConstants[physicalIndex];
 		for (size_t i = 0; i < count; ++i)
 		{
-			mFloatConstants[physicalIndex+i] = static_cast<float>(val[i]);
+			float f = static_cast<float>(val[i]);
+			if (pDest[i] != f)
+			{
+				pDest[i] = f;
+				mDirtyVariability |= mWriteVariability;
+			}
 		}
 	}
 	//-----------------------------------------------------------------------------
 	void GpuProgramParameters::_writeRawConstants(size_t physicalIndex, const float* val, size_t count)
 	{
 		assert(physicalIndex + count <= mFloatConstants.size());
-		memcpy(&mFloatConstants[physicalIndex], val, sizeof(float) * count);
+		// Only copy (and dirty the values) if something actually changed
+		if (memcmp(&mFloatConstants[physicalIndex], val, sizeof(float) * count) != 0)
+		{
+			memcpy(&mFloatConstants[physicalIndex], val, sizeof(float) * count);
+			mDirtyVariability |= mWriteVariability;
+		}
 	}
 	//-----------------------------------------------------------------------------
 	void GpuProgramParameters::_writeRawConstants(size_t physicalIndex, const int* val, size_t count)
 	{
 		assert(physicalIndex + count <= mIntConstants.size());
-		memcpy(&mIntConstants[physicalIndex], val, sizeof(int) * count);
+		if (memcmp(&mIntConstants[physicalIndex], val, sizeof(int) * count) != 0)
+		{
+			memcpy(&mIntConstants[physicalIndex], val, sizeof(int) * count);
+			mDirtyVariability |= mWriteVariability;
+		}
 	}
 	//-----------------------------------------------------------------------------
 	void GpuProgramParameters::_readRawConstants(size_t physicalIndex, size_t count, float* dest)
@@ -1622,6 +1648,8 @@ namespace Ogre
 			// Only update needed slots
 			if (i->variability & mask)
 			{
+				// Values which change will dirty this auto's variability only
+				mWriteVariability = i->variability;
 
 				switch(i->paramType)
 				{
@@ -2169,6 +2197,73 @@ namespace Ogre
 			}
 		}
 
+		mWriteVariability = GPV_ALL;
+
+	}
+	//-----------------------------------------------------------------------------
+	size_t GpuProgramParameters::calculateLogicalConstantElements(
+		const GpuLogicalIndexUseMap& logicalMap, uint16 variabilityMask)
+	{
+		size_t elems = 0;
+		size_t lastStart = 0;
+		size_t lastEnd = 0;
+		for (GpuLogicalIndexUseMap::const_iterator i = logicalMap.begin(); i != logicalMap.end(); ++i)
+		{
+			const GpuLogicalIndexUse& use = i->second;
+			// Constants spanning several registers have an entry per register
+			// (following the first), all of which point into the same storage
+			if (use.physicalIndex >= lastStart && use.physicalIndex < lastEnd)
+				continue;
+			lastStart = use.physicalIndex;
+			lastEnd = use.physicalIndex + use.currentSize;
+
+			if (use.variability & variabilityMask)
+				elems += use.currentSize;
+		}
+		return elems;
+	}
+	//-----------------------------------------------------------------------------
+	size_t GpuProgramParameters::calculateConstantBytes(uint16 variabilityMask) const
+	{
+		size_t bytes = 0;
+		bool logicalFloats = !mFloatLogicalToPhysical.isNull() && !mFloatLogicalToPhysical->map.empty();
+		bool logicalInts = !mIntLogicalToPhysical.isNull() && !mIntLogicalToPhysical->map.empty();
+		if (logicalFloats || logicalInts)
+		{
+			// Low-level style, render systems upload the logical entries
+			if (logicalFloats)
+			{
+				OGRE_LOCK_MUTEX(mFloatLogicalToPhysical->mutex)
+				bytes += calculateLogicalConstantElements(
+					mFloatLogicalToPhysical->map, variabilityMask) * sizeof(float);
+			}
+			if (logicalInts)
+			{
+				OGRE_LOCK_MUTEX(mIntLogicalToPhysical->mutex)
+				bytes += calculateLogicalConstantElements(
+					mIntLogicalToPhysical->map, variabilityMask) * sizeof(int);
+			}
+		}
+		else if (!mNamedConstants.isNull())
+		{
+			for (GpuConstantDefinitionMap::const_iterator i = mNamedConstants->map.begin();
+				i != mNamedConstants->map.end(); ++i)
+			{
+				// Skip the individual array element entries, they alias the main entry
+				const String& name = i->first;
+				if (!name.empty() && name[name.size() - 1] == ']')
+					continue;
+
+				const GpuConstantDefinition& def = i->second;
+				if (def.variability & variabilityMask)
+				{
+					bytes += def.elementSize * def.arraySize * 
+						(def.isFloat() ? sizeof(float) : sizeof(int));
+				}
+			}
+		}
+
+		return bytes;
 	}
 	//---------------------------------------------------------------------------
 	void GpuProgramParameters::setNamedConstant(const String& name, Real val)
@@ -2426,6 +2521,7 @@ namespace Ogre
 		mAutoConstants = source.getAutoConstantList();
 		mCombinedVariability = source.mCombinedVariability;
 		copySharedParamSetUsage(source.mSharedParamSets);
+		_markDirty();
 	}
 	//---------------------------------------------------------------------
 	void GpuProgramParameters::copyMatchingNamedConstantsFrom(const GpuProgramParameters& source)
@@ -2548,6 +2644,7 @@ namespace Ogre
 		{
 			// This is a physical index
 			++mFloatConstants[mActivePassIterationIndex];
+			mDirtyVariability |= GPV_PASS_ITERATION_NUMBER;
 		}
 	}
 	//---------------------------------------------------------------------
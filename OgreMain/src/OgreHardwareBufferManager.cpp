@@ -79,6 +79,26 @@ namespace Ogre {
 
         // No need to destroy temp buffers - they will be destroyed automatically.
     }
+    //-----------------------------------------------------------------------
+	HardwareVertexBufferSharedPtr HardwareBufferManagerBase::createVertexBufferFromData(
+		size_t vertexSize, size_t numVerts, HardwareBuffer::Usage usage, 
+		bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner)
+	{
+		HardwareVertexBufferSharedPtr vbuf = 
+			createVertexBuffer(vertexSize, numVerts, usage, useShadowBuffer);
+		vbuf->writeData(0, vbuf->getSizeInBytes(), data, true);
+		return vbuf;
+	}
+    //-----------------------------------------------------------------------
+	HardwareIndexBufferSharedPtr HardwareBufferManagerBase::createIndexBufferFromData(
+		HardwareIndexBuffer::IndexType itype, size_t numIndexes, HardwareBuffer::Usage usage, 
+		bool useShadowBuffer, void* data, const DataStreamPtr& dataOwner)
+	{
+		HardwareIndexBufferSharedPtr ibuf = 
+			createIndexBuffer(itype, numIndexes, usage, useShadowBuffer);
+		ibuf->writeData(0, ibuf->getSizeInBytes(), data, true);
+		return ibuf;
+	}
     //-----------------------------------------------------------------------
     VertexDeclaration* HardwareBufferManagerBase::createVertexDeclaration(void)
     {
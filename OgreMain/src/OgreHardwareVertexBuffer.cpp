@@ -44,7 +44,9 @@ namespace Ogre {
         : HardwareBuffer(usage, useSystemMemory, useShadowBuffer), 
 		  mMgr(mgr),
           mNumVertices(numVertices),
-          mVertexSize(vertexSize)
+          mVertexSize(vertexSize),
+		  mIsInstanceData(false),
+		  mInstanceDataStepRate(1)
     {
         // Calculate the size of the vertices
         mSizeInBytes = mVertexSize * numVertices;
@@ -0,0 +1,539 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreInstanceManager.h"
+#include "OgreMeshManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreSubMesh.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreCamera.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderQueue.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreStringConverter.h"
+#include "OgreException.h"
+
+namespace Ogre {
+
+	//--------------------------------------------------------------------------
+	InstanceManager::InstanceManager(const String& name, SceneManager* owner,
+		const String& meshName, const String& groupName, size_t instancesPerBatch,
+		unsigned short subMeshIdx)
+		: mName(name), mOwner(owner), mSubMeshIdx(subMeshIdx),
+		mInstancesPerBatch(instancesPerBatch), mNumInstances(0), mBatchCount(0)
+	{
+		RenderSystem* renderSystem = Root::getSingleton().getRenderSystem();
+		if (renderSystem && renderSystem->getCapabilities() &&
+			!renderSystem->getCapabilities()->hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA))
+		{
+			OGRE_EXCEPT(Exception::ERR_RENDERINGAPI_ERROR,
+				"The render system doesn't support vertex buffer instance data",
+				"InstanceManager::InstanceManager");
+		}
+		if (!instancesPerBatch)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Batches must have room for at least one instance",
+				"InstanceManager::InstanceManager");
+		}
+
+		mMesh = MeshManager::getSingleton().load(meshName, groupName);
+		if (subMeshIdx >= mMesh->getNumSubMeshes())
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Mesh '" + meshName + "' doesn't have submesh " +
+				StringConverter::toString(subMeshIdx),
+				"InstanceManager::InstanceManager");
+		}
+		SubMesh* subMesh = getSubMesh();
+		if (subMesh->operationType != RenderOperation::OT_TRIANGLE_LIST ||
+			!subMesh->indexData->indexCount)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Only indexed triangle lists can be instanced",
+				"InstanceManager::InstanceManager");
+		}
+	}
+	//--------------------------------------------------------------------------
+	InstanceManager::~InstanceManager()
+	{
+		destroyAllInstancedEntities();
+	}
+	//--------------------------------------------------------------------------
+	SubMesh* InstanceManager::getSubMesh(void) const
+	{
+		return mMesh->getSubMesh(mSubMeshIdx);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::setInstancesPerBatch(size_t instancesPerBatch)
+	{
+		if (!instancesPerBatch)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Batches must have room for at least one instance",
+				"InstanceManager::setInstancesPerBatch");
+		}
+		mInstancesPerBatch = instancesPerBatch;
+	}
+	//--------------------------------------------------------------------------
+	unsigned short InstanceManager::getInstanceTexCoordIndex(void) const
+	{
+		SubMesh* subMesh = getSubMesh();
+		const VertexData* vertexData = subMesh->useSharedVertices ?
+			mMesh->sharedVertexData : subMesh->vertexData;
+
+		// The first set after all the ones the mesh uses
+		unsigned short index = 0;
+		const VertexDeclaration::VertexElementList& elems =
+			vertexData->vertexDeclaration->getElements();
+		for (VertexDeclaration::VertexElementList::const_iterator i = elems.begin();
+			i != elems.end(); ++i)
+		{
+			if (i->getSemantic() == VES_TEXTURE_COORDINATES)
+				index = std::max(index, static_cast<unsigned short>(i->getIndex() + 1));
+		}
+		return index;
+	}
+	//--------------------------------------------------------------------------
+	InstanceManager::InstancedEntity* InstanceManager::createInstancedEntity(
+		const String& materialName)
+	{
+		InstanceBatchList& batches = mInstanceBatches[materialName];
+
+		InstanceBatch* batch = 0;
+		for (InstanceBatchList::iterator i = batches.begin(); i != batches.end(); ++i)
+		{
+			if (!(*i)->isFull())
+			{
+				batch = *i;
+				break;
+			}
+		}
+
+		if (!batch)
+		{
+			MaterialPtr material = MaterialManager::getSingleton().getByName(materialName);
+			if (material.isNull())
+			{
+				OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND,
+					"Material '" + materialName + "' not found",
+					"InstanceManager::createInstancedEntity");
+			}
+			batch = OGRE_NEW InstanceBatch(this,
+				mName + "/" + StringConverter::toString(mBatchCount++),
+				material, mInstancesPerBatch);
+			batches.push_back(batch);
+		}
+
+		++mNumInstances;
+		return batch->_createInstance();
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::destroyInstancedEntity(InstancedEntity* instance)
+	{
+		assert(instance->getBatch()->getInstanceManager() == this);
+		instance->getBatch()->_destroyInstance(instance);
+		--mNumInstances;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::destroyAllInstancedEntities(void)
+	{
+		for (InstanceBatchMap::iterator i = mInstanceBatches.begin();
+			i != mInstanceBatches.end(); ++i)
+		{
+			for (InstanceBatchList::iterator b = i->second.begin(); b != i->second.end(); ++b)
+			{
+				OGRE_DELETE *b;
+			}
+		}
+		mInstanceBatches.clear();
+		mNumInstances = 0;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::cleanupEmptyBatches(void)
+	{
+		InstanceBatchMap::iterator i = mInstanceBatches.begin();
+		while (i != mInstanceBatches.end())
+		{
+			InstanceBatchList& batches = i->second;
+			InstanceBatchList::iterator b = batches.begin();
+			while (b != batches.end())
+			{
+				if ((*b)->getNumInstances() == 0)
+				{
+					OGRE_DELETE *b;
+					b = batches.erase(b);
+				}
+				else
+				{
+					++b;
+				}
+			}
+
+			if (batches.empty())
+				mInstanceBatches.erase(i++);
+			else
+				++i;
+		}
+	}
+	//--------------------------------------------------------------------------
+	//--------------------------------------------------------------------------
+	InstanceManager::InstancedEntity::InstancedEntity(InstanceBatch* batch)
+		: mBatch(batch), mIndex(0), mPosition(Vector3::ZERO),
+		mOrientation(Quaternion::IDENTITY), mScale(Vector3::UNIT_SCALE),
+		mVisible(true)
+	{
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstancedEntity::setPosition(const Vector3& position)
+	{
+		mPosition = position;
+		mBatch->_notifyInstanceMoved(this);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstancedEntity::setOrientation(const Quaternion& orientation)
+	{
+		mOrientation = orientation;
+		mBatch->_notifyInstanceMoved(this);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstancedEntity::setScale(const Vector3& scale)
+	{
+		mScale = scale;
+		mBatch->_notifyInstanceMoved(this);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstancedEntity::setTransform(const Vector3& position,
+		const Quaternion& orientation, const Vector3& scale)
+	{
+		mPosition = position;
+		mOrientation = orientation;
+		mScale = scale;
+		mBatch->_notifyInstanceMoved(this);
+	}
+	//--------------------------------------------------------------------------
+	//--------------------------------------------------------------------------
+	InstanceManager::InstanceBatch::InstanceBatch(InstanceManager* manager,
+		const String& name, const MaterialPtr& material, size_t maxInstances)
+		: MovableObject(name), mInstanceManager(manager), mNode(0),
+		mMaterial(material), mVertexData(0), mIndexData(0),
+		mMaxInstances(maxInstances), mInstanceData(0), mTransforms(0),
+		mNumVisible(0), mBoundingRadius(0), mBoundsDirty(false)
+	{
+		// Share the mesh's buffers, and add the instance stream to them
+		SubMesh* subMesh = manager->getSubMesh();
+		VertexData* meshData = subMesh->useSharedVertices ?
+			manager->getMesh()->sharedVertexData : subMesh->vertexData;
+		mVertexData = meshData->clone(false);
+		mIndexData = subMesh->indexData;
+
+		unsigned short source = mVertexData->vertexBufferBinding->getNextIndex();
+		unsigned short texCoord = manager->getInstanceTexCoordIndex();
+		size_t offset = 0;
+		for (unsigned short row = 0; row < 3; ++row)
+		{
+			offset += mVertexData->vertexDeclaration->addElement(source, offset,
+				VET_FLOAT4, VES_TEXTURE_COORDINATES, texCoord + row).getSize();
+		}
+		mInstanceBuffer = HardwareBufferManager::getSingleton().createVertexBuffer(
+			offset, mMaxInstances, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+		mInstanceBuffer->setIsInstanceData(true);
+		mInstanceBuffer->setInstanceDataStepRate(1);
+		mVertexData->vertexBufferBinding->setBinding(source, mInstanceBuffer);
+
+		// Bounding spheres followed by transforms, SIMD aligned
+		size_t stride = (mMaxInstances + 3) & ~3;
+		mInstanceData = static_cast<float*>(
+			OGRE_MALLOC_SIMD(sizeof(float) * stride * 16, MEMCATEGORY_GEOMETRY));
+		mSpheres.centreX = mInstanceData;
+		mSpheres.centreY = mInstanceData + stride;
+		mSpheres.centreZ = mInstanceData + stride * 2;
+		mSpheres.radius = mInstanceData + stride * 3;
+		mTransforms = mInstanceData + stride * 4;
+		mVisibility.resize((mMaxInstances + 31) / 32);
+		mInstances.reserve(mMaxInstances);
+		mAABB.setNull();
+
+		// Instances are in world space, so the node stays at the origin
+		SceneManager* sceneMgr = manager->getSceneManager();
+		mNode = sceneMgr->getRootSceneNode()->createChildSceneNode(name);
+		mNode->attachObject(this);
+	}
+	//--------------------------------------------------------------------------
+	InstanceManager::InstanceBatch::~InstanceBatch()
+	{
+		if (mNode)
+		{
+			mNode->getParentSceneNode()->removeChild(mNode);
+			mInstanceManager->getSceneManager()->destroySceneNode(mNode->getName());
+			mNode = 0;
+		}
+		for (InstancedEntityList::iterator i = mInstances.begin(); i != mInstances.end(); ++i)
+		{
+			OGRE_DELETE *i;
+		}
+		mInstances.clear();
+
+		OGRE_FREE_SIMD(mInstanceData, MEMCATEGORY_GEOMETRY);
+		// Only the declaration and binding are ours, the buffers are shared
+		OGRE_DELETE mVertexData;
+	}
+	//--------------------------------------------------------------------------
+	InstanceManager::InstancedEntity* InstanceManager::InstanceBatch::_createInstance(void)
+	{
+		assert(!isFull() && "Instance batch is full");
+
+		InstancedEntity* instance = OGRE_NEW InstancedEntity(this);
+		instance->mIndex = mInstances.size();
+		mInstances.push_back(instance);
+		updateInstance(instance);
+		return instance;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::_destroyInstance(InstancedEntity* instance)
+	{
+		assert(instance->mBatch == this && mInstances[instance->mIndex] == instance);
+
+		// Move the last instance into the hole, so the arrays stay dense
+		size_t index = instance->mIndex;
+		size_t last = mInstances.size() - 1;
+		if (index != last)
+		{
+			mInstances[index] = mInstances[last];
+			mInstances[index]->mIndex = index;
+			mSpheres.centreX[index] = mSpheres.centreX[last];
+			mSpheres.centreY[index] = mSpheres.centreY[last];
+			mSpheres.centreZ[index] = mSpheres.centreZ[last];
+			mSpheres.radius[index] = mSpheres.radius[last];
+			memcpy(mTransforms + index * 12, mTransforms + last * 12, sizeof(float) * 12);
+		}
+		mInstances.pop_back();
+		OGRE_DELETE instance;
+
+		markBoundsDirty();
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::_notifyInstanceMoved(const InstancedEntity* instance)
+	{
+		updateInstance(instance);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::updateInstance(const InstancedEntity* instance)
+	{
+		size_t index = instance->mIndex;
+		Matrix4 xform;
+		xform.makeTransform(instance->mPosition, instance->mScale, instance->mOrientation);
+
+		float* pRows = mTransforms + index * 12;
+		for (size_t row = 0; row < 3; ++row)
+		{
+			for (size_t col = 0; col < 4; ++col)
+			{
+				*pRows++ = static_cast<float>(xform[row][col]);
+			}
+		}
+
+		// Sphere around the mesh bounds, grown by the largest scale
+		const AxisAlignedBox& meshBounds = mInstanceManager->getMesh()->getBounds();
+		Vector3 centre = instance->mPosition;
+		Real radius = 0;
+		if (meshBounds.isFinite())
+		{
+			const Vector3& scale = instance->mScale;
+			centre = xform.transformAffine(meshBounds.getCenter());
+			radius = meshBounds.getHalfSize().length() * std::max(
+				std::max(Math::Abs(scale.x), Math::Abs(scale.y)), Math::Abs(scale.z));
+		}
+		mSpheres.centreX[index] = static_cast<float>(centre.x);
+		mSpheres.centreY[index] = static_cast<float>(centre.y);
+		mSpheres.centreZ[index] = static_cast<float>(centre.z);
+		mSpheres.radius[index] = static_cast<float>(radius);
+
+		markBoundsDirty();
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::markBoundsDirty(void)
+	{
+		if (!mBoundsDirty)
+		{
+			mBoundsDirty = true;
+			// Make sure the node picks up the new bounds
+			if (mParentNode)
+				mParentNode->needUpdate();
+		}
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::updateBounds(void) const
+	{
+		if (!mBoundsDirty)
+			return;
+
+		if (mInstances.empty())
+		{
+			mAABB.setNull();
+			mBoundingRadius = 0;
+		}
+		else
+		{
+			Vector3 minimum(Math::POS_INFINITY, Math::POS_INFINITY, Math::POS_INFINITY);
+			Vector3 maximum(Math::NEG_INFINITY, Math::NEG_INFINITY, Math::NEG_INFINITY);
+			for (size_t i = 0; i < mInstances.size(); ++i)
+			{
+				Vector3 centre(mSpheres.centreX[i], mSpheres.centreY[i], mSpheres.centreZ[i]);
+				Vector3 radius(mSpheres.radius[i], mSpheres.radius[i], mSpheres.radius[i]);
+				minimum.makeFloor(centre - radius);
+				maximum.makeCeil(centre + radius);
+			}
+			mAABB.setExtents(minimum, maximum);
+			mBoundingRadius = Math::boundingRadiusFromAABB(mAABB);
+		}
+		mBoundsDirty = false;
+	}
+	//--------------------------------------------------------------------------
+	size_t InstanceManager::InstanceBatch::_cullAndPackInstances(const Frustum* frustum)
+	{
+		mNumVisible = 0;
+		size_t count = mInstances.size();
+		if (!count)
+			return 0;
+
+		// The far plane is left out if it's at infinity
+		const Plane* frustumPlanes = frustum->getFrustumPlanes();
+		Plane planes[6];
+		size_t numPlanes = 0;
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			if (plane != FRUSTUM_PLANE_FAR || frustum->getFarClipDistance() != 0)
+				planes[numPlanes++] = frustumPlanes[plane];
+		}
+		OptimisedUtil::getImplementation()->cullSpheres(
+			planes, numPlanes, mSpheres, &mVisibility[0], count);
+
+		// Pack the transforms of the visible instances together
+		float* pDest = static_cast<float*>(
+			mInstanceBuffer->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t word = 0; word * 32 < count; ++word)
+		{
+			uint32 mask = mVisibility[word];
+			for (size_t i = word * 32; mask; ++i, mask >>= 1)
+			{
+				if ((mask & 1) && mInstances[i]->mVisible)
+				{
+					memcpy(pDest, mTransforms + i * 12, sizeof(float) * 12);
+					pDest += 12;
+					++mNumVisible;
+				}
+			}
+		}
+		mInstanceBuffer->unlock();
+
+		return mNumVisible;
+	}
+	//--------------------------------------------------------------------------
+	const String& InstanceManager::InstanceBatch::getMovableType(void) const
+	{
+		static String sType = "InstanceBatch";
+		return sType;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::_notifyCurrentCamera(Camera* cam)
+	{
+		MovableObject::_notifyCurrentCamera(cam);
+
+		if (isVisible())
+		{
+			const Frustum* frustum = cam->getCullingFrustum() ?
+				cam->getCullingFrustum() : cam;
+			_cullAndPackInstances(frustum);
+		}
+	}
+	//--------------------------------------------------------------------------
+	const AxisAlignedBox& InstanceManager::InstanceBatch::getBoundingBox(void) const
+	{
+		updateBounds();
+		return mAABB;
+	}
+	//--------------------------------------------------------------------------
+	Real InstanceManager::InstanceBatch::getBoundingRadius(void) const
+	{
+		updateBounds();
+		return mBoundingRadius;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::_updateRenderQueue(RenderQueue* queue)
+	{
+		if (!mNumVisible)
+			return;
+
+		if (!mMaterial->isLoaded())
+			mMaterial->load();
+		queue->addRenderable(this, mRenderQueueID);
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::visitRenderables(Renderable::Visitor* visitor,
+		bool debugRenderables)
+	{
+		(void)debugRenderables;
+		visitor->visit(this, 0, false);
+	}
+	//--------------------------------------------------------------------------
+	uint32 InstanceManager::InstanceBatch::getTypeFlags(void) const
+	{
+		return SceneManager::ENTITY_TYPE_MASK;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::getRenderOperation(RenderOperation& op)
+	{
+		op.operationType = RenderOperation::OT_TRIANGLE_LIST;
+		op.srcRenderable = this;
+		op.useIndexes = true;
+		op.vertexData = mVertexData;
+		op.indexData = mIndexData;
+		op.numberOfInstances = mNumVisible;
+	}
+	//--------------------------------------------------------------------------
+	void InstanceManager::InstanceBatch::getWorldTransforms(Matrix4* xform) const
+	{
+		// Each instance's transform comes from the instance stream
+		*xform = Matrix4::IDENTITY;
+	}
+	//--------------------------------------------------------------------------
+	Real InstanceManager::InstanceBatch::getSquaredViewDepth(const Camera* cam) const
+	{
+		return getBoundingBox().getCenter().squaredDistance(
+			cam->getLodCamera()->getDerivedPosition());
+	}
+	//--------------------------------------------------------------------------
+	const LightList& InstanceManager::InstanceBatch::getLights(void) const
+	{
+		return queryLights();
+	}
+
+}
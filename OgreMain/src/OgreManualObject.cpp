@@ -81,6 +81,7 @@ namespace Ogre {
 			OGRE_DELETE *s;
 		}
 		mShadowRenderables.clear();
+		clearCachedShadowVolumes();
 
 
 	}
@@ -592,6 +593,8 @@ namespace Ogre {
 				"You cannot call end() until after you call begin()",
 				"ManualObject::end");
 		}
+		// Shadow volumes kept for the previous geometry are out of date
+		clearCachedShadowVolumes();
 		if (mTempVertexPending)
 		{
 			// bake current vertex
@@ -988,12 +991,9 @@ namespace Ogre {
             ++si;
             ++egi;
 		}
-		// Calc triangle light facing
-		updateEdgeListLightFacing(edgeList, lightPos);
-
-		// Generate indexes and update renderables
-		generateShadowVolume(edgeList, *indexBuffer, light,
-			mShadowRenderables, flags);
+		// Calc triangle light facing, generate indexes and update renderables
+		updateShadowVolume(edgeList, *indexBuffer, light, lightPos,
+			mShadowRenderables, flags, true);
 
 
 		return ShadowRenderableListIterator(
@@ -43,6 +43,8 @@ THE SOFTWARE.
 #include "OgreOptimisedUtil.h"
 #include "OgreTangentSpaceCalc.h"
 #include "OgreLodStrategyManager.h"
+#include "OgreQuadricLodGenerator.h"
+#include "OgreParallelTaskDispatcher.h"
 
 
 namespace Ogre {
@@ -250,8 +252,10 @@ namespace Ogre {
             ResourceGroupManager::getSingleton().openResource(
 				mName, mGroup, true, this);
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM, unless it's there already (e.g. when
+        // the file is memory mapped)
+        if (!mFreshFromDisk->getCurrentPtr())
+            mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -889,6 +893,30 @@ namespace Ogre {
     {
         return mSkeletonName;
     }
+	//---------------------------------------------------------------------
+	typedef vector<QuadricLodGenerator*>::type LodGeneratorList;
+	/// Computes the levels of the generators of several submeshes
+	class LodGenerationTaskSet : public ParallelTaskDispatcher::TaskSet
+	{
+	public:
+		LodGenerationTaskSet(const LodGeneratorList& generators, ushort numLevels,
+			ProgressiveMesh::VertexReductionQuota quota, Real reductionValue)
+			: mGenerators(generators), mNumLevels(numLevels), mQuota(quota), mReductionValue(reductionValue) {}
+
+		void processTasks(size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (mGenerators[i])
+					mGenerators[i]->computeLevels(mNumLevels, mQuota, mReductionValue);
+			}
+		}
+	protected:
+		const LodGeneratorList& mGenerators;
+		ushort mNumLevels;
+		ProgressiveMesh::VertexReductionQuota mQuota;
+		Real mReductionValue;
+	};
     //---------------------------------------------------------------------
     void Mesh::generateLodLevels(const LodValueList& lodValues,
         ProgressiveMesh::VertexReductionQuota reductionMethod, Real reductionValue)
@@ -903,32 +931,49 @@ namespace Ogre {
 			<< "Generating " << lodValues.size()
 			<< " lower LODs for mesh " << mName;
 
-        SubMeshList::iterator isub, isubend;
-        isubend = mSubMeshList.end();
-        for (isub = mSubMeshList.begin(); isub != isubend; ++isub)
-        {
-            // check if triangles are present
-            if ((*isub)->indexData->indexCount > 0)
-            {
-                // Set up data for reduction
-                VertexData* pVertexData = (*isub)->useSharedVertices ? sharedVertexData : (*isub)->vertexData;
+		// The geometry is read and the index buffers created on this thread,
+		// but the submeshes are reduced in parallel
+		LodGeneratorList generators(mSubMeshList.size(), 0);
+		try
+		{
+			for (size_t i = 0; i < mSubMeshList.size(); ++i)
+			{
+				SubMesh* sub = mSubMeshList[i];
+				// check if triangles are present
+				if (sub->indexData->indexCount > 0)
+				{
+					VertexData* pVertexData = sub->useSharedVertices ? sharedVertexData : sub->vertexData;
+					generators[i] = OGRE_NEW QuadricLodGenerator(pVertexData, sub->indexData);
+				}
+			}
 
-                ProgressiveMesh pm(pVertexData, (*isub)->indexData);
-                pm.build(
-                static_cast<ushort>(lodValues.size()),
-                    &((*isub)->mLodFaceList),
-                    reductionMethod, reductionValue);
+			LodGenerationTaskSet tasks(generators,
+				static_cast<ushort>(lodValues.size()), reductionMethod, reductionValue);
+			MeshManager::getSingleton().getParallelDispatcher()->dispatch(&tasks, generators.size());
+		}
+		catch (...)
+		{
+			for (LodGeneratorList::iterator i = generators.begin(); i != generators.end(); ++i)
+				OGRE_DELETE *i;
+			throw;
+		}
 
-            }
-            else
-            {
-                // create empty index data for each lod
-                for (size_t i = 0; i < lodValues.size(); ++i)
-                {
-                    (*isub)->mLodFaceList.push_back(OGRE_NEW IndexData);
-                }
-            }
-        }
+		for (size_t i = 0; i < mSubMeshList.size(); ++i)
+		{
+			if (generators[i])
+			{
+				generators[i]->bakeLevels(&mSubMeshList[i]->mLodFaceList);
+				OGRE_DELETE generators[i];
+			}
+			else
+			{
+				// create empty index data for each lod
+				for (size_t l = 0; l < lodValues.size(); ++l)
+				{
+					mSubMeshList[i]->mLodFaceList.push_back(OGRE_NEW IndexData);
+				}
+			}
+		}
 
         // Iterate over the lods and record usage
         LodValueList::const_iterator ivalue, ivalueend;
@@ -1470,6 +1515,10 @@ namespace Ogre {
                 // Build
                 EdgeListBuilder eb;
                 size_t vertexSetCount = 0;
+                // Submeshes with their own vertices are processed in parallel,
+                // except by background loading threads
+                if (!isBackgroundLoaded() && MeshManager::getSingletonPtr())
+                    eb.setParallelDispatcher(MeshManager::getSingleton().getParallelDispatcher());
 
                 if (sharedVertexData)
                 {
@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "OgreException.h"
 
 #include "OgrePrefabFactory.h"
+#include "OgreParallelTaskDispatcher.h"
 
 namespace Ogre
 {
@@ -55,7 +56,7 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------
     MeshManager::MeshManager():
-    mBoundsPaddingFactor(0.01), mListener(0)
+    mBoundsPaddingFactor(0.01), mListener(0), mParallelDispatcher(0)
     {
         mPrepAllMeshesForShadowVolumes = false;
 
@@ -69,6 +70,7 @@ namespace Ogre
     MeshManager::~MeshManager()
     {
         ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
+		OGRE_DELETE mParallelDispatcher;
     }
     //-----------------------------------------------------------------------
     void MeshManager::_initialise(void)
@@ -381,6 +383,13 @@ namespace Ogre
 	{
 		return mListener;
 	}
+	//-----------------------------------------------------------------------
+	ParallelTaskDispatcher* MeshManager::getParallelDispatcher(void)
+	{
+		if (!mParallelDispatcher)
+			mParallelDispatcher = OGRE_NEW ParallelTaskDispatcher("Ogre/MeshManager");
+		return mParallelDispatcher;
+	}
     //-----------------------------------------------------------------------
 	void MeshManager::loadResource(Resource* res)
 	{
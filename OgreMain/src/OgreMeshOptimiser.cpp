@@ -0,0 +1,661 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreMeshOptimiser.h"
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgrePose.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreVector3.h"
+
+namespace Ogre {
+
+	namespace
+	{
+		/// Number of remaining triangles up to which a vertex's valence is scored
+		const size_t MAX_VALENCE_SCORE = 32;
+		/// Marks a vertex or triangle which has not been given a place yet
+		const uint32 UNASSIGNED = 0xFFFFFFFF;
+
+		/// Orders clusters of triangles by descending sort key
+		struct ClusterKeyGreater
+		{
+			const vector<Real>::type& keys;
+			ClusterKeyGreater(const vector<Real>::type& k) : keys(k) {}
+			bool operator()(uint32 a, uint32 b) const { return keys[a] > keys[b]; }
+		};
+
+		/// Move the vertices of a buffer to the positions given by remap
+		void reorderVertexBuffer(const HardwareVertexBufferSharedPtr& src,
+			const HardwareVertexBufferSharedPtr& dest, size_t vertexStart,
+			const vector<uint32>::type& remap)
+		{
+			const size_t vertexSize = src->getVertexSize();
+			const size_t numVertices = src->getNumVertices();
+			vector<uchar>::type original(src->getSizeInBytes());
+			src->readData(0, original.size(), &original[0]);
+
+			vector<uchar>::type reordered(original);
+			for (size_t v = 0; v < remap.size(); ++v)
+			{
+				if (vertexStart + v >= numVertices || vertexStart + remap[v] >= numVertices)
+					continue;
+				memcpy(&reordered[(vertexStart + remap[v]) * vertexSize],
+					&original[(vertexStart + v) * vertexSize], vertexSize);
+			}
+			dest->writeData(0, reordered.size(), &reordered[0], src != dest);
+		}
+	}
+	//-----------------------------------------------------------------------
+	MeshOptimiser::MeshOptimiser()
+		: mCacheSize(16)
+		, mOptimiseOverdraw(true)
+		, mOverdrawThreshold(1.05f)
+		, mReorderVertices(true)
+	{
+	}
+	//-----------------------------------------------------------------------
+	MeshOptimiser::~MeshOptimiser()
+	{
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimise(Mesh* mesh)
+	{
+		IndexDataList sharedIndexData;
+		bool sharedVerticesIndexed = true;
+
+		for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+		{
+			SubMesh* subMesh = mesh->getSubMesh(i);
+			if (!subMesh->useSharedVertices)
+			{
+				optimise(subMesh);
+				continue;
+			}
+
+			if (subMesh->operationType == RenderOperation::OT_TRIANGLE_LIST)
+				optimiseTriangles(subMesh, mesh->sharedVertexData, true);
+
+			// Every submesh using the shared vertices must be remapped,
+			// whatever it draws
+			sharedIndexData.push_back(subMesh->indexData);
+			sharedIndexData.insert(sharedIndexData.end(),
+				subMesh->mLodFaceList.begin(), subMesh->mLodFaceList.end());
+			if (!subMesh->indexData || !subMesh->indexData->indexCount)
+				sharedVerticesIndexed = false;
+		}
+
+		if (mReorderVertices && mesh->sharedVertexData && sharedVerticesIndexed)
+			reorderVertices(mesh, 0, mesh->sharedVertexData, sharedIndexData);
+
+		if (mesh->isEdgeListBuilt())
+		{
+			mesh->freeEdgeList();
+			mesh->buildEdgeList();
+		}
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimise(SubMesh* subMesh)
+	{
+		if (subMesh->operationType != RenderOperation::OT_TRIANGLE_LIST)
+			return;
+
+		Mesh* mesh = subMesh->parent;
+		VertexData* vertexData = subMesh->useSharedVertices ?
+			mesh->sharedVertexData : subMesh->vertexData;
+		optimiseTriangles(subMesh, vertexData, true);
+
+		if (!mReorderVertices || subMesh->useSharedVertices ||
+			!subMesh->indexData || !subMesh->indexData->indexCount)
+			return;
+
+		ushort target = 0;
+		for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+		{
+			if (mesh->getSubMesh(i) == subMesh)
+				target = i + 1;
+		}
+
+		IndexDataList indexDataList;
+		indexDataList.push_back(subMesh->indexData);
+		indexDataList.insert(indexDataList.end(),
+			subMesh->mLodFaceList.begin(), subMesh->mLodFaceList.end());
+		reorderVertices(mesh, target, vertexData, indexDataList);
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimiseTriangles(SubMesh* subMesh, const VertexData* vertexData,
+		bool countStatistics)
+	{
+		optimiseTriangles(subMesh->indexData, vertexData, countStatistics);
+		// LOD levels have fewer triangles using the same vertices
+		for (ProgressiveMesh::LODFaceList::iterator i = subMesh->mLodFaceList.begin();
+			i != subMesh->mLodFaceList.end(); ++i)
+		{
+			optimiseTriangles(*i, vertexData, false);
+		}
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimiseTriangles(IndexData* indexData, const VertexData* vertexData,
+		bool countStatistics)
+	{
+		if (!indexData || indexData->indexBuffer.isNull() ||
+			indexData->indexCount < 3 || indexData->indexCount % 3)
+			return;
+
+		IndexList indexes;
+		readIndexes(indexData, indexes);
+
+		size_t vertexCount = vertexData ? vertexData->vertexCount : 0;
+		for (IndexList::iterator i = indexes.begin(); i != indexes.end(); ++i)
+			vertexCount = std::max(vertexCount, (size_t)*i + 1);
+
+		IndexList timestamps(vertexCount, 0);
+		uint32 time = (uint32)mCacheSize + 1;
+		size_t missesBefore = simulateCache(&indexes[0], indexes.size(), timestamps, time, mCacheSize);
+
+		optimiseVertexCache(indexes, vertexCount);
+		if (mOptimiseOverdraw && vertexData)
+			optimiseOverdraw(indexes, vertexCount, vertexData);
+
+		time += (uint32)mCacheSize + 1;
+		size_t missesAfter = simulateCache(&indexes[0], indexes.size(), timestamps, time, mCacheSize);
+
+		writeIndexes(indexData, indexes);
+
+		if (countStatistics)
+		{
+			mStatistics.triangleCount += indexes.size() / 3;
+			mStatistics.cacheMissesBefore += missesBefore;
+			mStatistics.cacheMissesAfter += missesAfter;
+		}
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimiseVertexCache(IndexList& indexes, size_t vertexCount) const
+	{
+		const size_t faceCount = indexes.size() / 3;
+		if (faceCount < 2)
+			return;
+
+		// Scores for a vertex's position in the cache and for the number of
+		// triangles still using it; vertices used by the last triangle get a
+		// fixed score, so that strips aren't favoured over fans
+		vector<float>::type cacheScore(mCacheSize);
+		for (size_t i = 0; i < mCacheSize; ++i)
+		{
+			if (i < 3)
+				cacheScore[i] = 0.75f;
+			else
+				cacheScore[i] = Math::Pow(1.0f - (float)(i - 3) / (float)(mCacheSize - 3), 1.5f);
+		}
+		float valenceScore[MAX_VALENCE_SCORE + 1];
+		valenceScore[0] = 0;
+		for (size_t i = 1; i <= MAX_VALENCE_SCORE; ++i)
+			valenceScore[i] = 2.0f * Math::Pow((float)i, -0.5f);
+
+		// Triangles using each vertex; those not emitted yet are kept at the
+		// start of each vertex's range
+		IndexList liveTriangles(vertexCount, 0);
+		for (size_t i = 0; i < indexes.size(); ++i)
+			++liveTriangles[indexes[i]];
+		IndexList adjacencyOffset(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; ++v)
+			adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+		IndexList adjacency(indexes.size());
+		{
+			IndexList fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for (size_t i = 0; i < indexes.size(); ++i)
+				adjacency[fill[indexes[i]]++] = (uint32)(i / 3);
+		}
+
+		vector<float>::type vertexScore(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			vertexScore[v] = liveTriangles[v] ?
+				valenceScore[std::min(liveTriangles[v], (uint32)MAX_VALENCE_SCORE)] : 0;
+		}
+		vector<float>::type triangleScore(faceCount);
+		vector<uchar>::type emitted(faceCount, 0);
+
+		// Start with the best triangle overall
+		uint32 best = 0;
+		for (size_t t = 0; t < faceCount; ++t)
+		{
+			triangleScore[t] = vertexScore[indexes[t * 3]] +
+				vertexScore[indexes[t * 3 + 1]] + vertexScore[indexes[t * 3 + 2]];
+			if (triangleScore[t] > triangleScore[best])
+				best = (uint32)t;
+		}
+
+		IndexList cache, newCache;
+		cache.reserve(mCacheSize + 3);
+		newCache.reserve(mCacheSize + 3);
+		IndexList result;
+		result.reserve(indexes.size());
+		size_t nextCandidate = 0;
+
+		for (size_t n = 0; n < faceCount; ++n)
+		{
+			if (best == UNASSIGNED)
+			{
+				// Nothing left around the cache, so start somewhere else
+				while (emitted[nextCandidate])
+					++nextCandidate;
+				best = (uint32)nextCandidate;
+			}
+
+			const uint32* tri = &indexes[best * 3];
+			emitted[best] = 1;
+			newCache.clear();
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32 v = tri[k];
+				result.push_back(v);
+
+				uint32* adj = &adjacency[adjacencyOffset[v]];
+				uint32 live = liveTriangles[v];
+				for (uint32 j = 0; j < live; ++j)
+				{
+					if (adj[j] == best)
+					{
+						std::swap(adj[j], adj[live - 1]);
+						break;
+					}
+				}
+				--liveTriangles[v];
+
+				if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+					newCache.push_back(v);
+			}
+			for (IndexList::iterator i = cache.begin(); i != cache.end(); ++i)
+			{
+				if (*i != tri[0] && *i != tri[1] && *i != tri[2])
+					newCache.push_back(*i);
+			}
+
+			// Rescore the vertices in the cache, and those which fell out of it
+			for (size_t i = 0; i < newCache.size(); ++i)
+			{
+				uint32 v = newCache[i];
+				uint32 live = liveTriangles[v];
+				vertexScore[v] = live ? valenceScore[std::min(live, (uint32)MAX_VALENCE_SCORE)] +
+					(i < mCacheSize ? cacheScore[i] : 0) : 0;
+			}
+
+			// The next triangle is the best of those using these vertices
+			best = UNASSIGNED;
+			float bestScore = -1;
+			for (size_t i = 0; i < newCache.size(); ++i)
+			{
+				uint32 v = newCache[i];
+				const uint32* adj = &adjacency[adjacencyOffset[v]];
+				for (uint32 j = 0; j < liveTriangles[v]; ++j)
+				{
+					uint32 t = adj[j];
+					triangleScore[t] = vertexScore[indexes[t * 3]] +
+						vertexScore[indexes[t * 3 + 1]] + vertexScore[indexes[t * 3 + 2]];
+					if (triangleScore[t] > bestScore)
+					{
+						bestScore = triangleScore[t];
+						best = t;
+					}
+				}
+			}
+
+			if (newCache.size() > mCacheSize)
+				newCache.resize(mCacheSize);
+			cache.swap(newCache);
+		}
+
+		indexes.swap(result);
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::optimiseOverdraw(IndexList& indexes, size_t vertexCount,
+		const VertexData* vertexData) const
+	{
+		const VertexElement* posElem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+		if (!posElem || posElem->getType() != VET_FLOAT3)
+			return;
+
+		vector<Vector3>::type positions(vertexCount, Vector3::ZERO);
+		{
+			HardwareVertexBufferSharedPtr vbuf =
+				vertexData->vertexBufferBinding->getBuffer(posElem->getSource());
+			const size_t count = std::min(vertexCount, vertexData->vertexCount);
+			unsigned char* vertex = static_cast<unsigned char*>(vbuf->lock(
+				vertexData->vertexStart * vbuf->getVertexSize(), count * vbuf->getVertexSize(),
+				HardwareBuffer::HBL_READ_ONLY));
+			float* pFloat;
+			for (size_t v = 0; v < count; ++v, vertex += vbuf->getVertexSize())
+			{
+				posElem->baseVertexPointerToElement(vertex, &pFloat);
+				positions[v] = Vector3(pFloat[0], pFloat[1], pFloat[2]);
+			}
+			vbuf->unlock();
+		}
+
+		const size_t faceCount = indexes.size() / 3;
+		IndexList timestamps(vertexCount, 0);
+		uint32 time = (uint32)mCacheSize + 1;
+
+		// Clusters always start where the cache has to be refilled anyway
+		IndexList hardBoundaries;
+		for (size_t t = 0; t < faceCount; ++t)
+		{
+			if (simulateCache(&indexes[t * 3], 3, timestamps, time, mCacheSize) == 3 || t == 0)
+				hardBoundaries.push_back((uint32)t);
+		}
+		hardBoundaries.push_back((uint32)faceCount);
+
+		// Then split them again as soon as the part so far has reached the
+		// cache efficiency of the whole, give or take the threshold
+		IndexList clusters;
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+		{
+			const size_t start = hardBoundaries[h];
+			const size_t end = hardBoundaries[h + 1];
+			time += (uint32)mCacheSize + 1;
+			const size_t clusterMisses = simulateCache(&indexes[start * 3], (end - start) * 3,
+				timestamps, time, mCacheSize);
+			const Real threshold = mOverdrawThreshold * (Real)clusterMisses / (Real)(end - start);
+
+			clusters.push_back((uint32)start);
+			time += (uint32)mCacheSize + 1;
+			size_t misses = 0, faces = 0;
+			for (size_t t = start; t < end; ++t)
+			{
+				misses += simulateCache(&indexes[t * 3], 3, timestamps, time, mCacheSize);
+				++faces;
+				if (t + 1 < end && (Real)misses <= threshold * (Real)faces)
+				{
+					clusters.push_back((uint32)(t + 1));
+					time += (uint32)mCacheSize + 1;
+					misses = faces = 0;
+				}
+			}
+		}
+		const size_t clusterCount = clusters.size();
+		clusters.push_back((uint32)faceCount);
+		if (clusterCount < 2)
+			return;
+
+		// Clusters which face away from the centre of the mesh are the ones
+		// most likely to occlude others, so draw them first
+		vector<Vector3>::type clusterCentroid(clusterCount, Vector3::ZERO);
+		vector<Vector3>::type clusterNormal(clusterCount, Vector3::ZERO);
+		Vector3 meshCentroid = Vector3::ZERO;
+		Real meshArea = 0;
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			Real clusterArea = 0;
+			for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+			{
+				const Vector3& p0 = positions[indexes[t * 3]];
+				const Vector3& p1 = positions[indexes[t * 3 + 1]];
+				const Vector3& p2 = positions[indexes[t * 3 + 2]];
+				Vector3 normal = (p1 - p0).crossProduct(p2 - p0);
+				Real area = normal.length();
+				clusterCentroid[c] += (p0 + p1 + p2) * (area / 3);
+				clusterNormal[c] += normal;
+				clusterArea += area;
+			}
+			meshCentroid += clusterCentroid[c];
+			meshArea += clusterArea;
+			if (clusterArea > 0)
+				clusterCentroid[c] /= clusterArea;
+		}
+		if (meshArea > 0)
+			meshCentroid /= meshArea;
+
+		vector<Real>::type keys(clusterCount);
+		IndexList order(clusterCount);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			keys[c] = (clusterCentroid[c] - meshCentroid).dotProduct(clusterNormal[c].normalisedCopy());
+			order[c] = (uint32)c;
+		}
+		std::stable_sort(order.begin(), order.end(), ClusterKeyGreater(keys));
+
+		IndexList result;
+		result.reserve(indexes.size());
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			result.insert(result.end(), indexes.begin() + clusters[order[c]] * 3,
+				indexes.begin() + clusters[order[c] + 1] * 3);
+		}
+		indexes.swap(result);
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::reorderVertices(Mesh* mesh, ushort target, VertexData* vertexData,
+		const IndexDataList& indexDataList)
+	{
+		if (!vertexData || !vertexData->vertexCount)
+			return;
+
+		const size_t vertexCount = vertexData->vertexCount;
+		vector<IndexList>::type indexLists(indexDataList.size());
+		for (size_t i = 0; i < indexDataList.size(); ++i)
+		{
+			if (!indexDataList[i] || indexDataList[i]->indexBuffer.isNull())
+				continue;
+			readIndexes(indexDataList[i], indexLists[i]);
+		}
+
+		// New position of each vertex, in the order the triangles use them;
+		// unused vertices go at the end
+		IndexList remap(vertexCount, UNASSIGNED);
+		uint32 next = 0;
+		for (size_t i = 0; i < indexLists.size(); ++i)
+		{
+			for (IndexList::iterator idx = indexLists[i].begin(); idx != indexLists[i].end(); ++idx)
+			{
+				if (*idx >= vertexCount)
+					return;
+				if (remap[*idx] == UNASSIGNED)
+					remap[*idx] = next++;
+			}
+		}
+		bool identity = true;
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (remap[v] == UNASSIGNED)
+				remap[v] = next++;
+			identity = identity && remap[v] == v;
+		}
+		if (identity)
+			return;
+
+		for (size_t i = 0; i < indexLists.size(); ++i)
+		{
+			if (indexLists[i].empty())
+				continue;
+			for (IndexList::iterator idx = indexLists[i].begin(); idx != indexLists[i].end(); ++idx)
+				*idx = remap[*idx];
+			writeIndexes(indexDataList[i], indexLists[i]);
+		}
+
+		// Every buffer bound, once even if bound more than once
+		set<HardwareVertexBuffer*>::type reordered;
+		const VertexBufferBinding::VertexBufferBindingMap& bindings =
+			vertexData->vertexBufferBinding->getBindings();
+		for (VertexBufferBinding::VertexBufferBindingMap::const_iterator b = bindings.begin();
+			b != bindings.end(); ++b)
+		{
+			if (reordered.insert(b->second.get()).second)
+				reorderVertexBuffer(b->second, b->second, vertexData->vertexStart, remap);
+		}
+
+		// Bone assignments; the blend buffers were reordered above
+		if (target == 0)
+		{
+			Mesh::VertexBoneAssignmentList assignments = mesh->getBoneAssignments();
+			if (!assignments.empty())
+			{
+				mesh->clearBoneAssignments();
+				for (Mesh::VertexBoneAssignmentList::iterator i = assignments.begin();
+					i != assignments.end(); ++i)
+				{
+					VertexBoneAssignment vba = i->second;
+					vba.vertexIndex = remap[vba.vertexIndex];
+					mesh->addBoneAssignment(vba);
+				}
+			}
+		}
+		else
+		{
+			SubMesh* subMesh = mesh->getSubMesh(target - 1);
+			SubMesh::VertexBoneAssignmentList assignments = subMesh->getBoneAssignments();
+			if (!assignments.empty())
+			{
+				subMesh->clearBoneAssignments();
+				for (SubMesh::VertexBoneAssignmentList::iterator i = assignments.begin();
+					i != assignments.end(); ++i)
+				{
+					VertexBoneAssignment vba = i->second;
+					vba.vertexIndex = remap[vba.vertexIndex];
+					subMesh->addBoneAssignment(vba);
+				}
+			}
+		}
+
+		// Poses
+		Mesh::PoseIterator poseIt = mesh->getPoseIterator();
+		while (poseIt.hasMoreElements())
+		{
+			Pose* pose = poseIt.getNext();
+			if (pose->getTarget() != target)
+				continue;
+			Pose::VertexOffsetMap offsets = pose->getVertexOffsets();
+			pose->clearVertexOffsets();
+			for (Pose::VertexOffsetMap::iterator i = offsets.begin(); i != offsets.end(); ++i)
+				pose->addVertex(remap[i->first], i->second);
+		}
+
+		// Morph keyframes; these buffers may be shared, so are replaced
+		// rather than changed
+		for (unsigned short a = 0; a < mesh->getNumAnimations(); ++a)
+		{
+			Animation* anim = mesh->getAnimation(a);
+			if (!anim->hasVertexTrack(target))
+				continue;
+			VertexAnimationTrack* track = anim->getVertexTrack(target);
+			if (track->getAnimationType() != VAT_MORPH)
+				continue;
+			for (unsigned short k = 0; k < track->getNumKeyFrames(); ++k)
+			{
+				VertexMorphKeyFrame* kf = track->getVertexMorphKeyFrame(k);
+				const HardwareVertexBufferSharedPtr& src = kf->getVertexBuffer();
+				if (src.isNull())
+					continue;
+				HardwareVertexBufferSharedPtr dest =
+					HardwareBufferManager::getSingleton().createVertexBuffer(
+						src->getVertexSize(), src->getNumVertices(), src->getUsage(),
+						src->hasShadowBuffer());
+				reorderVertexBuffer(src, dest, vertexData->vertexStart, remap);
+				kf->setVertexBuffer(dest);
+			}
+		}
+	}
+	//-----------------------------------------------------------------------
+	size_t MeshOptimiser::simulateCache(const uint32* indexes, size_t indexCount,
+		IndexList& timestamps, uint32& time, size_t cacheSize)
+	{
+		// A vertex is in the cache if fewer than cacheSize vertices have
+		// been added since it was
+		size_t misses = 0;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			uint32& stamp = timestamps[indexes[i]];
+			if (time - stamp > cacheSize)
+			{
+				stamp = time++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+	//-----------------------------------------------------------------------
+	size_t MeshOptimiser::countCacheMisses(const IndexData* indexData, size_t cacheSize)
+	{
+		if (!indexData || indexData->indexBuffer.isNull() || !indexData->indexCount)
+			return 0;
+
+		IndexList indexes;
+		readIndexes(indexData, indexes);
+		IndexList timestamps(*std::max_element(indexes.begin(), indexes.end()) + 1, 0);
+		uint32 time = (uint32)cacheSize + 1;
+		return simulateCache(&indexes[0], indexes.size(), timestamps, time, cacheSize);
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::readIndexes(const IndexData* indexData, IndexList& indexes)
+	{
+		const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+		indexes.resize(indexData->indexCount);
+		if (indexes.empty())
+			return;
+
+		const void* data = ibuf->lock(indexData->indexStart * ibuf->getIndexSize(),
+			indexData->indexCount * ibuf->getIndexSize(), HardwareBuffer::HBL_READ_ONLY);
+		if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+		{
+			memcpy(&indexes[0], data, indexes.size() * sizeof(uint32));
+		}
+		else
+		{
+			const uint16* p16 = static_cast<const uint16*>(data);
+			for (size_t i = 0; i < indexes.size(); ++i)
+				indexes[i] = p16[i];
+		}
+		ibuf->unlock();
+	}
+	//-----------------------------------------------------------------------
+	void MeshOptimiser::writeIndexes(IndexData* indexData, const IndexList& indexes)
+	{
+		const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+		if (indexes.empty())
+			return;
+
+		void* data = ibuf->lock(indexData->indexStart * ibuf->getIndexSize(),
+			indexes.size() * ibuf->getIndexSize(), HardwareBuffer::HBL_NORMAL);
+		if (ibuf->getType() == HardwareIndexBuffer::IT_32BIT)
+		{
+			memcpy(data, &indexes[0], indexes.size() * sizeof(uint32));
+		}
+		else
+		{
+			uint16* p16 = static_cast<uint16*>(data);
+			for (size_t i = 0; i < indexes.size(); ++i)
+				p16[i] = (uint16)indexes[i];
+		}
+		ibuf->unlock();
+	}
+
+}
@@ -38,6 +38,7 @@ THE SOFTWARE.
 namespace Ogre {
 
     String MeshSerializer::msCurrentVersion = "[MeshSerializer_v1.41]";
+    String MeshSerializer::msAlignedVersion = "[MeshSerializer_v1.41_aligned]";
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
     MeshSerializer::MeshSerializer()
@@ -63,6 +64,10 @@ namespace Ogre {
         mImplementations.insert(
             MeshSerializerImplMap::value_type(msCurrentVersion, 
             OGRE_NEW MeshSerializerImpl() ) );
+
+        mImplementations.insert(
+            MeshSerializerImplMap::value_type(msAlignedVersion, 
+            OGRE_NEW MeshSerializerImpl_Aligned() ) );
     }
     //---------------------------------------------------------------------
     MeshSerializer::~MeshSerializer()
@@ -78,13 +83,14 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void MeshSerializer::exportMesh(const Mesh* pMesh, const String& filename,
-		Endian endianMode)
+		Endian endianMode, bool alignBuffers)
     {
-        MeshSerializerImplMap::iterator impl = mImplementations.find(msCurrentVersion);
+        const String& version = alignBuffers ? msAlignedVersion : msCurrentVersion;
+        MeshSerializerImplMap::iterator impl = mImplementations.find(version);
         if (impl == mImplementations.end())
         {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot find serializer implementation for "
-                "current version " + msCurrentVersion, "MeshSerializer::exportMesh");
+                "current version " + version, "MeshSerializer::exportMesh");
         }
 
         impl->second->exportMesh(pMesh, filename, endianMode);
@@ -121,7 +127,7 @@ namespace Ogre {
         // Call implementation
         impl->second->importMesh(stream, pDest, mListener);
         // Warn on old version of mesh
-        if (ver != msCurrentVersion)
+        if (ver != msCurrentVersion && ver != msAlignedVersion)
         {
             LogManager::getSingleton().logMessage("WARNING: " + pDest->getName() + 
                 " is an older format (" + ver + "); you should upgrade it as soon as possible" +
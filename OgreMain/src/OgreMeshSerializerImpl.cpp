@@ -233,8 +233,16 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeSubMesh(const SubMesh* s)
     {
+        // Padding before the indexes, which follow the fields below
+        size_t indexPadding = 0;
+        if (s->indexData->indexCount > 0)
+        {
+            indexPadding = calcBufferDataPaddingSize(ftell(mpfFile) + STREAM_OVERHEAD_SIZE +
+                s->getMaterialName().length() + 1 + sizeof(char) + sizeof(unsigned int) + sizeof(char));
+        }
+
         // Header
-        writeChunkHeader(M_SUBMESH, calcSubMeshSize(s));
+        writeChunkHeader(M_SUBMESH, calcSubMeshSize(s) + indexPadding);
 
         // char* materialName
         writeString(s->getMaterialName());
@@ -252,6 +260,8 @@ namespace Ogre {
 
 		if (indexCount > 0)
 		{
+			writeBufferDataPadding();
+
 			// unsigned short* faceVertexIndices ((indexCount)
 			HardwareIndexBufferSharedPtr ibuf = s->indexData->indexBuffer;
 			void* pIdx = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
@@ -384,13 +394,15 @@ namespace Ogre {
             vertexData->vertexBufferBinding->getBindings();
         VertexBufferBinding::VertexBufferBindingMap::const_iterator vbi, vbiend;
 
+		size_t start = ftell(mpfFile);
 		size_t size = STREAM_OVERHEAD_SIZE + sizeof(unsigned int) + // base
 			(STREAM_OVERHEAD_SIZE + elemList.size() * (STREAM_OVERHEAD_SIZE + sizeof(unsigned short) * 5)); // elements
         vbiend = bindings.end();
 		for (vbi = bindings.begin(); vbi != vbiend; ++vbi)
 		{
 			const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
-			size += (STREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + vbuf->getSizeInBytes();
+			size += (STREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2);
+			size += calcBufferDataPaddingSize(start + size) + vbuf->getSizeInBytes();
 		}
 
 		// Header
@@ -434,7 +446,9 @@ namespace Ogre {
 		for (vbi = bindings.begin(); vbi != vbiend; ++vbi)
 		{
 			const HardwareVertexBufferSharedPtr& vbuf = vbi->second;
-			size = (STREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + vbuf->getSizeInBytes();
+			size_t padding = calcBufferDataPaddingSize(ftell(mpfFile) + 
+				(STREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2));
+			size = (STREAM_OVERHEAD_SIZE * 2) + (sizeof(unsigned short) * 2) + padding + vbuf->getSizeInBytes();
 			writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER,  size);
 			// unsigned short bindIndex;	// Index to bind this buffer to
 			tmp = vbi->first;
@@ -444,8 +458,9 @@ namespace Ogre {
 			writeShorts(&tmp, 1);
 
 			// Data
-			size = STREAM_OVERHEAD_SIZE + vbuf->getSizeInBytes();
+			size = STREAM_OVERHEAD_SIZE + padding + vbuf->getSizeInBytes();
 			writeChunkHeader(M_GEOMETRY_VERTEX_BUFFER_DATA, size);
+			writeBufferDataPadding();
 			void* pBuf = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
 
 			if (mFlipEndian)
@@ -759,26 +774,70 @@ namespace Ogre {
 		}
 
 		// Create / populate vertex buffer
+		HardwareVertexBufferSharedPtr vbuf = readVertexBufferData(stream, pMesh, 
+			vertexSize, dest->vertexCount, dest->vertexDeclaration->findElementsBySource(bindIndex));
+
+		// Set binding
+        dest->vertexBufferBinding->setBinding(bindIndex, vbuf);
+
+	}
+    //---------------------------------------------------------------------
+	HardwareVertexBufferSharedPtr MeshSerializerImpl::readVertexBufferData(DataStreamPtr& stream, 
+		Mesh* pMesh, size_t vertexSize, size_t vertexCount, 
+		const VertexDeclaration::VertexElementList& elems)
+	{
 		HardwareVertexBufferSharedPtr vbuf;
         vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
             vertexSize,
-            dest->vertexCount,
+            vertexCount,
             pMesh->mVertexBufferUsage,
 			pMesh->mVertexBufferShadowBuffer);
         void* pBuf = vbuf->lock(HardwareBuffer::HBL_DISCARD);
-        stream->read(pBuf, dest->vertexCount * vertexSize);
+        stream->read(pBuf, vertexCount * vertexSize);
 
 		// endian conversion for OSX
 		flipFromLittleEndian(
 			pBuf,
-			dest->vertexCount,
+			vertexCount,
 			vertexSize,
-			dest->vertexDeclaration->findElementsBySource(bindIndex));
+			elems);
         vbuf->unlock();
-
-		// Set binding
-        dest->vertexBufferBinding->setBinding(bindIndex, vbuf);
-
+		return vbuf;
+	}
+    //---------------------------------------------------------------------
+	HardwareIndexBufferSharedPtr MeshSerializerImpl::readIndexBufferData(DataStreamPtr& stream, 
+		Mesh* pMesh, HardwareIndexBuffer::IndexType itype, size_t indexCount)
+	{
+		HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().
+			createIndexBuffer(
+				itype,
+				indexCount,
+				pMesh->mIndexBufferUsage,
+				pMesh->mIndexBufferShadowBuffer);
+		void* pIdx = ibuf->lock(HardwareBuffer::HBL_DISCARD);
+		if (itype == HardwareIndexBuffer::IT_32BIT)
+		{
+			// unsigned int* faceVertexIndices
+			readInts(stream, static_cast<unsigned int*>(pIdx), indexCount);
+		}
+		else
+		{
+			// unsigned short* faceVertexIndices
+			readShorts(stream, static_cast<unsigned short*>(pIdx), indexCount);
+		}
+		ibuf->unlock();
+		return ibuf;
+	}
+    //---------------------------------------------------------------------
+	size_t MeshSerializerImpl::calcBufferDataPaddingSize(size_t offset)
+	{
+		// No padding in this version
+		return 0;
+	}
+    //---------------------------------------------------------------------
+	void MeshSerializerImpl::writeBufferDataPadding(void)
+	{
+		// No padding in this version
 	}
     //---------------------------------------------------------------------
 	void MeshSerializerImpl::readSubMeshNameTable(DataStreamPtr& stream, Mesh* pMesh)
@@ -957,37 +1016,8 @@ namespace Ogre {
         readBools(stream, &idx32bit, 1);
         if (indexCount > 0)
         {
-            if (idx32bit)
-            {
-                ibuf = HardwareBufferManager::getSingleton().
-                    createIndexBuffer(
-                        HardwareIndexBuffer::IT_32BIT,
-                        sm->indexData->indexCount,
-                        pMesh->mIndexBufferUsage,
-					    pMesh->mIndexBufferShadowBuffer);
-                // unsigned int* faceVertexIndices
-                unsigned int* pIdx = static_cast<unsigned int*>(
-                    ibuf->lock(HardwareBuffer::HBL_DISCARD)
-                    );
-                readInts(stream, pIdx, sm->indexData->indexCount);
-                ibuf->unlock();
-
-            }
-            else // 16-bit
-            {
-                ibuf = HardwareBufferManager::getSingleton().
-                    createIndexBuffer(
-                        HardwareIndexBuffer::IT_16BIT,
-                        sm->indexData->indexCount,
-                        pMesh->mIndexBufferUsage,
-					    pMesh->mIndexBufferShadowBuffer);
-                // unsigned short* faceVertexIndices
-                unsigned short* pIdx = static_cast<unsigned short*>(
-                    ibuf->lock(HardwareBuffer::HBL_DISCARD)
-                    );
-                readShorts(stream, pIdx, sm->indexData->indexCount);
-                ibuf->unlock();
-            }
+            ibuf = readIndexBufferData(stream, pMesh, idx32bit ? 
+                HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT, indexCount);
         }
         sm->indexData->indexBuffer = ibuf;
 
@@ -1840,6 +1870,7 @@ namespace Ogre {
         edgeData->triangles.resize(numTriangles);
         edgeData->triangleFaceNormals.resize(numTriangles);
         edgeData->triangleLightFacings.resize(numTriangles);
+        edgeData->triangleLightFacingMask.resize((numTriangles + 31) / 32);
         // unsigned long numEdgeGroups
         uint32 numEdgeGroups;
         readInts(stream, &numEdgeGroups, 1);
@@ -2474,6 +2505,93 @@ namespace Ogre {
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
+    MeshSerializerImpl_Aligned::MeshSerializerImpl_Aligned()
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v1.41_aligned]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_Aligned::~MeshSerializerImpl_Aligned()
+    {
+    }
+    //---------------------------------------------------------------------
+	size_t MeshSerializerImpl_Aligned::calcBufferDataPaddingSize(size_t offset)
+	{
+		// unsigned short count, then that many bytes to reach the boundary
+		size_t dataOffset = offset + sizeof(unsigned short);
+		return sizeof(unsigned short) + (BUFFER_ALIGNMENT - dataOffset % BUFFER_ALIGNMENT) % BUFFER_ALIGNMENT;
+	}
+    //---------------------------------------------------------------------
+	void MeshSerializerImpl_Aligned::writeBufferDataPadding(void)
+	{
+		static const char zeros[BUFFER_ALIGNMENT] = { 0 };
+		unsigned short count = static_cast<unsigned short>(
+			calcBufferDataPaddingSize(ftell(mpfFile)) - sizeof(unsigned short));
+		writeShorts(&count, 1);
+		writeData(zeros, 1, count);
+	}
+    //---------------------------------------------------------------------
+	void MeshSerializerImpl_Aligned::readBufferDataPadding(DataStreamPtr& stream)
+	{
+		unsigned short count;
+		readShorts(stream, &count, 1);
+		stream->skip(count);
+	}
+    //---------------------------------------------------------------------
+	HardwareVertexBufferSharedPtr MeshSerializerImpl_Aligned::readVertexBufferData(DataStreamPtr& stream, 
+		Mesh* pMesh, size_t vertexSize, size_t vertexCount, 
+		const VertexDeclaration::VertexElementList& elems)
+	{
+		readBufferDataPadding(stream);
+
+		size_t size = vertexSize * vertexCount;
+		void* pData = stream->getCurrentPtr();
+		if (!pData || mFlipEndian)
+		{
+			// Has to be copied out of the stream
+			return MeshSerializerImpl::readVertexBufferData(stream, pMesh, vertexSize, vertexCount, elems);
+		}
+		if (stream->size() - stream->tell() < size)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Vertex buffer data is truncated",
+				"MeshSerializerImpl_Aligned::readVertexBufferData");
+		}
+
+		HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBufferFromData(
+			vertexSize, vertexCount, pMesh->mVertexBufferUsage, pMesh->mVertexBufferShadowBuffer,
+			pData, stream->isWriteable() ? stream : DataStreamPtr());
+		stream->skip(static_cast<long>(size));
+		return vbuf;
+	}
+    //---------------------------------------------------------------------
+	HardwareIndexBufferSharedPtr MeshSerializerImpl_Aligned::readIndexBufferData(DataStreamPtr& stream, 
+		Mesh* pMesh, HardwareIndexBuffer::IndexType itype, size_t indexCount)
+	{
+		readBufferDataPadding(stream);
+
+		size_t size = indexCount * 
+			(itype == HardwareIndexBuffer::IT_32BIT ? sizeof(unsigned int) : sizeof(unsigned short));
+		void* pData = stream->getCurrentPtr();
+		if (!pData || mFlipEndian)
+		{
+			// Has to be copied out of the stream
+			return MeshSerializerImpl::readIndexBufferData(stream, pMesh, itype, indexCount);
+		}
+		if (stream->size() - stream->tell() < size)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Index buffer data is truncated",
+				"MeshSerializerImpl_Aligned::readIndexBufferData");
+		}
+
+		HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBufferFromData(
+			itype, indexCount, pMesh->mIndexBufferUsage, pMesh->mIndexBufferShadowBuffer,
+			pData, stream->isWriteable() ? stream : DataStreamPtr());
+		stream->skip(static_cast<long>(size));
+		return ibuf;
+	}
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
     MeshSerializerImpl_v1_4::MeshSerializerImpl_v1_4()
     {
         // Version number
@@ -2581,6 +2699,7 @@ namespace Ogre {
         edgeData->triangles.resize(numTriangles);
         edgeData->triangleFaceNormals.resize(numTriangles);
         edgeData->triangleLightFacings.resize(numTriangles);
+        edgeData->triangleLightFacingMask.resize((numTriangles + 31) / 32);
         // unsigned long numEdgeGroups
         uint32 numEdgeGroups;
         readInts(stream, &numEdgeGroups, 1);
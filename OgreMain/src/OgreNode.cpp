@@ -40,11 +40,13 @@ THE SOFTWARE.
 #include "OgreTechnique.h"
 #include "OgrePass.h"
 #include "OgreManualObject.h"
+#include "OgreTransformPool.h"
 
 namespace Ogre {
 
     NameGenerator Node::msNameGenerator("Unnamed_");
 	Node::QueuedUpdates Node::msQueuedUpdates;
+	OGRE_STATIC_MUTEX_INSTANCE(Node::msQueuedUpdatesMutex)
     //-----------------------------------------------------------------------
     Node::Node()
 		:mParent(0),
@@ -65,7 +67,9 @@ namespace Ogre {
 		mInitialScale(Vector3::UNIT_SCALE),
 		mCachedTransformOutOfDate(true),
 		mListener(0), 
-		mDebug(0)
+		mDebug(0),
+		mTransformPool(0),
+		mTransformPoolIndex(0)
     {
         // Generate a name
         mName = msNameGenerator.generate();
@@ -95,7 +99,9 @@ namespace Ogre {
 		mInitialScale(Vector3::UNIT_SCALE),
 		mCachedTransformOutOfDate(true),
 		mListener(0), 
-		mDebug(0)
+		mDebug(0),
+		mTransformPool(0),
+		mTransformPoolIndex(0)
 
     {
 
@@ -109,6 +115,12 @@ namespace Ogre {
 		OGRE_DELETE mDebug;
 		mDebug = 0;
 
+		if (mTransformPool)
+		{
+			mTransformPool->_notifyNodeDestroyed(mTransformPoolIndex);
+			mTransformPool = 0;
+		}
+
 		// Call listener (note, only called if there's something to do)
 		if (mListener)
 		{
@@ -121,6 +133,7 @@ namespace Ogre {
 
         if (mQueuedForUpdate)
         {
+            OGRE_LOCK_MUTEX(msQueuedUpdatesMutex)
             // Erase from queued updates
             QueuedUpdates::iterator it =
                 std::find(msQueuedUpdates.begin(), msQueuedUpdates.end(), this);
@@ -145,6 +158,15 @@ namespace Ogre {
     {
 		bool different = (parent != mParent);
 
+		// The layout of any transform pool we're in or joining changes
+		if (different)
+		{
+			if (mTransformPool)
+				mTransformPool->_notifyHierarchyChanged();
+			if (parent && parent->mTransformPool)
+				parent->mTransformPool->_notifyHierarchyChanged();
+		}
+
         mParent = parent;
         // Request update from parent
 		mParentNotified = false ;
@@ -225,6 +247,55 @@ namespace Ogre {
         mNeedChildUpdate = false;
 
     }
+	//-----------------------------------------------------------------------
+	void Node::setDerivedTransform(const Vector3& position,
+		const Quaternion& orientation, const Vector3& scale)
+	{
+		mDerivedPosition = position;
+		mDerivedOrientation = orientation;
+		mDerivedScale = scale;
+		mCachedTransformOutOfDate = true;
+		mNeedParentUpdate = false;
+
+		// Call listener, as _updateFromParent would
+		if (mListener)
+		{
+			mListener->nodeUpdated(this);
+		}
+	}
+	//-----------------------------------------------------------------------
+	void Node::_updateDeferred(bool parentHasChanged, DeferredUpdateList& deferred)
+	{
+		// Same as _update(true, parentHasChanged), except for the recursion
+		mParentNotified = false ;
+
+        if (mNeedParentUpdate || parentHasChanged)
+        {
+            _updateFromParent();
+		}
+
+		if (mNeedChildUpdate || parentHasChanged)
+		{
+            ChildNodeMap::iterator it, itend;
+			itend = mChildren.end();
+            for (it = mChildren.begin(); it != itend; ++it)
+            {
+                deferred.push_back(DeferredUpdate(it->second, true));
+            }
+        }
+        else
+        {
+            ChildUpdateSet::iterator it, itend;
+			itend = mChildrenToUpdate.end();
+            for(it = mChildrenToUpdate.begin(); it != itend; ++it)
+            {
+                deferred.push_back(DeferredUpdate(*it, false));
+            }
+        }
+
+        mChildrenToUpdate.clear();
+        mNeedChildUpdate = false;
+	}
 	//-----------------------------------------------------------------------
 	void Node::_updateFromParent(void) const
 	{
@@ -783,6 +854,9 @@ namespace Ogre {
 		mNeedChildUpdate = true;
         mCachedTransformOutOfDate = true;
 
+		if (mTransformPool)
+			mTransformPool->_notifyNodeDirty(mTransformPoolIndex);
+
         // Make sure we're not root and parent hasn't been notified before
         if (mParent && (!mParentNotified || forceParentUpdate))
         {
@@ -826,6 +900,7 @@ namespace Ogre {
 	//-----------------------------------------------------------------------
 	void Node::queueNeedUpdate(Node* n)
 	{
+        OGRE_LOCK_MUTEX(msQueuedUpdatesMutex)
         // Don't queue the node more than once
         if (!n->mQueuedForUpdate)
         {
@@ -836,6 +911,7 @@ namespace Ogre {
 	//-----------------------------------------------------------------------
 	void Node::processQueuedUpdates(void)
 	{
+		OGRE_LOCK_MUTEX(msQueuedUpdatesMutex)
 		for (QueuedUpdates::iterator i = msQueuedUpdates.begin();
 			i != msQueuedUpdates.end(); ++i)
 		{
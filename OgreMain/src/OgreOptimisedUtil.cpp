@@ -340,6 +340,318 @@ namespace Ogre {
             ++index;    // So we can put break point here even if in release build
         }
 
+        /// @copydoc OptimisedUtil::transformAffineVertices
+        virtual void transformAffineVertices(
+            const Matrix4& matrix,
+            const float* srcPtr,
+            size_t srcStride,
+            float* destPtr,
+            size_t destStride,
+            size_t numVertices,
+            bool directions)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->transformAffineVertices(
+                matrix,
+                srcPtr,
+                srcStride,
+                destPtr,
+                destStride,
+                numVertices,
+                directions);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::calculateLightFacingMask
+        virtual void calculateLightFacingMask(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            uint32* lightFacingMask,
+            size_t numFaces)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->calculateLightFacingMask(
+                lightPos,
+                faceNormals,
+                lightFacingMask,
+                numFaces);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::findSilhouetteEdges
+        virtual size_t findSilhouetteEdges(
+            const uint32* lightFacingMask,
+            const EdgeData::Edge* edges,
+            size_t numEdges,
+            uint32* silhouetteEdges)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            size_t numSilhouetteEdges = impl->findSilhouetteEdges(
+                lightFacingMask,
+                edges,
+                numEdges,
+                silhouetteEdges);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            return numSilhouetteEdges;
+        }
+
+        /// @copydoc OptimisedUtil::calculateDerivedTransforms
+        virtual void calculateDerivedTransforms(
+            const TransformArrays& parentTransforms,
+            const TransformArrays& localTransforms,
+            const TransformArrays& derivedTransforms,
+            size_t numNodes)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->calculateDerivedTransforms(
+                parentTransforms,
+                localTransforms,
+                derivedTransforms,
+                numNodes);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const AxisAlignedBoxArrays& boxes,
+            uint32* visibility,
+            size_t numBoxes)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->cullAxisAlignedBoxes(
+                planes,
+                numPlanes,
+                boxes,
+                visibility,
+                numBoxes);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        virtual void cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const SphereArrays& spheres,
+            uint32* visibility,
+            size_t numSpheres)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->cullSpheres(
+                planes,
+                numPlanes,
+                spheres,
+                visibility,
+                numSpheres);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::nlerpQuaternions
+        virtual void nlerpQuaternions(
+            const QuaternionArrays& from,
+            const QuaternionArrays& to,
+            const float* t,
+            const QuaternionArrays& result,
+            size_t count,
+            bool shortestPath)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->nlerpQuaternions(
+                from,
+                to,
+                t,
+                result,
+                count,
+                shortestPath);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::accumulateScaled
+        virtual void accumulateScaled(
+            float* dest,
+            const float* src,
+            float scale,
+            size_t count)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->accumulateScaled(
+                dest,
+                src,
+                scale,
+                count);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::scaleOffsetClamp
+        virtual void scaleOffsetClamp(
+            float* values,
+            size_t count,
+            float scale,
+            float offset,
+            float minValue,
+            float maxValue)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->scaleOffsetClamp(
+                values,
+                count,
+                scale,
+                offset,
+                minValue,
+                maxValue);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::generateQuadVertices
+        virtual void generateQuadVertices(
+            const float* centres,
+            const float* offsets,
+            size_t offsetStride,
+            const uint32* colours,
+            const float* texCoords,
+            float* dest,
+            size_t numQuads)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->generateQuadVertices(
+                centres,
+                offsets,
+                offsetStride,
+                colours,
+                texCoords,
+                dest,
+                numQuads);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        /// @copydoc OptimisedUtil::calculateHeightfieldNormals
+        virtual void calculateHeightfieldNormals(
+            const float* heights,
+            size_t rowStride,
+            float spacing,
+            float* normals,
+            size_t count)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->calculateHeightfieldNormals(
+                heights,
+                rowStride,
+                spacing,
+                normals,
+                count);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
     };
 #endif // __DO_PROFILE__
 
@@ -31,6 +31,8 @@ THE SOFTWARE.
 
 #include "OgreVector3.h"
 #include "OgreMatrix4.h"
+#include "OgreQuaternion.h"
+#include "OgrePlane.h"
 
 namespace Ogre {
 
@@ -85,6 +87,20 @@ namespace Ogre {
             char* lightFacings,
             size_t numFaces);
 
+        /// @copydoc OptimisedUtil::calculateLightFacingMask
+        virtual void calculateLightFacingMask(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            uint32* lightFacingMask,
+            size_t numFaces);
+
+        /// @copydoc OptimisedUtil::findSilhouetteEdges
+        virtual size_t findSilhouetteEdges(
+            const uint32* lightFacingMask,
+            const EdgeData::Edge* edges,
+            size_t numEdges,
+            uint32* silhouetteEdges);
+
         /// @copydoc OptimisedUtil::extrudeVertices
         virtual void extrudeVertices(
             const Vector4& lightPos,
@@ -92,6 +108,75 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::transformAffineVertices
+        virtual void transformAffineVertices(
+            const Matrix4& matrix,
+            const float* srcPtr,
+            size_t srcStride,
+            float* destPtr,
+            size_t destStride,
+            size_t numVertices,
+            bool directions);
+
+        /// @copydoc OptimisedUtil::calculateDerivedTransforms
+        virtual void calculateDerivedTransforms(
+            const TransformArrays& parentTransforms,
+            const TransformArrays& localTransforms,
+            const TransformArrays& derivedTransforms,
+            size_t numNodes);
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const AxisAlignedBoxArrays& boxes,
+            uint32* visibility,
+            size_t numBoxes);
+        /// @copydoc OptimisedUtil::cullSpheres
+        virtual void cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const SphereArrays& spheres,
+            uint32* visibility,
+            size_t numSpheres);
+        /// @copydoc OptimisedUtil::nlerpQuaternions
+        virtual void nlerpQuaternions(
+            const QuaternionArrays& from,
+            const QuaternionArrays& to,
+            const float* t,
+            const QuaternionArrays& result,
+            size_t count,
+            bool shortestPath);
+        /// @copydoc OptimisedUtil::accumulateScaled
+        virtual void accumulateScaled(
+            float* dest,
+            const float* src,
+            float scale,
+            size_t count);
+        /// @copydoc OptimisedUtil::scaleOffsetClamp
+        virtual void scaleOffsetClamp(
+            float* values,
+            size_t count,
+            float scale,
+            float offset,
+            float minValue,
+            float maxValue);
+        /// @copydoc OptimisedUtil::generateQuadVertices
+        virtual void generateQuadVertices(
+            const float* centres,
+            const float* offsets,
+            size_t offsetStride,
+            const uint32* colours,
+            const float* texCoords,
+            float* dest,
+            size_t numQuads);
+        /// @copydoc OptimisedUtil::calculateHeightfieldNormals
+        virtual void calculateHeightfieldNormals(
+            const float* heights,
+            size_t rowStride,
+            float spacing,
+            float* normals,
+            size_t count);
     };
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -315,6 +400,54 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::calculateLightFacingMask(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        uint32* lightFacingMask,
+        size_t numFaces)
+    {
+        memset(lightFacingMask, 0, sizeof(uint32) * ((numFaces + 31) / 32));
+
+        for (size_t i = 0; i < numFaces; ++i)
+        {
+            if (lightPos.dotProduct(faceNormals[i]) > 0)
+                lightFacingMask[i >> 5] |= 1u << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t OptimisedUtilGeneral::findSilhouetteEdges(
+        const uint32* lightFacingMask,
+        const EdgeData::Edge* edges,
+        size_t numEdges,
+        uint32* silhouetteEdges)
+    {
+        uint32* pDest = silhouetteEdges;
+        for (size_t i = 0; i < numEdges; ++i)
+        {
+            const EdgeData::Edge& edge = edges[i];
+
+            // A degenerate edge only has tri 0, so compare it against 'not
+            // light facing' instead
+            size_t t0 = edge.triIndex[0];
+            size_t t1 = edge.degenerate ? t0 : edge.triIndex[1];
+            uint32 notDegenerate = edge.degenerate ? 0 : 1;
+            uint32 f0 = (lightFacingMask[t0 >> 5] >> (t0 & 31)) & 1;
+            uint32 f1 = (lightFacingMask[t1 >> 5] >> (t1 & 31)) & notDegenerate;
+
+            // Always store the edge, but only keep it by moving on if it's a
+            // silhouette, so there are no hard to predict branches. Indexes
+            // run backwards when tri 1 is the light facing one.
+            uint32 v0 = static_cast<uint32>(edge.vertIndex[0]);
+            uint32 v1 = static_cast<uint32>(edge.vertIndex[1]);
+            uint32 swap = (v0 ^ v1) & (f0 - 1);
+            pDest[0] = v0 ^ swap;
+            pDest[1] = v1 ^ swap;
+            pDest += (f0 ^ f1) << 1;
+        }
+
+        return static_cast<size_t>(pDest - silhouetteEdges) >> 1;
+    }
+    //---------------------------------------------------------------------
     void OptimisedUtilGeneral::extrudeVertices(
         const Vector4& lightPos,
         Real extrudeDist,
@@ -361,6 +494,275 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::transformAffineVertices(
+        const Matrix4& m,
+        const float* pSrc,
+        size_t srcStride,
+        float* pDest,
+        size_t destStride,
+        size_t numVertices,
+        bool directions)
+    {
+        assert(m.isAffine());
+
+        for (size_t v = 0; v < numVertices; ++v)
+        {
+            Vector3 src(pSrc[0], pSrc[1], pSrc[2]);
+            Vector3 dest(
+                m[0][0] * src.x + m[0][1] * src.y + m[0][2] * src.z,
+                m[1][0] * src.x + m[1][1] * src.y + m[1][2] * src.z,
+                m[2][0] * src.x + m[2][1] * src.y + m[2][2] * src.z);
+            if (directions)
+            {
+                dest.normalise();
+            }
+            else
+            {
+                dest.x += m[0][3];
+                dest.y += m[1][3];
+                dest.z += m[2][3];
+            }
+
+            pDest[0] = dest.x;
+            pDest[1] = dest.y;
+            pDest[2] = dest.z;
+
+            advanceRawPointer(pSrc, srcStride);
+            advanceRawPointer(pDest, destStride);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::calculateDerivedTransforms(
+        const TransformArrays& parent,
+        const TransformArrays& local,
+        const TransformArrays& derived,
+        size_t numNodes)
+    {
+        for (size_t i = 0; i < numNodes; ++i)
+        {
+            // Same calculation as Node::updateFromParentImpl
+            Quaternion parentOrientation(parent.rotW[i], parent.rotX[i], parent.rotY[i], parent.rotZ[i]);
+            Vector3 parentScale(parent.scaleX[i], parent.scaleY[i], parent.scaleZ[i]);
+
+            Quaternion orientation = parentOrientation *
+                Quaternion(local.rotW[i], local.rotX[i], local.rotY[i], local.rotZ[i]);
+            Vector3 scale = parentScale *
+                Vector3(local.scaleX[i], local.scaleY[i], local.scaleZ[i]);
+            Vector3 position = parentOrientation *
+                (parentScale * Vector3(local.posX[i], local.posY[i], local.posZ[i]));
+            position += Vector3(parent.posX[i], parent.posY[i], parent.posZ[i]);
+
+            derived.rotW[i] = orientation.w;
+            derived.rotX[i] = orientation.x;
+            derived.rotY[i] = orientation.y;
+            derived.rotZ[i] = orientation.z;
+            derived.scaleX[i] = scale.x;
+            derived.scaleY[i] = scale.y;
+            derived.scaleZ[i] = scale.z;
+            derived.posX[i] = position.x;
+            derived.posY[i] = position.y;
+            derived.posZ[i] = position.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::cullAxisAlignedBoxes(
+        const Plane* planes,
+        size_t numPlanes,
+        const AxisAlignedBoxArrays& boxes,
+        uint32* visibility,
+        size_t numBoxes)
+    {
+        memset(visibility, 0, sizeof(uint32) * ((numBoxes + 31) / 32));
+
+        for (size_t i = 0; i < numBoxes; ++i)
+        {
+            Vector3 centre(boxes.centreX[i], boxes.centreY[i], boxes.centreZ[i]);
+            Vector3 halfSize(boxes.halfSizeX[i], boxes.halfSizeY[i], boxes.halfSizeZ[i]);
+
+            // Same test as Frustum::isVisible
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                if (planes[p].getSide(centre, halfSize) == Plane::NEGATIVE_SIDE)
+                {
+                    visible = false;
+                    break;
+                }
+            }
+
+            if (visible)
+                visibility[i >> 5] |= 1u << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const SphereArrays& spheres,
+        uint32* visibility,
+        size_t numSpheres)
+    {
+        memset(visibility, 0, sizeof(uint32) * ((numSpheres + 31) / 32));
+
+        for (size_t i = 0; i < numSpheres; ++i)
+        {
+            Vector3 centre(spheres.centreX[i], spheres.centreY[i], spheres.centreZ[i]);
+            Real radius = spheres.radius[i];
+
+            // Same test as Frustum::isVisible
+            bool visible = true;
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                if (planes[p].getDistance(centre) < -radius)
+                {
+                    visible = false;
+                    break;
+                }
+            }
+
+            if (visible)
+                visibility[i >> 5] |= 1u << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::nlerpQuaternions(
+        const QuaternionArrays& from,
+        const QuaternionArrays& to,
+        const float* t,
+        const QuaternionArrays& result,
+        size_t count,
+        bool shortestPath)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Quaternion q = Quaternion::nlerp(t[i],
+                Quaternion(from.w[i], from.x[i], from.y[i], from.z[i]),
+                Quaternion(to.w[i], to.x[i], to.y[i], to.z[i]),
+                shortestPath);
+            result.w[i] = q.w;
+            result.x[i] = q.x;
+            result.y[i] = q.y;
+            result.z[i] = q.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::accumulateScaled(
+        float* dest,
+        const float* src,
+        float scale,
+        size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dest[i] += src[i] * scale;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::scaleOffsetClamp(
+        float* values,
+        size_t count,
+        float scale,
+        float offset,
+        float minValue,
+        float maxValue)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float v = values[i] * scale + offset;
+            values[i] = std::min(std::max(v, minValue), maxValue);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::generateQuadVertices(
+        const float* centres,
+        const float* offsets,
+        size_t offsetStride,
+        const uint32* colours,
+        const float* texCoords,
+        float* dest,
+        size_t numQuads)
+    {
+        for (size_t i = 0; i < numQuads; ++i)
+        {
+            // Texture coordinates of the corners, in vertex order
+            const float u[4] = { texCoords[0], texCoords[2], texCoords[0], texCoords[2] };
+            const float v[4] = { texCoords[1], texCoords[1], texCoords[3], texCoords[3] };
+
+            for (size_t corner = 0; corner < 4; ++corner)
+            {
+                const float* offset = offsets + corner * 4;
+                dest[0] = centres[0] + offset[0];
+                dest[1] = centres[1] + offset[1];
+                dest[2] = centres[2] + offset[2];
+                *reinterpret_cast<uint32*>(dest + 3) = *colours;
+                dest[4] = u[corner];
+                dest[5] = v[corner];
+                dest += 6;
+            }
+
+            centres += 4;
+            offsets += offsetStride;
+            ++colours;
+            texCoords += 4;
+        }
+    }
+    //---------------------------------------------------------------------
+    static FORCEINLINE void addUnitNormal(float nx, float ny, float nz, float* sum)
+    {
+        float invLength = 1.0f / Math::Sqrt(nx * nx + ny * ny + nz * nz);
+        sum[0] += nx * invLength;
+        sum[1] += ny * invLength;
+        sum[2] += nz * invLength;
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::calculateHeightfieldNormals(
+        const float* heights,
+        size_t rowStride,
+        float spacing,
+        float* normals,
+        size_t count)
+    {
+        const float* below = heights - rowStride;
+        const float* above = heights + rowStride;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Neighbours relative to the centre, anticlockwise from +x
+            //  3---2---1
+            //  | \ | / |
+            //  4---P---0
+            //  | / | \ |
+            //  5---6---7
+            float c = heights[i];
+            float h0 = heights[i + 1] - c;
+            float h1 = above[i + 1] - c;
+            float h2 = above[i] - c;
+            float h3 = above[i - 1] - c;
+            float h4 = heights[i - 1] - c;
+            float h5 = below[i - 1] - c;
+            float h6 = below[i] - c;
+            float h7 = below[i + 1] - c;
+
+            // The cross products of consecutive neighbours reduce to these,
+            // the grid spacing being the same for each
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            addUnitNormal(-h0, h0 - h1, spacing, sum);
+            addUnitNormal(h2 - h1, -h2, spacing, sum);
+            addUnitNormal(h3 - h2, -h2, spacing, sum);
+            addUnitNormal(h4, h4 - h3, spacing, sum);
+            addUnitNormal(h4, h5 - h4, spacing, sum);
+            addUnitNormal(h5 - h6, h6, spacing, sum);
+            addUnitNormal(h6 - h7, h6, spacing, sum);
+            addUnitNormal(-h0, h7 - h0, spacing, sum);
+
+            float invLength = 1.0f / Math::Sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+            normals[0] = sum[0] * invLength;
+            normals[1] = sum[1] * invLength;
+            normals[2] = sum[2] * invLength;
+            normals += 3;
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilGeneral(void)
@@ -33,6 +33,8 @@ THE SOFTWARE.
 #if __OGRE_HAVE_SSE
 
 #include "OgreMatrix4.h"
+#include "OgrePlane.h"
+#include "OgreQuaternion.h"
 
 // Should keep this includes at latest to avoid potential "xmmintrin.h" included by
 // other header file on some platform for some reason.
@@ -65,6 +67,8 @@ THE SOFTWARE.
 
 namespace Ogre {
 
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+
 //-------------------------------------------------------------------------
 // Local classes
 //-------------------------------------------------------------------------
@@ -123,6 +127,20 @@ namespace Ogre {
             char* lightFacings,
             size_t numFaces);
 
+        /// @copydoc OptimisedUtil::calculateLightFacingMask
+        virtual void calculateLightFacingMask(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            uint32* lightFacingMask,
+            size_t numFaces);
+
+        /// @copydoc OptimisedUtil::findSilhouetteEdges
+        virtual size_t findSilhouetteEdges(
+            const uint32* lightFacingMask,
+            const EdgeData::Edge* edges,
+            size_t numEdges,
+            uint32* silhouetteEdges);
+
         /// @copydoc OptimisedUtil::extrudeVertices
         virtual void extrudeVertices(
             const Vector4& lightPos,
@@ -130,6 +148,75 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::transformAffineVertices
+        virtual void transformAffineVertices(
+            const Matrix4& matrix,
+            const float* srcPtr,
+            size_t srcStride,
+            float* destPtr,
+            size_t destStride,
+            size_t numVertices,
+            bool directions);
+
+        /// @copydoc OptimisedUtil::calculateDerivedTransforms
+        virtual void calculateDerivedTransforms(
+            const TransformArrays& parentTransforms,
+            const TransformArrays& localTransforms,
+            const TransformArrays& derivedTransforms,
+            size_t numNodes);
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const AxisAlignedBoxArrays& boxes,
+            uint32* visibility,
+            size_t numBoxes);
+        /// @copydoc OptimisedUtil::cullSpheres
+        virtual void cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const SphereArrays& spheres,
+            uint32* visibility,
+            size_t numSpheres);
+        /// @copydoc OptimisedUtil::nlerpQuaternions
+        virtual void nlerpQuaternions(
+            const QuaternionArrays& from,
+            const QuaternionArrays& to,
+            const float* t,
+            const QuaternionArrays& result,
+            size_t count,
+            bool shortestPath);
+        /// @copydoc OptimisedUtil::accumulateScaled
+        virtual void accumulateScaled(
+            float* dest,
+            const float* src,
+            float scale,
+            size_t count);
+        /// @copydoc OptimisedUtil::scaleOffsetClamp
+        virtual void scaleOffsetClamp(
+            float* values,
+            size_t count,
+            float scale,
+            float offset,
+            float minValue,
+            float maxValue);
+        /// @copydoc OptimisedUtil::generateQuadVertices
+        virtual void generateQuadVertices(
+            const float* centres,
+            const float* offsets,
+            size_t offsetStride,
+            const uint32* colours,
+            const float* texCoords,
+            float* dest,
+            size_t numQuads);
+        /// @copydoc OptimisedUtil::calculateHeightfieldNormals
+        virtual void calculateHeightfieldNormals(
+            const float* heights,
+            size_t rowStride,
+            float spacing,
+            float* normals,
+            size_t count);
     };
 
 #if defined(__OGRE_SIMD_ALIGN_STACK)
@@ -248,6 +335,36 @@ namespace Ogre {
                 numFaces);
         }
 
+        /// @copydoc OptimisedUtil::calculateLightFacingMask
+        virtual void calculateLightFacingMask(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            uint32* lightFacingMask,
+            size_t numFaces)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->calculateLightFacingMask(
+                lightPos,
+                faceNormals,
+                lightFacingMask,
+                numFaces);
+        }
+
+        /// @copydoc OptimisedUtil::findSilhouetteEdges
+        virtual size_t findSilhouetteEdges(
+            const uint32* lightFacingMask,
+            const EdgeData::Edge* edges,
+            size_t numEdges,
+            uint32* silhouetteEdges)
+        {
+            return mImpl->findSilhouetteEdges(
+                lightFacingMask,
+                edges,
+                numEdges,
+                silhouetteEdges);
+        }
+
         /// @copydoc OptimisedUtil::extrudeVertices
         virtual void extrudeVertices(
             const Vector4& lightPos,
@@ -265,6 +382,176 @@ namespace Ogre {
                 destPositions,
                 numVertices);
         }
+
+        /// @copydoc OptimisedUtil::transformAffineVertices
+        virtual void transformAffineVertices(
+            const Matrix4& matrix,
+            const float* srcPtr,
+            size_t srcStride,
+            float* destPtr,
+            size_t destStride,
+            size_t numVertices,
+            bool directions)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->transformAffineVertices(
+                matrix,
+                srcPtr,
+                srcStride,
+                destPtr,
+                destStride,
+                numVertices,
+                directions);
+        }
+
+        /// @copydoc OptimisedUtil::calculateDerivedTransforms
+        virtual void calculateDerivedTransforms(
+            const TransformArrays& parentTransforms,
+            const TransformArrays& localTransforms,
+            const TransformArrays& derivedTransforms,
+            size_t numNodes)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->calculateDerivedTransforms(
+                parentTransforms,
+                localTransforms,
+                derivedTransforms,
+                numNodes);
+        }
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const AxisAlignedBoxArrays& boxes,
+            uint32* visibility,
+            size_t numBoxes)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->cullAxisAlignedBoxes(
+                planes,
+                numPlanes,
+                boxes,
+                visibility,
+                numBoxes);
+        }
+
+        /// @copydoc OptimisedUtil::cullSpheres
+        virtual void cullSpheres(
+            const Plane* planes,
+            size_t numPlanes,
+            const SphereArrays& spheres,
+            uint32* visibility,
+            size_t numSpheres)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->cullSpheres(
+                planes,
+                numPlanes,
+                spheres,
+                visibility,
+                numSpheres);
+        }
+
+        /// @copydoc OptimisedUtil::nlerpQuaternions
+        virtual void nlerpQuaternions(
+            const QuaternionArrays& from,
+            const QuaternionArrays& to,
+            const float* t,
+            const QuaternionArrays& result,
+            size_t count,
+            bool shortestPath)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->nlerpQuaternions(
+                from,
+                to,
+                t,
+                result,
+                count,
+                shortestPath);
+        }
+
+        /// @copydoc OptimisedUtil::accumulateScaled
+        virtual void accumulateScaled(
+            float* dest,
+            const float* src,
+            float scale,
+            size_t count)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->accumulateScaled(
+                dest,
+                src,
+                scale,
+                count);
+        }
+
+        /// @copydoc OptimisedUtil::scaleOffsetClamp
+        virtual void scaleOffsetClamp(
+            float* values,
+            size_t count,
+            float scale,
+            float offset,
+            float minValue,
+            float maxValue)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->scaleOffsetClamp(
+                values,
+                count,
+                scale,
+                offset,
+                minValue,
+                maxValue);
+        }
+
+        /// @copydoc OptimisedUtil::generateQuadVertices
+        virtual void generateQuadVertices(
+            const float* centres,
+            const float* offsets,
+            size_t offsetStride,
+            const uint32* colours,
+            const float* texCoords,
+            float* dest,
+            size_t numQuads)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->generateQuadVertices(
+                centres,
+                offsets,
+                offsetStride,
+                colours,
+                texCoords,
+                dest,
+                numQuads);
+        }
+
+        /// @copydoc OptimisedUtil::calculateHeightfieldNormals
+        virtual void calculateHeightfieldNormals(
+            const float* heights,
+            size_t rowStride,
+            float spacing,
+            float* normals,
+            size_t count)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->calculateHeightfieldNormals(
+                heights,
+                rowStride,
+                spacing,
+                normals,
+                count);
+        }
     };
 #endif  // !defined(__OGRE_SIMD_ALIGN_STACK)
 
@@ -1798,6 +2085,75 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilSSE::calculateLightFacingMask(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        uint32* lightFacingMask,
+        size_t numFaces)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(faceNormals));
+
+        __m128 n0, n1, n2, n3;
+        __m128 t0, t1;
+        __m128 dp;
+
+        // Load light vector, unaligned
+        __m128 lp = _mm_loadu_ps(&lightPos.x);
+
+        __m128 zero = _mm_setzero_ps();
+
+        // Bits are or'ed in four at a time
+        memset(lightFacingMask, 0, sizeof(uint32) * ((numFaces + 31) / 32));
+
+        // Four faces per iteration, the faces past the end of the array are
+        // zero, which isn't light facing
+        for (size_t i = 0; i < numFaces; i += 4)
+        {
+            size_t remaining = numFaces - i;
+            n0 = __MM_LOAD_PS(&faceNormals[i].x);
+            n1 = remaining > 1 ? __MM_LOAD_PS(&faceNormals[i + 1].x) : zero;
+            n2 = remaining > 2 ? __MM_LOAD_PS(&faceNormals[i + 2].x) : zero;
+            n3 = remaining > 3 ? __MM_LOAD_PS(&faceNormals[i + 3].x) : zero;
+
+            // Multiply by light vector
+            n0 = _mm_mul_ps(n0, lp);        // x0 y0 z0 w0
+            n1 = _mm_mul_ps(n1, lp);        // x1 y1 z1 w1
+            n2 = _mm_mul_ps(n2, lp);        // x2 y2 z2 w2
+            n3 = _mm_mul_ps(n3, lp);        // x3 y3 z3 w3
+
+            // Horizontal add four vector values, the same way as
+            // calculateLightFacing so the results agree
+            t0 = _mm_add_ps(                                            // x0+z0 x1+z1 y0+w0 y1+w1
+                _mm_unpacklo_ps(n0, n1),    // x0 x1 y0 y1
+                _mm_unpackhi_ps(n0, n1));   // z0 z1 w0 w1
+            t1 = _mm_add_ps(                                            // x2+z2 x3+z3 y2+w2 y3+w3
+                _mm_unpacklo_ps(n2, n3),    // x2 x3 y2 y3
+                _mm_unpackhi_ps(n2, n3));   // z2 z3 w2 w3
+            dp = _mm_add_ps(                                            // dp0 dp1 dp2 dp3
+                _mm_movelh_ps(t0, t1),      // x0+z0 x1+z1 x2+z2 x3+z3
+                _mm_movehl_ps(t1, t0));     // y0+w0 y1+w1 y2+w2 y3+w3
+
+            // Four bits straight from the sign mask, 'i' is a multiple of 4
+            // so they never straddle two masks
+            uint32 bitmask = (uint32)_mm_movemask_ps(_mm_cmpnle_ps(dp, zero));
+            lightFacingMask[i >> 5] |= bitmask << (i & 31);
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t OptimisedUtilSSE::findSilhouetteEdges(
+        const uint32* lightFacingMask,
+        const EdgeData::Edge* edges,
+        size_t numEdges,
+        uint32* silhouetteEdges)
+    {
+        // Edges are integer structures, which SSE (as opposed to SSE2) has
+        // no instructions for, so use the branchless general version
+        return _getOptimisedUtilGeneral()->findSilhouetteEdges(
+            lightFacingMask, edges, numEdges, silhouetteEdges);
+    }
+    //---------------------------------------------------------------------
     // Template to extrude vertices for directional light.
     template <bool srcAligned, bool destAligned>
     struct ExtrudeVertices_SSE_DirectionalLight
@@ -2061,6 +2417,656 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    template <bool directions>
+    struct TransformAffineVertices_SSE
+    {
+        static void apply(
+            const Matrix4& m,
+            const float* pSrc,
+            size_t srcStride,
+            float* pDest,
+            size_t destStride,
+            size_t numVertices)
+        {
+            // Each vector is x * col0 + y * col1 + z * col2 (+ col3)
+            const float cols[4][4] =
+            {
+                { m[0][0], m[1][0], m[2][0], 0.0f },
+                { m[0][1], m[1][1], m[2][1], 0.0f },
+                { m[0][2], m[1][2], m[2][2], 0.0f },
+                { m[0][3], m[1][3], m[2][3], 0.0f },
+            };
+            __m128 col0 = _mm_loadu_ps(cols[0]);
+            __m128 col1 = _mm_loadu_ps(cols[1]);
+            __m128 col2 = _mm_loadu_ps(cols[2]);
+            __m128 col3 = _mm_loadu_ps(cols[3]);
+            __m128 zero = _mm_setzero_ps();
+
+            for (size_t v = 0; v < numVertices; ++v)
+            {
+                __m128 r = directions ?
+                    __MM_DOT3x3_PS(col0, col1, col2,
+                        _mm_load_ps1(pSrc + 0), _mm_load_ps1(pSrc + 1), _mm_load_ps1(pSrc + 2)) :
+                    __MM_DOT4x3_PS(col0, col1, col2, col3,
+                        _mm_load_ps1(pSrc + 0), _mm_load_ps1(pSrc + 1), _mm_load_ps1(pSrc + 2));
+
+                if (directions)
+                {
+                    // Length squared (w is always zero) broadcast to all lanes
+                    __m128 sq = _mm_mul_ps(r, r);
+                    sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
+                    sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1)));
+                    sq = _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(0, 0, 0, 0));
+                    // Zero length vectors are left alone, like Vector3::normalise,
+                    // masking out the NaNs from the infinite reciprocal
+                    __m128 valid = _mm_cmpnle_ps(sq, zero);
+                    r = _mm_and_ps(valid, _mm_mul_ps(r, __MM_RSQRT_PS(sq)));
+                }
+
+                _mm_storel_pi((__m64*)pDest, r);
+                _mm_store_ss(pDest + 2, _mm_movehl_ps(r, r));
+
+                advanceRawPointer(pSrc, srcStride);
+                advanceRawPointer(pDest, destStride);
+            }
+        }
+    };
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::transformAffineVertices(
+        const Matrix4& matrix,
+        const float* pSrc,
+        size_t srcStride,
+        float* pDest,
+        size_t destStride,
+        size_t numVertices,
+        bool directions)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(matrix.isAffine());
+
+        if (directions)
+            TransformAffineVertices_SSE<true>::apply(
+                matrix, pSrc, srcStride, pDest, destStride, numVertices);
+        else
+            TransformAffineVertices_SSE<false>::apply(
+                matrix, pSrc, srcStride, pDest, destStride, numVertices);
+    }
+    //---------------------------------------------------------------------
+    /// Scalar version of the derived transform calculation for a single node
+    static FORCEINLINE void _calculateDerivedTransform(
+        const TransformArrays& parent,
+        const TransformArrays& local,
+        const TransformArrays& derived,
+        size_t i)
+    {
+        float pw = parent.rotW[i], px = parent.rotX[i], py = parent.rotY[i], pz = parent.rotZ[i];
+        float lw = local.rotW[i], lx = local.rotX[i], ly = local.rotY[i], lz = local.rotZ[i];
+
+        derived.rotW[i] = pw * lw - px * lx - py * ly - pz * lz;
+        derived.rotX[i] = pw * lx + px * lw + py * lz - pz * ly;
+        derived.rotY[i] = pw * ly + py * lw + pz * lx - px * lz;
+        derived.rotZ[i] = pw * lz + pz * lw + px * ly - py * lx;
+
+        float sx = parent.scaleX[i], sy = parent.scaleY[i], sz = parent.scaleZ[i];
+        derived.scaleX[i] = sx * local.scaleX[i];
+        derived.scaleY[i] = sy * local.scaleY[i];
+        derived.scaleZ[i] = sz * local.scaleZ[i];
+
+        float vx = sx * local.posX[i], vy = sy * local.posY[i], vz = sz * local.posZ[i];
+        float uvx = py * vz - pz * vy, uvy = pz * vx - px * vz, uvz = px * vy - py * vx;
+        float uuvx = py * uvz - pz * uvy, uuvy = pz * uvx - px * uvz, uuvz = px * uvy - py * uvx;
+        float w2 = 2.0f * pw;
+
+        derived.posX[i] = vx + uvx * w2 + uuvx * 2.0f + parent.posX[i];
+        derived.posY[i] = vy + uvy * w2 + uuvy * 2.0f + parent.posY[i];
+        derived.posZ[i] = vz + uvz * w2 + uuvz * 2.0f + parent.posZ[i];
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::calculateDerivedTransforms(
+        const TransformArrays& parent,
+        const TransformArrays& local,
+        const TransformArrays& derived,
+        size_t numNodes)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(parent.posX) && _isAlignedForSSE(parent.rotW) && _isAlignedForSSE(parent.scaleX));
+        assert(_isAlignedForSSE(local.posX) && _isAlignedForSSE(local.rotW) && _isAlignedForSSE(local.scaleX));
+        assert(_isAlignedForSSE(derived.posX) && _isAlignedForSSE(derived.rotW) && _isAlignedForSSE(derived.scaleX));
+
+        const float two1 = 2.0f;
+        const __m128 two = _mm_load_ps1(&two1);
+
+        // Four nodes per iteration, one node per lane, so this is the same
+        // sequence of operations as the scalar version
+        size_t i = 0;
+        for (size_t numIterations = numNodes / 4; numIterations; --numIterations, i += 4)
+        {
+            __m128 pw = __MM_LOAD_PS(parent.rotW + i);
+            __m128 px = __MM_LOAD_PS(parent.rotX + i);
+            __m128 py = __MM_LOAD_PS(parent.rotY + i);
+            __m128 pz = __MM_LOAD_PS(parent.rotZ + i);
+            __m128 lw = __MM_LOAD_PS(local.rotW + i);
+            __m128 lx = __MM_LOAD_PS(local.rotX + i);
+            __m128 ly = __MM_LOAD_PS(local.rotY + i);
+            __m128 lz = __MM_LOAD_PS(local.rotZ + i);
+
+            // Orientation: parent * local
+            __MM_STORE_PS(derived.rotW + i, _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(
+                _mm_mul_ps(pw, lw), _mm_mul_ps(px, lx)), _mm_mul_ps(py, ly)), _mm_mul_ps(pz, lz)));
+            __MM_STORE_PS(derived.rotX + i, _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, lx), _mm_mul_ps(px, lw)), _mm_mul_ps(py, lz)), _mm_mul_ps(pz, ly)));
+            __MM_STORE_PS(derived.rotY + i, _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, ly), _mm_mul_ps(py, lw)), _mm_mul_ps(pz, lx)), _mm_mul_ps(px, lz)));
+            __MM_STORE_PS(derived.rotZ + i, _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, lz), _mm_mul_ps(pz, lw)), _mm_mul_ps(px, ly)), _mm_mul_ps(py, lx)));
+
+            // Scale: parent * local
+            __m128 sx = __MM_LOAD_PS(parent.scaleX + i);
+            __m128 sy = __MM_LOAD_PS(parent.scaleY + i);
+            __m128 sz = __MM_LOAD_PS(parent.scaleZ + i);
+            __MM_STORE_PS(derived.scaleX + i, _mm_mul_ps(sx, __MM_LOAD_PS(local.scaleX + i)));
+            __MM_STORE_PS(derived.scaleY + i, _mm_mul_ps(sy, __MM_LOAD_PS(local.scaleY + i)));
+            __MM_STORE_PS(derived.scaleZ + i, _mm_mul_ps(sz, __MM_LOAD_PS(local.scaleZ + i)));
+
+            // Position: parent orientation * (parent scale * local) + parent position
+            __m128 vx = _mm_mul_ps(sx, __MM_LOAD_PS(local.posX + i));
+            __m128 vy = _mm_mul_ps(sy, __MM_LOAD_PS(local.posY + i));
+            __m128 vz = _mm_mul_ps(sz, __MM_LOAD_PS(local.posZ + i));
+
+            __m128 uvx = _mm_sub_ps(_mm_mul_ps(py, vz), _mm_mul_ps(pz, vy));
+            __m128 uvy = _mm_sub_ps(_mm_mul_ps(pz, vx), _mm_mul_ps(px, vz));
+            __m128 uvz = _mm_sub_ps(_mm_mul_ps(px, vy), _mm_mul_ps(py, vx));
+            __m128 uuvx = _mm_sub_ps(_mm_mul_ps(py, uvz), _mm_mul_ps(pz, uvy));
+            __m128 uuvy = _mm_sub_ps(_mm_mul_ps(pz, uvx), _mm_mul_ps(px, uvz));
+            __m128 uuvz = _mm_sub_ps(_mm_mul_ps(px, uvy), _mm_mul_ps(py, uvx));
+            __m128 w2 = _mm_mul_ps(two, pw);
+
+            __MM_STORE_PS(derived.posX + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(uvx, w2)),
+                _mm_mul_ps(uuvx, two)), __MM_LOAD_PS(parent.posX + i)));
+            __MM_STORE_PS(derived.posY + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(uvy, w2)),
+                _mm_mul_ps(uuvy, two)), __MM_LOAD_PS(parent.posY + i)));
+            __MM_STORE_PS(derived.posZ + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(uvz, w2)),
+                _mm_mul_ps(uuvz, two)), __MM_LOAD_PS(parent.posZ + i)));
+        }
+
+        // Left over nodes
+        for (; i < numNodes; ++i)
+        {
+            _calculateDerivedTransform(parent, local, derived, i);
+        }
+    }
+    //---------------------------------------------------------------------
+    /// Set the visibility masks for a batch of count elements to all visible
+    static FORCEINLINE void _initVisibilityMasks(uint32* visibility, size_t count)
+    {
+        size_t numMasks = (count + 31) / 32;
+        for (size_t m = 0; m < numMasks; ++m)
+            visibility[m] = 0xFFFFFFFF;
+        if (count & 31)
+            visibility[numMasks - 1] = (1u << (count & 31)) - 1;
+    }
+    //---------------------------------------------------------------------
+    /** Planes splatted into registers for the culling functions. They are
+        done a few at a time, which is normally all of them for a frustum. */
+    struct SSECullingPlanes
+    {
+        enum { MAX_PLANES = 8 };
+
+        __m128 nx[MAX_PLANES], ny[MAX_PLANES], nz[MAX_PLANES], d[MAX_PLANES];
+        __m128 absX[MAX_PLANES], absY[MAX_PLANES], absZ[MAX_PLANES];
+        size_t count;
+
+        /// Load up to MAX_PLANES planes starting from 'first'
+        void load(const Plane* planes, size_t first, size_t numPlanes)
+        {
+            count = std::min(numPlanes - first, (size_t)MAX_PLANES);
+            for (size_t p = 0; p < count; ++p)
+            {
+                const Plane& plane = planes[first + p];
+                float x = plane.normal.x, y = plane.normal.y, z = plane.normal.z, w = plane.d;
+                float ax = fabsf(x), ay = fabsf(y), az = fabsf(z);
+                nx[p] = _mm_load_ps1(&x);
+                ny[p] = _mm_load_ps1(&y);
+                nz[p] = _mm_load_ps1(&z);
+                d[p] = _mm_load_ps1(&w);
+                absX[p] = _mm_load_ps1(&ax);
+                absY[p] = _mm_load_ps1(&ay);
+                absZ[p] = _mm_load_ps1(&az);
+            }
+        }
+
+        /// Distance of four points from plane p, as Plane::getDistance
+        FORCEINLINE __m128 distance(size_t p, __m128 x, __m128 y, __m128 z) const
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y)), _mm_mul_ps(nz[p], z)), d[p]);
+        }
+    };
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::cullAxisAlignedBoxes(
+        const Plane* planes,
+        size_t numPlanes,
+        const AxisAlignedBoxArrays& boxes,
+        uint32* visibility,
+        size_t numBoxes)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(boxes.centreX) && _isAlignedForSSE(boxes.centreY) && _isAlignedForSSE(boxes.centreZ));
+        assert(_isAlignedForSSE(boxes.halfSizeX) && _isAlignedForSSE(boxes.halfSizeY) && _isAlignedForSSE(boxes.halfSizeZ));
+
+        // Every box is visible until a plane culls it
+        _initVisibilityMasks(visibility, numBoxes);
+
+        const __m128 zero = _mm_setzero_ps();
+        SSECullingPlanes batch;
+        for (size_t firstPlane = 0; firstPlane < numPlanes; firstPlane += batch.count)
+        {
+            batch.load(planes, firstPlane, numPlanes);
+
+            // Four boxes per iteration, one box per lane, using the same
+            // sequence of operations as Plane::getSide
+            size_t i = 0;
+            for (size_t numIterations = numBoxes / 4; numIterations; --numIterations, i += 4)
+            {
+                __m128 cx = __MM_LOAD_PS(boxes.centreX + i);
+                __m128 cy = __MM_LOAD_PS(boxes.centreY + i);
+                __m128 cz = __MM_LOAD_PS(boxes.centreZ + i);
+                __m128 hx = __MM_LOAD_PS(boxes.halfSizeX + i);
+                __m128 hy = __MM_LOAD_PS(boxes.halfSizeY + i);
+                __m128 hz = __MM_LOAD_PS(boxes.halfSizeZ + i);
+
+                __m128 culled = zero;
+                for (size_t p = 0; p < batch.count; ++p)
+                {
+                    __m128 dist = batch.distance(p, cx, cy, cz);
+                    __m128 maxAbsDist = _mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(batch.absX[p], hx), _mm_mul_ps(batch.absY[p], hy)), _mm_mul_ps(batch.absZ[p], hz));
+                    culled = _mm_or_ps(culled, _mm_cmplt_ps(dist, _mm_sub_ps(zero, maxAbsDist)));
+                }
+
+                uint32 culledBits = (uint32)_mm_movemask_ps(culled);
+                visibility[i >> 5] &= ~(culledBits << (i & 31));
+            }
+
+            // Left over boxes
+            for (; i < numBoxes; ++i)
+            {
+                for (size_t p = 0; p < batch.count; ++p)
+                {
+                    const Plane& plane = planes[firstPlane + p];
+                    float x = plane.normal.x, y = plane.normal.y, z = plane.normal.z;
+                    float dist = x * boxes.centreX[i] + y * boxes.centreY[i] + z * boxes.centreZ[i] + (float)plane.d;
+                    float maxAbsDist = fabsf(x) * boxes.halfSizeX[i] + fabsf(y) * boxes.halfSizeY[i] +
+                        fabsf(z) * boxes.halfSizeZ[i];
+                    if (dist < -maxAbsDist)
+                    {
+                        visibility[i >> 5] &= ~(1u << (i & 31));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::cullSpheres(
+        const Plane* planes,
+        size_t numPlanes,
+        const SphereArrays& spheres,
+        uint32* visibility,
+        size_t numSpheres)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(spheres.centreX) && _isAlignedForSSE(spheres.centreY) &&
+            _isAlignedForSSE(spheres.centreZ) && _isAlignedForSSE(spheres.radius));
+
+        // Every sphere is visible until a plane culls it
+        _initVisibilityMasks(visibility, numSpheres);
+
+        const __m128 zero = _mm_setzero_ps();
+        SSECullingPlanes batch;
+        for (size_t firstPlane = 0; firstPlane < numPlanes; firstPlane += batch.count)
+        {
+            batch.load(planes, firstPlane, numPlanes);
+
+            // Four spheres per iteration, one sphere per lane
+            size_t i = 0;
+            for (size_t numIterations = numSpheres / 4; numIterations; --numIterations, i += 4)
+            {
+                __m128 cx = __MM_LOAD_PS(spheres.centreX + i);
+                __m128 cy = __MM_LOAD_PS(spheres.centreY + i);
+                __m128 cz = __MM_LOAD_PS(spheres.centreZ + i);
+                __m128 negRadius = _mm_sub_ps(zero, __MM_LOAD_PS(spheres.radius + i));
+
+                __m128 culled = zero;
+                for (size_t p = 0; p < batch.count; ++p)
+                {
+                    culled = _mm_or_ps(culled, _mm_cmplt_ps(batch.distance(p, cx, cy, cz), negRadius));
+                }
+
+                uint32 culledBits = (uint32)_mm_movemask_ps(culled);
+                visibility[i >> 5] &= ~(culledBits << (i & 31));
+            }
+
+            // Left over spheres
+            for (; i < numSpheres; ++i)
+            {
+                for (size_t p = 0; p < batch.count; ++p)
+                {
+                    const Plane& plane = planes[firstPlane + p];
+                    float dist = (float)plane.normal.x * spheres.centreX[i] + (float)plane.normal.y * spheres.centreY[i] +
+                        (float)plane.normal.z * spheres.centreZ[i] + (float)plane.d;
+                    if (dist < -spheres.radius[i])
+                    {
+                        visibility[i >> 5] &= ~(1u << (i & 31));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::nlerpQuaternions(
+        const QuaternionArrays& from,
+        const QuaternionArrays& to,
+        const float* t,
+        const QuaternionArrays& result,
+        size_t count,
+        bool shortestPath)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(from.w) && _isAlignedForSSE(from.x) &&
+            _isAlignedForSSE(from.y) && _isAlignedForSSE(from.z));
+        assert(_isAlignedForSSE(to.w) && _isAlignedForSSE(to.x) &&
+            _isAlignedForSSE(to.y) && _isAlignedForSSE(to.z));
+        assert(_isAlignedForSSE(result.w) && _isAlignedForSSE(result.x) &&
+            _isAlignedForSSE(result.y) && _isAlignedForSSE(result.z));
+        assert(_isAlignedForSSE(t));
+
+        const __m128 zero = _mm_setzero_ps();
+        // Negating 'to' is done by flipping sign bits, only in lanes whose
+        // dot product is negative
+        static const float signBit = -0.0f;
+        const __m128 negate = shortestPath ? _mm_load_ps1(&signBit) : zero;
+
+        // Four quaternions per iteration, one quaternion per lane
+        size_t i = 0;
+        for (size_t numIterations = count / 4; numIterations; --numIterations, i += 4)
+        {
+            __m128 fw = __MM_LOAD_PS(from.w + i);
+            __m128 fx = __MM_LOAD_PS(from.x + i);
+            __m128 fy = __MM_LOAD_PS(from.y + i);
+            __m128 fz = __MM_LOAD_PS(from.z + i);
+            __m128 tw = __MM_LOAD_PS(to.w + i);
+            __m128 tx = __MM_LOAD_PS(to.x + i);
+            __m128 ty = __MM_LOAD_PS(to.y + i);
+            __m128 tz = __MM_LOAD_PS(to.z + i);
+            __m128 factor = __MM_LOAD_PS(t + i);
+
+            __m128 dot = __MM_DOT4x4_PS(fw, fx, fy, fz, tw, tx, ty, tz);
+            __m128 sign = _mm_and_ps(_mm_cmplt_ps(dot, zero), negate);
+            tw = _mm_xor_ps(tw, sign);
+            tx = _mm_xor_ps(tx, sign);
+            ty = _mm_xor_ps(ty, sign);
+            tz = _mm_xor_ps(tz, sign);
+
+            // from + t * (to - from)
+            __m128 rw = __MM_MADD_PS(factor, _mm_sub_ps(tw, fw), fw);
+            __m128 rx = __MM_MADD_PS(factor, _mm_sub_ps(tx, fx), fx);
+            __m128 ry = __MM_MADD_PS(factor, _mm_sub_ps(ty, fy), fy);
+            __m128 rz = __MM_MADD_PS(factor, _mm_sub_ps(tz, fz), fz);
+
+            // Normalise, with a Newton-Raphson step since unlike normals the
+            // results are accumulated
+            __m128 invLength = __mm_rsqrt_nr_ps(__MM_DOT4x4_PS(rw, rx, ry, rz, rw, rx, ry, rz));
+            __MM_STORE_PS(result.w + i, _mm_mul_ps(rw, invLength));
+            __MM_STORE_PS(result.x + i, _mm_mul_ps(rx, invLength));
+            __MM_STORE_PS(result.y + i, _mm_mul_ps(ry, invLength));
+            __MM_STORE_PS(result.z + i, _mm_mul_ps(rz, invLength));
+        }
+
+        // Left over quaternions
+        for (; i < count; ++i)
+        {
+            Quaternion q = Quaternion::nlerp(t[i],
+                Quaternion(from.w[i], from.x[i], from.y[i], from.z[i]),
+                Quaternion(to.w[i], to.x[i], to.y[i], to.z[i]),
+                shortestPath);
+            result.w[i] = q.w;
+            result.x[i] = q.x;
+            result.y[i] = q.y;
+            result.z[i] = q.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::accumulateScaled(
+        float* dest,
+        const float* src,
+        float scale,
+        size_t count)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(dest) && _isAlignedForSSE(src));
+
+        const __m128 factor = _mm_load_ps1(&scale);
+
+        // Sixteen values per iteration, to hide the latency of the adds
+        size_t i = 0;
+        for (size_t numIterations = count / 16; numIterations; --numIterations, i += 16)
+        {
+            __m128 s0 = __MM_LOAD_PS(src + i);
+            __m128 s1 = __MM_LOAD_PS(src + i + 4);
+            __m128 s2 = __MM_LOAD_PS(src + i + 8);
+            __m128 s3 = __MM_LOAD_PS(src + i + 12);
+            __MM_STORE_PS(dest + i, __MM_MADD_PS(s0, factor, __MM_LOAD_PS(dest + i)));
+            __MM_STORE_PS(dest + i + 4, __MM_MADD_PS(s1, factor, __MM_LOAD_PS(dest + i + 4)));
+            __MM_STORE_PS(dest + i + 8, __MM_MADD_PS(s2, factor, __MM_LOAD_PS(dest + i + 8)));
+            __MM_STORE_PS(dest + i + 12, __MM_MADD_PS(s3, factor, __MM_LOAD_PS(dest + i + 12)));
+        }
+        for (size_t numIterations = (count - i) / 4; numIterations; --numIterations, i += 4)
+        {
+            __MM_STORE_PS(dest + i, __MM_MADD_PS(__MM_LOAD_PS(src + i), factor, __MM_LOAD_PS(dest + i)));
+        }
+
+        // Left over values
+        for (; i < count; ++i)
+        {
+            dest[i] += src[i] * scale;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::scaleOffsetClamp(
+        float* values,
+        size_t count,
+        float scale,
+        float offset,
+        float minValue,
+        float maxValue)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(values));
+
+        const __m128 factor = _mm_load_ps1(&scale);
+        const __m128 add = _mm_load_ps1(&offset);
+        const __m128 lower = _mm_load_ps1(&minValue);
+        const __m128 upper = _mm_load_ps1(&maxValue);
+
+        size_t i = 0;
+        for (size_t numIterations = count / 16; numIterations; --numIterations, i += 16)
+        {
+            __m128 v0 = __MM_MADD_PS(__MM_LOAD_PS(values + i), factor, add);
+            __m128 v1 = __MM_MADD_PS(__MM_LOAD_PS(values + i + 4), factor, add);
+            __m128 v2 = __MM_MADD_PS(__MM_LOAD_PS(values + i + 8), factor, add);
+            __m128 v3 = __MM_MADD_PS(__MM_LOAD_PS(values + i + 12), factor, add);
+            __MM_STORE_PS(values + i, _mm_min_ps(_mm_max_ps(v0, lower), upper));
+            __MM_STORE_PS(values + i + 4, _mm_min_ps(_mm_max_ps(v1, lower), upper));
+            __MM_STORE_PS(values + i + 8, _mm_min_ps(_mm_max_ps(v2, lower), upper));
+            __MM_STORE_PS(values + i + 12, _mm_min_ps(_mm_max_ps(v3, lower), upper));
+        }
+        for (size_t numIterations = (count - i) / 4; numIterations; --numIterations, i += 4)
+        {
+            __m128 v = __MM_MADD_PS(__MM_LOAD_PS(values + i), factor, add);
+            __MM_STORE_PS(values + i, _mm_min_ps(_mm_max_ps(v, lower), upper));
+        }
+
+        // Left over values
+        for (; i < count; ++i)
+        {
+            float v = values[i] * scale + offset;
+            values[i] = std::min(std::max(v, minValue), maxValue);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::generateQuadVertices(
+        const float* centres,
+        const float* offsets,
+        size_t offsetStride,
+        const uint32* colours,
+        const float* texCoords,
+        float* dest,
+        size_t numQuads)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        assert(_isAlignedForSSE(centres) && _isAlignedForSSE(offsets) &&
+            _isAlignedForSSE(texCoords));
+
+        // Shared offsets only need loading once
+        __m128 off0 = __MM_LOAD_PS(offsets);
+        __m128 off1 = __MM_LOAD_PS(offsets + 4);
+        __m128 off2 = __MM_LOAD_PS(offsets + 8);
+        __m128 off3 = __MM_LOAD_PS(offsets + 12);
+
+        for (size_t i = 0; i < numQuads; ++i)
+        {
+            if (offsetStride)
+            {
+                off0 = __MM_LOAD_PS(offsets);
+                off1 = __MM_LOAD_PS(offsets + 4);
+                off2 = __MM_LOAD_PS(offsets + 8);
+                off3 = __MM_LOAD_PS(offsets + 12);
+                offsets += offsetStride;
+            }
+
+            const __m128 centre = __MM_LOAD_PS(centres);
+            // Colour bits in every lane, to put in the w of the positions
+            const __m128 colour = _mm_load_ps1(reinterpret_cast<const float*>(colours));
+            // left top right bottom -> (left, top), (right, top), (left, bottom), (right, bottom)
+            const __m128 rect = __MM_LOAD_PS(texCoords);
+            const __m128 uvTop = _mm_shuffle_ps(rect, rect, _MM_SHUFFLE(1, 2, 1, 0));
+            const __m128 uvBottom = _mm_shuffle_ps(rect, rect, _MM_SHUFFLE(3, 2, 3, 0));
+
+            __m128 pos, zc;
+
+            // Each vertex is position with the colour in w, then the texture coordinates
+#define __GEN_QUAD_VERTEX(offset, uv, storeUV)                                  \
+            pos = _mm_add_ps(centre, offset);                                   \
+            zc = _mm_shuffle_ps(pos, colour, _MM_SHUFFLE(0, 0, 2, 2));          \
+            _mm_storeu_ps(dest, _mm_shuffle_ps(pos, zc, _MM_SHUFFLE(2, 0, 1, 0))); \
+            storeUV(reinterpret_cast<__m64*>(dest + 4), uv);                    \
+            dest += 6;
+
+            __GEN_QUAD_VERTEX(off0, uvTop, _mm_storel_pi)
+            __GEN_QUAD_VERTEX(off1, uvTop, _mm_storeh_pi)
+            __GEN_QUAD_VERTEX(off2, uvBottom, _mm_storel_pi)
+            __GEN_QUAD_VERTEX(off3, uvBottom, _mm_storeh_pi)
+
+#undef __GEN_QUAD_VERTEX
+
+            centres += 4;
+            ++colours;
+            texCoords += 4;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::calculateHeightfieldNormals(
+        const float* heights,
+        size_t rowStride,
+        float spacing,
+        float* normals,
+        size_t count)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        if (count < 4)
+        {
+            // Too short for a batch
+            _getOptimisedUtilGeneral()->calculateHeightfieldNormals(
+                heights, rowStride, spacing, normals, count);
+            return;
+        }
+
+        const float* below = heights - rowStride;
+        const float* above = heights + rowStride;
+        const __m128 nz = _mm_load_ps1(&spacing);
+        const __m128 nz2 = _mm_mul_ps(nz, nz);
+        const __m128 zero = _mm_setzero_ps();
+
+        // 4 vertices at a time; a short last batch is done by moving it back
+        // to overlap the previous one, which writes the same normals again
+        for (size_t i = 0; i < count; i += 4)
+        {
+            if (i + 4 > count)
+                i = count - 4;
+
+            // Neighbours relative to the centre, as in the general version
+            const __m128 c = _mm_loadu_ps(heights + i);
+            const __m128 h0 = _mm_sub_ps(_mm_loadu_ps(heights + i + 1), c);
+            const __m128 h1 = _mm_sub_ps(_mm_loadu_ps(above + i + 1), c);
+            const __m128 h2 = _mm_sub_ps(_mm_loadu_ps(above + i), c);
+            const __m128 h3 = _mm_sub_ps(_mm_loadu_ps(above + i - 1), c);
+            const __m128 h4 = _mm_sub_ps(_mm_loadu_ps(heights + i - 1), c);
+            const __m128 h5 = _mm_sub_ps(_mm_loadu_ps(below + i - 1), c);
+            const __m128 h6 = _mm_sub_ps(_mm_loadu_ps(below + i), c);
+            const __m128 h7 = _mm_sub_ps(_mm_loadu_ps(below + i + 1), c);
+
+            __m128 sx = zero, sy = zero, sz = zero;
+            __m128 nx, ny, invLength;
+
+#define __ADD_UNIT_NORMAL(x, y)                                                 \
+            nx = (x);                                                           \
+            ny = (y);                                                           \
+            invLength = __MM_RSQRT_PS(__MM_ACCUM3_PS(                           \
+                _mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny), nz2));                  \
+            sx = __MM_MADD_PS(nx, invLength, sx);                               \
+            sy = __MM_MADD_PS(ny, invLength, sy);                               \
+            sz = _mm_add_ps(sz, invLength);
+
+            __ADD_UNIT_NORMAL(_mm_sub_ps(zero, h0), _mm_sub_ps(h0, h1))
+            __ADD_UNIT_NORMAL(_mm_sub_ps(h2, h1), _mm_sub_ps(zero, h2))
+            __ADD_UNIT_NORMAL(_mm_sub_ps(h3, h2), _mm_sub_ps(zero, h2))
+            __ADD_UNIT_NORMAL(h4, _mm_sub_ps(h4, h3))
+            __ADD_UNIT_NORMAL(h4, _mm_sub_ps(h5, h4))
+            __ADD_UNIT_NORMAL(_mm_sub_ps(h5, h6), h6)
+            __ADD_UNIT_NORMAL(_mm_sub_ps(h6, h7), h6)
+            __ADD_UNIT_NORMAL(_mm_sub_ps(zero, h0), _mm_sub_ps(h7, h0))
+
+#undef __ADD_UNIT_NORMAL
+
+            // The z of each triangle normal was the spacing
+            sz = _mm_mul_ps(sz, nz);
+
+            // Normalise the sums precisely, these are the final results
+            invLength = __mm_rsqrt_nr_ps(__MM_DOT3x3_PS(sx, sy, sz, sx, sy, sz));
+            sx = _mm_mul_ps(sx, invLength);
+            sy = _mm_mul_ps(sy, invLength);
+            sz = _mm_mul_ps(sz, invLength);
+
+            // Interleave into xyz triples
+            __MM_TRANSPOSE3x4_PS(sx, sy, sz);
+            float* dest = normals + i * 3;
+            _mm_storeu_ps(dest, sx);
+            _mm_storeu_ps(dest + 4, sy);
+            _mm_storeu_ps(dest + 8, sz);
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilSSE(void)
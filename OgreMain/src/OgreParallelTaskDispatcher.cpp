@@ -0,0 +1,193 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "OgreRoot.h"
+#include "OgreException.h"
+#include "OgreTraceProfiler.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	ParallelTaskDispatcher::ParallelTaskDispatcher(const String& channelName)
+		: mChannelName(channelName)
+		, mWorkQueue(0)
+		, mUserWorkQueue(0)
+		, mChannel(0)
+		, mConcurrency(0)
+	{
+	}
+	//---------------------------------------------------------------------
+	ParallelTaskDispatcher::~ParallelTaskDispatcher()
+	{
+		unregisterFromWorkQueue();
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskDispatcher::setWorkQueue(WorkQueue* queue)
+	{
+		unregisterFromWorkQueue();
+		mUserWorkQueue = queue;
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskDispatcher::unregisterFromWorkQueue()
+	{
+		// Only disconnect if the queue we registered with still exists; this
+		// waits for any worker which is still inside handleRequest
+		Root* root = Root::getSingletonPtr();
+		if (mWorkQueue && (mWorkQueue == mUserWorkQueue || (root && root->getWorkQueue() == mWorkQueue)))
+			mWorkQueue->removeRequestHandler(mChannel, this);
+		mWorkQueue = 0;
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskDispatcher::registerWithWorkQueue()
+	{
+		Root* root = Root::getSingletonPtr();
+		WorkQueue* queue = mUserWorkQueue ? mUserWorkQueue : (root ? root->getWorkQueue() : 0);
+		if (queue != mWorkQueue)
+		{
+			// Root deletes a queue which is replaced, so don't touch the old one
+			mWorkQueue = queue;
+			if (mWorkQueue)
+			{
+				mChannel = mWorkQueue->getChannel(mChannelName);
+				mWorkQueue->addRequestHandler(mChannel, this);
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	size_t ParallelTaskDispatcher::getConcurrency() const
+	{
+#if OGRE_THREAD_SUPPORT
+		size_t threads = mConcurrency ? mConcurrency : OGRE_THREAD_HARDWARE_CONCURRENCY;
+		return threads ? threads : 1;
+#else
+		return 1;
+#endif
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskDispatcher::dispatch(TaskSet* tasks, size_t taskCount, size_t grainSize)
+	{
+		if (!taskCount)
+			return;
+		if (!grainSize)
+			grainSize = 1;
+
+		size_t batchCount = (taskCount + grainSize - 1) / grainSize;
+		size_t helpers = std::min(getConcurrency(), batchCount) - 1;
+#if OGRE_THREAD_SUPPORT
+		if (helpers)
+			registerWithWorkQueue();
+		if (!mWorkQueue)
+			helpers = 0;
+#else
+		helpers = 0;
+#endif
+
+		if (!helpers)
+		{
+			// Not worth involving other threads
+			tasks->processTasks(0, taskCount);
+			return;
+		}
+
+		// The job is shared with the requests, so that a request which is only
+		// picked up after this call returns finds nothing left to do rather
+		// than a dangling pointer
+		JobRequest req;
+		req.job.bind(OGRE_NEW Job());
+		Job* job = req.job.get();
+		job->tasks = tasks;
+		job->taskCount = taskCount;
+		job->grainSize = grainSize;
+		job->batchCount = batchCount;
+
+		Any data(req);
+		for (size_t i = 0; i < helpers; ++i)
+			mWorkQueue->addRequest(mChannel, 0, data);
+
+		job->run();
+
+		// Wait for batches still being processed by other threads
+		while (job->completedBatches.get() < batchCount)
+		{
+			OGRE_THREAD_SLEEP(0);
+		}
+
+		if (!job->error.empty())
+		{
+			OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+				"A task raised an exception: " + job->error,
+				"ParallelTaskDispatcher::dispatch");
+		}
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::Response* ParallelTaskDispatcher::handleRequest(
+		const WorkQueue::Request* req, const WorkQueue* srcQ)
+	{
+		(void)srcQ;
+		// Any dispatcher on this channel can process any job
+		JobRequest jobReq = any_cast<JobRequest>(req->getData());
+		jobReq.job->run();
+		return OGRE_NEW WorkQueue::Response(req, true, Any());
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskDispatcher::Job::run()
+	{
+		OgreTraceScopeGroup("ParallelTaskDispatcher::run", OGREPROF_GENERAL);
+
+		while (true)
+		{
+			size_t batch = nextBatch++;
+			if (batch >= batchCount)
+				break;
+
+			size_t begin = batch * grainSize;
+			size_t end = std::min(begin + grainSize, taskCount);
+			// Exceptions can't be allowed to escape, or the batch would never
+			// complete; the dispatching thread raises them instead
+			try
+			{
+				tasks->processTasks(begin, end);
+			}
+			catch (std::exception& e)
+			{
+				OGRE_LOCK_MUTEX(errorMutex)
+				if (error.empty())
+					error = e.what();
+			}
+			catch (...)
+			{
+				OGRE_LOCK_MUTEX(errorMutex)
+				if (error.empty())
+					error = "unknown exception";
+			}
+			++completedBatches;
+		}
+	}
+
+}
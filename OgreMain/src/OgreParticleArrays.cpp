@@ -0,0 +1,171 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreParticleArrays.h"
+#include "OgreParticle.h"
+
+namespace Ogre {
+
+	//-----------------------------------------------------------------------
+	ParticleArrays::ParticleArrays()
+		: mCount(0)
+		, mCapacity(0)
+	{
+		setArrays(0, 0);
+	}
+	//-----------------------------------------------------------------------
+	ParticleArrays::~ParticleArrays()
+	{
+		if (positionX)
+			OGRE_FREE_SIMD(positionX, MEMCATEGORY_SCENE_OBJECTS);
+	}
+	//-----------------------------------------------------------------------
+	void ParticleArrays::setArrays(float* p, size_t capacity)
+	{
+		positionX = p;
+		positionY = p + capacity;
+		positionZ = p + capacity * 2;
+		directionX = p + capacity * 3;
+		directionY = p + capacity * 4;
+		directionZ = p + capacity * 5;
+		colourR = p + capacity * 6;
+		colourG = p + capacity * 7;
+		colourB = p + capacity * 8;
+		colourA = p + capacity * 9;
+		rotation = p + capacity * 10;
+		rotationSpeed = p + capacity * 11;
+		width = p + capacity * 12;
+		height = p + capacity * 13;
+		timeToLive = p + capacity * 14;
+		totalTimeToLive = p + capacity * 15;
+		ownDimensions = reinterpret_cast<uint8*>(p + capacity * NUM_FLOAT_ARRAYS);
+	}
+	//-----------------------------------------------------------------------
+	void ParticleArrays::reserve(size_t count)
+	{
+		if (count <= mCapacity)
+			return;
+
+		// Grow geometrically, and keep the capacity a multiple of 4 so that
+		// every array in the block stays aligned
+		size_t capacity = (std::max(count, mCapacity + mCapacity / 2) + 3) & ~size_t(3);
+		// One block for all components
+		float* block = static_cast<float*>(OGRE_MALLOC_SIMD(
+			sizeof(float) * capacity * NUM_FLOAT_ARRAYS + capacity, MEMCATEGORY_SCENE_OBJECTS));
+
+		if (mCount)
+		{
+			for (size_t a = 0; a < NUM_FLOAT_ARRAYS; ++a)
+				memcpy(block + capacity * a, positionX + mCapacity * a, sizeof(float) * mCount);
+			memcpy(block + capacity * NUM_FLOAT_ARRAYS, ownDimensions, mCount);
+		}
+		if (positionX)
+			OGRE_FREE_SIMD(positionX, MEMCATEGORY_SCENE_OBJECTS);
+
+		setArrays(block, capacity);
+		mCapacity = capacity;
+		mParticles.resize(capacity);
+		mIterators.resize(capacity);
+	}
+	//-----------------------------------------------------------------------
+	void ParticleArrays::append(ParticleList::iterator begin, ParticleList::iterator end)
+	{
+		size_t i = mCount;
+		reserve(mCount + std::distance(begin, end));
+
+		for (ParticleList::iterator p = begin; p != end; ++p, ++i)
+		{
+			Particle* particle = *p;
+			mParticles[i] = particle;
+			mIterators[i] = p;
+			positionX[i] = (float)particle->position.x;
+			positionY[i] = (float)particle->position.y;
+			positionZ[i] = (float)particle->position.z;
+			directionX[i] = (float)particle->direction.x;
+			directionY[i] = (float)particle->direction.y;
+			directionZ[i] = (float)particle->direction.z;
+			colourR[i] = particle->colour.r;
+			colourG[i] = particle->colour.g;
+			colourB[i] = particle->colour.b;
+			colourA[i] = particle->colour.a;
+			rotation[i] = (float)particle->rotation.valueRadians();
+			rotationSpeed[i] = (float)particle->rotationSpeed.valueRadians();
+			timeToLive[i] = (float)particle->timeToLive;
+			totalTimeToLive[i] = (float)particle->totalTimeToLive;
+			if (particle->mOwnDimensions)
+			{
+				width[i] = (float)particle->mWidth;
+				height[i] = (float)particle->mHeight;
+				ownDimensions[i] = 1;
+			}
+			else
+			{
+				width[i] = height[i] = 0;
+				ownDimensions[i] = 0;
+			}
+		}
+		mCount = i;
+	}
+	//-----------------------------------------------------------------------
+	void ParticleArrays::scatter(void) const
+	{
+		for (size_t i = 0; i < mCount; ++i)
+		{
+			Particle* particle = mParticles[i];
+			particle->position.x = positionX[i];
+			particle->position.y = positionY[i];
+			particle->position.z = positionZ[i];
+			particle->direction.x = directionX[i];
+			particle->direction.y = directionY[i];
+			particle->direction.z = directionZ[i];
+			particle->colour.r = colourR[i];
+			particle->colour.g = colourG[i];
+			particle->colour.b = colourB[i];
+			particle->colour.a = colourA[i];
+			particle->rotation = Radian(rotation[i]);
+			particle->rotationSpeed = Radian(rotationSpeed[i]);
+			particle->timeToLive = timeToLive[i];
+			particle->totalTimeToLive = totalTimeToLive[i];
+			// Set directly, since Particle::setDimensions would notify the
+			// system once per particle; affectors notify it once per batch
+			particle->mOwnDimensions = ownDimensions[i] != 0;
+			particle->mWidth = width[i];
+			particle->mHeight = height[i];
+		}
+	}
+	//-----------------------------------------------------------------------
+	void ParticleArrays::copyElement(size_t dest, size_t src)
+	{
+		mParticles[dest] = mParticles[src];
+		mIterators[dest] = mIterators[src];
+		for (size_t a = 0; a < NUM_FLOAT_ARRAYS; ++a)
+			positionX[mCapacity * a + dest] = positionX[mCapacity * a + src];
+		ownDimensions[dest] = ownDimensions[src];
+	}
+
+}
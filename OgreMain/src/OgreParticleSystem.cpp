@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreParticleEmitter.h"
 #include "OgreParticleAffector.h"
 #include "OgreParticle.h"
+#include "OgreParticleArrays.h"
 #include "OgreSceneNode.h"
 #include "OgreCamera.h"
 #include "OgreStringConverter.h"
@@ -45,6 +46,7 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreControllerManager.h"
 #include "OgreRoot.h"
+#include "OgreOptimisedUtil.h"
 
 namespace Ogre {
     // Init statics
@@ -59,6 +61,7 @@ namespace Ogre {
 	ParticleSystem::CmdLocalSpace ParticleSystem::msLocalSpaceCmd;
 	ParticleSystem::CmdIterationInterval ParticleSystem::msIterationIntervalCmd;
 	ParticleSystem::CmdNonvisibleTimeout ParticleSystem::msNonvisibleTimeoutCmd;
+	ParticleSystem::CmdParticleArrays ParticleSystem::msParticleArraysCmd;
 
     RadixSort<ParticleSystem::ActiveParticleList, Particle*, float> ParticleSystem::mRadixSorter;
 
@@ -93,6 +96,9 @@ namespace Ogre {
         mIterationInterval(0),
 		mIterationIntervalSet(false),
         mSorted(false),
+        mParticleArraysEnabled(false),
+        mParticleArraysDirty(true),
+        mParticleArrays(0),
         mLocalSpace(false),
 		mNonvisibleTimeout(0),
 		mNonvisibleTimeoutSet(false),
@@ -127,6 +133,9 @@ namespace Ogre {
         mIterationInterval(0),
 		mIterationIntervalSet(false),
         mSorted(false),
+        mParticleArraysEnabled(false),
+        mParticleArraysDirty(true),
+        mParticleArrays(0),
         mLocalSpace(false),
 		mNonvisibleTimeout(0),
 		mNonvisibleTimeoutSet(false),
@@ -167,6 +176,7 @@ namespace Ogre {
 
 		// Deallocate all particles
 		destroyVisualParticles(0, mParticlePool.size());
+        OGRE_DELETE mParticleArrays;
         // Free pool items
         ParticlePool::iterator i;
         for (i = mParticlePool.begin(); i != mParticlePool.end(); ++i)
@@ -285,6 +295,7 @@ namespace Ogre {
         setDefaultDimensions(rhs.mDefaultWidth, rhs.mDefaultHeight);
         mCullIndividual = rhs.mCullIndividual;
 		mSorted = rhs.mSorted;
+		setParticleArraysEnabled(rhs.mParticleArraysEnabled);
 		mLocalSpace = rhs.mLocalSpace;
 		mIterationInterval = rhs.mIterationInterval;
 		mIterationIntervalSet = rhs.mIterationIntervalSet;
@@ -403,9 +414,16 @@ namespace Ogre {
             while (mUpdateRemainTime >= iterationInterval)
             {
                 // Update existing particles
-                _expire(iterationInterval);
-                _triggerAffectors(iterationInterval);
-                _applyMotion(iterationInterval);
+                if (mParticleArraysEnabled)
+                {
+                    _updateParticleArrays(iterationInterval);
+                }
+                else
+                {
+                    _expire(iterationInterval);
+                    _triggerAffectors(iterationInterval);
+                    _applyMotion(iterationInterval);
+                }
 
 				if(mIsEmitting)
 				{
@@ -419,9 +437,16 @@ namespace Ogre {
         else
         {
             // Update existing particles
-            _expire(timeElapsed);
-            _triggerAffectors(timeElapsed);
-            _applyMotion(timeElapsed);
+            if (mParticleArraysEnabled)
+            {
+                _updateParticleArrays(timeElapsed);
+            }
+            else
+            {
+                _expire(timeElapsed);
+                _triggerAffectors(timeElapsed);
+                _applyMotion(timeElapsed);
+            }
 
 			if(mIsEmitting)
 			{
@@ -440,7 +465,6 @@ namespace Ogre {
     {
         ActiveParticleList::iterator i, itEnd;
         Particle* pParticle;
-		ParticleEmitter* pParticleEmitter;
 
         itEnd = mActiveParticles.end();
 
@@ -449,28 +473,7 @@ namespace Ogre {
             pParticle = static_cast<Particle*>(*i);
             if (pParticle->timeToLive < timeElapsed)
             {
-                // Notify renderer
-                mRenderer->_notifyParticleExpired(pParticle);
-
-				// Identify the particle type
-				if (pParticle->particleType == Particle::Visual)
-				{
-	                // Destroy this one
-		            mFreeParticles.splice(mFreeParticles.end(), mActiveParticles, i++);
-				}
-				else
-				{
-					// For now, it can only be an emitted emitter
-					pParticleEmitter = static_cast<ParticleEmitter*>(*i);
-					list<ParticleEmitter*>::type* fee = findFreeEmittedEmitter(pParticleEmitter->getName());
-					fee->push_back(pParticleEmitter);
-
-					// Also erase from mActiveEmittedEmitters
-					removeFromActiveEmittedEmitters (pParticleEmitter);
-
-					// And erase from mActiveParticles
-					i = mActiveParticles.erase( i );
-				}
+                _expireParticle(i++);
             }
             else
             {
@@ -482,6 +485,34 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void ParticleSystem::_expireParticle(ActiveParticleList::iterator i)
+    {
+        Particle* pParticle = *i;
+
+        // Notify renderer
+        mRenderer->_notifyParticleExpired(pParticle);
+
+		// Identify the particle type
+		if (pParticle->particleType == Particle::Visual)
+		{
+            // Destroy this one
+            mFreeParticles.splice(mFreeParticles.end(), mActiveParticles, i);
+		}
+		else
+		{
+			// For now, it can only be an emitted emitter
+			ParticleEmitter* pParticleEmitter = static_cast<ParticleEmitter*>(pParticle);
+			list<ParticleEmitter*>::type* fee = findFreeEmittedEmitter(pParticleEmitter->getName());
+			fee->push_back(pParticleEmitter);
+
+			// Also erase from mActiveEmittedEmitters
+			removeFromActiveEmittedEmitters (pParticleEmitter);
+
+			// And erase from mActiveParticles
+			mActiveParticles.erase( i );
+		}
+    }
+    //-----------------------------------------------------------------------
     void ParticleSystem::_triggerEmitters(Real timeElapsed)
     {
         // Add up requests for emission
@@ -646,6 +677,124 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ParticleSystem::_updateParticleArrays(Real timeElapsed)
+    {
+        _syncParticleArrays();
+        ParticleArrays& arrays = *mParticleArrays;
+
+        // Expire, as _expire, keeping the survivors in order
+        size_t count = arrays.getCount();
+        size_t kept = 0;
+        float t = (float)timeElapsed;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (arrays.timeToLive[i] < t)
+            {
+                _expireParticle(arrays.getIterator(i));
+            }
+            else
+            {
+                arrays.timeToLive[i] -= t;
+                if (kept != i)
+                    arrays.copyElement(kept, i);
+                ++kept;
+            }
+        }
+        arrays.truncate(kept);
+        count = kept;
+
+        // Which of the arrays and the particles hold changes the other lacks
+        bool arraysChanged = true;
+        bool particlesChanged = false;
+
+        ParticleAffectorList::iterator i, itEnd;
+        itEnd = mAffectors.end();
+        for (i = mAffectors.begin(); i != itEnd; ++i)
+        {
+            if ((*i)->supportsParticleArrays())
+            {
+                if (particlesChanged)
+                {
+                    arrays.clear();
+                    arrays.append(mActiveParticles.begin(), mActiveParticles.end());
+                    particlesChanged = false;
+                }
+                (*i)->_affectParticleArrays(this, arrays, timeElapsed);
+                arraysChanged = true;
+            }
+            else
+            {
+                if (arraysChanged)
+                {
+                    arrays.scatter();
+                    arraysChanged = false;
+                }
+                (*i)->_affectParticles(this, timeElapsed);
+                particlesChanged = true;
+            }
+        }
+        if (particlesChanged)
+        {
+            arrays.clear();
+            arrays.append(mActiveParticles.begin(), mActiveParticles.end());
+        }
+        // _getIterator, used by the affectors above, can't have changed anything else
+        mParticleArraysDirty = false;
+
+        // Motion, as _applyMotion
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        util->accumulateScaled(arrays.positionX, arrays.directionX, t, count);
+        util->accumulateScaled(arrays.positionY, arrays.directionY, t, count);
+        util->accumulateScaled(arrays.positionZ, arrays.directionZ, t, count);
+
+        // Emitters and the renderer work with the particles
+        arrays.scatter();
+        if (!mActiveEmittedEmitters.empty())
+        {
+            // Emitted emitters must follow their particles
+            ActiveEmittedEmitterList::iterator e, eEnd = mActiveEmittedEmitters.end();
+            for (e = mActiveEmittedEmitters.begin(); e != eEnd; ++e)
+            {
+                (*e)->setPosition((*e)->position);
+            }
+        }
+
+        // Notify renderer
+        mRenderer->_notifyParticleMoved(mActiveParticles);
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_syncParticleArrays(void)
+    {
+        if (!mParticleArrays)
+            mParticleArrays = OGRE_NEW ParticleArrays();
+
+        if (mParticleArraysDirty)
+        {
+            mParticleArrays->clear();
+            mParticleArraysDirty = false;
+        }
+
+        // Particles created since the arrays were last updated are at the end
+        // of the list
+        size_t count = mParticleArrays->getCount();
+        if (count < mActiveParticles.size())
+        {
+            ActiveParticleList::iterator first = mActiveParticles.begin();
+            if (count)
+            {
+                first = mParticleArrays->getIterator(count - 1);
+                ++first;
+            }
+            mParticleArrays->append(first, mActiveParticles.end());
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::setParticleArraysEnabled(bool enabled)
+    {
+        mParticleArraysEnabled = enabled;
+        mParticleArraysDirty = true;
+    }
+    //-----------------------------------------------------------------------
     void ParticleSystem::increasePool(size_t size)
     {
         size_t oldSize = mParticlePool.size();
@@ -670,12 +819,15 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ParticleIterator ParticleSystem::_getIterator(void)
     {
+        // The particles may be changed through the iterator
+        mParticleArraysDirty = true;
         return ParticleIterator(mActiveParticles.begin(), mActiveParticles.end());
     }
     //-----------------------------------------------------------------------
 	Particle* ParticleSystem::getParticle(size_t index) 
 	{
 		assert (index < mActiveParticles.size() && "Index out of bounds!");
+        mParticleArraysDirty = true;
 		ActiveParticleList::iterator i = mActiveParticles.begin();
 		std::advance(i, index);
 		return *i;
@@ -800,6 +952,12 @@ namespace Ogre {
 				PT_REAL),
 				&msNonvisibleTimeoutCmd);
 
+			dict->addParameter(ParameterDef("particle_arrays", 
+				"Sets whether affectors and motion are applied to the particles in "
+				"batches, held in arrays.",
+				PT_BOOL),
+				&msParticleArraysCmd);
+
         }
     }
     //-----------------------------------------------------------------------
@@ -836,7 +994,25 @@ namespace Ogre {
                 Vector3 halfScale = Vector3::UNIT_SCALE * 0.5;
                 Vector3 defaultPadding = 
                     halfScale * std::max(mDefaultHeight, mDefaultWidth);
-                for (p = mActiveParticles.begin(); p != mActiveParticles.end(); ++p)
+                if (mParticleArraysEnabled && mParticleArrays && !mParticleArraysDirty &&
+                    mParticleArrays->getCount() == mActiveParticles.size())
+                {
+                    // Same as below, without visiting every particle
+                    const ParticleArrays& arrays = *mParticleArrays;
+                    Real defaultPad = defaultPadding.x;
+                    for (size_t i = 0; i < arrays.getCount(); ++i)
+                    {
+                        Real pad = arrays.ownDimensions[i] ?
+                            0.5f * std::max(arrays.width[i], arrays.height[i]) : defaultPad;
+                        min.x = std::min(min.x, arrays.positionX[i] - pad);
+                        min.y = std::min(min.y, arrays.positionY[i] - pad);
+                        min.z = std::min(min.z, arrays.positionZ[i] - pad);
+                        max.x = std::max(max.x, arrays.positionX[i] + pad);
+                        max.y = std::max(max.y, arrays.positionY[i] + pad);
+                        max.z = std::max(max.z, arrays.positionZ[i] + pad);
+                    }
+                }
+                else for (p = mActiveParticles.begin(); p != mActiveParticles.end(); ++p)
                 {
                     if ((*p)->mOwnDimensions)
                     {
@@ -1033,6 +1209,7 @@ namespace Ogre {
 
         // Move actives to free list
         mFreeParticles.splice(mFreeParticles.end(), mActiveParticles);
+        mParticleArraysDirty = true;
 
         // Add active emitted emitters to free list
 		addActiveEmittedEmittersToFreeList();
@@ -1209,6 +1386,8 @@ namespace Ogre {
                 }
                 mRadixSorter.sort(mActiveParticles, SortByDistanceFunctor(camPos));
             }
+            // The order of the particle arrays no longer matches
+            mParticleArraysDirty = true;
         }
     }
     ParticleSystem::SortByDirectionFunctor::SortByDirectionFunctor(const Vector3& dir)
@@ -1587,6 +1766,17 @@ namespace Ogre {
 		static_cast<ParticleSystem*>(target)->setNonVisibleUpdateTimeout(
 			StringConverter::parseReal(val));
 	}
+	//-----------------------------------------------------------------------
+	String ParticleSystem::CmdParticleArrays::doGet(const void* target) const
+	{
+		return StringConverter::toString(
+			static_cast<const ParticleSystem*>(target)->getParticleArraysEnabled());
+	}
+	void ParticleSystem::CmdParticleArrays::doSet(void* target, const String& val)
+	{
+		static_cast<ParticleSystem*>(target)->setParticleArraysEnabled(
+			StringConverter::parseBool(val));
+	}
    //-----------------------------------------------------------------------
     ParticleAffector::~ParticleAffector() 
     {
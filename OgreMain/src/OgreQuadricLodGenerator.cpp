@@ -0,0 +1,609 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreQuadricLodGenerator.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreVertexIndexData.h"
+#include "OgreException.h"
+#include "OgreAxisAlignedBox.h"
+#include <queue>
+
+namespace Ogre {
+
+	namespace
+	{
+		/// Orders vertices by position, so that duplicates end up together
+		struct PositionLess
+		{
+			const vector<Vector3>::type& positions;
+			PositionLess(const vector<Vector3>::type& p) : positions(p) {}
+			bool operator()(uint32 a, uint32 b) const
+			{
+				const Vector3& pa = positions[a];
+				const Vector3& pb = positions[b];
+				if (pa.x != pb.x) return pa.x < pb.x;
+				if (pa.y != pb.y) return pa.y < pb.y;
+				return pa.z < pb.z;
+			}
+		};
+
+		/** Read the first components of an element of every vertex, those the
+			element doesn't have are zero. Only float elements can be read, out
+			is left empty for any other type. */
+		template <typename T>
+		void readElement(const VertexData* vertexData, const VertexElement* elem,
+			size_t components, typename vector<T>::type& out)
+		{
+			out.clear();
+			if (VertexElement::getBaseType(elem->getType()) != VET_FLOAT1)
+				return;
+
+			HardwareVertexBufferSharedPtr vbuf =
+				vertexData->vertexBufferBinding->getBuffer(elem->getSource());
+			components = std::min(components, (size_t)VertexElement::getTypeCount(elem->getType()));
+			out.resize(vertexData->vertexCount, T::ZERO);
+			const unsigned char* vertex = static_cast<const unsigned char*>(vbuf->lock(
+				vertexData->vertexStart * vbuf->getVertexSize(),
+				vertexData->vertexCount * vbuf->getVertexSize(), HardwareBuffer::HBL_READ_ONLY));
+			float* pFloat;
+			for (size_t v = 0; v < out.size(); ++v, vertex += vbuf->getVertexSize())
+			{
+				elem->baseVertexPointerToElement(const_cast<unsigned char*>(vertex), &pFloat);
+				for (size_t c = 0; c < components; ++c)
+					out[v][c] = pFloat[c];
+			}
+			vbuf->unlock();
+		}
+
+		void removeIndex(vector<uint32>::type& list, uint32 value)
+		{
+			vector<uint32>::type::iterator i = std::find(list.begin(), list.end(), value);
+			if (i != list.end())
+			{
+				*i = list.back();
+				list.pop_back();
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::Quadric::addPlane(const Vector3& n, Real d, double weight)
+	{
+		a2 += weight * n.x * n.x; ab += weight * n.x * n.y; ac += weight * n.x * n.z; ad += weight * n.x * d;
+		b2 += weight * n.y * n.y; bc += weight * n.y * n.z; bd += weight * n.y * d;
+		c2 += weight * n.z * n.z; cd += weight * n.z * d;
+		d2 += weight * d * d;
+	}
+	//---------------------------------------------------------------------
+	QuadricLodGenerator::Quadric& QuadricLodGenerator::Quadric::operator+=(const Quadric& rhs)
+	{
+		a2 += rhs.a2; ab += rhs.ab; ac += rhs.ac; ad += rhs.ad;
+		b2 += rhs.b2; bc += rhs.bc; bd += rhs.bd;
+		c2 += rhs.c2; cd += rhs.cd;
+		d2 += rhs.d2;
+		area += rhs.area;
+		return *this;
+	}
+	//---------------------------------------------------------------------
+	double QuadricLodGenerator::Quadric::evaluate(const Vector3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+			+ c2 * z * z + 2 * cd * z + d2;
+		// Rounding can make it slightly negative
+		return std::max(error, 0.0);
+	}
+	//---------------------------------------------------------------------
+	QuadricLodGenerator::QuadricLodGenerator(const VertexData* vertexData, const IndexData* indexData)
+		: mIndexType(indexData->indexBuffer->getType())
+		, mAttributeWeight(0.01f)
+		, mBorderWeight(10.0f)
+		, mAttributeScale(1)
+	{
+		const VertexElement* posElem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+		if (!posElem || posElem->getType() != VET_FLOAT3)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Geometry must have VET_FLOAT3 positions",
+				"QuadricLodGenerator::QuadricLodGenerator");
+		}
+		vector<Vector3>::type vertexPositions;
+		readElement<Vector3>(vertexData, posElem, 3, vertexPositions);
+		const VertexElement* normElem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+		if (normElem)
+			readElement<Vector3>(vertexData, normElem, 3, mNormals);
+		const VertexElement* uvElem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_TEXTURE_COORDINATES);
+		if (uvElem)
+			readElement<Vector2>(vertexData, uvElem, 2, mUVs);
+
+		// Triangles
+		const HardwareIndexBufferSharedPtr& ibuf = indexData->indexBuffer;
+		mIndexes.resize(indexData->indexCount / 3 * 3);
+		if (!mIndexes.empty())
+		{
+			const void* pIdx = ibuf->lock(indexData->indexStart * ibuf->getIndexSize(),
+				mIndexes.size() * ibuf->getIndexSize(), HardwareBuffer::HBL_READ_ONLY);
+			for (size_t i = 0; i < mIndexes.size(); ++i)
+			{
+				mIndexes[i] = mIndexType == HardwareIndexBuffer::IT_32BIT ?
+					static_cast<const uint32*>(pIdx)[i] : static_cast<const uint16*>(pIdx)[i];
+			}
+			ibuf->unlock();
+		}
+		for (size_t i = 0; i < mIndexes.size(); ++i)
+		{
+			if (mIndexes[i] >= vertexPositions.size())
+			{
+				OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Index out of range",
+					"QuadricLodGenerator::QuadricLodGenerator");
+			}
+		}
+
+		// Vertices at the same position share one quadric
+		IndexList order(vertexPositions.size());
+		for (size_t v = 0; v < order.size(); ++v)
+			order[v] = (uint32)v;
+		std::sort(order.begin(), order.end(), PositionLess(vertexPositions));
+		mVertexPosition.resize(vertexPositions.size());
+		AxisAlignedBox bounds;
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			const Vector3& pos = vertexPositions[order[i]];
+			if (i == 0 || pos != mPositions.back())
+			{
+				mPositions.push_back(pos);
+				bounds.merge(pos);
+			}
+			mVertexPosition[order[i]] = (uint32)mPositions.size() - 1;
+		}
+		if (bounds.isFinite())
+			mAttributeScale = std::max((double)bounds.getHalfSize().squaredLength(), 1e-12);
+	}
+	//---------------------------------------------------------------------
+	QuadricLodGenerator::~QuadricLodGenerator()
+	{
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::initialise(void)
+	{
+		const size_t positionCount = mPositions.size();
+		mTriangles.clear();
+		mPositionTriangles.assign(positionCount, IndexList());
+		mPositionVertices.assign(positionCount, IndexList());
+		mQuadrics.assign(positionCount, Quadric());
+		mVersions.assign(positionCount, 0);
+		mPositionRemoved.assign(positionCount, 0);
+
+		for (size_t v = 0; v < mVertexPosition.size(); ++v)
+			mPositionVertices[mVertexPosition[v]].push_back((uint32)v);
+
+		// Triangles with fewer than 3 distinct positions have nothing to collapse
+		for (size_t i = 0; i < mIndexes.size(); i += 3)
+		{
+			uint32 p0 = mVertexPosition[mIndexes[i]];
+			uint32 p1 = mVertexPosition[mIndexes[i + 1]];
+			uint32 p2 = mVertexPosition[mIndexes[i + 2]];
+			if (p0 == p1 || p1 == p2 || p2 == p0)
+				continue;
+
+			uint32 t = (uint32)mTriangles.size() / 3;
+			mTriangles.insert(mTriangles.end(), mIndexes.begin() + i, mIndexes.begin() + i + 3);
+			mPositionTriangles[p0].push_back(t);
+			mPositionTriangles[p1].push_back(t);
+			mPositionTriangles[p2].push_back(t);
+
+			Vector3 normal = (mPositions[p1] - mPositions[p0]).crossProduct(mPositions[p2] - mPositions[p0]);
+			Real area = normal.normalise() * 0.5f;
+			Real d = -normal.dotProduct(mPositions[p0]);
+			for (size_t k = 0; k < 3; ++k)
+			{
+				Quadric& q = mQuadrics[mVertexPosition[mIndexes[i + k]]];
+				q.addPlane(normal, d, area);
+				q.area += area;
+			}
+		}
+		mTriangleRemoved.assign(mTriangles.size() / 3, 0);
+
+		// Planes through borders and seams, perpendicular to the surface,
+		// keep them from moving sideways
+		EdgeList edges;
+		for (uint32 p = 0; p < positionCount; ++p)
+		{
+			gatherEdges(p, edges);
+			for (EdgeList::iterator e = edges.begin(); e != edges.end(); ++e)
+			{
+				if (e->triangles == 2 && !e->seam)
+					continue;
+				Vector3 dir = mPositions[e->vertex] - mPositions[p];
+				Vector3 normal = dir.crossProduct(e->normal);
+				if (normal.normalise() == 0)
+					continue;
+				mQuadrics[p].addPlane(normal, -normal.dotProduct(mPositions[p]),
+					mBorderWeight * dir.squaredLength());
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::gatherEdges(uint32 position, EdgeList& edges) const
+	{
+		edges.clear();
+		const IndexList& triangles = mPositionTriangles[position];
+		for (IndexList::const_iterator t = triangles.begin(); t != triangles.end(); ++t)
+		{
+			const uint32* tri = &mTriangles[*t * 3];
+			size_t corner = 0;
+			while (mVertexPosition[tri[corner]] != position)
+				++corner;
+			const Vector3& p0 = mPositions[mVertexPosition[tri[0]]];
+			Vector3 normal = (mPositions[mVertexPosition[tri[1]]] - p0).crossProduct(
+				mPositions[mVertexPosition[tri[2]]] - p0);
+
+			for (size_t k = 1; k < 3; ++k)
+			{
+				uint32 to = tri[(corner + k) % 3];
+				uint32 toPosition = mVertexPosition[to];
+				EdgeList::iterator e = edges.begin();
+				while (e != edges.end() && e->vertex != toPosition)
+					++e;
+				if (e == edges.end())
+				{
+					Edge edge;
+					edge.vertex = toPosition;
+					edge.triangles = 1;
+					edge.wedgeFrom = tri[corner];
+					edge.wedgeTo = to;
+					edge.seam = false;
+					edge.normal = normal;
+					edges.push_back(edge);
+				}
+				else
+				{
+					++e->triangles;
+					e->seam = e->seam || e->wedgeFrom != tri[corner] || e->wedgeTo != to;
+					e->normal += normal;
+				}
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	bool QuadricLodGenerator::usesPosition(uint32 triangle, uint32 position) const
+	{
+		const uint32* tri = &mTriangles[triangle * 3];
+		return mVertexPosition[tri[0]] == position || mVertexPosition[tri[1]] == position ||
+			mVertexPosition[tri[2]] == position;
+	}
+	//---------------------------------------------------------------------
+	double QuadricLodGenerator::attributeDistance(uint32 a, uint32 b) const
+	{
+		double dist = 0;
+		if (!mNormals.empty())
+			dist += (mNormals[a] - mNormals[b]).squaredLength();
+		if (!mUVs.empty())
+			dist += (mUVs[a] - mUVs[b]).squaredLength();
+		return dist;
+	}
+	//---------------------------------------------------------------------
+	uint32 QuadricLodGenerator::findReplacement(uint32 vertex, uint32 position, uint32 target) const
+	{
+		// The vertex on the other end of an edge of a triangle using this one
+		const IndexList& triangles = mPositionTriangles[position];
+		for (IndexList::const_iterator t = triangles.begin(); t != triangles.end(); ++t)
+		{
+			const uint32* tri = &mTriangles[*t * 3];
+			if (tri[0] != vertex && tri[1] != vertex && tri[2] != vertex)
+				continue;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				if (mVertexPosition[tri[k]] == target)
+					return tri[k];
+			}
+		}
+
+		// Otherwise the most similar one
+		const IndexList& candidates = mPositionVertices[target];
+		uint32 best = candidates.front();
+		double bestDist = attributeDistance(vertex, best);
+		for (IndexList::const_iterator c = candidates.begin() + 1; c != candidates.end(); ++c)
+		{
+			double dist = attributeDistance(vertex, *c);
+			if (dist < bestDist)
+			{
+				bestDist = dist;
+				best = *c;
+			}
+		}
+		return best;
+	}
+	//---------------------------------------------------------------------
+	bool QuadricLodGenerator::evaluate(uint32 position, Collapse& collapse) const
+	{
+		if (mPositionRemoved[position] || mPositionTriangles[position].empty())
+			return false;
+
+		EdgeList edges;
+		gatherEdges(position, edges);
+
+		// Vertices on borders or seams may only move along them, and not at
+		// all where they meet
+		size_t specialEdges = 0;
+		for (EdgeList::iterator e = edges.begin(); e != edges.end(); ++e)
+		{
+			if (e->triangles != 2 || e->seam)
+				++specialEdges;
+		}
+		if (specialEdges > 2)
+			return false;
+		const bool special = specialEdges > 0 || mPositionVertices[position].size() > 1;
+
+		const IndexList& triangles = mPositionTriangles[position];
+		const Quadric& quadric = mQuadrics[position];
+		bool found = false;
+		IndexList targetNeighbours;
+		for (EdgeList::iterator e = edges.begin(); e != edges.end(); ++e)
+		{
+			const bool specialEdge = e->triangles != 2 || e->seam;
+			if (e->triangles > 2 || (special && !specialEdge))
+				continue;
+			const uint32 target = e->vertex;
+
+			// Collapsing must not join any neighbours other than the ones
+			// across the triangles which disappear, or the surface would fold
+			targetNeighbours.clear();
+			const IndexList& targetTriangles = mPositionTriangles[target];
+			for (IndexList::const_iterator t = targetTriangles.begin(); t != targetTriangles.end(); ++t)
+			{
+				for (size_t k = 0; k < 3; ++k)
+					targetNeighbours.push_back(mVertexPosition[mTriangles[*t * 3 + k]]);
+			}
+			size_t shared = 0;
+			for (EdgeList::iterator n = edges.begin(); n != edges.end(); ++n)
+			{
+				if (n != e && std::find(targetNeighbours.begin(), targetNeighbours.end(), n->vertex) !=
+					targetNeighbours.end())
+					++shared;
+			}
+			if (shared > e->triangles)
+				continue;
+
+			// Triangles which remain must not flip over
+			const Vector3& dest = mPositions[target];
+			bool flips = false;
+			for (IndexList::const_iterator t = triangles.begin(); t != triangles.end() && !flips; ++t)
+			{
+				if (usesPosition(*t, target))
+					continue;
+				const uint32* tri = &mTriangles[*t * 3];
+				Vector3 p[3], moved[3];
+				for (size_t k = 0; k < 3; ++k)
+				{
+					p[k] = mPositions[mVertexPosition[tri[k]]];
+					moved[k] = mVertexPosition[tri[k]] == position ? dest : p[k];
+				}
+				Vector3 before = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+				Vector3 after = (moved[1] - moved[0]).crossProduct(moved[2] - moved[0]);
+				flips = before.dotProduct(after) <= 0;
+			}
+			if (flips)
+				continue;
+
+			Quadric sum = quadric;
+			sum += mQuadrics[target];
+			double error = sum.evaluate(dest);
+			double cost = error;
+			if (!mNormals.empty() || !mUVs.empty())
+			{
+				const IndexList& vertices = mPositionVertices[position];
+				double attributeError = 0;
+				for (IndexList::const_iterator v = vertices.begin(); v != vertices.end(); ++v)
+					attributeError += attributeDistance(*v, findReplacement(*v, position, target));
+				cost += mAttributeWeight * mAttributeScale * quadric.area * attributeError;
+			}
+
+			if (!found || cost < collapse.cost)
+			{
+				found = true;
+				collapse.cost = cost;
+				collapse.error = sum.area > 0 ? error / sum.area : 0;
+				collapse.vertex = position;
+				collapse.target = target;
+			}
+		}
+		collapse.version = mVersions[position];
+		return found;
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::collapse(uint32 position, uint32 target)
+	{
+		// Replacements are found before the triangles change
+		const IndexList& vertices = mPositionVertices[position];
+		IndexList replacements(vertices.size());
+		for (size_t v = 0; v < vertices.size(); ++v)
+			replacements[v] = findReplacement(vertices[v], position, target);
+
+		IndexList triangles;
+		triangles.swap(mPositionTriangles[position]);
+		for (IndexList::iterator t = triangles.begin(); t != triangles.end(); ++t)
+		{
+			uint32* tri = &mTriangles[*t * 3];
+			if (usesPosition(*t, target))
+			{
+				mTriangleRemoved[*t] = 1;
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (mVertexPosition[tri[k]] != position)
+						removeIndex(mPositionTriangles[mVertexPosition[tri[k]]], *t);
+				}
+			}
+			else
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					if (mVertexPosition[tri[k]] == position)
+					{
+						size_t v = std::find(vertices.begin(), vertices.end(), tri[k]) - vertices.begin();
+						tri[k] = replacements[v];
+					}
+				}
+				mPositionTriangles[target].push_back(*t);
+			}
+		}
+
+		mQuadrics[target] += mQuadrics[position];
+		mPositionRemoved[position] = 1;
+		mPositionVertices[position].clear();
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::computeLevels(ushort numLevels,
+		ProgressiveMesh::VertexReductionQuota quota, Real reductionValue)
+	{
+		typedef std::priority_queue<Collapse, vector<Collapse>::type> CollapseQueue;
+
+		initialise();
+		mLevels.clear();
+		mLevelErrors.clear();
+
+		CollapseQueue queue;
+		size_t numVerts = 0;
+		Collapse c;
+		for (uint32 p = 0; p < mPositions.size(); ++p)
+		{
+			if (mPositionTriangles[p].empty())
+				continue;
+			++numVerts;
+			if (evaluate(p, c))
+				queue.push(c);
+		}
+
+		double maxError = 0;
+		IndexList affected;
+		while (numLevels--)
+		{
+			size_t numCollapses = quota == ProgressiveMesh::VRQ_PROPORTIONAL ?
+				static_cast<size_t>(numVerts * reductionValue) : static_cast<size_t>(reductionValue);
+			// Minimum 3 verts!
+			if (numVerts < numCollapses + 3)
+				numCollapses = numVerts > 3 ? numVerts - 3 : 0;
+			numVerts -= numCollapses;
+
+			while (numCollapses && !queue.empty())
+			{
+				Collapse top = queue.top();
+				queue.pop();
+				if (mPositionRemoved[top.vertex] || top.version != mVersions[top.vertex])
+					continue;
+
+				// Check it's still valid and no dearer than it was; if not,
+				// it goes back in the queue at its new cost
+				if (!evaluate(top.vertex, c))
+					continue;
+				if (c.cost > top.cost * (1 + 1e-9) + 1e-30)
+				{
+					queue.push(c);
+					continue;
+				}
+
+				// Everything around the collapse needs looking at again
+				affected.clear();
+				const IndexList& triangles = mPositionTriangles[c.vertex];
+				for (IndexList::const_iterator t = triangles.begin(); t != triangles.end(); ++t)
+				{
+					for (size_t k = 0; k < 3; ++k)
+						affected.push_back(mVertexPosition[mTriangles[*t * 3 + k]]);
+				}
+				collapse(c.vertex, c.target);
+				maxError = std::max(maxError, c.error);
+				--numCollapses;
+
+				const IndexList& targetTriangles = mPositionTriangles[c.target];
+				for (IndexList::const_iterator t = targetTriangles.begin(); t != targetTriangles.end(); ++t)
+				{
+					for (size_t k = 0; k < 3; ++k)
+						affected.push_back(mVertexPosition[mTriangles[*t * 3 + k]]);
+				}
+				std::sort(affected.begin(), affected.end());
+				affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+				for (IndexList::iterator a = affected.begin(); a != affected.end(); ++a)
+				{
+					++mVersions[*a];
+					if (evaluate(*a, c))
+						queue.push(c);
+				}
+			}
+
+			// NB if we ran out of collapses, the remaining levels are the same
+			mLevels.push_back(IndexList());
+			IndexList& level = mLevels.back();
+			for (size_t t = 0; t < mTriangleRemoved.size(); ++t)
+			{
+				if (!mTriangleRemoved[t])
+					level.insert(level.end(), mTriangles.begin() + t * 3, mTriangles.begin() + t * 3 + 3);
+			}
+			mLevelErrors.push_back((Real)Math::Sqrt((Real)maxError));
+		}
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::bakeLevels(ProgressiveMesh::LODFaceList* outList) const
+	{
+		for (vector<IndexList>::type::const_iterator i = mLevels.begin(); i != mLevels.end(); ++i)
+		{
+			IndexData* lod = OGRE_NEW IndexData();
+			outList->push_back(lod);
+			lod->indexStart = 0;
+			lod->indexCount = i->size();
+			if (i->empty())
+				continue;
+
+			// Create index buffer, we don't need to read it back or modify it a lot
+			lod->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+				mIndexType, lod->indexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY, false);
+			void* pIdx = lod->indexBuffer->lock(HardwareBuffer::HBL_DISCARD);
+			if (mIndexType == HardwareIndexBuffer::IT_32BIT)
+			{
+				memcpy(pIdx, &(*i)[0], i->size() * sizeof(uint32));
+			}
+			else
+			{
+				uint16* p16 = static_cast<uint16*>(pIdx);
+				for (size_t n = 0; n < i->size(); ++n)
+					p16[n] = static_cast<uint16>((*i)[n]);
+			}
+			lod->indexBuffer->unlock();
+		}
+	}
+	//---------------------------------------------------------------------
+	void QuadricLodGenerator::build(ushort numLevels, ProgressiveMesh::LODFaceList* outList,
+		ProgressiveMesh::VertexReductionQuota quota, Real reductionValue)
+	{
+		computeLevels(numLevels, quota, reductionValue);
+		bakeLevels(outList);
+	}
+
+}
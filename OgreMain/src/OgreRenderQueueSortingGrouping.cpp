@@ -35,6 +35,8 @@ namespace Ogre {
         RenderablePass, uint32> QueuedRenderableCollection::msRadixSorter1;
     RadixSort<QueuedRenderableCollection::RenderablePassList,
         RenderablePass, float> QueuedRenderableCollection::msRadixSorter2;
+    RadixSort<QueuedRenderableCollection::RenderablePassList,
+        RenderablePass, uint64> QueuedRenderableCollection::msRadixSorterKey;
 
 
 	//-----------------------------------------------------------------------
@@ -305,8 +307,9 @@ namespace Ogre {
             i->second->clear();
         }
 
-		// Clear sorted list
+		// Clear sorted lists
 		mSortedDescending.clear();
+		mSortedByKey.clear();
 	}
     //-----------------------------------------------------------------------
 	void QueuedRenderableCollection::removePassGroup(Pass* p)
@@ -357,6 +360,12 @@ namespace Ogre {
 			}
 		}
 
+		if (mOrganisationMode & OM_SORT_KEY)
+		{
+			// A single sort handles both the grouping and the depth ordering
+			msRadixSorterKey.sort(mSortedByKey, RadixSortFunctorSortKey(cam));
+		}
+
 		// Nothing needs to be done for pass groups, they auto-organise
 
     }
@@ -369,6 +378,12 @@ namespace Ogre {
 			mSortedDescending.push_back(RenderablePass(rend, pass));
 		}
 
+		if (mOrganisationMode & OM_SORT_KEY)
+		{
+			// Keys depend on the camera, so are calculated when sorting
+			mSortedByKey.push_back(RenderablePass(rend, pass));
+		}
+
 		if (mOrganisationMode & OM_PASS_GROUP)
 		{
             PassGroupRenderableMap::iterator i = mGrouped.find(pass);
@@ -401,6 +416,8 @@ namespace Ogre {
 			// try to fall back
 			if (OM_PASS_GROUP & mOrganisationMode)
 				om = OM_PASS_GROUP;
+			else if (OM_SORT_KEY & mOrganisationMode)
+				om = OM_SORT_KEY;
 			else if (OM_SORT_ASCENDING & mOrganisationMode)
 				om = OM_SORT_ASCENDING;
 			else if (OM_SORT_DESCENDING & mOrganisationMode)
@@ -423,6 +440,9 @@ namespace Ogre {
 		case OM_SORT_ASCENDING:
 			acceptVisitorAscending(visitor);
 			break;
+		case OM_SORT_KEY:
+			acceptVisitorSortKey(visitor);
+			break;
 		}
 		
 	}
@@ -479,10 +499,52 @@ namespace Ogre {
 		}
 
 	}
+    //-----------------------------------------------------------------------
+	void QueuedRenderableCollection::acceptVisitorSortKey(
+		QueuedRenderableVisitor* visitor) const
+	{
+		// Items with the same pass are adjacent; passes whose hashes and
+		// pointer hashes both collide may interleave, which just costs an
+		// extra pass change
+		const Pass* currentPass = 0;
+		bool skip = false;
+		RenderablePassList::const_iterator i, iend;
+		iend = mSortedByKey.end();
+		for (i = mSortedByKey.begin(); i != iend; ++i)
+		{
+			if (i->pass != currentPass)
+			{
+				currentPass = i->pass;
+				// Visit Pass - allow skip
+				skip = !visitor->visit(currentPass);
+			}
+			if (!skip)
+				visitor->visit(i->renderable);
+		}
+	}
+    //-----------------------------------------------------------------------
+	uint64 QueuedRenderableCollection::getSortKey(const Pass* pass, Real squaredViewDepth)
+	{
+		// Fold the pointer down to 16 bits, dropping the low bits which are
+		// the same for every allocation
+		size_t ptr = reinterpret_cast<size_t>(pass) >> 4;
+		uint32 passId = static_cast<uint32>(ptr ^ (ptr >> 16) ^ (ptr >> 16 >> 16)) & 0xFFFF;
+
+		// Squared depths are never negative, so their bits order like the floats
+		float depth = static_cast<float>(squaredViewDepth);
+		uint32 depthBits;
+		memcpy(&depthBits, &depth, sizeof(uint32));
+		if (depthBits & 0x80000000)
+			depthBits = 0;
+
+		return (static_cast<uint64>(pass->getHash()) << 32) | 
+			(passId << 16) | (depthBits >> 16);
+	}
     //-----------------------------------------------------------------------
 	void QueuedRenderableCollection::merge( const QueuedRenderableCollection& rhs )
 	{
 		mSortedDescending.insert( mSortedDescending.end(), rhs.mSortedDescending.begin(), rhs.mSortedDescending.end() );
+		mSortedByKey.insert( mSortedByKey.end(), rhs.mSortedByKey.begin(), rhs.mSortedByKey.end() );
 
 		PassGroupRenderableMap::const_iterator srcGroup;
 		for( srcGroup = rhs.mGrouped.begin(); srcGroup != rhs.mGrouped.end(); ++srcGroup )
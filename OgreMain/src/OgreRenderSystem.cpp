@@ -74,6 +74,7 @@ namespace Ogre {
 		, mUseCustomCapabilities(false)
 		, mTexProjRelative(false)
 		, mTexProjRelativeOrigin(Vector3::ZERO)
+		, mGpuProgramParameterStatsEnabled(false)
     {
     }
 
@@ -103,6 +104,10 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void RenderSystem::_updateAllRenderTargets(bool swapBuffers)
     {
+		// A new frame begins, publish the parameter statistics of the last one
+		mLastGpuProgramParameterStats = mGpuProgramParameterStats;
+		mGpuProgramParameterStats = GpuProgramParameterStats();
+
         // Update all in order of priority
         // This ensures render-to-texture targets get updated before render windows
 		RenderTargetPriorityMap::iterator itarg, itargend;
@@ -580,6 +585,21 @@ namespace Ogre {
     {
         return static_cast< unsigned int >( mVertexCount );
     }
+    //-----------------------------------------------------------------------
+	void RenderSystem::_notifyGpuProgramParametersBound(const GpuProgramParametersSharedPtr& params,
+		uint16 uploadedMask, uint16 skippedMask)
+	{
+		if (!mGpuProgramParameterStatsEnabled)
+			return;
+
+		if (uploadedMask)
+		{
+			++mGpuProgramParameterStats.bindCount;
+			mGpuProgramParameterStats.bytesUploaded += params->calculateConstantBytes(uploadedMask);
+		}
+		if (skippedMask)
+			mGpuProgramParameterStats.bytesSkipped += params->calculateConstantBytes(skippedMask);
+	}
     //-----------------------------------------------------------------------
 	void RenderSystem::convertColourValue(const ColourValue& colour, uint32* pDest)
 	{
@@ -611,6 +631,9 @@ namespace Ogre {
             val *= mCurrentPassIterationCount;
 		mCurrentPassIterationNum = 0;
 
+		// and for drawing several instances at once
+		val *= op.numberOfInstances;
+
         switch(op.operationType)
         {
 		case RenderOperation::OT_TRIANGLE_LIST:
@@ -626,7 +649,7 @@ namespace Ogre {
 	        break;
 	    }
 
-        mVertexCount += op.vertexData->vertexCount;
+        mVertexCount += op.vertexData->vertexCount * op.numberOfInstances;
         mBatchCount += mCurrentPassIterationCount;
 
 		// sort out clip planes
@@ -210,6 +210,9 @@ namespace Ogre {
 		pLog->logMessage(
 			" * Vertex texture fetch: "
 			+ StringConverter::toString(hasCapability(RSC_VERTEX_TEXTURE_FETCH), true));
+		pLog->logMessage(
+			" * Vertex buffer instance data: "
+			+ StringConverter::toString(hasCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA), true));
 		pLog->logMessage(
              " * Number of world matrices: "
              + StringConverter::toString(mNumWorldMatrices));
@@ -48,6 +48,7 @@ THE SOFTWARE.
 #include "OgreOverlayElementFactory.h"
 #include "OgreOverlayManager.h"
 #include "OgreProfiler.h"
+#include "OgreTraceProfiler.h"
 #include "OgreErrorDialog.h"
 #include "OgreConfigDialog.h"
 #include "OgreStringConverter.h"
@@ -154,7 +155,11 @@ namespace Ogre {
 		mResourceGroupManager = OGRE_NEW ResourceGroupManager();
 
 		// WorkQueue (note: users can replace this if they want)
+#if OGRE_WORK_STEALING_QUEUE && (OGRE_THREAD_PROVIDER == 1 || OGRE_THREAD_PROVIDER == 2)
+		DefaultWorkQueueBase* defaultQ = OGRE_NEW DefaultWorkQueueStealing("Root");
+#else
 		DefaultWorkQueue* defaultQ = OGRE_NEW DefaultWorkQueue("Root");
+#endif
 		// never process responses in main thread for longer than 10ms by default
 		defaultQ->setResponseProcessingTimeLimit(10);
 		// match threads to hardware
@@ -220,6 +225,8 @@ namespace Ogre {
         // Profiler
         mProfiler = OGRE_NEW Profiler();
 		Profiler::getSingleton().setTimer(mTimer);
+		mTraceProfiler = OGRE_NEW TraceProfiler();
+		mTraceProfiler->setThreadName("Main");
 #endif
         mFileSystemArchiveFactory = OGRE_NEW FileSystemArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mFileSystemArchiveFactory );
@@ -307,6 +314,7 @@ namespace Ogre {
 #endif
 #if OGRE_PROFILING
         OGRE_DELETE mProfiler;
+        OGRE_DELETE mTraceProfiler;
 #endif
         OGRE_DELETE mOverlayManager;
         OGRE_DELETE mFontManager;
@@ -788,6 +796,7 @@ namespace Ogre {
     bool Root::_fireFrameStarted(FrameEvent& evt)
     {
 		OgreProfileBeginGroup("Frame", OGREPROF_GENERAL);
+		OgreTraceFrame();
 
         // Remove all marked listeners
         set<FrameListener*>::type::iterator i;
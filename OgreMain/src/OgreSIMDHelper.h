@@ -76,15 +76,10 @@ THE SOFTWARE.
     }
 
 #else // 64
-#define __OGRE_SIMD_ALIGN_STACK()                                   \
-    {                                                               \
-        /* Use alloca to allocate some memory on the stack.  */     \
-        /* This alerts gcc that something funny is going on, */     \
-        /* so that it does not omit the frame pointer etc.   */     \
-        (void)__builtin_alloca(16);                                 \
-        /* Now align the stack pointer */                           \
-        __asm__ __volatile__ ("andq $-16, %rsp");                   \
-    }
+// The x86-64 ABI already requires the stack to be 16-bytes aligned at
+// every call, so nothing is needed. Realigning it behind the compiler's
+// back breaks forwarders which pass arguments on the stack, since gcc
+// addresses them relative to the stack pointer.
 #endif //64
 
 #elif defined(_MSC_VER)
@@ -193,8 +188,12 @@ __MM_DECL_OP2(sub_ps, subps, xm)
 __MM_DECL_OP2(sub_ss, subss, xm)
 __MM_DECL_OP2(mul_ps, mulps, xm)
 __MM_DECL_OP2(mul_ss, mulss, xm)
+__MM_DECL_OP2(min_ps, minps, xm)
+__MM_DECL_OP2(max_ps, maxps, xm)
 
+__MM_DECL_OP2(and_ps, andps, xm)
 __MM_DECL_OP2(xor_ps, xorps, xm)
+__MM_DECL_OP2(or_ps, orps, xm)
 
 __MM_DECL_OP2(unpacklo_ps, unpcklps, xm)
 __MM_DECL_OP2(unpackhi_ps, unpckhps, xm)
@@ -203,6 +202,7 @@ __MM_DECL_OP2(movehl_ps, movhlps, x)
 __MM_DECL_OP2(movelh_ps, movlhps, x)
 
 __MM_DECL_OP2(cmpnle_ps, cmpnleps, xm)
+__MM_DECL_OP2(cmplt_ps, cmpltps, xm)
 
 #undef __MM_DECL_OP2
 
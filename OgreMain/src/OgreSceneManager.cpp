@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "OgreSubMesh.h"
 #include "OgreEntity.h"
 #include "OgreSubEntity.h"
+#include "OgreSkeletonInstance.h"
 #include "OgreLight.h"
 #include "OgreMath.h"
 #include "OgreControllerManager.h"
@@ -62,6 +63,7 @@ THE SOFTWARE.
 #include "OgreShadowVolumeExtrudeProgram.h"
 #include "OgreDataStream.h"
 #include "OgreStaticGeometry.h"
+#include "OgreInstanceManager.h"
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreManualObject.h"
 #include "OgreRenderQueueInvocation.h"
@@ -69,8 +71,13 @@ THE SOFTWARE.
 #include "OgreRibbonTrail.h"
 #include "OgreParticleSystemManager.h"
 #include "OgreProfiler.h"
+#include "OgreTraceProfiler.h"
 #include "OgreCompositorManager.h"
 #include "OgreCompositorChain.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "OgreTransformPool.h"
+#include "OgreOptimisedUtil.h"
+#include "OgrePlatformInformation.h"
 // This class implements the most basic scene manager
 
 #include <cstdio>
@@ -154,8 +161,20 @@ mCameraRelativeRendering(false),
 mLastLightHash(0),
 mLastLightLimit(0),
 mLastLightHashGpuProgram(0),
-mGpuParamsDirty((uint16)GPV_ALL)
-{
+mGpuParamsDirty((uint16)GPV_ALL),
+mParallelSceneGraphUpdate(false),
+mParallelSceneGraphUpdateThreshold(2000),
+mParallelDispatcher(0),
+mTransformPool(0),
+mParallelCulling(false),
+mParallelCullingThreshold(2000),
+mParallelSkeletalAnimation(false)
+{
+    // nothing bound yet
+    for (size_t i = 0; i < 3; ++i)
+    {
+        mLastBoundGpuParams[i] = 0;
+    }
 
     // init sky
     for (size_t i = 0; i < 5; ++i)
@@ -220,6 +239,8 @@ SceneManager::~SceneManager()
     OGRE_DELETE mShadowCasterAABBQuery;
     OGRE_DELETE mRenderQueue;
 	OGRE_DELETE mAutoParamDataSource;
+	OGRE_DELETE mParallelDispatcher;
+	OGRE_DELETE mTransformPool;
 }
 //-----------------------------------------------------------------------
 RenderQueue* SceneManager::getRenderQueue(void)
@@ -762,6 +783,7 @@ void SceneManager::destroyAllParticleSystems(void)
 void SceneManager::clearScene(void)
 {
 	destroyAllStaticGeometry();
+	destroyAllInstanceManagers();
 	destroyAllMovableObjects();
 
 	// Clear root node of all children
@@ -1293,6 +1315,7 @@ void SceneManager::prepareRenderQueue(void)
 void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverlays)
 {
 	OgreProfileGroup("_renderScene", OGREPROF_GENERAL);
+	OgreTraceScopeGroup("SceneManager::_renderScene", OGREPROF_GENERAL);
 
     Root::getSingleton()._pushCurrentSceneManager(this);
 	mActiveQueuedRenderableVisitor->targetSceneMgr = this;
@@ -1337,6 +1360,11 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
     {
         // Update animations
         _applySceneAnimations();
+		if (mParallelSkeletalAnimation)
+		{
+			OgreTraceScopeGroup("SceneManager::_updateSkeletalAnimations", OGREPROF_GENERAL);
+			_updateSkeletalAnimations();
+		}
         mLastFrameNumber = thisFrameNumber;
     }
 
@@ -1347,6 +1375,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 		// Update scene graph for this camera (can happen multiple times per frame)
 		{
 			OgreProfileGroup("_updateSceneGraph", OGREPROF_GENERAL);
+			OgreTraceScopeGroup("SceneManager::_updateSceneGraph", OGREPROF_GENERAL);
 			_updateSceneGraph(camera);
 
 			// Auto-track nodes
@@ -1374,6 +1403,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 				if (isShadowTechniqueTextureBased())
 				{
 					OgreProfileGroup("prepareShadowTextures", OGREPROF_GENERAL);
+					OgreTraceScopeGroup("SceneManager::prepareShadowTextures", OGREPROF_GENERAL);
 
 					// *******
 					// WARNING
@@ -1433,12 +1463,14 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 		// Prepare render queue for receiving new objects
 		{
 			OgreProfileGroup("prepareRenderQueue", OGREPROF_GENERAL);
+			OgreTraceScopeGroup("SceneManager::prepareRenderQueue", OGREPROF_GENERAL);
 			prepareRenderQueue();
 		}
 
 		if (mFindVisibleObjects)
 		{
 			OgreProfileGroup("_findVisibleObjects", OGREPROF_CULLING);
+			OgreTraceScopeGroup("SceneManager::_findVisibleObjects", OGREPROF_CULLING);
 
 			// Assemble an AAB on the fly which contains the scene elements visible
 			// by the camera.
@@ -1504,6 +1536,7 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
     // Render scene content
 	{
 		OgreProfileGroup("_renderVisibleObjects", OGREPROF_RENDERING);
+		OgreTraceScopeGroup("SceneManager::_renderVisibleObjects", OGREPROF_RENDERING);
 		_renderVisibleObjects();
 	}
 
@@ -2165,24 +2198,384 @@ void SceneManager::_updateSceneGraph(Camera* cam)
 	// Process queued needUpdate calls 
 	Node::processQueuedUpdates();
 
+	if (mTransformPool && isTransformPoolSupported())
+	{
+		mTransformPool->update();
+		return;
+	}
+
     // Cascade down the graph updating transforms & world bounds
     // In this implementation, just update from the root
     // Smarter SceneManager subclasses may choose to update only
     //   certain scene graph branches
+#if OGRE_THREAD_SUPPORT
+	if (mParallelSceneGraphUpdate && mSceneNodes.size() >= mParallelSceneGraphUpdateThreshold &&
+		isParallelSceneGraphUpdateSupported())
+	{
+		updateSceneGraphParallel();
+		return;
+	}
+#endif
     getRootSceneNode()->_update(true, false);
 
 
+}
+//-----------------------------------------------------------------------
+/** Updates a list of independent subtrees of the scene graph. */
+class SceneGraphUpdateTaskSet : public ParallelTaskDispatcher::TaskSet
+{
+public:
+	SceneGraphUpdateTaskSet(const Node::DeferredUpdateList& updates)
+		: mUpdates(updates) {}
+
+	void processTasks(size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			mUpdates[i].first->_update(true, mUpdates[i].second);
+	}
+protected:
+	const Node::DeferredUpdateList& mUpdates;
+};
+//-----------------------------------------------------------------------
+void SceneManager::setTransformPoolEnabled(bool enabled)
+{
+	if (enabled && !mTransformPool)
+	{
+		mTransformPool = OGRE_NEW TransformPool(getRootSceneNode());
+	}
+	else if (!enabled && mTransformPool)
+	{
+		OGRE_DELETE mTransformPool;
+		mTransformPool = 0;
+	}
+}
+//-----------------------------------------------------------------------
+ParallelTaskDispatcher* SceneManager::getParallelDispatcher(void)
+{
+	if (!mParallelDispatcher)
+		mParallelDispatcher = OGRE_NEW ParallelTaskDispatcher("Ogre/SceneManager");
+	return mParallelDispatcher;
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphParallel(void)
+{
+	ParallelTaskDispatcher* dispatcher = getParallelDispatcher();
+
+	// Split the graph until there are enough subtrees to balance the load
+	// between threads, or it gets too deep to be worth continuing
+	const size_t targetSubtrees = dispatcher->getConcurrency() * 4;
+	const size_t maxSplitDepth = 4;
+
+	Node::DeferredUpdateList level;
+	mDeferredNodeUpdates.clear();
+	mSplitSceneNodes.clear();
+
+	SceneNode* root = getRootSceneNode();
+	root->_updateDeferred(false, mDeferredNodeUpdates);
+	mSplitSceneNodes.push_back(root);
+
+	for (size_t depth = 1; depth < maxSplitDepth &&
+		!mDeferredNodeUpdates.empty() && mDeferredNodeUpdates.size() < targetSubtrees; ++depth)
+	{
+		level.swap(mDeferredNodeUpdates);
+		mDeferredNodeUpdates.clear();
+		for (Node::DeferredUpdateList::iterator i = level.begin(); i != level.end(); ++i)
+		{
+			i->first->_updateDeferred(i->second, mDeferredNodeUpdates);
+			mSplitSceneNodes.push_back(static_cast<SceneNode*>(i->first));
+		}
+	}
+
+	SceneGraphUpdateTaskSet tasks(mDeferredNodeUpdates);
+	dispatcher->dispatch(&tasks, mDeferredNodeUpdates.size());
+
+	// Now the subtrees are done, finish the nodes above them, deepest first
+	for (SplitSceneNodeList::reverse_iterator i = mSplitSceneNodes.rbegin();
+		i != mSplitSceneNodes.rend(); ++i)
+	{
+		(*i)->_updateBounds();
+	}
+}
+//-----------------------------------------------------------------------
+/** Evaluates the skeletons of a list of entities which share none. */
+class SkeletonUpdateTaskSet : public ParallelTaskDispatcher::TaskSet
+{
+public:
+	SkeletonUpdateTaskSet(const vector<Entity*>::type& entities)
+		: mEntities(entities) {}
+
+	void processTasks(size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			mEntities[i]->_updateSkeleton();
+	}
+protected:
+	const vector<Entity*>::type& mEntities;
+};
+//-----------------------------------------------------------------------
+/// Orders entities by skeleton, so that entities sharing one are adjacent
+static bool skeletonLess(const Entity* a, const Entity* b)
+{
+	return a->getSkeleton() < b->getSkeleton();
+}
+static bool skeletonEqual(const Entity* a, const Entity* b)
+{
+	return a->getSkeleton() == b->getSkeleton();
+}
+//-----------------------------------------------------------------------
+void SceneManager::_updateSkeletalAnimations(void)
+{
+	mSkeletonUpdates.clear();
+	{
+		MovableObjectCollection* entities =
+			getMovableObjectCollection(EntityFactory::FACTORY_TYPE_NAME);
+		OGRE_LOCK_MUTEX(entities->mutex)
+		for (MovableObjectMap::iterator i = entities->map.begin(); i != entities->map.end(); ++i)
+		{
+			Entity* e = static_cast<Entity*>(i->second);
+			if (e->_isSkeletonUpdatePending())
+				mSkeletonUpdates.push_back(e);
+		}
+	}
+
+	// Entities which share a skeleton share its evaluation too, so only
+	// one of them must be updated
+	std::sort(mSkeletonUpdates.begin(), mSkeletonUpdates.end(), skeletonLess);
+	mSkeletonUpdates.erase(
+		std::unique(mSkeletonUpdates.begin(), mSkeletonUpdates.end(), skeletonEqual),
+		mSkeletonUpdates.end());
+	if (mSkeletonUpdates.empty())
+		return;
+
+	// Animation data which is built on demand must be built before the
+	// threads start, since skeletons may share animations
+	for (EntityList::iterator i = mSkeletonUpdates.begin(); i != mSkeletonUpdates.end(); ++i)
+		(*i)->getSkeleton()->_prepareAnimationState(*(*i)->getAllAnimationStates());
+
+	SkeletonUpdateTaskSet tasks(mSkeletonUpdates);
+	getParallelDispatcher()->dispatch(&tasks, mSkeletonUpdates.size());
 }
 //-----------------------------------------------------------------------
 void SceneManager::_findVisibleObjects(
 	Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
 {
+	if (mParallelCulling && mSceneNodes.size() >= mParallelCullingThreshold)
+	{
+		findVisibleObjectsParallel(cam, visibleBounds, onlyShadowCasters);
+		return;
+	}
+
     // Tell nodes to find, cascade down all nodes
     getRootSceneNode()->_findVisibleObjects(cam, getRenderQueue(), visibleBounds, true, 
         mDisplayNodes, onlyShadowCasters);
 
 }
 //-----------------------------------------------------------------------
+/** Culls a list of independent subtrees of the scene graph against a set of
+	planes, recording the visible nodes of each subtree in its own list. */
+class SceneManager::CullingTaskSet : public ParallelTaskDispatcher::TaskSet
+{
+public:
+	CullingTaskSet(const SplitSceneNodeList& subtrees, CullingEntryListList& results,
+		const Plane* planes, size_t numPlanes, bool displayNodes)
+		: mSubtrees(subtrees), mResults(results), mPlanes(planes), mNumPlanes(numPlanes)
+		, mDisplayNodes(displayNodes) {}
+
+	void processTasks(size_t begin, size_t end)
+	{
+		// Children are gathered into here a batch at a time, at every level
+		OGRE_SIMD_ALIGNED_DECL(float, scratch[6 * BATCH_SIZE]);
+		AxisAlignedBoxArrays boxes;
+		boxes.centreX = scratch;
+		boxes.centreY = scratch + BATCH_SIZE;
+		boxes.centreZ = scratch + BATCH_SIZE * 2;
+		boxes.halfSizeX = scratch + BATCH_SIZE * 3;
+		boxes.halfSizeY = scratch + BATCH_SIZE * 4;
+		boxes.halfSizeZ = scratch + BATCH_SIZE * 5;
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			mResults[i].clear();
+			cullSubtree(mSubtrees[i], mResults[i], boxes);
+		}
+	}
+
+protected:
+	/// Number of children tested at once, which is the number of bits in a mask
+	static const size_t BATCH_SIZE = 32;
+
+	const SplitSceneNodeList& mSubtrees;
+	CullingEntryListList& mResults;
+	const Plane* mPlanes;
+	size_t mNumPlanes;
+	bool mDisplayNodes;
+
+	/// Add entries for a visible node and the visible nodes below it
+	void cullSubtree(SceneNode* node, CullingEntryList& visible, const AxisAlignedBoxArrays& boxes)
+	{
+		CullingEntry entry = { node, CS_OBJECTS };
+		visible.push_back(entry);
+
+		Node::ChildNodeIterator children = node->getChildIterator();
+		while (children.hasMoreElements())
+		{
+			// Gather the bounds of the next batch of children; null and
+			// infinite boxes are dealt with here, as Frustum::isVisible does
+			Node::ChildNodeIterator batch = children;
+			uint32 nullMask = 0, infiniteMask = 0;
+			size_t count = 0;
+			for (; count < BATCH_SIZE && children.hasMoreElements(); ++count)
+			{
+				const AxisAlignedBox& aabb = static_cast<SceneNode*>(children.getNext())->_getWorldAABB();
+				if (aabb.isFinite())
+				{
+					Vector3 centre = aabb.getCenter();
+					Vector3 halfSize = aabb.getHalfSize();
+					boxes.centreX[count] = centre.x;
+					boxes.centreY[count] = centre.y;
+					boxes.centreZ[count] = centre.z;
+					boxes.halfSizeX[count] = halfSize.x;
+					boxes.halfSizeY[count] = halfSize.y;
+					boxes.halfSizeZ[count] = halfSize.z;
+				}
+				else
+				{
+					if (aabb.isNull())
+						nullMask |= 1u << count;
+					else
+						infiniteMask |= 1u << count;
+					boxes.centreX[count] = boxes.centreY[count] = boxes.centreZ[count] = 0;
+					boxes.halfSizeX[count] = boxes.halfSizeY[count] = boxes.halfSizeZ[count] = 0;
+				}
+			}
+
+			uint32 visibleMask;
+			OptimisedUtil::getImplementation()->cullAxisAlignedBoxes(
+				mPlanes, mNumPlanes, boxes, &visibleMask, count);
+			visibleMask = (visibleMask & ~nullMask) | infiniteMask;
+
+			// The batch's bounds are finished with, so the scratch space can
+			// be used again further down
+			for (size_t i = 0; i < count; ++i)
+			{
+				SceneNode* child = static_cast<SceneNode*>(batch.getNext());
+				if (visibleMask & (1u << i))
+					cullSubtree(child, visible, boxes);
+			}
+		}
+
+		if (node->_hasDebugRenderables(mDisplayNodes))
+		{
+			entry.step = CS_DEBUG;
+			visible.push_back(entry);
+		}
+	}
+};
+//-----------------------------------------------------------------------
+void SceneManager::findVisibleObjectsParallel(
+	Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+{
+	ParallelTaskDispatcher* dispatcher = getParallelDispatcher();
+
+	// Find the shallowest depth which gives enough subtrees to balance the
+	// load between threads, or stop if it gets too deep to be worth it
+	const size_t targetSubtrees = dispatcher->getConcurrency() * 4;
+	const size_t maxSplitDepth = 4;
+	size_t splitDepth = 1;
+	{
+		SplitSceneNodeList level, nextLevel;
+		level.push_back(getRootSceneNode());
+		for (;; ++splitDepth)
+		{
+			nextLevel.clear();
+			for (SplitSceneNodeList::iterator i = level.begin(); i != level.end(); ++i)
+			{
+				Node::ChildNodeIterator children = (*i)->getChildIterator();
+				while (children.hasMoreElements())
+					nextLevel.push_back(static_cast<SceneNode*>(children.getNext()));
+			}
+			if (nextLevel.empty() || nextLevel.size() >= targetSubtrees || splitDepth == maxSplitDepth)
+				break;
+			level.swap(nextLevel);
+		}
+	}
+
+	// Cull the nodes above the split here, as a serial traversal would
+	mCullingPlan.clear();
+	mCullingSubtrees.clear();
+	planCulling(getRootSceneNode(), cam, 0, splitDepth);
+
+	if (!mCullingSubtrees.empty())
+	{
+		// Threads test against the planes directly, so make sure they're up
+		// to date first; the far plane is left out if it's at infinity
+		const Frustum* frustum = cam->getCullingFrustum() ? cam->getCullingFrustum() : cam;
+		const Plane* frustumPlanes = frustum->getFrustumPlanes();
+		Plane planes[6];
+		size_t numPlanes = 0;
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			if (plane != FRUSTUM_PLANE_FAR || frustum->getFarClipDistance() != 0)
+				planes[numPlanes++] = frustumPlanes[plane];
+		}
+
+		if (mCullingResults.size() < mCullingSubtrees.size())
+			mCullingResults.resize(mCullingSubtrees.size());
+		CullingTaskSet tasks(mCullingSubtrees, mCullingResults, planes, numPlanes, mDisplayNodes);
+		dispatcher->dispatch(&tasks, mCullingSubtrees.size());
+	}
+
+	// Merge the results into the render queue in traversal order
+	RenderQueue* queue = getRenderQueue();
+	size_t subtree = 0;
+	for (CullingEntryList::iterator i = mCullingPlan.begin(); i != mCullingPlan.end(); ++i)
+	{
+		const CullingEntry* first = &(*i);
+		const CullingEntry* last = first + 1;
+		if (i->step == CS_SUBTREE)
+		{
+			const CullingEntryList& results = mCullingResults[subtree++];
+			first = results.empty() ? 0 : &results[0];
+			last = first + results.size();
+		}
+
+		for (const CullingEntry* entry = first; entry != last; ++entry)
+		{
+			if (entry->step == CS_OBJECTS)
+				entry->node->_addVisibleObjectsToQueue(cam, queue, visibleBounds, onlyShadowCasters);
+			else
+				entry->node->_addDebugRenderablesToQueue(queue, mDisplayNodes);
+		}
+	}
+}
+//-----------------------------------------------------------------------
+void SceneManager::planCulling(SceneNode* node, Camera* cam, size_t depth, size_t splitDepth)
+{
+	if (!cam->isVisible(node->_getWorldAABB()))
+		return;
+
+	CullingEntry entry = { node, CS_SUBTREE };
+	if (depth == splitDepth)
+	{
+		mCullingPlan.push_back(entry);
+		mCullingSubtrees.push_back(node);
+		return;
+	}
+
+	entry.step = CS_OBJECTS;
+	mCullingPlan.push_back(entry);
+
+	Node::ChildNodeIterator children = node->getChildIterator();
+	while (children.hasMoreElements())
+		planCulling(static_cast<SceneNode*>(children.getNext()), cam, depth + 1, splitDepth);
+
+	if (node->_hasDebugRenderables(mDisplayNodes))
+	{
+		entry.step = CS_DEBUG;
+		mCullingPlan.push_back(entry);
+	}
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderVisibleObjects(void)
 {
 	RenderQueueInvocationSequence* invocationSequence = 
@@ -6389,6 +6782,66 @@ void SceneManager::destroyAllInstancedGeometry(void)
 	mInstancedGeometryList.clear();
 }
 //---------------------------------------------------------------------
+InstanceManager* SceneManager::createInstanceManager(const String& customName, 
+	const String& meshName, const String& groupName, size_t instancesPerBatch, 
+	unsigned short subMeshIdx)
+{
+	// Check not existing
+	if (mInstanceManagers.find(customName) != mInstanceManagers.end())
+	{
+		OGRE_EXCEPT(Exception::ERR_DUPLICATE_ITEM, 
+			"InstanceManager with name '" + customName + "' already exists!", 
+			"SceneManager::createInstanceManager");
+	}
+	InstanceManager* ret = OGRE_NEW InstanceManager(customName, this, meshName, 
+		groupName, instancesPerBatch, subMeshIdx);
+	mInstanceManagers[customName] = ret;
+	return ret;
+}
+//---------------------------------------------------------------------
+InstanceManager* SceneManager::getInstanceManager(const String& name) const
+{
+	InstanceManagerMap::const_iterator i = mInstanceManagers.find(name);
+	if (i == mInstanceManagers.end())
+	{
+		OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, 
+			"InstanceManager with name '" + name + "' not found", 
+			"SceneManager::getInstanceManager");
+	}
+	return i->second;
+}
+//---------------------------------------------------------------------
+bool SceneManager::hasInstanceManager(const String& name) const
+{
+	return mInstanceManagers.find(name) != mInstanceManagers.end();
+}
+//---------------------------------------------------------------------
+void SceneManager::destroyInstanceManager(InstanceManager* instanceManager)
+{
+	destroyInstanceManager(instanceManager->getName());
+}
+//---------------------------------------------------------------------
+void SceneManager::destroyInstanceManager(const String& name)
+{
+	InstanceManagerMap::iterator i = mInstanceManagers.find(name);
+	if (i != mInstanceManagers.end())
+	{
+		OGRE_DELETE i->second;
+		mInstanceManagers.erase(i);
+	}
+}
+//---------------------------------------------------------------------
+void SceneManager::destroyAllInstanceManagers(void)
+{
+	InstanceManagerMap::iterator i, iend;
+	iend = mInstanceManagers.end();
+	for (i = mInstanceManagers.begin(); i != iend; ++i)
+	{
+		OGRE_DELETE i->second;
+	}
+	mInstanceManagers.clear();
+}
+//---------------------------------------------------------------------
 AxisAlignedBoxSceneQuery* 
 SceneManager::createAABBQuery(const AxisAlignedBox& box, unsigned long mask)
 {
@@ -6906,6 +7359,7 @@ void SceneManager::bindGpuProgram(GpuProgram* prog)
 	// Hash == 1 is almost impossible to achieve otherwise
 	mLastLightHashGpuProgram = 1;
 	mGpuParamsDirty = (uint16)GPV_ALL;
+	mLastBoundGpuParams[prog->getType()] = 0;
 	mDestRenderSystem->bindGpuProgram(prog);
 }
 //---------------------------------------------------------------------
@@ -6917,25 +7371,24 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
 		if (!mGpuParamsDirty)
 			return;
 
-		if (mGpuParamsDirty)
-			pass->_updateAutoParams(mAutoParamDataSource, mGpuParamsDirty);
+		pass->_updateAutoParams(mAutoParamDataSource, mGpuParamsDirty);
 
 		if (pass->hasVertexProgram())
 		{
-			mDestRenderSystem->bindGpuProgramParameters(GPT_VERTEX_PROGRAM, 
-				pass->getVertexProgramParameters(), mGpuParamsDirty);
+			bindGpuProgramParameters(GPT_VERTEX_PROGRAM, 
+				pass->getVertexProgramParameters());
 		}
 
 		if (pass->hasGeometryProgram())
 		{
-			mDestRenderSystem->bindGpuProgramParameters(GPT_GEOMETRY_PROGRAM,
-				pass->getGeometryProgramParameters(), mGpuParamsDirty);
+			bindGpuProgramParameters(GPT_GEOMETRY_PROGRAM,
+				pass->getGeometryProgramParameters());
 		}
 
 		if (pass->hasFragmentProgram())
 		{
-			mDestRenderSystem->bindGpuProgramParameters(GPT_FRAGMENT_PROGRAM, 
-				pass->getFragmentProgramParameters(), mGpuParamsDirty);
+			bindGpuProgramParameters(GPT_FRAGMENT_PROGRAM, 
+				pass->getFragmentProgramParameters());
 		}
 
 		mGpuParamsDirty = 0;
@@ -6943,6 +7396,26 @@ void SceneManager::updateGpuProgramParameters(const Pass* pass)
 
 }
 //---------------------------------------------------------------------
+void SceneManager::bindGpuProgramParameters(GpuProgramType gptype, 
+	const GpuProgramParametersSharedPtr& params)
+{
+	// Bring in shared parameters first so that changes to them show up as dirty
+	if (mGpuParamsDirty & GPV_GLOBAL)
+		params->_copySharedParams();
+
+	uint16 mask = mGpuParamsDirty;
+	// If the GPU already holds these parameters, only send what changed
+	if (mLastBoundGpuParams[gptype] == params.get())
+		mask &= params->getDirtyVariability();
+	else
+		mLastBoundGpuParams[gptype] = params.get();
+	params->_markClean(mGpuParamsDirty);
+
+	if (mask)
+		mDestRenderSystem->bindGpuProgramParameters(gptype, params, mask);
+	mDestRenderSystem->_notifyGpuProgramParametersBound(params, mask, mGpuParamsDirty & ~mask);
+}
+//---------------------------------------------------------------------
 //---------------------------------------------------------------------
 VisibleObjectsBoundsInfo::VisibleObjectsBoundsInfo()
 {
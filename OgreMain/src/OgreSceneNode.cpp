@@ -286,14 +286,7 @@ namespace Ogre {
             return;
 
         // Add all entities
-        ObjectMap::iterator iobj;
-        ObjectMap::iterator iobjend = mObjectsByName.end();
-        for (iobj = mObjectsByName.begin(); iobj != iobjend; ++iobj)
-        {
-			MovableObject* mo = iobj->second;
-
-			queue->processVisibleObject(mo, cam, onlyShadowCasters, visibleBounds);
-        }
+        _addVisibleObjectsToQueue(cam, queue, visibleBounds, onlyShadowCasters);
 
         if (includeChildren)
         {
@@ -307,6 +300,31 @@ namespace Ogre {
             }
         }
 
+        _addDebugRenderablesToQueue(queue, displayNodes);
+
+    }
+    //-----------------------------------------------------------------------
+    void SceneNode::_addVisibleObjectsToQueue(Camera* cam, RenderQueue* queue, 
+		VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+    {
+        ObjectMap::iterator iobj;
+        ObjectMap::iterator iobjend = mObjectsByName.end();
+        for (iobj = mObjectsByName.begin(); iobj != iobjend; ++iobj)
+        {
+			MovableObject* mo = iobj->second;
+
+			queue->processVisibleObject(mo, cam, onlyShadowCasters, visibleBounds);
+        }
+    }
+    //-----------------------------------------------------------------------
+    bool SceneNode::_hasDebugRenderables(bool displayNodes) const
+    {
+		return displayNodes || (!mHideBoundingBox &&
+			(mShowBoundingBox || (mCreator && mCreator->getShowBoundingBoxes())));
+    }
+    //-----------------------------------------------------------------------
+    void SceneNode::_addDebugRenderablesToQueue(RenderQueue* queue, bool displayNodes)
+    {
         if (displayNodes)
         {
             // Include self in the render queue
@@ -320,8 +338,6 @@ namespace Ogre {
 		{ 
 			_addBoundingBoxToQueue(queue);
 		}
-
-
     }
 
 	Node::DebugRenderable* SceneNode::getDebugRenderable()
@@ -369,6 +385,20 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void SceneNode::setDerivedTransform(const Vector3& position,
+        const Quaternion& orientation, const Vector3& scale)
+    {
+        Node::setDerivedTransform(position, orientation, scale);
+
+        // Notify objects that it has been moved
+        ObjectMap::const_iterator i;
+        for (i = mObjectsByName.begin(); i != mObjectsByName.end(); ++i)
+        {
+            MovableObject* object = i->second;
+            object->_notifyMoved();
+        }
+    }
+    //-----------------------------------------------------------------------
     Node* SceneNode::createChildImpl(void)
     {
         assert(mCreator);
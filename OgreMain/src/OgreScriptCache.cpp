@@ -0,0 +1,308 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreScriptCache.h"
+#include "OgreScriptLexer.h"
+#include "OgreScriptParser.h"
+#include "OgreStreamSerialiser.h"
+#include "OgreStringConverter.h"
+#include "OgreLogManager.h"
+#include "OgreException.h"
+
+namespace Ogre {
+
+	const uint32 ScriptCache::SCRIPTCACHE_CHUNK_ID = StreamSerialiser::makeIdentifier("SCCH");
+	const uint16 ScriptCache::SCRIPTCACHE_CHUNK_VERSION = 1;
+
+	namespace
+	{
+		/// Node fields, flattened in pre-order
+		struct FlatNodes
+		{
+			vector<uint32>::type tokens;
+			vector<uint32>::type files;
+			vector<uint32>::type lines;
+			vector<uint8>::type types;
+			vector<uint32>::type childCounts;
+		};
+		typedef map<String, uint32>::type StringIndexMap;
+
+		uint32 getStringIndex(const String& str, StringIndexMap& indexes, StringVector& strings)
+		{
+			std::pair<StringIndexMap::iterator, bool> result =
+				indexes.insert(StringIndexMap::value_type(str, static_cast<uint32>(strings.size())));
+			if (result.second)
+				strings.push_back(str);
+			return result.first->second;
+		}
+
+		void flattenNodes(const ConcreteNodeList& nodes, FlatNodes& flat,
+			StringIndexMap& indexes, StringVector& strings)
+		{
+			for (ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+			{
+				const ConcreteNode* node = i->get();
+				flat.tokens.push_back(getStringIndex(node->token, indexes, strings));
+				flat.files.push_back(getStringIndex(node->file, indexes, strings));
+				flat.lines.push_back(node->line);
+				flat.types.push_back(static_cast<uint8>(node->type));
+				flat.childCounts.push_back(static_cast<uint32>(node->children.size()));
+				flattenNodes(node->children, flat, indexes, strings);
+			}
+		}
+
+		/// Rebuilds the next node and its children, or returns null if the data is bad
+		ConcreteNodePtr buildNode(const FlatNodes& flat, const StringVector& strings,
+			size_t& next, ConcreteNode* parent)
+		{
+			if (next >= flat.tokens.size() || flat.tokens[next] >= strings.size() ||
+				flat.files[next] >= strings.size())
+				return ConcreteNodePtr();
+
+			size_t index = next++;
+			ConcreteNodePtr node(OGRE_NEW ConcreteNode());
+			node->token = strings[flat.tokens[index]];
+			node->file = strings[flat.files[index]];
+			node->line = flat.lines[index];
+			node->type = static_cast<ConcreteNodeType>(flat.types[index]);
+			node->parent = parent;
+			for (uint32 c = 0; c < flat.childCounts[index]; ++c)
+			{
+				ConcreteNodePtr child = buildNode(flat, strings, next, node.get());
+				if (child.isNull())
+					return child;
+				node->children.push_back(child);
+			}
+			return node;
+		}
+
+		template <typename T>
+		void writeArray(StreamSerialiser& stream, const typename vector<T>::type& values)
+		{
+			if (!values.empty())
+				stream.write(&values[0], values.size());
+		}
+
+		template <typename T>
+		void readArray(StreamSerialiser& stream, typename vector<T>::type& values, size_t count)
+		{
+			values.resize(count);
+			if (count)
+				stream.read(&values[0], count);
+		}
+
+		/// Two hashes of the contents, seeded differently
+		void hashScript(const String& script, uint32* hashes)
+		{
+			int len = static_cast<int>(script.size());
+			hashes[0] = FastHash(script.data(), len);
+			hashes[1] = FastHash(script.data(), len, static_cast<uint32>(len) ^ 0x9e3779b9);
+		}
+	}
+	//---------------------------------------------------------------------
+	ScriptCache::ScriptCache(const String& location)
+		: mLocation(location), mArchive(location, "FileSystem"),
+		mNumHits(0), mNumMisses(0)
+	{
+		mArchive.load();
+		if (mArchive.isReadOnly())
+		{
+			LogManager::getSingleton().logMessage("ScriptCache: '" + mLocation +
+				"' is not writeable, scripts will only be read from the cache.");
+		}
+	}
+	//---------------------------------------------------------------------
+	ScriptCache::~ScriptCache()
+	{
+	}
+	//---------------------------------------------------------------------
+	ConcreteNodeListPtr ScriptCache::parse(const String& script, const String& source)
+	{
+		ConcreteNodeListPtr nodes = load(script, source);
+		if (!nodes.isNull())
+		{
+			OGRE_LOCK_AUTO_MUTEX
+			++mNumHits;
+			return nodes;
+		}
+
+		ScriptLexer lexer;
+		ScriptParser parser;
+		nodes = parser.parse(lexer.tokenize(script, source));
+		{
+			OGRE_LOCK_AUTO_MUTEX
+			++mNumMisses;
+		}
+		save(nodes, script, source);
+		return nodes;
+	}
+	//---------------------------------------------------------------------
+	ConcreteNodeListPtr ScriptCache::load(const String& script, const String& source)
+	{
+		String fileName = getCacheFileName(source);
+		if (!mArchive.exists(fileName))
+			return ConcreteNodeListPtr();
+
+		try
+		{
+			DataStreamPtr data = mArchive.open(fileName);
+			StreamSerialiser stream(data);
+			const StreamSerialiser::Chunk* chunk =
+				stream.readChunkBegin(SCRIPTCACHE_CHUNK_ID, SCRIPTCACHE_CHUNK_VERSION);
+			if (!chunk)
+				return ConcreteNodeListPtr();
+
+			// Is it for this version of the script?
+			String cachedSource;
+			uint32 length;
+			uint32 hashes[2], cachedHashes[2];
+			stream.read(&cachedSource);
+			stream.read(&length);
+			stream.read(cachedHashes, 2);
+			hashScript(script, hashes);
+			if (cachedSource != source || length != script.size() ||
+				hashes[0] != cachedHashes[0] || hashes[1] != cachedHashes[1])
+			{
+				stream.readChunkEnd(SCRIPTCACHE_CHUNK_ID);
+				return ConcreteNodeListPtr();
+			}
+
+			// Counts larger than the chunk mean the file is damaged
+			uint32 numStrings, numNodes, numRoots;
+			stream.read(&numStrings);
+			if (numStrings > chunk->length)
+				return ConcreteNodeListPtr();
+			StringVector strings(numStrings);
+			for (uint32 i = 0; i < numStrings; ++i)
+				stream.read(&strings[i]);
+
+			stream.read(&numNodes);
+			stream.read(&numRoots);
+			if (numNodes > chunk->length || numRoots > numNodes)
+				return ConcreteNodeListPtr();
+			FlatNodes flat;
+			readArray<uint32>(stream, flat.tokens, numNodes);
+			readArray<uint32>(stream, flat.files, numNodes);
+			readArray<uint32>(stream, flat.lines, numNodes);
+			readArray<uint8>(stream, flat.types, numNodes);
+			readArray<uint32>(stream, flat.childCounts, numNodes);
+			stream.readChunkEnd(SCRIPTCACHE_CHUNK_ID);
+
+			ConcreteNodeListPtr nodes(OGRE_NEW_T(ConcreteNodeList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+			size_t next = 0;
+			for (uint32 i = 0; i < numRoots; ++i)
+			{
+				ConcreteNodePtr node = buildNode(flat, strings, next, 0);
+				if (node.isNull())
+					return ConcreteNodeListPtr();
+				nodes->push_back(node);
+			}
+			if (next != numNodes)
+				return ConcreteNodeListPtr();
+
+			return nodes;
+		}
+		catch (Exception& e)
+		{
+			LogManager::getSingleton().logMessage("ScriptCache: ignoring the entry for '" +
+				source + "': " + e.getFullDescription());
+			return ConcreteNodeListPtr();
+		}
+	}
+	//---------------------------------------------------------------------
+	void ScriptCache::save(const ConcreteNodeListPtr& nodes, const String& script, const String& source)
+	{
+		if (mArchive.isReadOnly())
+			return;
+
+		FlatNodes flat;
+		StringIndexMap indexes;
+		StringVector strings;
+		flattenNodes(*nodes, flat, indexes, strings);
+
+		OGRE_LOCK_AUTO_MUTEX
+		try
+		{
+			DataStreamPtr data = mArchive.create(getCacheFileName(source));
+			StreamSerialiser stream(data);
+			stream.writeChunkBegin(SCRIPTCACHE_CHUNK_ID, SCRIPTCACHE_CHUNK_VERSION);
+
+			uint32 length = static_cast<uint32>(script.size());
+			uint32 hashes[2];
+			hashScript(script, hashes);
+			stream.write(&source);
+			stream.write(&length);
+			stream.write(hashes, 2);
+
+			uint32 numStrings = static_cast<uint32>(strings.size());
+			stream.write(&numStrings);
+			for (StringVector::iterator i = strings.begin(); i != strings.end(); ++i)
+				stream.write(&(*i));
+
+			uint32 numNodes = static_cast<uint32>(flat.tokens.size());
+			uint32 numRoots = static_cast<uint32>(nodes->size());
+			stream.write(&numNodes);
+			stream.write(&numRoots);
+			writeArray<uint32>(stream, flat.tokens);
+			writeArray<uint32>(stream, flat.files);
+			writeArray<uint32>(stream, flat.lines);
+			writeArray<uint8>(stream, flat.types);
+			writeArray<uint32>(stream, flat.childCounts);
+
+			stream.writeChunkEnd(SCRIPTCACHE_CHUNK_ID);
+		}
+		catch (Exception& e)
+		{
+			// The script has been parsed, it just won't be cached
+			LogManager::getSingleton().logMessage("ScriptCache: unable to store '" +
+				source + "': " + e.getFullDescription());
+		}
+	}
+	//---------------------------------------------------------------------
+	void ScriptCache::remove(const String& source)
+	{
+		String fileName = getCacheFileName(source);
+		OGRE_LOCK_AUTO_MUTEX
+		if (!mArchive.isReadOnly() && mArchive.exists(fileName))
+			mArchive.remove(fileName);
+	}
+	//---------------------------------------------------------------------
+	void ScriptCache::resetStatistics(void)
+	{
+		OGRE_LOCK_AUTO_MUTEX
+		mNumHits = 0;
+		mNumMisses = 0;
+	}
+	//---------------------------------------------------------------------
+	String ScriptCache::getCacheFileName(const String& source) const
+	{
+		uint32 hash = FastHash(source.data(), static_cast<int>(source.size()));
+		return StringConverter::toString(hash, 8, '0', std::ios::hex) + ".scriptcache";
+	}
+
+}
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "OgreStableHeaders.h"
 #include "OgreScriptCompiler.h"
+#include "OgreScriptCache.h"
 #include "OgreScriptLexer.h"
 #include "OgreScriptParser.h"
 #include "OgreScriptTranslator.h"
@@ -281,9 +282,7 @@ namespace Ogre
 
 	bool ScriptCompiler::compile(const String &str, const String &source, const String &group)
 	{
-		ScriptLexer lexer;
-		ScriptParser parser;
-		ConcreteNodeListPtr nodes = parser.parse(lexer.tokenize(str, source));
+		ConcreteNodeListPtr nodes = parse(str, source);
 		return compile(nodes, group);
 	}
 
@@ -384,14 +383,23 @@ namespace Ogre
 		return mErrors.empty();
 	}
 
+	ConcreteNodeListPtr ScriptCompiler::parse(const String &str, const String &source)
+	{
+		ScriptCompilerManager *manager = ScriptCompilerManager::getSingletonPtr();
+		if(manager && manager->getCache())
+			return manager->getCache()->parse(str, source);
+
+		ScriptLexer lexer;
+		ScriptParser parser;
+		return parser.parse(lexer.tokenize(str, source));
+	}
+
 	AbstractNodeListPtr ScriptCompiler::_generateAST(const String &str, const String &source, bool doImports, bool doObjects, bool doVariables)
 	{
 		// Clear the past errors
 		mErrors.clear();
 
-		ScriptLexer lexer;
-		ScriptParser parser;
-		ConcreteNodeListPtr cst = parser.parse(lexer.tokenize(str, source));
+		ConcreteNodeListPtr cst = parse(str, source);
 
 		// Call the listener to intercept CST
 		if(mListener)
@@ -592,10 +600,7 @@ namespace Ogre
 			DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(name, mGroup);
 			if(!stream.isNull())
 			{
-				ScriptLexer lexer;
-				ScriptTokenListPtr tokens = lexer.tokenize(stream->getAsString(), name);
-				ScriptParser parser;
-				nodes = parser.parse(tokens);
+				nodes = parse(stream->getAsString(), name);
 			}
 		}
 
@@ -1544,7 +1549,7 @@ namespace Ogre
     }
 	//-----------------------------------------------------------------------
 	ScriptCompilerManager::ScriptCompilerManager()
-		:mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler)
+		:mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler), mCache(0)
 	{
 		OGRE_LOCK_AUTO_MUTEX
 #if OGRE_USE_NEW_COMPILERS == 1
@@ -1566,6 +1571,7 @@ namespace Ogre
 	{
 		OGRE_THREAD_POINTER_DELETE(mScriptCompiler);
 		OGRE_DELETE mBuiltinTranslatorManager;
+		OGRE_DELETE mCache;
 	}
 	//-----------------------------------------------------------------------
 	void ScriptCompilerManager::setListener(ScriptCompilerListener *listener)
@@ -1579,6 +1585,23 @@ namespace Ogre
 		return mListener;
 	}
 	//-----------------------------------------------------------------------
+	void ScriptCompilerManager::setCacheLocation(const String &location)
+	{
+		OGRE_LOCK_AUTO_MUTEX
+		OGRE_DELETE mCache;
+		mCache = location.empty() ? 0 : OGRE_NEW ScriptCache(location);
+	}
+	//-----------------------------------------------------------------------
+	const String &ScriptCompilerManager::getCacheLocation() const
+	{
+		return mCache ? mCache->getLocation() : StringUtil::BLANK;
+	}
+	//-----------------------------------------------------------------------
+	ScriptCache *ScriptCompilerManager::getCache() const
+	{
+		return mCache;
+	}
+	//-----------------------------------------------------------------------
 	void ScriptCompilerManager::addTranslatorManager(Ogre::ScriptTranslatorManager *man)
 	{
 		OGRE_LOCK_AUTO_MUTEX
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreLight.h"
 #include "OgreEdgeListBuilder.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreBitwise.h"
 
 namespace Ogre {
 	const LightList& ShadowRenderable::getLights(void) const 
@@ -44,173 +45,134 @@ namespace Ogre {
 		edgeData->updateTriangleLightFacing(lightPos);
 	}
 	// ------------------------------------------------------------------------
-	void ShadowCaster::generateShadowVolume(EdgeData* edgeData, 
-		const HardwareIndexBufferSharedPtr& indexBuffer, const Light* light,
-		ShadowRenderableList& shadowRenderables, unsigned long flags)
+	namespace
 	{
-		// Edge groups should be 1:1 with shadow renderables
-		assert(edgeData->edgeGroups.size() == shadowRenderables.size());
-
-		// Whether to use the McGuire method, a triangle fan covering all silhouette
-		// this won't work properly with multiple separate edge groups
-		bool useMcGuire = edgeData->edgeGroups.size() <= 1;
-		EdgeData::EdgeGroupList::const_iterator egi, egiend;
-		ShadowRenderableList::const_iterator si;
-
-		Light::LightTypes lightType = light->getType();
-
-		// pre-count the size of index data we need since it makes a big perf difference
-		// to GL in particular if we lock a smaller area of the index buffer
-		size_t preCountIndexes = 0;
-
-		si = shadowRenderables.begin();
-		egiend = edgeData->edgeGroups.end();
-		for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi, ++si)
+		/// Count the light facing triangles of a range of an edge list
+		size_t countLightFacingTriangles(const EdgeData* edgeData,
+			size_t triStart, size_t triCount)
 		{
-			const EdgeData::EdgeGroup& eg = *egi;
-			bool  firstDarkCapTri = true;
-
-			EdgeData::EdgeList::const_iterator i, iend;
-			iend = eg.edges.end();
-			for (i = eg.edges.begin(); i != iend; ++i)
+			size_t count = 0;
+			size_t t = triStart;
+			size_t end = triStart + triCount;
+			// Whole masks at once, once t is at the start of one
+			for ( ; t < end && (t & 31); ++t)
+				count += edgeData->isTriangleLightFacing(t);
+			for ( ; t + 32 <= end; t += 32)
+				count += Bitwise::countBitsSet(edgeData->triangleLightFacingMask[t >> 5]);
+			for ( ; t < end; ++t)
+				count += edgeData->isTriangleLightFacing(t);
+			return count;
+		}
+		/// Write the indexes of the light facing triangles of an edge group,
+		/// either as they are for a light cap or extruded and backwards for a
+		/// dark cap
+		unsigned short* writeLightFacingTriangles(const EdgeData* edgeData,
+			const EdgeData::EdgeGroup& eg, bool darkCap, unsigned short* pIdx)
+		{
+			size_t vertexOffset = darkCap ? eg.vertexData->vertexCount : 0;
+			size_t first = darkCap ? 1 : 0;
+			size_t t = eg.triStart;
+			size_t end = eg.triStart + eg.triCount;
+			while (t < end)
 			{
-				const EdgeData::Edge& edge = *i;
-
-				// Silhouette edge, when two tris has opposite light facing, or
-				// degenerate edge where only tri 1 is valid and the tri light facing
-				char lightFacing = edgeData->triangleLightFacings[edge.triIndex[0]];
-				if ((edge.degenerate && lightFacing) ||
-					(!edge.degenerate && (lightFacing != edgeData->triangleLightFacings[edge.triIndex[1]])))
+				uint32 bits = edgeData->triangleLightFacingMask[t >> 5] >> (t & 31);
+				if (!bits)
 				{
-
-					preCountIndexes += 3;
-
-					// Are we extruding to infinity?
-					if (!(lightType == Light::LT_DIRECTIONAL &&
-						flags & SRF_EXTRUDE_TO_INFINITY))
-					{
-						preCountIndexes += 3;
-					}
-
-					if(useMcGuire)
-					{
-						// Do dark cap tri
-						// Use McGuire et al method, a triangle fan covering all silhouette
-						// edges and one point (taken from the initial tri)
-						if (flags & SRF_INCLUDE_DARK_CAP)
-						{
-							if (firstDarkCapTri)
-							{
-								firstDarkCapTri = false;
-							}
-							else
-							{
-								preCountIndexes += 3;
-							}
-						}
-					}
+					// Nothing else in this mask is light facing
+					t = (t | 31) + 1;
+					continue;
 				}
-
-			}
-
-			if(useMcGuire)
-			{
-				// Do light cap
-				if (flags & SRF_INCLUDE_LIGHT_CAP) 
+				if (bits & 1)
 				{
-					// Iterate over the triangles which are using this vertex set
-					EdgeData::TriangleList::const_iterator ti, tiend;
-					EdgeData::TriangleLightFacingList::const_iterator lfi;
-					ti = edgeData->triangles.begin() + eg.triStart;
-					tiend = ti + eg.triCount;
-					lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-					for ( ; ti != tiend; ++ti, ++lfi)
-					{
-						assert(ti->vertexSet == eg.vertexSet);
-						// Check it's light facing
-						if (*lfi)
-						{
-							preCountIndexes += 3;
-						}
-					}
-
+					const EdgeData::Triangle& tri = edgeData->triangles[t];
+					assert(tri.vertexSet == eg.vertexSet);
+					assert(tri.vertIndex[0] < 65536 && tri.vertIndex[1] < 65536 &&
+						tri.vertIndex[2] < 65536 && 
+						"16-bit index limit exceeded!");
+					*pIdx++ = static_cast<unsigned short>(tri.vertIndex[first] + vertexOffset);
+					*pIdx++ = static_cast<unsigned short>(tri.vertIndex[1 - first] + vertexOffset);
+					*pIdx++ = static_cast<unsigned short>(tri.vertIndex[2] + vertexOffset);
 				}
+				++t;
 			}
-			else
+			return pIdx;
+		}
+		/// Whether to use the McGuire method, a triangle fan covering all
+		/// silhouette edges for the dark cap; this won't work properly with
+		/// multiple separate edge groups
+		bool useMcGuireDarkCap(const EdgeData* edgeData)
+		{
+			return edgeData->edgeGroups.size() <= 1;
+		}
+		/// Count the indexes writeShadowVolumeIndexes will write
+		size_t countShadowVolumeIndexes(const EdgeData* edgeData,
+			Light::LightTypes lightType, unsigned long flags)
+		{
+			bool useMcGuire = useMcGuireDarkCap(edgeData);
+			// We emit 2 tris per edge if the light is a point light, 1 if it
+			// is directional and extruded to infinity
+			size_t sideIndexes = (lightType == Light::LT_DIRECTIONAL &&
+				flags & SRF_EXTRUDE_TO_INFINITY) ? 3 : 6;
+			size_t capIndexes = 0;
+			if (flags & SRF_INCLUDE_LIGHT_CAP)
+				capIndexes += 3;
+			if (!useMcGuire && (flags & SRF_INCLUDE_DARK_CAP))
+				capIndexes += 3;
+
+			size_t count = 0;
+			for (size_t g = 0; g < edgeData->edgeGroups.size(); ++g)
 			{
-				// Do both caps
-				int increment = ((flags & SRF_INCLUDE_DARK_CAP) ? 3 : 0) + ((flags & SRF_INCLUDE_LIGHT_CAP) ? 3 : 0);
-				if(increment != 0)
-				{
-					// Iterate over the triangles which are using this vertex set
-					EdgeData::TriangleList::const_iterator ti, tiend;
-					EdgeData::TriangleLightFacingList::const_iterator lfi;
-					ti = edgeData->triangles.begin() + eg.triStart;
-					tiend = ti + eg.triCount;
-					lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-					for ( ; ti != tiend; ++ti, ++lfi)
-					{
-						assert(ti->vertexSet == eg.vertexSet);
-						// Check it's light facing
-						if (*lfi)
-							preCountIndexes += increment;
-					}
-					break;
-				}
+				const EdgeData::EdgeGroup& eg = edgeData->edgeGroups[g];
+				size_t numSilhouetteEdges =
+					(edgeData->silhouetteEdgeStarts[g + 1] - edgeData->silhouetteEdgeStarts[g]) / 2;
+				count += numSilhouetteEdges * sideIndexes;
+				// The fan has a tri for every edge but the first
+				if (useMcGuire && (flags & SRF_INCLUDE_DARK_CAP) && numSilhouetteEdges > 1)
+					count += (numSilhouetteEdges - 1) * 3;
+				if (capIndexes)
+					count += capIndexes * countLightFacingTriangles(edgeData, eg.triStart, eg.triCount);
 			}
+			return count;
 		}
-		// End pre-count
-
-
-		// Lock index buffer for writing, just enough length as we need
-		unsigned short* pIdx = static_cast<unsigned short*>(
-			indexBuffer->lock(0, sizeof(unsigned short) * preCountIndexes, 
-			HardwareBuffer::HBL_DISCARD));
-		size_t numIndices = 0;
-
-		// Iterate over the groups and form renderables for each based on their
-		// lightFacing
-		si = shadowRenderables.begin();
-		egiend = edgeData->edgeGroups.end();
-		for (egi = edgeData->edgeGroups.begin(); egi != egiend; ++egi, ++si)
+		/// Write the indexes of the shadow volume for the silhouette found by
+		/// EdgeData::updateSilhouetteEdges, and update the index ranges of
+		/// the renderables
+		size_t writeShadowVolumeIndexes(const EdgeData* edgeData,
+			Light::LightTypes lightType, ShadowCaster::ShadowRenderableList& shadowRenderables,
+			unsigned long flags, unsigned short* pIdx)
 		{
-			const EdgeData::EdgeGroup& eg = *egi;
-			// Initialise the index start for this shadow renderable
-			IndexData* indexData = (*si)->getRenderOperationForUpdate()->indexData;
-			indexData->indexStart = numIndices;
-			// original number of verts (without extruded copy)
-			size_t originalVertexCount = eg.vertexData->vertexCount;
-			bool  firstDarkCapTri = true;
-			unsigned short darkCapStart = 0;
-
-			EdgeData::EdgeList::const_iterator i, iend;
-			iend = eg.edges.end();
-			for (i = eg.edges.begin(); i != iend; ++i)
+			bool useMcGuire = useMcGuireDarkCap(edgeData);
+			bool extrudeToInfinity = lightType == Light::LT_DIRECTIONAL &&
+				(flags & SRF_EXTRUDE_TO_INFINITY);
+			unsigned short* pStart = pIdx;
+
+			// Iterate over the groups and form renderables for each based on their
+			// lightFacing
+			for (size_t g = 0; g < edgeData->edgeGroups.size(); ++g)
 			{
-				const EdgeData::Edge& edge = *i;
-
-				// Silhouette edge, when two tris has opposite light facing, or
-				// degenerate edge where only tri 1 is valid and the tri light facing
-				char lightFacing = edgeData->triangleLightFacings[edge.triIndex[0]];
-				if ((edge.degenerate && lightFacing) ||
-					(!edge.degenerate && (lightFacing != edgeData->triangleLightFacings[edge.triIndex[1]])))
+				const EdgeData::EdgeGroup& eg = edgeData->edgeGroups[g];
+				ShadowRenderable* sr = shadowRenderables[g];
+				// Initialise the index start for this shadow renderable
+				IndexData* indexData = sr->getRenderOperationForUpdate()->indexData;
+				indexData->indexStart = pIdx - pStart;
+				// original number of verts (without extruded copy)
+				size_t originalVertexCount = eg.vertexData->vertexCount;
+
+				// offset from the start of the list; the range of a trailing
+				// group with no silhouette edges starts at the end of it
+				const uint32* silhouette = edgeData->silhouetteEdges.empty() ? 0 :
+					&edgeData->silhouetteEdges[0] + edgeData->silhouetteEdgeStarts[g];
+				const uint32* silhouetteEnd = silhouette +
+					(edgeData->silhouetteEdgeStarts[g + 1] - edgeData->silhouetteEdgeStarts[g]);
+				for (const uint32* e = silhouette; e != silhouetteEnd; e += 2)
 				{
-					size_t v0 = edge.vertIndex[0];
-					size_t v1 = edge.vertIndex[1];
-					if (!lightFacing)
-					{
-						// Inverse edge indexes when t1 is light away
-						std::swap(v0, v1);
-					}
+					size_t v0 = e[0];
+					size_t v1 = e[1];
 
 					/* Note edge(v0, v1) run anticlockwise along the edge from
 					the light facing tri so to point shadow volume tris outward,
 					light cap indexes have to be backwards
 
-					We emit 2 tris if light is a point light, 1 if light 
-					is directional, because directional lights cause all
-					points to converge to a single point at infinity.
-
 					First side tri = near1, near0, far0
 					Second tri = far0, far1, near1
 
@@ -223,130 +185,249 @@ namespace Ogre {
 					*pIdx++ = static_cast<unsigned short>(v1);
 					*pIdx++ = static_cast<unsigned short>(v0);
 					*pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
-					numIndices += 3;
 
-					// Are we extruding to infinity?
-					if (!(lightType == Light::LT_DIRECTIONAL &&
-						flags & SRF_EXTRUDE_TO_INFINITY))
+					// Directional lights cause all points to converge to a
+					// single point at infinity, so need no second tri
+					if (!extrudeToInfinity)
 					{
 						// additional tri to make quad
 						*pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
 						*pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
 						*pIdx++ = static_cast<unsigned short>(v1);
-						numIndices += 3;
 					}
+				}
 
-					if(useMcGuire)
+				// Do dark cap
+				if (flags & SRF_INCLUDE_DARK_CAP)
+				{
+					if (useMcGuire)
 					{
-						// Do dark cap tri
 						// Use McGuire et al method, a triangle fan covering all silhouette
 						// edges and one point (taken from the initial tri)
-						if (flags & SRF_INCLUDE_DARK_CAP)
+						if (silhouetteEnd - silhouette > 2)
 						{
-							if (firstDarkCapTri)
-							{
-								darkCapStart = static_cast<unsigned short>(v0 + originalVertexCount);
-								firstDarkCapTri = false;
-							}
-							else
+							unsigned short darkCapStart =
+								static_cast<unsigned short>(silhouette[0] + originalVertexCount);
+							for (const uint32* e = silhouette + 2; e != silhouetteEnd; e += 2)
 							{
 								*pIdx++ = darkCapStart;
-								*pIdx++ = static_cast<unsigned short>(v1 + originalVertexCount);
-								*pIdx++ = static_cast<unsigned short>(v0 + originalVertexCount);
-								numIndices += 3;
+								*pIdx++ = static_cast<unsigned short>(e[1] + originalVertexCount);
+								*pIdx++ = static_cast<unsigned short>(e[0] + originalVertexCount);
 							}
-
 						}
 					}
-				}
-
-			}
-
-			if(!useMcGuire)
-			{
-				// Do dark cap
-				if (flags & SRF_INCLUDE_DARK_CAP) 
-				{
-					// Iterate over the triangles which are using this vertex set
-					EdgeData::TriangleList::const_iterator ti, tiend;
-					EdgeData::TriangleLightFacingList::const_iterator lfi;
-					ti = edgeData->triangles.begin() + eg.triStart;
-					tiend = ti + eg.triCount;
-					lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-					for ( ; ti != tiend; ++ti, ++lfi)
+					else
 					{
-						const EdgeData::Triangle& t = *ti;
-						assert(t.vertexSet == eg.vertexSet);
-						// Check it's light facing
-						if (*lfi)
-						{
-							assert(t.vertIndex[0] < 65536 && t.vertIndex[1] < 65536 &&
-								t.vertIndex[2] < 65536 && 
-								"16-bit index limit exceeded!");
-							*pIdx++ = static_cast<unsigned short>(t.vertIndex[1] + originalVertexCount);
-							*pIdx++ = static_cast<unsigned short>(t.vertIndex[0] + originalVertexCount);
-							*pIdx++ = static_cast<unsigned short>(t.vertIndex[2] + originalVertexCount);
-							numIndices += 3;
-						}
+						pIdx = writeLightFacingTriangles(edgeData, eg, true, pIdx);
 					}
-
 				}
-			}
 
-			// Do light cap
-			if (flags & SRF_INCLUDE_LIGHT_CAP) 
-			{
-				// separate light cap?
-				if ((*si)->isLightCapSeparate())
-				{
-					// update index count for this shadow renderable
-					indexData->indexCount = numIndices - indexData->indexStart;
-
-					// get light cap index data for update
-					indexData = (*si)->getLightCapRenderable()->getRenderOperationForUpdate()->indexData;
-					// start indexes after the current total
-					indexData->indexStart = numIndices;
-				}
-
-				// Iterate over the triangles which are using this vertex set
-				EdgeData::TriangleList::const_iterator ti, tiend;
-				EdgeData::TriangleLightFacingList::const_iterator lfi;
-				ti = edgeData->triangles.begin() + eg.triStart;
-				tiend = ti + eg.triCount;
-				lfi = edgeData->triangleLightFacings.begin() + eg.triStart;
-				for ( ; ti != tiend; ++ti, ++lfi)
+				// Do light cap
+				if (flags & SRF_INCLUDE_LIGHT_CAP) 
 				{
-					const EdgeData::Triangle& t = *ti;
-					assert(t.vertexSet == eg.vertexSet);
-					// Check it's light facing
-					if (*lfi)
+					// separate light cap?
+					if (sr->isLightCapSeparate())
 					{
-						assert(t.vertIndex[0] < 65536 && t.vertIndex[1] < 65536 &&
-							t.vertIndex[2] < 65536 && 
-							"16-bit index limit exceeded!");
-						*pIdx++ = static_cast<unsigned short>(t.vertIndex[0]);
-						*pIdx++ = static_cast<unsigned short>(t.vertIndex[1]);
-						*pIdx++ = static_cast<unsigned short>(t.vertIndex[2]);
-						numIndices += 3;
+						// update index count for this shadow renderable
+						indexData->indexCount = (pIdx - pStart) - indexData->indexStart;
+
+						// get light cap index data for update
+						indexData = sr->getLightCapRenderable()->getRenderOperationForUpdate()->indexData;
+						// start indexes after the current total
+						indexData->indexStart = pIdx - pStart;
 					}
+
+					pIdx = writeLightFacingTriangles(edgeData, eg, false, pIdx);
 				}
 
+				// update index count for current index data (either this shadow renderable or its light cap)
+				indexData->indexCount = (pIdx - pStart) - indexData->indexStart;
 			}
 
-			// update index count for current index data (either this shadow renderable or its light cap)
-			indexData->indexCount = numIndices - indexData->indexStart;
-
+			return pIdx - pStart;
 		}
+	}
+	// ------------------------------------------------------------------------
+	/// Shadow volume indexes generated for a light
+	struct ShadowCaster::CachedShadowVolume : public ShadowDataAlloc
+	{
+		/// The light position, in object space
+		Vector4 lightPos;
+		unsigned long flags;
+		/// EdgeData::generation of the edge list, as its address may be
+		/// reused by a rebuilt one
+		uint32 edgeDataGeneration;
+		/// The renderables the indexes are for
+		ShadowRenderableList renderables;
+		/// Index start and count of each renderable, followed by those of
+		/// its light cap
+		vector<size_t>::type ranges;
+		vector<unsigned short>::type indexes;
+	};
+	// ------------------------------------------------------------------------
+	ShadowCaster::ShadowCaster()
+		: mShadowVolumeCacheSize(4)
+	{
+	}
+	// ------------------------------------------------------------------------
+	ShadowCaster::~ShadowCaster()
+	{
+		clearCachedShadowVolumes();
+	}
+	// ------------------------------------------------------------------------
+	void ShadowCaster::setShadowVolumeCacheSize(size_t numLights)
+	{
+		mShadowVolumeCacheSize = numLights;
+		while (mCachedShadowVolumes.size() > numLights)
+		{
+			OGRE_DELETE mCachedShadowVolumes.back();
+			mCachedShadowVolumes.pop_back();
+		}
+	}
+	// ------------------------------------------------------------------------
+	void ShadowCaster::clearCachedShadowVolumes(void)
+	{
+		for (CachedShadowVolumeList::iterator i = mCachedShadowVolumes.begin();
+			i != mCachedShadowVolumes.end(); ++i)
+		{
+			OGRE_DELETE *i;
+		}
+		mCachedShadowVolumes.clear();
+	}
+	// ------------------------------------------------------------------------
+	void ShadowCaster::generateShadowVolume(EdgeData* edgeData, 
+		const HardwareIndexBufferSharedPtr& indexBuffer, const Light* light,
+		ShadowRenderableList& shadowRenderables, unsigned long flags)
+	{
+		// Edge groups should be 1:1 with shadow renderables
+		assert(edgeData->edgeGroups.size() == shadowRenderables.size());
+
+		edgeData->updateSilhouetteEdges();
+
+		// pre-count the size of index data we need since it makes a big perf difference
+		// to GL in particular if we lock a smaller area of the index buffer
+		Light::LightTypes lightType = light->getType();
+		size_t preCountIndexes = countShadowVolumeIndexes(edgeData, lightType, flags);
 
+		// Lock index buffer for writing, just enough length as we need
+		unsigned short* pIdx = static_cast<unsigned short*>(
+			indexBuffer->lock(0, sizeof(unsigned short) * preCountIndexes, 
+			HardwareBuffer::HBL_DISCARD));
+		size_t numIndices = writeShadowVolumeIndexes(edgeData, lightType,
+			shadowRenderables, flags, pIdx);
 
 		// Unlock index buffer
 		indexBuffer->unlock();
 
+		assert(numIndices == preCountIndexes && "Shadow volume index count mismatch");
 		// In debug mode, check we didn't overrun the index buffer
 		assert(numIndices <= indexBuffer->getNumIndexes() &&
 			"Index buffer overrun while generating shadow volume!! "
 			"You must increase the size of the shadow index buffer.");
+		(void)numIndices; // only checked in debug builds
+
+	}
+	// ------------------------------------------------------------------------
+	void ShadowCaster::updateShadowVolume(EdgeData* edgeData, 
+		const HardwareIndexBufferSharedPtr& indexBuffer, const Light* light,
+		const Vector4& lightPos, ShadowRenderableList& shadowRenderables,
+		unsigned long flags, bool cacheable)
+	{
+		if (!cacheable || !mShadowVolumeCacheSize)
+		{
+			updateEdgeListLightFacing(edgeData, lightPos);
+			generateShadowVolume(edgeData, indexBuffer, light, shadowRenderables, flags);
+			return;
+		}
+
+		// Edge groups should be 1:1 with shadow renderables
+		assert(edgeData->edgeGroups.size() == shadowRenderables.size());
 
+		// Look for a light which hasn't moved relative to this caster since
+		CachedShadowVolumeList::iterator i, iend;
+		iend = mCachedShadowVolumes.end();
+		for (i = mCachedShadowVolumes.begin(); i != iend; ++i)
+		{
+			const CachedShadowVolume* cached = *i;
+			if (cached->edgeDataGeneration == edgeData->generation && cached->flags == flags &&
+				cached->lightPos == lightPos && cached->renderables == shadowRenderables)
+			{
+				break;
+			}
+		}
+
+		CachedShadowVolume* volume;
+		if (i != iend)
+		{
+			volume = *i;
+			mCachedShadowVolumes.erase(i);
+
+			// Put the index ranges back, another light may have changed them
+			const size_t* range = volume->ranges.empty() ? 0 : &volume->ranges[0];
+			for (ShadowRenderableList::iterator si = shadowRenderables.begin();
+				si != shadowRenderables.end(); ++si, range += 4)
+			{
+				IndexData* indexData = (*si)->getRenderOperationForUpdate()->indexData;
+				indexData->indexStart = range[0];
+				indexData->indexCount = range[1];
+				if ((*si)->getLightCapRenderable())
+				{
+					indexData = (*si)->getLightCapRenderable()->getRenderOperationForUpdate()->indexData;
+					indexData->indexStart = range[2];
+					indexData->indexCount = range[3];
+				}
+			}
+		}
+		else
+		{
+			// Replace the least recently used volume if there's no room
+			if (mCachedShadowVolumes.size() >= mShadowVolumeCacheSize)
+			{
+				volume = mCachedShadowVolumes.back();
+				mCachedShadowVolumes.pop_back();
+			}
+			else
+			{
+				volume = OGRE_NEW CachedShadowVolume();
+			}
+
+			updateEdgeListLightFacing(edgeData, lightPos);
+			edgeData->updateSilhouetteEdges();
+			Light::LightTypes lightType = light->getType();
+			volume->indexes.resize(countShadowVolumeIndexes(edgeData, lightType, flags));
+			writeShadowVolumeIndexes(edgeData, lightType, shadowRenderables, flags,
+				volume->indexes.empty() ? 0 : &volume->indexes[0]);
+
+			volume->lightPos = lightPos;
+			volume->flags = flags;
+			volume->edgeDataGeneration = edgeData->generation;
+			volume->renderables = shadowRenderables;
+			volume->ranges.clear();
+			for (ShadowRenderableList::iterator si = shadowRenderables.begin();
+				si != shadowRenderables.end(); ++si)
+			{
+				const IndexData* indexData = (*si)->getRenderOperationForUpdate()->indexData;
+				volume->ranges.push_back(indexData->indexStart);
+				volume->ranges.push_back(indexData->indexCount);
+				ShadowRenderable* lightCap = (*si)->getLightCapRenderable();
+				indexData = lightCap ? lightCap->getRenderOperationForUpdate()->indexData : 0;
+				volume->ranges.push_back(indexData ? indexData->indexStart : 0);
+				volume->ranges.push_back(indexData ? indexData->indexCount : 0);
+			}
+		}
+		mCachedShadowVolumes.insert(mCachedShadowVolumes.begin(), volume);
+
+		// In debug mode, check we won't overrun the index buffer
+		assert(volume->indexes.size() <= indexBuffer->getNumIndexes() &&
+			"Index buffer overrun while generating shadow volume!! "
+			"You must increase the size of the shadow index buffer.");
+
+		// The index buffer is shared with other casters, so is always written
+		if (!volume->indexes.empty())
+		{
+			indexBuffer->writeData(0, sizeof(unsigned short) * volume->indexes.size(),
+				&volume->indexes[0], true);
+		}
 	}
 	// ------------------------------------------------------------------------
 	void ShadowCaster::extrudeVertices(
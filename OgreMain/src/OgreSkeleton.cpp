@@ -204,6 +204,21 @@ namespace Ogre {
         return mRootBones[0];
     }
     //---------------------------------------------------------------------
+    void Skeleton::_prepareAnimationState(const AnimationStateSet& animSet) const
+    {
+        ConstEnabledAnimationStateIterator stateIt = 
+            animSet.getEnabledAnimationStateIterator();
+        while (stateIt.hasMoreElements())
+        {
+            const AnimationState* animState = stateIt.getNext();
+            Animation* anim = _getAnimationImpl(animState->getAnimationName());
+            if (anim)
+            {
+                anim->_prepareForApply();
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     void Skeleton::setAnimationState(const AnimationStateSet& animSet)
     {
         /* 
@@ -685,6 +700,16 @@ namespace Ogre {
 		}
 	}
 	//---------------------------------------------------------------------
+	void Skeleton::compressAllAnimations(Real translationTolerance,
+		const Radian& rotationTolerance, Real scaleTolerance)
+	{
+		AnimationList::iterator ai;
+		for (ai = mAnimationsList.begin(); ai != mAnimationsList.end(); ++ai)
+		{
+			ai->second->compressNodeTracks(translationTolerance, rotationTolerance, scaleTolerance);
+		}
+	}
+	//---------------------------------------------------------------------
 	void Skeleton::addLinkedSkeletonAnimationSource(const String& skelName, 
 		Real scale)
 	{
@@ -44,12 +44,16 @@ THE SOFTWARE.
 namespace Ogre {
     /// stream overhead = ID + size
     const long STREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+    /// Version written unless there are compressed tracks
+    const char* const SKELETON_VERSION = "[Serializer_v1.10]";
+    /// Version written when there are compressed tracks, which older versions can't read
+    const char* const SKELETON_VERSION_COMPRESSED = "[Serializer_v1.20]";
     //---------------------------------------------------------------------
     SkeletonSerializer::SkeletonSerializer()
     {
         // Version number
         // NB changed to include bone names in 1.1
-        mVersion = "[Serializer_v1.10]";
+        mVersion = SKELETON_VERSION;
     }
     //---------------------------------------------------------------------
     SkeletonSerializer::~SkeletonSerializer()
@@ -71,6 +75,7 @@ namespace Ogre {
 				"SkeletonSerializer::exportSkeleton");
 		}
 
+        mVersion = hasCompressedTracks(pSkeleton) ? SKELETON_VERSION_COMPRESSED : SKELETON_VERSION;
         writeFileHeader();
 
         // Write main skeleton data
@@ -110,7 +115,16 @@ namespace Ogre {
 		// Determine endianness (must be the first thing we do!)
 		determineEndianness(stream);
 
-		// Check header
+		// Pick the version to accept from the header, then check it
+		size_t start = stream->tell();
+		unsigned short headerID;
+		readShorts(stream, &headerID, 1);
+		mVersion = SKELETON_VERSION;
+		if (headerID == SKELETON_HEADER && readString(stream) == SKELETON_VERSION_COMPRESSED)
+		{
+			mVersion = SKELETON_VERSION_COMPRESSED;
+		}
+		stream->seek(start);
         readFileHeader(stream);
 
         unsigned short streamID;
@@ -210,7 +224,16 @@ namespace Ogre {
         Animation::NodeTrackIterator trackIt = anim->getNodeTrackIterator();
         while(trackIt.hasMoreElements())
         {
-            writeAnimationTrack(pSkel, trackIt.getNext());
+            const NodeAnimationTrack* track = trackIt.getNext();
+            if (track->isCompressed())
+            {
+                writeCompressedAnimationTrack(pSkel, 
+                    static_cast<const CompressedNodeAnimationTrack*>(track));
+            }
+            else
+            {
+                writeAnimationTrack(pSkel, track);
+            }
         }
 
     }
@@ -233,6 +256,43 @@ namespace Ogre {
 
     }
     //---------------------------------------------------------------------
+    void SkeletonSerializer::writeCompressedAnimationTrack(const Skeleton* pSkel, 
+        const CompressedNodeAnimationTrack* track)
+    {
+        writeChunkHeader(SKELETON_ANIMATION_TRACK_COMPRESSED, 
+            calcCompressedAnimationTrackSize(pSkel, track));
+
+        // unsigned short boneIndex     : Index of bone to apply to
+        Bone* bone = (Bone*)track->getAssociatedNode();
+        unsigned short boneid = bone->getHandle();
+        writeShorts(&boneid, 1);
+        // unsigned short numKeyFrames  : Number of keyframes
+        unsigned short numKeyFrames = track->getNumKeyFrames();
+        writeShorts(&numKeyFrames, 1);
+        // unsigned short channels      : Channels with a value per keyframe
+        writeShorts(&track->mChannels, 1);
+        if (!numKeyFrames)
+            return;
+
+        // float times[numKeyFrames]
+        writeFloats(&track->mKeyTimes[0], numKeyFrames);
+        // Rotations, or the rotation of every keyframe
+        if (track->mChannels & CompressedNodeAnimationTrack::CH_ROTATION)
+            writeShorts(&track->mRotations[0], track->mRotations.size());
+        else
+            writeObject(track->mConstantRotation);
+        // Translation range, and translations
+        writeObject(track->mTranslateBase);
+        writeObject(track->mTranslateExtent);
+        if (track->mChannels & CompressedNodeAnimationTrack::CH_TRANSLATION)
+            writeShorts(&track->mTranslations[0], track->mTranslations.size());
+        // Scale range, and scales
+        writeObject(track->mScaleBase);
+        writeObject(track->mScaleExtent);
+        if (track->mChannels & CompressedNodeAnimationTrack::CH_SCALE)
+            writeShorts(&track->mScales[0], track->mScales.size());
+    }
+    //---------------------------------------------------------------------
     void SkeletonSerializer::writeKeyFrame(const Skeleton* pSkel, 
         const TransformKeyFrame* key)
     {
@@ -321,7 +381,16 @@ namespace Ogre {
 		Animation::NodeTrackIterator trackIt = pAnim->getNodeTrackIterator();
 		while(trackIt.hasMoreElements())
 		{
-            size += calcAnimationTrackSize(pSkel, trackIt.getNext());
+            const NodeAnimationTrack* track = trackIt.getNext();
+            if (track->isCompressed())
+            {
+                size += calcCompressedAnimationTrackSize(pSkel, 
+                    static_cast<const CompressedNodeAnimationTrack*>(track));
+            }
+            else
+            {
+                size += calcAnimationTrackSize(pSkel, track);
+            }
         }
 
         return size;
@@ -344,6 +413,33 @@ namespace Ogre {
         return size;
     }
     //---------------------------------------------------------------------
+    size_t SkeletonSerializer::calcCompressedAnimationTrackSize(const Skeleton* pSkel, 
+        const CompressedNodeAnimationTrack* pTrack)
+    {
+        size_t size = STREAM_OVERHEAD_SIZE;
+
+        // boneIndex, numKeyFrames, channels
+        size += sizeof(unsigned short) * 3;
+        if (!pTrack->getNumKeyFrames())
+            return size;
+
+        // times
+        size += sizeof(float) * pTrack->getNumKeyFrames();
+        // rotations or constant rotation
+        if (pTrack->mChannels & CompressedNodeAnimationTrack::CH_ROTATION)
+            size += sizeof(unsigned short) * pTrack->mRotations.size();
+        else
+            size += sizeof(float) * 4;
+        // translation range and translations
+        size += sizeof(float) * 6;
+        size += sizeof(unsigned short) * pTrack->mTranslations.size();
+        // scale range and scales
+        size += sizeof(float) * 6;
+        size += sizeof(unsigned short) * pTrack->mScales.size();
+
+        return size;
+    }
+    //---------------------------------------------------------------------
     size_t SkeletonSerializer::calcKeyFrameSize(const Skeleton* pSkel, 
         const TransformKeyFrame* pKey)
     {
@@ -442,9 +538,13 @@ namespace Ogre {
         if (!stream->eof())
         {
             unsigned short streamID = readChunk(stream);
-            while(streamID == SKELETON_ANIMATION_TRACK && !stream->eof())
+            while((streamID == SKELETON_ANIMATION_TRACK || 
+                streamID == SKELETON_ANIMATION_TRACK_COMPRESSED) && !stream->eof())
             {
-                readAnimationTrack(stream, pAnim, pSkel);
+                if (streamID == SKELETON_ANIMATION_TRACK_COMPRESSED)
+                    readCompressedAnimationTrack(stream, pAnim, pSkel);
+                else
+                    readAnimationTrack(stream, pAnim, pSkel);
 
                 if (!stream->eof())
                 {
@@ -500,6 +600,59 @@ namespace Ogre {
         }
 
 
+    }
+    //---------------------------------------------------------------------
+    void SkeletonSerializer::readCompressedAnimationTrack(DataStreamPtr& stream, Animation* anim, 
+        Skeleton* pSkel)
+    {
+        // unsigned short boneIndex     : Index of bone to apply to
+        unsigned short boneHandle;
+        readShorts(stream, &boneHandle, 1);
+        // unsigned short numKeyFrames  : Number of keyframes
+        unsigned short numKeyFrames;
+        readShorts(stream, &numKeyFrames, 1);
+
+        // Find bone and create track
+        Bone *targetBone = pSkel->getBone(boneHandle);
+        CompressedNodeAnimationTrack* pTrack = anim->createCompressedNodeTrack(boneHandle, targetBone);
+
+        // unsigned short channels      : Channels with a value per keyframe
+        readShorts(stream, &pTrack->mChannels, 1);
+        if (!numKeyFrames)
+            return;
+
+        // float times[numKeyFrames]
+        pTrack->mKeyTimes.resize(numKeyFrames);
+        readFloats(stream, &pTrack->mKeyTimes[0], numKeyFrames);
+        // Rotations, or the rotation of every keyframe
+        if (pTrack->mChannels & CompressedNodeAnimationTrack::CH_ROTATION)
+        {
+            pTrack->mRotations.resize(numKeyFrames * 3);
+            readShorts(stream, &pTrack->mRotations[0], pTrack->mRotations.size());
+        }
+        else
+        {
+            readObject(stream, pTrack->mConstantRotation);
+        }
+        // Translation range, and translations
+        readObject(stream, pTrack->mTranslateBase);
+        readObject(stream, pTrack->mTranslateExtent);
+        if (pTrack->mChannels & CompressedNodeAnimationTrack::CH_TRANSLATION)
+        {
+            pTrack->mTranslations.resize(numKeyFrames * 3);
+            readShorts(stream, &pTrack->mTranslations[0], pTrack->mTranslations.size());
+        }
+        // Scale range, and scales
+        readObject(stream, pTrack->mScaleBase);
+        readObject(stream, pTrack->mScaleExtent);
+        if (pTrack->mChannels & CompressedNodeAnimationTrack::CH_SCALE)
+        {
+            pTrack->mScales.resize(numKeyFrames * 3);
+            readShorts(stream, &pTrack->mScales[0], pTrack->mScales.size());
+        }
+
+        pTrack->_keyFrameDataChanged();
+        anim->_keyFrameListChanged();
     }
     //---------------------------------------------------------------------
     void SkeletonSerializer::readKeyFrame(DataStreamPtr& stream, NodeAnimationTrack* track, 
@@ -555,6 +708,20 @@ namespace Ogre {
 
 	}
 	//---------------------------------------------------------------------
+	bool SkeletonSerializer::hasCompressedTracks(const Skeleton* pSkel) const
+	{
+		for (unsigned short a = 0; a < pSkel->getNumAnimations(); ++a)
+		{
+			Animation::NodeTrackIterator trackIt = pSkel->getAnimation(a)->getNodeTrackIterator();
+			while(trackIt.hasMoreElements())
+			{
+				if (trackIt.getNext()->isCompressed())
+					return true;
+			}
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
 	void SkeletonSerializer::readSkeletonAnimationLink(DataStreamPtr& stream, 
 		Skeleton* pSkel)
 	{
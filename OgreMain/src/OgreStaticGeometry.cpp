@@ -40,6 +40,8 @@ THE SOFTWARE.
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
 #include "OgreEdgeListBuilder.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreParallelTaskDispatcher.h"
 
 namespace Ogre {
 
@@ -48,6 +50,95 @@ namespace Ogre {
 	#define REGION_MAX_INDEX 511
 	#define REGION_MIN_INDEX -512
 
+	namespace
+	{
+		typedef StaticGeometry::MaterialBucket::GeometryBucketList GeometryBucketList;
+
+		/// Bakes geometry buckets from a ParallelTaskDispatcher
+		class GeometryBakeTaskSet : public ParallelTaskDispatcher::TaskSet
+		{
+		public:
+			GeometryBakeTaskSet(const GeometryBucketList& buckets,
+				const StaticGeometry::SourceBufferLockMap& locks)
+				: mBuckets(buckets), mLocks(locks) {}
+
+			void processTasks(size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					mBuckets[i]->_bakeGeometry(mLocks);
+				}
+			}
+		protected:
+			const GeometryBucketList& mBuckets;
+			const StaticGeometry::SourceBufferLockMap& mLocks;
+		};
+		//--------------------------------------------------------------------------
+		void unlockSourceBuffers(StaticGeometry::SourceBufferLockMap& locks)
+		{
+			for (StaticGeometry::SourceBufferLockMap::iterator i = locks.begin();
+				i != locks.end(); ++i)
+			{
+				i->first->unlock();
+			}
+			locks.clear();
+		}
+		//--------------------------------------------------------------------------
+		/** Fill geometry buckets which have begun building, using the 
+			dispatcher to spread them between threads if there is one. 
+		*/
+		void bakeGeometryBuckets(const GeometryBucketList& buckets,
+			ParallelTaskDispatcher* dispatcher)
+		{
+			// Source buffers can be shared between buckets, so they're locked
+			// up front rather than by each (concurrent) bake
+			StaticGeometry::SourceBufferLockMap locks;
+			for (GeometryBucketList::const_iterator i = buckets.begin(); i != buckets.end(); ++i)
+			{
+				(*i)->_lockSourceBuffers(locks);
+			}
+
+			GeometryBakeTaskSet tasks(buckets, locks);
+			try
+			{
+				if (dispatcher && buckets.size() > 1)
+					dispatcher->dispatch(&tasks, buckets.size());
+				else
+					tasks.processTasks(0, buckets.size());
+			}
+			catch (...)
+			{
+				unlockSourceBuffers(locks);
+				throw;
+			}
+			unlockSourceBuffers(locks);
+		}
+		//--------------------------------------------------------------------------
+		void collectGeometryBuckets(StaticGeometry::LODBucket* lodBucket, 
+			GeometryBucketList& buckets)
+		{
+			StaticGeometry::LODBucket::MaterialIterator mi = lodBucket->getMaterialIterator();
+			while (mi.hasMoreElements())
+			{
+				StaticGeometry::MaterialBucket::GeometryIterator gi = 
+					mi.getNext()->getGeometryIterator();
+				while (gi.hasMoreElements())
+				{
+					buckets.push_back(gi.getNext());
+				}
+			}
+		}
+		//--------------------------------------------------------------------------
+		void collectGeometryBuckets(StaticGeometry::Region* region, 
+			GeometryBucketList& buckets)
+		{
+			StaticGeometry::Region::LODIterator li = region->getLODIterator();
+			while (li.hasMoreElements())
+			{
+				collectGeometryBuckets(li.getNext(), buckets);
+			}
+		}
+	}
 	//--------------------------------------------------------------------------
 	StaticGeometry::StaticGeometry(SceneManager* owner, const String& name):
 		mOwner(owner),
@@ -62,7 +153,9 @@ namespace Ogre {
 		mVisible(true),
         mRenderQueueID(RENDER_QUEUE_MAIN),
         mRenderQueueIDSet(false),
-		mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags())
+		mVisibilityFlags(Ogre::MovableObject::getDefaultVisibilityFlags()),
+		mParallelBuild(false),
+		mBuildListener(0)
 	{
 	}
 	//--------------------------------------------------------------------------
@@ -564,16 +657,51 @@ namespace Ogre {
 			stencilShadows = true;
 		}
 
-		// Now tell each region to build itself
-		for (RegionMap::iterator ri = mRegionMap.begin();
-			ri != mRegionMap.end(); ++ri)
+		ParallelTaskDispatcher* dispatcher = 0;
+		size_t minBatchBuckets = 1;
+		if (mParallelBuild)
 		{
-			ri->second->build(stencilShadows);
-			
-			// Set the visibility flags on these regions
-			ri->second->setVisibilityFlags(mVisibilityFlags);
+			dispatcher = mOwner->getParallelDispatcher();
+			// Enough buckets to share out between the threads
+			minBatchBuckets = dispatcher->getConcurrency() * 4;
 		}
 
+		// Now build the regions a batch at a time. Creating and locking the 
+		// buffers has to be done on this thread, filling them doesn't.
+		size_t regionsBuilt = 0;
+		RegionMap::iterator ri = mRegionMap.begin();
+		while (ri != mRegionMap.end())
+		{
+			vector<Region*>::type batch;
+			GeometryBucketList buckets;
+			while (ri != mRegionMap.end() && 
+				(batch.empty() || buckets.size() < minBatchBuckets))
+			{
+				Region* region = ri->second;
+				region->_beginBuild(stencilShadows);
+				collectGeometryBuckets(region, buckets);
+				batch.push_back(region);
+				++ri;
+			}
+
+			bakeGeometryBuckets(buckets, dispatcher);
+
+			for (vector<Region*>::type::iterator bi = batch.begin(); bi != batch.end(); ++bi)
+			{
+				(*bi)->_endBuild(stencilShadows);
+
+				// Set the visibility flags on these regions
+				(*bi)->setVisibilityFlags(mVisibilityFlags);
+			}
+
+			regionsBuilt += batch.size();
+			if (mBuildListener)
+				mBuildListener->buildProgress(this, regionsBuilt, mRegionMap.size());
+		}
+
+		if (mBuildListener)
+			mBuildListener->buildComplete(this);
+
 	}
 	//--------------------------------------------------------------------------
 	void StaticGeometry::destroy(void)
@@ -792,6 +920,15 @@ namespace Ogre {
 	}
 	//--------------------------------------------------------------------------
 	void StaticGeometry::Region::build(bool stencilShadows)
+	{
+		_beginBuild(stencilShadows);
+		GeometryBucketList buckets;
+		collectGeometryBuckets(this, buckets);
+		bakeGeometryBuckets(buckets, 0);
+		_endBuild(stencilShadows);
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::Region::_beginBuild(bool stencilShadows)
 	{
 		// Create a node
 		mNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(mName,
@@ -813,12 +950,18 @@ namespace Ogre {
 				lodBucket->assign(*qi, lod);
 			}
 			// now build
-			lodBucket->build(stencilShadows);
+			lodBucket->_beginBuild(stencilShadows);
 		}
-
-
-
-					}
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::Region::_endBuild(bool stencilShadows)
+	{
+		for (LODBucketList::iterator i = mLodBucketList.begin(); 
+			i != mLodBucketList.end(); ++i)
+		{
+			(*i)->_endBuild(stencilShadows);
+		}
+	}
 	//--------------------------------------------------------------------------
 	const String& StaticGeometry::Region::getMovableType(void) const
 	{
@@ -913,12 +1056,9 @@ namespace Ogre {
 		EdgeData* edgeList = mLodBucketList[mCurrentLod]->getEdgeList();
 		ShadowRenderableList& shadowRendList = mLodBucketList[mCurrentLod]->getShadowRenderableList();
 
-		// Calc triangle light facing
-		updateEdgeListLightFacing(edgeList, lightPos);
-
-		// Generate indexes and update renderables
-		generateShadowVolume(edgeList, *indexBuffer, light,
-			shadowRendList, flags);
+		// Calc triangle light facing, generate indexes and update renderables
+		updateShadowVolume(edgeList, *indexBuffer, light, lightPos,
+			shadowRendList, flags, true);
 
 
 		return ShadowCaster::ShadowRenderableListIterator(shadowRendList.begin(), shadowRendList.end());
@@ -1085,6 +1225,25 @@ namespace Ogre {
 	}
 	//--------------------------------------------------------------------------
 	void StaticGeometry::LODBucket::build(bool stencilShadows)
+	{
+		_beginBuild(stencilShadows);
+		GeometryBucketList buckets;
+		collectGeometryBuckets(this, buckets);
+		bakeGeometryBuckets(buckets, 0);
+		_endBuild(stencilShadows);
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::LODBucket::_beginBuild(bool stencilShadows)
+	{
+		// Just pass this on to child buckets
+		for (MaterialBucketMap::iterator i = mMaterialBucketMap.begin();
+			i != mMaterialBucketMap.end(); ++i)
+		{
+			i->second->_beginBuild(stencilShadows);
+		}
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::LODBucket::_endBuild(bool stencilShadows)
 	{
 
 		EdgeListBuilder eb;
@@ -1096,7 +1255,7 @@ namespace Ogre {
 		{
 			MaterialBucket* mat = i->second;
 
-			mat->build(stencilShadows);
+			mat->_endBuild();
 
 			if (stencilShadows)
 			{
@@ -1297,6 +1456,13 @@ namespace Ogre {
 	}
 	//--------------------------------------------------------------------------
 	void StaticGeometry::MaterialBucket::build(bool stencilShadows)
+	{
+		_beginBuild(stencilShadows);
+		bakeGeometryBuckets(mGeometryBucketList, 0);
+		_endBuild();
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::MaterialBucket::_beginBuild(bool stencilShadows)
 	{
 		mTechnique = 0;
 		mMaterial = MaterialManager::getSingleton().getByName(mMaterialName);
@@ -1311,7 +1477,16 @@ namespace Ogre {
 		for (GeometryBucketList::iterator i = mGeometryBucketList.begin();
 			i != mGeometryBucketList.end(); ++i)
 		{
-			(*i)->build(stencilShadows);
+			(*i)->_beginBuild(stencilShadows);
+		}
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::MaterialBucket::_endBuild(void)
+	{
+		for (GeometryBucketList::iterator i = mGeometryBucketList.begin();
+			i != mGeometryBucketList.end(); ++i)
+		{
+			(*i)->_endBuild();
 		}
 	}
 	//--------------------------------------------------------------------------
@@ -1408,6 +1583,7 @@ namespace Ogre {
 		const String& formatString, const VertexData* vData,
 		const IndexData* iData)
 		: Renderable(), mParent(parent), mFormatString(formatString)
+		, mIndexLock(0), mStencilShadows(false)
 	{
 		// Clone the structure from the example
 		mVertexData = vData->clone(false);
@@ -1525,8 +1701,15 @@ namespace Ogre {
 	//--------------------------------------------------------------------------
 	void StaticGeometry::GeometryBucket::build(bool stencilShadows)
 	{
-		// Ok, here's where we transfer the vertices and indexes to the shared
-		// buffers
+		_beginBuild(stencilShadows);
+		GeometryBucketList buckets(1, this);
+		bakeGeometryBuckets(buckets, 0);
+		_endBuild();
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::GeometryBucket::_beginBuild(bool stencilShadows)
+	{
+		// Create the shared buffers and leave them locked ready for baking
 		// Shortcuts
 		VertexDeclaration* dcl = mVertexData->vertexDeclaration;
 		VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
@@ -1535,25 +1718,12 @@ namespace Ogre {
 		mIndexData->indexBuffer = HardwareBufferManager::getSingleton()
 			.createIndexBuffer(mIndexType, mIndexData->indexCount,
 				HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-		uint32* p32Dest = 0;
-		uint16* p16Dest = 0;
-		if (mIndexType == HardwareIndexBuffer::IT_32BIT)
-		{
-			p32Dest = static_cast<uint32*>(
-				mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
-		}
-		else
-		{
-			p16Dest = static_cast<uint16*>(
-				mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
-		}
+		mIndexLock = mIndexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD);
+
 		// create all vertex buffers, and lock
-		ushort b;
 		ushort posBufferIdx = dcl->findElementBySemantic(VES_POSITION)->getSource();
-
-		vector<uchar*>::type destBufferLocks;
-		vector<VertexDeclaration::VertexElementList>::type bufferElements;
-		for (b = 0; b < binds->getBufferCount(); ++b)
+		mVertexLocks.clear();
+		for (ushort b = 0; b < binds->getBufferCount(); ++b)
 		{
 			size_t vertexCount = mVertexData->vertexCount;
 			// Need to double the vertex count for the position buffer
@@ -1571,13 +1741,59 @@ namespace Ogre {
 					vertexCount,
 					HardwareBuffer::HBU_STATIC_WRITE_ONLY);
 			binds->setBinding(b, vbuf);
-			uchar* pLock = static_cast<uchar*>(
-				vbuf->lock(HardwareBuffer::HBL_DISCARD));
-			destBufferLocks.push_back(pLock);
-			// Pre-cache vertex elements per buffer
-			bufferElements.push_back(dcl->findElementsBySource(b));
+			mVertexLocks.push_back(static_cast<uchar*>(
+				vbuf->lock(HardwareBuffer::HBL_DISCARD)));
+		}
+		mStencilShadows = stencilShadows;
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::GeometryBucket::_lockSourceBuffers(SourceBufferLockMap& locks)
+	{
+		for (QueuedGeometryList::iterator gi = mQueuedGeometry.begin(); 
+			gi != mQueuedGeometry.end(); ++gi)
+		{
+			SubMeshLodGeometryLink* geom = (*gi)->geometry;
+			HardwareBuffer* ibuf = geom->indexData->indexBuffer.get();
+			if (locks.find(ibuf) == locks.end())
+			{
+				locks[ibuf] = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
+			}
+			VertexBufferBinding* srcBinds = geom->vertexData->vertexBufferBinding;
+			for (ushort b = 0; b < srcBinds->getBufferCount(); ++b)
+			{
+				HardwareBuffer* vbuf = srcBinds->getBuffer(b).get();
+				if (locks.find(vbuf) == locks.end())
+				{
+					locks[vbuf] = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+				}
+			}
 		}
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::GeometryBucket::_bakeGeometry(const SourceBufferLockMap& locks)
+	{
+		// Ok, here's where we transfer the vertices and indexes to the shared
+		// buffers. Only touches memory which is already locked, so it's safe
+		// to bake different buckets at the same time.
+		VertexDeclaration* dcl = mVertexData->vertexDeclaration;
+		VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+		OptimisedUtil* util = OptimisedUtil::getImplementation();
 
+		uint32* p32Dest = 0;
+		uint16* p16Dest = 0;
+		if (mIndexType == HardwareIndexBuffer::IT_32BIT)
+			p32Dest = static_cast<uint32*>(mIndexLock);
+		else
+			p16Dest = static_cast<uint16*>(mIndexLock);
+
+		ushort b;
+		vector<uchar*>::type destBufferLocks = mVertexLocks;
+		// Pre-cache vertex elements per buffer
+		vector<VertexDeclaration::VertexElementList>::type bufferElements;
+		for (b = 0; b < binds->getBufferCount(); ++b)
+		{
+			bufferElements.push_back(dcl->findElementsBySource(b));
+		}
 
 		// Iterate over the geometry items
 		size_t indexOffset = 0;
@@ -1589,128 +1805,102 @@ namespace Ogre {
 			QueuedGeometry* geom = *gi;
 			// Copy indexes across with offset
 			IndexData* srcIdxData = geom->geometry->indexData;
+			const uchar* pSrcIdx = static_cast<const uchar*>(
+				locks.find(srcIdxData->indexBuffer.get())->second) +
+				srcIdxData->indexStart * srcIdxData->indexBuffer->getIndexSize();
 			if (mIndexType == HardwareIndexBuffer::IT_32BIT)
 			{
-				// Lock source indexes
-				uint32* pSrc = static_cast<uint32*>(
-					srcIdxData->indexBuffer->lock(
-						srcIdxData->indexStart, 
-						srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-						HardwareBuffer::HBL_READ_ONLY));
-
-				copyIndexes(pSrc, p32Dest, srcIdxData->indexCount, indexOffset);
+				copyIndexes(reinterpret_cast<const uint32*>(pSrcIdx), 
+					p32Dest, srcIdxData->indexCount, indexOffset);
 				p32Dest += srcIdxData->indexCount;
-				srcIdxData->indexBuffer->unlock();
 			}
 			else
 			{
-				// Lock source indexes
-				uint16* pSrc = static_cast<uint16*>(
-					srcIdxData->indexBuffer->lock(
-					srcIdxData->indexStart, 
-					srcIdxData->indexCount * srcIdxData->indexBuffer->getIndexSize(),
-					HardwareBuffer::HBL_READ_ONLY));
-
-				copyIndexes(pSrc, p16Dest, srcIdxData->indexCount, indexOffset);
+				copyIndexes(reinterpret_cast<const uint16*>(pSrcIdx), 
+					p16Dest, srcIdxData->indexCount, indexOffset);
 				p16Dest += srcIdxData->indexCount;
-				srcIdxData->indexBuffer->unlock();
 			}
 
+			// Positions get the full transform relative to the region centre,
+			// directions the rotation and inverted scale only
+			Matrix4 posXform, dirXform;
+			posXform.makeTransform(geom->position - regionCentre, 
+				geom->scale, geom->orientation);
+			dirXform.makeTransform(Vector3::ZERO, 
+				Vector3::UNIT_SCALE / geom->scale, geom->orientation);
+
 			// Now deal with vertex buffers
 			// we can rely on buffer counts / formats being the same
 			VertexData* srcVData = geom->geometry->vertexData;
 			VertexBufferBinding* srcBinds = srcVData->vertexBufferBinding;
+			size_t vertexCount = srcVData->vertexCount;
 			for (b = 0; b < binds->getBufferCount(); ++b)
 			{
-				// lock source
 				HardwareVertexBufferSharedPtr srcBuf =
 					srcBinds->getBuffer(b);
-				uchar* pSrcBase = static_cast<uchar*>(
-					srcBuf->lock(HardwareBuffer::HBL_READ_ONLY));
+				const uchar* pSrcBase = static_cast<const uchar*>(
+					locks.find(srcBuf.get())->second);
 				// Get buffer lock pointer, we'll update this later
 				uchar* pDstBase = destBufferLocks[b];
 				size_t bufInc = srcBuf->getVertexSize();
 
-				// Iterate over vertices
-				float *pSrcReal, *pDstReal;
-				Vector3 tmp;
-				for (size_t v = 0; v < srcVData->vertexCount; ++v)
+				// Raw copy everything, then transform the spatial elements
+				// over the whole run of vertices
+				memcpy(pDstBase, pSrcBase, bufInc * vertexCount);
+
+				VertexDeclaration::VertexElementList& elems = bufferElements[b];
+				VertexDeclaration::VertexElementList::iterator ei;
+				for (ei = elems.begin(); ei != elems.end(); ++ei)
 				{
-					// Iterate over vertex elements
-					VertexDeclaration::VertexElementList& elems =
-						bufferElements[b];
-					VertexDeclaration::VertexElementList::iterator ei;
-					for (ei = elems.begin(); ei != elems.end(); ++ei)
+					const VertexElement& elem = *ei;
+					const float* pSrcReal = reinterpret_cast<const float*>(
+						pSrcBase + elem.getOffset());
+					float* pDstReal = reinterpret_cast<float*>(
+						pDstBase + elem.getOffset());
+					switch (elem.getSemantic())
 					{
-						VertexElement& elem = *ei;
-						elem.baseVertexPointerToElement(pSrcBase, &pSrcReal);
-						elem.baseVertexPointerToElement(pDstBase, &pDstReal);
-						switch (elem.getSemantic())
-						{
-						case VES_POSITION:
-							tmp.x = *pSrcReal++;
-							tmp.y = *pSrcReal++;
-							tmp.z = *pSrcReal++;
-							// transform
-							tmp = (geom->orientation * (tmp * geom->scale)) +
-								geom->position;
-							// Adjust for region centre
-							tmp -= regionCentre;
-							*pDstReal++ = tmp.x;
-							*pDstReal++ = tmp.y;
-							*pDstReal++ = tmp.z;
-							break;
-						case VES_NORMAL:
-						case VES_TANGENT:
-						case VES_BINORMAL:
-							tmp.x = *pSrcReal++;
-							tmp.y = *pSrcReal++;
-							tmp.z = *pSrcReal++;
-							// scale (invert)
-							tmp = tmp / geom->scale;
-							tmp.normalise();
-							// rotation
-							tmp = geom->orientation * tmp;
-							*pDstReal++ = tmp.x;
-							*pDstReal++ = tmp.y;
-							*pDstReal++ = tmp.z;
-							// copy parity for tangent.
-							if (elem.getType() == Ogre::VET_FLOAT4)
-								*pDstReal = *pSrcReal;
-							break;
-						default:
-							// just raw copy
-							memcpy(pDstReal, pSrcReal,
-									VertexElement::getTypeSize(elem.getType()));
-							break;
-						};
-
-					}
-
-					// Increment both pointers
-					pDstBase += bufInc;
-					pSrcBase += bufInc;
-
+					case VES_POSITION:
+						util->transformAffineVertices(posXform, 
+							pSrcReal, bufInc, pDstReal, bufInc, vertexCount, false);
+						break;
+					case VES_NORMAL:
+					case VES_TANGENT:
+					case VES_BINORMAL:
+						// parity for 4D tangents was copied above
+						util->transformAffineVertices(dirXform, 
+							pSrcReal, bufInc, pDstReal, bufInc, vertexCount, true);
+						break;
+					default:
+						break;
+					};
 				}
 
 				// Update pointer
-				destBufferLocks[b] = pDstBase;
-				srcBuf->unlock();
+				destBufferLocks[b] = pDstBase + bufInc * vertexCount;
 			}
 
-			indexOffset += geom->geometry->vertexData->vertexCount;
+			indexOffset += vertexCount;
 		}
+	}
+	//--------------------------------------------------------------------------
+	void StaticGeometry::GeometryBucket::_endBuild(void)
+	{
+		VertexDeclaration* dcl = mVertexData->vertexDeclaration;
+		VertexBufferBinding* binds = mVertexData->vertexBufferBinding;
+		ushort posBufferIdx = dcl->findElementBySemantic(VES_POSITION)->getSource();
 
 		// Unlock everything
 		mIndexData->indexBuffer->unlock();
-		for (b = 0; b < binds->getBufferCount(); ++b)
+		mIndexLock = 0;
+		for (ushort b = 0; b < binds->getBufferCount(); ++b)
 		{
 			binds->getBuffer(b)->unlock();
 		}
+		mVertexLocks.clear();
 
 		// If we're dealing with stencil shadows, copy the position data from
 		// the early half of the buffer to the latter part
-		if (stencilShadows)
+		if (mStencilShadows)
 		{
 			HardwareVertexBufferSharedPtr buf = binds->getBuffer(posBufferIdx);
 			void* pSrc = buf->lock(HardwareBuffer::HBL_NORMAL);
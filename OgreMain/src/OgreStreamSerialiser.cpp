@@ -42,6 +42,9 @@ THE SOFTWARE.
 #include "OgreNode.h"
 #include "OgreRay.h"
 #include "OgreSphere.h"
+#if OGRE_NO_ZIP_ARCHIVE == 0
+#include <zlib.h>
+#endif
 
 namespace Ogre
 {
@@ -448,6 +451,41 @@ namespace Ogre
 			mStream->write(buf, totSize);
 		}
 
+	}
+	//---------------------------------------------------------------------
+	void StreamSerialiser::writeCompressedData(const void* buf, size_t size)
+	{
+#if OGRE_NO_ZIP_ARCHIVE == 0
+		uLongf compressedSize = compressBound(static_cast<uLong>(size));
+		Bytef* pCompressed = static_cast<Bytef*>(OGRE_MALLOC(compressedSize, MEMCATEGORY_GENERAL));
+		int result = compress2(pCompressed, &compressedSize, 
+			static_cast<const Bytef*>(buf), static_cast<uLong>(size), Z_BEST_SPEED);
+		if (result != Z_OK)
+		{
+			OGRE_FREE(pCompressed, MEMCATEGORY_GENERAL);
+			OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, 
+				"zlib error " + StringConverter::toString(result) + " while compressing", 
+				"StreamSerialiser::writeCompressedData");
+		}
+
+		uint32 compressedSize32 = static_cast<uint32>(compressedSize);
+		write(&compressedSize32);
+		writeData(pCompressed, 1, compressedSize);
+		OGRE_FREE(pCompressed, MEMCATEGORY_GENERAL);
+#else
+		OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, 
+			"OGRE was built without zlib, compressed data is not supported", 
+			"StreamSerialiser::writeCompressedData");
+#endif
+	}
+	//---------------------------------------------------------------------
+	bool StreamSerialiser::isCompressionSupported()
+	{
+#if OGRE_NO_ZIP_ARCHIVE == 0
+		return true;
+#else
+		return false;
+#endif
 	}
 	//---------------------------------------------------------------------
 	void StreamSerialiser::write(const Vector2* vec, size_t count)
@@ -587,6 +625,38 @@ namespace Ogre
 		if (mFlipEndian)
 			flipEndian(buf, size, count);
 
+	}
+	//---------------------------------------------------------------------
+	void StreamSerialiser::readCompressedData(void* buf, size_t size)
+	{
+#if OGRE_NO_ZIP_ARCHIVE == 0
+		uint32 compressedSize;
+		read(&compressedSize);
+		// don't trust a size larger than the whole stream
+		if (mStream->size() && compressedSize > mStream->size())
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Compressed data is larger than the stream, the stream is corrupt", 
+				"StreamSerialiser::readCompressedData");
+		}
+
+		Bytef* pCompressed = static_cast<Bytef*>(OGRE_MALLOC(compressedSize, MEMCATEGORY_GENERAL));
+		readData(pCompressed, 1, compressedSize);
+		uLongf uncompressedSize = static_cast<uLongf>(size);
+		int result = uncompress(static_cast<Bytef*>(buf), &uncompressedSize, 
+			pCompressed, compressedSize);
+		OGRE_FREE(pCompressed, MEMCATEGORY_GENERAL);
+		if (result != Z_OK || uncompressedSize != size)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Compressed data did not uncompress to the expected size, the stream is corrupt", 
+				"StreamSerialiser::readCompressedData");
+		}
+#else
+		OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, 
+			"OGRE was built without zlib, compressed data is not supported", 
+			"StreamSerialiser::readCompressedData");
+#endif
 	}
 	//---------------------------------------------------------------------
 	void StreamSerialiser::read(Vector2* vec, size_t count)
@@ -0,0 +1,316 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreTraceProfiler.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include <fstream>
+
+namespace Ogre {
+	//-----------------------------------------------------------------------
+	template<> TraceProfiler* Singleton<TraceProfiler>::ms_Singleton = 0;
+	TraceProfiler* TraceProfiler::getSingletonPtr(void)
+	{
+		return ms_Singleton;
+	}
+	TraceProfiler& TraceProfiler::getSingleton(void)
+	{
+		assert( ms_Singleton );  return ( *ms_Singleton );
+	}
+	//-----------------------------------------------------------------------
+	TraceMarker::TraceMarker(const char* markerName, uint32 markerGroupID)
+		: name(markerName)
+		, groupID(markerGroupID)
+		, hash(FastHash(markerName, (int)strlen(markerName)))
+	{
+	}
+	//-----------------------------------------------------------------------
+	/// Marker for the events recorded by markFrame
+	static const TraceMarker msFrameMarker("Frame", (uint32)OGREPROF_GENERAL);
+	//-----------------------------------------------------------------------
+	TraceProfiler::TraceProfiler(size_t eventsPerThread)
+		: OGRE_THREAD_POINTER_INIT(mThreadHandle)
+		, mCapacity(1)
+		, mEnabled(false)
+		, mProfileMask(0xFFFFFFFF)
+		, mFrameCount(0)
+	{
+		// A power of 2, so that positions in the ring can be masked
+		while (mCapacity < eventsPerThread)
+			mCapacity <<= 1;
+	}
+	//-----------------------------------------------------------------------
+	TraceProfiler::~TraceProfiler()
+	{
+		OGRE_THREAD_POINTER_DELETE(mThreadHandle);
+
+		for (ThreadBufferList::iterator i = mThreads.begin(); i != mThreads.end(); ++i)
+		{
+			if ((*i)->events)
+				OGRE_FREE((*i)->events, MEMCATEGORY_GENERAL);
+			OGRE_DELETE *i;
+		}
+	}
+	//-----------------------------------------------------------------------
+	TraceProfiler::ThreadBuffer* TraceProfiler::getThreadBuffer(void)
+	{
+		ThreadHandle* handle = OGRE_THREAD_POINTER_GET(mThreadHandle);
+		if (handle)
+			return handle->buffer;
+
+		ThreadBuffer* thread = OGRE_NEW ThreadBuffer();
+		{
+			OGRE_LOCK_MUTEX(mThreadsMutex)
+			thread->index = (uint32)mThreads.size();
+			thread->name = thread->index ? "Thread " + StringConverter::toString(thread->index) : "Main";
+			mThreads.push_back(thread);
+		}
+
+		handle = OGRE_NEW ThreadHandle();
+		handle->buffer = thread;
+		OGRE_THREAD_POINTER_SET(mThreadHandle, handle);
+		return thread;
+	}
+	//-----------------------------------------------------------------------
+	void* TraceProfiler::beginEvent(const TraceMarker& marker)
+	{
+		ThreadBuffer* thread = getThreadBuffer();
+		if (thread->depth < MAX_DEPTH)
+		{
+			thread->openMarker[thread->depth] = &marker;
+			thread->openStart[thread->depth] = mTimer.getMicroseconds();
+		}
+		// Events nested too deeply are counted, but not recorded
+		++thread->depth;
+		return thread;
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::endEvent(void* threadHandle)
+	{
+		ThreadBuffer* thread = static_cast<ThreadBuffer*>(threadHandle);
+		assert(thread->depth > 0 && "endEvent called without beginEvent");
+		--thread->depth;
+		if (thread->depth < MAX_DEPTH)
+		{
+			record(thread, thread->openMarker[thread->depth], thread->openStart[thread->depth],
+				mTimer.getMicroseconds(), thread->depth);
+		}
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::record(ThreadBuffer* thread, const TraceMarker* marker,
+		unsigned long start, unsigned long end, size_t depth)
+	{
+		if (!thread->events)
+		{
+			thread->events = static_cast<TraceEvent*>(
+				OGRE_MALLOC(sizeof(TraceEvent) * mCapacity, MEMCATEGORY_GENERAL));
+		}
+
+		// Only this thread writes, so the slot can be filled before the count
+		// is published to readers
+		size_t written = thread->written.get();
+		TraceEvent& e = thread->events[written & (mCapacity - 1)];
+		e.marker = marker;
+		e.threadIndex = thread->index;
+		e.depth = (uint32)depth;
+		e.start = start;
+		e.duration = end - start;
+		thread->written.set(written + 1);
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::markFrame(void)
+	{
+		++mFrameCount;
+		if (!mEnabled)
+			return;
+
+		ThreadBuffer* thread = getThreadBuffer();
+		unsigned long now = mTimer.getMicroseconds();
+		if (thread->frameOpen && (msFrameMarker.groupID & mProfileMask))
+			record(thread, &msFrameMarker, thread->frameStart, now, 0);
+		thread->frameStart = now;
+		thread->frameOpen = true;
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::setThreadName(const String& name)
+	{
+		ThreadBuffer* thread = getThreadBuffer();
+		OGRE_LOCK_MUTEX(mThreadsMutex)
+		thread->name = name;
+	}
+	//-----------------------------------------------------------------------
+	String TraceProfiler::getThreadName(uint32 threadIndex) const
+	{
+		OGRE_LOCK_MUTEX(mThreadsMutex)
+		return threadIndex < mThreads.size() ? mThreads[threadIndex]->name : StringUtil::BLANK;
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::getEvents(TraceEventList& events) const
+	{
+		OGRE_LOCK_MUTEX(mThreadsMutex)
+		for (ThreadBufferList::const_iterator i = mThreads.begin(); i != mThreads.end(); ++i)
+		{
+			// The ring is allocated before the first event is counted
+			const ThreadBuffer* thread = *i;
+			size_t end = thread->written.get();
+			if (!end)
+				continue;
+
+			size_t begin = end > mCapacity ? end - mCapacity : 0;
+			begin = std::max(begin, thread->discarded);
+			size_t first = events.size();
+			for (size_t n = begin; n < end; ++n)
+				events.push_back(thread->events[n & (mCapacity - 1)]);
+
+			// The owner may have wrapped around while we copied; drop anything
+			// which could have been overwritten, including the slot it may be
+			// writing now
+			size_t after = thread->written.get();
+			size_t valid = after + 1 > mCapacity ? after + 1 - mCapacity : 0;
+			if (valid > begin)
+			{
+				size_t stale = std::min(valid - begin, end - begin);
+				events.erase(events.begin() + first, events.begin() + first + stale);
+			}
+		}
+	}
+	//-----------------------------------------------------------------------
+	/// Write a string as a JSON string literal
+	static void writeJsonString(std::ostream& stream, const String& str)
+	{
+		stream << '"';
+		for (String::const_iterator i = str.begin(); i != str.end(); ++i)
+		{
+			unsigned char c = (unsigned char)*i;
+			if (c == '"' || c == '\\')
+				stream << '\\' << *i;
+			else if (c < 0x20)
+				stream << ' ';
+			else
+				stream << *i;
+		}
+		stream << '"';
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::exportChromeTrace(std::ostream& stream) const
+	{
+		TraceEventList events;
+		getEvents(events);
+
+		stream << "{\"traceEvents\":[";
+		bool first = true;
+		{
+			OGRE_LOCK_MUTEX(mThreadsMutex)
+			for (ThreadBufferList::const_iterator i = mThreads.begin(); i != mThreads.end(); ++i)
+			{
+				if (!first)
+					stream << ",";
+				first = false;
+				stream << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (*i)->index
+					<< ",\"args\":{\"name\":";
+				writeJsonString(stream, (*i)->name);
+				stream << "}}";
+			}
+		}
+
+		for (TraceEventList::const_iterator i = events.begin(); i != events.end(); ++i)
+		{
+			if (!first)
+				stream << ",";
+			first = false;
+			stream << "\n{\"name\":";
+			writeJsonString(stream, i->marker->name);
+			stream << ",\"cat\":\"" << std::hex << i->marker->groupID << std::dec
+				<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << i->threadIndex
+				<< ",\"ts\":" << i->start << ",\"dur\":" << i->duration << "}";
+		}
+		stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	}
+	//-----------------------------------------------------------------------
+	bool TraceProfiler::exportChromeTrace(const String& filename) const
+	{
+		std::ofstream stream(filename.c_str());
+		if (!stream)
+			return false;
+		exportChromeTrace(stream);
+		return !stream.fail();
+	}
+	//-----------------------------------------------------------------------
+	/// Totals for the events of markers with the same name
+	struct TraceMarkerSummary
+	{
+		const char* name;
+		size_t calls;
+		unsigned long total;
+		unsigned long max;
+	};
+	//-----------------------------------------------------------------------
+	void TraceProfiler::logSummary(void) const
+	{
+		typedef map<uint32, TraceMarkerSummary>::type MarkerSummaryMap;
+		TraceEventList events;
+		getEvents(events);
+
+		MarkerSummaryMap summaries;
+		for (TraceEventList::const_iterator i = events.begin(); i != events.end(); ++i)
+		{
+			MarkerSummaryMap::iterator s = summaries.find(i->marker->hash);
+			if (s == summaries.end())
+			{
+				TraceMarkerSummary summary = { i->marker->name, 0, 0, 0 };
+				s = summaries.insert(MarkerSummaryMap::value_type(i->marker->hash, summary)).first;
+			}
+			++s->second.calls;
+			s->second.total += i->duration;
+			s->second.max = std::max(s->second.max, i->duration);
+		}
+
+		LogManager::getSingleton().logMessage("----------------------Trace Summary----------------------");
+		LogManager::getSingleton().logMessage("Name | Calls | Total (ms) | Average (ms) | Max (ms)");
+		for (MarkerSummaryMap::const_iterator s = summaries.begin(); s != summaries.end(); ++s)
+		{
+			const TraceMarkerSummary& summary = s->second;
+			LogManager::getSingleton().stream() << summary.name << " | " << summary.calls << " | "
+				<< summary.total / 1000.0 << " | " << summary.total / 1000.0 / summary.calls << " | "
+				<< summary.max / 1000.0;
+		}
+		LogManager::getSingleton().logMessage("---------------------------------------------------------");
+	}
+	//-----------------------------------------------------------------------
+	void TraceProfiler::reset(void)
+	{
+		// Threads may still be recording, so rather than clearing the rings
+		// the events recorded so far are hidden from readers
+		OGRE_LOCK_MUTEX(mThreadsMutex)
+		for (ThreadBufferList::iterator i = mThreads.begin(); i != mThreads.end(); ++i)
+		{
+			(*i)->discarded = (*i)->written.get();
+		}
+	}
+
+}
@@ -0,0 +1,365 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreTransformPool.h"
+#include "OgreSceneNode.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	TransformPool::TransformPool(SceneNode* root)
+		: mRoot(root)
+		, mHierarchyDirty(true)
+		, mNodeCount(0)
+		, mCapacity(0)
+		, mParentCapacity(0)
+	{
+		memset(&mLocal, 0, sizeof(TransformArrays));
+		memset(&mDerived, 0, sizeof(TransformArrays));
+		memset(&mParentDerived, 0, sizeof(TransformArrays));
+	}
+	//---------------------------------------------------------------------
+	TransformPool::~TransformPool()
+	{
+		for (NodeList::iterator i = mNodes.begin(); i != mNodes.end(); ++i)
+		{
+			if (*i)
+				(*i)->mTransformPool = 0;
+		}
+
+		freeArrays(mLocal);
+		freeArrays(mDerived);
+		freeArrays(mParentDerived);
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::allocateArrays(TransformArrays& arrays, size_t count)
+	{
+		// One block for all components; count is a multiple of 4 so every
+		// component stays aligned
+		float* p = static_cast<float*>(OGRE_MALLOC_SIMD(sizeof(float) * count * 10, MEMCATEGORY_SCENE_CONTROL));
+		arrays.posX = p;
+		arrays.posY = p + count;
+		arrays.posZ = p + count * 2;
+		arrays.rotW = p + count * 3;
+		arrays.rotX = p + count * 4;
+		arrays.rotY = p + count * 5;
+		arrays.rotZ = p + count * 6;
+		arrays.scaleX = p + count * 7;
+		arrays.scaleY = p + count * 8;
+		arrays.scaleZ = p + count * 9;
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::freeArrays(TransformArrays& arrays)
+	{
+		if (arrays.posX)
+			OGRE_FREE_SIMD(arrays.posX, MEMCATEGORY_SCENE_CONTROL);
+		memset(&arrays, 0, sizeof(TransformArrays));
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::_notifyNodeDestroyed(size_t index)
+	{
+		if (mNodes[index] == mRoot)
+			mRoot = 0;
+		mNodes[index] = 0;
+		mDirty[index] = 0;
+		mHierarchyDirty = true;
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::rebuild(void)
+	{
+		for (NodeList::iterator i = mNodes.begin(); i != mNodes.end(); ++i)
+		{
+			if (*i)
+				(*i)->mTransformPool = 0;
+		}
+		mNodes.clear();
+		mParents.clear();
+		mVisits.clear();
+		mLevels.clear();
+		mNodeCount = 0;
+		mHierarchyDirty = false;
+
+		if (!mRoot)
+			return;
+
+		// Breadth first, padding the start of each level to a multiple of 4
+		size_t maxLevelCount = 0;
+		Level level;
+		level.start = 0;
+		level.count = 1;
+		mNodes.push_back(mRoot);
+		mParents.push_back(0);
+		while (true)
+		{
+			mLevels.push_back(level);
+			mNodeCount += level.count;
+			maxLevelCount = std::max(maxLevelCount, level.count);
+
+			while (mNodes.size() % 4)
+			{
+				mNodes.push_back(0);
+				mParents.push_back(level.start);
+			}
+
+			Level next;
+			next.start = mNodes.size();
+			for (size_t slot = level.start; slot < level.start + level.count; ++slot)
+			{
+				Node::ChildNodeMap& children = mNodes[slot]->mChildren;
+				for (Node::ChildNodeMap::iterator c = children.begin(); c != children.end(); ++c)
+				{
+					mNodes.push_back(static_cast<SceneNode*>(c->second));
+					mParents.push_back(slot);
+				}
+			}
+			next.count = mNodes.size() - next.start;
+			if (!next.count)
+				break;
+			level = next;
+		}
+
+		// The children of a slot are contiguous in the next level, so the
+		// depth first order can be worked out from the first child of each
+		size_t slots = mNodes.size();
+		IndexList firstChild(slots + 1, slots);
+		for (size_t slot = slots; slot-- > 1; )
+		{
+			if (mNodes[slot])
+				firstChild[mParents[slot]] = slot;
+		}
+		IndexList stack;
+		IndexList nextChild;
+		stack.push_back(0);
+		nextChild.push_back(firstChild[0]);
+		mVisits.push_back(0);
+		while (!stack.empty())
+		{
+			size_t parent = stack.back();
+			size_t child = nextChild.back();
+			if (child < slots && mNodes[child] && mParents[child] == parent)
+			{
+				nextChild.back() = child + 1;
+				stack.push_back(child);
+				nextChild.push_back(firstChild[child]);
+				mVisits.push_back(child * 2);
+			}
+			else
+			{
+				stack.pop_back();
+				nextChild.pop_back();
+				mVisits.push_back(parent * 2 + 1);
+			}
+		}
+
+		if (slots > mCapacity)
+		{
+			freeArrays(mLocal);
+			freeArrays(mDerived);
+			mCapacity = slots;
+			allocateArrays(mLocal, mCapacity);
+			allocateArrays(mDerived, mCapacity);
+		}
+		maxLevelCount = (maxLevelCount + 3) & ~3;
+		if (maxLevelCount > mParentCapacity)
+		{
+			freeArrays(mParentDerived);
+			mParentCapacity = maxLevelCount;
+			allocateArrays(mParentDerived, mParentCapacity);
+		}
+
+		mDirty.assign(slots, 0);
+		mChanged.assign(slots, 0);
+		mBoundsDirty.assign(slots, 0);
+		mInherit.assign(slots, 0);
+
+		for (size_t slot = 0; slot < slots; ++slot)
+		{
+			Node* node = mNodes[slot];
+			if (node)
+			{
+				node->mTransformPool = this;
+				node->mTransformPoolIndex = slot;
+				// Every node has to be recalculated in its new slot
+				mDirty[slot] = 1;
+			}
+			else
+			{
+				// Padding slots hold an identity transform
+				mLocal.posX[slot] = mLocal.posY[slot] = mLocal.posZ[slot] = 0;
+				mLocal.rotW[slot] = 1;
+				mLocal.rotX[slot] = mLocal.rotY[slot] = mLocal.rotZ[slot] = 0;
+				mLocal.scaleX[slot] = mLocal.scaleY[slot] = mLocal.scaleZ[slot] = 1;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::copyLocalTransform(size_t slot)
+	{
+		const Node* node = mNodes[slot];
+		mLocal.posX[slot] = node->mPosition.x;
+		mLocal.posY[slot] = node->mPosition.y;
+		mLocal.posZ[slot] = node->mPosition.z;
+		mLocal.rotW[slot] = node->mOrientation.w;
+		mLocal.rotX[slot] = node->mOrientation.x;
+		mLocal.rotY[slot] = node->mOrientation.y;
+		mLocal.rotZ[slot] = node->mOrientation.z;
+		mLocal.scaleX[slot] = node->mScale.x;
+		mLocal.scaleY[slot] = node->mScale.y;
+		mLocal.scaleZ[slot] = node->mScale.z;
+		mInherit[slot] = (node->mInheritOrientation ? IF_ORIENTATION : 0) |
+			(node->mInheritScale ? IF_SCALE : 0);
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::updateLevel(const Level& level)
+	{
+		size_t end = level.start + level.count;
+
+		// A node changes if it is dirty or its parent has changed
+		bool anyChanged = false;
+		for (size_t slot = level.start; slot < end; ++slot)
+		{
+			mChanged[slot] |= mChanged[mParents[slot]];
+			anyChanged |= (mChanged[slot] != 0);
+		}
+		if (!anyChanged)
+			return;
+
+		// Gather the parents' derived transforms so element i of each array
+		// lines up with node i of the level; the whole level is recalculated,
+		// which gives the same results for the nodes which haven't changed
+		for (size_t i = 0, slot = level.start; slot < end; ++i, ++slot)
+		{
+			size_t parent = mParents[slot];
+			mParentDerived.posX[i] = mDerived.posX[parent];
+			mParentDerived.posY[i] = mDerived.posY[parent];
+			mParentDerived.posZ[i] = mDerived.posZ[parent];
+			mParentDerived.rotW[i] = mDerived.rotW[parent];
+			mParentDerived.rotX[i] = mDerived.rotX[parent];
+			mParentDerived.rotY[i] = mDerived.rotY[parent];
+			mParentDerived.rotZ[i] = mDerived.rotZ[parent];
+			mParentDerived.scaleX[i] = mDerived.scaleX[parent];
+			mParentDerived.scaleY[i] = mDerived.scaleY[parent];
+			mParentDerived.scaleZ[i] = mDerived.scaleZ[parent];
+		}
+
+		OptimisedUtil::getImplementation()->calculateDerivedTransforms(
+			mParentDerived, mLocal.offset(level.start), mDerived.offset(level.start), level.count);
+
+		// Nodes which don't inherit orientation or scale use their own
+		for (size_t slot = level.start; slot < end; ++slot)
+		{
+			uint8 inherit = mInherit[slot];
+			if (!(inherit & IF_ORIENTATION))
+			{
+				mDerived.rotW[slot] = mLocal.rotW[slot];
+				mDerived.rotX[slot] = mLocal.rotX[slot];
+				mDerived.rotY[slot] = mLocal.rotY[slot];
+				mDerived.rotZ[slot] = mLocal.rotZ[slot];
+			}
+			if (!(inherit & IF_SCALE))
+			{
+				mDerived.scaleX[slot] = mLocal.scaleX[slot];
+				mDerived.scaleY[slot] = mLocal.scaleY[slot];
+				mDerived.scaleZ[slot] = mLocal.scaleZ[slot];
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void TransformPool::update(void)
+	{
+		if (mHierarchyDirty)
+			rebuild();
+		if (!mRoot)
+			return;
+
+		// Pick up changed local transforms; anything flagged after this point
+		// is left for the next update
+		size_t slots = mNodes.size();
+		for (size_t slot = 0; slot < slots; ++slot)
+		{
+			mChanged[slot] = mDirty[slot];
+			if (mDirty[slot])
+			{
+				copyLocalTransform(slot);
+				mDirty[slot] = 0;
+			}
+		}
+
+		// The root has no parent
+		if (mChanged[0])
+		{
+			mDerived.posX[0] = mLocal.posX[0];
+			mDerived.posY[0] = mLocal.posY[0];
+			mDerived.posZ[0] = mLocal.posZ[0];
+			mDerived.rotW[0] = mLocal.rotW[0];
+			mDerived.rotX[0] = mLocal.rotX[0];
+			mDerived.rotY[0] = mLocal.rotY[0];
+			mDerived.rotZ[0] = mLocal.rotZ[0];
+			mDerived.scaleX[0] = mLocal.scaleX[0];
+			mDerived.scaleY[0] = mLocal.scaleY[0];
+			mDerived.scaleZ[0] = mLocal.scaleZ[0];
+		}
+		for (size_t l = 1; l < mLevels.size(); ++l)
+		{
+			updateLevel(mLevels[l]);
+		}
+
+		// Copy the results back to the nodes and update their bounds, in the
+		// same order as a recursive update. Ancestors of changed nodes have
+		// their bounds updated too, which are the other nodes it would visit.
+		mBoundsDirty.assign(slots, 0);
+		mBoundsDirty[0] = 1;
+		for (IndexList::iterator v = mVisits.begin(); v != mVisits.end(); ++v)
+		{
+			size_t slot = *v >> 1;
+			if (!(*v & 1))
+			{
+				if (mChanged[slot])
+				{
+					// Called through Node, which this class is a friend of
+					Node* node = mNodes[slot];
+					node->setDerivedTransform(
+						Vector3(mDerived.posX[slot], mDerived.posY[slot], mDerived.posZ[slot]),
+						Quaternion(mDerived.rotW[slot], mDerived.rotX[slot], mDerived.rotY[slot], mDerived.rotZ[slot]),
+						Vector3(mDerived.scaleX[slot], mDerived.scaleY[slot], mDerived.scaleZ[slot]));
+					mBoundsDirty[slot] = 1;
+				}
+			}
+			else if (mBoundsDirty[slot])
+			{
+				SceneNode* node = mNodes[slot];
+				node->mNeedChildUpdate = false;
+				node->mParentNotified = false;
+				node->mChildrenToUpdate.clear();
+				node->_updateBounds();
+				mBoundsDirty[mParents[slot]] = 1;
+			}
+		}
+	}
+
+}
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
+#include "OgreTraceProfiler.h"
 
 namespace Ogre {
 	//---------------------------------------------------------------------
@@ -527,6 +528,8 @@ namespace Ogre {
 	//---------------------------------------------------------------------
 	WorkQueue::Response* DefaultWorkQueueBase::processRequest(Request* r)
 	{
+		OgreTraceScopeGroup("WorkQueue::processRequest", OGREPROF_GENERAL);
+
 		RequestHandlerListByChannel handlerListCopy;
 		{
 			// lock the list only to make a copy of it, to maximise parallelism
@@ -0,0 +1,703 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "Threading/OgreDefaultWorkQueueStealing.h"
+#include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::StealQueue::StealQueue()
+		: mFront(0)
+		, mBack(0)
+		, mRing(createRing(64, 0))
+	{
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::StealQueue::~StealQueue()
+	{
+		Ring* ring = mRing;
+		while (ring)
+		{
+			Ring* retired = ring->retired;
+			OGRE_FREE((void*)ring->slots, MEMCATEGORY_GENERAL);
+			OGRE_FREE(ring, MEMCATEGORY_GENERAL);
+			ring = retired;
+		}
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::StealQueue::Ring*
+	DefaultWorkQueueStealing::StealQueue::createRing(size_t capacity, Ring* retired)
+	{
+		Ring* ring = OGRE_ALLOC_T(Ring, 1, MEMCATEGORY_GENERAL);
+		ring->mask = capacity - 1;
+		ring->slots = OGRE_ALLOC_T(QueuedRequest*, capacity, MEMCATEGORY_GENERAL);
+		ring->retired = retired;
+		return ring;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::StealQueue::grow()
+	{
+		Ring* oldRing = mRing;
+		Ring* newRing = createRing((oldRing->mask + 1) * 2, oldRing);
+		size_t back = mBack.get();
+		for (size_t i = mFront.get(); i != back; ++i)
+			newRing->slots[i & newRing->mask] = oldRing->slots[i & oldRing->mask];
+		// thieves only need the new ring for requests pushed after this, and
+		// the increment of mBack in push() orders the two
+		mRing = newRing;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::StealQueue::push(QueuedRequest* q)
+	{
+		size_t back = mBack.get();
+		Ring* ring = mRing;
+		if (back - mFront.get() > ring->mask)
+		{
+			grow();
+			ring = mRing;
+		}
+		ring->slots[back & ring->mask] = q;
+		// the increment is a full barrier, publishing the slot to thieves
+		++mBack;
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::QueuedRequest* DefaultWorkQueueStealing::StealQueue::take()
+	{
+		while (true)
+		{
+			size_t front = mFront.get();
+			size_t back = mBack.get();
+			if ((ptrdiff_t)(back - front) <= 0)
+				return 0;
+
+			// read the ring after mBack; it is always published before the
+			// requests which need it
+			Ring* ring = mRing;
+			QueuedRequest* q = ring->slots[front & ring->mask];
+			// if the owner wrapped around onto this slot then mFront has
+			// moved on and the exchange fails
+			if (mFront.cas(front, front + 1))
+				return q;
+		}
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueStealing::StealQueue::empty() const
+	{
+		return (ptrdiff_t)(mBack.get() - mFront.get()) <= 0;
+	}
+	//---------------------------------------------------------------------
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::DefaultWorkQueueStealing(const String& name)
+		: DefaultWorkQueueBase(name)
+		, mAbortGeneration(0)
+		, mNextRequestID(0)
+		, mQueuedCount(0)
+		, mUncheckedCount(0)
+		, mStealCount(0)
+		, mNextWorker(0)
+		, mWorkersStarted(0)
+		, mIdleWorkers(0)
+		, mChannelAffinity(true)
+		, mNumThreadsRegisteredWithRS(0)
+	{
+		mShuttingDown = false;
+		// slot for threads driving the queue themselves; requests posted before
+		// startup wait here until a worker adopts them
+		mWorkerSlots.push_back(OGRE_NEW Worker());
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::~DefaultWorkQueueStealing()
+	{
+		shutdown();
+		destroyWorkerSlots(true);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::startup(bool forceRestart)
+	{
+		if (mIsRunning)
+		{
+			if (forceRestart)
+				shutdown();
+			else
+				return;
+		}
+
+		mShuttingDown = false;
+
+		// one slot per thread, ahead of the external slot
+		destroyWorkerSlots(false);
+		for (size_t i = 0; i < mWorkerThreadCount; ++i)
+			mWorkerSlots.insert(mWorkerSlots.begin(), OGRE_NEW Worker());
+		mWorkersStarted.set(0);
+
+		mWorkerFunc = OGRE_NEW_T(WorkerFunc(this), MEMCATEGORY_GENERAL);
+
+		LogManager::getSingleton().stream() <<
+			"DefaultWorkQueueStealing('" << mName << "') initialising on thread " <<
+			OGRE_THREAD_CURRENT_ID << " with " << mWorkerThreadCount << " workers.";
+
+		if (mWorkerRenderSystemAccess)
+			Root::getSingleton().getRenderSystem()->preExtraThreadsStarted();
+
+		mNumThreadsRegisteredWithRS = 0;
+		for (size_t i = 0; i < mWorkerThreadCount; ++i)
+		{
+			OGRE_THREAD_CREATE(t, *mWorkerFunc);
+			mWorkers.push_back(t);
+		}
+
+		if (mWorkerRenderSystemAccess)
+		{
+			OGRE_LOCK_MUTEX_NAMED(mInitMutex, initLock)
+			// have to wait until all threads are registered with the render system
+			while (mNumThreadsRegisteredWithRS < mWorkerThreadCount)
+				OGRE_THREAD_WAIT(mInitSync, mInitMutex, initLock);
+
+			Root::getSingleton().getRenderSystem()->postExtraThreadsStarted();
+		}
+
+		mIsRunning = true;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::notifyThreadRegistered()
+	{
+		OGRE_LOCK_MUTEX(mInitMutex)
+
+		++mNumThreadsRegisteredWithRS;
+
+		// wake up main thread
+		OGRE_THREAD_NOTIFY_ALL(mInitSync);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::shutdown()
+	{
+		if( !mIsRunning )
+			return;
+
+		LogManager::getSingleton().stream() <<
+			"DefaultWorkQueueStealing('" << mName << "') shutting down on thread " <<
+			OGRE_THREAD_CURRENT_ID << ", " << mStealCount.get() << " requests stolen.";
+
+		mShuttingDown = true;
+		abortAllRequests();
+
+		{
+			// wake all threads (they check shutting down as first thing after wait)
+			OGRE_LOCK_MUTEX(mIdleMutex)
+			OGRE_THREAD_NOTIFY_ALL(mIdleCondition)
+		}
+
+		for (WorkerThreadList::iterator i = mWorkers.begin(); i != mWorkers.end(); ++i)
+		{
+			(*i)->join();
+			OGRE_THREAD_DESTROY(*i);
+		}
+		mWorkers.clear();
+
+		if (mWorkerFunc)
+		{
+			OGRE_DELETE_T(mWorkerFunc, WorkerFunc, MEMCATEGORY_GENERAL);
+			mWorkerFunc = 0;
+		}
+
+		// requests left on the worker queues were aborted above
+		destroyWorkerSlots(false);
+
+		mIsRunning = false;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::destroyWorkerSlots(bool includeExternal)
+	{
+		size_t count = includeExternal ? mWorkerSlots.size() : mWorkerSlots.size() - 1;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Worker* w = mWorkerSlots[i];
+			QueuedRequest* q = reinterpret_cast<QueuedRequest*>(w->inbox.get());
+			while (q)
+			{
+				QueuedRequest* next = q->next;
+				OGRE_DELETE q->request;
+				OGRE_FREE(q, MEMCATEGORY_GENERAL);
+				--mQueuedCount;
+				--mUncheckedCount;
+				q = next;
+			}
+			while ((q = w->queue.take()) != 0)
+			{
+				OGRE_DELETE q->request;
+				OGRE_FREE(q, MEMCATEGORY_GENERAL);
+				--mQueuedCount;
+				--mUncheckedCount;
+			}
+			OGRE_DELETE w;
+		}
+		mWorkerSlots.erase(mWorkerSlots.begin(), mWorkerSlots.begin() + count);
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueStealing::isTrivialLogging() const
+	{
+		// Log::logMessage locks the log even for messages it discards, so
+		// avoid building per-request messages no one will see
+		Log* log = LogManager::getSingleton().getDefaultLog();
+		return log && log->getLogDetail() == LL_BOREME;
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::RequestID DefaultWorkQueueStealing::addRequest(uint16 channel, uint16 requestType,
+		const Any& rData, uint8 retryCount, bool forceSynchronous)
+	{
+		if (!mAcceptRequests || mShuttingDown)
+			return 0;
+
+		RequestID rid = ++mNextRequestID;
+		Request* req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid);
+
+		if (isTrivialLogging())
+		{
+			LogManager::getSingleton().stream(LML_TRIVIAL) <<
+				"DefaultWorkQueueStealing('" << mName << "') - QUEUED(thread:" <<
+				OGRE_THREAD_CURRENT_ID << "): ID=" << rid
+				<< " channel=" << channel << " requestType=" << requestType;
+		}
+
+		if (forceSynchronous)
+		{
+			processQueuedRequest(req, mAbortGeneration.get(), 0, true);
+		}
+		else
+		{
+			postRequest(req);
+		}
+
+		return rid;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::postRequest(Request* req)
+	{
+		// counted before the generation is read, so that recordAbort cannot
+		// drop an abort record this request has not been checked against
+		++mUncheckedCount;
+
+		QueuedRequest* q = OGRE_ALLOC_T(QueuedRequest, 1, MEMCATEGORY_GENERAL);
+		q->request = req;
+		q->abortGeneration = mAbortGeneration.get();
+
+		// pick a worker thread (or the external slot if there are none)
+		size_t numWorkers = mWorkerSlots.size() - 1;
+		size_t slot = numWorkers;
+		if (numWorkers)
+		{
+			if (mChannelAffinity)
+				slot = req->getChannel() % numWorkers;
+			else
+				slot = mNextWorker++ % numWorkers;
+		}
+
+		// lock-free push onto the inbox stack
+		Worker* w = mWorkerSlots[slot];
+		size_t head;
+		do
+		{
+			head = w->inbox.get();
+			q->next = reinterpret_cast<QueuedRequest*>(head);
+		} while (!w->inbox.cas(head, reinterpret_cast<size_t>(q)));
+
+		++mQueuedCount;
+		notifyWorkers();
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::notifyWorkers()
+	{
+		// mQueuedCount has been incremented (a full barrier) before this
+		// check, and waitForWork increments mIdleWorkers before checking the
+		// count, so either we see the sleeper or it sees the request
+		if (mIdleWorkers.get() > 0)
+		{
+			OGRE_LOCK_MUTEX(mIdleMutex)
+			OGRE_THREAD_NOTIFY_ONE(mIdleCondition)
+		}
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::waitForWork()
+	{
+		OGRE_LOCK_MUTEX_NAMED(mIdleMutex, idleLock)
+		++mIdleWorkers;
+		if (!mShuttingDown && (mPaused || mQueuedCount.get() == 0))
+		{
+			// frees lock and suspends the thread
+			OGRE_THREAD_WAIT(mIdleCondition, mIdleMutex, idleLock);
+		}
+		--mIdleWorkers;
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueStealing::drainInbox(Worker* src, size_t dest)
+	{
+		// take the whole stack at once; safe with any number of consumers
+		size_t taken;
+		do
+		{
+			taken = src->inbox.get();
+			if (!taken)
+				return false;
+		} while (!src->inbox.cas(taken, 0));
+		QueuedRequest* head = reinterpret_cast<QueuedRequest*>(taken);
+
+		// the stack is newest first, reverse it to keep requests in order
+		QueuedRequest* ordered = 0;
+		while (head)
+		{
+			QueuedRequest* next = head->next;
+			head->next = ordered;
+			ordered = head;
+			head = next;
+		}
+		StealQueue& queue = mWorkerSlots[dest]->queue;
+		for (; ordered; ordered = ordered->next)
+			queue.push(ordered);
+
+		return true;
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueStealing::QueuedRequest* DefaultWorkQueueStealing::takeRequest(size_t slot)
+	{
+		Worker* own = mWorkerSlots[slot];
+		size_t numSlots = mWorkerSlots.size();
+
+		// own requests first
+		drainInbox(own, slot);
+		QueuedRequest* q = own->queue.take();
+		if (q)
+			return q;
+
+		// steal from the queues of other workers, nearest first
+		for (size_t i = 1; i < numSlots; ++i)
+		{
+			q = mWorkerSlots[(slot + i) % numSlots]->queue.take();
+			if (q)
+			{
+				++mStealCount;
+				return q;
+			}
+		}
+
+		// finally adopt requests another worker hasn't got round to yet
+		for (size_t i = 1; i < numSlots; ++i)
+		{
+			if (drainInbox(mWorkerSlots[(slot + i) % numSlots], slot))
+			{
+				q = own->queue.take();
+				if (q)
+				{
+					++mStealCount;
+					return q;
+				}
+			}
+		}
+
+		return 0;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::_threadMain()
+	{
+		size_t slot = mWorkersStarted++;
+
+		LogManager::getSingleton().stream() <<
+			"DefaultWorkQueueStealing('" << getName() << "')::WorkerFunc - thread "
+			<< OGRE_THREAD_CURRENT_ID << " starting as worker " << slot << ".";
+
+		// Initialise the thread for RS if necessary
+		if (mWorkerRenderSystemAccess)
+		{
+			Root::getSingleton().getRenderSystem()->registerThread();
+			notifyThreadRegistered();
+		}
+
+		// Spin forever until we're told to shut down
+		while (!isShuttingDown())
+		{
+			QueuedRequest* q = mPaused ? 0 : takeRequest(slot);
+			if (q)
+				processQueuedRequest(q, mWorkerSlots[slot]);
+			else
+				waitForWork();
+		}
+
+		LogManager::getSingleton().stream() <<
+			"DefaultWorkQueueStealing('" << getName() << "')::WorkerFunc - thread "
+			<< OGRE_THREAD_CURRENT_ID << " stopped.";
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::_processNextRequest()
+	{
+		if (mPaused)
+			return;
+
+		QueuedRequest* q = 0;
+		{
+			// the external slot's queue may only be pushed by one thread
+			OGRE_LOCK_MUTEX(mExternalMutex)
+			q = takeRequest(mWorkerSlots.size() - 1);
+		}
+		if (q)
+			processQueuedRequest(q, 0);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::processQueuedRequest(QueuedRequest* q, Worker* w)
+	{
+		Request* r = q->request;
+		uint32 abortGeneration = q->abortGeneration;
+		OGRE_FREE(q, MEMCATEGORY_GENERAL);
+		--mQueuedCount;
+
+		processQueuedRequest(r, abortGeneration, w, false);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::processQueuedRequest(Request* r, uint32 abortGeneration,
+		Worker* w, bool synchronous)
+	{
+		// Make the request visible to aborts before checking the abort records,
+		// so that an abort issued in between is seen by one or the other
+		if (w)
+		{
+			OGRE_LOCK_MUTEX(w->currentMutex)
+			w->current = r;
+		}
+		else
+		{
+			OGRE_LOCK_MUTEX(mProcessMutex)
+			mProcessQueue.push_back(r);
+		}
+
+		if (isAbortPending(r, abortGeneration))
+			r->abortRequest();
+		if (!synchronous)
+			--mUncheckedCount;
+
+		Response* response = dispatchRequest(r);
+
+		if (response && !response->succeeded() && r->getRetryCount() && !mShuttingDown)
+		{
+			// Failed, try again with the same ID
+			Request* retry = OGRE_NEW Request(r->getChannel(), r->getType(), r->getData(),
+				r->getRetryCount() - 1, r->getID());
+			if (synchronous)
+				processQueuedRequest(retry, mAbortGeneration.get(), w, synchronous);
+			else
+				postRequest(retry);
+			// discard response (this also deletes request)
+			OGRE_DELETE response;
+		}
+		else if (response && synchronous)
+		{
+			processResponse(response);
+			OGRE_DELETE response;
+		}
+		else if (response)
+		{
+			if (response->getRequest()->getAborted())
+			{
+				// destroy response user data
+				response->abortRequest();
+			}
+			// Queue response
+			OGRE_LOCK_MUTEX(mResponseMutex)
+			mResponseQueue.push_back(response);
+			// no need to wake thread, this is processed by the main thread
+		}
+		else
+		{
+			LogManager::getSingleton().stream() <<
+				"DefaultWorkQueueStealing('" << mName << "') warning: no handler processed request "
+				<< r->getID() << ", channel " << r->getChannel()
+				<< ", type " << r->getType();
+		}
+
+		// Only stop being visible to aborts once the response is queued
+		if (w)
+		{
+			OGRE_LOCK_MUTEX(w->currentMutex)
+			w->current = 0;
+		}
+		else
+		{
+			OGRE_LOCK_MUTEX(mProcessMutex)
+			RequestQueue::iterator i = std::find(mProcessQueue.begin(), mProcessQueue.end(), r);
+			if (i != mProcessQueue.end())
+				mProcessQueue.erase(i);
+		}
+
+		// no response, delete request
+		if (!response)
+			OGRE_DELETE r;
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::Response* DefaultWorkQueueStealing::dispatchRequest(Request* r)
+	{
+		RequestHandlerList handlers;
+		{
+			// copy only this channel's handlers, to hold the lock briefly
+			OGRE_LOCK_RW_MUTEX_READ(mRequestHandlerMutex);
+			RequestHandlerListByChannel::iterator i = mRequestHandlers.find(r->getChannel());
+			if (i != mRequestHandlers.end())
+				handlers = i->second;
+		}
+
+		Response* response = 0;
+		for (RequestHandlerList::reverse_iterator j = handlers.rbegin(); j != handlers.rend(); ++j)
+		{
+			// threadsafe call which tests canHandleRequest and calls it if so
+			response = (*j)->handleRequest(r, this);
+
+			if (response)
+				break;
+		}
+
+		if (isTrivialLogging())
+		{
+			LogManager::getSingleton().stream(LML_TRIVIAL) <<
+				"DefaultWorkQueueStealing('" << mName << "') - PROCESSED(thread:" <<
+				OGRE_THREAD_CURRENT_ID << "): ID=" << r->getID() << " channel=" << r->getChannel()
+				<< " requestType=" << r->getType() << " processed=" << (response!=0);
+		}
+
+		return response;
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueStealing::abortApplies(const AbortRecord& rec, const Request* r)
+	{
+		switch (rec.scope)
+		{
+		case AbortRecord::AS_ID:
+			return r->getID() == rec.id;
+		case AbortRecord::AS_CHANNEL:
+			return r->getChannel() == rec.channel;
+		case AbortRecord::AS_ALL:
+		default:
+			return true;
+		};
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueStealing::isAbortPending(const Request* r, uint32 abortGeneration)
+	{
+		// fast path: nothing has been aborted since this was queued
+		if (abortGeneration == mAbortGeneration.get())
+			return false;
+
+		OGRE_LOCK_MUTEX(mAbortMutex)
+		for (AbortRecordList::iterator i = mAbortRecords.begin(); i != mAbortRecords.end(); ++i)
+		{
+			if ((int32)(i->generation - abortGeneration) > 0 && abortApplies(*i, r))
+				return true;
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::recordAbort(const AbortRecord& rec)
+	{
+		{
+			OGRE_LOCK_MUTEX(mAbortMutex)
+
+			// Records only matter to requests queued before them; if no queued
+			// request still has to be checked against them, or this aborts
+			// everything, the older ones can go
+			if (mUncheckedCount.get() == 0 || rec.scope == AbortRecord::AS_ALL)
+				mAbortRecords.clear();
+
+			AbortRecord r = rec;
+			r.generation = mAbortGeneration.get() + 1;
+			mAbortRecords.push_back(r);
+			mAbortGeneration.set(r.generation);
+		}
+
+		// requests being processed right now
+		for (WorkerList::iterator i = mWorkerSlots.begin(); i != mWorkerSlots.end(); ++i)
+		{
+			OGRE_LOCK_MUTEX((*i)->currentMutex)
+			if ((*i)->current && abortApplies(rec, (*i)->current))
+				(*i)->current->abortRequest();
+		}
+		{
+			OGRE_LOCK_MUTEX(mProcessMutex)
+			for (RequestQueue::iterator i = mProcessQueue.begin(); i != mProcessQueue.end(); ++i)
+			{
+				if (abortApplies(rec, *i))
+					(*i)->abortRequest();
+			}
+		}
+
+		// responses not yet processed
+		{
+			OGRE_LOCK_MUTEX(mResponseMutex)
+			for (ResponseQueue::iterator i = mResponseQueue.begin(); i != mResponseQueue.end(); ++i)
+			{
+				if (abortApplies(rec, (*i)->getRequest()))
+					(*i)->abortRequest();
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::abortRequest(RequestID id)
+	{
+		AbortRecord rec;
+		rec.scope = AbortRecord::AS_ID;
+		rec.id = id;
+		rec.channel = 0;
+		recordAbort(rec);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::abortRequestsByChannel(uint16 channel)
+	{
+		AbortRecord rec;
+		rec.scope = AbortRecord::AS_CHANNEL;
+		rec.id = 0;
+		rec.channel = channel;
+		recordAbort(rec);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::abortAllRequests()
+	{
+		AbortRecord rec;
+		rec.scope = AbortRecord::AS_ALL;
+		rec.id = 0;
+		rec.channel = 0;
+		recordAbort(rec);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueStealing::setPaused(bool pause)
+	{
+		DefaultWorkQueueBase::setPaused(pause);
+
+		if (!pause)
+		{
+			OGRE_LOCK_MUTEX(mIdleMutex)
+			OGRE_THREAD_NOTIFY_ALL(mIdleCondition)
+		}
+	}
+}
@@ -122,6 +122,12 @@ namespace Ogre {
 		/// @copydoc SceneManager::getTypeName
 		const String& getTypeName(void) const;
 
+        /** Bsp nodes update the level's object membership when moved, so the
+            graph can't be updated in parallel. */
+        bool isParallelSceneGraphUpdateSupported(void) const { return false; }
+        /** Bsp nodes override _update, which a TransformPool doesn't call. */
+        bool isTransformPoolSupported(void) const { return false; }
+
         /** Specialised from SceneManager to support Quake3 bsp files. */
         void setWorldGeometry(const String& filename);
 
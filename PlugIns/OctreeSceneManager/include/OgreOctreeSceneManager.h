@@ -108,6 +108,9 @@ public:
 
     /** Does nothing more */
     virtual void _updateSceneGraph( Camera * cam );
+    /** Octree nodes relocate themselves in the shared octree when updated,
+        so the graph can't be updated in parallel. */
+    virtual bool isParallelSceneGraphUpdateSupported( void ) const { return false; }
     /** Recurses through the octree determining which nodes are visible. */
     virtual void _findVisibleObjects ( Camera * cam, 
 		VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters );
@@ -152,6 +152,11 @@ namespace Ogre
 
         /** Update Scene Graph (does several things now) */
         virtual void _updateSceneGraph( Camera * cam );
+        /** PCZ nodes update zone membership when moved, so the graph can't
+            be updated in parallel. */
+        virtual bool isParallelSceneGraphUpdateSupported( void ) const { return false; }
+        /** PCZ nodes override _update, which a TransformPool doesn't call. */
+        virtual bool isTransformPoolSupported( void ) const { return false; }
 
         /** Recurses through the PCZTree determining which nodes are visible. */
         virtual void _findVisibleObjects ( Camera * cam, 
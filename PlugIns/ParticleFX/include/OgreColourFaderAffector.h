@@ -83,6 +83,12 @@ namespace Ogre {
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
 
+        /** See ParticleAffector. */
+        bool supportsParticleArrays(void) const { return true; }
+
+        /** See ParticleAffector. */
+        void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed);
+
         /** Sets the colour adjustment to be made per second to particles. 
         @param red, green, blue, alpha
             Sets the adjustment to be made to each of the colour components per second. These
@@ -85,6 +85,12 @@ namespace Ogre {
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
 
+        /** See ParticleAffector. */
+        bool supportsParticleArrays(void) const { return true; }
+
+        /** See ParticleAffector. */
+        void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed);
+
 
 
 		/** Sets the minimum rotation speed of particles to be emitted. */
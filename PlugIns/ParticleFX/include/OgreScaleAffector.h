@@ -58,6 +58,12 @@ namespace Ogre {
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
 
+        /** See ParticleAffector. */
+        bool supportsParticleArrays(void) const { return true; }
+
+        /** See ParticleAffector. */
+        void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed);
+
         /** Sets the scale adjustment to be made per second to particles. 
         @param Rate
             Sets the adjustment to be made to the x and y scale components per second. These
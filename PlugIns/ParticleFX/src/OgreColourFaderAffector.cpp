@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreParticleSystem.h"
 #include "OgreStringConverter.h"
 #include "OgreParticle.h"
+#include "OgreParticleArrays.h"
+#include "OgreOptimisedUtil.h"
 
 
 namespace Ogre {
@@ -90,6 +92,19 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ColourFaderAffector::_affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+    {
+        (void)pSystem;
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        size_t count = particles.getCount();
+
+        // Scale adjustments by time, and limit to [0, 1]
+        util->scaleOffsetClamp(particles.colourR, count, 1.0f, mRedAdj * (float)timeElapsed, 0.0f, 1.0f);
+        util->scaleOffsetClamp(particles.colourG, count, 1.0f, mGreenAdj * (float)timeElapsed, 0.0f, 1.0f);
+        util->scaleOffsetClamp(particles.colourB, count, 1.0f, mBlueAdj * (float)timeElapsed, 0.0f, 1.0f);
+        util->scaleOffsetClamp(particles.colourA, count, 1.0f, mAlphaAdj * (float)timeElapsed, 0.0f, 1.0f);
+    }
+    //-----------------------------------------------------------------------
     void ColourFaderAffector::setAdjust(float red, float green, float blue, float alpha)
     {
         mRedAdj = red;
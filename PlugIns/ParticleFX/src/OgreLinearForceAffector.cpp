@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "OgreLinearForceAffector.h"
 #include "OgreParticleSystem.h"
 #include "OgreParticle.h"
+#include "OgreParticleArrays.h"
+#include "OgreOptimisedUtil.h"
 #include "OgreStringConverter.h"
 
 
@@ -95,6 +97,33 @@ namespace Ogre {
         
     }
     //-----------------------------------------------------------------------
+    void LinearForceAffector::_affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+    {
+        (void)pSystem;
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        size_t count = particles.getCount();
+
+        // Both applications are direction * scale + offset
+        Real scale, offsetScale;
+        if (mForceApplication == FA_ADD)
+        {
+            scale = 1;
+            offsetScale = timeElapsed;
+        }
+        else // FA_AVERAGE
+        {
+            scale = 0.5f;
+            offsetScale = 0.5f;
+        }
+
+        util->scaleOffsetClamp(particles.directionX, count, (float)scale, (float)(mForceVector.x * offsetScale),
+            -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+        util->scaleOffsetClamp(particles.directionY, count, (float)scale, (float)(mForceVector.y * offsetScale),
+            -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+        util->scaleOffsetClamp(particles.directionZ, count, (float)scale, (float)(mForceVector.z * offsetScale),
+            -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+    }
+    //-----------------------------------------------------------------------
     void LinearForceAffector::setForceVector(const Vector3& force)
     {
         mForceVector = force;
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreParticleSystem.h"
 #include "OgreStringConverter.h"
 #include "OgreParticle.h"
+#include "OgreParticleArrays.h"
+#include "OgreOptimisedUtil.h"
 
 
 namespace Ogre {
@@ -107,6 +109,19 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void RotationAffector::_affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+    {
+        size_t count = particles.getCount();
+        if (!count)
+            return;
+
+        OptimisedUtil::getImplementation()->accumulateScaled(
+            particles.rotation, particles.rotationSpeed, (float)timeElapsed, count);
+
+        // Once for all the particles, rather than for each as setRotation does
+        pSystem->_notifyParticleRotated();
+    }
+    //-----------------------------------------------------------------------
     const Radian& RotationAffector::getRotationSpeedRangeStart(void) const
     {
         return mRotationSpeedRangeStart;
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "OgreParticleSystem.h"
 #include "OgreStringConverter.h"
 #include "OgreParticle.h"
+#include "OgreParticleArrays.h"
+#include "OgreOptimisedUtil.h"
 
 
 namespace Ogre {
@@ -85,6 +87,38 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ScaleAffector::_affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+    {
+        size_t count = particles.getCount();
+        if (!count)
+            return;
+
+        // Particles without their own dimensions start from the defaults,
+        // and have their own from now on
+        float defaultWidth = (float)pSystem->getDefaultWidth();
+        float defaultHeight = (float)pSystem->getDefaultHeight();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!particles.ownDimensions[i])
+            {
+                particles.width[i] = defaultWidth;
+                particles.height[i] = defaultHeight;
+                particles.ownDimensions[i] = 1;
+            }
+        }
+
+        // Scale adjustments by time
+        float ds = (float)(mScaleAdj * timeElapsed);
+        OptimisedUtil* util = OptimisedUtil::getImplementation();
+        util->scaleOffsetClamp(particles.width, count, 1.0f, ds,
+            -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+        util->scaleOffsetClamp(particles.height, count, 1.0f, ds,
+            -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+
+        // Once for all the particles, rather than for each as setDimensions does
+        pSystem->_notifyParticleResized();
+    }
+    //-----------------------------------------------------------------------
     void ScaleAffector::setAdjust( Real rate )
     {
         mScaleAdj = rate;
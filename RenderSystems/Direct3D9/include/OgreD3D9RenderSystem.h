@@ -125,6 +125,8 @@ namespace Ogre
 		D3D9DeviceManager* mDeviceManager;
 
 		size_t mLastVertexSourceCount;
+		/// Number of stream sources whose frequency was last set up for instancing
+		size_t mLastInstancedSourceCount;
 
 
         /// Internal method for populating the capabilities structure
@@ -277,6 +279,9 @@ namespace Ogre
 		void _setTextureLayerAnisotropy(size_t unit, unsigned int maxAnisotropy);
 		void setVertexDeclaration(VertexDeclaration* decl);
 		void setVertexBufferBinding(VertexBufferBinding* binding);
+		/** Binds the vertex buffers, setting up the stream frequencies to 
+			draw the given number of instances. */
+		void setVertexBufferBinding(VertexBufferBinding* binding, size_t numberOfInstances);
         void _render(const RenderOperation& op);
         /** See
           RenderSystem
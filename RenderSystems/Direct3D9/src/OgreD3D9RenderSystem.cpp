@@ -111,6 +111,7 @@ namespace Ogre
 		}
 
 		mLastVertexSourceCount = 0;
+		mLastInstancedSourceCount = 0;
 
 		mCurrentLights = 0;
 
@@ -1025,6 +1026,9 @@ namespace Ogre
 				rsc->setNumVertexTextureUnits(4);
 				rsc->setVertexTextureUnitsShared(false);
 			}
+
+			// Stream source frequencies are always available with vs_3_0
+			rsc->setCapability(RSC_VERTEX_BUFFER_INSTANCE_DATA);
 		}		
 
 		// Check alpha to coverage support
@@ -2992,6 +2996,12 @@ namespace Ogre
 	}
 	//---------------------------------------------------------------------
 	void D3D9RenderSystem::setVertexBufferBinding(VertexBufferBinding* binding)
+	{
+		setVertexBufferBinding(binding, 1);
+	}
+	//---------------------------------------------------------------------
+	void D3D9RenderSystem::setVertexBufferBinding(VertexBufferBinding* binding, 
+		size_t numberOfInstances)
 	{
 		HRESULT hr;
 
@@ -3000,6 +3010,14 @@ namespace Ogre
 		VertexBufferBinding::VertexBufferBindingMap::const_iterator i, iend;
 		size_t source = 0;
 		iend = binds.end();
+
+		// Stream frequencies only need setting up if there's instance data
+		bool instanced = numberOfInstances > 1;
+		for (i = binds.begin(); i != iend && !instanced; ++i)
+		{
+			instanced = i->second->getIsInstanceData();
+		}
+
 		for (i = binds.begin(); i != iend; ++i, ++source)
 		{
 			// Unbind gap sources
@@ -3027,6 +3045,24 @@ namespace Ogre
 					"D3D9RenderSystem::setVertexBufferBinding");
 			}
 
+			// Instance data advances once per instance (or per step), the
+			// geometry is repeated for each instance
+			if (instanced || source < mLastInstancedSourceCount)
+			{
+				UINT frequency = 1;
+				if (instanced)
+				{
+					frequency = d3d9buf->getIsInstanceData() ?
+						(D3DSTREAMSOURCE_INSTANCEDATA | static_cast<UINT>(d3d9buf->getInstanceDataStepRate())) :
+						(D3DSTREAMSOURCE_INDEXEDDATA | static_cast<UINT>(numberOfInstances));
+				}
+				hr = getActiveD3D9Device()->SetStreamSourceFreq(static_cast<UINT>(source), frequency);
+				if (FAILED(hr))
+				{
+					OGRE_EXCEPT(Exception::ERR_RENDERINGAPI_ERROR, "Unable to set D3D9 stream source frequency", 
+						"D3D9RenderSystem::setVertexBufferBinding");
+				}
+			}
 
 		}
 
@@ -3042,7 +3078,12 @@ namespace Ogre
 			}
 
 		}
+		for (size_t unused = source; unused < mLastInstancedSourceCount; ++unused)
+		{
+			getActiveD3D9Device()->SetStreamSourceFreq(static_cast<UINT>(unused), 1);
+		}
 		mLastVertexSourceCount = source;
+		mLastInstancedSourceCount = instanced ? source : 0;
 
 	}
 	//---------------------------------------------------------------------
@@ -3060,7 +3101,7 @@ namespace Ogre
 		// setVertexBufferBinding from RenderSystem since the sequence is
 		// a bit too D3D9-specific?
 		setVertexDeclaration(op.vertexData->vertexDeclaration);
-		setVertexBufferBinding(op.vertexData->vertexBufferBinding);
+		setVertexBufferBinding(op.vertexData->vertexBufferBinding, op.numberOfInstances);
 
 		// Determine rendering operation
 		D3DPRIMITIVETYPE primType = D3DPT_TRIANGLELIST;
@@ -3867,6 +3908,7 @@ namespace Ogre
 		mVertexProgramBound = false;
 		mFragmentProgramBound = false;
 		mLastVertexSourceCount = 0;
+		mLastInstancedSourceCount = 0;
 
 		
 		// Force all compositors to reconstruct their internal resources
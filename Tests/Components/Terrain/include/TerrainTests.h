@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "OgreRoot.h"
+#include "OgreTerrain.h"
 
 using namespace Ogre; 
 
@@ -37,13 +38,42 @@ class TerrainTests : public CppUnit::TestFixture
 	// CppUnit macros for setting up the test suite
 	CPPUNIT_TEST_SUITE( TerrainTests );
 	CPPUNIT_TEST(testCreate);
+	CPPUNIT_TEST(testRayIntersectsMatchesTriangles);
+	CPPUNIT_TEST(testRayIntersectsAfterEdit);
+#ifdef OGRE_TEST_BENCHMARKS
+	CPPUNIT_TEST(testRaySpeed);
+#endif
+	CPPUNIT_TEST(testNormalsMatchPlanes);
+	CPPUNIT_TEST(testDerivedDataTiles);
+	CPPUNIT_TEST(testDerivedDataManyTiles);
+#ifdef OGRE_TEST_BENCHMARKS
+	CPPUNIT_TEST(testNormalsSpeed);
+#endif
+	CPPUNIT_TEST(testCompressedHeights);
+	CPPUNIT_TEST(testCompressedImage);
+	CPPUNIT_TEST(testCompressedSaveLoad);
+	CPPUNIT_TEST(testStreamedVertexData);
+	CPPUNIT_TEST(testGroupMemoryBudget);
 	CPPUNIT_TEST_SUITE_END();
 
 	Root* mRoot;
 	SceneManager* mSceneMgr;
+	TerrainGlobalOptions* mTerrainOpts;
 
 public:
 	void setUp();
 	void tearDown();
 	void testCreate();
+	void testRayIntersectsMatchesTriangles();
+	void testRayIntersectsAfterEdit();
+	void testRaySpeed();
+	void testNormalsMatchPlanes();
+	void testDerivedDataTiles();
+	void testDerivedDataManyTiles();
+	void testNormalsSpeed();
+	void testCompressedHeights();
+	void testCompressedImage();
+	void testCompressedSaveLoad();
+	void testStreamedVertexData();
+	void testGroupMemoryBudget();
 };
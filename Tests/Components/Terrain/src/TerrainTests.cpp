@@ -27,8 +27,17 @@ THE SOFTWARE.
 */
 #include "TerrainTests.h"
 #include "OgreTerrain.h"
+#include "OgreTerrainCompression.h"
+#include "OgreTerrainQuadTreeNode.h"
+#include "OgreTerrainGroup.h"
+#include "OgreTerrainMaterialGenerator.h"
+#include "OgreDefaultHardwareBufferManager.h"
 #include "OgreConfigFile.h"
 #include "OgreResourceGroupManager.h"
+#include "OgrePlane.h"
+#include "OgreTimer.h"
+#include "OgreStreamSerialiser.h"
+#include <iostream>
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TerrainTests );
@@ -61,11 +70,13 @@ void TerrainTests::setUp()
 	}
 
 	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	mTerrainOpts = OGRE_NEW TerrainGlobalOptions();
 
 }
 
 void TerrainTests::tearDown()
 {
+	OGRE_DELETE mTerrainOpts;
 	OGRE_DELETE mRoot;
 }
 
@@ -94,3 +105,606 @@ void TerrainTests::testCreate()
 	OGRE_DELETE t;
 }
 
+
+namespace
+{
+	/// Rolling hills with some higher frequency detail
+	Terrain* createHillTerrain(SceneManager* sm, uint16 size, Real worldSize,
+		Terrain::Alignment align = Terrain::ALIGN_X_Z)
+	{
+		vector<float>::type heights(size * size);
+		for (uint16 z = 0; z < size; ++z)
+		{
+			for (uint16 x = 0; x < size; ++x)
+			{
+				heights[z * size + x] = 60.0f * Math::Sin(x * 0.11f) * Math::Cos(z * 0.07f)
+					+ 25.0f * Math::Sin((x + z) * 0.31f) + (float)((x * 7 + z * 13) % 5);
+			}
+		}
+
+		Terrain* t = OGRE_NEW Terrain(sm);
+		Terrain::ImportData imp;
+		imp.inputFloat = &heights[0];
+		imp.terrainSize = size;
+		imp.worldSize = worldSize;
+		imp.minBatchSize = 33;
+		imp.maxBatchSize = 65;
+		imp.terrainAlign = align;
+		t->prepare(imp);
+		return t;
+	}
+
+	/// Nearest hit found by testing every triangle of the terrain
+	std::pair<bool, Real> bruteForceRay(Terrain* t, const Ray& ray)
+	{
+		std::pair<bool, Real> nearest(false, 0);
+		long size = t->getSize();
+		for (long z = 0; z < size - 1; ++z)
+		{
+			for (long x = 0; x < size - 1; ++x)
+			{
+				Vector3 v1, v2, v3, v4;
+				t->getPoint(x, z, &v1);
+				t->getPoint(x + 1, z, &v2);
+				t->getPoint(x, z + 1, &v3);
+				t->getPoint(x + 1, z + 1, &v4);
+				std::pair<bool, Real> hits[2];
+				// same triangulation as the terrain
+				if (z % 2)
+				{
+					hits[0] = Math::intersects(ray, v2, v4, v3, true, true);
+					hits[1] = Math::intersects(ray, v1, v2, v3, true, true);
+				}
+				else
+				{
+					hits[0] = Math::intersects(ray, v1, v2, v4, true, true);
+					hits[1] = Math::intersects(ray, v1, v4, v3, true, true);
+				}
+				for (int i = 0; i < 2; ++i)
+				{
+					if (hits[i].first && (!nearest.first || hits[i].second < nearest.second))
+						nearest = hits[i];
+				}
+			}
+		}
+		return nearest;
+	}
+
+	/// Rays from above at a range of slopes, plus shallow ones along the light direction
+	void makeTestRays(Terrain* t, size_t numRays, vector<Ray>::type& rays)
+	{
+		Real halfSize = t->getWorldSize() * 0.5f;
+		for (size_t i = 0; i < numRays; ++i)
+		{
+			Real fx = (Real)((i * 37) % 101) / 100.0f;
+			Real fz = (Real)((i * 59) % 103) / 102.0f;
+			Vector3 origin(halfSize * (fx * 2 - 1), 0, halfSize * (fz * 2 - 1));
+			Vector3 dir;
+			if (i % 2)
+			{
+				origin.y = 150.0f;
+				Radian angle((Real)i);
+				dir = Vector3(Math::Cos(angle), -0.15f - (Real)(i % 7) * 0.3f, Math::Sin(angle));
+			}
+			else
+			{
+				// from just above the surface towards the light, as for lightmaps
+				origin.y = t->getHeightAtWorldPosition(origin) + 1.0f;
+				dir = Vector3(-1, 0.2f + (Real)(i % 5) * 0.1f, 0.3f);
+			}
+			rays.push_back(Ray(origin, dir.normalisedCopy()));
+		}
+	}
+
+	void checkRaysMatchTriangles(Terrain* t)
+	{
+		vector<Ray>::type rays;
+		makeTestRays(t, 200, rays);
+		Real quadSize = t->getWorldSize() / (Real)(t->getSize() - 1);
+		size_t numHits = 0;
+		for (vector<Ray>::type::iterator i = rays.begin(); i != rays.end(); ++i)
+		{
+			std::pair<bool, Real> expected = bruteForceRay(t, *i);
+			std::pair<bool, Vector3> result = t->rayIntersects(*i);
+			CPPUNIT_ASSERT_EQUAL(expected.first, result.first);
+			if (expected.first)
+			{
+				++numHits;
+				Vector3 expectedPos = i->getPoint(expected.second);
+				// the quad test allows a small margin at triangle edges, which
+				// moves shallow rays' hits by a fraction of a quad
+				CPPUNIT_ASSERT(expectedPos.positionEquals(result.second, quadSize * 0.1f));
+			}
+		}
+		// both kinds of result are covered
+		CPPUNIT_ASSERT(numHits > 20 && numHits < rays.size() - 20);
+	}
+}
+
+void TerrainTests::testRayIntersectsMatchesTriangles()
+{
+	Terrain* t = createHillTerrain(mSceneMgr, 65, 640);
+	checkRaysMatchTriangles(t);
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testRayIntersectsAfterEdit()
+{
+	Terrain* t = createHillTerrain(mSceneMgr, 65, 640);
+	// prime any cached data before the edits
+	t->rayIntersects(Ray(Vector3(0, 500, 0), Vector3::NEGATIVE_UNIT_Y));
+
+	// a ridge across the middle, a pit and a single spike
+	for (long x = 0; x < 65; ++x)
+		t->setHeightAtPoint(x, 32, 250.0f);
+	for (long z = 10; z < 20; ++z)
+		for (long x = 40; x < 50; ++x)
+			t->setHeightAtPoint(x, z, -200.0f);
+	t->setHeightAtPoint(5, 60, 400.0f);
+
+	std::pair<bool, Vector3> hit = t->rayIntersects(Ray(Vector3(0, 500, 0), Vector3::NEGATIVE_UNIT_Y));
+	CPPUNIT_ASSERT(hit.first);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(250.0, hit.second.y, 1e-2);
+	checkRaysMatchTriangles(t);
+
+	// bulk edit through the height data
+	float* heights = t->getHeightData();
+	for (long i = 0; i < 65 * 65; ++i)
+		heights[i] *= 0.5f;
+	t->dirty();
+	checkRaysMatchTriangles(t);
+
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testRaySpeed()
+{
+	Terrain* t = createHillTerrain(mSceneMgr, 513, 5000);
+	vector<Ray>::type rays;
+	makeTestRays(t, 20000, rays);
+
+	Timer timer;
+	size_t numHits = 0;
+	for (vector<Ray>::type::iterator i = rays.begin(); i != rays.end(); ++i)
+	{
+		if (t->rayIntersects(*i).first)
+			++numHits;
+	}
+	Real rayTime = (Real)timer.getMicroseconds() / 1000.0f;
+
+	timer.reset();
+	Rect rect(0, 0, 513, 513), finalRect;
+	PixelBox* lightmap = t->calculateLightmap(rect, Rect(), finalRect);
+	Real lightmapTime = (Real)timer.getMicroseconds() / 1000.0f;
+	OGRE_FREE(lightmap->data, MEMCATEGORY_GENERAL);
+	OGRE_DELETE lightmap;
+
+	std::cout << std::endl << "Terrain rays, 513x513: " << rays.size() << " rays ("
+		<< numHits << " hits) " << rayTime << "ms, "
+		<< (Real)rays.size() / rayTime << " rays/ms; lightmap " << finalRect.width() << "x"
+		<< finalRect.height() << " " << lightmapTime << "ms" << std::endl;
+
+	OGRE_DELETE t;
+}
+
+namespace
+{
+	/// Normals encoded the way the terrain does, from the planes around each vertex
+	void calculatePlaneNormals(Terrain* t, vector<uint8>::type& normals)
+	{
+		long size = t->getSize();
+		normals.resize(size * size * 3);
+		const long offsets[9][2] = 
+			{ {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0} };
+		for (long y = 0; y < size; ++y)
+		{
+			for (long x = 0; x < size; ++x)
+			{
+				Vector3 centre, points[9];
+				t->getPoint(x, y, &centre);
+				for (int i = 0; i < 9; ++i)
+				{
+					long px = std::min(std::max(x + offsets[i][0], 0L), size - 1);
+					long py = std::min(std::max(y + offsets[i][1], 0L), size - 1);
+					t->getPoint(px, py, &points[i]);
+				}
+				Vector3 normal = Vector3::ZERO;
+				for (int i = 0; i < 8; ++i)
+					normal += Plane(centre, points[i], points[i + 1]).normal;
+				normal.normalise();
+
+				uint8* pStore = &normals[((size - y - 1) * size + x) * 3];
+				pStore[0] = static_cast<uint8>((normal.x + 1.0f) * 0.5f * 255.0f);
+				pStore[1] = static_cast<uint8>((normal.y + 1.0f) * 0.5f * 255.0f);
+				pStore[2] = static_cast<uint8>((normal.z + 1.0f) * 0.5f * 255.0f);
+			}
+		}
+	}
+
+	void freePixelBox(PixelBox* box)
+	{
+		OGRE_FREE(box->data, MEMCATEGORY_GENERAL);
+		OGRE_DELETE box;
+	}
+}
+
+void TerrainTests::testNormalsMatchPlanes()
+{
+	Terrain::Alignment aligns[2] = { Terrain::ALIGN_X_Z, Terrain::ALIGN_Y_Z };
+	for (int a = 0; a < 2; ++a)
+	{
+		Terrain* t = createHillTerrain(mSceneMgr, 65, 640, aligns[a]);
+		vector<uint8>::type expected;
+		calculatePlaneNormals(t, expected);
+
+		Rect rect(0, 0, 65, 65), finalRect;
+		PixelBox* normals = t->calculateNormals(rect, finalRect);
+		CPPUNIT_ASSERT(finalRect.width() == 65 && finalRect.height() == 65);
+		const uint8* pData = static_cast<const uint8*>(normals->data);
+		// allow for rounding in the last bit
+		for (size_t i = 0; i < expected.size(); ++i)
+			CPPUNIT_ASSERT(std::abs((int)pData[i] - (int)expected[i]) <= 1);
+
+		freePixelBox(normals);
+		OGRE_DELETE t;
+	}
+}
+
+void TerrainTests::testDerivedDataTiles()
+{
+	Terrain* t = createHillTerrain(mSceneMgr, 129, 1280);
+
+	// The tiles of an update must add up to the update in one go
+	Rect dirty(20, 10, 110, 90), finalRect;
+	PixelBox* normals = t->calculateNormals(dirty, finalRect);
+	PixelBox tiledNormals(finalRect.width(), finalRect.height(), 1, PF_BYTE_RGB,
+		OGRE_MALLOC(normals->getConsecutiveSize(), MEMCATEGORY_GENERAL));
+	for (long top = finalRect.top; top < finalRect.bottom; top += 17)
+	{
+		for (long left = finalRect.left; left < finalRect.right; left += 17)
+		{
+			Rect tile(left, top, std::min(left + 17, finalRect.right),
+				std::min(top + 17, finalRect.bottom));
+			t->calculateNormals(tile, finalRect, &tiledNormals);
+		}
+	}
+	CPPUNIT_ASSERT(memcmp(normals->data, tiledNormals.data, normals->getConsecutiveSize()) == 0);
+	freePixelBox(normals);
+	OGRE_FREE(tiledNormals.data, MEMCATEGORY_GENERAL);
+
+	PixelBox* lightmap = t->calculateLightmap(dirty, Rect(), finalRect);
+	PixelBox tiledLightmap(finalRect.width(), finalRect.height(), 1, PF_L8,
+		OGRE_MALLOC(lightmap->getConsecutiveSize(), MEMCATEGORY_GENERAL));
+	for (long top = finalRect.top; top < finalRect.bottom; top += 50)
+	{
+		for (long left = finalRect.left; left < finalRect.right; left += 50)
+		{
+			Rect tile(left, top, std::min(left + 50, finalRect.right),
+				std::min(top + 50, finalRect.bottom));
+			t->calculateLightmap(tile, finalRect, &tiledLightmap);
+		}
+	}
+	CPPUNIT_ASSERT(memcmp(lightmap->data, tiledLightmap.data, lightmap->getConsecutiveSize()) == 0);
+	freePixelBox(lightmap);
+	OGRE_FREE(tiledLightmap.data, MEMCATEGORY_GENERAL);
+
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testDerivedDataManyTiles()
+{
+	// more tiles than a 16 bit count can hold; the update must only be 
+	// finalised once the last of them has responded
+	Terrain* t = createHillTerrain(mSceneMgr, 1025, 10000);
+	mTerrainOpts->setDerivedDataTileSize(4);
+	WorkQueue* wq = mRoot->getWorkQueue();
+	wq->startup();
+
+	// calculates the normals of the whole terrain
+	t->_setNormalMapRequired(true);
+	CPPUNIT_ASSERT(t->isDerivedDataUpdateInProgress());
+	while (t->isDerivedDataUpdateInProgress())
+		wq->processResponses();
+
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testNormalsSpeed()
+{
+	Terrain* t = createHillTerrain(mSceneMgr, 2049, 20000);
+
+	Timer timer;
+	Rect rect(0, 0, 2049, 2049), finalRect;
+	PixelBox* normals = t->calculateNormals(rect, finalRect);
+	Real normalsTime = (Real)timer.getMicroseconds() / 1000.0f;
+	freePixelBox(normals);
+
+	std::cout << std::endl << "Terrain normals, 2049x2049: " << normalsTime << "ms" << std::endl;
+
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testCompressedHeights()
+{
+	if (!StreamSerialiser::isCompressionSupported())
+		return;
+
+	Terrain* t = createHillTerrain(mSceneMgr, 129, 1280);
+	const float* heights = t->getHeightData();
+	uint16 size = t->getSize();
+	Real precision = 0.01;
+
+	DataStreamPtr data(OGRE_NEW MemoryDataStream(size * size * sizeof(float) * 2));
+	StreamSerialiser writer(data);
+	TerrainCompression::writeHeights(writer, heights, size, 4, precision);
+	size_t compressedSize = data->tell();
+	CPPUNIT_ASSERT(compressedSize < size * size * sizeof(float));
+
+	// All levels
+	data->seek(0);
+	StreamSerialiser reader(data);
+	vector<float>::type readHeights(size * size, 0.0f);
+	uint16 level = 0;
+	for (uint16 expectedLevel = 4; expectedLevel-- > 0; )
+	{
+		CPPUNIT_ASSERT(TerrainCompression::readHeightLevel(reader, &readHeights[0], size, &level));
+		CPPUNIT_ASSERT_EQUAL(expectedLevel, level);
+	}
+	CPPUNIT_ASSERT_EQUAL(compressedSize, data->tell());
+	for (size_t i = 0; i < readHeights.size(); ++i)
+		CPPUNIT_ASSERT(Math::Abs(readHeights[i] - heights[i]) <= precision * 0.501f);
+
+	// The coarsest level only, the rest filled in from it
+	data->seek(0);
+	StreamSerialiser coarseReader(data);
+	vector<float>::type coarseHeights(size * size, 0.0f);
+	CPPUNIT_ASSERT(TerrainCompression::readHeightLevel(coarseReader, &coarseHeights[0], size, &level));
+	CPPUNIT_ASSERT_EQUAL((uint16)3, level);
+	TerrainCompression::interpolateHeights(&coarseHeights[0], size, level);
+	for (uint16 y = 0; y < size; ++y)
+	{
+		for (uint16 x = 0; x < size; ++x)
+		{
+			size_t i = y * size + x;
+			if (x % 8 == 0 && y % 8 == 0)
+				CPPUNIT_ASSERT_EQUAL(readHeights[i], coarseHeights[i]);
+			else
+				CPPUNIT_ASSERT(Math::Abs(coarseHeights[i] - heights[i]) < 100);
+		}
+	}
+
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testCompressedImage()
+{
+	if (!StreamSerialiser::isCompressionSupported())
+		return;
+
+	size_t size = 256;
+	vector<uint8>::type image(size * size * 3);
+	for (size_t y = 0; y < size; ++y)
+	{
+		for (size_t x = 0; x < size; ++x)
+		{
+			uint8* pixel = &image[(y * size + x) * 3];
+			pixel[0] = (uint8)(128 + 100 * Math::Sin(x * 0.05f) * Math::Cos(y * 0.03f));
+			pixel[1] = (uint8)(x ^ y);
+			pixel[2] = (uint8)((x * 7 + y * 13) % 5);
+		}
+	}
+	vector<float>::type values(1000);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = Math::Sin(i * 0.1f) * 50.0f;
+
+	DataStreamPtr data(OGRE_NEW MemoryDataStream(image.size() * 2));
+	StreamSerialiser writer(data);
+	TerrainCompression::writeImage(writer, &image[0], size, size, 3);
+	TerrainCompression::writeQuantised(writer, &values[0], values.size(), 0.001);
+	CPPUNIT_ASSERT(data->tell() < image.size() + values.size() * sizeof(float));
+
+	data->seek(0);
+	StreamSerialiser reader(data);
+	vector<uint8>::type readImage(image.size());
+	TerrainCompression::readImage(reader, &readImage[0], size, size, 3);
+	CPPUNIT_ASSERT(readImage == image);
+	vector<float>::type readValues(values.size());
+	TerrainCompression::readQuantised(reader, &readValues[0], readValues.size());
+	for (size_t i = 0; i < values.size(); ++i)
+		CPPUNIT_ASSERT(Math::Abs(readValues[i] - values[i]) <= 0.00051f);
+}
+
+void TerrainTests::testCompressedSaveLoad()
+{
+	if (!StreamSerialiser::isCompressionSupported())
+		return;
+
+	Terrain* t = createHillTerrain(mSceneMgr, 129, 1280);
+	uint16 size = t->getSize();
+	size_t bufferSize = size * size * sizeof(float) * 8;
+
+	DataStreamPtr plain(OGRE_NEW MemoryDataStream(bufferSize));
+	StreamSerialiser plainWriter(plain);
+	t->save(plainWriter);
+	size_t plainSize = plain->tell();
+
+	Real precision = 0.05;
+	mTerrainOpts->setSaveCompressed(true);
+	mTerrainOpts->setCompressedHeightPrecision(precision);
+	DataStreamPtr data(OGRE_NEW MemoryDataStream(bufferSize));
+	StreamSerialiser writer(data);
+	t->save(writer);
+	CPPUNIT_ASSERT(data->tell() < plainSize);
+
+	// the height levels follow the quad tree, and all of them must be found
+	data->seek(0);
+	StreamSerialiser reader(data);
+	Terrain* loaded = OGRE_NEW Terrain(mSceneMgr);
+	CPPUNIT_ASSERT(loaded->prepare(reader));
+	CPPUNIT_ASSERT_EQUAL(size, loaded->getSize());
+	CPPUNIT_ASSERT_EQUAL(t->getNumLodLevels(), loaded->getNumLodLevels());
+
+	const float* heights = t->getHeightData();
+	const float* loadedHeights = loaded->getHeightData();
+	const float* deltas = t->getDeltaData();
+	const float* loadedDeltas = loaded->getDeltaData();
+	for (size_t i = 0; i < (size_t)size * size; ++i)
+	{
+		CPPUNIT_ASSERT(Math::Abs(loadedHeights[i] - heights[i]) <= precision * 0.501f);
+		CPPUNIT_ASSERT(Math::Abs(loadedDeltas[i] - deltas[i]) <= precision * 0.501f);
+	}
+
+	// bounds are built from the loaded heights
+	const AxisAlignedBox& box = t->getQuadTree()->getAABB();
+	const AxisAlignedBox& loadedBox = loaded->getQuadTree()->getAABB();
+	CPPUNIT_ASSERT(loadedBox.getMinimum().positionEquals(box.getMinimum(), precision));
+	CPPUNIT_ASSERT(loadedBox.getMaximum().positionEquals(box.getMaximum(), precision));
+
+	OGRE_DELETE loaded;
+	OGRE_DELETE t;
+}
+
+void TerrainTests::testStreamedVertexData()
+{
+	Terrain* full = createHillTerrain(mSceneMgr, 1025, 1000);
+	mTerrainOpts->setStreamVertexData(true);
+	Terrain* t = createHillTerrain(mSceneMgr, 1025, 1000);
+	Terrain::VertexDataStreamer* streamer = t->getVertexDataStreamer();
+
+	// only the root has vertex data to begin with, but all the bounds are known
+	// at this size there is data at depth 1 which depth 3 refines
+	TerrainQuadTreeNode* root = t->getQuadTree();
+	TerrainQuadTreeNode* coarse = root->getChild(0);
+	TerrainQuadTreeNode* fine = coarse->getChild(0)->getChild(0);
+	TerrainQuadTreeNode* sibling = coarse->getChild(0)->getChild(1);
+	CPPUNIT_ASSERT(root->isVertexDataAvailable());
+	CPPUNIT_ASSERT(!root->isVertexDataStreamed());
+	CPPUNIT_ASSERT(coarse->isVertexDataStreamed());
+	CPPUNIT_ASSERT(!coarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT(fine->isVertexDataStreamed());
+	CPPUNIT_ASSERT(!fine->isVertexDataAvailable());
+	const AxisAlignedBox& fullBox = full->getQuadTree()->getChild(0)->getChild(0)->getChild(0)->getAABB();
+	CPPUNIT_ASSERT(fine->getAABB().getMinimum().positionEquals(fullBox.getMinimum()));
+	CPPUNIT_ASSERT(fine->getAABB().getMaximum().positionEquals(fullBox.getMaximum()));
+
+	// room for the coarse data and one fine set, the coarser data is loaded first
+	size_t coarseBytes = coarse->getVertexDataMemorySize();
+	size_t fineBytes = fine->getVertexDataMemorySize();
+	streamer->setMemoryBudget(coarseBytes + fineBytes);
+	streamer->_requestLoad(fine);
+	streamer->_requestLoad(coarse);
+	streamer->_processRequests();
+	CPPUNIT_ASSERT(coarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT(fine->isVertexDataAvailable());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer->getStatistics().residentCount);
+	CPPUNIT_ASSERT_EQUAL(coarseBytes + fineBytes, streamer->getStatistics().residentBytes);
+
+	// data loaded in this frame is kept, so the request waits
+	streamer->_requestLoad(sibling);
+	streamer->_processRequests();
+	CPPUNIT_ASSERT(!sibling->isVertexDataAvailable());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer->getStatistics().deferredCount);
+
+	// once it hasn't been rendered for a frame, the finest of it goes
+	mRoot->_fireFrameRenderingQueued();
+	mRoot->_fireFrameRenderingQueued();
+	streamer->_requestLoad(sibling);
+	streamer->_processRequests();
+	CPPUNIT_ASSERT(sibling->isVertexDataAvailable());
+	CPPUNIT_ASSERT(!fine->isVertexDataAvailable());
+	CPPUNIT_ASSERT(coarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer->getStatistics().evictionCount);
+
+	// evicting coarse data takes the data refining it too
+	TerrainQuadTreeNode* otherCoarse = root->getChild(1);
+	streamer->setMemoryBudget(coarseBytes);
+	mRoot->_fireFrameRenderingQueued();
+	mRoot->_fireFrameRenderingQueued();
+	streamer->_requestLoad(otherCoarse);
+	streamer->_processRequests();
+	CPPUNIT_ASSERT(otherCoarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT(!coarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT(!sibling->isVertexDataAvailable());
+	CPPUNIT_ASSERT_EQUAL((size_t)3, streamer->getStatistics().evictionCount);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer->getStatistics().residentCount);
+	CPPUNIT_ASSERT_EQUAL(coarseBytes, streamer->getStatistics().residentBytes);
+
+	streamer->evictAll();
+	CPPUNIT_ASSERT(!otherCoarse->isVertexDataAvailable());
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer->getStatistics().residentBytes);
+	CPPUNIT_ASSERT_EQUAL((size_t)4, streamer->getStatistics().loadCount);
+
+	OGRE_DELETE t;
+	OGRE_DELETE full;
+}
+
+void TerrainTests::testGroupMemoryBudget()
+{
+	// no render system, so software vertex buffers and no textures
+	HardwareBufferManager* bufMgr = OGRE_NEW DefaultHardwareBufferManager();
+	mTerrainOpts->setDefaultMaterialGenerator(
+		TerrainMaterialGeneratorPtr(OGRE_NEW TerrainMaterialGenerator()));
+	ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem", "TerrainBudget");
+
+	// three tiles in a row, saved first so that they can be reloaded
+	TerrainGroup* group = OGRE_NEW TerrainGroup(mSceneMgr, Terrain::ALIGN_X_Z, 129, 1280);
+	group->setResourceGroup("TerrainBudget");
+	group->setFilenameConvention("budgettest", "dat");
+	group->getDefaultImportSettings().minBatchSize = 33;
+	group->getDefaultImportSettings().maxBatchSize = 65;
+	StringVector filenames;
+	for (long x = 0; x < 3; ++x)
+	{
+		Terrain* t = createHillTerrain(mSceneMgr, 129, 1280);
+		t->setResourceGroup("TerrainBudget");
+		Vector3 pos;
+		group->convertTerrainSlotToWorldPosition(x, 0, &pos);
+		t->setPosition(pos);
+		filenames.push_back(group->generateFilename(x, 0));
+		t->save(filenames.back());
+		OGRE_DELETE t;
+		group->defineTerrain(x, 0);
+	}
+	group->loadAllTerrains(true);
+
+	TerrainGroup::ResidencyStatistics stats = group->getResidencyStatistics();
+	CPPUNIT_ASSERT_EQUAL((size_t)3, stats.loadedCount);
+	Terrain* first = group->getTerrain(0, 0);
+	CPPUNIT_ASSERT(first->getGpuMemoryUsage() > 0);
+	size_t tileBytes = first->getCpuMemoryUsage() + first->getGpuMemoryUsage();
+	CPPUNIT_ASSERT_EQUAL(tileBytes * 3, stats.cpuMemory + stats.gpuMemory);
+
+	// room for two tiles, but all of them have just been loaded
+	group->setMemoryBudget(tileBytes * 2);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, group->getResidencyStatistics().loadedCount);
+
+	// once the first is out of view for a frame it goes, and its neighbour forgets it
+	mRoot->_fireFrameRenderingQueued();
+	group->getTerrain(1, 0)->_notifyVisible();
+	group->getTerrain(2, 0)->_notifyVisible();
+	mRoot->_fireFrameRenderingQueued();
+	group->applyMemoryBudget();
+	stats = group->getResidencyStatistics();
+	CPPUNIT_ASSERT(!group->getTerrain(0, 0));
+	CPPUNIT_ASSERT(!group->getTerrain(1, 0)->getNeighbour(Terrain::NEIGHBOUR_WEST));
+	CPPUNIT_ASSERT_EQUAL((size_t)2, stats.loadedCount);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, stats.evictionCount);
+	CPPUNIT_ASSERT(stats.cpuMemory + stats.gpuMemory + stats.freeBufferMemory <= tileBytes * 2);
+
+	// bringing it back evicts the least recently visible tile which hasn't been edited
+	group->getTerrain(1, 0)->setHeightAtPoint(10, 10, 50);
+	mRoot->_fireFrameRenderingQueued();
+	mRoot->_fireFrameRenderingQueued();
+	group->loadTerrain(0, 0, true);
+	stats = group->getResidencyStatistics();
+	CPPUNIT_ASSERT(group->getTerrain(0, 0) && group->getTerrain(0, 0)->isLoaded());
+	CPPUNIT_ASSERT(group->getTerrain(1, 0));
+	CPPUNIT_ASSERT(!group->getTerrain(2, 0));
+	CPPUNIT_ASSERT_EQUAL((size_t)2, stats.loadedCount);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, stats.evictionCount);
+
+	OGRE_DELETE group;
+	for (StringVector::iterator i = filenames.begin(); i != filenames.end(); ++i)
+		ResourceGroupManager::getSingleton().deleteResource(*i, "TerrainBudget");
+	OGRE_DELETE bufMgr;
+}
@@ -35,6 +35,7 @@ class BitwiseTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testFixedPointConversion);
     CPPUNIT_TEST(testIntReadWrite);
     CPPUNIT_TEST(testHalf);
+    CPPUNIT_TEST(testCountBitsSet);
     CPPUNIT_TEST_SUITE_END();
 public:
     void setUp();
@@ -42,4 +43,5 @@ public:
     void testFixedPointConversion();
     void testIntReadWrite();
     void testHalf();
+    void testCountBitsSet();
 };
@@ -39,6 +39,11 @@ class EdgeBuilderTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testSingleIndexBufSingleVertexBuf);
     CPPUNIT_TEST(testMultiIndexBufSingleVertexBuf);
     CPPUNIT_TEST(testMultiIndexBufMultiVertexBuf);
+    CPPUNIT_TEST(testParallelLargeMesh);
+#ifdef OGRE_TEST_BENCHMARKS
+    CPPUNIT_TEST(testBuildPerformance);
+#endif
+    CPPUNIT_TEST(testLightFacing);
     CPPUNIT_TEST_SUITE_END();
 protected:
     HardwareBufferManager* mBufMgr;
@@ -49,5 +54,8 @@ public:
     void testSingleIndexBufSingleVertexBuf();
     void testMultiIndexBufSingleVertexBuf();
     void testMultiIndexBufMultiVertexBuf();
+    void testParallelLargeMesh();
+    void testBuildPerformance();
+    void testLightFacing();
 
 };
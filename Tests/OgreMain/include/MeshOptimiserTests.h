@@ -0,0 +1,63 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgreMesh.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreLodStrategyManager.h"
+
+class MeshOptimiserTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( MeshOptimiserTests );
+	CPPUNIT_TEST(testCacheMissesReduced);
+	CPPUNIT_TEST(testTrianglesPreserved);
+	CPPUNIT_TEST(testVerticesInFirstUseOrder);
+	CPPUNIT_TEST(testSharedVertexData);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Ogre::ResourceGroupManager* mResourceGroupMgr;
+	Ogre::LodStrategyManager* mLodStrategyMgr;
+	Ogre::HardwareBufferManager* mBufMgr;
+	Ogre::MeshManager* mMeshMgr;
+
+	/** Create a grid of triangles in a random order, using vertices in a
+		random order, with the original vertex number as a texture coordinate.
+	@param submeshes Number of submeshes the triangles are divided between
+	@param shared Whether the submeshes use shared vertex data
+	*/
+	Ogre::MeshPtr createGrid(const Ogre::String& name, size_t size, size_t submeshes, bool shared);
+public:
+	void setUp();
+	void tearDown();
+
+	void testCacheMissesReduced();
+	void testTrianglesPreserved();
+	void testVerticesInFirstUseOrder();
+	void testSharedVertexData();
+};
@@ -38,6 +38,7 @@ class RadixSortTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testIntList);
 	CPPUNIT_TEST(testUnsignedIntVector);
 	CPPUNIT_TEST(testIntVector);
+	CPPUNIT_TEST(testUnsignedInt64Vector);
 	CPPUNIT_TEST_SUITE_END();
 protected:
 public:
@@ -49,5 +50,6 @@ public:
 	void testIntList();
 	void testUnsignedIntVector();
 	void testIntVector();
+	void testUnsignedInt64Vector();
 
 };
@@ -0,0 +1,62 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TestRandom_H__
+#define __TestRandom_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreMath.h"
+#include "OgreVector3.h"
+#include "OgreQuaternion.h"
+
+/** Simple deterministic generator for test data, so that failures can be
+	reproduced and scenes built identically more than once.
+*/
+class TestRandom
+{
+	Ogre::uint32 mState;
+public:
+	TestRandom(Ogre::uint32 seed) : mState(seed) {}
+
+	/// Next value in [low, high)
+	Ogre::Real next(Ogre::Real low, Ogre::Real high)
+	{
+		mState = mState * 1664525 + 1013904223;
+		return low + (high - low) * (Ogre::Real)(mState >> 8) / (Ogre::Real)(1 << 24);
+	}
+
+	/// Rotation about a random axis
+	Ogre::Quaternion nextRotation(void)
+	{
+		Ogre::Vector3 axis(next(-1, 1), next(-1, 1), next(-1, 1));
+		axis.x += 0.01f;
+		return Ogre::Quaternion(Ogre::Radian(next(-Ogre::Math::PI, Ogre::Math::PI)),
+			axis.normalisedCopy());
+	}
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "AnimationTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSkeletonManager.h"
+#include "OgreSkeleton.h"
+#include "OgreBone.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreSkeletonSerializer.h"
+#include "OgreDataStream.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( AnimationTests );
+
+namespace
+{
+	/** Create a skeleton with a chain of bones, and an animation with a
+		track for every bone, keyed at random. */
+	SkeletonPtr createAnimatedSkeleton(const String& name, unsigned short numBones, uint32 seed)
+	{
+		SkeletonPtr skel = SkeletonManager::getSingleton().create(
+			name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+		TestRandom rnd(seed);
+		Bone* parent = 0;
+		for (unsigned short b = 0; b < numBones; ++b)
+		{
+			Bone* bone = skel->createBone(b);
+			bone->setPosition(rnd.next(-1, 1), rnd.next(0, 2), rnd.next(-1, 1));
+			bone->setOrientation(rnd.nextRotation());
+			if (parent)
+				parent->addChild(bone);
+			parent = bone;
+		}
+		skel->setBindingPose();
+
+		Animation* anim = skel->createAnimation("Walk", 3);
+		for (unsigned short b = 0; b < numBones; ++b)
+		{
+			NodeAnimationTrack* track = anim->createNodeTrack(b, skel->getBone(b));
+			for (int k = 0; k < 4; ++k)
+			{
+				TransformKeyFrame* kf = track->createNodeKeyFrame((Real)k);
+				kf->setTranslate(Vector3(rnd.next(-1, 1), rnd.next(-1, 1), rnd.next(-1, 1)));
+				kf->setRotation(rnd.nextRotation());
+				kf->setScale(Vector3(rnd.next(0.5f, 2), rnd.next(0.5f, 2), rnd.next(0.5f, 2)));
+			}
+		}
+		return skel;
+	}
+
+	/** Add a track keyed densely along smooth curves, as exporters which
+		sample every frame produce. */
+	NodeAnimationTrack* createSampledTrack(Animation* anim, unsigned short handle, size_t numKeys)
+	{
+		NodeAnimationTrack* track = anim->createNodeTrack(handle);
+		for (size_t k = 0; k < numKeys; ++k)
+		{
+			Real t = anim->getLength() * k / (numKeys - 1);
+			TransformKeyFrame* kf = track->createNodeKeyFrame(t);
+			kf->setTranslate(Vector3(Math::Sin(t) * 2, t * 0.5f, 1));
+			kf->setRotation(Quaternion(Radian(Math::Cos(t * 2)), Vector3::UNIT_Y) *
+				Quaternion(Radian(t * 0.3f), Vector3::UNIT_X));
+		}
+		return track;
+	}
+
+	/// Angle of the rotation between 2 orientations
+	Radian rotationDifference(const Quaternion& a, const Quaternion& b)
+	{
+		return Math::ACos(std::min(Math::Abs(a.Dot(b)), (Real)1.0f)) * 2;
+	}
+}
+
+void AnimationTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+}
+void AnimationTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+void AnimationTests::testBatchedSkeletonApplyMatchesTracks()
+{
+	// more bones than fit in one batch, and not a multiple of 4
+	const unsigned short numBones = 45;
+	SkeletonPtr batched = createAnimatedSkeleton("Batched", numBones, 17);
+	SkeletonPtr tracks = createAnimatedSkeleton("Tracks", numBones, 17);
+
+	const Real times[] = { 0, 0.3f, 1.5f, 2.99f, 3 };
+	for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+	{
+		batched->reset();
+		tracks->reset();
+
+		batched->getAnimation("Walk")->apply(batched.get(), times[i], 0.7f, 1.3f);
+
+		// The same thing, a track at a time
+		Animation* anim = tracks->getAnimation("Walk");
+		TimeIndex timeIndex = anim->_getTimeIndex(times[i]);
+		Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+		while (it.hasMoreElements())
+		{
+			NodeAnimationTrack* track = it.getNext();
+			track->applyToNode(tracks->getBone(track->getHandle()), timeIndex, 0.7f, 1.3f);
+		}
+
+		for (unsigned short b = 0; b < numBones; ++b)
+		{
+			Bone* expected = tracks->getBone(b);
+			Bone* actual = batched->getBone(b);
+			CPPUNIT_ASSERT(expected->getPosition().positionEquals(actual->getPosition(), 1e-4f));
+			CPPUNIT_ASSERT(expected->getScale().positionEquals(actual->getScale(), 1e-4f));
+			CPPUNIT_ASSERT(expected->getOrientation().equals(actual->getOrientation(), Radian(1e-3f)));
+		}
+	}
+
+	SkeletonManager::getSingleton().remove(batched->getHandle());
+	SkeletonManager::getSingleton().remove(tracks->getHandle());
+}
+
+void AnimationTests::testSkeletonApplyPerformance()
+{
+	const unsigned short numBones = 64;
+	const size_t runs = 2000;
+	SkeletonPtr skel = createAnimatedSkeleton("Timed", numBones, 5);
+	Animation* anim = skel->getAnimation("Walk");
+
+	Timer timer;
+	for (size_t r = 0; r < runs; ++r)
+	{
+		TimeIndex timeIndex = anim->_getTimeIndex((Real)(r % 300) / 100);
+		Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+		while (it.hasMoreElements())
+		{
+			NodeAnimationTrack* track = it.getNext();
+			track->applyToNode(skel->getBone(track->getHandle()), timeIndex, 0.5f);
+		}
+		skel->reset();
+	}
+	double perTrack = (double)timer.getMicroseconds() * 1000.0 / (double)(numBones * runs);
+
+	timer.reset();
+	for (size_t r = 0; r < runs; ++r)
+	{
+		anim->apply(skel.get(), (Real)(r % 300) / 100, 0.5f);
+		skel->reset();
+	}
+	double batched = (double)timer.getMicroseconds() * 1000.0 / (double)(numBones * runs);
+
+	std::cout << std::endl << "Skeleton animation, ns per bone: " << perTrack
+		<< " a track at a time, " << batched << " batched" << std::endl;
+
+	SkeletonManager::getSingleton().remove(skel->getHandle());
+}
+
+void AnimationTests::testCompressedTrackWithinTolerance()
+{
+	Animation anim("Sampled", 4);
+	NodeAnimationTrack* track = createSampledTrack(&anim, 0, 121);
+
+	CompressedNodeAnimationTrack* compressed = anim.createCompressedNodeTrack(1, 0);
+	compressed->compress(track, 0.01f, Degree(0.5f), 0.001f);
+
+	// The scale never changes, so only rotation and translation are stored
+	CPPUNIT_ASSERT(compressed->isCompressed());
+	CPPUNIT_ASSERT_EQUAL((unsigned short)(CompressedNodeAnimationTrack::CH_ROTATION |
+		CompressedNodeAnimationTrack::CH_TRANSLATION), compressed->getChannels());
+	CPPUNIT_ASSERT(compressed->getNumKeyFrames() > 2);
+	CPPUNIT_ASSERT(compressed->getNumKeyFrames() < track->getNumKeyFrames() / 2);
+	CPPUNIT_ASSERT_EQUAL(track->getNodeKeyFrame(120)->getTime(),
+		compressed->getNodeKeyFrame(compressed->getNumKeyFrames() - 1)->getTime());
+
+	// Allow a little extra for quantisation
+	for (Real t = 0; t < 4; t += 0.0137f)
+	{
+		TransformKeyFrame expected(0, t), actual(0, t);
+		track->getInterpolatedKeyFrame(anim._getTimeIndex(t), &expected);
+		compressed->getInterpolatedKeyFrame(anim._getTimeIndex(t), &actual);
+		CPPUNIT_ASSERT(expected.getTranslate().distance(actual.getTranslate()) < 0.0101f);
+		CPPUNIT_ASSERT(rotationDifference(expected.getRotation(), actual.getRotation()) < Degree(0.51f));
+		CPPUNIT_ASSERT(expected.getScale().positionEquals(actual.getScale(), 1e-4f));
+	}
+
+	// Keys are never all removed, and compressed tracks can be compressed again
+	CompressedNodeAnimationTrack* again = anim.createCompressedNodeTrack(2, 0);
+	again->compress(compressed, 100, Degree(180), 100);
+	CPPUNIT_ASSERT_EQUAL((unsigned short)2, again->getNumKeyFrames());
+	CPPUNIT_ASSERT_EQUAL((unsigned short)0, again->getChannels());
+}
+
+void AnimationTests::testCompressedSkeletonApply()
+{
+	// With tight tolerances no keys are removed, and quantisation error is tiny
+	const unsigned short numBones = 45;
+	SkeletonPtr compressed = createAnimatedSkeleton("Compressed", numBones, 23);
+	SkeletonPtr original = createAnimatedSkeleton("Original", numBones, 23);
+	compressed->compressAllAnimations(1e-5f, Radian(1e-5f), 1e-5f);
+	Animation* anim = compressed->getAnimation("Walk");
+	CPPUNIT_ASSERT(anim->getNodeTrack(0)->isCompressed());
+	CPPUNIT_ASSERT_EQUAL((unsigned short)4, anim->getNodeTrack(0)->getNumKeyFrames());
+
+	const Real times[] = { 0, 0.3f, 1.5f, 2.99f, 3 };
+	for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+	{
+		compressed->reset();
+		original->reset();
+		anim->apply(compressed.get(), times[i], 0.7f, 1.3f);
+		original->getAnimation("Walk")->apply(original.get(), times[i], 0.7f, 1.3f);
+
+		for (unsigned short b = 0; b < numBones; ++b)
+		{
+			Bone* expected = original->getBone(b);
+			Bone* actual = compressed->getBone(b);
+			CPPUNIT_ASSERT(expected->getPosition().positionEquals(actual->getPosition(), 1e-3f));
+			CPPUNIT_ASSERT(expected->getScale().positionEquals(actual->getScale(), 1e-3f));
+			CPPUNIT_ASSERT(expected->getOrientation().equals(actual->getOrientation(), Radian(1e-3f)));
+		}
+	}
+
+	SkeletonManager::getSingleton().remove(compressed->getHandle());
+	SkeletonManager::getSingleton().remove(original->getHandle());
+}
+
+void AnimationTests::testCompressedSkeletonSerialisation()
+{
+	SkeletonPtr skel = createAnimatedSkeleton("Saved", 8, 31);
+	Animation* anim = skel->getAnimation("Walk");
+	createSampledTrack(anim, 8, 61)->setAssociatedNode(skel->createBone(8));
+	skel->compressAllAnimations(0.01f, Degree(0.5f), 0.001f);
+
+	const String filename = "AnimationTests.skeleton";
+	SkeletonSerializer serializer;
+	serializer.exportSkeleton(skel.get(), filename);
+
+	SkeletonPtr loaded = SkeletonManager::getSingleton().create(
+		"Loaded", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+	{
+		std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+			filename.c_str(), std::ios::in | std::ios::binary);
+		DataStreamPtr stream(OGRE_NEW FileStreamDataStream(file));
+		serializer.importSkeleton(stream, loaded.get());
+	}
+	std::remove(filename.c_str());
+
+	Animation* loadedAnim = loaded->getAnimation("Walk");
+	CPPUNIT_ASSERT_EQUAL(anim->getNumNodeTracks(), loadedAnim->getNumNodeTracks());
+	for (unsigned short h = 0; h < anim->getNumNodeTracks(); ++h)
+	{
+		NodeAnimationTrack* track = anim->getNodeTrack(h);
+		NodeAnimationTrack* loadedTrack = loadedAnim->getNodeTrack(h);
+		CPPUNIT_ASSERT(loadedTrack->isCompressed());
+		CPPUNIT_ASSERT_EQUAL(track->getNumKeyFrames(), loadedTrack->getNumKeyFrames());
+		for (unsigned short k = 0; k < track->getNumKeyFrames(); ++k)
+		{
+			// Decoded key frames are only valid until the next call, so copy them
+			TransformKeyFrame expected = *track->getNodeKeyFrame(k);
+			TransformKeyFrame* actual = loadedTrack->getNodeKeyFrame(k);
+			CPPUNIT_ASSERT_EQUAL(expected.getTime(), actual->getTime());
+			CPPUNIT_ASSERT(expected.getTranslate() == actual->getTranslate());
+			CPPUNIT_ASSERT(expected.getRotation() == actual->getRotation());
+			CPPUNIT_ASSERT(expected.getScale() == actual->getScale());
+		}
+	}
+
+	SkeletonManager::getSingleton().remove(skel->getHandle());
+	SkeletonManager::getSingleton().remove(loaded->getHandle());
+}
@@ -0,0 +1,292 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "BillboardSetTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreCamera.h"
+#include "OgreBillboard.h"
+#include "OgreBillboardSet.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( BillboardSetTests );
+
+namespace
+{
+	/** Generates each billboard's vertices on its own with genVertices, as
+		injectBillboard did before they were generated in batches
+	*/
+	class ScalarBillboardSet : public BillboardSet
+	{
+	public:
+		ScalarBillboardSet(const String& name, unsigned int poolSize)
+			: BillboardSet(name, poolSize) {}
+
+		void injectScalar(const Billboard& bb)
+		{
+			// individual culling is off, so every billboard is visible
+			if (mNumVisibleBillboards == getPoolSize())
+				return;
+
+			bool ownAxes = !mPointRendering &&
+				(mBillboardType == BBT_ORIENTED_SELF ||
+				mBillboardType == BBT_PERPENDICULAR_SELF ||
+				(mAccurateFacing && mBillboardType != BBT_PERPENDICULAR_COMMON));
+			if (ownAxes)
+				genBillboardAxes(&mCamX, &mCamY, &bb);
+
+			if (mAllDefaultSize || mPointRendering)
+			{
+				if (ownAxes)
+				{
+					genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff,
+						mDefaultWidth, mDefaultHeight, mCamX, mCamY, mVOffset);
+				}
+				genVertices(mVOffset, bb);
+			}
+			else if (ownAxes || bb.hasOwnDimensions())
+			{
+				Vector3 vOwnOffset[4];
+				genVertOffsets(mLeftOff, mRightOff, mTopOff, mBottomOff,
+					bb.getOwnWidth(), bb.getOwnHeight(), mCamX, mCamY, vOwnOffset);
+				genVertices(vOwnOffset, bb);
+			}
+			else
+			{
+				genVertices(mVOffset, bb);
+			}
+			++mNumVisibleBillboards;
+		}
+	};
+
+	typedef vector<Billboard>::type BillboardList;
+
+	/// Options for the billboards compared by compareWithScalar
+	struct BillboardOptions
+	{
+		BillboardType type;
+		bool accurateFacing;
+		/// Every n'th billboard has its own size, or none if 0
+		size_t ownSizeEvery;
+		/// Every n'th billboard is rotated, or none if 0
+		size_t rotateEvery;
+		bool parallel;
+
+		BillboardOptions(BillboardType t)
+			: type(t), accurateFacing(false), ownSizeEvery(0), rotateEvery(0), parallel(false) {}
+	};
+
+	void configure(BillboardSet* set, const BillboardOptions& options)
+	{
+		set->setBillboardType(options.type);
+		set->setUseAccurateFacing(options.accurateFacing);
+		set->setCommonDirection(Vector3(0.3f, 1, 0.2f).normalisedCopy());
+		set->setCommonUpVector(Vector3(0, 0.2f, 1).normalisedCopy());
+		set->setDefaultDimensions(3, 2);
+		set->setTextureStacksAndSlices(2, 2);
+		set->setParallelVertexGeneration(options.parallel);
+	}
+
+	void makeBillboards(BillboardSet* owner, BillboardSet* other, size_t count,
+		const BillboardOptions& options, uint32 seed, BillboardList& billboards)
+	{
+		TestRandom rnd(seed);
+		billboards.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			billboards.push_back(Billboard(
+				Vector3(rnd.next(-50, 50), rnd.next(-50, 50), rnd.next(-50, 50)), owner,
+				ColourValue(rnd.next(0, 1), rnd.next(0, 1), rnd.next(0, 1), rnd.next(0, 1))));
+			Billboard& bb = billboards.back();
+			bb.mDirection = Vector3(rnd.next(-1, 1), rnd.next(-1, 1), 1).normalisedCopy();
+			if (i % 3 == 0)
+				bb.setTexcoordRect(rnd.next(0, 0.5f), rnd.next(0, 0.5f), rnd.next(0.5f, 1), rnd.next(0.5f, 1));
+			else
+				bb.setTexcoordIndex((uint16)(i % 4));
+			if (options.ownSizeEvery && i % options.ownSizeEvery == 0)
+				bb.setDimensions(rnd.next(1, 5), rnd.next(1, 5));
+			if (options.rotateEvery && i % options.rotateEvery == 0)
+				bb.setRotation(Radian(rnd.next(0.1f, 3)));
+		}
+		// the billboards only tell their owner
+		if (options.ownSizeEvery)
+			other->_notifyBillboardResized();
+		if (options.rotateEvery)
+			other->_notifyBillboardRotated();
+	}
+
+	const void* lockVertices(BillboardSet* set, size_t& vertexCount, size_t& vertexSize)
+	{
+		RenderOperation op;
+		set->getRenderOperation(op);
+		HardwareVertexBufferSharedPtr vbuf = op.vertexData->vertexBufferBinding->getBuffer(0);
+		vertexCount = op.vertexData->vertexCount;
+		vertexSize = vbuf->getVertexSize();
+		return vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+	}
+
+	void unlockVertices(BillboardSet* set)
+	{
+		RenderOperation op;
+		set->getRenderOperation(op);
+		op.vertexData->vertexBufferBinding->getBuffer(0)->unlock();
+	}
+
+	/** Generate the vertices of the same billboards through injectBillboard
+		and through ScalarBillboardSet, and check they're identical
+	*/
+	void compareWithScalar(SceneManager* sm, SceneNode* node, Camera* cam,
+		const BillboardOptions& options, size_t count)
+	{
+		BillboardSet* batched = sm->createBillboardSet("Batched", (unsigned int)count);
+		ScalarBillboardSet* scalar = OGRE_NEW ScalarBillboardSet("Scalar", (unsigned int)count);
+		configure(batched, options);
+		configure(scalar, options);
+		node->attachObject(batched);
+		node->attachObject(scalar);
+
+		BillboardList billboards;
+		makeBillboards(batched, scalar, count, options, 1234, billboards);
+
+		batched->_notifyCurrentCamera(cam);
+		batched->beginBillboards(count);
+		for (BillboardList::iterator i = billboards.begin(); i != billboards.end(); ++i)
+			batched->injectBillboard(*i);
+		batched->endBillboards();
+
+		scalar->_notifyCurrentCamera(cam);
+		scalar->beginBillboards(count);
+		for (BillboardList::iterator i = billboards.begin(); i != billboards.end(); ++i)
+			scalar->injectScalar(*i);
+		scalar->endBillboards();
+
+		size_t vertexCount[2], vertexSize[2];
+		const void* batchedVerts = lockVertices(batched, vertexCount[0], vertexSize[0]);
+		const void* scalarVerts = lockVertices(scalar, vertexCount[1], vertexSize[1]);
+		CPPUNIT_ASSERT_EQUAL(count * 4, vertexCount[0]);
+		CPPUNIT_ASSERT_EQUAL(vertexCount[1], vertexCount[0]);
+		CPPUNIT_ASSERT_EQUAL(vertexSize[1], vertexSize[0]);
+		CPPUNIT_ASSERT(memcmp(batchedVerts, scalarVerts, vertexCount[0] * vertexSize[0]) == 0);
+		unlockVertices(batched);
+		unlockVertices(scalar);
+
+		node->detachAllObjects();
+		sm->destroyBillboardSet(batched);
+		OGRE_DELETE scalar;
+	}
+}
+
+void BillboardSetTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+	mBufMgr = new DefaultHardwareBufferManager();
+	// billboard sets start with BaseWhite; without techniques, since
+	// compiling them needs a render system
+	MaterialManager::getSingleton().initialise();
+	MaterialPtr baseWhite = MaterialManager::getSingleton().getByName("BaseWhite");
+	baseWhite->removeAllTechniques();
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	mNode = mSceneMgr->getRootSceneNode()->createChildSceneNode(
+		Vector3(5, -3, 2), Quaternion(Degree(30), Vector3::UNIT_Y));
+	mSceneMgr->getRootSceneNode()->_update(true, false);
+	// not registered with the scene manager, which needs a render system
+	// to destroy it
+	mCamera = OGRE_NEW Camera("BillboardTest", mSceneMgr);
+	mCamera->setPosition(40, 30, 200);
+	mCamera->lookAt(0, 0, 0);
+}
+void BillboardSetTests::tearDown()
+{
+	OGRE_DELETE mCamera;
+	mRoot->destroySceneManager(mSceneMgr);
+	delete mBufMgr;
+	OGRE_DELETE mRoot;
+}
+
+void BillboardSetTests::testBatchedMatchesScalar()
+{
+	const BillboardType types[] = {
+		BBT_POINT, BBT_ORIENTED_COMMON, BBT_ORIENTED_SELF,
+		BBT_PERPENDICULAR_COMMON, BBT_PERPENDICULAR_SELF };
+	for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+	{
+		BillboardOptions options(types[t]);
+		for (int accurate = 0; accurate < 2; ++accurate)
+		{
+			options.accurateFacing = accurate != 0;
+			// all the default size, sharing their offsets, then some with their own
+			options.ownSizeEvery = 0;
+			compareWithScalar(mSceneMgr, mNode, mCamera, options, 300);
+			options.ownSizeEvery = 4;
+			compareWithScalar(mSceneMgr, mNode, mCamera, options, 300);
+		}
+	}
+}
+
+void BillboardSetTests::testRotatedKeepOrder()
+{
+	// rotated billboards take genVertices between staged batches
+	const BillboardType types[] = { BBT_POINT, BBT_ORIENTED_SELF };
+	for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+	{
+		BillboardOptions options(types[t]);
+		options.rotateEvery = 7;
+		compareWithScalar(mSceneMgr, mNode, mCamera, options, 300);
+		options.ownSizeEvery = 5;
+		compareWithScalar(mSceneMgr, mNode, mCamera, options, 300);
+	}
+}
+
+void BillboardSetTests::testParallelMatchesScalar()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("BillboardSetTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+	// use several threads even if the hardware doesn't have them
+	mSceneMgr->getParallelDispatcher()->setConcurrency(4);
+
+	// several 512 billboard chunks, with and without shared offsets, and with
+	// rotated billboards splitting the batches
+	const BillboardType types[] = { BBT_POINT, BBT_ORIENTED_SELF };
+	for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+	{
+		BillboardOptions options(types[t]);
+		options.parallel = true;
+		compareWithScalar(mSceneMgr, mNode, mCamera, options, 3000);
+		options.rotateEvery = 1100;
+		compareWithScalar(mSceneMgr, mNode, mCamera, options, 3000);
+	}
+}
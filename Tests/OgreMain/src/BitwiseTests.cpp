@@ -124,3 +124,12 @@ void BitwiseTests::testHalf()
     }
     */
 }
+
+void BitwiseTests::testCountBitsSet()
+{
+    CPPUNIT_ASSERT_EQUAL(0u, Bitwise::countBitsSet(0));
+    CPPUNIT_ASSERT_EQUAL(1u, Bitwise::countBitsSet(0x80000000));
+    CPPUNIT_ASSERT_EQUAL(32u, Bitwise::countBitsSet(0xFFFFFFFF));
+    CPPUNIT_ASSERT_EQUAL(16u, Bitwise::countBitsSet(0x5555AAAA));
+    CPPUNIT_ASSERT_EQUAL(13u, Bitwise::countBitsSet(0x12345678));
+}
@@ -29,10 +29,73 @@ THE SOFTWARE.
 #include "OgreDefaultHardwareBufferManager.h"
 #include "OgreVertexIndexData.h"
 #include "OgreEdgeListBuilder.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+#include <iostream>
 
 // Regsiter the suite
 CPPUNIT_TEST_SUITE_REGISTRATION( EdgeBuilderTests );
 
+namespace
+{
+    /** Fill in a grid of (strips * width + 1) by height positions, split into
+        strips with their own vertex buffers which share the positions along
+        their boundaries
+    */
+    void createGridStrips(VertexData* vd, IndexData* id, size_t strips, size_t width, size_t height)
+    {
+        for (size_t s = 0; s < strips; ++s)
+        {
+            vd[s].vertexCount = (width + 1) * height;
+            vd[s].vertexStart = 0;
+            vd[s].vertexDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+            vd[s].vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+            HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+                sizeof(float)*3, vd[s].vertexCount, HardwareBuffer::HBU_STATIC, true);
+            vd[s].vertexBufferBinding->setBinding(0, vbuf);
+            float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x <= width; ++x)
+                {
+                    *pFloat++ = (float)(s * width + x); *pFloat++ = (float)y; *pFloat++ = 0;
+                }
+            }
+            vbuf->unlock();
+
+            id[s].indexCount = width * (height - 1) * 6;
+            id[s].indexStart = 0;
+            id[s].indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                HardwareIndexBuffer::IT_32BIT, id[s].indexCount, HardwareBuffer::HBU_STATIC, true);
+            uint32* pIdx = static_cast<uint32*>(id[s].indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
+            for (size_t y = 0; y + 1 < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    uint32 v = (uint32)(y * (width + 1) + x);
+                    *pIdx++ = v; *pIdx++ = v + 1; *pIdx++ = v + (uint32)width + 1;
+                    *pIdx++ = v + 1; *pIdx++ = v + (uint32)width + 2; *pIdx++ = v + (uint32)width + 1;
+                }
+            }
+            id[s].indexBuffer->unlock();
+        }
+    }
+
+    EdgeData* buildGridStrips(VertexData* vd, IndexData* id, size_t strips,
+        ParallelTaskDispatcher* dispatcher)
+    {
+        EdgeListBuilder edgeBuilder;
+        edgeBuilder.setParallelDispatcher(dispatcher);
+        for (size_t s = 0; s < strips; ++s)
+        {
+            edgeBuilder.addVertexData(&vd[s]);
+            edgeBuilder.addIndexData(&id[s], s);
+        }
+        return edgeBuilder.build();
+    }
+}
+
 void EdgeBuilderTests::setUp()
 {
     mBufMgr = new DefaultHardwareBufferManager();
@@ -287,3 +350,177 @@ void EdgeBuilderTests::testMultiIndexBufMultiVertexBuf()
 
 
 }
+void EdgeBuilderTests::testParallelLargeMesh()
+{
+    /* This tests that building in parallel gives the same result, for a large
+    grid split into strips with their own vertex buffers, which share the
+    positions along their boundaries
+    */
+    const size_t strips = 8, width = 64, height = 128;
+    VertexData vd[strips];
+    IndexData id[strips];
+    createGridStrips(vd, id, strips, width, height);
+
+    DefaultWorkQueue workQueue("EdgeBuilderTests");
+    workQueue.setWorkerThreadCount(2);
+    workQueue.startup();
+    ParallelTaskDispatcher dispatcher("EdgeBuilderTests");
+    dispatcher.setWorkQueue(&workQueue);
+    dispatcher.setConcurrency(3);
+
+    EdgeData* edgeData[2];
+    for (size_t b = 0; b < 2; ++b)
+        edgeData[b] = buildGridStrips(vd, id, strips, b ? &dispatcher : 0);
+    dispatcher.setWorkQueue(0);
+    workQueue.shutdown();
+
+    // One grid of (strips * width + 1) by height positions
+    const size_t columns = strips * width;
+    const size_t triangles = columns * (height - 1) * 2;
+    const size_t edges = columns * height + (columns + 1) * (height - 1) + columns * (height - 1);
+    for (size_t b = 0; b < 2; ++b)
+    {
+        CPPUNIT_ASSERT_EQUAL(triangles, edgeData[b]->triangles.size());
+        CPPUNIT_ASSERT(!edgeData[b]->isClosed);
+        size_t edgeCount = 0, degenerateCount = 0;
+        for (size_t s = 0; s < strips; ++s)
+        {
+            const EdgeData::EdgeList& el = edgeData[b]->edgeGroups[s].edges;
+            edgeCount += el.size();
+            for (size_t e = 0; e < el.size(); ++e)
+                degenerateCount += el[e].degenerate ? 1 : 0;
+        }
+        CPPUNIT_ASSERT_EQUAL(edges, edgeCount);
+        CPPUNIT_ASSERT_EQUAL(2 * (columns + height - 1), degenerateCount);
+    }
+
+    // Identical either way
+    for (size_t t = 0; t < triangles; ++t)
+    {
+        const EdgeData::Triangle& t0 = edgeData[0]->triangles[t];
+        const EdgeData::Triangle& t1 = edgeData[1]->triangles[t];
+        CPPUNIT_ASSERT(t0.vertexSet == t1.vertexSet && t0.indexSet == t1.indexSet);
+        for (size_t i = 0; i < 3; ++i)
+        {
+            CPPUNIT_ASSERT(t0.vertIndex[i] == t1.vertIndex[i]);
+            CPPUNIT_ASSERT(t0.sharedVertIndex[i] == t1.sharedVertIndex[i]);
+        }
+        CPPUNIT_ASSERT(edgeData[0]->triangleFaceNormals[t] == edgeData[1]->triangleFaceNormals[t]);
+    }
+    for (size_t s = 0; s < strips; ++s)
+    {
+        const EdgeData::EdgeGroup& g0 = edgeData[0]->edgeGroups[s];
+        const EdgeData::EdgeGroup& g1 = edgeData[1]->edgeGroups[s];
+        CPPUNIT_ASSERT_EQUAL(g0.triStart, g1.triStart);
+        CPPUNIT_ASSERT_EQUAL(g0.triCount, g1.triCount);
+        CPPUNIT_ASSERT_EQUAL(g0.edges.size(), g1.edges.size());
+        for (size_t e = 0; e < g0.edges.size(); ++e)
+        {
+            CPPUNIT_ASSERT(g0.edges[e].triIndex[0] == g1.edges[e].triIndex[0]);
+            CPPUNIT_ASSERT(g0.edges[e].triIndex[1] == g1.edges[e].triIndex[1]);
+            CPPUNIT_ASSERT(g0.edges[e].vertIndex[0] == g1.edges[e].vertIndex[0]);
+            CPPUNIT_ASSERT(g0.edges[e].vertIndex[1] == g1.edges[e].vertIndex[1]);
+            CPPUNIT_ASSERT(g0.edges[e].sharedVertIndex[0] == g1.edges[e].sharedVertIndex[0]);
+            CPPUNIT_ASSERT(g0.edges[e].sharedVertIndex[1] == g1.edges[e].sharedVertIndex[1]);
+            CPPUNIT_ASSERT(g0.edges[e].degenerate == g1.edges[e].degenerate);
+        }
+    }
+
+    delete edgeData[0];
+    delete edgeData[1];
+}
+
+void EdgeBuilderTests::testBuildPerformance()
+{
+    // The same strips as testParallelLargeMesh, on a 524k triangle grid
+    const size_t strips = 8, width = 64, height = 512;
+    VertexData vd[strips];
+    IndexData id[strips];
+    createGridStrips(vd, id, strips, width, height);
+
+    DefaultWorkQueue workQueue("EdgeBuilderTests");
+    workQueue.setWorkerThreadCount(2);
+    workQueue.startup();
+    ParallelTaskDispatcher dispatcher("EdgeBuilderTests");
+    dispatcher.setWorkQueue(&workQueue);
+    dispatcher.setConcurrency(3);
+
+    EdgeData* edgeData[2];
+    unsigned long times[2];
+    Timer timer;
+    for (size_t b = 0; b < 2; ++b)
+    {
+        timer.reset();
+        edgeData[b] = buildGridStrips(vd, id, strips, b ? &dispatcher : 0);
+        times[b] = timer.getMicroseconds();
+    }
+    dispatcher.setWorkQueue(0);
+    workQueue.shutdown();
+
+    CPPUNIT_ASSERT_EQUAL(edgeData[0]->triangles.size(), edgeData[1]->triangles.size());
+    std::cout << "\nEdge list of " << edgeData[0]->triangles.size() << " triangles in " << strips
+        << " vertex sets: " << times[0] / 1000.0 << "ms serial, " << times[1] / 1000.0
+        << "ms parallel" << std::endl;
+
+    delete edgeData[0];
+    delete edgeData[1];
+}
+
+void EdgeBuilderTests::testLightFacing()
+{
+    // Pyramid, as in testSingleIndexBufSingleVertexBuf
+    VertexData vd;
+    IndexData id;
+    vd.vertexCount = 4;
+    vd.vertexStart = 0;
+    vd.vertexDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+    vd.vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(sizeof(float)*3, 4, HardwareBuffer::HBU_STATIC,true);
+    vd.vertexBufferBinding->setBinding(0, vbuf);
+    float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+    *pFloat++ = 0  ; *pFloat++ = 0  ; *pFloat++ = 0  ;
+    *pFloat++ = 50 ; *pFloat++ = 0  ; *pFloat++ = 0  ;
+    *pFloat++ = 0  ; *pFloat++ = 100; *pFloat++ = 0  ;
+    *pFloat++ = 0  ; *pFloat++ = 0  ; *pFloat++ = -50;
+    vbuf->unlock();
+
+    id.indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+        HardwareIndexBuffer::IT_16BIT, 12, HardwareBuffer::HBU_STATIC, true);
+    id.indexCount = 12;
+    id.indexStart = 0;
+    unsigned short* pIdx = static_cast<unsigned short*>(id.indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
+    *pIdx++ = 0; *pIdx++ = 1; *pIdx++ = 2;
+    *pIdx++ = 0; *pIdx++ = 2; *pIdx++ = 3;
+    *pIdx++ = 1; *pIdx++ = 3; *pIdx++ = 2;
+    *pIdx++ = 0; *pIdx++ = 3; *pIdx++ = 1;
+    id.indexBuffer->unlock();
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    // the per triangle states agree with the mask
+    edgeData->updateTriangleLightFacing(Vector4(100, 100, 100, 1));
+    CPPUNIT_ASSERT_EQUAL(edgeData->triangles.size(), edgeData->triangleLightFacings.size());
+    size_t numFacing = 0;
+    for (size_t i = 0; i < edgeData->triangles.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(edgeData->isTriangleLightFacing(i),
+            edgeData->triangleLightFacings[i] != 0);
+        if (edgeData->triangleLightFacings[i])
+            ++numFacing;
+    }
+    CPPUNIT_ASSERT(numFacing > 0 && numFacing < edgeData->triangles.size());
+
+    // a rebuilt edge list never has the same generation, even at the same address
+    uint32 generation = edgeData->generation;
+    delete edgeData;
+    EdgeListBuilder rebuilder;
+    rebuilder.addVertexData(&vd);
+    rebuilder.addIndexData(&id);
+    edgeData = rebuilder.build();
+    CPPUNIT_ASSERT(edgeData->generation != generation);
+
+    delete edgeData;
+}
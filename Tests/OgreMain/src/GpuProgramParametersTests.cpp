@@ -0,0 +1,173 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "GpuProgramParametersTests.h"
+#include "OgreGpuProgramParams.h"
+#include "OgreAutoParamDataSource.h"
+#include "OgreMatrix4.h"
+
+using namespace Ogre;
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( GpuProgramParametersTests );
+
+namespace
+{
+	/// Create a parameter set using logical indexes, like a low-level program
+	GpuProgramParametersSharedPtr createLogicalParams()
+	{
+		GpuProgramParametersSharedPtr params(OGRE_NEW GpuProgramParameters());
+		GpuLogicalBufferStructPtr floats(OGRE_NEW GpuLogicalBufferStruct());
+		GpuLogicalBufferStructPtr ints(OGRE_NEW GpuLogicalBufferStruct());
+		params->_setLogicalIndexes(floats, ints);
+		return params;
+	}
+}
+
+void GpuProgramParametersTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+}
+
+void GpuProgramParametersTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+void GpuProgramParametersTests::testDirtyVariability()
+{
+	GpuProgramParametersSharedPtr params = createLogicalParams();
+	int intVals[4] = {5, 6, 7, 8};
+	params->setConstant(0, Vector4(1, 2, 3, 4));
+	params->setConstant(1, intVals, 1);
+	CPPUNIT_ASSERT(params->getDirtyVariability() != 0);
+
+	params->_markClean();
+	CPPUNIT_ASSERT_EQUAL((uint16)0, params->getDirtyVariability());
+
+	// Writing the same values again doesn't dirty anything
+	params->setConstant(0, Vector4(1, 2, 3, 4));
+	params->setConstant(1, intVals, 1);
+	CPPUNIT_ASSERT_EQUAL((uint16)0, params->getDirtyVariability());
+
+	// Manual writes dirty every class
+	params->setConstant(0, Vector4(1, 2, 3, 5));
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_ALL, params->getDirtyVariability());
+	params->_markClean();
+	intVals[0] = 9;
+	params->setConstant(1, intVals, 1);
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_ALL, params->getDirtyVariability());
+
+	// Only the classes given are cleaned
+	params->_markClean(GPV_GLOBAL);
+	CPPUNIT_ASSERT_EQUAL((uint16)(GPV_ALL & ~GPV_GLOBAL), params->getDirtyVariability());
+}
+
+void GpuProgramParametersTests::testAutoConstantDirtyVariability()
+{
+	GpuProgramParametersSharedPtr params = createLogicalParams();
+	params->setAutoConstant(0, GpuProgramParameters::ACT_WORLD_MATRIX);
+	params->setAutoConstant(4, GpuProgramParameters::ACT_LIGHT_COUNT);
+
+	AutoParamDataSource source;
+	Matrix4 world = Matrix4::getTrans(1, 2, 3);
+	source.setWorldMatrices(&world, 1);
+	LightList lights;
+	source.setCurrentLightList(&lights);
+
+	params->_updateAutoParams(&source, GPV_ALL);
+	params->_markClean();
+
+	// Same world matrix for the next object
+	params->_updateAutoParams(&source, GPV_PER_OBJECT);
+	CPPUNIT_ASSERT_EQUAL((uint16)0, params->getDirtyVariability());
+
+	// A new world matrix only dirties the per object class
+	Matrix4 world2 = Matrix4::getTrans(4, 5, 6);
+	source.setWorldMatrices(&world2, 1);
+	params->_updateAutoParams(&source, GPV_PER_OBJECT | GPV_LIGHTS);
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_PER_OBJECT, params->getDirtyVariability());
+
+	// Manual writes after an update are still attributed to every class
+	params->_markClean();
+	params->setConstant(8, Vector4(1, 1, 1, 1));
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_ALL, params->getDirtyVariability());
+}
+
+void GpuProgramParametersTests::testSharedParametersCopiedOnChange()
+{
+	GpuSharedParametersPtr shared(OGRE_NEW GpuSharedParameters("shared"));
+	shared->addConstantDefinition("ambient", GCT_FLOAT4);
+	shared->setNamedConstant("ambient", Vector4(0.5, 0.5, 0.5, 1));
+
+	GpuNamedConstantsPtr named(OGRE_NEW GpuNamedConstants());
+	GpuConstantDefinition def;
+	def.constType = GCT_FLOAT4;
+	def.elementSize = 4;
+	def.arraySize = 1;
+	def.physicalIndex = 0;
+	def.logicalIndex = 0;
+	def.variability = GPV_GLOBAL;
+	named->map["ambient"] = def;
+	named->floatBufferSize = 4;
+
+	GpuProgramParametersSharedPtr params(OGRE_NEW GpuProgramParameters());
+	params->_setNamedConstants(named);
+	params->addSharedParameters(shared);
+	params->_markClean();
+
+	params->_copySharedParams();
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_GLOBAL, params->getDirtyVariability());
+	CPPUNIT_ASSERT_EQUAL(0.5f, *params->getFloatPointer(0));
+	params->_markClean();
+
+	// Nothing changed in the shared set, no copy
+	params->_copySharedParams();
+	CPPUNIT_ASSERT_EQUAL((uint16)0, params->getDirtyVariability());
+
+	shared->setNamedConstant("ambient", Vector4(0.25, 0.5, 0.5, 1));
+	params->_copySharedParams();
+	CPPUNIT_ASSERT_EQUAL((uint16)GPV_GLOBAL, params->getDirtyVariability());
+	CPPUNIT_ASSERT_EQUAL(0.25f, *params->getFloatPointer(0));
+}
+
+void GpuProgramParametersTests::testCalculateConstantBytes()
+{
+	GpuProgramParametersSharedPtr params = createLogicalParams();
+	params->setAutoConstant(0, GpuProgramParameters::ACT_WORLDVIEWPROJ_MATRIX);
+	params->setAutoConstant(4, GpuProgramParameters::ACT_LIGHT_POSITION, 0);
+	params->setConstant(5, Vector4::ZERO);
+	int intVals[4] = {1, 2, 3, 4};
+	params->setConstant(0, intVals, 1);
+
+	CPPUNIT_ASSERT_EQUAL(size_t(16 * sizeof(float)), params->calculateConstantBytes(GPV_PER_OBJECT));
+	CPPUNIT_ASSERT_EQUAL(size_t(4 * sizeof(float)), params->calculateConstantBytes(GPV_LIGHTS));
+	CPPUNIT_ASSERT_EQUAL(size_t(4 * sizeof(float) + 4 * sizeof(int)), 
+		params->calculateConstantBytes(GPV_GLOBAL));
+	CPPUNIT_ASSERT_EQUAL(size_t(24 * sizeof(float) + 4 * sizeof(int)), 
+		params->calculateConstantBytes(GPV_ALL));
+}
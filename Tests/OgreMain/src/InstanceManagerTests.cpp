@@ -0,0 +1,338 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "InstanceManagerTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreInstanceManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreSubMesh.h"
+#include "OgreTimer.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( InstanceManagerTests );
+
+namespace
+{
+	typedef InstanceManager::InstancedEntity InstancedEntity;
+	typedef InstanceManager::InstanceBatch InstanceBatch;
+	typedef vector<InstanceBatch*>::type BatchList;
+
+	/// A unit quad with positions, normals and texture coordinates
+	void createQuadMesh(const String& name)
+	{
+		MeshPtr mesh = MeshManager::getSingleton().createManual(name,
+			ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		SubMesh* sub = mesh->createSubMesh();
+		sub->useSharedVertices = false;
+		sub->vertexData = OGRE_NEW VertexData();
+		sub->vertexData->vertexCount = 4;
+		VertexDeclaration* decl = sub->vertexData->vertexDeclaration;
+		decl->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+		decl->addElement(0, 12, VET_FLOAT3, VES_NORMAL);
+		decl->addElement(0, 24, VET_FLOAT2, VES_TEXTURE_COORDINATES);
+		HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton()
+			.createVertexBuffer(32, 4, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		float vertices[] = {
+			-1, -1, 0, 0, 0, 1, 0, 0,
+			1, -1, 0, 0, 0, 1, 1, 0,
+			1, 1, 0, 0, 0, 1, 1, 1,
+			-1, 1, 0, 0, 0, 1, 0, 1 };
+		vbuf->writeData(0, sizeof(vertices), vertices);
+		sub->vertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+		uint16 indexes[] = { 0, 1, 2, 0, 2, 3 };
+		sub->indexData->indexCount = 6;
+		sub->indexData->indexBuffer = HardwareBufferManager::getSingleton()
+			.createIndexBuffer(HardwareIndexBuffer::IT_16BIT, 6, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		sub->indexData->indexBuffer->writeData(0, sizeof(indexes), indexes);
+
+		mesh->_setBounds(AxisAlignedBox(-1, -1, 0, 1, 1, 0));
+		mesh->_setBoundingSphereRadius(Math::Sqrt(2));
+		mesh->load();
+	}
+
+	BatchList getBatches(InstanceManager* mgr)
+	{
+		BatchList batches;
+		InstanceManager::InstanceBatchMapIterator it = mgr->getInstanceBatchMapIterator();
+		while (it.hasMoreElements())
+		{
+			const InstanceManager::InstanceBatchList& list = it.getNext();
+			batches.insert(batches.end(), list.begin(), list.end());
+		}
+		return batches;
+	}
+
+	/// The bounding sphere culling should use for an instance
+	Sphere getInstanceSphere(const InstancedEntity* instance)
+	{
+		// the mesh's bounds are padded, so the radius isn't just that of the quad
+		const AxisAlignedBox& bounds =
+			instance->getBatch()->getInstanceManager()->getMesh()->getBounds();
+		const Vector3& scale = instance->getScale();
+		return Sphere(instance->getPosition(), bounds.getHalfSize().length() *
+			std::max(std::max(scale.x, scale.y), scale.z));
+	}
+
+	/// Scatter instances around in front of the camera, crossing its planes
+	void scatterInstances(InstanceManager* mgr, size_t count, uint32 seed,
+		vector<InstancedEntity*>::type& instances)
+	{
+		TestRandom rnd(seed);
+		for (size_t i = 0; i < count; ++i)
+		{
+			InstancedEntity* instance = mgr->createInstancedEntity("InstanceTest");
+			instance->setTransform(
+				Vector3(rnd.next(-150, 150), rnd.next(-150, 150), rnd.next(-250, 50)),
+				Quaternion(Radian(rnd.next(0, Math::TWO_PI)), Vector3::UNIT_Y),
+				Vector3(rnd.next(0.5f, 10), rnd.next(0.5f, 10), 1));
+			instances.push_back(instance);
+		}
+	}
+}
+
+void InstanceManagerTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+	mBufMgr = new DefaultHardwareBufferManager();
+	createQuadMesh("InstanceTestQuad");
+	MaterialManager::getSingleton().create("InstanceTest",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	// not registered with the scene manager, which needs a render system
+	// to destroy it
+	mCamera = OGRE_NEW Camera("InstanceTest", mSceneMgr);
+	mCamera->setNearClipDistance(1);
+	mCamera->setFarClipDistance(200);
+}
+void InstanceManagerTests::tearDown()
+{
+	OGRE_DELETE mCamera;
+	mRoot->destroySceneManager(mSceneMgr);
+	MeshManager::getSingleton().removeAll();
+	delete mBufMgr;
+	OGRE_DELETE mRoot;
+}
+
+void InstanceManagerTests::testBatchesStayDense()
+{
+	InstanceManager* mgr = mSceneMgr->createInstanceManager("Dense",
+		"InstanceTestQuad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, 16);
+	vector<InstancedEntity*>::type instances;
+	scatterInstances(mgr, 100, 7, instances);
+	CPPUNIT_ASSERT_EQUAL((size_t)100, mgr->getNumInstancedEntities());
+	CPPUNIT_ASSERT_EQUAL((size_t)7, getBatches(mgr).size());
+
+	// remove every third instance, and check the moved ones kept their place
+	for (size_t i = 0; i < instances.size(); i += 3)
+	{
+		mgr->destroyInstancedEntity(instances[i]);
+		instances[i] = 0;
+	}
+	size_t total = 0;
+	BatchList batches = getBatches(mgr);
+	for (BatchList::iterator b = batches.begin(); b != batches.end(); ++b)
+	{
+		const InstanceBatch::InstancedEntityList& list = (*b)->getInstances();
+		for (size_t i = 0; i < list.size(); ++i)
+		{
+			CPPUNIT_ASSERT_EQUAL(i, list[i]->_getIndex());
+			CPPUNIT_ASSERT(list[i]->getBatch() == *b);
+		}
+		total += list.size();
+	}
+	CPPUNIT_ASSERT_EQUAL((size_t)66, total);
+	CPPUNIT_ASSERT_EQUAL(total, mgr->getNumInstancedEntities());
+
+	// new instances fill the holes before any more batches are made
+	scatterInstances(mgr, 46, 11, instances);
+	CPPUNIT_ASSERT_EQUAL((size_t)7, getBatches(mgr).size());
+	scatterInstances(mgr, 1, 13, instances);
+	CPPUNIT_ASSERT_EQUAL((size_t)8, getBatches(mgr).size());
+
+	// empty batches can be tidied up
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		if (instances[i] && instances[i]->getBatch() == batches[0])
+			mgr->destroyInstancedEntity(instances[i]);
+	}
+	mgr->cleanupEmptyBatches();
+	CPPUNIT_ASSERT_EQUAL((size_t)7, getBatches(mgr).size());
+	CPPUNIT_ASSERT_EQUAL((size_t)97, mgr->getNumInstancedEntities());
+
+	mSceneMgr->destroyInstanceManager(mgr);
+	CPPUNIT_ASSERT(!mSceneMgr->hasInstanceManager("Dense"));
+}
+
+void InstanceManagerTests::testInstanceStream()
+{
+	InstanceManager* mgr = mSceneMgr->createInstanceManager("Stream",
+		"InstanceTestQuad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, 64);
+	CPPUNIT_ASSERT_EQUAL((unsigned short)1, mgr->getInstanceTexCoordIndex());
+	InstancedEntity* instance = mgr->createInstancedEntity("InstanceTest");
+	instance->setPosition(Vector3(0, 0, -50));
+
+	InstanceBatch* batch = instance->getBatch();
+	RenderOperation op;
+	batch->getRenderOperation(op);
+
+	// the mesh's buffer is shared, the instance stream is added to it
+	SubMesh* sub = mgr->getSubMesh();
+	VertexBufferBinding* binds = op.vertexData->vertexBufferBinding;
+	CPPUNIT_ASSERT_EQUAL((size_t)2, binds->getBufferCount());
+	CPPUNIT_ASSERT(binds->getBuffer(0) == sub->vertexData->vertexBufferBinding->getBuffer(0));
+	CPPUNIT_ASSERT(op.indexData == sub->indexData);
+	HardwareVertexBufferSharedPtr instanceBuf = binds->getBuffer(1);
+	CPPUNIT_ASSERT(instanceBuf->getIsInstanceData());
+	CPPUNIT_ASSERT_EQUAL((size_t)64, instanceBuf->getNumVertices());
+	for (unsigned short row = 0; row < 3; ++row)
+	{
+		const VertexElement* elem = op.vertexData->vertexDeclaration->findElementBySemantic(
+			VES_TEXTURE_COORDINATES, 1 + row);
+		CPPUNIT_ASSERT(elem);
+		CPPUNIT_ASSERT_EQUAL((unsigned short)1, elem->getSource());
+		CPPUNIT_ASSERT_EQUAL(VET_FLOAT4, elem->getType());
+	}
+
+	// nothing is packed until the batch is culled
+	CPPUNIT_ASSERT_EQUAL((size_t)0, op.numberOfInstances);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, batch->_cullAndPackInstances(mCamera));
+	batch->getRenderOperation(op);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, op.numberOfInstances);
+
+	// the batch's bounds follow the instances
+	instance->setPosition(Vector3(10, 0, 0));
+	CPPUNIT_ASSERT(batch->getBoundingBox().contains(Vector3(10, 0, 0)));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, batch->_cullAndPackInstances(mCamera));
+
+	instance->setPosition(Vector3(0, 0, -50));
+	instance->setVisible(false);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, batch->_cullAndPackInstances(mCamera));
+}
+
+void InstanceManagerTests::testCullAndPack()
+{
+	InstanceManager* mgr = mSceneMgr->createInstanceManager("Cull",
+		"InstanceTestQuad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, 100);
+	vector<InstancedEntity*>::type instances;
+	scatterInstances(mgr, 1000, 5, instances);
+	// drop some, so the culling works on moved instances
+	for (size_t i = 0; i < instances.size(); i += 7)
+	{
+		mgr->destroyInstancedEntity(instances[i]);
+	}
+
+	size_t totalVisible = 0;
+	BatchList batches = getBatches(mgr);
+	for (BatchList::iterator b = batches.begin(); b != batches.end(); ++b)
+	{
+		InstanceBatch* batch = *b;
+		size_t visible = batch->_cullAndPackInstances(mCamera);
+		CPPUNIT_ASSERT_EQUAL(visible, batch->getNumVisibleInstances());
+
+		// the visible instances are packed in the order the batch holds them
+		RenderOperation op;
+		batch->getRenderOperation(op);
+		HardwareVertexBufferSharedPtr buf = op.vertexData->vertexBufferBinding->getBuffer(1);
+		const float* pRows = static_cast<const float*>(buf->lock(HardwareBuffer::HBL_READ_ONLY));
+		size_t packed = 0;
+		const InstanceBatch::InstancedEntityList& list = batch->getInstances();
+		for (size_t i = 0; i < list.size(); ++i)
+		{
+			Matrix4 xform;
+			xform.makeTransform(list[i]->getPosition(), list[i]->getScale(), list[i]->getOrientation());
+			if (!mCamera->isVisible(getInstanceSphere(list[i])))
+				continue;
+			for (size_t r = 0; r < 3; ++r)
+				for (size_t c = 0; c < 4; ++c)
+					CPPUNIT_ASSERT_DOUBLES_EQUAL(xform[r][c], pRows[packed * 12 + r * 4 + c], 1e-4);
+			++packed;
+		}
+		buf->unlock();
+		CPPUNIT_ASSERT_EQUAL(visible, packed);
+		totalVisible += visible;
+	}
+	CPPUNIT_ASSERT(totalVisible > 0 && totalVisible < mgr->getNumInstancedEntities());
+}
+
+void InstanceManagerTests::testCullingPerformance()
+{
+	const size_t count = 20000;
+	InstanceManager* mgr = mSceneMgr->createInstanceManager("Performance",
+		"InstanceTestQuad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, 1000);
+	vector<InstancedEntity*>::type instances;
+	scatterInstances(mgr, count, 9, instances);
+	BatchList batches = getBatches(mgr);
+
+	const int iterations = 20;
+	Timer timer;
+	unsigned long start = timer.getMicroseconds();
+	size_t visibleBatched = 0;
+	for (int it = 0; it < iterations; ++it)
+	{
+		for (BatchList::iterator b = batches.begin(); b != batches.end(); ++b)
+			visibleBatched += (*b)->_cullAndPackInstances(mCamera);
+	}
+	unsigned long batched = timer.getMicroseconds() - start;
+
+	// what it would cost to test and transform each one on its own
+	vector<float>::type rows(count * 12);
+	start = timer.getMicroseconds();
+	size_t visibleEach = 0;
+	for (int it = 0; it < iterations; ++it)
+	{
+		float* pDest = &rows[0];
+		for (size_t i = 0; i < count; ++i)
+		{
+			const InstancedEntity* instance = instances[i];
+			if (mCamera->isVisible(getInstanceSphere(instance)))
+			{
+				Matrix4 xform;
+				xform.makeTransform(instance->getPosition(), instance->getScale(),
+					instance->getOrientation());
+				for (size_t r = 0; r < 3; ++r)
+					for (size_t c = 0; c < 4; ++c)
+						*pDest++ = xform[r][c];
+				++visibleEach;
+			}
+		}
+	}
+	unsigned long each = timer.getMicroseconds() - start;
+
+	CPPUNIT_ASSERT_EQUAL(visibleEach, visibleBatched);
+	std::cout << std::endl << "Instance culling and packing, ns per instance: "
+		<< (batched * 1000.0) / (count * iterations) << " batched, "
+		<< (each * 1000.0) / (count * iterations) << " one at a time" << std::endl;
+}
@@ -0,0 +1,345 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshOptimiserTests.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshManager.h"
+#include "OgreMeshOptimiser.h"
+#include "OgreSubMesh.h"
+#include "OgrePose.h"
+
+using namespace Ogre;
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( MeshOptimiserTests );
+
+namespace
+{
+	typedef vector<uint32>::type IndexList;
+	/// Corners of a triangle by original vertex number, rotated so the first is lowest
+	typedef std::pair<uint32, std::pair<uint32, uint32> > TriangleKey;
+	typedef vector<TriangleKey>::type TriangleList;
+
+	/// Deterministic shuffle
+	void shuffle(IndexList& list, uint32 seed)
+	{
+		for (size_t i = list.size(); i > 1; --i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			std::swap(list[i - 1], list[(seed >> 8) % i]);
+		}
+	}
+
+	IndexList readIndexes(const IndexData* indexData)
+	{
+		IndexList indexes(indexData->indexCount);
+		HardwareIndexBufferSharedPtr ibuf = indexData->indexBuffer;
+		void* p = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
+		for (size_t i = 0; i < indexes.size(); ++i)
+		{
+			indexes[i] = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ?
+				static_cast<uint32*>(p)[indexData->indexStart + i] :
+				static_cast<uint16*>(p)[indexData->indexStart + i];
+		}
+		ibuf->unlock();
+		return indexes;
+	}
+
+	/// Original vertex number of each vertex
+	IndexList readVertexIds(const VertexData* vertexData)
+	{
+		const VertexElement* elem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_TEXTURE_COORDINATES);
+		HardwareVertexBufferSharedPtr vbuf = vertexData->vertexBufferBinding->getBuffer(elem->getSource());
+		IndexList ids(vertexData->vertexCount);
+		uchar* vertex = static_cast<uchar*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+		float* pFloat;
+		for (size_t v = 0; v < ids.size(); ++v, vertex += vbuf->getVertexSize())
+		{
+			elem->baseVertexPointerToElement(vertex, &pFloat);
+			ids[v] = (uint32)*pFloat;
+		}
+		vbuf->unlock();
+		return ids;
+	}
+
+	/// The triangles of a mesh in terms of original vertex numbers, sorted
+	TriangleList getTriangles(const MeshPtr& mesh)
+	{
+		TriangleList triangles;
+		for (unsigned short s = 0; s < mesh->getNumSubMeshes(); ++s)
+		{
+			SubMesh* sub = mesh->getSubMesh(s);
+			IndexList ids = readVertexIds(sub->useSharedVertices ? mesh->sharedVertexData : sub->vertexData);
+			IndexList indexes = readIndexes(sub->indexData);
+			for (size_t i = 0; i < indexes.size(); i += 3)
+			{
+				uint32 a = ids[indexes[i]], b = ids[indexes[i + 1]], c = ids[indexes[i + 2]];
+				// keep the winding
+				while (a > b || a > c)
+				{
+					uint32 t = a; a = b; b = c; c = t;
+				}
+				triangles.push_back(TriangleKey(a, std::make_pair(b, c)));
+			}
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
+
+void MeshOptimiserTests::setUp()
+{
+	mResourceGroupMgr = new ResourceGroupManager();
+	mLodStrategyMgr = new LodStrategyManager();
+	mBufMgr = new DefaultHardwareBufferManager();
+	mMeshMgr = new MeshManager();
+}
+
+void MeshOptimiserTests::tearDown()
+{
+	delete mMeshMgr;
+	delete mBufMgr;
+	delete mLodStrategyMgr;
+	delete mResourceGroupMgr;
+}
+
+MeshPtr MeshOptimiserTests::createGrid(const String& name, size_t size, size_t submeshes, bool shared)
+{
+	MeshPtr mesh = mMeshMgr->createManual(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+	// Vertex v of the grid is stored at position slot[v]
+	const size_t vertexCount = size * size;
+	IndexList slot(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+		slot[v] = (uint32)v;
+	shuffle(slot, 12345);
+
+	IndexList triangles;
+	for (size_t y = 0; y + 1 < size; ++y)
+	{
+		for (size_t x = 0; x + 1 < size; ++x)
+		{
+			uint32 v = (uint32)(y * size + x);
+			triangles.push_back(v);
+			triangles.push_back(v + 1);
+			triangles.push_back(v + (uint32)size);
+			triangles.push_back(v + 1);
+			triangles.push_back(v + (uint32)size + 1);
+			triangles.push_back(v + (uint32)size);
+		}
+	}
+	IndexList order(triangles.size() / 3);
+	for (size_t t = 0; t < order.size(); ++t)
+		order[t] = (uint32)t;
+	shuffle(order, 54321);
+
+	VertexData* vertexData = 0;
+	for (size_t s = 0; s < submeshes; ++s)
+	{
+		SubMesh* sub = mesh->createSubMesh();
+		sub->useSharedVertices = shared;
+		if (!vertexData || !shared)
+		{
+			vertexData = OGRE_NEW VertexData();
+			vertexData->vertexCount = vertexCount;
+			VertexDeclaration* decl = vertexData->vertexDeclaration;
+			decl->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+			decl->addElement(1, 0, VET_FLOAT1, VES_TEXTURE_COORDINATES);
+
+			HardwareVertexBufferSharedPtr pbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+				decl->getVertexSize(0), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+			HardwareVertexBufferSharedPtr tbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+				decl->getVertexSize(1), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+			float* pPos = static_cast<float*>(pbuf->lock(HardwareBuffer::HBL_DISCARD));
+			float* pTex = static_cast<float*>(tbuf->lock(HardwareBuffer::HBL_DISCARD));
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				pPos[slot[v] * 3] = (float)(v % size);
+				pPos[slot[v] * 3 + 1] = (float)(v / size);
+				pPos[slot[v] * 3 + 2] = 0;
+				pTex[slot[v]] = (float)v;
+			}
+			pbuf->unlock();
+			tbuf->unlock();
+			vertexData->vertexBufferBinding->setBinding(0, pbuf);
+			vertexData->vertexBufferBinding->setBinding(1, tbuf);
+
+			if (shared)
+				mesh->sharedVertexData = vertexData;
+			else
+				sub->vertexData = vertexData;
+		}
+
+		// Every submesh gets an equal share of the triangles
+		size_t begin = order.size() * s / submeshes;
+		size_t end = order.size() * (s + 1) / submeshes;
+		HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
+			HardwareIndexBuffer::IT_16BIT, (end - begin) * 3, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		uint16* pIdx = static_cast<uint16*>(ibuf->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t t = begin; t < end; ++t)
+		{
+			for (size_t k = 0; k < 3; ++k)
+				*pIdx++ = (uint16)slot[triangles[order[t] * 3 + k]];
+		}
+		ibuf->unlock();
+		sub->indexData->indexBuffer = ibuf;
+		sub->indexData->indexCount = (end - begin) * 3;
+	}
+	mesh->_setBounds(AxisAlignedBox(0, 0, 0, (Real)size, (Real)size, 0));
+	return mesh;
+}
+
+void MeshOptimiserTests::testCacheMissesReduced()
+{
+	MeshPtr mesh = createGrid("Grid", 64, 1, false);
+	IndexData* indexData = mesh->getSubMesh(0)->indexData;
+	const size_t triangleCount = indexData->indexCount / 3;
+	size_t before = MeshOptimiser::countCacheMisses(indexData);
+
+	MeshOptimiser optimiser;
+	optimiser.optimise(mesh.get());
+	size_t after = MeshOptimiser::countCacheMisses(indexData);
+
+	const MeshOptimiser::Statistics& stats = optimiser.getStatistics();
+	CPPUNIT_ASSERT_EQUAL(triangleCount, stats.triangleCount);
+	CPPUNIT_ASSERT_EQUAL(before, stats.cacheMissesBefore);
+	CPPUNIT_ASSERT_EQUAL(after, stats.cacheMissesAfter);
+
+	// Random order transforms almost every corner; a grid can get close to
+	// one vertex per two triangles
+	CPPUNIT_ASSERT(stats.getACMRBefore() > 2.5f);
+	CPPUNIT_ASSERT(stats.getACMRAfter() < 0.8f);
+
+	// Sorting for overdraw costs no more than the threshold allows
+	MeshPtr unsorted = createGrid("Unsorted", 64, 1, false);
+	MeshOptimiser cacheOnly;
+	cacheOnly.setOptimiseOverdraw(false);
+	cacheOnly.optimise(unsorted.get());
+	Real cacheOnlyACMR = cacheOnly.getStatistics().getACMRAfter();
+	CPPUNIT_ASSERT(stats.getACMRAfter() <= cacheOnlyACMR * optimiser.getOverdrawThreshold() + 0.01f);
+}
+
+void MeshOptimiserTests::testTrianglesPreserved()
+{
+	MeshPtr mesh = createGrid("Grid", 40, 2, false);
+	TriangleList before = getTriangles(mesh);
+
+	MeshOptimiser optimiser;
+	optimiser.optimise(mesh.get());
+	CPPUNIT_ASSERT(before == getTriangles(mesh));
+
+	// Positions moved with the rest of the vertex
+	for (unsigned short s = 0; s < mesh->getNumSubMeshes(); ++s)
+	{
+		VertexData* vertexData = mesh->getSubMesh(s)->vertexData;
+		IndexList ids = readVertexIds(vertexData);
+		HardwareVertexBufferSharedPtr pbuf = vertexData->vertexBufferBinding->getBuffer(0);
+		float* pPos = static_cast<float*>(pbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+		for (size_t v = 0; v < ids.size(); ++v)
+		{
+			CPPUNIT_ASSERT_EQUAL((float)(ids[v] % 40), pPos[v * 3]);
+			CPPUNIT_ASSERT_EQUAL((float)(ids[v] / 40), pPos[v * 3 + 1]);
+		}
+		pbuf->unlock();
+	}
+}
+
+void MeshOptimiserTests::testVerticesInFirstUseOrder()
+{
+	MeshPtr mesh = createGrid("Grid", 32, 1, false);
+	MeshOptimiser optimiser;
+	optimiser.optimise(mesh.get());
+
+	IndexList indexes = readIndexes(mesh->getSubMesh(0)->indexData);
+	uint32 next = 0;
+	for (size_t i = 0; i < indexes.size(); ++i)
+	{
+		CPPUNIT_ASSERT(indexes[i] <= next);
+		if (indexes[i] == next)
+			++next;
+	}
+	CPPUNIT_ASSERT_EQUAL((uint32)(32 * 32), next);
+
+	// Left alone when disabled
+	MeshPtr unordered = createGrid("Unordered", 32, 1, false);
+	IndexList idsBefore = readVertexIds(unordered->getSubMesh(0)->vertexData);
+	optimiser.setReorderVertices(false);
+	optimiser.optimise(unordered.get());
+	CPPUNIT_ASSERT(idsBefore == readVertexIds(unordered->getSubMesh(0)->vertexData));
+}
+
+void MeshOptimiserTests::testSharedVertexData()
+{
+	MeshPtr mesh = createGrid("Grid", 32, 3, true);
+	IndexList ids = readVertexIds(mesh->sharedVertexData);
+	for (size_t v = 0; v < ids.size(); ++v)
+	{
+		VertexBoneAssignment vba;
+		vba.vertexIndex = (unsigned int)v;
+		vba.boneIndex = (unsigned short)(ids[v] % 7);
+		vba.weight = 1;
+		mesh->addBoneAssignment(vba);
+	}
+	Pose* pose = mesh->createPose(0, "pose");
+	for (size_t v = 0; v < ids.size(); v += 5)
+		pose->addVertex(v, Vector3((Real)ids[v], 0, 0));
+	TriangleList before = getTriangles(mesh);
+
+	MeshOptimiser optimiser;
+	optimiser.optimise(mesh.get());
+	CPPUNIT_ASSERT(before == getTriangles(mesh));
+
+	// The submeshes use the vertices in turn
+	uint32 next = 0;
+	for (unsigned short s = 0; s < mesh->getNumSubMeshes(); ++s)
+	{
+		IndexList indexes = readIndexes(mesh->getSubMesh(s)->indexData);
+		for (size_t i = 0; i < indexes.size(); ++i)
+		{
+			CPPUNIT_ASSERT(indexes[i] <= next);
+			if (indexes[i] == next)
+				++next;
+		}
+	}
+
+	// Data referring to vertices by index was remapped
+	ids = readVertexIds(mesh->sharedVertexData);
+	const Mesh::VertexBoneAssignmentList& assignments = mesh->getBoneAssignments();
+	CPPUNIT_ASSERT_EQUAL(ids.size(), assignments.size());
+	for (Mesh::VertexBoneAssignmentList::const_iterator i = assignments.begin(); i != assignments.end(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL((unsigned short)(ids[i->second.vertexIndex] % 7), i->second.boneIndex);
+	}
+	const Pose::VertexOffsetMap& offsets = pose->getVertexOffsets();
+	CPPUNIT_ASSERT_EQUAL((ids.size() + 4) / 5, offsets.size());
+	for (Pose::VertexOffsetMap::const_iterator i = offsets.begin(); i != offsets.end(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL((Real)ids[i->first], i->second.x);
+	}
+}
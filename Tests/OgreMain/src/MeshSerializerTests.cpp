@@ -0,0 +1,297 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshSerializerTests.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreLodStrategyManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreArchiveManager.h"
+#include "OgreFileSystem.h"
+#include "OgreMeshManager.h"
+#include "OgreMeshSerializer.h"
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreTimer.h"
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+
+using namespace Ogre;
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( MeshSerializerTests );
+
+namespace
+{
+	/// Vertex layout of the test meshes: position, normal, uv
+	const size_t VERTEX_FLOATS = 8;
+
+	float vertexValue(size_t submesh, size_t i)
+	{
+		return (float)((i * 31 + submesh * 7) % 1000) * 0.5f;
+	}
+
+	size_t indexValue(size_t submesh, size_t i, size_t vertexCount)
+	{
+		return (i * 7 + submesh) % vertexCount;
+	}
+
+	/// Compare the contents of a loaded submesh with what createMesh wrote
+	void checkSubMesh(SubMesh* sub, size_t submesh, size_t vertexCount)
+	{
+		CPPUNIT_ASSERT_EQUAL(vertexCount, sub->vertexData->vertexCount);
+		HardwareVertexBufferSharedPtr vbuf = sub->vertexData->vertexBufferBinding->getBuffer(0);
+		const float* pFloat = static_cast<const float*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+		for (size_t i = 0; i < vertexCount * VERTEX_FLOATS; ++i)
+		{
+			CPPUNIT_ASSERT_EQUAL(vertexValue(submesh, i), pFloat[i]);
+		}
+		vbuf->unlock();
+
+		HardwareIndexBufferSharedPtr ibuf = sub->indexData->indexBuffer;
+		CPPUNIT_ASSERT_EQUAL(vertexCount, sub->indexData->indexCount);
+		void* pIdx = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			size_t index = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ?
+				static_cast<uint32*>(pIdx)[i] : static_cast<uint16*>(pIdx)[i];
+			CPPUNIT_ASSERT_EQUAL(indexValue(submesh, i, vertexCount), index);
+		}
+		ibuf->unlock();
+	}
+
+	/// Whether the buffers of a mesh use the memory of a stream in place
+	bool usesStreamMemory(const MeshPtr& mesh, MemoryDataStream* stream)
+	{
+		const uchar* begin = stream->getPtr();
+		const uchar* end = begin + stream->size();
+		for (unsigned short s = 0; s < mesh->getNumSubMeshes(); ++s)
+		{
+			SubMesh* sub = mesh->getSubMesh(s);
+			HardwareVertexBufferSharedPtr vbuf = sub->vertexData->vertexBufferBinding->getBuffer(0);
+			const uchar* pVert = static_cast<const uchar*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+			vbuf->unlock();
+			const uchar* pIdx = static_cast<const uchar*>(
+				sub->indexData->indexBuffer->lock(HardwareBuffer::HBL_READ_ONLY));
+			sub->indexData->indexBuffer->unlock();
+			if (pVert < begin || pVert >= end || pIdx < begin || pIdx >= end)
+				return false;
+		}
+		return true;
+	}
+}
+
+void MeshSerializerTests::setUp()
+{
+	mResourceGroupMgr = new ResourceGroupManager();
+	mLodStrategyMgr = new LodStrategyManager();
+	mBufMgr = new DefaultHardwareBufferManager();
+	mMeshMgr = new MeshManager();
+	mArchiveMgr = new ArchiveManager();
+	mArchiveFactory = new FileSystemArchiveFactory();
+	mArchiveMgr->addArchiveFactory(mArchiveFactory);
+}
+
+void MeshSerializerTests::tearDown()
+{
+	FileSystemArchive::setUseMemoryMapping(false);
+	delete mMeshMgr;
+	delete mBufMgr;
+	delete mArchiveMgr;
+	delete mArchiveFactory;
+	delete mLodStrategyMgr;
+	delete mResourceGroupMgr;
+}
+
+MeshPtr MeshSerializerTests::createMesh(const String& name, size_t vertexCount)
+{
+	MeshPtr mesh = mMeshMgr->createManual(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	for (size_t s = 0; s < 2; ++s)
+	{
+		SubMesh* sub = mesh->createSubMesh();
+		sub->setMaterialName("BaseWhite");
+		sub->useSharedVertices = false;
+		sub->vertexData = OGRE_NEW VertexData();
+		sub->vertexData->vertexCount = vertexCount;
+		VertexDeclaration* decl = sub->vertexData->vertexDeclaration;
+		size_t offset = 0;
+		offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+		offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+		decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES);
+
+		HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+			decl->getVertexSize(0), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t i = 0; i < vertexCount * VERTEX_FLOATS; ++i)
+			pFloat[i] = vertexValue(s, i);
+		vbuf->unlock();
+		sub->vertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+		// 16 bit indexes for the first submesh, 32 bit for the second
+		HardwareIndexBuffer::IndexType itype = 
+			s == 0 && vertexCount <= 65536 ? HardwareIndexBuffer::IT_16BIT : HardwareIndexBuffer::IT_32BIT;
+		HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
+			itype, vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		void* pIdx = ibuf->lock(HardwareBuffer::HBL_DISCARD);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			if (itype == HardwareIndexBuffer::IT_32BIT)
+				static_cast<uint32*>(pIdx)[i] = (uint32)indexValue(s, i, vertexCount);
+			else
+				static_cast<uint16*>(pIdx)[i] = (uint16)indexValue(s, i, vertexCount);
+		}
+		ibuf->unlock();
+		sub->indexData->indexBuffer = ibuf;
+		sub->indexData->indexCount = vertexCount;
+	}
+	mesh->_setBounds(AxisAlignedBox(0, 0, 0, 500, 500, 500));
+	mesh->_setBoundingSphereRadius(870);
+	return mesh;
+}
+
+MeshPtr MeshSerializerTests::importMesh(const String& name, DataStreamPtr& stream)
+{
+	MeshPtr mesh = mMeshMgr->createManual(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	MeshSerializer serializer;
+	serializer.importMesh(stream, mesh.get());
+	return mesh;
+}
+
+void MeshSerializerTests::testAlignedBuffersRoundTrip()
+{
+	// odd sizes, so that data following the buffers is misaligned
+	const size_t vertexCount = 1001;
+	MeshPtr mesh = createMesh("RoundTrip", vertexCount);
+	MeshSerializer serializer;
+	serializer.exportMesh(mesh.get(), "MeshSerializerTests_aligned.mesh", Serializer::ENDIAN_NATIVE, true);
+	serializer.exportMesh(mesh.get(), "MeshSerializerTests.mesh");
+	mMeshMgr->remove("RoundTrip");
+
+	// Mapped, so the data is used in place
+	MappedFileDataStream* mapped = OGRE_NEW MappedFileDataStream("aligned", "MeshSerializerTests_aligned.mesh");
+	DataStreamPtr stream(mapped);
+	MeshPtr loaded = importMesh("Mapped", stream);
+	CPPUNIT_ASSERT_EQUAL((unsigned short)2, loaded->getNumSubMeshes());
+	CPPUNIT_ASSERT(usesStreamMemory(loaded, mapped));
+	stream.setNull();
+	// The buffers keep the mapping alive
+	for (unsigned short s = 0; s < 2; ++s)
+		checkSubMesh(loaded->getSubMesh(s), s, vertexCount);
+	CPPUNIT_ASSERT_EQUAL(HardwareIndexBuffer::IT_16BIT, loaded->getSubMesh(0)->indexData->indexBuffer->getType());
+	CPPUNIT_ASSERT_EQUAL(HardwareIndexBuffer::IT_32BIT, loaded->getSubMesh(1)->indexData->indexBuffer->getType());
+	mMeshMgr->remove("Mapped");
+
+	// From a file stream, the data has to be copied
+	std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+		"MeshSerializerTests_aligned.mesh", std::ios::in | std::ios::binary);
+	stream = DataStreamPtr(OGRE_NEW FileStreamDataStream(file));
+	loaded = importMesh("Streamed", stream);
+	for (unsigned short s = 0; s < 2; ++s)
+		checkSubMesh(loaded->getSubMesh(s), s, vertexCount);
+	mMeshMgr->remove("Streamed");
+
+	// Through the resource system, both formats with memory mapping
+	FileSystemArchive::setUseMemoryMapping(true);
+	ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem");
+	const char* files[] = { "MeshSerializerTests_aligned.mesh", "MeshSerializerTests.mesh" };
+	for (size_t f = 0; f < 2; ++f)
+	{
+		loaded = mMeshMgr->load(files[f], ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		for (unsigned short s = 0; s < 2; ++s)
+			checkSubMesh(loaded->getSubMesh(s), s, vertexCount);
+		mMeshMgr->remove(files[f]);
+	}
+	loaded.setNull();
+
+	remove("MeshSerializerTests_aligned.mesh");
+	remove("MeshSerializerTests.mesh");
+}
+
+void MeshSerializerTests::testAlignedBuffersLoadPerformance()
+{
+	const size_t vertexCount = 256 * 1024;
+	const int loads = 10;
+	MeshPtr mesh = createMesh("Benchmark", vertexCount);
+	MeshSerializer serializer;
+	serializer.exportMesh(mesh.get(), "MeshSerializerTests.mesh");
+	serializer.exportMesh(mesh.get(), "MeshSerializerTests_aligned.mesh", Serializer::ENDIAN_NATIVE, true);
+	mMeshMgr->remove("Benchmark");
+	mesh.setNull();
+
+	Timer timer;
+	double loadTime[2];
+	double useTime[2];
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		loadTime[mode] = useTime[mode] = 0;
+		for (int i = 0; i < loads; ++i)
+		{
+			timer.reset();
+			DataStreamPtr stream;
+			if (mode == 0)
+			{
+				// As Mesh::prepareImpl does without memory mapping
+				std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+					"MeshSerializerTests.mesh", std::ios::in | std::ios::binary);
+				DataStreamPtr fileStream(OGRE_NEW FileStreamDataStream(file));
+				stream = DataStreamPtr(OGRE_NEW MemoryDataStream("Benchmark", fileStream));
+			}
+			else
+			{
+				stream = DataStreamPtr(OGRE_NEW MappedFileDataStream("Benchmark", "MeshSerializerTests_aligned.mesh"));
+			}
+			MeshPtr loaded = importMesh("Benchmark", stream);
+			stream.setNull();
+			loadTime[mode] += timer.getMicroseconds();
+
+			// Mapped pages are only read when used, so include a pass over the data
+			timer.reset();
+			float sum = 0;
+			for (unsigned short s = 0; s < loaded->getNumSubMeshes(); ++s)
+			{
+				HardwareVertexBufferSharedPtr vbuf = 
+					loaded->getSubMesh(s)->vertexData->vertexBufferBinding->getBuffer(0);
+				const float* pFloat = static_cast<const float*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+				for (size_t v = 0; v < vertexCount * VERTEX_FLOATS; v += 16)
+					sum += pFloat[v];
+				vbuf->unlock();
+			}
+			CPPUNIT_ASSERT(sum > 0);
+			useTime[mode] += timer.getMicroseconds();
+			loaded.setNull();
+			mMeshMgr->remove("Benchmark");
+		}
+	}
+
+	std::cout << std::endl << "Mesh load, " << vertexCount * 2 << " vertices, ms: "
+		<< loadTime[0] / (1000.0 * loads) << " copied, " << loadTime[1] / (1000.0 * loads) << " mapped in place; "
+		<< "first pass over the vertices, ms: " << useTime[0] / (1000.0 * loads) << " copied, "
+		<< useTime[1] / (1000.0 * loads) << " mapped" << std::endl;
+
+	remove("MeshSerializerTests_aligned.mesh");
+	remove("MeshSerializerTests.mesh");
+}
@@ -0,0 +1,499 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OptimisedUtilTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreFrustum.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreTimer.h"
+#include "OgreQuaternion.h"
+#include "OgreEdgeListBuilder.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( OptimisedUtilTests );
+
+namespace
+{
+	/// SIMD aligned arrays of bounds to cull, with the objects they describe
+	struct CullingData
+	{
+		size_t count;
+		float* data;
+		AxisAlignedBoxArrays boxes;
+		SphereArrays spheres;
+		vector<AxisAlignedBox>::type boxObjects;
+		vector<Sphere>::type sphereObjects;
+		vector<uint32>::type visibility;
+
+		/// Scatter boxes and spheres around the frustum, mostly crossing its planes
+		CullingData(size_t n, uint32 seed)
+			: count(n)
+		{
+			size_t stride = (count + 3) & ~3;
+			data = static_cast<float*>(OGRE_MALLOC_SIMD(sizeof(float) * stride * 7, MEMCATEGORY_GENERAL));
+			boxes.centreX = spheres.centreX = data;
+			boxes.centreY = spheres.centreY = data + stride;
+			boxes.centreZ = spheres.centreZ = data + stride * 2;
+			boxes.halfSizeX = data + stride * 3;
+			boxes.halfSizeY = data + stride * 4;
+			boxes.halfSizeZ = data + stride * 5;
+			spheres.radius = data + stride * 6;
+			visibility.resize((count + 31) / 32);
+
+			TestRandom rnd(seed);
+			for (size_t i = 0; i < count; ++i)
+			{
+				Vector3 centre(rnd.next(-150, 150), rnd.next(-150, 150), rnd.next(-250, 50));
+				Vector3 halfSize(rnd.next(0, 20), rnd.next(0, 20), rnd.next(0, 20));
+				boxObjects.push_back(AxisAlignedBox(centre - halfSize, centre + halfSize));
+				sphereObjects.push_back(Sphere(centre, halfSize.x));
+
+				// Gather what the objects themselves return, as callers would
+				Vector3 boxCentre = boxObjects.back().getCenter();
+				Vector3 boxHalfSize = boxObjects.back().getHalfSize();
+				boxes.centreX[i] = boxCentre.x;
+				boxes.centreY[i] = boxCentre.y;
+				boxes.centreZ[i] = boxCentre.z;
+				boxes.halfSizeX[i] = boxHalfSize.x;
+				boxes.halfSizeY[i] = boxHalfSize.y;
+				boxes.halfSizeZ[i] = boxHalfSize.z;
+				spheres.radius[i] = halfSize.x;
+			}
+		}
+
+		~CullingData()
+		{
+			OGRE_FREE_SIMD(data, MEMCATEGORY_GENERAL);
+		}
+
+		bool isVisible(size_t i) const
+		{
+			return (visibility[i >> 5] & (1u << (i & 31))) != 0;
+		}
+	};
+}
+
+void OptimisedUtilTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+	mBufMgr = new DefaultHardwareBufferManager();
+	mFrustum = OGRE_NEW Frustum();
+	mFrustum->setNearClipDistance(1);
+	mFrustum->setFarClipDistance(200);
+}
+void OptimisedUtilTests::tearDown()
+{
+	OGRE_DELETE mFrustum;
+	delete mBufMgr;
+	OGRE_DELETE mRoot;
+}
+
+void OptimisedUtilTests::testCullAxisAlignedBoxes()
+{
+	// not a multiple of 4 or 32, so the left over boxes are tested too
+	CullingData data(1003, 1234);
+	OptimisedUtil::getImplementation()->cullAxisAlignedBoxes(
+		mFrustum->getFrustumPlanes(), 6, data.boxes, &data.visibility[0], data.count);
+
+	size_t visible = 0;
+	for (size_t i = 0; i < data.count; ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(mFrustum->isVisible(data.boxObjects[i]), data.isVisible(i));
+		visible += data.isVisible(i) ? 1 : 0;
+	}
+	CPPUNIT_ASSERT(visible > 0 && visible < data.count);
+
+	// more planes than are done in one go, with the frustum's planes twice
+	// and some extra ones
+	Plane planes[10];
+	std::copy(mFrustum->getFrustumPlanes(), mFrustum->getFrustumPlanes() + 6, planes);
+	std::copy(mFrustum->getFrustumPlanes(), mFrustum->getFrustumPlanes() + 2, planes + 6);
+	planes[8] = Plane(Vector3::UNIT_X, 20);
+	planes[9] = Plane(Vector3(-1, 1, 0).normalisedCopy(), 30);
+	OptimisedUtil::getImplementation()->cullAxisAlignedBoxes(
+		planes, 10, data.boxes, &data.visibility[0], data.count);
+	for (size_t i = 0; i < data.count; ++i)
+	{
+		const AxisAlignedBox& box = data.boxObjects[i];
+		bool expected = mFrustum->isVisible(box) &&
+			planes[8].getSide(box.getCenter(), box.getHalfSize()) != Plane::NEGATIVE_SIDE &&
+			planes[9].getSide(box.getCenter(), box.getHalfSize()) != Plane::NEGATIVE_SIDE;
+		CPPUNIT_ASSERT_EQUAL(expected, data.isVisible(i));
+	}
+}
+
+void OptimisedUtilTests::testCullSpheres()
+{
+	CullingData data(1003, 5678);
+	OptimisedUtil::getImplementation()->cullSpheres(
+		mFrustum->getFrustumPlanes(), 6, data.spheres, &data.visibility[0], data.count);
+
+	size_t visible = 0;
+	for (size_t i = 0; i < data.count; ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(mFrustum->isVisible(data.sphereObjects[i]), data.isVisible(i));
+		visible += data.isVisible(i) ? 1 : 0;
+	}
+	CPPUNIT_ASSERT(visible > 0 && visible < data.count);
+
+	// no planes means nothing is culled
+	OptimisedUtil::getImplementation()->cullSpheres(
+		0, 0, data.spheres, &data.visibility[0], data.count);
+	for (size_t i = 0; i < data.count; ++i)
+		CPPUNIT_ASSERT(data.isVisible(i));
+}
+
+void OptimisedUtilTests::testCullingPerformance()
+{
+	const size_t count = 100000;
+	const size_t runs = 20;
+	CullingData data(count, 42);
+	const Plane* planes = mFrustum->getFrustumPlanes();
+
+	size_t visible = 0;
+	Timer timer;
+	for (size_t r = 0; r < runs; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+			visible += mFrustum->isVisible(data.boxObjects[i]) ? 1 : 0;
+	}
+	double perBox = (double)timer.getMicroseconds() * 1000.0 / (double)(count * runs);
+
+	timer.reset();
+	for (size_t r = 0; r < runs; ++r)
+	{
+		OptimisedUtil::getImplementation()->cullAxisAlignedBoxes(
+			planes, 6, data.boxes, &data.visibility[0], count);
+	}
+	double batchedBox = (double)timer.getMicroseconds() * 1000.0 / (double)(count * runs);
+
+	timer.reset();
+	for (size_t r = 0; r < runs; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+			visible += mFrustum->isVisible(data.sphereObjects[i]) ? 1 : 0;
+	}
+	double perSphere = (double)timer.getMicroseconds() * 1000.0 / (double)(count * runs);
+
+	timer.reset();
+	for (size_t r = 0; r < runs; ++r)
+	{
+		OptimisedUtil::getImplementation()->cullSpheres(
+			planes, 6, data.spheres, &data.visibility[0], count);
+	}
+	double batchedSphere = (double)timer.getMicroseconds() * 1000.0 / (double)(count * runs);
+
+	std::cout << std::endl << "Frustum culling, ns per object: boxes " << perBox
+		<< " with Frustum::isVisible, " << batchedBox << " batched; spheres " << perSphere
+		<< " with Frustum::isVisible, " << batchedSphere << " batched" << std::endl;
+	CPPUNIT_ASSERT(visible > 0);
+}
+
+void OptimisedUtilTests::testNlerpQuaternions()
+{
+	// not a multiple of 4, so the left over quaternions are interpolated too
+	const size_t count = 103;
+	const size_t stride = 104;
+	float* data = static_cast<float*>(OGRE_MALLOC_SIMD(sizeof(float) * stride * 13, MEMCATEGORY_GENERAL));
+	QuaternionArrays from = { data, data + stride, data + stride * 2, data + stride * 3 };
+	QuaternionArrays to = { data + stride * 4, data + stride * 5, data + stride * 6, data + stride * 7 };
+	QuaternionArrays result = { data + stride * 8, data + stride * 9, data + stride * 10, data + stride * 11 };
+	float* t = data + stride * 12;
+
+	TestRandom rnd(91);
+	vector<Quaternion>::type fromQ, toQ;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Quaternion a(Radian(rnd.next(-Math::PI, Math::PI)),
+			Vector3(rnd.next(-1, 1), rnd.next(-1, 1), rnd.next(0.1f, 1)).normalisedCopy());
+		Quaternion b(Radian(rnd.next(-Math::PI, Math::PI)),
+			Vector3(rnd.next(-1, 1), rnd.next(0.1f, 1), rnd.next(-1, 1)).normalisedCopy());
+		fromQ.push_back(a);
+		toQ.push_back(b);
+		from.w[i] = a.w; from.x[i] = a.x; from.y[i] = a.y; from.z[i] = a.z;
+		to.w[i] = b.w; to.x[i] = b.x; to.y[i] = b.y; to.z[i] = b.z;
+		t[i] = rnd.next(0, 1);
+	}
+
+	for (int shortestPath = 0; shortestPath < 2; ++shortestPath)
+	{
+		OptimisedUtil::getImplementation()->nlerpQuaternions(
+			from, to, t, result, count, shortestPath != 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			Quaternion expected = Quaternion::nlerp(t[i], fromQ[i], toQ[i], shortestPath != 0);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.w, result.w[i], 1e-4);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.x, result.x[i], 1e-4);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.y, result.y[i], 1e-4);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, result.z[i], 1e-4);
+		}
+	}
+
+	// the results may overwrite the quaternions interpolated to
+	OptimisedUtil::getImplementation()->nlerpQuaternions(from, to, t, to, count, true);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Quaternion expected = Quaternion::nlerp(t[i], fromQ[i], toQ[i], true);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.w, to.w[i], 1e-4);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, to.z[i], 1e-4);
+	}
+
+	OGRE_FREE_SIMD(data, MEMCATEGORY_GENERAL);
+}
+
+void OptimisedUtilTests::testArrayArithmetic()
+{
+	// not a multiple of 4 or 16, so the left over values are done too
+	const size_t count = 1003;
+	const size_t stride = 1004;
+	float* data = static_cast<float*>(OGRE_MALLOC_SIMD(sizeof(float) * stride * 2, MEMCATEGORY_GENERAL));
+	float* dest = data;
+	float* src = data + stride;
+	vector<float>::type expected(count);
+
+	TestRandom rnd(77);
+	for (size_t i = 0; i < count; ++i)
+	{
+		dest[i] = rnd.next(-2, 2);
+		src[i] = rnd.next(-10, 10);
+		expected[i] = dest[i] + src[i] * 0.25f;
+	}
+	OptimisedUtil::getImplementation()->accumulateScaled(dest, src, 0.25f, count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], dest[i], 1e-5);
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float v = dest[i] * 0.5f + 0.3f;
+		expected[i] = std::min(std::max(v, 0.0f), 1.0f);
+	}
+	OptimisedUtil::getImplementation()->scaleOffsetClamp(dest, count, 0.5f, 0.3f, 0.0f, 1.0f);
+	for (size_t i = 0; i < count; ++i)
+	{
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], dest[i], 1e-6);
+	}
+
+	// infinite limits leave the values unclamped
+	for (size_t i = 0; i < count; ++i)
+	{
+		src[i] *= 100;
+		expected[i] = src[i] - 5;
+	}
+	OptimisedUtil::getImplementation()->scaleOffsetClamp(src, count, 1.0f, -5.0f,
+		-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+	for (size_t i = 0; i < count; ++i)
+	{
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], src[i], 1e-4);
+	}
+
+	OGRE_FREE_SIMD(data, MEMCATEGORY_GENERAL);
+}
+
+void OptimisedUtilTests::testLightFacingMask()
+{
+	// not a multiple of 4 or 32, so the left over faces are done too
+	const size_t count = 1003;
+	EdgeData::TriangleFaceNormalList faceNormals;
+	TestRandom rnd(123);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector3 n = Vector3(rnd.next(-1, 1), rnd.next(-1, 1), rnd.next(-1, 1)).normalisedCopy();
+		faceNormals.push_back(Vector4(n.x, n.y, n.z, rnd.next(-10, 10)));
+	}
+
+	Vector4 lights[2] = { Vector4(3, -20, 5, 1), Vector4(0.6f, 0.8f, 0, 0) };
+	vector<char>::type lightFacings(count);
+	vector<uint32>::type mask((count + 31) / 32, 0xFFFFFFFF);
+	for (size_t l = 0; l < 2; ++l)
+	{
+		OptimisedUtil::getImplementation()->calculateLightFacing(
+			lights[l], &faceNormals[0], &lightFacings[0], count);
+		OptimisedUtil::getImplementation()->calculateLightFacingMask(
+			lights[l], &faceNormals[0], &mask[0], count);
+
+		size_t facing = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			bool bit = (mask[i >> 5] & (1u << (i & 31))) != 0;
+			CPPUNIT_ASSERT_EQUAL(lightFacings[i] != 0, bit);
+			facing += bit ? 1 : 0;
+		}
+		CPPUNIT_ASSERT(facing > 0 && facing < count);
+		// bits past the last face are cleared
+		CPPUNIT_ASSERT_EQUAL((uint32)0, mask.back() >> (count & 31));
+	}
+}
+
+void OptimisedUtilTests::testSilhouetteEdges()
+{
+	const size_t numTriangles = 60000;
+	const size_t numEdges = numTriangles * 3 / 2;
+	vector<uint32>::type mask((numTriangles + 31) / 32);
+	vector<char>::type lightFacings(numTriangles);
+	TestRandom rnd(321);
+	for (size_t i = 0; i < numTriangles; ++i)
+	{
+		// runs of light facing triangles, as on a real mesh
+		lightFacings[i] = (i / 7 + (size_t)rnd.next(0, 1.3f)) % 2 ? 1 : 0;
+		if (lightFacings[i])
+			mask[i >> 5] |= 1u << (i & 31);
+	}
+	EdgeData::EdgeList edges(numEdges);
+	for (size_t i = 0; i < numEdges; ++i)
+	{
+		EdgeData::Edge& e = edges[i];
+		e.triIndex[0] = (size_t)rnd.next(0, (float)numTriangles - 1);
+		e.triIndex[1] = std::min(e.triIndex[0] + (size_t)rnd.next(0, 3), numTriangles - 1);
+		e.vertIndex[0] = e.sharedVertIndex[0] = (size_t)rnd.next(0, 65535);
+		e.vertIndex[1] = e.sharedVertIndex[1] = (size_t)rnd.next(0, 65535);
+		e.degenerate = rnd.next(0, 1) < 0.05f;
+	}
+
+	// The test generateShadowVolume used to do for each edge
+	vector<uint32>::type expected;
+	for (size_t i = 0; i < numEdges; ++i)
+	{
+		const EdgeData::Edge& edge = edges[i];
+		char lightFacing = lightFacings[edge.triIndex[0]];
+		if ((edge.degenerate && lightFacing) ||
+			(!edge.degenerate && (lightFacing != lightFacings[edge.triIndex[1]])))
+		{
+			size_t v0 = edge.vertIndex[0];
+			size_t v1 = edge.vertIndex[1];
+			if (!lightFacing)
+				std::swap(v0, v1);
+			expected.push_back((uint32)v0);
+			expected.push_back((uint32)v1);
+		}
+	}
+
+	vector<uint32>::type silhouette(numEdges * 2);
+	size_t numSilhouetteEdges = OptimisedUtil::getImplementation()->findSilhouetteEdges(
+		&mask[0], &edges[0], numEdges, &silhouette[0]);
+
+	CPPUNIT_ASSERT(numSilhouetteEdges > 0 && numSilhouetteEdges < numEdges);
+	CPPUNIT_ASSERT_EQUAL(expected.size(), numSilhouetteEdges * 2);
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(expected[i], silhouette[i]);
+	}
+}
+
+void OptimisedUtilTests::testTransformAffineVertices()
+{
+	// interleaved position, normal and texture coordinate, as static geometry sees them
+	const size_t count = 57;
+	const size_t stride = sizeof(float) * 8;
+	vector<float>::type src(count * 8), dest(count * 8, 0.0f);
+	TestRandom rnd(17);
+	for (size_t i = 0; i < src.size(); ++i)
+		src[i] = rnd.next(-10, 10);
+	// a zero length normal is left as it is
+	src[3] = src[4] = src[5] = 0;
+
+	Quaternion orientation(Radian(1.2f), Vector3(1, 2, 3).normalisedCopy());
+	Vector3 scale(2, 0.5f, 3);
+	Matrix4 posXform, dirXform;
+	posXform.makeTransform(Vector3(5, -4, 100), scale, orientation);
+	dirXform.makeTransform(Vector3::ZERO, Vector3::UNIT_SCALE / scale, orientation);
+
+	OptimisedUtil* util = OptimisedUtil::getImplementation();
+	util->transformAffineVertices(posXform, &src[0], stride, &dest[0], stride, count, false);
+	// normals are normalised with the SIMD reciprocal square root estimate
+	util->transformAffineVertices(dirXform, &src[3], stride, &dest[3], stride, count, true);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* s = &src[i * 8];
+		const float* d = &dest[i * 8];
+		Vector3 pos = posXform.transformAffine(Vector3(s[0], s[1], s[2]));
+		Vector3 norm = (orientation * (Vector3(s[3], s[4], s[5]) / scale)).normalisedCopy();
+		if (i == 0)
+			norm = Vector3::ZERO;
+		for (int c = 0; c < 3; ++c)
+		{
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(pos[c], d[c], 1e-3);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(norm[c], d[3 + c], 1e-3);
+		}
+		// the rest of the vertex isn't touched
+		CPPUNIT_ASSERT_EQUAL(0.0f, d[6]);
+		CPPUNIT_ASSERT_EQUAL(0.0f, d[7]);
+	}
+}
+
+void OptimisedUtilTests::testGenerateQuadVertices()
+{
+	// billboards with their own offsets, then all sharing the first ones
+	const size_t count = 37;
+	float* data = static_cast<float*>(OGRE_MALLOC_SIMD(sizeof(float) * count * 24, MEMCATEGORY_GENERAL));
+	float* centres = data;
+	float* offsets = centres + count * 4;
+	float* texCoords = offsets + count * 16;
+	vector<uint32>::type colours(count);
+	TestRandom rnd(23);
+	for (size_t i = 0; i < count * 24; ++i)
+		data[i] = rnd.next(-10, 10);
+	for (size_t i = 0; i < count; ++i)
+		colours[i] = 0x01020304 * (uint32)(i + 1);
+
+	OptimisedUtil* util = OptimisedUtil::getImplementation();
+	for (int shared = 0; shared < 2; ++shared)
+	{
+		size_t offsetStride = shared ? 0 : 16;
+		// an extra vertex to check nothing is written past the end
+		vector<float>::type dest((count * 4 + 1) * 6, 0.0f);
+		util->generateQuadVertices(centres, offsets, offsetStride, &colours[0],
+			texCoords, &dest[0], count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* c = centres + i * 4;
+			const float* t = texCoords + i * 4;
+			for (size_t corner = 0; corner < 4; ++corner)
+			{
+				const float* o = offsets + i * offsetStride + corner * 4;
+				const float* v = &dest[(i * 4 + corner) * 6];
+				for (int e = 0; e < 3; ++e)
+					CPPUNIT_ASSERT_EQUAL(c[e] + o[e], v[e]);
+				CPPUNIT_ASSERT_EQUAL(colours[i], *reinterpret_cast<const uint32*>(v + 3));
+				CPPUNIT_ASSERT_EQUAL(corner & 1 ? t[2] : t[0], v[4]);
+				CPPUNIT_ASSERT_EQUAL(corner & 2 ? t[3] : t[1], v[5]);
+			}
+		}
+		for (size_t e = count * 24; e < dest.size(); ++e)
+			CPPUNIT_ASSERT_EQUAL(0.0f, dest[e]);
+	}
+
+	OGRE_FREE_SIMD(data, MEMCATEGORY_GENERAL);
+}
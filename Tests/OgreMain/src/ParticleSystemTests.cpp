@@ -0,0 +1,386 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ParticleSystemTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreMaterialManager.h"
+#include "OgreMaterial.h"
+#include "OgreControllerManager.h"
+#include "OgreParticleSystem.h"
+#include "OgreParticleSystemManager.h"
+#include "OgreParticleSystemRenderer.h"
+#include "OgreParticleAffector.h"
+#include "OgreParticleAffectorFactory.h"
+#include "OgreParticleArrays.h"
+#include "OgreParticle.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreTimer.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ParticleSystemTests );
+
+namespace
+{
+	const float INF = std::numeric_limits<float>::infinity();
+
+	// Affectors which work like those of the ParticleFX plugin, which the
+	// tests can't create
+
+	/// Adds a force to the direction, like LinearForceAffector
+	class ForceAffector : public ParticleAffector
+	{
+	public:
+		ForceAffector(ParticleSystem* psys) : ParticleAffector(psys) { mType = "TestForce"; }
+		void _affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+		{
+			ParticleIterator pi = pSystem->_getIterator();
+			while (!pi.end())
+				pi.getNext()->direction += Vector3(0, -10, 2) * timeElapsed;
+		}
+		bool supportsParticleArrays(void) const { return true; }
+		void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+		{
+			(void)pSystem;
+			OptimisedUtil* util = OptimisedUtil::getImplementation();
+			util->scaleOffsetClamp(particles.directionY, particles.getCount(), 1, -10 * timeElapsed, -INF, INF);
+			util->scaleOffsetClamp(particles.directionZ, particles.getCount(), 1, 2 * timeElapsed, -INF, INF);
+		}
+	};
+
+	/// Fades the colour, like ColourFaderAffector
+	class FaderAffector : public ParticleAffector
+	{
+	public:
+		FaderAffector(ParticleSystem* psys) : ParticleAffector(psys) { mType = "TestFader"; }
+		static void adjust(float& c, float d)
+		{
+			c += d;
+			if (c < 0) c = 0; else if (c > 1) c = 1;
+		}
+		void _affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+		{
+			ParticleIterator pi = pSystem->_getIterator();
+			float d = -0.25f * timeElapsed;
+			while (!pi.end())
+			{
+				Particle* p = pi.getNext();
+				adjust(p->colour.r, d);
+				adjust(p->colour.g, d);
+				adjust(p->colour.b, d);
+				adjust(p->colour.a, d);
+			}
+		}
+		bool supportsParticleArrays(void) const { return true; }
+		void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+		{
+			(void)pSystem;
+			OptimisedUtil* util = OptimisedUtil::getImplementation();
+			float d = -0.25f * timeElapsed;
+			util->scaleOffsetClamp(particles.colourR, particles.getCount(), 1, d, 0, 1);
+			util->scaleOffsetClamp(particles.colourG, particles.getCount(), 1, d, 0, 1);
+			util->scaleOffsetClamp(particles.colourB, particles.getCount(), 1, d, 0, 1);
+			util->scaleOffsetClamp(particles.colourA, particles.getCount(), 1, d, 0, 1);
+		}
+	};
+
+	/// Grows the particles, like ScaleAffector
+	class ScaleAffector : public ParticleAffector
+	{
+	public:
+		ScaleAffector(ParticleSystem* psys) : ParticleAffector(psys) { mType = "TestScale"; }
+		void _affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+		{
+			ParticleIterator pi = pSystem->_getIterator();
+			Real ds = 5 * timeElapsed;
+			while (!pi.end())
+			{
+				Particle* p = pi.getNext();
+				if (p->hasOwnDimensions())
+					p->setDimensions(p->getOwnWidth() + ds, p->getOwnHeight() + ds);
+				else
+					p->setDimensions(pSystem->getDefaultWidth() + ds, pSystem->getDefaultHeight() + ds);
+			}
+		}
+		bool supportsParticleArrays(void) const { return true; }
+		void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+		{
+			size_t count = particles.getCount();
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!particles.ownDimensions[i])
+				{
+					particles.width[i] = pSystem->getDefaultWidth();
+					particles.height[i] = pSystem->getDefaultHeight();
+					particles.ownDimensions[i] = 1;
+				}
+			}
+			OptimisedUtil* util = OptimisedUtil::getImplementation();
+			util->scaleOffsetClamp(particles.width, count, 1, 5 * timeElapsed, -INF, INF);
+			util->scaleOffsetClamp(particles.height, count, 1, 5 * timeElapsed, -INF, INF);
+			pSystem->_notifyParticleResized();
+		}
+	};
+
+	/// Spins the particles, like RotationAffector
+	class RotatorAffector : public ParticleAffector
+	{
+	public:
+		RotatorAffector(ParticleSystem* psys) : ParticleAffector(psys) { mType = "TestRotator"; }
+		void _affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+		{
+			ParticleIterator pi = pSystem->_getIterator();
+			while (!pi.end())
+			{
+				Particle* p = pi.getNext();
+				p->setRotation(p->rotation + timeElapsed * p->rotationSpeed);
+			}
+		}
+		bool supportsParticleArrays(void) const { return true; }
+		void _affectParticleArrays(ParticleSystem* pSystem, ParticleArrays& particles, Real timeElapsed)
+		{
+			OptimisedUtil::getImplementation()->accumulateScaled(
+				particles.rotation, particles.rotationSpeed, timeElapsed, particles.getCount());
+			pSystem->_notifyParticleRotated();
+		}
+	};
+
+	/// Slows the particles down, without supporting arrays
+	class DragAffector : public ParticleAffector
+	{
+	public:
+		DragAffector(ParticleSystem* psys) : ParticleAffector(psys) { mType = "TestDrag"; }
+		void _affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+		{
+			ParticleIterator pi = pSystem->_getIterator();
+			while (!pi.end())
+				pi.getNext()->direction *= 1 - 0.5f * timeElapsed;
+		}
+	};
+
+	/// Renderer which draws nothing, since there is no render system
+	class NullRenderer : public ParticleSystemRenderer
+	{
+	public:
+		NullRenderer() : resizedCount(0), rotatedCount(0) {}
+		const String& getType(void) const { static String type = "billboard"; return type; }
+		void _updateRenderQueue(RenderQueue* queue, list<Particle*>::type& currentParticles, bool cullIndividually)
+		{ (void)queue; (void)currentParticles; (void)cullIndividually; }
+		void _setMaterial(MaterialPtr& mat) { (void)mat; }
+		void _notifyCurrentCamera(Camera* cam) { (void)cam; }
+		void _notifyAttached(Node* parent, bool isTagPoint) { (void)parent; (void)isTagPoint; }
+		void _notifyParticleRotated(void) { ++rotatedCount; }
+		void _notifyParticleResized(void) { ++resizedCount; }
+		void _notifyParticleQuota(size_t quota) { (void)quota; }
+		void _notifyDefaultDimensions(Real width, Real height) { (void)width; (void)height; }
+		void setRenderQueueGroup(uint8 queueID) { (void)queueID; }
+		void setKeepParticlesInLocalSpace(bool keepLocal) { (void)keepLocal; }
+		SortMode _getSortMode(void) const { return SM_DISTANCE; }
+		void visitRenderables(Renderable::Visitor* visitor, bool debugRenderables)
+		{ (void)visitor; (void)debugRenderables; }
+
+		size_t resizedCount;
+		size_t rotatedCount;
+	};
+
+	class NullRendererFactory : public ParticleSystemRendererFactory
+	{
+	public:
+		const String& getType(void) const { static String type = "billboard"; return type; }
+		ParticleSystemRenderer* createInstance(const String& name) { (void)name; return OGRE_NEW NullRenderer(); }
+		void destroyInstance(ParticleSystemRenderer* inst) { OGRE_DELETE inst; }
+	};
+
+	template <class T>
+	class TestAffectorFactory : public ParticleAffectorFactory
+	{
+		String mName;
+	public:
+		TestAffectorFactory(const String& name) : mName(name) {}
+		String getName() const { return mName; }
+		ParticleAffector* createAffector(ParticleSystem* psys)
+		{
+			ParticleAffector* p = OGRE_NEW T(psys);
+			mAffectors.push_back(p);
+			return p;
+		}
+	};
+}
+
+void ParticleSystemTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+	// Normally created by Root::initialise; systems need it once attached
+	mControllerMgr = OGRE_NEW ControllerManager();
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+
+	// Stand in for the default renderer and material, which need a render system
+	mRendererFactory = OGRE_NEW NullRendererFactory();
+	ParticleSystemManager::getSingleton().addRendererFactory(mRendererFactory);
+	MaterialPtr mat = MaterialManager::getSingleton().create("BaseWhite",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	mat->removeAllTechniques();
+
+	mForceFactory = OGRE_NEW TestAffectorFactory<ForceAffector>("TestForce");
+	mFaderFactory = OGRE_NEW TestAffectorFactory<FaderAffector>("TestFader");
+	mScaleFactory = OGRE_NEW TestAffectorFactory<ScaleAffector>("TestScale");
+	mRotatorFactory = OGRE_NEW TestAffectorFactory<RotatorAffector>("TestRotator");
+	mDragFactory = OGRE_NEW TestAffectorFactory<DragAffector>("TestDrag");
+	ParticleSystemManager& mgr = ParticleSystemManager::getSingleton();
+	mgr.addAffectorFactory(mForceFactory);
+	mgr.addAffectorFactory(mFaderFactory);
+	mgr.addAffectorFactory(mScaleFactory);
+	mgr.addAffectorFactory(mRotatorFactory);
+	mgr.addAffectorFactory(mDragFactory);
+}
+void ParticleSystemTests::tearDown()
+{
+	// The affectors have to be destroyed before their factories
+	mRoot->destroySceneManager(mSceneMgr);
+	OGRE_DELETE mControllerMgr;
+	OGRE_DELETE mForceFactory;
+	OGRE_DELETE mFaderFactory;
+	OGRE_DELETE mScaleFactory;
+	OGRE_DELETE mRotatorFactory;
+	OGRE_DELETE mDragFactory;
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mRendererFactory;
+}
+
+ParticleSystem* ParticleSystemTests::createSystem(const String& name, size_t count, uint32 seed)
+{
+	ParticleSystem* ps = mSceneMgr->createParticleSystem(name, count);
+	mSceneMgr->getRootSceneNode()->attachObject(ps);
+	// Creates the pool of particles
+	ps->_update(0);
+
+	TestRandom rnd(seed);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Particle* p = ps->createParticle();
+		p->position = Vector3(rnd.next(-100, 100), rnd.next(-100, 100), rnd.next(-100, 100));
+		p->direction = Vector3(rnd.next(-10, 10), rnd.next(-10, 10), rnd.next(-10, 10));
+		p->colour = ColourValue(rnd.next(0, 1), rnd.next(0, 1), rnd.next(0, 1), rnd.next(0, 1));
+		p->rotation = Radian(rnd.next(-Math::PI, Math::PI));
+		p->rotationSpeed = Radian(rnd.next(-2, 2));
+		// Some expire during the updates
+		p->timeToLive = p->totalTimeToLive = rnd.next(0.2f, 10);
+		if (i % 3 == 0)
+			p->setDimensions(rnd.next(1, 10), rnd.next(1, 10));
+		else
+			p->resetDimensions();
+	}
+	return ps;
+}
+
+void ParticleSystemTests::testParticleArraysMatchList()
+{
+	// not a multiple of 4
+	const size_t count = 1001;
+	ParticleSystem* listSystem = createSystem("List", count, 42);
+	ParticleSystem* arraySystem = createSystem("Arrays", count, 42);
+	arraySystem->setParticleArraysEnabled(true);
+	CPPUNIT_ASSERT(!listSystem->getParticleArraysEnabled());
+
+	// The drag affector doesn't support arrays, so the arrays are copied
+	// back to the particles and gathered again around it
+	const char* affectors[] = { "TestForce", "TestDrag", "TestFader", "TestScale", "TestRotator" };
+	for (size_t a = 0; a < 5; ++a)
+	{
+		listSystem->addAffector(affectors[a]);
+		arraySystem->addAffector(affectors[a]);
+	}
+
+	NullRenderer* listRenderer = static_cast<NullRenderer*>(listSystem->getRenderer());
+	NullRenderer* arrayRenderer = static_cast<NullRenderer*>(arraySystem->getRenderer());
+	size_t listResized = listRenderer->resizedCount;
+	size_t arrayResized = arrayRenderer->resizedCount;
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		listSystem->_update(0.05f);
+		arraySystem->_update(0.05f);
+	}
+
+	// Affectors on arrays notify the renderer once per update, not per particle
+	CPPUNIT_ASSERT_EQUAL((size_t)10, arrayRenderer->resizedCount - arrayResized);
+	CPPUNIT_ASSERT(listRenderer->resizedCount - listResized > 1000);
+
+	CPPUNIT_ASSERT(listSystem->getNumParticles() < count);
+	CPPUNIT_ASSERT_EQUAL(listSystem->getNumParticles(), arraySystem->getNumParticles());
+	for (size_t i = 0; i < listSystem->getNumParticles(); ++i)
+	{
+		Particle* expected = listSystem->getParticle(i);
+		Particle* actual = arraySystem->getParticle(i);
+		CPPUNIT_ASSERT(expected->position.positionEquals(actual->position, 1e-3));
+		CPPUNIT_ASSERT(expected->direction.positionEquals(actual->direction, 1e-4));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->colour.r, actual->colour.r, 1e-5);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->colour.a, actual->colour.a, 1e-5);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->rotation.valueRadians(), actual->rotation.valueRadians(), 1e-5);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->timeToLive, actual->timeToLive, 1e-5);
+		CPPUNIT_ASSERT(actual->hasOwnDimensions());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->getOwnWidth(), actual->getOwnWidth(), 1e-4);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->getOwnHeight(), actual->getOwnHeight(), 1e-4);
+	}
+
+	mSceneMgr->destroyParticleSystem(listSystem);
+	mSceneMgr->destroyParticleSystem(arraySystem);
+}
+
+void ParticleSystemTests::testParticleArraysPerformance()
+{
+	const size_t count = 1000000;
+	const int updates = 5;
+	ParticleSystem* ps = createSystem("Benchmark", count, 7);
+	ps->addAffector("TestForce");
+	ps->addAffector("TestFader");
+	ps->addAffector("TestScale");
+	ps->addAffector("TestRotator");
+
+	Timer timer;
+	double perParticle[2];
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		ps->setParticleArraysEnabled(mode != 0);
+		// Short updates, so that no particles expire
+		ps->_update(0.001f);
+		timer.reset();
+		for (int i = 0; i < updates; ++i)
+			ps->_update(0.001f);
+		perParticle[mode] = timer.getMicroseconds() * 1000.0 / (double(count) * updates);
+	}
+	CPPUNIT_ASSERT_EQUAL(count, ps->getNumParticles());
+
+	std::cout << std::endl << "Particle update with 4 affectors, ns per particle: "
+		<< perParticle[0] << " with lists, " << perParticle[1] << " with arrays" << std::endl;
+
+	mSceneMgr->destroyParticleSystem(ps);
+}
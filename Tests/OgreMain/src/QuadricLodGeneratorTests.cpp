@@ -0,0 +1,427 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "QuadricLodGeneratorTests.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshManager.h"
+#include "OgreQuadricLodGenerator.h"
+#include "OgreProgressiveMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreTimer.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( QuadricLodGeneratorTests );
+
+namespace
+{
+	typedef vector<uint32>::type IndexList;
+	typedef vector<Vector3>::type PositionList;
+
+	IndexList readIndexes(const IndexData* indexData)
+	{
+		IndexList indexes(indexData->indexCount);
+		if (indexes.empty())
+			return indexes;
+		HardwareIndexBufferSharedPtr ibuf = indexData->indexBuffer;
+		void* p = ibuf->lock(HardwareBuffer::HBL_READ_ONLY);
+		for (size_t i = 0; i < indexes.size(); ++i)
+		{
+			indexes[i] = ibuf->getType() == HardwareIndexBuffer::IT_32BIT ?
+				static_cast<uint32*>(p)[indexData->indexStart + i] :
+				static_cast<uint16*>(p)[indexData->indexStart + i];
+		}
+		ibuf->unlock();
+		return indexes;
+	}
+
+	PositionList readPositions(const VertexData* vertexData)
+	{
+		const VertexElement* elem =
+			vertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+		HardwareVertexBufferSharedPtr vbuf = vertexData->vertexBufferBinding->getBuffer(elem->getSource());
+		PositionList positions(vertexData->vertexCount);
+		uchar* vertex = static_cast<uchar*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+		float* pFloat;
+		for (size_t v = 0; v < positions.size(); ++v, vertex += vbuf->getVertexSize())
+		{
+			elem->baseVertexPointerToElement(vertex, &pFloat);
+			positions[v] = Vector3(pFloat[0], pFloat[1], pFloat[2]);
+		}
+		vbuf->unlock();
+		return positions;
+	}
+
+	/// Distance from a point to a triangle
+	Real pointTriangleDistance(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c)
+	{
+		Vector3 n = (b - a).crossProduct(c - a);
+		Real len = n.length();
+		if (len > 1e-12f)
+		{
+			// Inside the prism of the triangle, the distance is to the plane
+			n /= len;
+			if (n.dotProduct((b - a).crossProduct(p - a)) >= 0 &&
+				n.dotProduct((c - b).crossProduct(p - b)) >= 0 &&
+				n.dotProduct((a - c).crossProduct(p - c)) >= 0)
+			{
+				return Math::Abs(n.dotProduct(p - a));
+			}
+		}
+		// Otherwise it is to the nearest edge
+		Real best = Math::POS_INFINITY;
+		const Vector3* corners[4] = { &a, &b, &c, &a };
+		for (size_t e = 0; e < 3; ++e)
+		{
+			Vector3 d = *corners[e + 1] - *corners[e];
+			Real t = d.squaredLength() > 0 ? (p - *corners[e]).dotProduct(d) / d.squaredLength() : 0;
+			t = std::max((Real)0, std::min((Real)1, t));
+			best = std::min(best, (p - (*corners[e] + d * t)).length());
+		}
+		return best;
+	}
+
+	/// Largest distance from the original vertices to a reduced level
+	Real maxDistance(const PositionList& positions, const IndexList& indexes)
+	{
+		Real worst = 0;
+		for (size_t v = 0; v < positions.size(); ++v)
+		{
+			Real best = Math::POS_INFINITY;
+			for (size_t i = 0; i < indexes.size(); i += 3)
+			{
+				best = std::min(best, pointTriangleDistance(positions[v],
+					positions[indexes[i]], positions[indexes[i + 1]], positions[indexes[i + 2]]));
+			}
+			worst = std::max(worst, best);
+		}
+		return worst;
+	}
+
+	void deleteLevels(ProgressiveMesh::LODFaceList& levels)
+	{
+		for (ProgressiveMesh::LODFaceList::iterator i = levels.begin(); i != levels.end(); ++i)
+			OGRE_DELETE *i;
+		levels.clear();
+	}
+}
+
+void QuadricLodGeneratorTests::setUp()
+{
+	mResourceGroupMgr = new ResourceGroupManager();
+	mLodStrategyMgr = new LodStrategyManager();
+	mBufMgr = new DefaultHardwareBufferManager();
+	mMeshMgr = new MeshManager();
+}
+
+void QuadricLodGeneratorTests::tearDown()
+{
+	delete mMeshMgr;
+	delete mBufMgr;
+	delete mLodStrategyMgr;
+	delete mResourceGroupMgr;
+}
+
+MeshPtr QuadricLodGeneratorTests::createSphere(const String& name, size_t rings, size_t segments, size_t submeshes)
+{
+	MeshPtr mesh = mMeshMgr->createManual(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+	const size_t vertexCount = (rings + 1) * (segments + 1);
+	VertexData* vertexData = OGRE_NEW VertexData();
+	vertexData->vertexCount = vertexCount;
+	VertexDeclaration* decl = vertexData->vertexDeclaration;
+	size_t offset = decl->addElement(0, 0, VET_FLOAT3, VES_POSITION).getSize();
+	offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+	decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES);
+
+	HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+		decl->getVertexSize(0), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+	for (size_t r = 0; r <= rings; ++r)
+	{
+		Real phi = Math::PI * r / rings;
+		for (size_t s = 0; s <= segments; ++s)
+		{
+			Real theta = Math::TWO_PI * s / segments;
+			Vector3 n(Math::Sin(phi) * Math::Cos(theta), Math::Cos(phi), Math::Sin(phi) * Math::Sin(theta));
+			*pFloat++ = n.x; *pFloat++ = n.y; *pFloat++ = n.z;
+			*pFloat++ = n.x; *pFloat++ = n.y; *pFloat++ = n.z;
+			*pFloat++ = (float)s / segments;
+			*pFloat++ = (float)r / rings;
+		}
+	}
+	vbuf->unlock();
+	vertexData->vertexBufferBinding->setBinding(0, vbuf);
+	mesh->sharedVertexData = vertexData;
+
+	// Each submesh takes a band of rings, leaving out the degenerate
+	// triangles at the poles
+	for (size_t sub = 0; sub < submeshes; ++sub)
+	{
+		IndexList indexes;
+		for (size_t r = rings * sub / submeshes; r < rings * (sub + 1) / submeshes; ++r)
+		{
+			for (size_t s = 0; s < segments; ++s)
+			{
+				uint32 v = (uint32)(r * (segments + 1) + s);
+				uint32 below = v + (uint32)segments + 1;
+				if (r > 0)
+				{
+					indexes.push_back(v);
+					indexes.push_back(v + 1);
+					indexes.push_back(below);
+				}
+				if (r + 1 < rings)
+				{
+					indexes.push_back(v + 1);
+					indexes.push_back(below + 1);
+					indexes.push_back(below);
+				}
+			}
+		}
+
+		SubMesh* subMesh = mesh->createSubMesh();
+		subMesh->useSharedVertices = true;
+		HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
+			HardwareIndexBuffer::IT_32BIT, indexes.size(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		ibuf->writeData(0, ibuf->getSizeInBytes(), &indexes[0], true);
+		subMesh->indexData->indexBuffer = ibuf;
+		subMesh->indexData->indexCount = indexes.size();
+	}
+	mesh->_setBounds(AxisAlignedBox(-1, -1, -1, 1, 1, 1));
+	mesh->_setBoundingSphereRadius(1);
+	return mesh;
+}
+
+MeshPtr QuadricLodGeneratorTests::createSplitGrid(const String& name, size_t size)
+{
+	MeshPtr mesh = mMeshMgr->createManual(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+	// The left half takes columns [0, half], the right half [half, size),
+	// so the middle column is held twice
+	const size_t half = size / 2;
+	const size_t leftCount = (half + 1) * size;
+	const size_t vertexCount = leftCount + (size - half) * size;
+	VertexData* vertexData = OGRE_NEW VertexData();
+	vertexData->vertexCount = vertexCount;
+	VertexDeclaration* decl = vertexData->vertexDeclaration;
+	size_t offset = decl->addElement(0, 0, VET_FLOAT3, VES_POSITION).getSize();
+	decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES);
+
+	HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+		decl->getVertexSize(0), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+	for (size_t side = 0; side < 2; ++side)
+	{
+		size_t first = side ? half : 0, last = side ? size - 1 : half;
+		for (size_t y = 0; y < size; ++y)
+		{
+			for (size_t x = first; x <= last; ++x)
+			{
+				*pFloat++ = (float)x; *pFloat++ = (float)y; *pFloat++ = 0;
+				*pFloat++ = side * 10.0f + x * 0.1f; *pFloat++ = y * 0.1f;
+			}
+		}
+	}
+	vbuf->unlock();
+	vertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+	IndexList indexes;
+	for (size_t side = 0; side < 2; ++side)
+	{
+		size_t first = side ? half : 0, last = side ? size - 1 : half;
+		size_t width = last - first + 1;
+		uint32 base = side ? (uint32)leftCount : 0;
+		for (size_t y = 0; y + 1 < size; ++y)
+		{
+			for (size_t x = 0; x + 1 < width; ++x)
+			{
+				uint32 v = base + (uint32)(y * width + x);
+				indexes.push_back(v);
+				indexes.push_back(v + 1);
+				indexes.push_back(v + (uint32)width);
+				indexes.push_back(v + 1);
+				indexes.push_back(v + (uint32)width + 1);
+				indexes.push_back(v + (uint32)width);
+			}
+		}
+	}
+
+	SubMesh* sub = mesh->createSubMesh();
+	sub->useSharedVertices = false;
+	sub->vertexData = vertexData;
+	HardwareIndexBufferSharedPtr ibuf = HardwareBufferManager::getSingleton().createIndexBuffer(
+		HardwareIndexBuffer::IT_32BIT, indexes.size(), HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+	ibuf->writeData(0, ibuf->getSizeInBytes(), &indexes[0], true);
+	sub->indexData->indexBuffer = ibuf;
+	sub->indexData->indexCount = indexes.size();
+	mesh->_setBounds(AxisAlignedBox(0, 0, 0, (Real)size, (Real)size, 0));
+	return mesh;
+}
+
+void QuadricLodGeneratorTests::testGenerateLodLevels()
+{
+	MeshPtr mesh = createSphere("Sphere", 24, 48, 3);
+	Mesh::LodValueList values;
+	values.push_back(100);
+	values.push_back(200);
+	values.push_back(300);
+	mesh->generateLodLevels(values, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+
+	CPPUNIT_ASSERT_EQUAL((ushort)4, mesh->getNumLodLevels());
+	const size_t vertexCount = mesh->sharedVertexData->vertexCount;
+	for (unsigned short s = 0; s < mesh->getNumSubMeshes(); ++s)
+	{
+		SubMesh* sub = mesh->getSubMesh(s);
+		CPPUNIT_ASSERT_EQUAL((size_t)3, sub->mLodFaceList.size());
+		size_t previous = sub->indexData->indexCount;
+		for (size_t l = 0; l < sub->mLodFaceList.size(); ++l)
+		{
+			// Each level is coarser than the last, but still has a surface
+			IndexList indexes = readIndexes(sub->mLodFaceList[l]);
+			CPPUNIT_ASSERT(indexes.size() % 3 == 0);
+			CPPUNIT_ASSERT(indexes.size() < previous);
+			CPPUNIT_ASSERT(!indexes.empty());
+			previous = indexes.size();
+			for (size_t i = 0; i < indexes.size(); i += 3)
+			{
+				CPPUNIT_ASSERT(indexes[i] < vertexCount);
+				CPPUNIT_ASSERT(indexes[i + 1] < vertexCount);
+				CPPUNIT_ASSERT(indexes[i + 2] < vertexCount);
+				CPPUNIT_ASSERT(indexes[i] != indexes[i + 1] &&
+					indexes[i + 1] != indexes[i + 2] && indexes[i] != indexes[i + 2]);
+			}
+		}
+	}
+}
+
+void QuadricLodGeneratorTests::testBordersAndSeamsKept()
+{
+	const size_t size = 16, half = size / 2;
+	const uint32 leftCount = (uint32)((half + 1) * size);
+	MeshPtr mesh = createSplitGrid("Grid", size);
+	SubMesh* sub = mesh->getSubMesh(0);
+	PositionList positions = readPositions(sub->vertexData);
+
+	QuadricLodGenerator generator(sub->vertexData, sub->indexData);
+	ProgressiveMesh::LODFaceList levels;
+	generator.build(3, &levels, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, levels.size());
+
+	for (size_t l = 0; l < levels.size(); ++l)
+	{
+		IndexList indexes = readIndexes(levels[l]);
+		CPPUNIT_ASSERT(indexes.size() < sub->indexData->indexCount);
+		Real leftArea = 0, rightArea = 0;
+		for (size_t i = 0; i < indexes.size(); i += 3)
+		{
+			// Triangles stay on one side of the seam
+			bool left = indexes[i] < leftCount;
+			CPPUNIT_ASSERT_EQUAL(left, indexes[i + 1] < leftCount);
+			CPPUNIT_ASSERT_EQUAL(left, indexes[i + 2] < leftCount);
+
+			// and face the same way
+			Vector3 n = (positions[indexes[i + 1]] - positions[indexes[i]]).crossProduct(
+				positions[indexes[i + 2]] - positions[indexes[i]]);
+			CPPUNIT_ASSERT(n.z > 0);
+			(left ? leftArea : rightArea) += n.z * 0.5f;
+		}
+		// If the outline and the seam are kept, both halves are still covered
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((Real)(half * (size - 1)), leftArea, 1e-3);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL((Real)((size - 1 - half) * (size - 1)), rightArea, 1e-3);
+	}
+	deleteLevels(levels);
+}
+
+void QuadricLodGeneratorTests::testQuality()
+{
+	MeshPtr mesh = createSphere("Sphere", 48, 96);
+	SubMesh* sub = mesh->getSubMesh(0);
+	PositionList positions = readPositions(mesh->sharedVertexData);
+
+	ProgressiveMesh::LODFaceList pmLevels;
+	ProgressiveMesh pm(mesh->sharedVertexData, sub->indexData);
+	pm.build(2, &pmLevels, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+
+	ProgressiveMesh::LODFaceList quadricLevels;
+	QuadricLodGenerator generator(mesh->sharedVertexData, sub->indexData);
+	generator.build(2, &quadricLevels, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+
+	for (size_t l = 0; l < 2; ++l)
+	{
+		IndexList pmIndexes = readIndexes(pmLevels[l]);
+		IndexList quadricIndexes = readIndexes(quadricLevels[l]);
+
+		// Removing as many vertices leaves about as many triangles; the
+		// seams and poles are kept more carefully, but the error is lower
+		CPPUNIT_ASSERT(quadricIndexes.size() * 10 <= pmIndexes.size() * 11);
+		CPPUNIT_ASSERT(maxDistance(positions, quadricIndexes) <= maxDistance(positions, pmIndexes));
+	}
+
+	deleteLevels(pmLevels);
+	deleteLevels(quadricLevels);
+}
+
+void QuadricLodGeneratorTests::testQualityAndPerformance()
+{
+	MeshPtr mesh = createSphere("Sphere", 48, 96);
+	SubMesh* sub = mesh->getSubMesh(0);
+	PositionList positions = readPositions(mesh->sharedVertexData);
+	Timer timer;
+
+	ProgressiveMesh::LODFaceList pmLevels;
+	timer.reset();
+	ProgressiveMesh pm(mesh->sharedVertexData, sub->indexData);
+	pm.build(2, &pmLevels, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+	unsigned long pmTime = timer.getMicroseconds();
+
+	ProgressiveMesh::LODFaceList quadricLevels;
+	timer.reset();
+	QuadricLodGenerator generator(mesh->sharedVertexData, sub->indexData);
+	generator.build(2, &quadricLevels, ProgressiveMesh::VRQ_PROPORTIONAL, 0.5f);
+	unsigned long quadricTime = timer.getMicroseconds();
+
+	std::cout << "\nSphere of " << sub->indexData->indexCount / 3 << " triangles:";
+	for (size_t l = 0; l < 2; ++l)
+	{
+		IndexList pmIndexes = readIndexes(pmLevels[l]);
+		IndexList quadricIndexes = readIndexes(quadricLevels[l]);
+		Real pmError = maxDistance(positions, pmIndexes);
+		Real quadricError = maxDistance(positions, quadricIndexes);
+		std::cout << "\n  level " << l + 1 << ": ProgressiveMesh " << pmIndexes.size() / 3
+			<< " triangles, max error " << pmError << "; QuadricLodGenerator "
+			<< quadricIndexes.size() / 3 << " triangles, max error " << quadricError;
+	}
+	std::cout << "\n  build time: ProgressiveMesh " << pmTime / 1000.0 << "ms, QuadricLodGenerator "
+		<< quadricTime / 1000.0 << "ms" << std::endl;
+
+	deleteLevels(pmLevels);
+	deleteLevels(quadricLevels);
+}
@@ -61,6 +61,16 @@ public:
 
 };
 
+class UnsignedInt64SortFunctor
+{
+public:
+	uint64 operator()(const uint64& p) const
+	{
+		return p;
+	}
+
+};
+
 class UnsignedIntSortFunctor
 {
 public:
@@ -200,5 +210,27 @@ void RadixSortTests::testIntVector()
 		lastValue = *v;
 	}
 }
+void RadixSortTests::testUnsignedInt64Vector()
+{
+	std::vector<uint64> container;
+	UnsignedInt64SortFunctor func;
+	RadixSort<std::vector<uint64>, uint64, uint64> sorter;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		// Only a few distinct high words, like packed sort keys
+		uint64 high = (uint64)Math::RangeRandom(0, 8);
+		uint64 low = (uint64)Math::RangeRandom(0, 1e9);
+		container.push_back((high << 40) | low);
+	}
 
+	sorter.sort(container, func);
 
+	std::vector<uint64>::iterator v = container.begin();
+	uint64 lastValue = *v++;
+	for (;v != container.end(); ++v)
+	{
+		CPPUNIT_ASSERT(*v >= lastValue);
+		lastValue = *v;
+	}
+}
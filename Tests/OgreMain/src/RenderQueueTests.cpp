@@ -0,0 +1,214 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "RenderQueueTests.h"
+#include "OgreRenderQueueSortingGrouping.h"
+#include "OgreRenderable.h"
+#include "OgreMath.h"
+#include "OgreTimer.h"
+#include <map>
+
+using namespace Ogre;
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( RenderQueueTests );
+
+/// Renderable at a fixed view depth
+class DepthRenderable : public Renderable
+{
+public:
+	Real depth;
+
+	DepthRenderable() : depth(0) {}
+	const MaterialPtr& getMaterial(void) const { return msMaterial; }
+	void getRenderOperation(RenderOperation& op) { (void)op; }
+	void getWorldTransforms(Matrix4* xform) const { *xform = Matrix4::IDENTITY; }
+	Real getSquaredViewDepth(const Camera* cam) const { (void)cam; return depth; }
+	const LightList& getLights(void) const { return msLights; }
+
+	static MaterialPtr msMaterial;
+	static LightList msLights;
+};
+MaterialPtr DepthRenderable::msMaterial;
+LightList DepthRenderable::msLights;
+
+/// Records what a collection visits
+class RecordingVisitor : public QueuedRenderableVisitor
+{
+public:
+	typedef std::vector<std::pair<const Pass*, Renderable*> > VisitList;
+	VisitList visits;
+	size_t passVisits;
+	const Pass* currentPass;
+
+	RecordingVisitor() : passVisits(0), currentPass(0) {}
+	void visit(RenderablePass* rp) { visits.push_back(std::make_pair(rp->pass, rp->renderable)); }
+	bool visit(const Pass* p) { ++passVisits; currentPass = p; return true; }
+	void visit(Renderable* r) { visits.push_back(std::make_pair(currentPass, r)); }
+};
+
+/// Visitor which touches every item, so that visiting isn't optimised away
+class CountingVisitor : public QueuedRenderableVisitor
+{
+public:
+	size_t count;
+
+	CountingVisitor() : count(0) {}
+	void visit(RenderablePass* rp) { (void)rp; ++count; }
+	bool visit(const Pass* p) { (void)p; return true; }
+	void visit(Renderable* r) { (void)r; ++count; }
+};
+
+//--------------------------------------------------------------------------
+void RenderQueueTests::setUp()
+{
+	// Passes with the same index have the same hash, since none have textures
+	for (unsigned short i = 0; i < 40; ++i)
+		mPasses.push_back(OGRE_NEW Pass(0, i % 16));
+}
+//--------------------------------------------------------------------------
+void RenderQueueTests::tearDown()
+{
+	for (PassList::iterator i = mPasses.begin(); i != mPasses.end(); ++i)
+		OGRE_DELETE *i;
+	mPasses.clear();
+}
+//--------------------------------------------------------------------------
+void RenderQueueTests::testSortKeyMatchesPassGroup()
+{
+	const size_t count = 5000;
+	std::vector<DepthRenderable> rends(count);
+	std::map<Renderable*, const Pass*> passOf;
+
+	QueuedRenderableCollection grouped, keyed;
+	grouped.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+	keyed.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEY);
+	for (size_t i = 0; i < count; ++i)
+	{
+		rends[i].depth = Math::RangeRandom(0, 10000);
+		Pass* pass = mPasses[(size_t)Math::RangeRandom(0, (Real)mPasses.size() - 0.01f)];
+		passOf[&rends[i]] = pass;
+		grouped.addRenderable(pass, &rends[i]);
+		keyed.addRenderable(pass, &rends[i]);
+	}
+	grouped.sort(0);
+	keyed.sort(0);
+
+	RecordingVisitor groupedVisitor, keyedVisitor;
+	grouped.acceptVisitor(&groupedVisitor, QueuedRenderableCollection::OM_PASS_GROUP);
+	// OM_PASS_GROUP isn't available, so OM_SORT_KEY should be used in its place
+	keyed.acceptVisitor(&keyedVisitor, QueuedRenderableCollection::OM_PASS_GROUP);
+
+	// Every renderable is visited under its own pass, in order of hash;
+	// passes with the same hash may be in a different order. The key only 
+	// holds part of the pass pointer, so passes whose hashes and folded 
+	// pointers both collide can interleave and be visited more than once.
+	CPPUNIT_ASSERT(keyedVisitor.passVisits >= groupedVisitor.passVisits);
+	CPPUNIT_ASSERT_EQUAL(count, keyedVisitor.visits.size());
+	for (size_t i = 0; i < count; ++i)
+	{
+		CPPUNIT_ASSERT(keyedVisitor.visits[i].first == passOf[keyedVisitor.visits[i].second]);
+		CPPUNIT_ASSERT_EQUAL(groupedVisitor.visits[i].first->getHash(), 
+			keyedVisitor.visits[i].first->getHash());
+	}
+
+	// Each group holds the same renderables, front to back
+	RecordingVisitor::VisitList groupedSorted = groupedVisitor.visits;
+	RecordingVisitor::VisitList keyedSorted = keyedVisitor.visits;
+	std::sort(groupedSorted.begin(), groupedSorted.end());
+	std::sort(keyedSorted.begin(), keyedSorted.end());
+	CPPUNIT_ASSERT(groupedSorted == keyedSorted);
+	for (size_t i = 1; i < count; ++i)
+	{
+		const RecordingVisitor::VisitList::value_type& prev = keyedVisitor.visits[i - 1];
+		const RecordingVisitor::VisitList::value_type& cur = keyedVisitor.visits[i];
+		if (prev.first == cur.first)
+		{
+			CPPUNIT_ASSERT(QueuedRenderableCollection::getSortKey(prev.first, prev.second->getSquaredViewDepth(0)) <=
+				QueuedRenderableCollection::getSortKey(cur.first, cur.second->getSquaredViewDepth(0)));
+		}
+	}
+
+	// Merging keeps the items of both collections
+	QueuedRenderableCollection merged;
+	merged.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEY);
+	merged.merge(keyed);
+	merged.merge(keyed);
+	merged.sort(0);
+	CountingVisitor counter;
+	merged.acceptVisitor(&counter, QueuedRenderableCollection::OM_SORT_KEY);
+	CPPUNIT_ASSERT_EQUAL(count * 2, counter.count);
+
+	keyed.clear();
+	counter.count = 0;
+	keyed.acceptVisitor(&counter, QueuedRenderableCollection::OM_SORT_KEY);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, counter.count);
+}
+//--------------------------------------------------------------------------
+void RenderQueueTests::testSortKeyPerformance()
+{
+	const size_t count = 100000;
+	const int frames = 5;
+
+	// A scene with many materials, which is where the pass map is slowest
+	while (mPasses.size() < 1000)
+		mPasses.push_back(OGRE_NEW Pass(0, (unsigned short)(mPasses.size() % 16)));
+
+	std::vector<DepthRenderable> rends(count);
+	std::vector<Pass*> passes(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		rends[i].depth = Math::RangeRandom(0, 10000);
+		passes[i] = mPasses[(size_t)Math::RangeRandom(0, (Real)mPasses.size() - 0.01f)];
+	}
+
+	QueuedRenderableCollection::OrganisationMode modes[2] = {
+		QueuedRenderableCollection::OM_PASS_GROUP, QueuedRenderableCollection::OM_SORT_KEY };
+	unsigned long times[2];
+	for (int m = 0; m < 2; ++m)
+	{
+		QueuedRenderableCollection collection;
+		collection.addOrganisationMode(modes[m]);
+		CountingVisitor counter;
+
+		Timer timer;
+		for (int f = 0; f < frames; ++f)
+		{
+			collection.clear();
+			for (size_t i = 0; i < count; ++i)
+				collection.addRenderable(passes[i], &rends[i]);
+			collection.sort(0);
+			collection.acceptVisitor(&counter, modes[m]);
+		}
+		times[m] = timer.getMicroseconds() / frames;
+		CPPUNIT_ASSERT_EQUAL(count * frames, counter.count);
+	}
+
+	std::cout << std::endl << "Queueing " << count << " renderables with " << mPasses.size() 
+		<< " passes, ms per frame: pass groups "
+		<< times[0] / 1000.0 << ", sort keys " << times[1] / 1000.0 << std::endl;
+}
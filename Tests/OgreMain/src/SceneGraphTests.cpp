@@ -0,0 +1,407 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SceneGraphTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreMovableObject.h"
+#include "OgreCamera.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( SceneGraphTests );
+
+namespace
+{
+	/// Minimal object with fixed bounds, so that nodes have world bounds to merge
+	class BoxObject : public MovableObject
+	{
+	protected:
+		AxisAlignedBox mBox;
+	public:
+		BoxObject(const String& name)
+			: MovableObject(name), mBox(-1, -1, -1, 1, 1, 1) {}
+
+		const String& getMovableType(void) const
+		{
+			static String type = "TestBox";
+			return type;
+		}
+		const AxisAlignedBox& getBoundingBox(void) const { return mBox; }
+		Real getBoundingRadius(void) const { return Math::Sqrt(3); }
+		void _updateRenderQueue(RenderQueue* queue)
+		{
+			(void)queue;
+			if (msQueued)
+				msQueued->push_back(this);
+		}
+		void visitRenderables(Renderable::Visitor* visitor, bool debugRenderables)
+		{ (void)visitor; (void)debugRenderables; }
+
+		/// If set, boxes add themselves to this list when they are queued for rendering
+		static vector<BoxObject*>::type* msQueued;
+	};
+	vector<BoxObject*>::type* BoxObject::msQueued = 0;
+	typedef vector<BoxObject*>::type BoxList;
+	typedef vector<SceneNode*>::type NodeList;
+
+	/// Build a tree of scene nodes, each with up to 8 children and a box attached
+	void buildScene(SceneManager* sm, size_t nodeCount, uint32 seed, NodeList& nodes, BoxList& boxes)
+	{
+		TestRandom rnd(seed);
+		nodes.push_back(sm->getRootSceneNode());
+		for (size_t i = 0; i < nodeCount; ++i)
+		{
+			SceneNode* parent = nodes[i / 8];
+			SceneNode* node = parent->createChildSceneNode(
+				Vector3(rnd.next(-10, 10), rnd.next(-10, 10), rnd.next(-10, 10)),
+				Quaternion(Degree(rnd.next(0, 360)), Vector3::UNIT_Y));
+			BoxObject* box = OGRE_NEW BoxObject(StringConverter::toString(i));
+			node->attachObject(box);
+			nodes.push_back(node);
+			boxes.push_back(box);
+		}
+	}
+
+	void destroyScene(Root* root, SceneManager* sm, BoxList& boxes)
+	{
+		root->destroySceneManager(sm);
+		for (BoxList::iterator i = boxes.begin(); i != boxes.end(); ++i)
+			OGRE_DELETE *i;
+		boxes.clear();
+	}
+
+	/// Time updates of the whole graph, in milliseconds per update
+	double timeUpdates(SceneManager* sm, size_t updates)
+	{
+		SceneNode* root = sm->getRootSceneNode();
+		Timer timer;
+		for (size_t i = 0; i < updates; ++i)
+		{
+			// moving the top level nodes means everything below needs updating
+			SceneNode::ChildNodeIterator it = root->getChildIterator();
+			while (it.hasMoreElements())
+				it.getNext()->translate(Vector3::UNIT_X);
+			sm->_updateSceneGraph(0);
+		}
+		return (double)timer.getMicroseconds() / 1000.0 / (double)updates;
+	}
+}
+
+void SceneGraphTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+}
+void SceneGraphTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+void SceneGraphTests::testParallelUpdateMatchesSerial()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("SceneGraphTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+
+	SceneManager* serialSM = mRoot->createSceneManager(ST_GENERIC, "Serial");
+	SceneManager* parallelSM = mRoot->createSceneManager(ST_GENERIC, "Parallel");
+	parallelSM->setParallelSceneGraphUpdate(true);
+	parallelSM->setParallelSceneGraphUpdateThreshold(0);
+	// use several threads even if the hardware doesn't have them
+	parallelSM->getParallelDispatcher()->setConcurrency(4);
+
+	NodeList serialNodes, parallelNodes;
+	BoxList serialBoxes, parallelBoxes;
+	const size_t nodeCount = 5000;
+	buildScene(serialSM, nodeCount, 1234, serialNodes, serialBoxes);
+	buildScene(parallelSM, nodeCount, 1234, parallelNodes, parallelBoxes);
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+		{
+			// move a few nodes, so that only some branches need updating
+			for (size_t i = 1; i < serialNodes.size(); i += 97)
+			{
+				serialNodes[i]->translate(Vector3(1, 2, 3));
+				parallelNodes[i]->translate(Vector3(1, 2, 3));
+				serialNodes[i]->yaw(Degree(10));
+				parallelNodes[i]->yaw(Degree(10));
+			}
+		}
+
+		serialSM->_updateSceneGraph(0);
+		parallelSM->_updateSceneGraph(0);
+
+		for (size_t i = 0; i < serialNodes.size(); ++i)
+		{
+			CPPUNIT_ASSERT(serialNodes[i]->_getDerivedPosition() == parallelNodes[i]->_getDerivedPosition());
+			CPPUNIT_ASSERT(serialNodes[i]->_getDerivedOrientation() == parallelNodes[i]->_getDerivedOrientation());
+			const AxisAlignedBox& serialBox = serialNodes[i]->_getWorldAABB();
+			const AxisAlignedBox& parallelBox = parallelNodes[i]->_getWorldAABB();
+			CPPUNIT_ASSERT(!parallelBox.isNull());
+			CPPUNIT_ASSERT(serialBox.getMinimum() == parallelBox.getMinimum());
+			CPPUNIT_ASSERT(serialBox.getMaximum() == parallelBox.getMaximum());
+		}
+	}
+
+	destroyScene(mRoot, serialSM, serialBoxes);
+	destroyScene(mRoot, parallelSM, parallelBoxes);
+}
+
+void SceneGraphTests::testParallelUpdateScaling()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("SceneGraphTests");
+	mRoot->setWorkQueue(q);
+
+	const size_t nodeCounts[] = { 10000, 50000 };
+	const size_t threadCounts[] = { 2, 4, 8 };
+	const size_t updates = 10;
+
+	for (size_t n = 0; n < sizeof(nodeCounts) / sizeof(nodeCounts[0]); ++n)
+	{
+		SceneManager* sm = mRoot->createSceneManager(ST_GENERIC);
+		NodeList nodes;
+		BoxList boxes;
+		buildScene(sm, nodeCounts[n], 42, nodes, boxes);
+		sm->setParallelSceneGraphUpdateThreshold(0);
+
+		sm->setParallelSceneGraphUpdate(false);
+		std::cout << std::endl << "Scene graph update, " << nodeCounts[n] << " nodes: serial "
+			<< timeUpdates(sm, updates) << "ms";
+
+		sm->setParallelSceneGraphUpdate(true);
+		for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+		{
+			// the calling thread works too, so one less worker is needed
+			q->setWorkerThreadCount(threadCounts[t] - 1);
+			q->startup();
+			sm->getParallelDispatcher()->setConcurrency(threadCounts[t]);
+			std::cout << ", " << threadCounts[t] << " threads " << timeUpdates(sm, updates) << "ms";
+		}
+		sm->setParallelSceneGraphUpdate(false);
+		sm->setTransformPoolEnabled(true);
+		std::cout << ", transform pool " << timeUpdates(sm, updates) << "ms";
+		std::cout << std::endl;
+
+		destroyScene(mRoot, sm, boxes);
+	}
+}
+
+void SceneGraphTests::testTransformPoolMatchesSerial()
+{
+	SceneManager* serialSM = mRoot->createSceneManager(ST_GENERIC, "Serial");
+	SceneManager* poolSM = mRoot->createSceneManager(ST_GENERIC, "Pool");
+	poolSM->setTransformPoolEnabled(true);
+
+	NodeList serialNodes, poolNodes;
+	BoxList serialBoxes, poolBoxes;
+	const size_t nodeCount = 5000;
+	buildScene(serialSM, nodeCount, 1234, serialNodes, serialBoxes);
+	buildScene(poolSM, nodeCount, 1234, poolNodes, poolBoxes);
+	for (size_t i = 1; i < serialNodes.size(); i += 13)
+	{
+		serialNodes[i]->setScale(1, 2, 0.5);
+		poolNodes[i]->setScale(1, 2, 0.5);
+	}
+	for (size_t i = 5; i < serialNodes.size(); i += 31)
+	{
+		serialNodes[i]->setInheritOrientation(false);
+		poolNodes[i]->setInheritOrientation(false);
+		serialNodes[i + 1]->setInheritScale(false);
+		poolNodes[i + 1]->setInheritScale(false);
+	}
+
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		if (pass == 1)
+		{
+			// move a few nodes, so that only some branches need updating
+			for (size_t i = 1; i < serialNodes.size(); i += 97)
+			{
+				serialNodes[i]->translate(Vector3(1, 2, 3));
+				poolNodes[i]->translate(Vector3(1, 2, 3));
+				serialNodes[i]->yaw(Degree(10));
+				poolNodes[i]->yaw(Degree(10));
+			}
+		}
+		else if (pass == 2)
+		{
+			// change the structure of the graph
+			for (size_t i = 7; i < serialNodes.size(); i += 211)
+			{
+				serialNodes[i]->getParentSceneNode()->removeChild(serialNodes[i]);
+				serialNodes[i - 6]->addChild(serialNodes[i]);
+				poolNodes[i]->getParentSceneNode()->removeChild(poolNodes[i]);
+				poolNodes[i - 6]->addChild(poolNodes[i]);
+			}
+			// the old parents' bounds aren't updated by removing a child, and
+			// the pool recalculates everything after a change of structure
+			serialSM->getRootSceneNode()->needUpdate();
+		}
+
+		serialSM->_updateSceneGraph(0);
+		poolSM->_updateSceneGraph(0);
+
+		// the SSE kernel can differ from the scalar code in the last bit
+		const Real tolerance = 1e-4f;
+		for (size_t i = 0; i < serialNodes.size(); ++i)
+		{
+			CPPUNIT_ASSERT(serialNodes[i]->_getDerivedPosition().positionEquals(
+				poolNodes[i]->_getDerivedPosition(), tolerance));
+			const Quaternion& serialOrientation = serialNodes[i]->_getDerivedOrientation();
+			const Quaternion& poolOrientation = poolNodes[i]->_getDerivedOrientation();
+			CPPUNIT_ASSERT(Math::RealEqual(serialOrientation.w, poolOrientation.w, tolerance));
+			CPPUNIT_ASSERT(Math::RealEqual(serialOrientation.x, poolOrientation.x, tolerance));
+			CPPUNIT_ASSERT(Math::RealEqual(serialOrientation.y, poolOrientation.y, tolerance));
+			CPPUNIT_ASSERT(Math::RealEqual(serialOrientation.z, poolOrientation.z, tolerance));
+			CPPUNIT_ASSERT(serialNodes[i]->_getDerivedScale().positionEquals(
+				poolNodes[i]->_getDerivedScale(), tolerance));
+			const AxisAlignedBox& serialBox = serialNodes[i]->_getWorldAABB();
+			const AxisAlignedBox& poolBox = poolNodes[i]->_getWorldAABB();
+			CPPUNIT_ASSERT(!poolBox.isNull());
+			CPPUNIT_ASSERT(serialBox.getMinimum().positionEquals(poolBox.getMinimum(), tolerance));
+			CPPUNIT_ASSERT(serialBox.getMaximum().positionEquals(poolBox.getMaximum(), tolerance));
+		}
+	}
+
+	destroyScene(mRoot, serialSM, serialBoxes);
+	destroyScene(mRoot, poolSM, poolBoxes);
+}
+
+void SceneGraphTests::testParallelCullingMatchesSerial()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("SceneGraphTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+
+	// cameras need somewhere to put their debug geometry
+	HardwareBufferManager* bufMgr = new DefaultHardwareBufferManager();
+
+	SceneManager* sm = mRoot->createSceneManager(ST_GENERIC);
+	sm->setParallelCullingThreshold(0);
+	sm->getParallelDispatcher()->setConcurrency(4);
+	NodeList nodes;
+	BoxList boxes;
+	buildScene(sm, 20000, 1234, nodes, boxes);
+	sm->_updateSceneGraph(0);
+
+	// a camera which sees part of the scene, so that nodes are culled by
+	// the sides of the frustum and by the far plane
+	// the camera isn't registered with the scene manager, since that needs
+	// a render system to destroy it
+	Camera* cam = OGRE_NEW Camera("Cam", sm);
+	cam->setPosition(Vector3::ZERO);
+	cam->lookAt(Vector3(1, 0.2, -1));
+	cam->setNearClipDistance(1);
+	cam->setFarClipDistance(30);
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+			cam->setFarClipDistance(0);
+
+		BoxList serialQueued, parallelQueued;
+		VisibleObjectsBoundsInfo serialBounds, parallelBounds;
+
+		sm->setParallelCulling(false);
+		BoxObject::msQueued = &serialQueued;
+		sm->_findVisibleObjects(cam, &serialBounds, false);
+
+		sm->setParallelCulling(true);
+		BoxObject::msQueued = &parallelQueued;
+		sm->_findVisibleObjects(cam, &parallelBounds, false);
+		BoxObject::msQueued = 0;
+
+		// the same objects, in the same order
+		CPPUNIT_ASSERT(!serialQueued.empty());
+		CPPUNIT_ASSERT(serialQueued.size() < boxes.size());
+		CPPUNIT_ASSERT(serialQueued == parallelQueued);
+		CPPUNIT_ASSERT(serialBounds.aabb == parallelBounds.aabb);
+		CPPUNIT_ASSERT_EQUAL(serialBounds.minDistance, parallelBounds.minDistance);
+		CPPUNIT_ASSERT_EQUAL(serialBounds.maxDistance, parallelBounds.maxDistance);
+	}
+
+	OGRE_DELETE cam;
+	destroyScene(mRoot, sm, boxes);
+	delete bufMgr;
+}
+
+void SceneGraphTests::testParallelCullingSpeed()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("SceneGraphTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+
+	// cameras need somewhere to put their debug geometry
+	HardwareBufferManager* bufMgr = new DefaultHardwareBufferManager();
+
+	SceneManager* sm = mRoot->createSceneManager(ST_GENERIC);
+	sm->setParallelCullingThreshold(0);
+	sm->getParallelDispatcher()->setConcurrency(4);
+	NodeList nodes;
+	BoxList boxes;
+	buildScene(sm, 20000, 1234, nodes, boxes);
+	sm->_updateSceneGraph(0);
+
+	// everything in view
+	Camera* cam = OGRE_NEW Camera("Cam", sm);
+	cam->setNearClipDistance(1);
+	cam->setPosition(Vector3(0, 0, 200));
+	cam->lookAt(Vector3::ZERO);
+	const size_t runs = 10;
+	for (int parallel = 0; parallel < 2; ++parallel)
+	{
+		sm->setParallelCulling(parallel != 0);
+		Timer timer;
+		for (size_t i = 0; i < runs; ++i)
+		{
+			VisibleObjectsBoundsInfo bounds;
+			sm->getRenderQueue()->clear();
+			sm->_findVisibleObjects(cam, &bounds, false);
+		}
+		std::cout << (parallel ? ", parallel " : "\nFind visible objects, 20000 nodes: serial ")
+			<< (double)timer.getMicroseconds() / 1000.0 / (double)runs << "ms";
+	}
+	std::cout << std::endl;
+
+	OGRE_DELETE cam;
+	destroyScene(mRoot, sm, boxes);
+	delete bufMgr;
+}
@@ -0,0 +1,210 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptCacheTests.h"
+#include "OgreScriptCache.h"
+#include "OgreScriptLexer.h"
+#include "OgreScriptParser.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ScriptCacheTests );
+
+namespace
+{
+	const String SOURCE_NAME = "ScriptCacheTests.material";
+
+	/// A material script with the given number of materials
+	String makeScript(size_t numMaterials)
+	{
+		StringUtil::StrStreamType str;
+		str << "import * from \"base.material\"\n";
+		for (size_t i = 0; i < numMaterials; ++i)
+		{
+			str << "material Test/Material" << i << " : Base\n{\n"
+				<< "\ttechnique\n\t{\n\t\tpass\n\t\t{\n"
+				<< "\t\t\tambient 0.5 0.5 0.5 1\n"
+				<< "\t\t\tdiffuse " << (i % 10) * 0.1f << " 0.2 0.3 1\n"
+				<< "\t\t\tscene_blend alpha_blend\n"
+				<< "\t\t\ttexture_unit\n\t\t\t{\n"
+				<< "\t\t\t\ttexture \"texture" << i << ".png\"\n"
+				<< "\t\t\t\ttex_address_mode clamp // edges\n"
+				<< "\t\t\t\tset $scale " << i << "\n"
+				<< "\t\t\t}\n\t\t}\n\t}\n}\n";
+		}
+		return str.str();
+	}
+
+	ConcreteNodeListPtr parseScript(const String& script)
+	{
+		ScriptLexer lexer;
+		ScriptParser parser;
+		return parser.parse(lexer.tokenize(script, SOURCE_NAME));
+	}
+
+	void checkNodesEqual(const ConcreteNodeList& a, const ConcreteNodeList& b, const ConcreteNode* parent)
+	{
+		CPPUNIT_ASSERT_EQUAL(a.size(), b.size());
+		ConcreteNodeList::const_iterator i = a.begin(), j = b.begin();
+		for (; i != a.end(); ++i, ++j)
+		{
+			CPPUNIT_ASSERT_EQUAL((*i)->token, (*j)->token);
+			CPPUNIT_ASSERT_EQUAL((*i)->file, (*j)->file);
+			CPPUNIT_ASSERT_EQUAL((*i)->line, (*j)->line);
+			CPPUNIT_ASSERT_EQUAL((int)(*i)->type, (int)(*j)->type);
+			CPPUNIT_ASSERT((*j)->parent == parent);
+			checkNodesEqual((*i)->children, (*j)->children, j->get());
+		}
+	}
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::setUp()
+{
+	mLogManager = OGRE_NEW LogManager();
+	mLogManager->createLog("ScriptCacheTests.log", true, false, true);
+	mCache = OGRE_NEW ScriptCache("./");
+	mCache->remove(SOURCE_NAME);
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::tearDown()
+{
+	mCache->remove(SOURCE_NAME);
+	OGRE_DELETE mCache;
+	OGRE_DELETE mLogManager;
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::testCachedNodesMatchParsed()
+{
+	String script = makeScript(20);
+	ConcreteNodeListPtr parsed = parseScript(script);
+
+	CPPUNIT_ASSERT(mCache->load(script, SOURCE_NAME).isNull());
+	ConcreteNodeListPtr first = mCache->parse(script, SOURCE_NAME);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mCache->getNumHits());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mCache->getNumMisses());
+
+	ConcreteNodeListPtr cached = mCache->parse(script, SOURCE_NAME);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mCache->getNumHits());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mCache->getNumMisses());
+
+	checkNodesEqual(*parsed, *first, 0);
+	checkNodesEqual(*parsed, *cached, 0);
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::testChangedScriptMisses()
+{
+	String script = makeScript(5);
+	mCache->parse(script, SOURCE_NAME);
+
+	// same length, different contents
+	String edited = script;
+	size_t pos = edited.find("alpha_blend");
+	edited.replace(pos, 11, "add_blended");
+	CPPUNIT_ASSERT_EQUAL(script.size(), edited.size());
+	CPPUNIT_ASSERT(mCache->load(edited, SOURCE_NAME).isNull());
+
+	ConcreteNodeListPtr nodes = mCache->parse(edited, SOURCE_NAME);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mCache->getNumMisses());
+	checkNodesEqual(*parseScript(edited), *nodes, 0);
+
+	// the edited script replaced the old entry
+	CPPUNIT_ASSERT(mCache->load(script, SOURCE_NAME).isNull());
+	CPPUNIT_ASSERT(!mCache->load(edited, SOURCE_NAME).isNull());
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::testDamagedEntryIgnored()
+{
+	String script = makeScript(5);
+	ConcreteNodeListPtr nodes = parseScript(script);
+	mCache->parse(script, SOURCE_NAME);
+	CPPUNIT_ASSERT(!mCache->load(script, SOURCE_NAME).isNull());
+
+	FileSystemArchive arch("./", "FileSystem");
+	arch.load();
+	String fileName;
+	StringVectorPtr files = arch.find("*.scriptcache", false);
+	for (StringVector::iterator i = files->begin(); i != files->end(); ++i)
+	{
+		DataStreamPtr stream = arch.open(*i);
+		if (stream->getAsString().find(SOURCE_NAME) != String::npos)
+			fileName = *i;
+	}
+	CPPUNIT_ASSERT(!fileName.empty());
+	String contents = arch.open(fileName)->getAsString();
+
+	// cut the entry short, keeping the header
+	{
+		DataStreamPtr stream = arch.create(fileName);
+		stream->write(contents.data(), contents.size() / 2);
+	}
+	CPPUNIT_ASSERT(mCache->load(script, SOURCE_NAME).isNull());
+
+	// garbage in place of the entry
+	{
+		DataStreamPtr stream = arch.create(fileName);
+		String junk(64, '\xff');
+		stream->write(junk.data(), junk.size());
+	}
+	CPPUNIT_ASSERT(mCache->load(script, SOURCE_NAME).isNull());
+	checkNodesEqual(*nodes, *mCache->parse(script, SOURCE_NAME), 0);
+}
+//--------------------------------------------------------------------------
+void ScriptCacheTests::testCacheSpeed()
+{
+	const size_t numMaterials = 2000;
+	const int runs = 3;
+	String script = makeScript(numMaterials);
+	double parseTime = 0, storeTime = 0, loadTime = 0;
+
+	for (int r = 0; r < runs; ++r)
+	{
+		mCache->remove(SOURCE_NAME);
+		Timer timer;
+		parseScript(script);
+		parseTime += timer.getMicroseconds() / 1000.0;
+
+		timer.reset();
+		mCache->parse(script, SOURCE_NAME);
+		storeTime += timer.getMicroseconds() / 1000.0;
+
+		timer.reset();
+		ConcreteNodeListPtr nodes = mCache->parse(script, SOURCE_NAME);
+		loadTime += timer.getMicroseconds() / 1000.0;
+		CPPUNIT_ASSERT(!nodes.isNull());
+	}
+	CPPUNIT_ASSERT_EQUAL((size_t)runs, mCache->getNumHits());
+
+	std::cout << std::endl << "Script cache, " << numMaterials << " materials ("
+		<< script.size() / 1024 << "KB): lex and parse " << parseTime / runs
+		<< "ms, parse and store " << storeTime / runs
+		<< "ms, read from cache " << loadTime / runs << "ms" << std::endl;
+}
@@ -0,0 +1,325 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "StaticGeometryTests.h"
+#include "TestRandom.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreStaticGeometry.h"
+#include "OgreEntity.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMeshManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreSubMesh.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( StaticGeometryTests );
+
+namespace
+{
+	/** A grid of quads in the XY plane with positions, normals and texture
+		coordinates, and optionally tangents
+	*/
+	void createGridMesh(const String& name, const String& materialName, bool tangents)
+	{
+		const size_t size = 4;
+		MeshPtr mesh = MeshManager::getSingleton().createManual(name,
+			ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		SubMesh* sub = mesh->createSubMesh();
+		sub->setMaterialName(materialName);
+		sub->useSharedVertices = false;
+		sub->vertexData = OGRE_NEW VertexData();
+		sub->vertexData->vertexCount = (size + 1) * (size + 1);
+		VertexDeclaration* decl = sub->vertexData->vertexDeclaration;
+		size_t offset = 0;
+		offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+		offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+		if (tangents)
+			offset += decl->addElement(0, offset, VET_FLOAT3, VES_TANGENT).getSize();
+		offset += decl->addElement(0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES).getSize();
+		HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton()
+			.createVertexBuffer(offset, sub->vertexData->vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		float* pFloat = static_cast<float*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t y = 0; y <= size; ++y)
+		{
+			for (size_t x = 0; x <= size; ++x)
+			{
+				*pFloat++ = (float)x; *pFloat++ = (float)y; *pFloat++ = (float)((x * y) % 3);
+				Vector3 normal = Vector3((float)x - 2, (float)y - 2, 4).normalisedCopy();
+				*pFloat++ = normal.x; *pFloat++ = normal.y; *pFloat++ = normal.z;
+				if (tangents)
+				{
+					*pFloat++ = 1; *pFloat++ = 0; *pFloat++ = 0;
+				}
+				*pFloat++ = (float)x / size; *pFloat++ = (float)y / size;
+			}
+		}
+		vbuf->unlock();
+		sub->vertexData->vertexBufferBinding->setBinding(0, vbuf);
+
+		sub->indexData->indexCount = size * size * 6;
+		sub->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+			HardwareIndexBuffer::IT_16BIT, sub->indexData->indexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+		uint16* pIdx = static_cast<uint16*>(sub->indexData->indexBuffer->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t y = 0; y < size; ++y)
+		{
+			for (size_t x = 0; x < size; ++x)
+			{
+				uint16 v = (uint16)(y * (size + 1) + x);
+				*pIdx++ = v; *pIdx++ = v + 1; *pIdx++ = v + (uint16)size + 1;
+				*pIdx++ = v + 1; *pIdx++ = v + (uint16)size + 2; *pIdx++ = v + (uint16)size + 1;
+			}
+		}
+		sub->indexData->indexBuffer->unlock();
+
+		mesh->_setBounds(AxisAlignedBox(0, 0, 0, (Real)size, (Real)size, 2));
+		mesh->_setBoundingSphereRadius(Math::Sqrt(2) * size);
+		mesh->load();
+	}
+
+	/// Add copies of both test meshes to the geometry, spread over many regions
+	void fillGeometry(SceneManager* sm, StaticGeometry* geom, size_t count, uint32 seed)
+	{
+		Entity* ents[2] = {
+			sm->createEntity(geom->getName() + "/Plain", "StaticTestPlain"),
+			sm->createEntity(geom->getName() + "/Tangents", "StaticTestTangents") };
+		geom->setRegionDimensions(Vector3(100, 100, 100));
+		TestRandom rnd(seed);
+		for (size_t i = 0; i < count; ++i)
+		{
+			Vector3 pos(rnd.next(-400, 400), rnd.next(-400, 400), rnd.next(-400, 400));
+			Vector3 scale(rnd.next(0.5f, 3), rnd.next(0.5f, 3), rnd.next(0.5f, 3));
+			geom->addEntity(ents[i % 2], pos, rnd.nextRotation(), scale);
+		}
+	}
+
+	typedef vector<StaticGeometry::GeometryBucket*>::type BucketList;
+
+	/// All the geometry buckets built, in region order
+	BucketList getBuckets(StaticGeometry* geom)
+	{
+		BucketList buckets;
+		StaticGeometry::RegionIterator ri = geom->getRegionIterator();
+		while (ri.hasMoreElements())
+		{
+			StaticGeometry::Region::LODIterator li = ri.getNext()->getLODIterator();
+			while (li.hasMoreElements())
+			{
+				StaticGeometry::LODBucket::MaterialIterator mi = li.getNext()->getMaterialIterator();
+				while (mi.hasMoreElements())
+				{
+					StaticGeometry::MaterialBucket::GeometryIterator gi =
+						mi.getNext()->getGeometryIterator();
+					while (gi.hasMoreElements())
+						buckets.push_back(gi.getNext());
+				}
+			}
+		}
+		return buckets;
+	}
+
+	size_t getRegionCount(StaticGeometry* geom)
+	{
+		size_t count = 0;
+		StaticGeometry::RegionIterator ri = geom->getRegionIterator();
+		while (ri.hasMoreElements())
+		{
+			ri.getNext();
+			++count;
+		}
+		return count;
+	}
+
+	bool buffersEqual(HardwareBuffer* a, HardwareBuffer* b)
+	{
+		if (a->getSizeInBytes() != b->getSizeInBytes())
+			return false;
+		const void* pA = a->lock(HardwareBuffer::HBL_READ_ONLY);
+		const void* pB = b->lock(HardwareBuffer::HBL_READ_ONLY);
+		bool equal = memcmp(pA, pB, a->getSizeInBytes()) == 0;
+		a->unlock();
+		b->unlock();
+		return equal;
+	}
+
+	/// Records the calls StaticGeometry::build makes
+	class RecordingListener : public StaticGeometry::BuildListener
+	{
+	public:
+		vector<size_t>::type regionsBuilt;
+		size_t regionCount;
+		size_t completeCount;
+		size_t progressBeforeComplete;
+
+		RecordingListener() : regionCount(0), completeCount(0), progressBeforeComplete(0) {}
+
+		void buildProgress(StaticGeometry* geom, size_t built, size_t count)
+		{
+			(void)geom;
+			regionsBuilt.push_back(built);
+			regionCount = count;
+		}
+		void buildComplete(StaticGeometry* geom)
+		{
+			(void)geom;
+			++completeCount;
+			progressBeforeComplete = regionsBuilt.size();
+		}
+	};
+}
+
+void StaticGeometryTests::setUp()
+{
+	mRoot = OGRE_NEW Root("");
+	mBufMgr = new DefaultHardwareBufferManager();
+	const char* materials[2] = { "StaticTestPlain", "StaticTestTangents" };
+	for (int i = 0; i < 2; ++i)
+	{
+		MaterialPtr mat = MaterialManager::getSingleton().create(materials[i],
+			ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		// no techniques, since compiling them needs a render system
+		mat->removeAllTechniques();
+	}
+	createGridMesh("StaticTestPlain", "StaticTestPlain", false);
+	createGridMesh("StaticTestTangents", "StaticTestTangents", true);
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+}
+void StaticGeometryTests::tearDown()
+{
+	mRoot->destroySceneManager(mSceneMgr);
+	MeshManager::getSingleton().removeAll();
+	delete mBufMgr;
+	OGRE_DELETE mRoot;
+}
+
+void StaticGeometryTests::testParallelBuildMatchesSerial()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("StaticGeometryTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+	// use several threads even if the hardware doesn't have them
+	mSceneMgr->getParallelDispatcher()->setConcurrency(4);
+
+	StaticGeometry* serial = mSceneMgr->createStaticGeometry("Serial");
+	StaticGeometry* parallel = mSceneMgr->createStaticGeometry("Parallel");
+	parallel->setParallelBuild(true);
+	fillGeometry(mSceneMgr, serial, 1000, 4321);
+	fillGeometry(mSceneMgr, parallel, 1000, 4321);
+	serial->build();
+	parallel->build();
+
+	CPPUNIT_ASSERT(getRegionCount(serial) > 100);
+	CPPUNIT_ASSERT_EQUAL(getRegionCount(serial), getRegionCount(parallel));
+	BucketList serialBuckets = getBuckets(serial);
+	BucketList parallelBuckets = getBuckets(parallel);
+	CPPUNIT_ASSERT_EQUAL(serialBuckets.size(), parallelBuckets.size());
+	for (size_t i = 0; i < serialBuckets.size(); ++i)
+	{
+		const VertexData* vd[2] = {
+			serialBuckets[i]->getVertexData(), parallelBuckets[i]->getVertexData() };
+		CPPUNIT_ASSERT_EQUAL(vd[0]->vertexCount, vd[1]->vertexCount);
+		CPPUNIT_ASSERT_EQUAL(vd[0]->vertexBufferBinding->getBufferCount(),
+			vd[1]->vertexBufferBinding->getBufferCount());
+		for (unsigned short b = 0; b < vd[0]->vertexBufferBinding->getBufferCount(); ++b)
+		{
+			CPPUNIT_ASSERT(buffersEqual(vd[0]->vertexBufferBinding->getBuffer(b).get(),
+				vd[1]->vertexBufferBinding->getBuffer(b).get()));
+		}
+
+		const IndexData* id[2] = {
+			serialBuckets[i]->getIndexData(), parallelBuckets[i]->getIndexData() };
+		CPPUNIT_ASSERT_EQUAL(id[0]->indexCount, id[1]->indexCount);
+		CPPUNIT_ASSERT(buffersEqual(id[0]->indexBuffer.get(), id[1]->indexBuffer.get()));
+	}
+
+	// The vertices really were transformed, the source grid is within 4 units of the origin
+	const VertexData* vd = serialBuckets[0]->getVertexData();
+	const VertexElement* posElem =
+		vd->vertexDeclaration->findElementBySemantic(VES_POSITION);
+	HardwareVertexBufferSharedPtr vbuf = vd->vertexBufferBinding->getBuffer(posElem->getSource());
+	const float* pPos = static_cast<const float*>(vbuf->lock(HardwareBuffer::HBL_READ_ONLY));
+	bool transformed = false;
+	for (size_t v = 0; v < vd->vertexCount && !transformed; ++v)
+	{
+		const float* p = pPos + v * vbuf->getVertexSize() / sizeof(float);
+		transformed = Math::Abs(p[0]) > 10 || Math::Abs(p[1]) > 10 || Math::Abs(p[2]) > 10;
+	}
+	vbuf->unlock();
+	CPPUNIT_ASSERT(transformed);
+
+	mSceneMgr->destroyStaticGeometry(serial);
+	mSceneMgr->destroyStaticGeometry(parallel);
+}
+
+void StaticGeometryTests::testBuildListener()
+{
+	DefaultWorkQueue* q = OGRE_NEW DefaultWorkQueue("StaticGeometryTests");
+	q->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(q);
+	q->startup();
+	mSceneMgr->getParallelDispatcher()->setConcurrency(4);
+
+	StaticGeometry* geom = mSceneMgr->createStaticGeometry("Listened");
+	fillGeometry(mSceneMgr, geom, 300, 99);
+	RecordingListener serialListener;
+	geom->setBuildListener(&serialListener);
+	geom->build();
+	size_t regionCount = getRegionCount(geom);
+
+	// Built one region at a time
+	CPPUNIT_ASSERT(regionCount > 10);
+	CPPUNIT_ASSERT_EQUAL(regionCount, serialListener.regionCount);
+	CPPUNIT_ASSERT_EQUAL(regionCount, serialListener.regionsBuilt.size());
+	for (size_t i = 0; i < serialListener.regionsBuilt.size(); ++i)
+		CPPUNIT_ASSERT_EQUAL(i + 1, serialListener.regionsBuilt[i]);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, serialListener.completeCount);
+	CPPUNIT_ASSERT_EQUAL(regionCount, serialListener.progressBeforeComplete);
+
+	// Built in batches big enough to share out, but still reporting progress
+	RecordingListener parallelListener;
+	geom->setBuildListener(&parallelListener);
+	geom->setParallelBuild(true);
+	geom->build();
+	CPPUNIT_ASSERT_EQUAL(regionCount, getRegionCount(geom));
+	CPPUNIT_ASSERT_EQUAL(regionCount, parallelListener.regionCount);
+	CPPUNIT_ASSERT(parallelListener.regionsBuilt.size() > 1);
+	CPPUNIT_ASSERT(parallelListener.regionsBuilt.size() < regionCount);
+	for (size_t i = 1; i < parallelListener.regionsBuilt.size(); ++i)
+		CPPUNIT_ASSERT(parallelListener.regionsBuilt[i] > parallelListener.regionsBuilt[i - 1]);
+	CPPUNIT_ASSERT_EQUAL(regionCount, parallelListener.regionsBuilt.back());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, parallelListener.completeCount);
+	CPPUNIT_ASSERT_EQUAL(parallelListener.regionsBuilt.size(), parallelListener.progressBeforeComplete);
+	// the serial listener is no longer told anything
+	CPPUNIT_ASSERT_EQUAL((size_t)1, serialListener.completeCount);
+
+	mSceneMgr->destroyStaticGeometry(geom);
+}
@@ -0,0 +1,192 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "TraceProfilerTests.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+#include <sstream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( TraceProfilerTests );
+
+namespace
+{
+	const TraceMarker outerMarker("TraceProfilerTests::outer");
+	const TraceMarker innerMarker("TraceProfilerTests::inner");
+	const TraceMarker workerMarker("TraceProfilerTests::worker");
+}
+
+void TraceProfilerTests::setUp()
+{
+	LogManager::getSingleton().createLog("TraceProfilerTests.log", true);
+	LogManager::getSingleton().setLogDetail(LL_LOW);
+	mProfiler = OGRE_NEW TraceProfiler(1024);
+	mProfiler->setEnabled(true);
+}
+void TraceProfilerTests::tearDown()
+{
+	OGRE_DELETE mProfiler;
+}
+
+void TraceProfilerTests::testNestedScopes()
+{
+	{
+		TraceScope outer(outerMarker);
+		{
+			TraceScope inner(innerMarker);
+			OGRE_THREAD_SLEEP(1);
+		}
+	}
+
+	TraceEventList events;
+	mProfiler->getEvents(events);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, events.size());
+
+	// events are recorded as they end, so the inner one comes first
+	const TraceEvent& inner = events[0];
+	const TraceEvent& outer = events[1];
+	CPPUNIT_ASSERT(inner.marker == &innerMarker);
+	CPPUNIT_ASSERT(outer.marker == &outerMarker);
+	CPPUNIT_ASSERT_EQUAL((uint32)1, inner.depth);
+	CPPUNIT_ASSERT_EQUAL((uint32)0, outer.depth);
+	CPPUNIT_ASSERT(inner.start >= outer.start);
+	CPPUNIT_ASSERT(inner.start + inner.duration <= outer.start + outer.duration);
+
+	// filtered out groups are not recorded
+	mProfiler->reset();
+	mProfiler->setProfileGroupMask(OGREPROF_GENERAL);
+	{
+		TraceScope outer(outerMarker);
+	}
+	events.clear();
+	mProfiler->getEvents(events);
+	CPPUNIT_ASSERT(events.empty());
+}
+
+void TraceProfilerTests::testRingBufferKeepsLatest()
+{
+	const size_t capacity = mProfiler->getEventsPerThread();
+	CPPUNIT_ASSERT_EQUAL((size_t)1024, capacity);
+
+	for (size_t i = 0; i < capacity + 100; ++i)
+	{
+		TraceScope scope(i < 100 ? outerMarker : innerMarker);
+	}
+
+	// only the newest events are kept, which are all for the inner marker;
+	// the oldest slot is left out once the ring has wrapped, since it is
+	// the next one to be overwritten
+	TraceEventList events;
+	mProfiler->getEvents(events);
+	CPPUNIT_ASSERT_EQUAL(capacity - 1, events.size());
+	for (TraceEventList::iterator i = events.begin(); i != events.end(); ++i)
+		CPPUNIT_ASSERT(i->marker == &innerMarker);
+
+	mProfiler->reset();
+	events.clear();
+	mProfiler->getEvents(events);
+	CPPUNIT_ASSERT(events.empty());
+}
+
+#if OGRE_THREAD_SUPPORT && (OGRE_THREAD_PROVIDER == 1 || OGRE_THREAD_PROVIDER == 2)
+namespace
+{
+	/// Records an event on whichever worker handles each request
+	class TracingHandler : public WorkQueue::RequestHandler
+	{
+	public:
+		AtomicScalar<size_t> handled;
+
+		TracingHandler() : handled(0) {}
+
+		WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
+		{
+			{
+				TraceScope scope(workerMarker);
+				OGRE_THREAD_SLEEP(1);
+			}
+			++handled;
+			return OGRE_NEW WorkQueue::Response(req, true, Any());
+		}
+	};
+}
+#endif
+
+void TraceProfilerTests::testThreadsAndExport()
+{
+	mProfiler->setThreadName("Test \"main\"");
+	{
+		TraceScope outer(outerMarker);
+	}
+
+#if OGRE_THREAD_SUPPORT && (OGRE_THREAD_PROVIDER == 1 || OGRE_THREAD_PROVIDER == 2)
+	DefaultWorkQueue q("Test");
+	TracingHandler handler;
+	q.setWorkerThreadCount(2);
+	q.setResponseProcessingTimeLimit(0);
+	q.addRequestHandler(0, &handler);
+	q.startup();
+
+	const size_t count = 50;
+	for (size_t i = 0; i < count; ++i)
+		q.addRequest(0, 0, Any());
+
+	Timer timer;
+	while (handler.handled.get() < count && timer.getMilliseconds() < 30000)
+		OGRE_THREAD_SLEEP(1);
+	q.shutdown();
+	q.removeRequestHandler(0, &handler);
+	CPPUNIT_ASSERT_EQUAL(count, handler.handled.get());
+
+	TraceEventList events;
+	mProfiler->getEvents(events);
+	size_t workerEvents = 0;
+	for (TraceEventList::iterator i = events.begin(); i != events.end(); ++i)
+	{
+		if (i->marker == &workerMarker)
+		{
+			// workers never record on the main thread's buffer
+			CPPUNIT_ASSERT(i->threadIndex != 0);
+			++workerEvents;
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL(count, workerEvents);
+#endif
+
+	std::stringstream stream;
+	mProfiler->exportChromeTrace(stream);
+	String json = stream.str();
+	CPPUNIT_ASSERT(json.find("\"traceEvents\"") != String::npos);
+	CPPUNIT_ASSERT(json.find("\"thread_name\"") != String::npos);
+	CPPUNIT_ASSERT(json.find("\"Test \\\"main\\\"\"") != String::npos);
+	CPPUNIT_ASSERT(json.find("\"TraceProfilerTests::outer\"") != String::npos);
+
+	mProfiler->logSummary();
+}
@@ -0,0 +1,228 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "WorkQueueTests.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+#include <iostream>
+
+using namespace Ogre;
+
+// Regsiter the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( WorkQueueTests );
+
+void WorkQueueTests::setUp()
+{
+	LogManager::getSingleton().createLog("WorkQueueTests.log", true);
+	LogManager::getSingleton().setLogDetail(LL_LOW);
+}
+void WorkQueueTests::tearDown()
+{
+}
+
+#if OGRE_THREAD_SUPPORT && (OGRE_THREAD_PROVIDER == 1 || OGRE_THREAD_PROVIDER == 2)
+
+namespace
+{
+	/// Counts requests per channel, optionally failing the first attempt at each
+	class CountingHandler : public WorkQueue::RequestHandler
+	{
+	public:
+		AtomicScalar<size_t> seen;
+		AtomicScalar<size_t> handled[3];
+		size_t work;
+		bool failFirstAttempt;
+
+		CountingHandler(size_t w = 0) : seen(0), work(w), failFirstAttempt(false)
+		{
+			for (int i = 0; i < 3; ++i)
+				handled[i].set(0);
+		}
+
+		bool canHandleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
+		{
+			++seen;
+			return RequestHandler::canHandleRequest(req, srcQ);
+		}
+
+		WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
+		{
+			// simulate a little CPU work
+			volatile size_t acc = 0;
+			for (size_t i = 0; i < work; ++i)
+				acc += i;
+
+			++handled[req->getChannel() % 3];
+			bool success = !(failFirstAttempt && req->getRetryCount());
+			return OGRE_NEW WorkQueue::Response(req, success, Any());
+		}
+	};
+
+	bool waitFor(AtomicScalar<size_t>& counter, size_t target)
+	{
+		Timer timer;
+		while (counter.get() < target)
+		{
+			if (timer.getMilliseconds() > 30000)
+				return false;
+			OGRE_THREAD_SLEEP(1);
+		}
+		return true;
+	}
+
+	/// Push 'count' requests through a queue and return requests per second
+	double measureThroughput(DefaultWorkQueueBase& q, size_t workers, size_t count, size_t work)
+	{
+		CountingHandler handler(work);
+		q.setWorkerThreadCount(workers);
+		q.setResponseProcessingTimeLimit(0);
+		for (uint16 c = 0; c < 3; ++c)
+			q.addRequestHandler(c, &handler);
+		q.startup();
+
+		Timer timer;
+		for (size_t i = 0; i < count; ++i)
+			q.addRequest((uint16)(i % 3), 0, Any());
+		CPPUNIT_ASSERT(waitFor(handler.seen, count));
+		unsigned long us = timer.getMicroseconds();
+
+		q.shutdown();
+		for (uint16 c = 0; c < 3; ++c)
+			q.removeRequestHandler(c, &handler);
+
+		return us ? (double)count * 1000000.0 / (double)us : 0;
+	}
+}
+
+void WorkQueueTests::testStealingProcessesAll()
+{
+	DefaultWorkQueueStealing q("Test");
+	CountingHandler handler;
+	q.setWorkerThreadCount(4);
+	for (uint16 c = 0; c < 3; ++c)
+		q.addRequestHandler(c, &handler);
+	q.startup();
+
+	// everything on one channel, so the other workers have to steal
+	const size_t count = 10000;
+	for (size_t i = 0; i < count; ++i)
+		q.addRequest(1, 0, Any());
+
+	CPPUNIT_ASSERT(waitFor(handler.handled[1], count));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, q.getQueuedRequestCount());
+
+	q.shutdown();
+	CPPUNIT_ASSERT_EQUAL(count, handler.handled[1].get());
+	q.removeRequestHandler(0, &handler);
+	q.removeRequestHandler(1, &handler);
+	q.removeRequestHandler(2, &handler);
+}
+
+void WorkQueueTests::testStealingAbortByChannel()
+{
+	DefaultWorkQueueStealing q("Test");
+	CountingHandler handler;
+	q.setWorkerThreadCount(2);
+	q.addRequestHandler(1, &handler);
+	q.addRequestHandler(2, &handler);
+	q.startup();
+	q.setPaused(true);
+
+	const size_t count = 500;
+	for (size_t i = 0; i < count; ++i)
+	{
+		q.addRequest(1, 0, Any());
+		q.addRequest(2, 0, Any());
+	}
+	q.abortRequestsByChannel(1);
+	// requests queued after the abort are not affected
+	q.addRequest(1, 0, Any());
+	q.setPaused(false);
+
+	CPPUNIT_ASSERT(waitFor(handler.handled[2], count));
+	CPPUNIT_ASSERT(waitFor(handler.handled[1], 1));
+	// the aborted requests are still offered to the handler, which turns them down;
+	// join the workers once they have all been seen so none can still be in progress
+	CPPUNIT_ASSERT(waitFor(handler.seen, count * 2 + 1));
+	q.shutdown();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, handler.handled[1].get());
+	CPPUNIT_ASSERT_EQUAL(count, handler.handled[2].get());
+
+	q.removeRequestHandler(1, &handler);
+	q.removeRequestHandler(2, &handler);
+}
+
+void WorkQueueTests::testStealingRetry()
+{
+	DefaultWorkQueueStealing q("Test");
+	CountingHandler handler;
+	handler.failFirstAttempt = true;
+	q.setWorkerThreadCount(2);
+	q.addRequestHandler(0, &handler);
+	q.startup();
+
+	const size_t count = 100;
+	for (size_t i = 0; i < count; ++i)
+		q.addRequest(0, 0, Any(), 1);
+
+	// each request fails once and succeeds on the retry
+	CPPUNIT_ASSERT(waitFor(handler.handled[0], count * 2));
+
+	q.shutdown();
+	CPPUNIT_ASSERT_EQUAL(count * 2, handler.handled[0].get());
+	q.removeRequestHandler(0, &handler);
+}
+
+void WorkQueueTests::testThroughput()
+{
+	const size_t count = 100000;
+	size_t workers = OGRE_THREAD_HARDWARE_CONCURRENCY;
+	if (workers < 2)
+		workers = 2;
+
+	for (size_t work = 0; work <= 1000; work += 1000)
+	{
+		DefaultWorkQueue standard("Standard");
+		DefaultWorkQueueStealing stealing("Stealing");
+		double standardRate = measureThroughput(standard, workers, count, work);
+		double stealingRate = measureThroughput(stealing, workers, count, work);
+
+		std::cout << std::endl << "WorkQueue throughput, " << workers << " workers, "
+			<< work << " work units per request: DefaultWorkQueue " << (size_t)standardRate
+			<< " req/s, DefaultWorkQueueStealing " << (size_t)stealingRate << " req/s" << std::endl;
+	}
+}
+
+#else
+
+void WorkQueueTests::testStealingProcessesAll() {}
+void WorkQueueTests::testStealingAbortByChannel() {}
+void WorkQueueTests::testStealingRetry() {}
+void WorkQueueTests::testThroughput() {}
+
+#endif
@@ -29,9 +29,12 @@ THE SOFTWARE.
 
 #include "Ogre.h"
 #include "OgreMeshSerializer.h"
+#include "OgreMeshOptimiser.h"
 #include "OgreSkeletonSerializer.h"
 #include "OgreDefaultHardwareBufferManager.h"
 #include "OgreHardwareVertexBuffer.h"
+#include "OgreParallelTaskDispatcher.h"
+#include "Threading/OgreDefaultWorkQueue.h"
 
 #include <iostream>
 #include <sys/stat.h>
@@ -42,7 +45,7 @@ using namespace Ogre;
 void help(void)
 {
     // Print help message
-    cout << endl << "OgreMeshUpgrader: Upgrades .mesh files to the latest version." << endl;
+    cout << endl << "OgreMeshUpgrader: Upgrades .mesh and .skeleton files to the latest version." << endl;
     cout << "Provided for OGRE by Steve Streeting 2004" << endl << endl;
     cout << "Usage: OgreMeshUpgrader [-e] sourcefile [destfile] " << endl;
 	cout << "-i             = Interactive mode, prompt for options" << endl;
@@ -64,6 +67,15 @@ void help(void)
 	cout << "-srcgl     = Interpret ambiguous colours as GL style" << endl;
 	cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
 	cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
+	cout << "-o         = Optimise triangle and vertex order for the vertex cache" << endl;
+	cout << "             and overdraw" << endl;
+	cout << "-oc size   = Vertex cache size to optimise for (default 16)" << endl;
+	cout << "-ab        = Align vertex and index data for memory mapped loading" << endl;
+	cout << "             (.mesh files only; use with native endian)" << endl;
+	cout << "-ac        = Compress skeleton animations (.skeleton files only)" << endl;
+	cout << "-act tol   = Translation error allowed by -ac (default 0.001)" << endl;
+	cout << "-acr deg   = Rotation error allowed by -ac, in degrees (default 0.1)" << endl;
+	cout << "-acs tol   = Scale error allowed by -ac (default 0.001)" << endl;
     cout << "sourcefile = name of file to convert" << endl;
     cout << "destfile   = optional name of file to write to. If you don't" << endl;
     cout << "             specify this OGRE overwrites the existing file." << endl;
@@ -92,6 +104,13 @@ struct UpgradeOptions
 	bool usePercent;
 	Serializer::Endian endian;
 	bool recalcBounds;
+	bool optimiseVertexCache;
+	size_t vertexCacheSize;
+	bool alignBuffers;
+	bool compressAnimations;
+	Real animTranslationTolerance;
+	Real animRotationTolerance;
+	Real animScaleTolerance;
 
 };
 
@@ -109,6 +128,7 @@ SkeletonSerializer* skeletonSerializer = 0;
 DefaultHardwareBufferManager *bufferManager = 0;
 ResourceGroupManager* rgm = 0;
 MeshManager* meshMgr = 0;
+WorkQueue* workQueue = 0;
 UpgradeOptions opts;
 
 void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
@@ -131,6 +151,13 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 	opts.numLods = 0;
 	opts.usePercent = true;
 	opts.recalcBounds = false;
+	opts.optimiseVertexCache = false;
+	opts.vertexCacheSize = 16;
+	opts.alignBuffers = false;
+	opts.compressAnimations = false;
+	opts.animTranslationTolerance = 0.001f;
+	opts.animRotationTolerance = 0.1f;
+	opts.animScaleTolerance = 0.001f;
 
 
 	UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -175,6 +202,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 	{
 		opts.recalcBounds = true;
 	}
+	ui = unOpts.find("-o");
+	opts.optimiseVertexCache = ui->second;
+	ui = unOpts.find("-ab");
+	opts.alignBuffers = ui->second;
+	ui = unOpts.find("-ac");
+	opts.compressAnimations = ui->second;
 
 
 	BinaryOptionList::iterator bi = binOpts.find("-l");
@@ -228,6 +261,26 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 		if (bi->second == "4")
 			opts.tangentUseParity = true;
 	}
+	bi = binOpts.find("-oc");
+	if (!bi->second.empty())
+	{
+		opts.vertexCacheSize = StringConverter::parseUnsignedInt(bi->second);
+	}
+	bi = binOpts.find("-act");
+	if (!bi->second.empty())
+	{
+		opts.animTranslationTolerance = StringConverter::parseReal(bi->second);
+	}
+	bi = binOpts.find("-acr");
+	if (!bi->second.empty())
+	{
+		opts.animRotationTolerance = StringConverter::parseReal(bi->second);
+	}
+	bi = binOpts.find("-acs");
+	if (!bi->second.empty())
+	{
+		opts.animScaleTolerance = StringConverter::parseReal(bi->second);
+	}
 }
 
 String describeSemantic(VertexElementSemantic sem)
@@ -701,7 +754,9 @@ void buildLod(Mesh* mesh)
 
 		}
 
+		Timer timer;
 		mesh->generateLodLevels(distanceList, quota, reduction);
+		cout << "\nGenerated LOD levels in " << timer.getMilliseconds() << "ms." << std::endl;
 	}
 
 }
@@ -886,6 +941,51 @@ void recalcBounds(Mesh* mesh)
 	mesh->_setBoundingSphereRadius(radius);
 }
 
+void optimiseVertexCache(Mesh* mesh)
+{
+	cout << "\nOptimising for a vertex cache of " << opts.vertexCacheSize << " entries.." << endl;
+	MeshOptimiser optimiser;
+	optimiser.setCacheSize(opts.vertexCacheSize);
+	optimiser.optimise(mesh);
+
+	// Average cache miss ratio, ie vertices transformed per triangle
+	const MeshOptimiser::Statistics& stats = optimiser.getStatistics();
+	cout << "ACMR " << stats.getACMRBefore() << " before, " << stats.getACMRAfter() 
+		<< " after, over " << stats.triangleCount << " triangles" << endl;
+}
+
+size_t countKeyFrames(Skeleton& skel)
+{
+	size_t count = 0;
+	for (unsigned short a = 0; a < skel.getNumAnimations(); ++a)
+	{
+		Animation::NodeTrackIterator it = skel.getAnimation(a)->getNodeTrackIterator();
+		while (it.hasMoreElements())
+		{
+			count += it.getNext()->getNumKeyFrames();
+		}
+	}
+	return count;
+}
+
+// Upgrade a .skeleton file, compressing its animations if requested
+void upgradeSkeleton(DataStreamPtr& stream, const String& dest)
+{
+	Skeleton skel(skelMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	skeletonSerializer->importSkeleton(stream, &skel);
+
+	if (opts.compressAnimations)
+	{
+		cout << "\nCompressing animations.." << std::endl;
+		size_t before = countKeyFrames(skel);
+		skel.compressAllAnimations(opts.animTranslationTolerance,
+			Degree(opts.animRotationTolerance), opts.animScaleTolerance);
+		cout << "Key frames reduced from " << before << " to " << countKeyFrames(skel) << std::endl;
+	}
+
+	skeletonSerializer->exportSkeleton(&skel, dest, opts.endian);
+}
+
 int main(int numargs, char** args)
 {
     if (numargs < 2)
@@ -911,6 +1011,15 @@ int main(int numargs, char** args)
 		meshMgr = new MeshManager();
 		// don't pad during upgrade
 		meshMgr->setBoundsPaddingFactor(0.0f);
+#if OGRE_THREAD_SUPPORT
+		// LOD levels and edge lists are built in parallel; there's no Root
+		// to supply a work queue for that, so provide one
+		DefaultWorkQueue* defaultQueue = new DefaultWorkQueue("MeshUpgrader");
+		defaultQueue->setWorkerThreadCount(OGRE_THREAD_HARDWARE_CONCURRENCY);
+		defaultQueue->startup();
+		workQueue = defaultQueue;
+		meshMgr->getParallelDispatcher()->setWorkQueue(workQueue);
+#endif
 
 	    
 		UnaryOptionList unOptList;
@@ -927,6 +1036,9 @@ int main(int numargs, char** args)
 		unOptList["-srcgl"] = false;
 		unOptList["-srcd3d"] = false;
 		unOptList["-b"] = false;
+		unOptList["-o"] = false;
+		unOptList["-ab"] = false;
+		unOptList["-ac"] = false;
 		binOptList["-l"] = "";
 		binOptList["-d"] = "";
 		binOptList["-p"] = "";
@@ -934,6 +1046,10 @@ int main(int numargs, char** args)
 		binOptList["-E"] = "";
 		binOptList["-td"] = "";
 		binOptList["-ts"] = "";
+		binOptList["-oc"] = "";
+		binOptList["-act"] = "";
+		binOptList["-acr"] = "";
+		binOptList["-acs"] = "";
 
 		int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
 		parseOpts(unOptList, binOptList);
@@ -955,12 +1071,9 @@ int main(int numargs, char** args)
 		fread( (void*)memstream->getPtr(), tagStat.st_size, 1, pFile );
 		fclose( pFile );
 
-		Mesh mesh(meshMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
-
 		DataStreamPtr stream(memstream);
-		meshSerializer->importMesh(stream, &mesh);
 
-		// Write out the converted mesh
+		// Write out the converted file
 		String dest;
 		if (numargs == startIdx + 2)
 		{
@@ -971,77 +1084,91 @@ int main(int numargs, char** args)
 			dest = source;
 		}
 
-		String response;
-
-		vertexBufferReorg(mesh);
-
-		// Deal with VET_COLOUR ambiguities
-		resolveColourAmbiguities(&mesh);
-		
-		buildLod(&mesh);
-
-		// Make sure we generate edge lists, provided they are not deliberately disabled
-		if (!opts.suppressEdgeLists)
+		if (StringUtil::endsWith(source, ".skeleton"))
 		{
-			cout << "\nGenerating edge lists.." << std::endl;
-			mesh.buildEdgeList();
+			upgradeSkeleton(stream, dest);
 		}
 		else
 		{
-			mesh.freeEdgeList();
-		}
+			Mesh mesh(meshMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
 
-		// Generate tangents?
-		if (opts.generateTangents)
-		{
-			unsigned short srcTex, destTex;
-			bool existing = mesh.suggestTangentVectorBuildParams(opts.tangentSemantic, srcTex, destTex);
-			if (existing)
+			meshSerializer->importMesh(stream, &mesh);
+
+			String response;
+
+			vertexBufferReorg(mesh);
+
+			// Deal with VET_COLOUR ambiguities
+			resolveColourAmbiguities(&mesh);
+		
+			buildLod(&mesh);
+
+			// Make sure we generate edge lists, provided they are not deliberately disabled
+			if (!opts.suppressEdgeLists)
 			{
-				if (opts.interactive)
+				cout << "\nGenerating edge lists.." << std::endl;
+				mesh.buildEdgeList();
+			}
+			else
+			{
+				mesh.freeEdgeList();
+			}
+
+			// Generate tangents?
+			if (opts.generateTangents)
+			{
+				unsigned short srcTex, destTex;
+				bool existing = mesh.suggestTangentVectorBuildParams(opts.tangentSemantic, srcTex, destTex);
+				if (existing)
 				{
-					std::cout << "\nThis mesh appears to already have a set of tangents, " <<
-						"which would suggest tangent vectors have already been calculated. Do you really " <<
-						"want to generate new tangent vectors (may duplicate)? (y/n)";
-					while (response == "")
+					if (opts.interactive)
 					{
-						cin >> response;
-						StringUtil::toLowerCase(response);
-						if (response == "y")
-						{
-							// Do nothing
-						}
-						else if (response == "n")
+						std::cout << "\nThis mesh appears to already have a set of tangents, " <<
+							"which would suggest tangent vectors have already been calculated. Do you really " <<
+							"want to generate new tangent vectors (may duplicate)? (y/n)";
+						while (response == "")
 						{
-							opts.generateTangents = false;
-						}
-						else
-						{
-							response = "";
+							cin >> response;
+							StringUtil::toLowerCase(response);
+							if (response == "y")
+							{
+								// Do nothing
+							}
+							else if (response == "n")
+							{
+								opts.generateTangents = false;
+							}
+							else
+							{
+								response = "";
+							}
 						}
 					}
+					else
+					{
+						// safe
+						opts.generateTangents = false;
+					}
+
 				}
-				else
+				if (opts.generateTangents)
 				{
-					// safe
-					opts.generateTangents = false;
+					cout << "Generating tangent vectors...." << std::endl;
+					mesh.buildTangentVectors(opts.tangentSemantic, srcTex, destTex, 
+						opts.tangentSplitMirrored, opts.tangentSplitRotated, 
+						opts.tangentUseParity);
 				}
-
 			}
-			if (opts.generateTangents)
-			{
-				cout << "Generating tangent vectors...." << std::endl;
-				mesh.buildTangentVectors(opts.tangentSemantic, srcTex, destTex, 
-					opts.tangentSplitMirrored, opts.tangentSplitRotated, 
-					opts.tangentUseParity);
-			}
-		}
 
 
-		if (opts.recalcBounds)
-			recalcBounds(&mesh);
+			if (opts.optimiseVertexCache)
+				optimiseVertexCache(&mesh);
+
+			if (opts.recalcBounds)
+				recalcBounds(&mesh);
 
-		meshSerializer->exportMesh(&mesh, dest, opts.endian);
+			meshSerializer->exportMesh(&mesh, dest, opts.endian, opts.alignBuffers);
+		}
     
 	}
 	catch (Exception& e)
@@ -1050,7 +1177,12 @@ int main(int numargs, char** args)
 		retCode = 1;
 	}
 
-
+	if (workQueue)
+	{
+		meshMgr->getParallelDispatcher()->setWorkQueue(0);
+		workQueue->shutdown();
+		delete workQueue;
+	}
     delete meshMgr;
     delete skeletonSerializer;
     delete meshSerializer;